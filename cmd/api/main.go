@@ -3,11 +3,15 @@ package main
 import (
 	"context"
 	"fmt"
+	"net"
+	"net/http"
 	"os"
 	"time"
 
 	"github.com/yourtionguo/CodeAtlas/internal/api"
+	"github.com/yourtionguo/CodeAtlas/internal/api/middleware"
 	"github.com/yourtionguo/CodeAtlas/internal/config"
+	"github.com/yourtionguo/CodeAtlas/internal/diagnostics"
 	"github.com/yourtionguo/CodeAtlas/internal/indexer"
 	"github.com/yourtionguo/CodeAtlas/internal/utils"
 	"github.com/yourtionguo/CodeAtlas/pkg/models"
@@ -41,6 +45,29 @@ func main() {
 		utils.Field{Key: "db_name", Value: cfg.Database.Database},
 	)
 
+	// Bind the port before touching the database. Until the router is
+	// installed the gate answers /health (alive) and /ready (503), and rejects
+	// API requests with 503 + Retry-After, so load balancers never see a
+	// refused connection during a rolling restart.
+	gate := api.NewStartupGate()
+	address := cfg.API.Address()
+	listener, err := net.Listen("tcp", fmt.Sprintf(":%d", cfg.API.Port))
+	if err != nil {
+		logger.ErrorWithFields("Failed to start server", err,
+			utils.Field{Key: "address", Value: address},
+		)
+		os.Exit(1)
+	}
+	serveErr := make(chan error, 1)
+	go func() {
+		serveErr <- (&http.Server{Handler: gate}).Serve(listener)
+	}()
+	logger.InfoWithFields("Starting CodeAtlas API server",
+		utils.Field{Key: "address", Value: address},
+		utils.Field{Key: "port", Value: cfg.API.Port},
+		utils.Field{Key: "host", Value: cfg.API.Host},
+	)
+
 	// Wait for database to be ready with retries
 	logger.Info("Connecting to database...")
 	db, err := models.NewDBWithConfig(&cfg.Database)
@@ -58,7 +85,7 @@ func main() {
 		utils.Field{Key: "db_name", Value: cfg.Database.Database},
 	)
 
-	// Initialize database schema
+	// Initialize database schema (a single version lookup when migrations are current)
 	logger.Info("Initializing database schema...")
 	sm := models.NewSchemaManager(db)
 	ctx, cancel := context.WithTimeout(context.Background(), 30*time.Second)
@@ -78,18 +105,63 @@ func main() {
 	}
 	logger.Info("Database health check passed")
 
-	// Log database statistics
-	stats, err := sm.GetDatabaseStats(ctx)
-	if err != nil {
-		logger.WarnWithFields("Failed to get database stats",
-			utils.Field{Key: "error", Value: err.Error()},
-		)
-	} else {
-		logger.InfoWithFields("Database statistics",
-			utils.Field{Key: "repositories", Value: stats.RepositoryCount},
-			utils.Field{Key: "files", Value: stats.FileCount},
-			utils.Field{Key: "symbols", Value: stats.SymbolCount},
-			utils.Field{Key: "edges", Value: stats.EdgeCount},
+	// Rebuild indexes left deferred by a bulk load that did not finish. HNSW
+	// builds can take minutes, so this runs in the background without the
+	// startup timeout; queries work meanwhile, just without those indexes.
+	bulkLoadConfig := models.DefaultBulkLoadConfig()
+	if cfg.Indexer.BulkMaintenanceMemMB > 0 {
+		bulkLoadConfig.MaintenanceWorkMemMB = cfg.Indexer.BulkMaintenanceMemMB
+	}
+	if cfg.Indexer.BulkBuildParallelism > 0 {
+		bulkLoadConfig.Parallelism = cfg.Indexer.BulkBuildParallelism
+	}
+	go func() {
+		restored, err := models.RestoreDeferredIndexes(context.Background(), db, bulkLoadConfig)
+		if err != nil {
+			logger.WarnWithFields("Failed to restore deferred indexes",
+				utils.Field{Key: "error", Value: err.Error()},
+			)
+		} else if restored > 0 {
+			logger.InfoWithFields("Restored deferred indexes",
+				utils.Field{Key: "indexes", Value: restored},
+			)
+		}
+	}()
+
+	// Optional half-precision index for rescored searches, built concurrently
+	// in the background; rescore is ignored until it is valid
+	var rescoreIndex *models.RescoreIndex
+	if cfg.Database.VectorRescore {
+		rescoreIndex = &models.RescoreIndex{}
+		go func() {
+			built, err := rescoreIndex.Ensure(context.Background(), db, bulkLoadConfig)
+			if err != nil {
+				logger.WarnWithFields("Failed to build rescore index",
+					utils.Field{Key: "index", Value: models.RescoreIndexName},
+					utils.Field{Key: "error", Value: err.Error()},
+				)
+			} else if built {
+				logger.InfoWithFields("Built rescore index",
+					utils.Field{Key: "index", Value: models.RescoreIndexName},
+				)
+			}
+		}()
+	}
+
+	// Optional background compaction of orphan rows and dangling edges
+	if cfg.Database.CompactionInterval > 0 {
+		compactionConfig := models.DefaultCompactionConfig()
+		compactionConfig.Interval = cfg.Database.CompactionInterval
+		compactionConfig.BatchSize = cfg.Database.CompactionBatchSize
+		compactionConfig.RowsPerSecond = cfg.Database.CompactionRowsPerSecond
+		compactionConfig.ReindexBloatRatio = cfg.Database.CompactionReindexBloat
+		compactor := models.NewCompactor(db, compactionConfig)
+		compactor.Start()
+		defer compactor.Stop()
+		logger.InfoWithFields("Background compaction enabled",
+			utils.Field{Key: "interval", Value: compactionConfig.Interval},
+			utils.Field{Key: "batch_size", Value: compactionConfig.BatchSize},
+			utils.Field{Key: "rows_per_second", Value: compactionConfig.RowsPerSecond},
 		)
 	}
 
@@ -106,6 +178,7 @@ func main() {
 		BaseRetryDelay:       cfg.Embedder.BaseRetryDelay,
 		MaxRetryDelay:        cfg.Embedder.MaxRetryDelay,
 		Timeout:              cfg.Embedder.Timeout,
+		Granularity:          cfg.Embedder.Granularity,
 	}
 
 	// Create server configuration from loaded config
@@ -114,6 +187,10 @@ func main() {
 		AuthTokens:     cfg.API.AuthTokens,
 		CORSOrigins:    cfg.API.CORSOrigins,
 		EmbedderConfig: embedderConfig,
+		BulkLoad:       &bulkLoadConfig,
+
+		WriteParallelism: cfg.Indexer.WriteParallelism,
+		RescoreIndex:     rescoreIndex,
 	}
 	logger.InfoWithFields("Server configuration",
 		utils.Field{Key: "auth_enabled", Value: serverConfig.EnableAuth},
@@ -123,21 +200,115 @@ func main() {
 		utils.Field{Key: "embedder_model", Value: embedderConfig.Model},
 	)
 
+	// Optional per-client quotas and fair queuing (validated by LoadConfig)
+	if cfg.API.QuotasEnabled() {
+		routeQuotas, _ := cfg.API.RouteQuotas()
+		weights, _ := cfg.API.TokenWeights()
+		quota := &middleware.QuotaConfig{
+			Rate:         cfg.API.QuotaRate,
+			Burst:        cfg.API.QuotaBurst,
+			Routes:       make(map[string]middleware.RouteQuota, len(routeQuotas)),
+			Weights:      weights,
+			MaxInFlight:  cfg.API.MaxInFlight,
+			MaxQueue:     cfg.API.QueueSize,
+			QueueTimeout: cfg.API.QueueTimeout,
+		}
+		for route, rq := range routeQuotas {
+			quota.Routes[route] = middleware.RouteQuota{Rate: rq.Rate, Burst: rq.Burst, Cost: rq.Cost}
+		}
+		serverConfig.Quota = quota
+		logger.InfoWithFields("Request quotas enabled",
+			utils.Field{Key: "rate", Value: quota.Rate},
+			utils.Field{Key: "burst", Value: quota.Burst},
+			utils.Field{Key: "route_quotas", Value: len(quota.Routes)},
+			utils.Field{Key: "max_in_flight", Value: quota.MaxInFlight},
+		)
+	}
+
+	// Optional flight recorder and diagnostics listener
+	var recorder *diagnostics.FlightRecorder
+	if cfg.API.TraceSlowThreshold > 0 {
+		frConfig := diagnostics.DefaultFlightRecorderConfig()
+		frConfig.SlowThreshold = cfg.API.TraceSlowThreshold
+		frConfig.Window = cfg.API.TraceWindow
+		if cfg.API.TraceDir != "" {
+			frConfig.Dir = cfg.API.TraceDir
+		}
+		recorder = diagnostics.NewFlightRecorder(frConfig, logger)
+		if err := recorder.Start(); err != nil {
+			logger.WarnWithFields("Failed to start flight recorder",
+				utils.Field{Key: "error", Value: err.Error()},
+			)
+			recorder = nil
+		} else {
+			defer recorder.Stop()
+			serverConfig.LatencyObserver = recorder.Observe
+			logger.InfoWithFields("Flight recorder enabled",
+				utils.Field{Key: "slow_threshold", Value: frConfig.SlowThreshold},
+				utils.Field{Key: "window", Value: frConfig.Window},
+				utils.Field{Key: "dir", Value: frConfig.Dir},
+			)
+		}
+	}
+	if cfg.API.DiagnosticsAddr != "" {
+		diagServer := diagnostics.NewServer(cfg.API.DiagnosticsAddr, cfg.API.DiagnosticsToken, recorder)
+		go func() {
+			if err := diagServer.ListenAndServe(); err != nil && err != http.ErrServerClosed {
+				logger.ErrorWithFields("Diagnostics listener failed", err,
+					utils.Field{Key: "address", Value: cfg.API.DiagnosticsAddr},
+				)
+			}
+		}()
+		logger.InfoWithFields("Diagnostics listener started",
+			utils.Field{Key: "address", Value: cfg.API.DiagnosticsAddr},
+		)
+	}
+
+	// Log database statistics. COUNT(*) scans large tables, so it neither
+	// blocks startup nor counts towards readiness.
+	go func() {
+		stats, err := sm.GetDatabaseStats(context.Background())
+		if err != nil {
+			logger.WarnWithFields("Failed to get database stats",
+				utils.Field{Key: "error", Value: err.Error()},
+			)
+			return
+		}
+		logger.InfoWithFields("Database statistics",
+			utils.Field{Key: "repositories", Value: stats.RepositoryCount},
+			utils.Field{Key: "files", Value: stats.FileCount},
+			utils.Field{Key: "symbols", Value: stats.SymbolCount},
+			utils.Field{Key: "edges", Value: stats.EdgeCount},
+		)
+	}()
+
 	// Create API server
 	server := api.NewServer(db, serverConfig)
 
-	// Setup router with middleware
-	r := server.SetupRouter()
+	// Setup router with middleware and start serving API requests
+	gate.SetHandler(server.SetupRouter())
 
-	// Start server
-	address := cfg.API.Address()
-	logger.InfoWithFields("Starting CodeAtlas API server",
-		utils.Field{Key: "address", Value: address},
-		utils.Field{Key: "port", Value: cfg.API.Port},
-		utils.Field{Key: "host", Value: cfg.API.Host},
-	)
+	// Warm caches concurrently; /ready flips once the generations are loaded
+	// or the warm-up timeout cancels the load. Until a repository's generation
+	// is known its responses simply carry no validator. pg_prewarm reads whole
+	// HNSW indexes and runs best-effort in the background.
+	warmupCtx, cancelWarmup := context.WithTimeout(context.Background(), cfg.API.WarmupTimeout)
+	defer cancelWarmup()
+	gate.Warmup(warmupCtx, []api.WarmupTask{
+		{Name: "index_generations", Run: func(ctx context.Context) error {
+			return models.NewRepositoryRepository(db).LoadIndexGenerations(ctx)
+		}},
+		{Name: "prewarm_indexes", Background: true, Run: func(ctx context.Context) error {
+			warmed, err := models.PrewarmRelations(ctx, db, models.DefaultPrewarmRelations)
+			if warmed > 0 {
+				logger.InfoWithFields("Prewarmed indexes", utils.Field{Key: "relations", Value: warmed})
+			}
+			return err
+		}},
+	})
+	logger.Info("API server ready")
 
-	if err := r.Run(fmt.Sprintf(":%d", cfg.API.Port)); err != nil {
+	if err := <-serveErr; err != nil {
 		logger.ErrorWithFields("Failed to start server", err,
 			utils.Field{Key: "address", Value: address},
 		)
@@ -0,0 +1,236 @@
+package main
+
+import (
+	"context"
+	"database/sql"
+	"fmt"
+	"os"
+
+	"github.com/urfave/cli/v2"
+	"github.com/yourtionguo/CodeAtlas/internal/archive"
+	"github.com/yourtionguo/CodeAtlas/internal/utils"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+// dbFlag 是 export / import 共用的数据库连接参数，与 eval 一致。
+func dbFlag() cli.Flag {
+	return &cli.StringFlag{
+		Name:    "db",
+		Usage:   "PostgreSQL connection string (default: built from DB_* environment variables)",
+		EnvVars: []string{"DATABASE_URL", "DB_DSN"},
+	}
+}
+
+// openArchiveDB 直连 PostgreSQL。export / import 搬运的是数据库行，不经过 API server。
+func openArchiveDB(c *cli.Context) (*models.DB, error) {
+	dsn := c.String("db")
+	if dsn == "" {
+		dsn = fmt.Sprintf("host=%s port=%s user=%s password=%s dbname=%s sslmode=%s",
+			envOrEval("DB_HOST", "localhost"), envOrEval("DB_PORT", "5432"),
+			envOrEval("DB_USER", "codeatlas"), envOrEval("DB_PASSWORD", "codeatlas"),
+			envOrEval("DB_NAME", "codeatlas"), envOrEval("DB_SSLMODE", "disable"))
+	}
+	db, err := sql.Open("postgres", dsn)
+	if err != nil {
+		return nil, fmt.Errorf("open db: %w", err)
+	}
+	if err := db.Ping(); err != nil {
+		db.Close()
+		return nil, fmt.Errorf("ping db: %w", err)
+	}
+	return &models.DB{DB: db}, nil
+}
+
+// createExportCommand 创建仓库归档导出命令。
+func createExportCommand() *cli.Command {
+	return &cli.Command{
+		Name:  "export",
+		Usage: "Export one indexed repository to a snapshot archive",
+		Description: `Dump a repository's rows (files, symbols, edges, vectors, optionally AST)
+   from PostgreSQL into a versioned, checksummed archive that 'codeatlas import'
+   can bulk-load into another database without re-parsing or re-embedding.
+
+EXAMPLES:
+   # Export by repository name
+   codeatlas export --name my-project --output my-project.catlas
+
+   # Export by ID, including AST nodes
+   codeatlas export --repo-id <repo_id> --output repo.catlas --include-ast`,
+		Flags: []cli.Flag{
+			&cli.StringFlag{
+				Name:    "repo-id",
+				Aliases: []string{"r"},
+				Usage:   "Repository ID to export",
+			},
+			&cli.StringFlag{
+				Name:    "name",
+				Aliases: []string{"n"},
+				Usage:   "Repository name to export (alternative to --repo-id)",
+			},
+			&cli.StringFlag{
+				Name:     "output",
+				Aliases:  []string{"o"},
+				Usage:    "Archive file to write",
+				Required: true,
+			},
+			&cli.BoolFlag{
+				Name:  "include-ast",
+				Usage: "Also export AST nodes (usually the largest table)",
+			},
+			dbFlag(),
+			&cli.BoolFlag{
+				Name:    "verbose",
+				Aliases: []string{"v"},
+				Usage:   "Enable verbose output",
+			},
+		},
+		Action: runExport,
+	}
+}
+
+func runExport(c *cli.Context) error {
+	repoID := c.String("repo-id")
+	name := c.String("name")
+	if (repoID == "") == (name == "") {
+		return fmt.Errorf("exactly one of --repo-id or --name must be specified")
+	}
+	logger := utils.NewLogger(c.Bool("verbose"))
+
+	db, err := openArchiveDB(c)
+	if err != nil {
+		return err
+	}
+	defer db.Close()
+
+	ctx := context.Background()
+	if repoID == "" {
+		repo, err := models.NewRepositoryRepository(db).GetByName(ctx, name)
+		if err != nil {
+			return fmt.Errorf("failed to look up repository: %w", err)
+		}
+		if repo == nil {
+			return fmt.Errorf("repository not found: %s", name)
+		}
+		repoID = repo.RepoID
+	}
+
+	output := c.String("output")
+	logger.Info("Exporting repository %s to %s", repoID, output)
+	manifest, err := archive.ExportFile(ctx, db, repoID, output, archive.ExportOptions{
+		IncludeAST: c.Bool("include-ast"),
+	})
+	if err != nil {
+		return err
+	}
+
+	for _, t := range manifest.Tables {
+		logger.Info("  %-12s %10d rows %12d bytes", t.Name, t.Rows, t.Bytes)
+	}
+	logger.Info("Exported repository '%s' (schema version %d)", manifest.RepoName, manifest.SchemaVersion)
+	return nil
+}
+
+// createImportCommand 创建仓库归档导入命令。
+func createImportCommand() *cli.Command {
+	return &cli.Command{
+		Name:  "import",
+		Usage: "Bulk-load a snapshot archive written by 'codeatlas export'",
+		Description: `Load a repository archive into PostgreSQL in a single transaction with
+   COPY, verifying every table's checksum and row count; any mismatch rolls the
+   whole import back. Into an empty database, secondary indexes (including the
+   HNSW vector index) are dropped first and built once after the load.
+
+EXAMPLES:
+   # Seed a fresh database
+   codeatlas import --input my-project.catlas
+
+   # Replace an existing copy of the repository
+   codeatlas import --input my-project.catlas --replace
+
+   # Only print the archive manifest
+   codeatlas import --input my-project.catlas --dry-run`,
+		Flags: []cli.Flag{
+			&cli.StringFlag{
+				Name:     "input",
+				Aliases:  []string{"i"},
+				Usage:    "Archive file to load",
+				Required: true,
+			},
+			&cli.BoolFlag{
+				Name:  "replace",
+				Usage: "Replace a repository with the same ID or name instead of failing",
+			},
+			&cli.BoolFlag{
+				Name:  "defer-indexes",
+				Usage: "Drop and rebuild secondary indexes when the target tables are empty",
+				Value: true,
+			},
+			&cli.BoolFlag{
+				Name:  "dry-run",
+				Usage: "Validate the manifest and print it without touching the database",
+			},
+			dbFlag(),
+			&cli.BoolFlag{
+				Name:    "verbose",
+				Aliases: []string{"v"},
+				Usage:   "Enable verbose output",
+			},
+		},
+		Action: runImport,
+	}
+}
+
+func runImport(c *cli.Context) error {
+	input := c.String("input")
+	logger := utils.NewLogger(c.Bool("verbose"))
+
+	if c.Bool("dry-run") {
+		f, err := os.Open(input)
+		if err != nil {
+			return fmt.Errorf("failed to open archive: %w", err)
+		}
+		defer f.Close()
+		manifest, err := archive.ReadManifest(f)
+		if err != nil {
+			return err
+		}
+		logger.Info("Repository '%s' (%s), schema version %d, exported %s",
+			manifest.RepoName, manifest.RepoID, manifest.SchemaVersion, manifest.CreatedAt.Format("2006-01-02 15:04:05"))
+		for _, t := range manifest.Tables {
+			logger.Info("  %-12s %10d rows %12d bytes", t.Name, t.Rows, t.Bytes)
+		}
+		return nil
+	}
+
+	db, err := openArchiveDB(c)
+	if err != nil {
+		return err
+	}
+	defer db.Close()
+
+	ctx := context.Background()
+	if err := models.NewSchemaManager(db).InitializeSchema(ctx); err != nil {
+		return fmt.Errorf("failed to initialize database schema: %w", err)
+	}
+
+	logger.Info("Importing %s", input)
+	result, err := archive.ImportFile(ctx, db, input, archive.ImportOptions{
+		Replace:      c.Bool("replace"),
+		DeferIndexes: c.Bool("defer-indexes"),
+	})
+	if err != nil {
+		return err
+	}
+
+	for _, t := range result.Manifest.Tables {
+		logger.Info("  %-12s %10d rows", t.Name, t.Rows)
+	}
+	if result.Replaced {
+		logger.Info("Replaced the existing copy of the repository")
+	}
+	if result.RebuiltIndexes > 0 {
+		logger.Info("Rebuilt %d deferred indexes", result.RebuiltIndexes)
+	}
+	logger.Info("Imported repository '%s' in %v", result.Manifest.RepoName, result.Duration)
+	return nil
+}
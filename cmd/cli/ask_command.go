@@ -5,10 +5,11 @@ import (
 	"encoding/json"
 	"fmt"
 	"os"
-	"strings"
 	"time"
 
 	"github.com/urfave/cli/v2"
+	"github.com/yourtionguo/CodeAtlas/internal/qa"
+	"github.com/yourtionguo/CodeAtlas/internal/snapshot"
 	"github.com/yourtionguo/CodeAtlas/pkg/client"
 )
 
@@ -22,7 +23,10 @@ func createAskCommand() *cli.Command {
 		Name:  "ask",
 		Usage: "Ask a question and get assembled code context (prompt for LLMs)",
 		Description: `Performs a QA context query and outputs a Markdown prompt ready to paste into an LLM.
-The prompt includes relevant symbols with their 1-hop callers/callees.`,
+The prompt includes relevant symbols with their 1-hop callers/callees.
+
+With --snapshot the query runs against an offline snapshot written by
+'codeatlas index --snapshot' (keyword retrieval, no API server or database).`,
 		Flags: []cli.Flag{
 			&cli.StringFlag{
 				Name:     "question",
@@ -40,6 +44,7 @@ The prompt includes relevant symbols with their 1-hop callers/callees.`,
 			&cli.StringFlag{Name: "mode", Usage: "Retrieval mode: hybrid(default)|vector|keyword", Value: "hybrid"},
 			&cli.IntFlag{Name: "limit", Usage: "Top-K results", Value: 10},
 			&cli.BoolFlag{Name: "include-source", Usage: "Inline source code into prompt"},
+			&cli.StringFlag{Name: "snapshot", Usage: "Query an offline snapshot file instead of the API server"},
 			&cli.StringFlag{Name: "api-url", Usage: "API server URL (or CODEATLAS_API_URL env)"},
 			&cli.StringFlag{Name: "api-token", Usage: "API auth token (or CODEATLAS_API_TOKEN env)"},
 			&cli.StringFlag{Name: "output", Aliases: []string{"o"}, Usage: "Write prompt to file (default stdout)"},
@@ -52,6 +57,10 @@ The prompt includes relevant symbols with their 1-hop callers/callees.`,
 
 // executeAskCommand runs the ask command.
 func executeAskCommand(c *cli.Context) error {
+	if snapshotPath := c.String("snapshot"); snapshotPath != "" {
+		return executeAskSnapshot(c, snapshotPath)
+	}
+
 	apiURL := c.String("api-url")
 	if apiURL == "" {
 		apiURL = os.Getenv("CODEATLAS_API_URL")
@@ -70,17 +79,11 @@ func executeAskCommand(c *cli.Context) error {
 		Query:         c.String("question"),
 		RepoIDs:       c.StringSlice("repo"),
 		Language:      c.String("language"),
+		Kind:          parseKindFilter(c.String("kind")),
 		Mode:          c.String("mode"),
 		Limit:         c.Int("limit"),
 		IncludeSource: c.Bool("include-source"),
 	}
-	if k := c.String("kind"); k != "" {
-		req.Kind = strings.Split(k, ",")
-		// Trim whitespace from each kind
-		for i := range req.Kind {
-			req.Kind[i] = strings.TrimSpace(req.Kind[i])
-		}
-	}
 
 	ctx, cancel := context.WithTimeout(context.Background(), c.Duration("timeout"))
 	defer cancel()
@@ -90,6 +93,42 @@ func executeAskCommand(c *cli.Context) error {
 		return fmt.Errorf("ask failed: %w", err)
 	}
 
+	return writeAskOutput(c, resp, resp.Prompt)
+}
+
+// executeAskSnapshot 在离线快照上组装 prompt：检索与 1 跳扩展由 snapshot.Retriever
+// 完成，prompt 拼接复用 qa.Service，输出格式与 API 模式一致。
+// 快照不含源码，--include-source 在此模式下无效。
+func executeAskSnapshot(c *cli.Context, path string) error {
+	snap, err := snapshot.Open(path)
+	if err != nil {
+		return err
+	}
+	defer snap.Close()
+
+	svc := qa.NewService(snapshot.NewRetriever(snap, nil), nil, qa.DefaultPromptBuildOptions())
+
+	ctx, cancel := context.WithTimeout(context.Background(), c.Duration("timeout"))
+	defer cancel()
+
+	resp, err := svc.Ask(ctx, qa.AskRequest{
+		Query:         c.String("question"),
+		RepoIDs:       c.StringSlice("repo"),
+		Language:      c.String("language"),
+		Kind:          parseKindFilter(c.String("kind")),
+		Mode:          c.String("mode"),
+		Limit:         c.Int("limit"),
+		ExpandCallers: true,
+		ExpandCallees: true,
+	})
+	if err != nil {
+		return fmt.Errorf("ask failed: %w", err)
+	}
+	return writeAskOutput(c, resp, resp.Prompt)
+}
+
+// writeAskOutput writes either the full JSON response or only the prompt.
+func writeAskOutput(c *cli.Context, resp interface{}, prompt string) error {
 	if c.Bool("json") {
 		data, err := json.MarshalIndent(resp, "", "  ")
 		if err != nil {
@@ -101,8 +140,8 @@ func executeAskCommand(c *cli.Context) error {
 
 	output := c.String("output")
 	if output != "" {
-		return os.WriteFile(output, []byte(resp.Prompt), 0644)
+		return os.WriteFile(output, []byte(prompt), 0644)
 	}
-	fmt.Print(resp.Prompt)
+	fmt.Print(prompt)
 	return nil
 }
@@ -10,6 +10,7 @@ import (
 	"time"
 
 	"github.com/urfave/cli/v2"
+	"github.com/yourtionguo/CodeAtlas/internal/snapshot"
 	"github.com/yourtionguo/CodeAtlas/internal/utils"
 	"github.com/yourtionguo/CodeAtlas/pkg/client"
 )
@@ -41,6 +42,9 @@ EXAMPLES:
    # Limit traversal depth
    codeatlas impact --symbol abc-123 --depth 3
 
+   # Query an offline snapshot written by 'codeatlas index --snapshot'
+   codeatlas impact --symbol abc-123 --snapshot repo.snap
+
 ENVIRONMENT VARIABLES:
    CODEATLAS_API_URL        Default API server URL
    CODEATLAS_API_TOKEN      API authentication token`,
@@ -62,6 +66,10 @@ ENVIRONMENT VARIABLES:
 				Usage:   "Maximum hop count (default uses server default, typically 5)",
 				Value:   0,
 			},
+			&cli.StringFlag{
+				Name:  "snapshot",
+				Usage: "Query an offline snapshot file instead of the API server",
+			},
 			&cli.StringFlag{
 				Name:  "api-url",
 				Usage: "API server URL (can also use CODEATLAS_API_URL env var)",
@@ -97,6 +105,17 @@ func executeImpactCommand(c *cli.Context) error {
 		return fmt.Errorf("direction must be 'callees' or 'callers', got: %s", direction)
 	}
 
+	// 离线快照：不连 API / 数据库，直接在 mmap 的调用图上做 BFS
+	if snapshotPath := c.String("snapshot"); snapshotPath != "" {
+		startTime := time.Now()
+		resp, err := queryImpactSnapshot(snapshotPath, symbolID, direction, c.Int("depth"))
+		if err != nil {
+			return err
+		}
+		displayImpactTree(os.Stdout, resp, direction, time.Since(startTime))
+		return nil
+	}
+
 	// Get API URL from flag or environment
 	apiURL := c.String("api-url")
 	if apiURL == "" {
@@ -159,6 +178,37 @@ func executeImpactCommand(c *cli.Context) error {
 	return nil
 }
 
+// queryImpactSnapshot 在离线快照上执行多跳可达查询，结果转换为与 API 相同的响应结构。
+func queryImpactSnapshot(path, symbolID, direction string, depth int) (*client.TransitiveResponse, error) {
+	snap, err := snapshot.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer snap.Close()
+
+	reachable, usedDepth, err := snap.Transitive(symbolID, direction, depth)
+	if err != nil {
+		return nil, fmt.Errorf("failed to query transitive %s: %w", direction, err)
+	}
+
+	resp := &client.TransitiveResponse{
+		Symbols: make([]client.ReachableSymbol, 0, len(reachable)),
+		Total:   len(reachable),
+		Depth:   usedDepth,
+	}
+	for _, r := range reachable {
+		resp.Symbols = append(resp.Symbols, client.ReachableSymbol{
+			SymbolID:  r.SymbolID,
+			Name:      r.Name,
+			Kind:      r.Kind,
+			FilePath:  r.FilePath,
+			Signature: r.Signature,
+			Depth:     r.Depth,
+		})
+	}
+	return resp, nil
+}
+
 // displayImpactTree 把多跳可达集合按 depth 分组，以缩进树形式写入 w。
 //
 // 注：多跳 API 返回的是去重可达集合（每符号最短跳数），不是完整路径。
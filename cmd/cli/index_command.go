@@ -12,6 +12,7 @@ import (
 	"github.com/urfave/cli/v2"
 	"github.com/yourtionguo/CodeAtlas/internal/parser"
 	"github.com/yourtionguo/CodeAtlas/internal/schema"
+	"github.com/yourtionguo/CodeAtlas/internal/snapshot"
 	"github.com/yourtionguo/CodeAtlas/internal/utils"
 	"github.com/yourtionguo/CodeAtlas/pkg/client"
 )
@@ -41,15 +42,27 @@ EXAMPLES:
    # Index incrementally (only changed files)
    codeatlas index --path /path/to/repo --incremental
 
+   # Index a commit and keep the symbol/edge diff as commit-level history
+   codeatlas index --path /path/to/repo --incremental --commit $(git rev-parse HEAD) --history
+
    # Index without generating embeddings (faster)
    codeatlas index --path /path/to/repo --skip-vectors
 
+   # Index only the declarations of code under libs/ (besides third_party/, Pods/, ...)
+   codeatlas index --path /path/to/repo --api-surface "libs/"
+
    # Index with custom batch size and workers
    codeatlas index --path /path/to/repo --batch-size 50 --workers 8
 
    # Index from pre-parsed JSON output
    codeatlas index --input parsed-output.json --name my-project
 
+   # Write an offline snapshot only (no API server / database required)
+   codeatlas index --path /path/to/repo --snapshot repo.snap
+
+   # Index to the server and also write a snapshot
+   codeatlas index --path /path/to/repo --snapshot repo.snap --api-url http://localhost:8080
+
 ENVIRONMENT VARIABLES:
    CODEATLAS_API_URL        Default API server URL
    CODEATLAS_API_TOKEN      API authentication token
@@ -98,14 +111,38 @@ ENVIRONMENT VARIABLES:
 				Name:  "api-token",
 				Usage: "API authentication token (can also use CODEATLAS_API_TOKEN env var)",
 			},
+			&cli.StringFlag{
+				Name:  "snapshot",
+				Usage: "Also write an offline snapshot file for database-free impact/search/ask (API URL becomes optional)",
+			},
 			&cli.BoolFlag{
 				Name:  "incremental",
 				Usage: "Only process changed files (based on checksums)",
 			},
+			&cli.BoolFlag{
+				Name:  "history",
+				Usage: "Record the symbol/edge diff against the previous commit as history (requires --commit)",
+			},
+			&cli.BoolFlag{
+				Name:  "bulk-load",
+				Usage: "Drop secondary indexes of empty tables during the load and rebuild them in parallel afterwards (first import of a large repository)",
+			},
+			&cli.IntFlag{
+				Name:  "error-budget",
+				Usage: "Stop indexing early once more than this many errors occur (0 = unlimited)",
+			},
 			&cli.BoolFlag{
 				Name:  "skip-vectors",
 				Usage: "Skip embedding generation (faster indexing)",
 			},
+			&cli.StringSliceFlag{
+				Name:  "api-surface",
+				Usage: "Path pattern of third-party code indexed for declarations only (can be specified multiple times)",
+			},
+			&cli.BoolFlag{
+				Name:  "no-api-surface-detect",
+				Usage: "Do not treat common vendor layouts (third_party/, Pods/, Carthage/, ...) as API-surface-only",
+			},
 			&cli.IntFlag{
 				Name:  "batch-size",
 				Usage: "Batch size for processing",
@@ -149,11 +186,17 @@ func executeIndexCommand(c *cli.Context) error {
 		return fmt.Errorf("cannot specify both --path and --input")
 	}
 
+	if c.Bool("history") && c.String("commit") == "" {
+		return fmt.Errorf("--history requires --commit")
+	}
+
 	// Get API URL from flag or environment
+	// 指定 --snapshot 时允许不连服务端：只写离线快照
+	snapshotPath := c.String("snapshot")
 	apiURL := c.String("api-url")
 	if apiURL == "" {
 		apiURL = os.Getenv("CODEATLAS_API_URL")
-		if apiURL == "" {
+		if apiURL == "" && snapshotPath == "" {
 			return fmt.Errorf("API URL must be specified via --api-url flag or CODEATLAS_API_URL environment variable")
 		}
 	}
@@ -195,13 +238,33 @@ func executeIndexCommand(c *cli.Context) error {
 	} else {
 		// Parse the repository
 		logger.Info("Parsing repository at: %s", path)
-		parseOutput, err = parseRepository(path, c.Int("workers"), verbose, logger)
+		apiSurface := parser.NewAPISurfaceFilter(c.StringSlice("api-surface"), !c.Bool("no-api-surface-detect"))
+		parseOutput, err = parseRepository(path, c.Int("workers"), apiSurface, verbose, logger)
 		if err != nil {
 			return fmt.Errorf("failed to parse repository: %w", err)
 		}
 		logger.Info("Parsed %d files successfully", parseOutput.Metadata.SuccessCount)
 	}
 
+	if snapshotPath != "" {
+		logger.Info("Writing snapshot to: %s", snapshotPath)
+		snapStart := time.Now()
+		err := snapshot.WriteFile(snapshotPath, &parseOutput, snapshot.WriteOptions{
+			RepoID:     c.String("repo-id"),
+			RepoName:   repoName,
+			CommitHash: c.String("commit"),
+		})
+		if err != nil {
+			return fmt.Errorf("failed to write snapshot: %w", err)
+		}
+		logger.Info("Snapshot written in %v", time.Since(snapStart))
+
+		if apiURL == "" {
+			logger.Info("No API URL configured, skipping server indexing")
+			return nil
+		}
+	}
+
 	// Create API client
 	clientOpts := []client.ClientOption{
 		client.WithTimeout(c.Duration("timeout")),
@@ -231,6 +294,9 @@ func executeIndexCommand(c *cli.Context) error {
 		ParseOutput: parseOutput,
 		Options: client.IndexOptions{
 			Incremental:    c.Bool("incremental"),
+			History:        c.Bool("history"),
+			BulkLoad:       c.Bool("bulk-load"),
+			ErrorBudget:    c.Int("error-budget"),
 			SkipVectors:    c.Bool("skip-vectors"),
 			BatchSize:      c.Int("batch-size"),
 			WorkerCount:    c.Int("workers"),
@@ -263,7 +329,7 @@ func executeIndexCommand(c *cli.Context) error {
 }
 
 // parseRepository parses a repository and returns the parse output
-func parseRepository(path string, workers int, verbose bool, logger *utils.Logger) (schema.ParseOutput, error) {
+func parseRepository(path string, workers int, apiSurface *parser.APISurfaceFilter, verbose bool, logger *utils.Logger) (schema.ParseOutput, error) {
 	// Check if directory exists
 	if _, err := os.Stat(path); err != nil {
 		return schema.ParseOutput{}, fmt.Errorf("path does not exist: %w", err)
@@ -283,6 +349,7 @@ func parseRepository(path string, workers int, verbose bool, logger *utils.Logge
 
 	// Scan directory
 	scanner := parser.NewFileScanner(path, filter)
+	scanner.SetAPISurfaceFilter(apiSurface)
 	files, err := scanner.Scan()
 	if err != nil {
 		return schema.ParseOutput{}, fmt.Errorf("failed to scan directory: %w", err)
@@ -293,35 +360,40 @@ func parseRepository(path string, workers int, verbose bool, logger *utils.Logge
 	}
 
 	logger.Info("Found %d files to parse", len(files))
+	if n := countAPIOnly(files); n > 0 {
+		logger.Info("%d third-party files are indexed for their declarations only (--api-surface \"!<dir>/\" or --no-api-surface-detect indexes them fully)", n)
+	}
 
-	// Initialize Tree-sitter parser
-	tsParser, err := parser.NewTreeSitterParser()
-	if err != nil {
-		return schema.ParseOutput{}, fmt.Errorf("failed to initialize Tree-sitter parser: %w", err)
+	// 内容相同的文件只解析一次，解析后再分发到各路径（见 parser.GroupByContent）
+	unique, copies := parser.GroupByContent(files)
+	if dup := len(files) - len(unique); dup > 0 {
+		logger.Info("%d files share content with another path, parsing %d unique files", dup, len(unique))
 	}
 
 	// Optimize worker count for small file sets
-	if workers == runtime.NumCPU() && len(files) < 50 {
-		workers = parser.OptimalWorkerCount(len(files))
-		logger.Debug("Optimized worker count to %d for %d files", workers, len(files))
+	if workers == runtime.NumCPU() && len(unique) < 50 {
+		workers = parser.OptimalWorkerCount(len(unique))
+		logger.Debug("Optimized worker count to %d for %d files", workers, len(unique))
 	}
 
-	// Create parser pool
-	pool := parser.NewParserPool(workers, tsParser)
-	pool.SetVerbose(verbose)
-
+	var progress parser.ProgressLogger
 	if verbose {
-		pool.SetProgressLogger(&parser.DefaultProgressLogger{})
+		progress = &parser.DefaultProgressLogger{}
 	}
 
 	logger.Info("Parsing with %d workers", workers)
 	startTime := time.Now()
 
 	// Process files
-	parsedFiles, parseErrors := pool.Process(files)
+	parsed, err := parseFiles(unique, workers, progress)
+	if err != nil {
+		return schema.ParseOutput{}, err
+	}
+	expandCopies(parsed, copies)
+	sortShardResult(parsed, files)
 
 	parseTime := time.Since(startTime)
-	logger.Info("Parsed %d files in %v", len(parsedFiles), parseTime)
+	logger.Info("Parsed %d files in %v", len(parsed.Files), parseTime)
 
 	// Map to schema
 	mapper := schema.NewSchemaMapper()
@@ -330,11 +402,12 @@ func parseRepository(path string, workers int, verbose bool, logger *utils.Logge
 	var mappingErrors []schema.ParseError
 
 	// 第一遍：收集符号
-	for _, parsedFile := range parsedFiles {
-		schemaFile, err := mapper.CollectSymbols(parsedFile)
+	for i := range parsed.Files {
+		preparedFile := &parsed.Files[i]
+		schemaFile, err := mapper.CollectPrepared(preparedFile)
 		if err != nil {
 			mappingErrors = append(mappingErrors, schema.ParseError{
-				File:    parsedFile.Path,
+				File:    preparedFile.Path,
 				Message: err.Error(),
 				Type:    schema.ErrorMapping,
 			})
@@ -352,23 +425,7 @@ func parseRepository(path string, workers int, verbose bool, logger *utils.Logge
 	allEdges = resolvedEdges
 
 	// Collect all errors
-	var allErrors []schema.ParseError
-	for _, err := range parseErrors {
-		if detailedErr, ok := err.(*parser.DetailedParseError); ok {
-			allErrors = append(allErrors, schema.ParseError{
-				File:    detailedErr.File,
-				Line:    detailedErr.Line,
-				Column:  detailedErr.Column,
-				Message: detailedErr.Message,
-				Type:    schema.ErrorType(detailedErr.Type),
-			})
-		} else {
-			allErrors = append(allErrors, schema.ParseError{
-				Message: err.Error(),
-				Type:    schema.ErrorParse,
-			})
-		}
-	}
+	allErrors := append([]schema.ParseError(nil), parsed.Errors...)
 	allErrors = append(allErrors, mappingErrors...)
 
 	// Create output
@@ -40,11 +40,14 @@ func main() {
 		Version: Version,
 		Commands: []*cli.Command{
 			createParseCommand(),
+			createParseShardCommand(),
 			createIndexCommand(),
 			createSearchCommand(),
 			createImpactCommand(),
 			createAskCommand(),
 			createEvalCommand(),
+			createExportCommand(),
+			createImportCommand(),
 			{
 				Name:  "upload",
 				Usage: "Upload repository to CodeAtlas server",
@@ -1,6 +1,7 @@
 package main
 
 import (
+	"context"
 	"encoding/json"
 	"fmt"
 	"os"
@@ -22,11 +23,19 @@ type ParseCommand struct {
 	File          string
 	Language      string
 	Workers       int
+	Shards        int
 	Semantic      bool
 	Verbose       bool
 	IgnoreFile    string
 	IgnorePattern []string
 	NoIgnore      bool
+	// APISurface are extra path patterns parsed for declarations only;
+	// NoAPISurfaceDetect disables the default vendor layouts
+	APISurface         []string
+	NoAPISurfaceDetect bool
+
+	// runShard parses one shard; nil runs shards as child processes
+	runShard shardRunner
 }
 
 // createParseCommand creates the parse CLI command
@@ -67,9 +76,13 @@ EXAMPLES:
    # Parse with custom worker count
    codeatlas parse --path /path/to/repo --workers 8
 
+   # Split parsing across 8 child processes (output is identical to --shards 1)
+   codeatlas parse --path /path/to/repo --workers 128 --shards 8
+
 ENVIRONMENT VARIABLES:
    CODEATLAS_LLM_API_KEY    API key for LLM-based semantic enhancement (optional)
    CODEATLAS_WORKERS        Default number of concurrent workers (default: number of CPUs)
+   CODEATLAS_PARSE_SHARDS   Default number of parse processes (default: 1)
    CODEATLAS_VERBOSE        Enable verbose logging (true/false)`,
 		Flags: []cli.Flag{
 			&cli.StringFlag{
@@ -98,6 +111,11 @@ ENVIRONMENT VARIABLES:
 				Usage:   "Number of concurrent workers",
 				Value:   runtime.NumCPU(),
 			},
+			&cli.IntFlag{
+				Name:  "shards",
+				Usage: "Number of child processes to split parsing across; workers are divided among them (0 = one per 16 CPUs)",
+				Value: 1,
+			},
 			&cli.BoolFlag{
 				Name:  "semantic",
 				Usage: "Enable LLM-based semantic enhancement (requires CODEATLAS_LLM_API_KEY)",
@@ -119,6 +137,14 @@ ENVIRONMENT VARIABLES:
 				Name:  "no-ignore",
 				Usage: "Disable all ignore rules (parse all files)",
 			},
+			&cli.StringSliceFlag{
+				Name:  "api-surface",
+				Usage: "Path pattern of third-party code parsed for declarations only (can be specified multiple times)",
+			},
+			&cli.BoolFlag{
+				Name:  "no-api-surface-detect",
+				Usage: "Do not treat common vendor layouts (third_party/, Pods/, Carthage/, ...) as API-surface-only",
+			},
 		},
 		Action: executeParseCommand,
 	}
@@ -137,6 +163,18 @@ func executeParseCommand(c *cli.Context) error {
 		}
 	}
 
+	// Get shards from flag or environment variable
+	shards := c.Int("shards")
+	if !c.IsSet("shards") {
+		if envShards := os.Getenv("CODEATLAS_PARSE_SHARDS"); envShards != "" {
+			fmt.Sscanf(envShards, "%d", &shards)
+		}
+	}
+	if shards <= 0 {
+		// ParserPool 单进程最多 16 个 worker
+		shards = (runtime.NumCPU() + 15) / 16
+	}
+
 	// Get verbose from flag or environment variable
 	verbose := c.Bool("verbose")
 	if !verbose {
@@ -159,11 +197,15 @@ func executeParseCommand(c *cli.Context) error {
 		File:          c.String("file"),
 		Language:      c.String("language"),
 		Workers:       workers,
+		Shards:        shards,
 		Semantic:      semantic,
 		Verbose:       verbose,
 		IgnoreFile:    c.String("ignore-file"),
 		IgnorePattern: c.StringSlice("ignore-pattern"),
 		NoIgnore:      c.Bool("no-ignore"),
+
+		APISurface:         c.StringSlice("api-surface"),
+		NoAPISurfaceDetect: c.Bool("no-api-surface-detect"),
 	}
 
 	return cmd.Execute()
@@ -236,37 +278,54 @@ func (cmd *ParseCommand) Execute() error {
 	}
 
 	logger.Info("Found %d files to parse", len(files))
+	if n := countAPIOnly(files); n > 0 {
+		logger.Info("%d third-party files are parsed for their declarations only (--api-surface \"!<dir>/\" or --no-api-surface-detect parses them fully)", n)
+	}
 
-	// Initialize Tree-sitter parser
-	tsParser, err := parser.NewTreeSitterParser()
-	if err != nil {
-		return fmt.Errorf("failed to initialize Tree-sitter parser: %w", err)
+	// 内容相同的文件（vendored / 多平台副本）只解析一次，解析后再分发到各路径
+	unique, copies := parser.GroupByContent(files)
+	if dup := len(files) - len(unique); dup > 0 {
+		logger.Info("%d files share content with another path, parsing %d unique files", dup, len(unique))
 	}
 
 	// Optimize worker count if not explicitly set
 	workers := cmd.Workers
-	if workers == runtime.NumCPU() && len(files) < 50 {
+	if workers == runtime.NumCPU() && len(unique) < 50 {
 		// Use optimal worker count for small file sets
-		workers = parser.OptimalWorkerCount(len(files))
-		logger.Debug("Optimized worker count from %d to %d for %d files", cmd.Workers, workers, len(files))
-	}
-
-	// Create parser pool
-	pool := parser.NewParserPool(workers, tsParser)
-	pool.SetVerbose(cmd.Verbose)
-
-	if cmd.Verbose {
-		pool.SetProgressLogger(&parser.DefaultProgressLogger{})
+		workers = parser.OptimalWorkerCount(len(unique))
+		logger.Debug("Optimized worker count from %d to %d for %d files", cmd.Workers, workers, len(unique))
 	}
 
 	logger.Info("Starting parsing with %d workers", cmd.Workers)
 	startTime := time.Now()
 
-	// Process files
-	parsedFiles, parseErrors := pool.Process(files)
+	// Process files, in child processes when sharded
+	var parsed *shardResult
+	if cmd.Shards > 1 && len(unique) > 1 {
+		run := cmd.runShard
+		if run == nil {
+			run = execShardRunner
+		}
+		parsed, err = parseSharded(context.Background(), unique, cmd.Shards, workers, run, logger)
+		if err != nil {
+			return fmt.Errorf("failed to parse files: %w", err)
+		}
+	} else {
+		var progress parser.ProgressLogger
+		if cmd.Verbose {
+			progress = &parser.DefaultProgressLogger{}
+		}
+		parsed, err = parseFiles(unique, workers, progress)
+		if err != nil {
+			return err
+		}
+	}
+	expandCopies(parsed, copies)
+	// 按扫描顺序合并：符号收集与边消解的结果与分片数、完成顺序无关
+	sortShardResult(parsed, files)
 
 	parseTime := time.Since(startTime)
-	logger.Info("Parsed %d files successfully, %d errors in %v", len(parsedFiles), len(parseErrors), parseTime)
+	logger.Info("Parsed %d files successfully, %d errors in %v", len(parsed.Files), len(parsed.Errors), parseTime)
 	logger.Debug("Average time per file: %v", parseTime/time.Duration(len(files)))
 
 	// Map to schema
@@ -274,14 +333,15 @@ func (cmd *ParseCommand) Execute() error {
 	var schemaFiles []schema.File
 	var mappingErrors []schema.ParseError
 
-	logger.Debug("Starting schema mapping for %d files", len(parsedFiles))
+	logger.Debug("Starting schema mapping for %d files", len(parsed.Files))
 	mapStartTime := time.Now()
 
 	// 第一遍：收集所有文件的符号 + import 关系
-	for i, parsedFile := range parsedFiles {
-		logger.Debug("[%d/%d] Mapping file: %s", i+1, len(parsedFiles), parsedFile.Path)
+	for i := range parsed.Files {
+		parsedFile := &parsed.Files[i]
+		logger.Debug("[%d/%d] Mapping file: %s", i+1, len(parsed.Files), parsedFile.Path)
 
-		schemaFile, err := mapper.CollectSymbols(parsedFile)
+		schemaFile, err := mapper.CollectPrepared(parsedFile)
 		if err != nil {
 			mappingErrors = append(mappingErrors, schema.ParseError{
 				File:    parsedFile.Path,
@@ -307,25 +367,8 @@ func (cmd *ParseCommand) Execute() error {
 	logger.Debug("Schema mapping completed in %v", mapTime)
 
 	// Collect all errors with detailed information
-	var allErrors []schema.ParseError
-	for _, err := range parseErrors {
-		// Check if it's a DetailedParseError
-		if detailedErr, ok := err.(*parser.DetailedParseError); ok {
-			allErrors = append(allErrors, schema.ParseError{
-				File:    detailedErr.File,
-				Line:    detailedErr.Line,
-				Column:  detailedErr.Column,
-				Message: detailedErr.Message,
-				Type:    schema.ErrorType(detailedErr.Type),
-			})
-		} else {
-			// Generic error
-			allErrors = append(allErrors, schema.ParseError{
-				Message: err.Error(),
-				Type:    schema.ErrorParse,
-			})
-		}
-	}
+	parseErrors := parsed.Errors
+	allErrors := append([]schema.ParseError(nil), parseErrors...)
 	allErrors = append(allErrors, mappingErrors...)
 
 	logger.Debug("Total errors collected: %d (%d parse errors, %d mapping errors)",
@@ -374,7 +417,7 @@ func (cmd *ParseCommand) Execute() error {
 	// Clear large data structures to help GC
 	schemaFiles = nil
 	allEdges = nil
-	parsedFiles = nil
+	parsed = nil
 	runtime.GC()
 
 	// Print summary
@@ -493,6 +536,7 @@ func (cmd *ParseCommand) scanDirectory(logger *utils.Logger) ([]parser.ScannedFi
 
 	// Create file scanner
 	scanner := parser.NewFileScanner(cmd.Path, filter)
+	scanner.SetAPISurfaceFilter(parser.NewAPISurfaceFilter(cmd.APISurface, !cmd.NoAPISurfaceDetect))
 
 	// Apply language filter if specified
 	if cmd.Language != "" {
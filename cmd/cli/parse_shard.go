@@ -0,0 +1,328 @@
+package main
+
+import (
+	"bytes"
+	"context"
+	"encoding/json"
+	"fmt"
+	"io"
+	"os"
+	"os/exec"
+	"sort"
+	"strconv"
+	"sync"
+
+	"github.com/urfave/cli/v2"
+	"github.com/yourtionguo/CodeAtlas/internal/parser"
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+	"github.com/yourtionguo/CodeAtlas/internal/utils"
+)
+
+// parseShardCommandName is the hidden subcommand a parse shard child runs
+const parseShardCommandName = "parse-shard"
+
+// shardResult is what one parse shard hands back to the parent: files reduced
+// by SchemaMapper.PrepareFile (no Tree-sitter trees) plus the parse errors
+type shardResult struct {
+	Files  []schema.PreparedFile `json:"files"`
+	Errors []schema.ParseError   `json:"errors,omitempty"`
+}
+
+// shardRunner parses one shard's files, typically in a child process
+type shardRunner func(ctx context.Context, shard int, files []parser.ScannedFile, workers int) (*shardResult, error)
+
+// createParseShardCommand creates the hidden command run by parse shard child
+// processes. It reads a JSON array of scanned files on stdin and writes a
+// shardResult on stdout; all logging goes to stderr.
+func createParseShardCommand() *cli.Command {
+	return &cli.Command{
+		Name:   parseShardCommandName,
+		Usage:  "Internal: parse one shard for `codeatlas parse --shards`",
+		Hidden: true,
+		Flags: []cli.Flag{
+			&cli.IntFlag{
+				Name:  "workers",
+				Usage: "Number of concurrent workers in this shard",
+				Value: 1,
+			},
+		},
+		Action: func(c *cli.Context) error {
+			return runParseShard(os.Stdin, os.Stdout, c.Int("workers"))
+		},
+	}
+}
+
+// runParseShard is the body of a parse shard child: stdin → parse → stdout
+func runParseShard(r io.Reader, w io.Writer, workers int) error {
+	var files []parser.ScannedFile
+	if err := json.NewDecoder(r).Decode(&files); err != nil {
+		return fmt.Errorf("failed to read shard file list: %w", err)
+	}
+	result, err := parseFiles(files, workers, nil)
+	if err != nil {
+		return err
+	}
+	if err := json.NewEncoder(w).Encode(result); err != nil {
+		return fmt.Errorf("failed to write shard result: %w", err)
+	}
+	return nil
+}
+
+// parseFiles parses files with a ParserPool and reduces each result with
+// PrepareFile, releasing the Tree-sitter trees as it goes. progress may be nil.
+func parseFiles(files []parser.ScannedFile, workers int, progress parser.ProgressLogger) (*shardResult, error) {
+	tsParser, err := parser.NewTreeSitterParser()
+	if err != nil {
+		return nil, fmt.Errorf("failed to initialize Tree-sitter parser: %w", err)
+	}
+
+	pool := parser.NewParserPool(workers, tsParser)
+	if progress != nil {
+		pool.SetVerbose(true)
+		pool.SetProgressLogger(progress)
+	}
+	parsedFiles, parseErrors := pool.Process(files)
+
+	// PrepareFile 不修改 mapper 状态，这里只借用 mapASTNodes
+	mapper := schema.NewSchemaMapper()
+	result := &shardResult{Files: make([]schema.PreparedFile, 0, len(parsedFiles))}
+	for i, parsedFile := range parsedFiles {
+		result.Files = append(result.Files, *mapper.PrepareFile(parsedFile))
+		parsedFiles[i] = nil
+	}
+	for _, err := range parseErrors {
+		result.Errors = append(result.Errors, toParseError(err))
+	}
+	return result, nil
+}
+
+// toParseError converts a parser error into the output error format
+func toParseError(err error) schema.ParseError {
+	// Check if it's a DetailedParseError
+	if detailedErr, ok := err.(*parser.DetailedParseError); ok {
+		return schema.ParseError{
+			File:    detailedErr.File,
+			Line:    detailedErr.Line,
+			Column:  detailedErr.Column,
+			Message: detailedErr.Message,
+			Type:    schema.ErrorType(detailedErr.Type),
+		}
+	}
+	// Generic error
+	return schema.ParseError{
+		Message: err.Error(),
+		Type:    schema.ErrorParse,
+	}
+}
+
+// assignShards splits files into at most n shards balanced by total size
+// (largest file first onto the lightest shard). The assignment depends only on
+// the input, and every shard keeps its files in scan order.
+func assignShards(files []parser.ScannedFile, n int) [][]parser.ScannedFile {
+	if n > len(files) {
+		n = len(files)
+	}
+	if n <= 1 {
+		return [][]parser.ScannedFile{files}
+	}
+
+	order := make([]int, len(files))
+	for i := range order {
+		order[i] = i
+	}
+	sort.SliceStable(order, func(a, b int) bool {
+		return files[order[a]].Size > files[order[b]].Size
+	})
+
+	owner := make([]int, len(files))
+	load := make([]int64, n)
+	for _, i := range order {
+		lightest := 0
+		for s := 1; s < n; s++ {
+			if load[s] < load[lightest] {
+				lightest = s
+			}
+		}
+		owner[i] = lightest
+		// 空文件也计 1，避免大量空文件全部落在同一分片
+		load[lightest] += files[i].Size + 1
+	}
+
+	shards := make([][]parser.ScannedFile, n)
+	for i, f := range files {
+		shards[owner[i]] = append(shards[owner[i]], f)
+	}
+	return shards
+}
+
+// parseSharded runs every shard through run concurrently and merges the
+// results. Any shard failure cancels the others and fails the parse: a merged
+// output missing a shard would silently drop files and edges.
+func parseSharded(ctx context.Context, files []parser.ScannedFile, shards, workers int, run shardRunner, logger *utils.Logger) (*shardResult, error) {
+	parts := assignShards(files, shards)
+	perShard := workers / len(parts)
+	if perShard < 1 {
+		perShard = 1
+	}
+	logger.Info("Parsing in %d shard processes with %d workers each", len(parts), perShard)
+
+	ctx, cancel := context.WithCancel(ctx)
+	defer cancel()
+
+	results := make([]*shardResult, len(parts))
+	var (
+		mu       sync.Mutex
+		firstErr error
+		wg       sync.WaitGroup
+	)
+	for i, part := range parts {
+		wg.Add(1)
+		go func(i int, part []parser.ScannedFile) {
+			defer wg.Done()
+			res, err := run(ctx, i, part, perShard)
+			if err != nil {
+				// 只记录第一个失败：其余分片随后因取消而失败，不是根因
+				mu.Lock()
+				if firstErr == nil {
+					firstErr = fmt.Errorf("shard %d/%d: %w", i+1, len(parts), err)
+					cancel()
+				}
+				mu.Unlock()
+				return
+			}
+			logger.Debug("Shard %d/%d parsed %d files, %d errors", i+1, len(parts), len(res.Files), len(res.Errors))
+			results[i] = res
+		}(i, part)
+	}
+	wg.Wait()
+
+	if firstErr != nil {
+		return nil, firstErr
+	}
+
+	merged := &shardResult{Files: make([]schema.PreparedFile, 0, len(files))}
+	for _, res := range results {
+		merged.Files = append(merged.Files, res.Files...)
+		merged.Errors = append(merged.Errors, res.Errors...)
+	}
+	return merged, nil
+}
+
+// execShardRunner runs each shard as a child process of the current
+// executable (`codeatlas parse-shard`), so every shard has its own cgo heap and
+// Go GC instead of sharing one huge process
+func execShardRunner(ctx context.Context, shard int, files []parser.ScannedFile, workers int) (*shardResult, error) {
+	exe, err := os.Executable()
+	if err != nil {
+		return nil, fmt.Errorf("failed to locate executable: %w", err)
+	}
+
+	input, err := json.Marshal(files)
+	if err != nil {
+		return nil, fmt.Errorf("failed to encode file list: %w", err)
+	}
+
+	child := exec.CommandContext(ctx, exe, parseShardCommandName, "--workers", strconv.Itoa(workers))
+	child.Stdin = bytes.NewReader(input)
+	child.Stderr = os.Stderr
+	stdout, err := child.StdoutPipe()
+	if err != nil {
+		return nil, err
+	}
+	if err := child.Start(); err != nil {
+		return nil, fmt.Errorf("failed to start shard process: %w", err)
+	}
+
+	var result shardResult
+	decodeErr := json.NewDecoder(stdout).Decode(&result)
+	// 读完再 Wait：Wait 会关闭管道
+	io.Copy(io.Discard, stdout)
+	if err := child.Wait(); err != nil {
+		return nil, fmt.Errorf("shard process failed: %w", err)
+	}
+	if decodeErr != nil {
+		return nil, fmt.Errorf("failed to decode shard result: %w", decodeErr)
+	}
+	return &result, nil
+}
+
+// expandCopies adds a prepared copy for every path whose content matched a
+// parsed canonical file (see parser.GroupByContent) and returns how many were
+// added. Copies of a file that failed to parse fail with it: each gets one
+// error mirroring the canonical file's first error, so no path goes missing
+// from the output without a trace.
+func expandCopies(result *shardResult, copies map[string][]parser.ScannedFile) int {
+	if len(copies) == 0 {
+		return 0
+	}
+	// PrepareCopy 不修改 mapper 状态
+	mapper := schema.NewSchemaMapper()
+	added := 0
+	prepared := make(map[string]bool, len(result.Files))
+	for i, n := 0, len(result.Files); i < n; i++ {
+		prepared[result.Files[i].Path] = true
+		for _, c := range copies[result.Files[i].Path] {
+			result.Files = append(result.Files, *mapper.PrepareCopy(&result.Files[i], c.Path))
+			added++
+		}
+	}
+
+	failed := make(map[string]bool)
+	for i, n := 0, len(result.Errors); i < n; i++ {
+		canonical := result.Errors[i]
+		if prepared[canonical.File] || failed[canonical.File] {
+			continue
+		}
+		failed[canonical.File] = true
+		for _, c := range copies[canonical.File] {
+			mirrored := canonical
+			mirrored.File = c.Path
+			mirrored.Message = fmt.Sprintf("%s (same content as %s)", canonical.Message, canonical.File)
+			result.Errors = append(result.Errors, mirrored)
+		}
+	}
+	return added
+}
+
+// countAPIOnly returns how many scanned files belong to the API-surface tier
+func countAPIOnly(files []parser.ScannedFile) int {
+	n := 0
+	for _, f := range files {
+		if f.APIOnly {
+			n++
+		}
+	}
+	return n
+}
+
+// sortShardResult puts files and errors into scan order, so the merged output
+// does not depend on worker or shard completion order
+func sortShardResult(result *shardResult, files []parser.ScannedFile) {
+	rank := make(map[string]int, len(files))
+	for i, f := range files {
+		rank[f.Path] = i
+	}
+	rankOf := func(path string) int {
+		if r, ok := rank[path]; ok {
+			return r
+		}
+		return len(files)
+	}
+
+	sort.SliceStable(result.Files, func(i, j int) bool {
+		return rankOf(result.Files[i].Path) < rankOf(result.Files[j].Path)
+	})
+	sort.SliceStable(result.Errors, func(i, j int) bool {
+		a, b := result.Errors[i], result.Errors[j]
+		if ra, rb := rankOf(a.File), rankOf(b.File); ra != rb {
+			return ra < rb
+		}
+		if a.Line != b.Line {
+			return a.Line < b.Line
+		}
+		if a.Column != b.Column {
+			return a.Column < b.Column
+		}
+		return a.Message < b.Message
+	})
+}
@@ -0,0 +1,205 @@
+package main
+
+import (
+	"bytes"
+	"context"
+	"encoding/json"
+	"errors"
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/yourtionguo/CodeAtlas/internal/parser"
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+)
+
+// inProcessShardRunner 走与子进程相同的 JSON 协议（runParseShard），但不 fork
+func inProcessShardRunner(ctx context.Context, shard int, files []parser.ScannedFile, workers int) (*shardResult, error) {
+	input, err := json.Marshal(files)
+	if err != nil {
+		return nil, err
+	}
+	var out bytes.Buffer
+	if err := runParseShard(bytes.NewReader(input), &out, workers); err != nil {
+		return nil, err
+	}
+	var result shardResult
+	if err := json.Unmarshal(out.Bytes(), &result); err != nil {
+		return nil, err
+	}
+	return &result, nil
+}
+
+func writeShardFixture(t *testing.T) string {
+	t.Helper()
+	dir := t.TempDir()
+	fixtures := map[string]string{
+		"main.go": `package main
+
+import "fmt"
+
+func main() {
+	fmt.Println(helper())
+	run()
+}
+`,
+		"helper.go": `package main
+
+// helper returns a greeting
+func helper() string { return format("hi") }
+
+func format(s string) string { return s + "!" }
+`,
+		"pkg/run.go": `package main
+
+func run() { helper() }
+`,
+		"tools/util.py": `import os
+
+def util():
+    return os.getcwd()
+
+class Tool:
+    def run(self):
+        return util()
+`,
+		"web/app.js": `import { util } from './lib'
+
+export function app() { return util() }
+`,
+	}
+	for name, content := range fixtures {
+		path := filepath.Join(dir, name)
+		require.NoError(t, os.MkdirAll(filepath.Dir(path), 0o755))
+		require.NoError(t, os.WriteFile(path, []byte(content), 0o644))
+	}
+	return dir
+}
+
+// runParse 执行 parse 并返回去掉时间戳后的输出
+func runParse(t *testing.T, dir string, shards int, run shardRunner) []byte {
+	t.Helper()
+	outPath := filepath.Join(t.TempDir(), "out.json")
+	cmd := &ParseCommand{
+		Path:     dir,
+		Output:   outPath,
+		Workers:  4,
+		Shards:   shards,
+		NoIgnore: true,
+		runShard: run,
+	}
+	require.NoError(t, cmd.Execute())
+
+	data, err := os.ReadFile(outPath)
+	require.NoError(t, err)
+	var output schema.ParseOutput
+	require.NoError(t, json.Unmarshal(data, &output))
+	output.Metadata.Timestamp = time.Time{}
+	normalized, err := json.MarshalIndent(output, "", "  ")
+	require.NoError(t, err)
+	return normalized
+}
+
+func TestAssignShards(t *testing.T) {
+	files := []parser.ScannedFile{
+		{Path: "a", Size: 900},
+		{Path: "b", Size: 100},
+		{Path: "c", Size: 500},
+		{Path: "d", Size: 400},
+		{Path: "e", Size: 0},
+		{Path: "f", Size: 0},
+	}
+
+	shards := assignShards(files, 2)
+	require.Len(t, shards, 2)
+
+	seen := make(map[string]int)
+	var loads []int64
+	for _, shard := range shards {
+		var load int64
+		for i, f := range shard {
+			seen[f.Path]++
+			load += f.Size
+			if i > 0 {
+				assert.Less(t, shard[i-1].Path, f.Path, "分片内应保持扫描顺序")
+			}
+		}
+		loads = append(loads, load)
+	}
+	assert.Len(t, seen, len(files))
+	for path, n := range seen {
+		assert.Equal(t, 1, n, "文件 %s 应只属于一个分片", path)
+	}
+	assert.Equal(t, []int64{1000, 900}, loads)
+
+	assert.Equal(t, shards, assignShards(files, 2), "分配应是确定的")
+	assert.Len(t, assignShards(files, 10), len(files), "分片数不超过文件数")
+	assert.Len(t, assignShards(files, 1), 1)
+}
+
+func TestParseShardsMatchSingleProcess(t *testing.T) {
+	dir := writeShardFixture(t)
+
+	want := runParse(t, dir, 1, nil)
+	require.Contains(t, string(want), `"edge_type": "call"`)
+
+	for shards := 2; shards <= 5; shards++ {
+		got := runParse(t, dir, shards, inProcessShardRunner)
+		assert.Equal(t, string(want), string(got), "shards=%d 的输出应与单进程一致", shards)
+	}
+}
+
+func TestParseShardFailureFailsParse(t *testing.T) {
+	dir := writeShardFixture(t)
+
+	failing := func(ctx context.Context, shard int, files []parser.ScannedFile, workers int) (*shardResult, error) {
+		if shard == 1 {
+			return nil, errors.New("boom")
+		}
+		return inProcessShardRunner(ctx, shard, files, workers)
+	}
+
+	cmd := &ParseCommand{
+		Path:     dir,
+		Output:   filepath.Join(t.TempDir(), "out.json"),
+		Workers:  2,
+		Shards:   3,
+		NoIgnore: true,
+		runShard: failing,
+	}
+	err := cmd.Execute()
+	require.Error(t, err)
+	assert.Contains(t, err.Error(), "shard 2/3: boom")
+}
+
+func TestExpandCopiesMirrorsCanonicalFailure(t *testing.T) {
+	result := &shardResult{
+		Files: []schema.PreparedFile{{Path: "a/util.go", Checksum: "c1"}},
+		Errors: []schema.ParseError{
+			{File: "a/util.go", Line: 3, Message: "parse tree contains errors", Type: schema.ErrorParse},
+			{File: "a/broken.h", Message: "syntax errors cover 80% of the file", Type: schema.ErrorParse},
+			{File: "a/broken.h", Line: 9, Message: "second error", Type: schema.ErrorParse},
+		},
+	}
+	copies := map[string][]parser.ScannedFile{
+		"a/util.go":  {{Path: "b/util.go"}},
+		"a/broken.h": {{Path: "b/broken.h"}, {Path: "c/broken.h"}},
+	}
+
+	added := expandCopies(result, copies)
+	assert.Equal(t, 1, added)
+	require.Len(t, result.Files, 2)
+	assert.Equal(t, "b/util.go", result.Files[1].Path)
+
+	// 解析失败的原件的每个副本各记一条错误；解析成功文件的非致命错误不复制
+	require.Len(t, result.Errors, 5)
+	for i, path := range []string{"b/broken.h", "c/broken.h"} {
+		mirrored := result.Errors[3+i]
+		assert.Equal(t, path, mirrored.File)
+		assert.Equal(t, schema.ErrorParse, mirrored.Type)
+		assert.Equal(t, "syntax errors cover 80% of the file (same content as a/broken.h)", mirrored.Message)
+	}
+}
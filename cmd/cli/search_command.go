@@ -9,6 +9,7 @@ import (
 
 	"github.com/urfave/cli/v2"
 	"github.com/yourtionguo/CodeAtlas/internal/indexer"
+	"github.com/yourtionguo/CodeAtlas/internal/snapshot"
 	"github.com/yourtionguo/CodeAtlas/internal/utils"
 	"github.com/yourtionguo/CodeAtlas/pkg/client"
 )
@@ -41,6 +42,9 @@ EXAMPLES:
    # Limit number of results
    codeatlas search --query "error handling" --limit 5
 
+   # Search an offline snapshot (keyword search unless the snapshot has vectors)
+   codeatlas search --query "parse config" --snapshot repo.snap
+
 ENVIRONMENT VARIABLES:
    CODEATLAS_API_URL        Default API server URL
    CODEATLAS_API_TOKEN      API authentication token
@@ -74,6 +78,10 @@ ENVIRONMENT VARIABLES:
 				Usage:   "Maximum number of results to return",
 				Value:   10,
 			},
+			&cli.StringFlag{
+				Name:  "snapshot",
+				Usage: "Search an offline snapshot file instead of the API server",
+			},
 			&cli.StringFlag{
 				Name:  "api-url",
 				Usage: "API server URL (can also use CODEATLAS_API_URL env var)",
@@ -120,10 +128,11 @@ func executeSearchCommand(c *cli.Context) error {
 	}
 
 	// Get API URL from flag or environment
+	snapshotPath := c.String("snapshot")
 	apiURL := c.String("api-url")
 	if apiURL == "" {
 		apiURL = os.Getenv("CODEATLAS_API_URL")
-		if apiURL == "" {
+		if apiURL == "" && snapshotPath == "" {
 			return fmt.Errorf("API URL must be specified via --api-url flag or CODEATLAS_API_URL environment variable")
 		}
 	}
@@ -151,6 +160,8 @@ func executeSearchCommand(c *cli.Context) error {
 
 	logger.Info("Searching for: %s", query)
 
+	kinds := parseKindFilter(c.String("kind"))
+
 	// Create embedder for query vectorization
 	embedderConfig := &indexer.EmbedderConfig{
 		Backend:              "openai",
@@ -164,10 +175,24 @@ func executeSearchCommand(c *cli.Context) error {
 	}
 
 	embedder := indexer.NewOpenAIEmbedder(embedderConfig, nil)
+	ctx := context.Background()
+
+	if snapshotPath != "" {
+		startTime := time.Now()
+		searchResp, err := searchSnapshot(ctx, snapshotPath, query, embedder, snapshot.Filters{
+			Language: c.String("language"),
+			Kind:     kinds,
+			Limit:    c.Int("limit"),
+		}, logger)
+		if err != nil {
+			return err
+		}
+		displaySearchResults(searchResp, query, time.Since(startTime), logger)
+		return nil
+	}
 
 	// Generate embedding for query
 	logger.Info("Generating embedding for query...")
-	ctx := context.Background()
 	embedding, err := embedder.GenerateEmbedding(ctx, query)
 	if err != nil {
 		return fmt.Errorf("failed to generate embedding: %w", err)
@@ -201,14 +226,7 @@ func executeSearchCommand(c *cli.Context) error {
 		filters.RepoIDs = []string{repoID}
 	}
 
-	// Parse kind filter
-	if kindStr := c.String("kind"); kindStr != "" {
-		filters.Kind = strings.Split(kindStr, ",")
-		// Trim whitespace from each kind
-		for i := range filters.Kind {
-			filters.Kind[i] = strings.TrimSpace(filters.Kind[i])
-		}
-	}
+	filters.Kind = kinds
 
 	// Perform search
 	logger.Info("Searching...")
@@ -227,6 +245,59 @@ func executeSearchCommand(c *cli.Context) error {
 	return nil
 }
 
+// parseKindFilter splits a comma-separated kind filter and trims whitespace from each kind
+func parseKindFilter(kindStr string) []string {
+	if kindStr == "" {
+		return nil
+	}
+	kinds := strings.Split(kindStr, ",")
+	for i := range kinds {
+		kinds[i] = strings.TrimSpace(kinds[i])
+	}
+	return kinds
+}
+
+// searchSnapshot searches an offline snapshot. Vector search is used when the
+// snapshot carries embeddings; otherwise it falls back to the keyword index so
+// no embedding service is required.
+func searchSnapshot(ctx context.Context, path, query string, embedder indexer.Embedder, filters snapshot.Filters, logger *utils.Logger) (*client.SearchResponse, error) {
+	snap, err := snapshot.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer snap.Close()
+
+	var hits []snapshot.Hit
+	if snap.HasVectors() {
+		logger.Info("Generating embedding for query...")
+		embedding, err := embedder.GenerateEmbedding(ctx, query)
+		if err != nil {
+			return nil, fmt.Errorf("failed to generate embedding: %w", err)
+		}
+		hits = snap.VectorSearch(embedding, filters)
+	} else {
+		logger.Debug("Snapshot has no vectors, using keyword search")
+		hits = snap.KeywordSearch(query, filters)
+	}
+
+	resp := &client.SearchResponse{
+		Results: make([]client.SearchResult, 0, len(hits)),
+		Total:   len(hits),
+	}
+	for _, h := range hits {
+		resp.Results = append(resp.Results, client.SearchResult{
+			SymbolID:   h.SymbolID,
+			Name:       h.Name,
+			Kind:       h.Kind,
+			Signature:  h.Signature,
+			FilePath:   h.FilePath,
+			Docstring:  h.Docstring,
+			Similarity: h.Score,
+		})
+	}
+	return resp, nil
+}
+
 // displaySearchResults displays the search results
 func displaySearchResults(resp *client.SearchResponse, query string, duration time.Duration, logger *utils.Logger) {
 	fmt.Println("\n=== Search Results ===")
@@ -2,6 +2,7 @@ package handlers
 
 import (
 	"context"
+	"errors"
 	"net/http"
 
 	"github.com/gin-gonic/gin"
@@ -15,6 +16,8 @@ import (
 type IndexHandler struct {
 	db             *models.DB
 	embedderConfig *EmbedderConfig
+	bulkLoad       models.BulkLoadConfig
+	writeGroups    int
 }
 
 // NewIndexHandler creates a new index handler with embedder configuration
@@ -22,9 +25,21 @@ func NewIndexHandler(db *models.DB, embedderConfig *EmbedderConfig) *IndexHandle
 	return &IndexHandler{
 		db:             db,
 		embedderConfig: embedderConfig,
+		bulkLoad:       models.DefaultBulkLoadConfig(),
 	}
 }
 
+// SetBulkLoadConfig sets how indexes deferred by bulk_load requests are rebuilt
+func (h *IndexHandler) SetBulkLoadConfig(config models.BulkLoadConfig) {
+	h.bulkLoad = config
+}
+
+// SetWriteParallelism sets how many file groups an index request writes
+// concurrently (<= 1 writes in a single transaction)
+func (h *IndexHandler) SetWriteParallelism(groups int) {
+	h.writeGroups = groups
+}
+
 // IndexRequest represents the request body for POST /api/v1/index
 type IndexRequest struct {
 	RepoID      string              `json:"repo_id,omitempty"`
@@ -43,6 +58,12 @@ type IndexOptions struct {
 	BatchSize      int    `json:"batch_size"`
 	WorkerCount    int    `json:"worker_count"`
 	EmbeddingModel string `json:"embedding_model,omitempty"`
+	// History 把本次索引作为 commit_hash 的一个版本写入提交级历史
+	History bool `json:"history,omitempty"`
+	// BulkLoad 在表为空时（首次导入）推迟二级索引，写完后并行重建
+	BulkLoad bool `json:"bulk_load,omitempty"`
+	// ErrorBudget > 0 时错误数超过该值即提前结束索引，返回 422
+	ErrorBudget int `json:"error_budget,omitempty"`
 }
 
 // IndexResponse represents the response for POST /api/v1/index
@@ -53,8 +74,11 @@ type IndexResponse struct {
 	SymbolsCreated int           `json:"symbols_created"`
 	EdgesCreated   int           `json:"edges_created"`
 	VectorsCreated int           `json:"vectors_created"`
+	History        *models.HistoryDiff `json:"history,omitempty"`
 	Errors         []IndexError  `json:"errors,omitempty"`
-	Duration       string        `json:"duration"`
+	// ErrorBuckets 按 (stage, type, code) 汇总的错误计数；Errors 只含各分桶的前几条样例
+	ErrorBuckets []indexer.ErrorBucket `json:"error_buckets,omitempty"`
+	Duration     string                `json:"duration"`
 }
 
 // IndexError represents an error that occurred during indexing
@@ -85,6 +109,13 @@ func (h *IndexHandler) Index(c *gin.Context) {
 		return
 	}
 
+	if req.Options.History && req.CommitHash == "" {
+		c.JSON(http.StatusBadRequest, gin.H{
+			"error": "commit_hash is required when history is enabled",
+		})
+		return
+	}
+
 	// Generate repo ID if not provided
 	if req.RepoID == "" {
 		req.RepoID = uuid.New().String()
@@ -101,11 +132,14 @@ func (h *IndexHandler) Index(c *gin.Context) {
 		RepoName:        req.RepoName,
 		RepoURL:         req.RepoURL,
 		Branch:          req.Branch,
+		CommitHash:      req.CommitHash,
 		BatchSize:       req.Options.BatchSize,
 		WorkerCount:     req.Options.WorkerCount,
 		SkipVectors:     req.Options.SkipVectors,
 		Incremental:     req.Options.Incremental,
 		UseTransactions: true,
+		History:         req.Options.History,
+		ErrorBudget:     req.Options.ErrorBudget,
 		EmbeddingModel:  req.Options.EmbeddingModel,
 	}
 
@@ -116,22 +150,41 @@ func (h *IndexHandler) Index(c *gin.Context) {
 	if config.WorkerCount == 0 {
 		config.WorkerCount = 4
 	}
+	if req.Options.BulkLoad {
+		bulkLoad := h.bulkLoad
+		config.BulkLoad = &bulkLoad
+	}
+	config.WriteParallelism = h.writeGroups
+
+	// Indexing holds long write transactions; run it on the bulk pool so it
+	// cannot starve interactive queries (falls back to the shared pool).
+	db := h.db.Bulk()
 
 	// Create indexer with embedder config if available
 	var idx *indexer.Indexer
 	if h.embedderConfig != nil && !config.SkipVectors {
 		// Create embedder with handler's config
-		vectorRepo := models.NewVectorRepository(h.db)
+		vectorRepo := models.NewVectorRepository(db)
 		embedder := indexer.NewOpenAIEmbedder(h.embedderConfig, vectorRepo)
-		idx = indexer.NewIndexerWithEmbedder(h.db, config, embedder)
+		idx = indexer.NewIndexerWithEmbedder(db, config, embedder)
 	} else {
-		idx = indexer.NewIndexer(h.db, config)
+		idx = indexer.NewIndexer(db, config)
 	}
 
 	// Run indexing
 	ctx := context.Background()
 	result, err := idx.Index(ctx, &req.ParseOutput)
 	
+	if errors.Is(err, indexer.ErrErrorBudgetExceeded) {
+		buckets, _ := result.Summary["error_buckets"].([]indexer.ErrorBucket)
+		c.JSON(http.StatusUnprocessableEntity, gin.H{
+			"error":         "Indexing stopped: error budget exceeded",
+			"details":       err.Error(),
+			"error_buckets": buckets,
+		})
+		return
+	}
+
 	if err != nil {
 		
 		// Check if it's a validation error
@@ -162,6 +215,12 @@ func (h *IndexHandler) Index(c *gin.Context) {
 		Duration:       result.Duration.String(),
 		Errors:         convertIndexErrors(result.Errors),
 	}
+	if buckets, ok := result.Summary["error_buckets"].([]indexer.ErrorBucket); ok {
+		response.ErrorBuckets = buckets
+	}
+	if diff, ok := result.Summary["history"].(*models.HistoryDiff); ok {
+		response.History = diff
+	}
 
 	// Determine HTTP status code based on result status
 	statusCode := http.StatusOK
@@ -1,10 +1,14 @@
 package handlers
 
 import (
+	"encoding/base64"
+	"encoding/json"
+	"errors"
 	"net/http"
 	"strconv"
 
 	"github.com/gin-gonic/gin"
+	"github.com/google/uuid"
 	"github.com/yourtionguo/CodeAtlas/pkg/models"
 )
 
@@ -39,6 +43,8 @@ type RelatedSymbol struct {
 type RelationshipResponse struct {
 	Symbols []RelatedSymbol `json:"symbols"`
 	Total   int             `json:"total"`
+	// NextCursor 在分页请求（?limit=）还有下一页时返回，作为下一次请求的 ?cursor=
+	NextCursor string `json:"next_cursor,omitempty"`
 }
 
 // DependencyResponse represents the response for dependency queries
@@ -87,6 +93,12 @@ func (h *RelationshipHandler) GetCallers(c *gin.Context) {
 		return
 	}
 
+	// ?commit= 查询提交级历史中该提交时刻的调用关系
+	if commit := c.Query("commit"); commit != "" {
+		h.getRelationsAt(c, symbolID, commit, true)
+		return
+	}
+
 	ctx := c.Request.Context()
 
 	// Verify symbol exists
@@ -114,7 +126,18 @@ func (h *RelationshipHandler) GetCallers(c *gin.Context) {
 func (h *RelationshipHandler) getCallersSQL(c *gin.Context, symbolID string) {
 	ctx := c.Request.Context()
 
-	edges, err := h.edgeRepo.GetCallersWithDetails(ctx, symbolID)
+	limit, after, ok := parsePageParams(c)
+	if !ok {
+		return
+	}
+	var edges []*models.EdgeWithDetails
+	var err error
+	if limit > 0 {
+		// 多取一行判断是否还有下一页
+		edges, err = h.edgeRepo.GetCallersPage(ctx, symbolID, after.Name, after.EdgeID, limit+1)
+	} else {
+		edges, err = h.edgeRepo.GetCallersWithDetails(ctx, symbolID)
+	}
 	if err != nil {
 		c.JSON(http.StatusInternalServerError, gin.H{
 			"error":   "Failed to retrieve callers",
@@ -123,6 +146,60 @@ func (h *RelationshipHandler) getCallersSQL(c *gin.Context, symbolID string) {
 		return
 	}
 
+	c.JSON(http.StatusOK, toRelationshipResponse(edges, limit))
+}
+
+// getRelationsAt 从 symbol_history / edge_history 还原给定提交时的调用方
+// （callers 为 true）或被调用方。返回的 symbol_id 是该提交时的符号 ID。
+func (h *RelationshipHandler) getRelationsAt(c *gin.Context, symbolID, commitRef string, callers bool) {
+	ctx := c.Request.Context()
+	history := models.NewHistoryRepository(h.db)
+
+	repoID, key, err := history.SymbolKey(ctx, symbolID)
+	if err != nil {
+		c.JSON(http.StatusInternalServerError, gin.H{
+			"error":   "Failed to retrieve symbol",
+			"details": err.Error(),
+		})
+		return
+	}
+	if key == "" {
+		c.JSON(http.StatusNotFound, gin.H{
+			"error": "Symbol not found",
+		})
+		return
+	}
+
+	commit, err := history.ResolveCommit(ctx, repoID, commitRef)
+	if errors.Is(err, models.ErrCommitNotFound) || errors.Is(err, models.ErrAmbiguousCommit) {
+		c.JSON(http.StatusNotFound, gin.H{
+			"error":   "Commit not found in history",
+			"details": err.Error(),
+		})
+		return
+	}
+	if err != nil {
+		c.JSON(http.StatusInternalServerError, gin.H{
+			"error":   "Failed to resolve commit",
+			"details": err.Error(),
+		})
+		return
+	}
+
+	var edges []*models.EdgeWithDetails
+	if callers {
+		edges, err = history.CallersAt(ctx, repoID, key, commit.Seq)
+	} else {
+		edges, err = history.CalleesAt(ctx, repoID, key, commit.Seq)
+	}
+	if err != nil {
+		c.JSON(http.StatusInternalServerError, gin.H{
+			"error":   "Failed to retrieve relationships",
+			"details": err.Error(),
+		})
+		return
+	}
+
 	results := make([]RelatedSymbol, 0, len(edges))
 	for _, e := range edges {
 		results = append(results, RelatedSymbol{
@@ -148,6 +225,12 @@ func (h *RelationshipHandler) GetCallees(c *gin.Context) {
 		return
 	}
 
+	// ?commit= 查询提交级历史中该提交时刻的调用关系
+	if commit := c.Query("commit"); commit != "" {
+		h.getRelationsAt(c, symbolID, commit, false)
+		return
+	}
+
 	ctx := c.Request.Context()
 
 	// Verify symbol exists
@@ -175,7 +258,17 @@ func (h *RelationshipHandler) GetCallees(c *gin.Context) {
 func (h *RelationshipHandler) getCalleesSQL(c *gin.Context, symbolID string) {
 	ctx := c.Request.Context()
 
-	edges, err := h.edgeRepo.GetCalleesWithDetails(ctx, symbolID)
+	limit, after, ok := parsePageParams(c)
+	if !ok {
+		return
+	}
+	var edges []*models.EdgeWithDetails
+	var err error
+	if limit > 0 {
+		edges, err = h.edgeRepo.GetCalleesPage(ctx, symbolID, after.Name, after.EdgeID, limit+1)
+	} else {
+		edges, err = h.edgeRepo.GetCalleesWithDetails(ctx, symbolID)
+	}
 	if err != nil {
 		c.JSON(http.StatusInternalServerError, gin.H{
 			"error":   "Failed to retrieve callees",
@@ -184,6 +277,76 @@ func (h *RelationshipHandler) getCalleesSQL(c *gin.Context, symbolID string) {
 		return
 	}
 
+	c.JSON(http.StatusOK, toRelationshipResponse(edges, limit))
+}
+
+// maxPageLimit 是分页请求单页的最大行数
+const maxPageLimit = 1000
+
+// edgeCursor 是 keyset 分页游标：上一页最后一行的排序键 (name, edge_id)。
+// 对客户端不透明（base64 编码的 JSON）。
+type edgeCursor struct {
+	Name   string `json:"n"`
+	EdgeID string `json:"e"`
+}
+
+func (cur edgeCursor) encode() string {
+	raw, _ := json.Marshal(cur)
+	return base64.RawURLEncoding.EncodeToString(raw)
+}
+
+func decodeEdgeCursor(s string) (edgeCursor, error) {
+	var cur edgeCursor
+	raw, err := base64.RawURLEncoding.DecodeString(s)
+	if err != nil {
+		return cur, err
+	}
+	if err := json.Unmarshal(raw, &cur); err != nil {
+		return cur, err
+	}
+	if _, err := uuid.Parse(cur.EdgeID); err != nil {
+		return cur, err
+	}
+	return cur, nil
+}
+
+// parsePageParams 解析可选的 limit / cursor 查询参数。limit 缺省（0）时不分页，
+// 返回全部结果；超过 maxPageLimit 时截断。参数非法时写入 400 并返回 false。
+func parsePageParams(c *gin.Context) (int, edgeCursor, bool) {
+	var limit int
+	if raw := c.Query("limit"); raw != "" {
+		n, err := strconv.Atoi(raw)
+		if err != nil || n < 0 {
+			c.JSON(http.StatusBadRequest, gin.H{"error": "limit must be a non-negative integer"})
+			return 0, edgeCursor{}, false
+		}
+		limit = n
+	}
+	if limit > maxPageLimit {
+		limit = maxPageLimit
+	}
+	var after edgeCursor
+	if raw := c.Query("cursor"); raw != "" {
+		cur, err := decodeEdgeCursor(raw)
+		if err != nil {
+			c.JSON(http.StatusBadRequest, gin.H{"error": "Invalid cursor"})
+			return 0, edgeCursor{}, false
+		}
+		after = cur
+	}
+	return limit, after, true
+}
+
+// toRelationshipResponse 把边详情转为响应；limit > 0 时 edges 多取了一行，
+// 有多余行说明还有下一页，返回指向本页最后一行的游标。
+func toRelationshipResponse(edges []*models.EdgeWithDetails, limit int) RelationshipResponse {
+	var next string
+	if limit > 0 && len(edges) > limit {
+		edges = edges[:limit]
+		last := edges[len(edges)-1]
+		next = edgeCursor{Name: last.Name, EdgeID: last.EdgeID}.encode()
+	}
+
 	results := make([]RelatedSymbol, 0, len(edges))
 	for _, e := range edges {
 		results = append(results, RelatedSymbol{
@@ -194,8 +357,7 @@ func (h *RelationshipHandler) getCalleesSQL(c *gin.Context, symbolID string) {
 			Signature: e.Signature,
 		})
 	}
-
-	c.JSON(http.StatusOK, RelationshipResponse{Symbols: results, Total: len(results)})
+	return RelationshipResponse{Symbols: results, Total: len(results), NextCursor: next}
 }
 
 // GetDependencies handles GET /api/v1/symbols/:id/dependencies
@@ -284,6 +446,63 @@ func (h *RelationshipHandler) getDependenciesSQL(c *gin.Context, symbolID string
 	c.JSON(http.StatusOK, DependencyResponse{Dependencies: results, Total: len(results)})
 }
 
+// ModuleDependent is a symbol importing an external module
+type ModuleDependent struct {
+	RelatedSymbol
+	Module   string `json:"module"`
+	EdgeType string `json:"edge_type"`
+}
+
+// ModuleDependentsResponse represents the response for external module queries
+type ModuleDependentsResponse struct {
+	Dependents []ModuleDependent `json:"dependents"`
+	Total      int               `json:"total"`
+}
+
+// GetModuleDependents handles GET /api/v1/modules/dependents?name=curl/curl.h
+// Finds the symbols that import an external module across repositories.
+// prefix=true matches every module starting with name; repo_id narrows the
+// search to one repository.
+func (h *RelationshipHandler) GetModuleDependents(c *gin.Context) {
+	module := c.Query("name")
+	if module == "" {
+		c.JSON(http.StatusBadRequest, gin.H{
+			"error": "Module name is required",
+		})
+		return
+	}
+	prefix, _ := strconv.ParseBool(c.Query("prefix"))
+
+	edges, err := h.edgeRepo.GetModuleDependents(c.Request.Context(), module, prefix, c.Query("repo_id"))
+	if err != nil {
+		c.JSON(http.StatusInternalServerError, gin.H{
+			"error":   "Failed to retrieve module dependents",
+			"details": err.Error(),
+		})
+		return
+	}
+
+	results := make([]ModuleDependent, 0, len(edges))
+	for _, e := range edges {
+		d := ModuleDependent{
+			RelatedSymbol: RelatedSymbol{
+				SymbolID:  e.SymbolID,
+				Name:      e.Name,
+				Kind:      e.Kind,
+				FilePath:  e.FilePath,
+				Signature: e.Signature,
+			},
+			EdgeType: e.EdgeType,
+		}
+		if e.TargetModule != nil {
+			d.Module = *e.TargetModule
+		}
+		results = append(results, d)
+	}
+
+	c.JSON(http.StatusOK, ModuleDependentsResponse{Dependents: results, Total: len(results)})
+}
+
 // GetFileSymbols handles GET /api/v1/files/:id/symbols
 // Retrieves all symbols in a file using SQL queries
 func (h *RelationshipHandler) GetFileSymbols(c *gin.Context) {
@@ -303,6 +303,22 @@ func TestRelationshipHandler_GetTransitiveCallers_InvalidRequest(t *testing.T) {
 	}
 }
 
+// TestRelationshipHandler_GetModuleDependents_InvalidRequest 验证缺少模块名返回 400。
+func TestRelationshipHandler_GetModuleDependents_InvalidRequest(t *testing.T) {
+	gin.SetMode(gin.TestMode)
+	handler := NewRelationshipHandler(nil)
+	router := gin.New()
+	router.GET("/api/v1/modules/dependents", handler.GetModuleDependents)
+
+	req, _ := http.NewRequest("GET", "/api/v1/modules/dependents?prefix=true", nil)
+	w := httptest.NewRecorder()
+	router.ServeHTTP(w, req)
+
+	if w.Code != http.StatusBadRequest {
+		t.Errorf("Expected status %d for missing module name, got %d", http.StatusBadRequest, w.Code)
+	}
+}
+
 // TestParseDepthParam 验证 depth 查询参数解析的边界。
 func TestParseDepthParam(t *testing.T) {
 	gin.SetMode(gin.TestMode)
@@ -331,3 +347,42 @@ func TestParseDepthParam(t *testing.T) {
 		})
 	}
 }
+
+// TestEdgeCursor_RoundTrip 验证分页游标编码可逆，且拒绝伪造的游标。
+func TestEdgeCursor_RoundTrip(t *testing.T) {
+	cur := edgeCursor{Name: "handle_request", EdgeID: "7d444840-9dc0-11d1-b245-5ffdce74fad2"}
+	got, err := decodeEdgeCursor(cur.encode())
+	if err != nil || got != cur {
+		t.Fatalf("round trip = %+v, %v", got, err)
+	}
+	for _, bad := range []string{"not base64!", "e30", cur.encode()[:5]} {
+		if _, err := decodeEdgeCursor(bad); err == nil {
+			t.Errorf("expected %q to be rejected", bad)
+		}
+	}
+}
+
+// TestToRelationshipResponse_Pagination 验证多取的一行被裁掉并生成 next_cursor。
+func TestToRelationshipResponse_Pagination(t *testing.T) {
+	edges := []*models.EdgeWithDetails{
+		{EdgeID: "7d444840-9dc0-11d1-b245-5ffdce74fad1", Name: "a"},
+		{EdgeID: "7d444840-9dc0-11d1-b245-5ffdce74fad2", Name: "b"},
+		{EdgeID: "7d444840-9dc0-11d1-b245-5ffdce74fad3", Name: "c"},
+	}
+
+	resp := toRelationshipResponse(edges, 2)
+	if resp.Total != 2 || resp.NextCursor == "" {
+		t.Fatalf("expected a 2-row page with a cursor, got %d rows cursor %q", resp.Total, resp.NextCursor)
+	}
+	cur, err := decodeEdgeCursor(resp.NextCursor)
+	if err != nil || cur.Name != "b" || cur.EdgeID != edges[1].EdgeID {
+		t.Errorf("cursor should point at the last row of the page, got %+v (%v)", cur, err)
+	}
+
+	if resp := toRelationshipResponse(edges, 3); resp.NextCursor != "" || resp.Total != 3 {
+		t.Errorf("last page should have no cursor, got %q", resp.NextCursor)
+	}
+	if resp := toRelationshipResponse(edges, 0); resp.NextCursor != "" || resp.Total != 3 {
+		t.Errorf("unpaged response should return everything, got %d", resp.Total)
+	}
+}
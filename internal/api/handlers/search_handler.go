@@ -1,7 +1,7 @@
 package handlers
 
 import (
-	"context"
+	"fmt"
 	"net/http"
 
 	"github.com/gin-gonic/gin"
@@ -12,12 +12,19 @@ import (
 // EmbedderConfig is an alias for indexer.EmbedderConfig for easier imports
 type EmbedderConfig = indexer.EmbedderConfig
 
+// defaultCoarseFiles 是多粒度索引下粗筛保留的候选文件数
+const defaultCoarseFiles = 50
+
 // SearchHandler handles search operations
 type SearchHandler struct {
 	vectorRepo *models.VectorRepository
 	symbolRepo *models.SymbolRepository
 	fileRepo   *models.FileRepository
 	embedder   indexer.Embedder
+	// coarseFiles > 0 时向量召回走粗到细检索（多粒度 embedding 下默认开启）
+	coarseFiles int
+	// rescoreIndex 就绪前忽略 rescore，避免按未建索引的表达式排序全表
+	rescoreIndex *models.RescoreIndex
 }
 
 // NewSearchHandler creates a new search handler with embedder configuration
@@ -27,12 +34,16 @@ func NewSearchHandler(db *models.DB, embedderConfig *EmbedderConfig) *SearchHand
 		embedderConfig = indexer.DefaultEmbedderConfig()
 	}
 	
-	return &SearchHandler{
+	h := &SearchHandler{
 		vectorRepo: models.NewVectorRepository(db),
 		symbolRepo: models.NewSymbolRepository(db),
 		fileRepo:   models.NewFileRepository(db),
 		embedder:   indexer.NewOpenAIEmbedder(embedderConfig, models.NewVectorRepository(db)),
 	}
+	if embedderConfig.Granularity == indexer.GranularityMulti {
+		h.coarseFiles = defaultCoarseFiles
+	}
+	return h
 }
 
 // NewSearchHandlerWithEmbedder creates a new search handler with custom embedder
@@ -45,6 +56,12 @@ func NewSearchHandlerWithEmbedder(db *models.DB, embedder indexer.Embedder) *Sea
 	}
 }
 
+// SetRescoreIndex enables rescored searches once index is ready (nil disables
+// them)
+func (h *SearchHandler) SetRescoreIndex(index *models.RescoreIndex) {
+	h.rescoreIndex = index
+}
+
 // SearchRequest represents the request body for POST /api/v1/search
 type SearchRequest struct {
 	Query    string   `json:"query" binding:"required"`
@@ -55,12 +72,25 @@ type SearchRequest struct {
 	// Mode 控制检索策略：vector（纯向量）、keyword（纯关键词）、hybrid（混合重排）。
 	// 默认 hybrid。hybrid 适合自然语言提问，keyword 适合精确符号名查找。
 	Mode string `json:"mode,omitempty"`
+	// CoarseFiles 覆盖粗到细检索的候选文件数：> 0 为候选数，< 0 关闭粗筛，
+	// 0 使用服务端默认（多粒度索引时为 50）。只作用于 vector / hybrid 的向量召回。
+	CoarseFiles int `json:"coarse_files,omitempty"`
+	// Recall 是向量召回的召回目标：fast、balanced（默认）、high。
+	// 越高 HNSW 候选越多，延迟越高。
+	Recall string `json:"recall,omitempty"`
+	// Rescore > 1 开启两阶段向量召回：半精度索引过取 limit × rescore 个候选，
+	// 再按全精度向量精确重排。配合 recall=fast 以更小的 ef_search 换取延迟。
+	// 服务端未建立半精度索引（DB_VECTOR_RESCORE）时忽略。
+	Rescore int `json:"rescore,omitempty"`
 }
 
 // SearchResponse represents the response for POST /api/v1/search
 type SearchResponse struct {
 	Results []SearchResult `json:"results"`
 	Total   int            `json:"total"`
+	// Plan 描述向量召回的执行方式（ef_search、重试次数、过滤选择率），
+	// keyword 模式下省略
+	Plan *models.SearchPlan `json:"plan,omitempty"`
 }
 
 // SearchResult represents a single search result
@@ -90,7 +120,8 @@ func (h *SearchHandler) Search(c *gin.Context) {
 		req.Limit = 10
 	}
 
-	ctx := context.Background()
+	// 使用请求上下文：客户端断开或超时时取消在途查询（含多仓库分片检索）
+	ctx := c.Request.Context()
 
 	// mode 默认 hybrid：向量召回（语义）+ 关键词召回（精确符号名）+ 重排。
 	// keyword 模式跳过 embedding 生成，适合精确符号查找且省一次 API 调用。
@@ -98,6 +129,20 @@ func (h *SearchHandler) Search(c *gin.Context) {
 	if mode == "" {
 		mode = "hybrid"
 	}
+	switch req.Recall {
+	case "", models.RecallFast, models.RecallBalanced, models.RecallHigh:
+	default:
+		c.JSON(http.StatusBadRequest, gin.H{
+			"error": "Invalid recall: expected fast, balanced or high",
+		})
+		return
+	}
+	if req.Rescore < 0 || req.Rescore > models.MaxRescoreFactor {
+		c.JSON(http.StatusBadRequest, gin.H{
+			"error": fmt.Sprintf("Invalid rescore: expected 0 to %d", models.MaxRescoreFactor),
+		})
+		return
+	}
 
 	// 构建检索过滤：kind/language/repo 全部下沉到 SQL（JOIN symbols/files），
 	// 过滤在 LIMIT 前应用，保证返回数满 limit。
@@ -108,10 +153,22 @@ func (h *SearchHandler) Search(c *gin.Context) {
 		Language:    req.Language,
 		RepoIDs:     req.RepoIDs,
 		WithDetails: true, // JOIN 顺带返回 name/kind/signature/docstring/file_path/language/repo
+		CoarseFiles: h.coarseFiles,
+		Recall:      req.Recall,
+		Rescore:     req.Rescore,
+	}
+	if !h.rescoreIndex.Ready() {
+		filters.Rescore = 0
+	}
+	if req.CoarseFiles > 0 {
+		filters.CoarseFiles = req.CoarseFiles
+	} else if req.CoarseFiles < 0 {
+		filters.CoarseFiles = 0
 	}
 
 	// 按 mode 分发到不同检索路径
 	var hybridResults []*models.HybridSearchResult
+	var plan *models.SearchPlan
 	switch mode {
 	case "keyword":
 		// 纯关键词召回（无需 embedding）
@@ -152,7 +209,7 @@ func (h *SearchHandler) Search(c *gin.Context) {
 			})
 			return
 		}
-		vecResults, err := h.vectorRepo.SimilaritySearchWithFilters(ctx, embedding, filters)
+		vecResults, vecPlan, err := h.vectorRepo.SimilaritySearchWithPlan(ctx, embedding, filters)
 		if err != nil {
 			c.JSON(http.StatusInternalServerError, gin.H{
 				"error":   "Failed to perform semantic search",
@@ -160,6 +217,7 @@ func (h *SearchHandler) Search(c *gin.Context) {
 			})
 			return
 		}
+		plan = vecPlan
 		hybridResults = make([]*models.HybridSearchResult, 0, len(vecResults))
 		for _, v := range vecResults {
 			hybridResults = append(hybridResults, &models.HybridSearchResult{
@@ -177,7 +235,7 @@ func (h *SearchHandler) Search(c *gin.Context) {
 			return
 		}
 		// 权重：向量为主 0.7，关键词为辅 0.3
-		hybridResults, err = h.vectorRepo.HybridSearch(ctx, req.Query, embedding, filters, 0.7, 0.3)
+		hybridResults, plan, err = h.vectorRepo.HybridSearchWithPlan(ctx, req.Query, embedding, filters, 0.7, 0.3)
 		if err != nil {
 			c.JSON(http.StatusInternalServerError, gin.H{
 				"error":   "Failed to perform hybrid search",
@@ -204,6 +262,7 @@ func (h *SearchHandler) Search(c *gin.Context) {
 	response := SearchResponse{
 		Results: results,
 		Total:   len(results),
+		Plan:    plan,
 	}
 
 	c.JSON(http.StatusOK, response)
@@ -7,6 +7,10 @@ import (
 	"github.com/gin-gonic/gin"
 )
 
+// AuthTokenKey is the gin context key under which Auth stores a validated
+// bearer token
+const AuthTokenKey = "auth_token"
+
 // AuthConfig holds authentication configuration
 type AuthConfig struct {
 	Enabled bool
@@ -74,6 +78,13 @@ func Auth(config *AuthConfig) gin.HandlerFunc {
 		}
 
 		// Token is valid, continue
+		c.Set(AuthTokenKey, token)
 		c.Next()
 	}
 }
+
+// AuthenticatedToken returns the bearer token validated by Auth, or "" when
+// authentication is disabled or the request was not authenticated
+func AuthenticatedToken(c *gin.Context) string {
+	return c.GetString(AuthTokenKey)
+}
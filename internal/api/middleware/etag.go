@@ -0,0 +1,108 @@
+package middleware
+
+import (
+	"net/http"
+	"strconv"
+	"strings"
+	"time"
+
+	"github.com/gin-gonic/gin"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+// ValidatorFunc resolves the ETag and modification time of the data a request
+// reads. ok=false means no validator is known and the request is served normally.
+type ValidatorFunc func(c *gin.Context) (etag string, modified time.Time, ok bool)
+
+// RepoGeneration derives validators from the persisted generation of the
+// repository named by the given path parameter. Repositories without a known
+// generation are served normally.
+func RepoGeneration(gens *models.IndexGenerations, param string) ValidatorFunc {
+	return func(c *gin.Context) (string, time.Time, bool) {
+		gen, ok := gens.Repo(c.Request.Context(), c.Param(param))
+		if !ok {
+			return "", time.Time{}, false
+		}
+		// 带上修改时间：仓库删除后以同一 ID 重建时代数会从 0 重新开始
+		return `W/"r` + strconv.FormatInt(gen.Value, 10) + "-" + strconv.FormatInt(gen.ModifiedAt.UnixNano(), 36) + `"`, gen.ModifiedAt, true
+	}
+}
+
+// GlobalGeneration derives validators from the fingerprint of all repositories'
+// generations, for endpoints addressed by file or symbol ID or spanning all
+// repositories.
+func GlobalGeneration(gens *models.IndexGenerations) ValidatorFunc {
+	return func(c *gin.Context) (string, time.Time, bool) {
+		tag, modified, ok := gens.Global(c.Request.Context())
+		if !ok {
+			return "", time.Time{}, false
+		}
+		return `W/"g` + tag + `"`, modified, true
+	}
+}
+
+// ConditionalGET returns a middleware that sets ETag/Last-Modified on GET and
+// HEAD responses and answers 304 Not Modified when the client's validator is
+// still current, before the handler (and its database queries) runs.
+//
+// The validator is read before the handler executes. If the data changes while
+// the handler is running, the response carries the older validator, so the
+// next poll misses and refetches; it can never make a newer response look current.
+func ConditionalGET(validator ValidatorFunc) gin.HandlerFunc {
+	return func(c *gin.Context) {
+		if c.Request.Method != http.MethodGet && c.Request.Method != http.MethodHead {
+			c.Next()
+			return
+		}
+
+		etag, modified, ok := validator(c)
+		if !ok {
+			c.Next()
+			return
+		}
+
+		header := c.Writer.Header()
+		header.Set("ETag", etag)
+		header.Set("Cache-Control", "no-cache")
+		if !modified.IsZero() {
+			header.Set("Last-Modified", modified.UTC().Format(http.TimeFormat))
+		}
+
+		if notModified(c.Request, etag, modified) {
+			c.AbortWithStatus(http.StatusNotModified)
+			return
+		}
+
+		c.Next()
+	}
+}
+
+// notModified evaluates If-None-Match, falling back to If-Modified-Since only
+// when no If-None-Match is present (RFC 9110 §13.2.2)
+func notModified(r *http.Request, etag string, modified time.Time) bool {
+	if inm := r.Header.Get("If-None-Match"); inm != "" {
+		return etagMatches(inm, etag)
+	}
+	ims := r.Header.Get("If-Modified-Since")
+	if ims == "" || modified.IsZero() {
+		return false
+	}
+	t, err := http.ParseTime(ims)
+	if err != nil {
+		return false
+	}
+	// HTTP 日期只有秒级精度
+	return !modified.Truncate(time.Second).After(t)
+}
+
+// etagMatches applies weak comparison of etag against an If-None-Match list
+func etagMatches(header, etag string) bool {
+	target := strings.TrimPrefix(etag, "W/")
+	for _, candidate := range strings.Split(header, ",") {
+		candidate = strings.TrimSpace(candidate)
+		if candidate == "*" || strings.TrimPrefix(candidate, "W/") == target {
+			return true
+		}
+	}
+	return false
+}
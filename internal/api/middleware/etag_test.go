@@ -0,0 +1,141 @@
+package middleware
+
+import (
+	"net/http"
+	"net/http/httptest"
+	"testing"
+	"time"
+
+	"github.com/gin-gonic/gin"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+func newConditionalRouter(validator ValidatorFunc, calls *int) *gin.Engine {
+	gin.SetMode(gin.TestMode)
+	router := gin.New()
+	router.GET("/repositories/:id", ConditionalGET(validator), func(c *gin.Context) {
+		*calls++
+		c.JSON(http.StatusOK, gin.H{"id": c.Param("id")})
+	})
+	router.POST("/repositories/:id", ConditionalGET(validator), func(c *gin.Context) {
+		*calls++
+		c.Status(http.StatusCreated)
+	})
+	return router
+}
+
+func TestConditionalGET_NotModified(t *testing.T) {
+	gens := models.NewIndexGenerations()
+	modified := time.Date(2026, 1, 2, 3, 4, 5, 0, time.UTC)
+	gens.Observe("repo-1", models.IndexGeneration{Value: 3, ModifiedAt: modified})
+
+	calls := 0
+	router := newConditionalRouter(RepoGeneration(gens, "id"), &calls)
+
+	// First request returns validators
+	w := httptest.NewRecorder()
+	router.ServeHTTP(w, httptest.NewRequest("GET", "/repositories/repo-1", nil))
+	if w.Code != http.StatusOK {
+		t.Fatalf("Expected status %d, got %d", http.StatusOK, w.Code)
+	}
+	etag := w.Header().Get("ETag")
+	if etag == "" {
+		t.Fatal("Expected ETag header")
+	}
+	if w.Header().Get("Last-Modified") != "Fri, 02 Jan 2026 03:04:05 GMT" {
+		t.Errorf("Unexpected Last-Modified: %s", w.Header().Get("Last-Modified"))
+	}
+
+	// Revalidation short-circuits before the handler
+	req := httptest.NewRequest("GET", "/repositories/repo-1", nil)
+	req.Header.Set("If-None-Match", `"other", `+etag)
+	w = httptest.NewRecorder()
+	router.ServeHTTP(w, req)
+	if w.Code != http.StatusNotModified {
+		t.Errorf("Expected status %d, got %d", http.StatusNotModified, w.Code)
+	}
+	if calls != 1 {
+		t.Errorf("Expected handler to run once, ran %d times", calls)
+	}
+
+	// A new generation invalidates the old validator
+	gens.Observe("repo-1", models.IndexGeneration{Value: 4, ModifiedAt: modified.Add(time.Minute)})
+	w = httptest.NewRecorder()
+	router.ServeHTTP(w, req)
+	if w.Code != http.StatusOK {
+		t.Errorf("Expected status %d after reindex, got %d", http.StatusOK, w.Code)
+	}
+	if w.Header().Get("ETag") == etag {
+		t.Error("Expected ETag to change after reindex")
+	}
+}
+
+func TestConditionalGET_IfModifiedSince(t *testing.T) {
+	gens := models.NewIndexGenerations()
+	modified := time.Date(2026, 1, 2, 3, 4, 5, 500, time.UTC)
+	gens.Observe("repo-1", models.IndexGeneration{Value: 1, ModifiedAt: modified})
+
+	calls := 0
+	router := newConditionalRouter(RepoGeneration(gens, "id"), &calls)
+
+	req := httptest.NewRequest("GET", "/repositories/repo-1", nil)
+	req.Header.Set("If-Modified-Since", "Fri, 02 Jan 2026 03:04:05 GMT")
+	w := httptest.NewRecorder()
+	router.ServeHTTP(w, req)
+	if w.Code != http.StatusNotModified {
+		t.Errorf("Expected status %d, got %d", http.StatusNotModified, w.Code)
+	}
+
+	// If-None-Match takes precedence over If-Modified-Since
+	req.Header.Set("If-None-Match", `W/"stale"`)
+	w = httptest.NewRecorder()
+	router.ServeHTTP(w, req)
+	if w.Code != http.StatusOK {
+		t.Errorf("Expected status %d, got %d", http.StatusOK, w.Code)
+	}
+}
+
+func TestConditionalGET_UnknownRepoAndOtherMethods(t *testing.T) {
+	gens := models.NewIndexGenerations()
+	calls := 0
+	router := newConditionalRouter(RepoGeneration(gens, "id"), &calls)
+
+	req := httptest.NewRequest("GET", "/repositories/unknown", nil)
+	req.Header.Set("If-None-Match", "*")
+	w := httptest.NewRecorder()
+	router.ServeHTTP(w, req)
+	if w.Code != http.StatusOK || w.Header().Get("ETag") != "" {
+		t.Errorf("Expected full response without ETag for unknown repo, got %d %q", w.Code, w.Header().Get("ETag"))
+	}
+
+	req = httptest.NewRequest("POST", "/repositories/unknown", nil)
+	req.Header.Set("If-None-Match", "*")
+	w = httptest.NewRecorder()
+	router.ServeHTTP(w, req)
+	if w.Code != http.StatusCreated {
+		t.Errorf("Expected POST to bypass conditional handling, got %d", w.Code)
+	}
+}
+
+func TestGlobalGeneration(t *testing.T) {
+	gin.SetMode(gin.TestMode)
+	c, _ := gin.CreateTestContext(httptest.NewRecorder())
+	c.Request = httptest.NewRequest("GET", "/files/f1", nil)
+
+	gens := models.NewIndexGenerations()
+	validator := GlobalGeneration(gens)
+
+	before, _, ok := validator(c)
+	if !ok {
+		t.Fatal("Expected global validator")
+	}
+	gens.Observe("repo-1", models.IndexGeneration{Value: 1, ModifiedAt: time.Now()})
+	after, _, _ := validator(c)
+	if before == after {
+		t.Error("Expected global ETag to change with any repository's generation")
+	}
+
+	if _, _, ok := GlobalGeneration(nil)(c); ok {
+		t.Error("Expected no validator without a generation table")
+	}
+}
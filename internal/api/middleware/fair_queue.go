@@ -0,0 +1,171 @@
+package middleware
+
+import (
+	"container/heap"
+	"context"
+	"errors"
+	"sync"
+	"time"
+)
+
+var (
+	// ErrQueueFull means the fair queue has no room for another waiter
+	ErrQueueFull = errors.New("request queue is full")
+	// ErrQueueTimeout means no slot freed up within the queue timeout
+	ErrQueueTimeout = errors.New("timed out waiting in request queue")
+)
+
+// FairQueue bounds the number of requests in flight and, once that bound is
+// reached, hands freed slots out by weighted fair queuing (start-time fair
+// queuing over virtual time). Each waiter gets a finish tag
+//
+//	finish = max(virtual, lastFinish[client]) + cost / weight
+//
+// and the smallest tag is served first. A client that floods the server
+// pushes only its own tags further out, so other clients' requests overtake
+// its backlog in proportion to their weights.
+type FairQueue struct {
+	mu         sync.Mutex
+	capacity   int
+	maxQueue   int
+	inFlight   int
+	virtual    float64
+	lastFinish map[string]float64
+	waiters    waiterHeap
+	seq        uint64
+}
+
+type queueWaiter struct {
+	finish float64
+	seq    uint64
+	ready  chan struct{}
+	index  int // position in the heap, -1 once granted or removed
+}
+
+// NewFairQueue creates a queue admitting capacity concurrent requests with up
+// to maxQueue waiters (maxQueue <= 0 means capacity waiters)
+func NewFairQueue(capacity, maxQueue int) *FairQueue {
+	if maxQueue <= 0 {
+		maxQueue = capacity
+	}
+	return &FairQueue{
+		capacity:   capacity,
+		maxQueue:   maxQueue,
+		lastFinish: make(map[string]float64),
+	}
+}
+
+// Acquire waits for a slot and returns the function that releases it. Below
+// capacity it returns immediately without touching the queue state.
+func (q *FairQueue) Acquire(ctx context.Context, client string, weight, cost float64, timeout time.Duration) (func(), error) {
+	q.mu.Lock()
+	if q.inFlight < q.capacity && len(q.waiters) == 0 {
+		q.inFlight++
+		q.mu.Unlock()
+		return q.release, nil
+	}
+	if len(q.waiters) >= q.maxQueue {
+		q.mu.Unlock()
+		return nil, ErrQueueFull
+	}
+
+	if weight <= 0 {
+		weight = 1
+	}
+	start := q.virtual
+	if last := q.lastFinish[client]; last > start {
+		start = last
+	}
+	q.seq++
+	w := &queueWaiter{finish: start + cost/weight, seq: q.seq, ready: make(chan struct{})}
+	q.lastFinish[client] = w.finish
+	heap.Push(&q.waiters, w)
+	q.mu.Unlock()
+
+	var expired <-chan time.Time
+	if timeout > 0 {
+		timer := time.NewTimer(timeout)
+		defer timer.Stop()
+		expired = timer.C
+	}
+
+	select {
+	case <-w.ready:
+		return q.release, nil
+	case <-expired:
+		return q.abandon(w, ErrQueueTimeout)
+	case <-ctx.Done():
+		return q.abandon(w, ctx.Err())
+	}
+}
+
+// abandon removes a waiter that gave up. If a slot was handed to it in the
+// meantime the slot is kept and the request proceeds.
+func (q *FairQueue) abandon(w *queueWaiter, err error) (func(), error) {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+	if w.index < 0 {
+		return q.release, nil
+	}
+	heap.Remove(&q.waiters, w.index)
+	return nil, err
+}
+
+// release passes the slot to the waiter with the smallest finish tag, or
+// frees it when nobody is waiting
+func (q *FairQueue) release() {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+	if len(q.waiters) == 0 {
+		q.inFlight--
+		// 队列清空后各客户端的 finish 标签都已不早于 virtual，没有保留价值
+		if len(q.lastFinish) > 0 {
+			q.lastFinish = make(map[string]float64)
+		}
+		return
+	}
+	w := heap.Pop(&q.waiters).(*queueWaiter)
+	q.virtual = w.finish
+	close(w.ready)
+}
+
+// Stats reports the current number of requests in flight and waiting
+func (q *FairQueue) Stats() (inFlight, waiting int) {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+	return q.inFlight, len(q.waiters)
+}
+
+// waiterHeap orders waiters by finish tag, then arrival
+type waiterHeap []*queueWaiter
+
+func (h waiterHeap) Len() int { return len(h) }
+
+func (h waiterHeap) Less(i, j int) bool {
+	if h[i].finish != h[j].finish {
+		return h[i].finish < h[j].finish
+	}
+	return h[i].seq < h[j].seq
+}
+
+func (h waiterHeap) Swap(i, j int) {
+	h[i], h[j] = h[j], h[i]
+	h[i].index = i
+	h[j].index = j
+}
+
+func (h *waiterHeap) Push(x interface{}) {
+	w := x.(*queueWaiter)
+	w.index = len(*h)
+	*h = append(*h, w)
+}
+
+func (h *waiterHeap) Pop() interface{} {
+	old := *h
+	n := len(old)
+	w := old[n-1]
+	old[n-1] = nil
+	w.index = -1
+	*h = old[:n-1]
+	return w
+}
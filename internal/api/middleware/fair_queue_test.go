@@ -0,0 +1,131 @@
+package middleware
+
+import (
+	"context"
+	"errors"
+	"sync"
+	"testing"
+	"time"
+)
+
+func TestFairQueue_AdmitsBelowCapacity(t *testing.T) {
+	q := NewFairQueue(2, 1)
+	ctx := context.Background()
+
+	r1, err := q.Acquire(ctx, "a", 1, 1, 0)
+	if err != nil {
+		t.Fatalf("Acquire: %v", err)
+	}
+	r2, err := q.Acquire(ctx, "a", 1, 1, 0)
+	if err != nil {
+		t.Fatalf("Acquire: %v", err)
+	}
+	if inFlight, waiting := q.Stats(); inFlight != 2 || waiting != 0 {
+		t.Errorf("Stats = %d, %d; want 2, 0", inFlight, waiting)
+	}
+	r1()
+	r2()
+	if inFlight, _ := q.Stats(); inFlight != 0 {
+		t.Errorf("inFlight = %d after release, want 0", inFlight)
+	}
+}
+
+func TestFairQueue_TimeoutAndFull(t *testing.T) {
+	q := NewFairQueue(1, 1)
+	ctx := context.Background()
+	release, _ := q.Acquire(ctx, "a", 1, 1, 0)
+	defer release()
+
+	done := make(chan error, 1)
+	go func() {
+		_, err := q.Acquire(ctx, "b", 1, 1, 50*time.Millisecond)
+		done <- err
+	}()
+	waitForWaiters(t, q, 1)
+
+	if _, err := q.Acquire(ctx, "c", 1, 1, time.Second); !errors.Is(err, ErrQueueFull) {
+		t.Errorf("expected ErrQueueFull, got %v", err)
+	}
+	if err := <-done; !errors.Is(err, ErrQueueTimeout) {
+		t.Errorf("expected ErrQueueTimeout, got %v", err)
+	}
+	if _, waiting := q.Stats(); waiting != 0 {
+		t.Errorf("timed-out waiter still queued: %d", waiting)
+	}
+}
+
+func TestFairQueue_WeightedOrder(t *testing.T) {
+	q := NewFairQueue(1, 16)
+	ctx := context.Background()
+	release, _ := q.Acquire(ctx, "holder", 1, 1, 0)
+
+	// bot 先排入 4 个请求，之后 human 只排 1 个；human 不应排在 bot 的全部积压之后
+	var mu sync.Mutex
+	var order []string
+	var wg sync.WaitGroup
+	enqueue := func(client string, weight float64) {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			r, err := q.Acquire(ctx, client, weight, 1, 0)
+			if err != nil {
+				t.Errorf("Acquire(%s): %v", client, err)
+				return
+			}
+			mu.Lock()
+			order = append(order, client)
+			mu.Unlock()
+			r()
+		}()
+	}
+	for i := 1; i <= 4; i++ {
+		enqueue("bot", 1)
+		waitForWaiters(t, q, i)
+	}
+	enqueue("human", 2)
+	waitForWaiters(t, q, 5)
+
+	release()
+	wg.Wait()
+
+	pos := -1
+	for i, c := range order {
+		if c == "human" {
+			pos = i
+		}
+	}
+	// bot 的标签为 1,2,3,4，human 为 0.5：第一个被放行
+	if pos != 0 {
+		t.Errorf("human served at position %d, order %v", pos, order)
+	}
+}
+
+func TestFairQueue_ContextCancel(t *testing.T) {
+	q := NewFairQueue(1, 4)
+	release, _ := q.Acquire(context.Background(), "a", 1, 1, 0)
+	defer release()
+
+	ctx, cancel := context.WithCancel(context.Background())
+	done := make(chan error, 1)
+	go func() {
+		_, err := q.Acquire(ctx, "b", 1, 1, 0)
+		done <- err
+	}()
+	waitForWaiters(t, q, 1)
+	cancel()
+	if err := <-done; !errors.Is(err, context.Canceled) {
+		t.Errorf("expected context.Canceled, got %v", err)
+	}
+}
+
+func waitForWaiters(t *testing.T, q *FairQueue, n int) {
+	t.Helper()
+	deadline := time.Now().Add(2 * time.Second)
+	for time.Now().Before(deadline) {
+		if _, waiting := q.Stats(); waiting >= n {
+			return
+		}
+		time.Sleep(time.Millisecond)
+	}
+	t.Fatalf("timed out waiting for %d waiters", n)
+}
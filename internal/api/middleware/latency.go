@@ -0,0 +1,27 @@
+package middleware
+
+import (
+	"time"
+
+	"github.com/gin-gonic/gin"
+)
+
+// LatencyObserver receives the route ("GET /api/v1/symbols/:id/callers") and
+// total handling time of every request
+type LatencyObserver func(route string, latency time.Duration)
+
+// Latency returns a middleware that reports each request's latency to observe.
+// The route uses the registered pattern rather than the raw path, so IDs do
+// not explode the number of distinct routes.
+func Latency(observe LatencyObserver) gin.HandlerFunc {
+	return func(c *gin.Context) {
+		start := time.Now()
+		c.Next()
+
+		route := c.FullPath()
+		if route == "" {
+			route = c.Request.URL.Path
+		}
+		observe(c.Request.Method+" "+route, time.Since(start))
+	}
+}
@@ -0,0 +1,32 @@
+package middleware
+
+import (
+	"net/http"
+	"net/http/httptest"
+	"testing"
+	"time"
+
+	"github.com/gin-gonic/gin"
+)
+
+func TestLatency_ReportsRoutePattern(t *testing.T) {
+	var routes []string
+	router := gin.New()
+	router.Use(Latency(func(route string, latency time.Duration) {
+		if latency < 0 {
+			t.Errorf("Negative latency %s", latency)
+		}
+		routes = append(routes, route)
+	}))
+	router.GET("/symbols/:id/callers", func(c *gin.Context) {
+		c.Status(http.StatusOK)
+	})
+
+	router.ServeHTTP(httptest.NewRecorder(), httptest.NewRequest("GET", "/symbols/abc/callers", nil))
+	router.ServeHTTP(httptest.NewRecorder(), httptest.NewRequest("GET", "/missing", nil))
+
+	want := []string{"GET /symbols/:id/callers", "GET /missing"}
+	if len(routes) != len(want) || routes[0] != want[0] || routes[1] != want[1] {
+		t.Errorf("Expected routes %v, got %v", want, routes)
+	}
+}
@@ -0,0 +1,295 @@
+package middleware
+
+import (
+	"math"
+	"net/http"
+	"strconv"
+	"sync"
+	"time"
+
+	"github.com/gin-gonic/gin"
+)
+
+// RouteQuota overrides the per-client budget for one route
+// ("POST /api/v1/search"). Rate is in requests per second; Cost is what a
+// request of this route counts for in the fair queue (default 1), so that
+// expensive endpoints such as /search and /qa take a larger share of a
+// client's turn than cheap lookups.
+type RouteQuota struct {
+	Rate  float64
+	Burst int
+	Cost  float64
+}
+
+// QuotaConfig configures per-client token buckets and the fair queue.
+// Clients are identified by the bearer token Auth validated, or by IP when
+// authentication is disabled: an unchecked header would let a client get a
+// fresh bucket by sending a new token with every request.
+type QuotaConfig struct {
+	// Rate and Burst form the bucket every client gets across all routes
+	// (Rate <= 0 disables it)
+	Rate  float64
+	Burst int
+
+	// Routes adds a second, per-client bucket for individual routes
+	Routes map[string]RouteQuota
+
+	// Weights gives tokens a larger (or smaller) share of the fair queue;
+	// unlisted clients have weight 1
+	Weights map[string]float64
+
+	// MaxInFlight enables weighted fair queuing once this many requests are
+	// being handled (0 disables it). Up to MaxQueue requests wait at most
+	// QueueTimeout for a slot and are then rejected with 503.
+	MaxInFlight  int
+	MaxQueue     int
+	QueueTimeout time.Duration
+}
+
+// Response headers describing the tightest bucket that applied to a request
+const (
+	HeaderRateLimit          = "X-RateLimit-Limit"
+	HeaderRateLimitRemaining = "X-RateLimit-Remaining"
+	HeaderRateLimitReset     = "X-RateLimit-Reset"
+)
+
+// quotaSweepInterval 是清理空闲 bucket 的最小间隔
+const quotaSweepInterval = time.Minute
+
+// tokenBucket is a lazily refilled token bucket. It holds no timer; tokens
+// are topped up from the elapsed time whenever it is touched.
+type tokenBucket struct {
+	rate   float64
+	burst  float64
+	tokens float64
+	last   time.Time
+}
+
+func newTokenBucket(rate float64, burst int, now time.Time) *tokenBucket {
+	b := float64(burst)
+	if b < 1 {
+		b = math.Max(1, math.Ceil(rate))
+	}
+	return &tokenBucket{rate: rate, burst: b, tokens: b, last: now}
+}
+
+func (b *tokenBucket) refill(now time.Time) {
+	if elapsed := now.Sub(b.last).Seconds(); elapsed > 0 {
+		b.tokens = math.Min(b.burst, b.tokens+elapsed*b.rate)
+		b.last = now
+	}
+}
+
+// wait is how long until one token is available (0 when it already is)
+func (b *tokenBucket) wait() time.Duration {
+	if b.tokens >= 1 {
+		return 0
+	}
+	return time.Duration((1 - b.tokens) / b.rate * float64(time.Second))
+}
+
+// untilFull is how long until the bucket is back to its burst size
+func (b *tokenBucket) untilFull() time.Duration {
+	return time.Duration((b.burst - b.tokens) / b.rate * float64(time.Second))
+}
+
+// bucketKey identifies one client's bucket; route is empty for the global one
+type bucketKey struct {
+	client string
+	route  string
+}
+
+// QuotaDecision is the outcome of Quota.Allow
+type QuotaDecision struct {
+	Allowed bool
+	// Limit, Remaining and Reset describe the bucket with the fewest tokens left
+	Limit     int
+	Remaining int
+	Reset     time.Duration
+	// RetryAfter is set when the request was rejected
+	RetryAfter time.Duration
+	// Limited is false when no bucket applies to the request
+	Limited bool
+}
+
+// Quota holds the buckets of all clients. All state sits behind one mutex:
+// a decision is a couple of map lookups and float operations, far cheaper
+// than the handlers it protects.
+type Quota struct {
+	config QuotaConfig
+	queue  *FairQueue
+
+	mu        sync.Mutex
+	buckets   map[bucketKey]*tokenBucket
+	lastSweep time.Time
+	now       func() time.Time
+}
+
+// NewQuota creates the quota state for config
+func NewQuota(config QuotaConfig) *Quota {
+	q := &Quota{
+		config:  config,
+		buckets: make(map[bucketKey]*tokenBucket),
+		now:     time.Now,
+	}
+	if config.MaxInFlight > 0 {
+		q.queue = NewFairQueue(config.MaxInFlight, config.MaxQueue)
+	}
+	q.lastSweep = q.now()
+	return q
+}
+
+// Allow takes one token from every bucket that applies to client on route.
+// Either all buckets are charged or none is, so a rejection by the route
+// bucket does not also burn the client's global budget.
+func (q *Quota) Allow(client, route string) QuotaDecision {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+
+	now := q.now()
+	q.sweepLocked(now)
+
+	var applied [2]*tokenBucket
+	n := 0
+	if q.config.Rate > 0 {
+		applied[n] = q.bucketLocked(bucketKey{client: client}, q.config.Rate, q.config.Burst, now)
+		n++
+	}
+	if rq, ok := q.config.Routes[route]; ok && rq.Rate > 0 {
+		applied[n] = q.bucketLocked(bucketKey{client: client, route: route}, rq.Rate, rq.Burst, now)
+		n++
+	}
+	if n == 0 {
+		return QuotaDecision{Allowed: true}
+	}
+
+	d := QuotaDecision{Allowed: true, Limited: true}
+	for _, b := range applied[:n] {
+		if w := b.wait(); w > 0 {
+			d.Allowed = false
+			if w > d.RetryAfter {
+				d.RetryAfter = w
+			}
+		}
+	}
+	tightest := applied[0]
+	for _, b := range applied[:n] {
+		if d.Allowed {
+			b.tokens--
+		}
+		if b.tokens < tightest.tokens {
+			tightest = b
+		}
+	}
+	d.Limit = int(tightest.burst)
+	d.Remaining = int(math.Max(0, math.Floor(tightest.tokens)))
+	d.Reset = tightest.untilFull()
+	return d
+}
+
+func (q *Quota) bucketLocked(key bucketKey, rate float64, burst int, now time.Time) *tokenBucket {
+	b, ok := q.buckets[key]
+	if !ok {
+		b = newTokenBucket(rate, burst, now)
+		q.buckets[key] = b
+		return b
+	}
+	b.refill(now)
+	return b
+}
+
+// sweepLocked drops buckets that have refilled completely. A full bucket is
+// indistinguishable from a new one, so forgetting it loses nothing and keeps
+// the map from growing with every client IP ever seen.
+func (q *Quota) sweepLocked(now time.Time) {
+	if now.Sub(q.lastSweep) < quotaSweepInterval {
+		return
+	}
+	q.lastSweep = now
+	for key, b := range q.buckets {
+		b.refill(now)
+		if b.tokens >= b.burst {
+			delete(q.buckets, key)
+		}
+	}
+}
+
+// Cost returns the fair-queue cost of a request to route
+func (q *Quota) Cost(route string) float64 {
+	if rq, ok := q.config.Routes[route]; ok && rq.Cost > 0 {
+		return rq.Cost
+	}
+	return 1
+}
+
+// Weight returns the fair-queue weight of a bearer token
+func (q *Quota) Weight(token string) float64 {
+	if w, ok := q.config.Weights[token]; ok && w > 0 {
+		return w
+	}
+	return 1
+}
+
+// Queue returns the fair queue, or nil when it is disabled
+func (q *Quota) Queue() *FairQueue {
+	return q.queue
+}
+
+// RateLimit returns a middleware enforcing q. It must run after Auth, which
+// marks the tokens that get their own bucket. Over-budget requests are answered
+// with 429 before the handler runs; every limited response carries the
+// X-RateLimit-* headers of the tightest bucket.
+func RateLimit(q *Quota) gin.HandlerFunc {
+	return func(c *gin.Context) {
+		// 与 Auth 一致，健康检查不计配额
+		if c.Request.URL.Path == "/health" {
+			c.Next()
+			return
+		}
+
+		route := c.FullPath()
+		if route == "" {
+			route = c.Request.URL.Path
+		}
+		route = c.Request.Method + " " + route
+		token := AuthenticatedToken(c)
+		client := "ip:" + c.ClientIP()
+		if token != "" {
+			client = "token:" + token
+		}
+
+		d := q.Allow(client, route)
+		if d.Limited {
+			h := c.Writer.Header()
+			h.Set(HeaderRateLimit, strconv.Itoa(d.Limit))
+			h.Set(HeaderRateLimitRemaining, strconv.Itoa(d.Remaining))
+			h.Set(HeaderRateLimitReset, strconv.Itoa(ceilSeconds(d.Reset)))
+		}
+		if !d.Allowed {
+			c.Header("Retry-After", strconv.Itoa(ceilSeconds(d.RetryAfter)))
+			c.AbortWithStatusJSON(http.StatusTooManyRequests, gin.H{
+				"error": "Rate limit exceeded",
+			})
+			return
+		}
+
+		if q.queue == nil {
+			c.Next()
+			return
+		}
+		release, err := q.queue.Acquire(c.Request.Context(), client, q.Weight(token), q.Cost(route), q.config.QueueTimeout)
+		if err != nil {
+			c.Header("Retry-After", "1")
+			c.AbortWithStatusJSON(http.StatusServiceUnavailable, gin.H{
+				"error": "Server is busy, please retry",
+			})
+			return
+		}
+		defer release()
+		c.Next()
+	}
+}
+
+func ceilSeconds(d time.Duration) int {
+	return int(math.Ceil(d.Seconds()))
+}
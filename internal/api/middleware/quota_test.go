@@ -0,0 +1,196 @@
+package middleware
+
+import (
+	"net/http"
+	"net/http/httptest"
+	"testing"
+	"time"
+
+	"github.com/gin-gonic/gin"
+)
+
+// fakeClock 让 bucket 补充可控
+type fakeClock struct{ t time.Time }
+
+func (f *fakeClock) now() time.Time          { return f.t }
+func (f *fakeClock) advance(d time.Duration) { f.t = f.t.Add(d) }
+
+func newTestQuota(config QuotaConfig) (*Quota, *fakeClock) {
+	clock := &fakeClock{t: time.Date(2026, 1, 1, 0, 0, 0, 0, time.UTC)}
+	q := NewQuota(config)
+	q.now = clock.now
+	q.lastSweep = clock.t
+	return q, clock
+}
+
+func TestQuota_BurstAndRefill(t *testing.T) {
+	q, clock := newTestQuota(QuotaConfig{Rate: 2, Burst: 3})
+
+	for i := 0; i < 3; i++ {
+		d := q.Allow("token:a", "GET /x")
+		if !d.Allowed {
+			t.Fatalf("request %d rejected within burst", i)
+		}
+		if d.Remaining != 2-i || d.Limit != 3 {
+			t.Errorf("request %d: remaining %d limit %d", i, d.Remaining, d.Limit)
+		}
+	}
+	d := q.Allow("token:a", "GET /x")
+	if d.Allowed {
+		t.Fatal("request beyond burst allowed")
+	}
+	if d.RetryAfter != 500*time.Millisecond {
+		t.Errorf("RetryAfter = %v, want 500ms", d.RetryAfter)
+	}
+
+	// 其他客户端不受影响
+	if !q.Allow("token:b", "GET /x").Allowed {
+		t.Error("independent client was limited")
+	}
+
+	clock.advance(500 * time.Millisecond)
+	if !q.Allow("token:a", "GET /x").Allowed {
+		t.Error("request rejected after refill")
+	}
+}
+
+func TestQuota_RouteBucketIsAllOrNothing(t *testing.T) {
+	q, _ := newTestQuota(QuotaConfig{
+		Rate:   1,
+		Burst:  10,
+		Routes: map[string]RouteQuota{"POST /api/v1/search": {Rate: 1, Burst: 1}},
+	})
+
+	if !q.Allow("token:a", "POST /api/v1/search").Allowed {
+		t.Fatal("first search rejected")
+	}
+	d := q.Allow("token:a", "POST /api/v1/search")
+	if d.Allowed {
+		t.Fatal("second search allowed past route burst")
+	}
+	if d.Limit != 1 || d.Remaining != 0 {
+		t.Errorf("headers should describe the route bucket, got limit %d remaining %d", d.Limit, d.Remaining)
+	}
+	// 被拒的 search 不应消耗全局额度：10 - 1
+	d = q.Allow("token:a", "GET /api/v1/repositories")
+	if !d.Allowed || d.Remaining != 8 {
+		t.Errorf("global bucket: allowed=%v remaining=%d, want true/8", d.Allowed, d.Remaining)
+	}
+}
+
+func TestQuota_SweepsFullBuckets(t *testing.T) {
+	q, clock := newTestQuota(QuotaConfig{Rate: 10, Burst: 10})
+	q.Allow("ip:1.2.3.4", "GET /x")
+	q.Allow("ip:5.6.7.8", "GET /x")
+
+	clock.advance(2 * quotaSweepInterval)
+	q.Allow("ip:9.9.9.9", "GET /x")
+	if len(q.buckets) != 1 {
+		t.Errorf("expected refilled buckets to be dropped, have %d", len(q.buckets))
+	}
+}
+
+func TestQuota_CostAndWeight(t *testing.T) {
+	q := NewQuota(QuotaConfig{
+		Routes:  map[string]RouteQuota{"POST /api/v1/qa": {Cost: 4}},
+		Weights: map[string]float64{"human": 3},
+	})
+	if q.Cost("POST /api/v1/qa") != 4 || q.Cost("GET /x") != 1 {
+		t.Error("unexpected route cost")
+	}
+	if q.Weight("human") != 3 || q.Weight("bot") != 1 {
+		t.Error("unexpected token weight")
+	}
+	if !q.Allow("token:bot", "POST /api/v1/qa").Allowed {
+		t.Error("routes without a rate should not be limited")
+	}
+}
+
+func TestRateLimit_Middleware(t *testing.T) {
+	gin.SetMode(gin.TestMode)
+
+	q := NewQuota(QuotaConfig{Rate: 0.001, Burst: 1})
+	router := gin.New()
+	router.Use(RateLimit(q))
+	handled := 0
+	router.GET("/test", func(c *gin.Context) {
+		handled++
+		c.JSON(http.StatusOK, gin.H{"message": "success"})
+	})
+	router.GET("/health", func(c *gin.Context) {
+		c.JSON(http.StatusOK, gin.H{"status": "ok"})
+	})
+
+	do := func(path string) *httptest.ResponseRecorder {
+		req := httptest.NewRequest("GET", path, nil)
+		req.Header.Set("Authorization", "Bearer ci-bot")
+		w := httptest.NewRecorder()
+		router.ServeHTTP(w, req)
+		return w
+	}
+
+	w := do("/test")
+	if w.Code != http.StatusOK {
+		t.Fatalf("Expected status %d, got %d", http.StatusOK, w.Code)
+	}
+	if w.Header().Get(HeaderRateLimit) != "1" || w.Header().Get(HeaderRateLimitRemaining) != "0" {
+		t.Errorf("Unexpected headers: %v", w.Header())
+	}
+
+	w = do("/test")
+	if w.Code != http.StatusTooManyRequests {
+		t.Errorf("Expected status %d, got %d", http.StatusTooManyRequests, w.Code)
+	}
+	if w.Header().Get("Retry-After") == "" {
+		t.Error("Expected Retry-After header")
+	}
+	if handled != 1 {
+		t.Errorf("Expected the handler to run once, ran %d times", handled)
+	}
+
+	if w = do("/health"); w.Code != http.StatusOK {
+		t.Errorf("Health check should bypass quotas, got %d", w.Code)
+	}
+}
+
+func TestRateLimit_KeysByAuthenticatedToken(t *testing.T) {
+	gin.SetMode(gin.TestMode)
+
+	newRouter := func(auth *AuthConfig) *gin.Engine {
+		router := gin.New()
+		router.Use(Auth(auth))
+		router.Use(RateLimit(NewQuota(QuotaConfig{Rate: 0.001, Burst: 1})))
+		router.GET("/test", func(c *gin.Context) {
+			c.JSON(http.StatusOK, gin.H{"message": "success"})
+		})
+		return router
+	}
+	do := func(router *gin.Engine, token string) int {
+		req := httptest.NewRequest("GET", "/test", nil)
+		req.Header.Set("Authorization", "Bearer "+token)
+		w := httptest.NewRecorder()
+		router.ServeHTTP(w, req)
+		return w.Code
+	}
+
+	// 未开启认证：换 token 不能换来新的桶
+	router := newRouter(NewAuthConfig(false, nil))
+	if code := do(router, "a"); code != http.StatusOK {
+		t.Fatalf("Expected status %d, got %d", http.StatusOK, code)
+	}
+	if code := do(router, "b"); code != http.StatusTooManyRequests {
+		t.Errorf("Unvalidated tokens should share the IP bucket, got %d", code)
+	}
+
+	// 开启认证：每个有效 token 一个桶
+	router = newRouter(NewAuthConfig(true, []string{"a", "b"}))
+	if code := do(router, "a"); code != http.StatusOK {
+		t.Fatalf("Expected status %d, got %d", http.StatusOK, code)
+	}
+	if code := do(router, "b"); code != http.StatusOK {
+		t.Errorf("Each valid token should have its own bucket, got %d", code)
+	}
+	if code := do(router, "a"); code != http.StatusTooManyRequests {
+		t.Errorf("Expected status %d, got %d", http.StatusTooManyRequests, code)
+	}
+}
@@ -0,0 +1,143 @@
+package api
+
+import (
+	"context"
+	"encoding/json"
+	"net/http"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// WarmupTask is one step of post-start warm-up, such as loading a cache or
+// prewarming database buffers. Tasks run concurrently and a failed task does
+// not block readiness: warm-up only makes the first requests faster.
+// Background tasks do not gate readiness at all; they keep running after the
+// gate is marked ready and their outcome is only reported.
+type WarmupTask struct {
+	Name       string
+	Run        func(ctx context.Context) error
+	Background bool
+}
+
+// WarmupStatus reports the outcome of one warm-up task
+type WarmupStatus struct {
+	State    string `json:"state"` // running, done or failed
+	Duration string `json:"duration,omitempty"`
+	Error    string `json:"error,omitempty"`
+}
+
+// StartupGate is the listener's root handler while the server starts. It lets
+// the process bind its port before the database is connected, so a restarting
+// replica is reachable within milliseconds:
+//   - GET /ready returns 503 until warm-up finishes, then 200 (readiness probe)
+//   - GET /health returns 200 as soon as the process is up (liveness probe)
+//   - other requests get 503 with Retry-After until the API router is installed
+type StartupGate struct {
+	handler atomic.Value // http.Handler
+	ready   atomic.Bool
+	started time.Time
+
+	mu    sync.Mutex
+	tasks map[string]WarmupStatus
+}
+
+// NewStartupGate creates a gate with no router installed
+func NewStartupGate() *StartupGate {
+	return &StartupGate{started: time.Now(), tasks: make(map[string]WarmupStatus)}
+}
+
+// SetHandler installs the API router; requests other than /ready go to it
+// from now on
+func (g *StartupGate) SetHandler(h http.Handler) {
+	g.handler.Store(h)
+}
+
+// Ready reports whether warm-up has finished
+func (g *StartupGate) Ready() bool {
+	return g.ready.Load()
+}
+
+// MarkReady flips /ready to 200 without running warm-up tasks
+func (g *StartupGate) MarkReady() {
+	g.ready.Store(true)
+}
+
+// Warmup runs tasks concurrently, records each outcome for /ready and marks the
+// gate ready once all foreground tasks have returned. It blocks until then;
+// background tasks keep running with ctx, so bound ctx with a timeout.
+func (g *StartupGate) Warmup(ctx context.Context, tasks []WarmupTask) {
+	var wg sync.WaitGroup
+	for _, task := range tasks {
+		g.setStatus(task.Name, WarmupStatus{State: "running"})
+		if !task.Background {
+			wg.Add(1)
+		}
+		go func(task WarmupTask) {
+			if !task.Background {
+				defer wg.Done()
+			}
+			start := time.Now()
+			status := WarmupStatus{State: "done"}
+			if err := task.Run(ctx); err != nil {
+				status = WarmupStatus{State: "failed", Error: err.Error()}
+			}
+			status.Duration = time.Since(start).Round(time.Millisecond).String()
+			g.setStatus(task.Name, status)
+		}(task)
+	}
+	wg.Wait()
+	g.MarkReady()
+}
+
+func (g *StartupGate) setStatus(name string, status WarmupStatus) {
+	g.mu.Lock()
+	g.tasks[name] = status
+	g.mu.Unlock()
+}
+
+// ServeHTTP implements http.Handler
+func (g *StartupGate) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+	if r.URL.Path == "/ready" {
+		g.serveReady(w)
+		return
+	}
+	if h, ok := g.handler.Load().(http.Handler); ok {
+		h.ServeHTTP(w, r)
+		return
+	}
+	if r.URL.Path == "/health" {
+		writeJSON(w, http.StatusOK, map[string]string{
+			"status":  "starting",
+			"message": "CodeAtlas API server is starting",
+		})
+		return
+	}
+	w.Header().Set("Retry-After", "1")
+	writeJSON(w, http.StatusServiceUnavailable, map[string]string{"error": "Server is starting"})
+}
+
+func (g *StartupGate) serveReady(w http.ResponseWriter) {
+	g.mu.Lock()
+	tasks := make(map[string]WarmupStatus, len(g.tasks))
+	for name, status := range g.tasks {
+		tasks[name] = status
+	}
+	g.mu.Unlock()
+
+	status, code := "starting", http.StatusServiceUnavailable
+	if g.Ready() {
+		status, code = "ready", http.StatusOK
+	}
+	writeJSON(w, code, map[string]interface{}{
+		"status": status,
+		"uptime": time.Since(g.started).Round(time.Millisecond).String(),
+		"tasks":  tasks,
+	})
+}
+
+func writeJSON(w http.ResponseWriter, code int, body interface{}) {
+	w.Header().Set("Content-Type", "application/json; charset=utf-8")
+	w.WriteHeader(code)
+	_ = json.NewEncoder(w).Encode(body)
+}
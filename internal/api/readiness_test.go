@@ -0,0 +1,103 @@
+package api
+
+import (
+	"context"
+	"encoding/json"
+	"errors"
+	"net/http"
+	"net/http/httptest"
+	"testing"
+)
+
+func gateRequest(g *StartupGate, path string) *httptest.ResponseRecorder {
+	w := httptest.NewRecorder()
+	g.ServeHTTP(w, httptest.NewRequest("GET", path, nil))
+	return w
+}
+
+func TestStartupGate_BeforeRouter(t *testing.T) {
+	g := NewStartupGate()
+
+	if w := gateRequest(g, "/health"); w.Code != http.StatusOK {
+		t.Errorf("liveness should pass while starting, got %d", w.Code)
+	}
+	if w := gateRequest(g, "/ready"); w.Code != http.StatusServiceUnavailable {
+		t.Errorf("readiness should fail while starting, got %d", w.Code)
+	}
+	w := gateRequest(g, "/api/v1/repositories")
+	if w.Code != http.StatusServiceUnavailable {
+		t.Errorf("API requests should get 503 before the router is installed, got %d", w.Code)
+	}
+	if w.Header().Get("Retry-After") == "" {
+		t.Error("expected Retry-After on 503")
+	}
+}
+
+func TestStartupGate_WarmupFlipsReadiness(t *testing.T) {
+	g := NewStartupGate()
+	g.SetHandler(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		w.WriteHeader(http.StatusTeapot)
+	}))
+
+	if w := gateRequest(g, "/api/v1/repositories"); w.Code != http.StatusTeapot {
+		t.Errorf("requests should reach the router once installed, got %d", w.Code)
+	}
+	if w := gateRequest(g, "/ready"); w.Code != http.StatusServiceUnavailable {
+		t.Errorf("readiness should wait for warm-up, got %d", w.Code)
+	}
+
+	g.Warmup(context.Background(), []WarmupTask{
+		{Name: "ok", Run: func(ctx context.Context) error { return nil }},
+		{Name: "broken", Run: func(ctx context.Context) error { return errors.New("boom") }},
+	})
+
+	w := gateRequest(g, "/ready")
+	if w.Code != http.StatusOK {
+		t.Fatalf("expected ready after warm-up, got %d", w.Code)
+	}
+	var body struct {
+		Status string                  `json:"status"`
+		Tasks  map[string]WarmupStatus `json:"tasks"`
+	}
+	if err := json.Unmarshal(w.Body.Bytes(), &body); err != nil {
+		t.Fatalf("invalid /ready body: %v", err)
+	}
+	if body.Status != "ready" || body.Tasks["ok"].State != "done" {
+		t.Errorf("unexpected readiness body: %+v", body)
+	}
+	if got := body.Tasks["broken"]; got.State != "failed" || got.Error != "boom" {
+		t.Errorf("failed task should be reported, got %+v", got)
+	}
+}
+
+func TestStartupGate_BackgroundTaskDoesNotGate(t *testing.T) {
+	g := NewStartupGate()
+
+	release := make(chan struct{})
+	finished := make(chan struct{})
+	g.Warmup(context.Background(), []WarmupTask{
+		{Name: "generations", Run: func(ctx context.Context) error { return nil }},
+		{Name: "prewarm", Background: true, Run: func(ctx context.Context) error {
+			defer close(finished)
+			<-release
+			return nil
+		}},
+	})
+
+	w := gateRequest(g, "/ready")
+	if w.Code != http.StatusOK {
+		t.Fatalf("background tasks should not delay readiness, got %d", w.Code)
+	}
+	var body struct {
+		Tasks map[string]WarmupStatus `json:"tasks"`
+	}
+	if err := json.Unmarshal(w.Body.Bytes(), &body); err != nil {
+		t.Fatalf("invalid /ready body: %v", err)
+	}
+	if got := body.Tasks["prewarm"].State; got != "running" {
+		t.Errorf("expected the background task to still be running, got %q", got)
+	}
+
+	close(release)
+	<-finished
+}
@@ -3,6 +3,7 @@ package api
 import (
 	"context"
 	"net/http"
+	"time"
 
 	"github.com/gin-gonic/gin"
 	"github.com/google/uuid"
@@ -17,6 +18,26 @@ type ServerConfig struct {
 	AuthTokens     []string
 	CORSOrigins    []string
 	EmbedderConfig *handlers.EmbedderConfig
+
+	// LatencyObserver, when set, receives every request's route and latency
+	// (used to trigger flight recorder dumps on slow requests)
+	LatencyObserver middleware.LatencyObserver
+
+	// Quota, when set, enforces per-client token buckets and fair queuing
+	// ahead of every handler
+	Quota *middleware.QuotaConfig
+
+	// BulkLoad, when set, replaces the default rebuild budget for indexes
+	// deferred by bulk_load index requests
+	BulkLoad *models.BulkLoadConfig
+
+	// WriteParallelism is the number of file groups large index requests
+	// write concurrently before publishing them in one transaction
+	WriteParallelism int
+
+	// RescoreIndex, when set, enables the rescore search parameter once the
+	// half-precision index is ready
+	RescoreIndex *models.RescoreIndex
 }
 
 // Server represents the API server
@@ -42,14 +63,23 @@ func NewServer(db *models.DB, config *ServerConfig) *Server {
 		}
 	}
 
+	indexHandler := handlers.NewIndexHandler(db, config.EmbedderConfig)
+	if config.BulkLoad != nil {
+		indexHandler.SetBulkLoadConfig(*config.BulkLoad)
+	}
+	indexHandler.SetWriteParallelism(config.WriteParallelism)
+
+	searchHandler := handlers.NewSearchHandler(db, config.EmbedderConfig)
+	searchHandler.SetRescoreIndex(config.RescoreIndex)
+
 	return &Server{
 		db:                  db,
 		config:              config,
 		repoRepository:      models.NewRepositoryRepository(db),
 		fileRepository:      models.NewFileRepository(db),
-		indexHandler:        handlers.NewIndexHandler(db, config.EmbedderConfig),
+		indexHandler:        indexHandler,
 		repoHandler:         handlers.NewRepositoryHandler(db),
-		searchHandler:       handlers.NewSearchHandler(db, config.EmbedderConfig),
+		searchHandler:       searchHandler,
 		relationshipHandler: handlers.NewRelationshipHandler(db),
 		qaHandler:           handlers.NewQAHandler(db, config.EmbedderConfig),
 	}
@@ -63,6 +93,11 @@ func (s *Server) SetupRouter() *gin.Engine {
 	// Add recovery middleware
 	r.Use(gin.Recovery())
 
+	// Add latency observer (measures the full middleware chain)
+	if s.config.LatencyObserver != nil {
+		r.Use(middleware.Latency(s.config.LatencyObserver))
+	}
+
 	// Add logging middleware
 	r.Use(middleware.Logging())
 
@@ -74,6 +109,11 @@ func (s *Server) SetupRouter() *gin.Engine {
 	authConfig := middleware.NewAuthConfig(s.config.EnableAuth, s.config.AuthTokens)
 	r.Use(middleware.Auth(authConfig))
 
+	// Add quota middleware (after auth: only valid tokens get their own budget)
+	if s.config.Quota != nil {
+		r.Use(middleware.RateLimit(middleware.NewQuota(*s.config.Quota)))
+	}
+
 	// Register routes
 	s.RegisterRoutes(r)
 
@@ -85,6 +125,11 @@ func (s *Server) RegisterRoutes(r *gin.Engine) {
 	// Health check endpoint (no auth required)
 	r.GET("/health", s.healthCheck)
 
+	// Conditional GET validators derived from repository index generations
+	gens := s.db.Generations()
+	repoConditional := middleware.ConditionalGET(middleware.RepoGeneration(gens, "id"))
+	globalConditional := middleware.ConditionalGET(middleware.GlobalGeneration(gens))
+
 	// API v1 routes
 	v1 := r.Group("/api/v1")
 	{
@@ -92,21 +137,22 @@ func (s *Server) RegisterRoutes(r *gin.Engine) {
 		v1.POST("/index", s.indexHandler.Index)
 
 		// Repository endpoints
-		v1.GET("/repositories", s.repoHandler.GetAll)
-		v1.GET("/repositories/:id", s.repoHandler.GetByID)
+		v1.GET("/repositories", globalConditional, s.repoHandler.GetAll)
+		v1.GET("/repositories/:id", repoConditional, s.repoHandler.GetByID)
 		v1.POST("/repositories", s.createRepository)
 
 		// Search endpoint
 		v1.POST("/search", s.searchHandler.Search)
 
 		// Relationship endpoints
-		v1.GET("/symbols/:id/callers", s.relationshipHandler.GetCallers)
-		v1.GET("/symbols/:id/callees", s.relationshipHandler.GetCallees)
-		v1.GET("/symbols/:id/dependencies", s.relationshipHandler.GetDependencies)
+		v1.GET("/symbols/:id/callers", globalConditional, s.relationshipHandler.GetCallers)
+		v1.GET("/symbols/:id/callees", globalConditional, s.relationshipHandler.GetCallees)
+		v1.GET("/symbols/:id/dependencies", globalConditional, s.relationshipHandler.GetDependencies)
 		// Transitive (multi-hop) relationship endpoints
-		v1.GET("/symbols/:id/transitive-callers", s.relationshipHandler.GetTransitiveCallers)
-		v1.GET("/symbols/:id/transitive-callees", s.relationshipHandler.GetTransitiveCallees)
-		v1.GET("/files/:id/symbols", s.relationshipHandler.GetFileSymbols)
+		v1.GET("/symbols/:id/transitive-callers", globalConditional, s.relationshipHandler.GetTransitiveCallers)
+		v1.GET("/symbols/:id/transitive-callees", globalConditional, s.relationshipHandler.GetTransitiveCallees)
+		v1.GET("/files/:id/symbols", globalConditional, s.relationshipHandler.GetFileSymbols)
+		v1.GET("/modules/dependents", globalConditional, s.relationshipHandler.GetModuleDependents)
 
 		// File endpoints
 		v1.POST("/files", s.createFile)
@@ -117,6 +163,11 @@ func (s *Server) RegisterRoutes(r *gin.Engine) {
 		// QA endpoints
 		v1.POST("/qa", s.qaHandler.Ask)
 		v1.GET("/qa/chunks", s.qaHandler.GetChunks)
+
+		// Admin endpoints
+		v1.GET("/admin/pool", s.poolStatus)
+		v1.GET("/admin/queries", s.queryStats)
+		v1.DELETE("/admin/queries", s.resetQueryStats)
 	}
 }
 
@@ -128,6 +179,26 @@ func (s *Server) healthCheck(c *gin.Context) {
 	})
 }
 
+// poolStatus returns connection pool limits, stats and adaptive controller decisions
+func (s *Server) poolStatus(c *gin.Context) {
+	if s.db == nil {
+		c.JSON(http.StatusServiceUnavailable, gin.H{"error": "Database not configured"})
+		return
+	}
+	c.JSON(http.StatusOK, s.db.PoolStatus())
+}
+
+// queryStats returns per-statement latency histograms and captured slow queries
+func (s *Server) queryStats(c *gin.Context) {
+	c.JSON(http.StatusOK, s.db.QueryStats().Snapshot())
+}
+
+// resetQueryStats clears statement statistics, e.g. after a deployment
+func (s *Server) resetQueryStats(c *gin.Context) {
+	s.db.QueryStats().Reset()
+	c.Status(http.StatusNoContent)
+}
+
 // createRepository handles repository creation
 func (s *Server) createRepository(c *gin.Context) {
 	var req struct {
@@ -158,6 +229,8 @@ func (s *Server) createRepository(c *gin.Context) {
 		c.JSON(http.StatusInternalServerError, gin.H{"error": err.Error()})
 		return
 	}
+	// 新仓库改变全局指纹：本进程立即重新加载，其他副本在 TTL 内看到
+	s.db.Generations().Expire()
 
 	c.JSON(http.StatusCreated, repo)
 }
@@ -214,15 +287,21 @@ func (s *Server) createFile(c *gin.Context) {
 		c.JSON(http.StatusInternalServerError, gin.H{"error": err.Error()})
 		return
 	}
+	// 持久化的代数是所有副本验证器的来源
+	if _, err := s.repoRepository.BumpIndexGeneration(ctx, file.RepoID); err != nil {
+		s.db.Generations().Invalidate(file.RepoID)
+	}
 
 	c.JSON(http.StatusCreated, file)
 }
 
-// createCommit handles commit creation
+// createCommit registers commit metadata for the commit-level history.
+// Symbols and edges are attached when the commit is indexed with history enabled.
 func (s *Server) createCommit(c *gin.Context) {
 	var req struct {
-		RepositoryID int    `json:"repository_id" binding:"required"`
+		RepositoryID string `json:"repository_id" binding:"required"`
 		Hash         string `json:"hash" binding:"required"`
+		ParentHash   string `json:"parent_hash"`
 		Author       string `json:"author" binding:"required"`
 		Email        string `json:"email" binding:"required"`
 		Message      string `json:"message" binding:"required"`
@@ -235,7 +314,37 @@ func (s *Server) createCommit(c *gin.Context) {
 	}
 
 	// Parse timestamp
-	// TODO: Implement proper timestamp parsing
+	committedAt, err := time.Parse(time.RFC3339, req.Timestamp)
+	if err != nil {
+		c.JSON(http.StatusBadRequest, gin.H{"error": "timestamp must be RFC 3339"})
+		return
+	}
+
+	commit := &models.Commit{
+		RepoID:      req.RepositoryID,
+		Hash:        req.Hash,
+		ParentHash:  req.ParentHash,
+		Author:      req.Author,
+		Email:       req.Email,
+		Message:     req.Message,
+		CommittedAt: &committedAt,
+	}
+
+	ctx := c.Request.Context()
+	repo, err := s.repoRepository.GetByID(ctx, req.RepositoryID)
+	if err != nil {
+		c.JSON(http.StatusInternalServerError, gin.H{"error": err.Error()})
+		return
+	}
+	if repo == nil {
+		c.JSON(http.StatusNotFound, gin.H{"error": "Repository not found"})
+		return
+	}
+
+	if err := models.NewHistoryRepository(s.db).RegisterCommit(ctx, commit); err != nil {
+		c.JSON(http.StatusInternalServerError, gin.H{"error": err.Error()})
+		return
+	}
 
-	c.JSON(http.StatusNotImplemented, gin.H{"error": "Not implemented yet"})
+	c.JSON(http.StatusCreated, commit)
 }
@@ -0,0 +1,261 @@
+package archive
+
+import (
+	"archive/tar"
+	"bytes"
+	"database/sql"
+	"errors"
+	"io"
+	"os"
+	"path/filepath"
+	"reflect"
+	"strings"
+	"testing"
+	"time"
+)
+
+// fakeRows 以 *string 行模拟 *sql.Rows（nil 为 NULL）。
+type fakeRows struct {
+	rows [][]*string
+	i    int
+}
+
+func (f *fakeRows) Next() bool {
+	f.i++
+	return f.i <= len(f.rows)
+}
+
+func (f *fakeRows) Scan(dest ...interface{}) error {
+	for i, v := range f.rows[f.i-1] {
+		ns := dest[i].(*sql.NullString)
+		*ns = sql.NullString{}
+		if v != nil {
+			*ns = sql.NullString{String: *v, Valid: true}
+		}
+	}
+	return nil
+}
+
+func (f *fakeRows) Err() error { return nil }
+
+func str(s string) *string { return &s }
+
+func testRows() [][]*string {
+	return [][]*string{
+		{str("9a1f0c8e-0000-4000-8000-000000000001"), str("main"), nil, str(`{"k": "v"}`)},
+		{str("9a1f0c8e-0000-4000-8000-000000000002"), str("多行\n文本\t\"引号\" <tag>"), str("[0.25,-1,3e-05]"), nil},
+	}
+}
+
+// encodeTable 用 writeTable 编码 rows，返回字节与对应的 manifest 条目。
+func encodeTable(t *testing.T, name string, columns []string, rows [][]*string) ([]byte, TableSummary) {
+	t.Helper()
+	var buf bytes.Buffer
+	dw := newDigestWriter(&buf)
+	n, err := writeTable(dw, &fakeRows{rows: rows}, len(columns))
+	if err != nil {
+		t.Fatalf("writeTable: %v", err)
+	}
+	return buf.Bytes(), TableSummary{
+		Name:    name,
+		File:    tableFileName(name),
+		Columns: columns,
+		Rows:    n,
+		Bytes:   dw.n,
+		SHA256:  dw.sum(),
+	}
+}
+
+func TestTableRoundTrip(t *testing.T) {
+	rows := testRows()
+	data, summary := encodeTable(t, "files", []string{"file_id", "path", "checksum", "language"}, rows)
+	if summary.Rows != int64(len(rows)) {
+		t.Fatalf("rows = %d, want %d", summary.Rows, len(rows))
+	}
+
+	var got [][]*string
+	err := readTable(bytes.NewReader(data), &summary, func(values []interface{}) error {
+		row := make([]*string, len(values))
+		for i, v := range values {
+			if v != nil {
+				s := v.(string)
+				row[i] = &s
+			}
+		}
+		got = append(got, row)
+		return nil
+	})
+	if err != nil {
+		t.Fatalf("readTable: %v", err)
+	}
+	if !reflect.DeepEqual(got, rows) {
+		t.Errorf("round trip mismatch:\n got %v\nwant %v", got, rows)
+	}
+}
+
+func TestReadTableDetectsTampering(t *testing.T) {
+	columns := []string{"file_id", "path", "checksum", "language"}
+	data, summary := encodeTable(t, "files", columns, testRows())
+	noop := func([]interface{}) error { return nil }
+
+	t.Run("checksum", func(t *testing.T) {
+		s := summary
+		s.SHA256 = strings.Repeat("0", 64)
+		err := readTable(bytes.NewReader(data), &s, noop)
+		if !errors.Is(err, ErrChecksumMismatch) {
+			t.Errorf("expected ErrChecksumMismatch, got %v", err)
+		}
+	})
+
+	t.Run("row_count", func(t *testing.T) {
+		s := summary
+		s.Rows++
+		err := readTable(bytes.NewReader(data), &s, noop)
+		if !errors.Is(err, ErrCorrupt) {
+			t.Errorf("expected ErrCorrupt, got %v", err)
+		}
+	})
+
+	t.Run("flipped_byte", func(t *testing.T) {
+		bad := append([]byte(nil), data...)
+		bad[len(bad)/2] ^= 0xff
+		err := readTable(bytes.NewReader(bad), &summary, noop)
+		if !errors.Is(err, ErrCorrupt) && !errors.Is(err, ErrChecksumMismatch) {
+			t.Errorf("expected corruption to be detected, got %v", err)
+		}
+	})
+
+	t.Run("column_count", func(t *testing.T) {
+		s := summary
+		s.Columns = columns[:3]
+		err := readTable(bytes.NewReader(data), &s, noop)
+		if !errors.Is(err, ErrCorrupt) {
+			t.Errorf("expected ErrCorrupt, got %v", err)
+		}
+	})
+
+	t.Run("callback_error", func(t *testing.T) {
+		boom := errors.New("boom")
+		err := readTable(bytes.NewReader(data), &summary, func([]interface{}) error { return boom })
+		if !errors.Is(err, boom) {
+			t.Errorf("expected callback error, got %v", err)
+		}
+	})
+}
+
+func TestArchiveLayout(t *testing.T) {
+	dir := t.TempDir()
+	manifest := &Manifest{
+		FormatVersion: FormatVersion,
+		CreatedAt:     time.Date(2026, 1, 2, 3, 4, 5, 0, time.UTC),
+		SchemaVersion: 20260101000007,
+		RepoID:        "9a1f0c8e-0000-4000-8000-0000000000aa",
+		RepoName:      "demo",
+	}
+	for _, name := range []string{"repositories", "files"} {
+		var columns []string
+		for _, spec := range tableSpecs {
+			if spec.name == name {
+				columns = spec.columns[:4]
+			}
+		}
+		data, summary := encodeTable(t, name, columns, testRows())
+		if err := os.WriteFile(filepath.Join(dir, summary.File), data, 0o644); err != nil {
+			t.Fatal(err)
+		}
+		manifest.Tables = append(manifest.Tables, summary)
+	}
+
+	var buf bytes.Buffer
+	if err := writeArchive(&buf, manifest, dir); err != nil {
+		t.Fatalf("writeArchive: %v", err)
+	}
+
+	tr := tar.NewReader(bytes.NewReader(buf.Bytes()))
+	got, err := readManifest(tr)
+	if err != nil {
+		t.Fatalf("readManifest: %v", err)
+	}
+	if !reflect.DeepEqual(got, manifest) {
+		t.Errorf("manifest mismatch:\n got %+v\nwant %+v", got, manifest)
+	}
+	for i := range got.Tables {
+		hdr, err := tr.Next()
+		if err != nil {
+			t.Fatalf("entry %d: %v", i, err)
+		}
+		if hdr.Name != got.Tables[i].File {
+			t.Errorf("entry %d = %s, want %s", i, hdr.Name, got.Tables[i].File)
+		}
+		if err := readTable(tr, &got.Tables[i], func([]interface{}) error { return nil }); err != nil {
+			t.Errorf("readTable(%s): %v", hdr.Name, err)
+		}
+	}
+	if _, err := tr.Next(); err != io.EOF {
+		t.Errorf("expected end of archive, got %v", err)
+	}
+
+	if _, err := ReadManifest(strings.NewReader("not an archive")); !errors.Is(err, ErrNotArchive) {
+		t.Errorf("expected ErrNotArchive, got %v", err)
+	}
+}
+
+func TestManifestValidate(t *testing.T) {
+	valid := func() *Manifest {
+		return &Manifest{
+			FormatVersion: FormatVersion,
+			RepoID:        "r1",
+			Tables: []TableSummary{
+				{Name: "repositories", File: "repositories.jsonl.gz", Columns: []string{"repo_id", "name"}},
+				{Name: "files", File: "files.jsonl.gz", Columns: []string{"file_id", "repo_id"}},
+			},
+		}
+	}
+	if err := valid().validate(); err != nil {
+		t.Fatalf("valid manifest rejected: %v", err)
+	}
+
+	tests := []struct {
+		name   string
+		mutate func(m *Manifest)
+		want   error
+	}{
+		{"version", func(m *Manifest) { m.FormatVersion = FormatVersion + 1 }, ErrUnsupportedVersion},
+		{"no_repository", func(m *Manifest) { m.Tables = m.Tables[1:] }, ErrCorrupt},
+		{"unknown_table", func(m *Manifest) { m.Tables[1].Name = "pg_authid" }, ErrCorrupt},
+		{"unknown_column", func(m *Manifest) { m.Tables[1].Columns = []string{"file_id); DROP TABLE files; --"} }, ErrCorrupt},
+		{"duplicate_table", func(m *Manifest) { m.Tables[1] = m.Tables[0] }, ErrCorrupt},
+		{"bad_file", func(m *Manifest) { m.Tables[1].File = "../files.jsonl.gz" }, ErrCorrupt},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			m := valid()
+			tt.mutate(m)
+			if err := m.validate(); !errors.Is(err, tt.want) {
+				t.Errorf("expected %v, got %v", tt.want, err)
+			}
+		})
+	}
+}
+
+func TestSelectQuery(t *testing.T) {
+	for _, spec := range tableSpecs {
+		query := spec.selectQuery()
+		if got := strings.Count(query, "::text"); got != len(spec.columns) {
+			t.Errorf("%s: %d ::text casts, want %d", spec.name, got, len(spec.columns))
+		}
+		if !strings.Contains(query, "$1") {
+			t.Errorf("%s: query is not scoped to the repository", spec.name)
+		}
+	}
+	// 跨仓库目标不能被导出
+	for _, spec := range tableSpecs {
+		if spec.name == "edges" && !strings.Contains(spec.selectQuery(), "CASE WHEN t.target_id IN") {
+			t.Error("edges: target_id should be limited to the exported repository")
+		}
+		// module_id 只在源库有效，模块以名字导出
+		if spec.name == "edges" && !strings.Contains(spec.selectQuery(), "FROM external_modules") {
+			t.Error("edges: target modules should be exported by name")
+		}
+	}
+}
@@ -0,0 +1,190 @@
+package archive
+
+import (
+	"archive/tar"
+	"bufio"
+	"bytes"
+	"context"
+	"database/sql"
+	"encoding/json"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"time"
+
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+// ExportOptions 控制归档内容。
+type ExportOptions struct {
+	// IncludeAST 导出 ast_nodes。AST 通常是最大的表，而检索与图查询不依赖它。
+	IncludeAST bool
+}
+
+// ExportFile 把仓库导出为归档文件。先写临时文件再 rename，
+// 不会留下写了一半的归档。
+func ExportFile(ctx context.Context, db *models.DB, repoID, path string, opts ExportOptions) (*Manifest, error) {
+	dir := filepath.Dir(path)
+	tmp, err := os.CreateTemp(dir, ".archive-*")
+	if err != nil {
+		return nil, fmt.Errorf("failed to create temp file: %w", err)
+	}
+	tmpPath := tmp.Name()
+	defer os.Remove(tmpPath)
+
+	bw := bufio.NewWriterSize(tmp, 1<<20)
+	manifest, err := Export(ctx, db, repoID, bw, opts)
+	if err != nil {
+		tmp.Close()
+		return nil, err
+	}
+	if err := bw.Flush(); err != nil {
+		tmp.Close()
+		return nil, fmt.Errorf("failed to flush archive: %w", err)
+	}
+	if err := tmp.Sync(); err != nil {
+		tmp.Close()
+		return nil, fmt.Errorf("failed to sync archive: %w", err)
+	}
+	if err := tmp.Close(); err != nil {
+		return nil, fmt.Errorf("failed to close archive: %w", err)
+	}
+	if err := os.Rename(tmpPath, path); err != nil {
+		return nil, fmt.Errorf("failed to move archive into place: %w", err)
+	}
+	return manifest, nil
+}
+
+// Export 把仓库 repoID 的全部行写成归档。所有表在同一个只读
+// REPEATABLE READ 事务中读取，即使导出期间有索引写入，归档也是一致的快照。
+//
+// tar 条目需要事先知道长度，各表先写到临时目录，最后连同 manifest 一起打包。
+func Export(ctx context.Context, db *models.DB, repoID string, w io.Writer, opts ExportOptions) (*Manifest, error) {
+	schemaVersion, err := models.MigrationStatus(ctx, db.DB)
+	if err != nil {
+		return nil, err
+	}
+
+	tx, err := db.Bulk().BeginTx(ctx, &sql.TxOptions{Isolation: sql.LevelRepeatableRead, ReadOnly: true})
+	if err != nil {
+		return nil, fmt.Errorf("failed to begin transaction: %w", err)
+	}
+	defer tx.Rollback()
+
+	manifest := &Manifest{
+		FormatVersion: FormatVersion,
+		CreatedAt:     time.Now().UTC(),
+		SchemaVersion: schemaVersion,
+		RepoID:        repoID,
+	}
+	var commit sql.NullString
+	err = tx.QueryRowContext(ctx, `SELECT name, commit_hash FROM repositories WHERE repo_id = $1`, repoID).
+		Scan(&manifest.RepoName, &commit)
+	if err != nil {
+		if err == sql.ErrNoRows {
+			return nil, fmt.Errorf("repository not found: %s", repoID)
+		}
+		return nil, fmt.Errorf("failed to read repository: %w", err)
+	}
+	manifest.CommitHash = commit.String
+
+	tmpDir, err := os.MkdirTemp("", "codeatlas-export-*")
+	if err != nil {
+		return nil, fmt.Errorf("failed to create temp dir: %w", err)
+	}
+	defer os.RemoveAll(tmpDir)
+
+	for _, spec := range tableSpecs {
+		if spec.optional && !opts.IncludeAST {
+			continue
+		}
+		summary, err := exportTable(ctx, tx, spec, repoID, filepath.Join(tmpDir, tableFileName(spec.name)))
+		if err != nil {
+			return nil, fmt.Errorf("failed to export %s: %w", spec.name, err)
+		}
+		manifest.Tables = append(manifest.Tables, *summary)
+	}
+
+	if err := writeArchive(w, manifest, tmpDir); err != nil {
+		return nil, err
+	}
+	return manifest, nil
+}
+
+// exportTable 把一张表写入 path，返回它在 manifest 中的条目。
+func exportTable(ctx context.Context, tx *sql.Tx, spec tableSpec, repoID, path string) (*TableSummary, error) {
+	f, err := os.Create(path)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+
+	rows, err := tx.QueryContext(ctx, spec.selectQuery(), repoID)
+	if err != nil {
+		return nil, err
+	}
+	defer rows.Close()
+
+	bw := bufio.NewWriterSize(f, 1<<20)
+	dw := newDigestWriter(bw)
+	n, err := writeTable(dw, rows, len(spec.columns))
+	if err != nil {
+		return nil, err
+	}
+	if err := bw.Flush(); err != nil {
+		return nil, err
+	}
+	return &TableSummary{
+		Name:    spec.name,
+		File:    tableFileName(spec.name),
+		Columns: spec.columns,
+		Rows:    n,
+		Bytes:   dw.n,
+		SHA256:  dw.sum(),
+	}, f.Close()
+}
+
+// writeArchive 写出 tar：manifest 在前，随后按 manifest 顺序写各表文件。
+func writeArchive(w io.Writer, manifest *Manifest, dir string) error {
+	tw := tar.NewWriter(w)
+	data, err := json.MarshalIndent(manifest, "", "  ")
+	if err != nil {
+		return fmt.Errorf("failed to encode manifest: %w", err)
+	}
+	if err := writeEntry(tw, manifestName, int64(len(data)), manifest.CreatedAt, bytes.NewReader(data)); err != nil {
+		return err
+	}
+	for _, t := range manifest.Tables {
+		f, err := os.Open(filepath.Join(dir, t.File))
+		if err != nil {
+			return err
+		}
+		err = writeEntry(tw, t.File, t.Bytes, manifest.CreatedAt, f)
+		f.Close()
+		if err != nil {
+			return err
+		}
+	}
+	if err := tw.Close(); err != nil {
+		return fmt.Errorf("failed to finish archive: %w", err)
+	}
+	return nil
+}
+
+func writeEntry(tw *tar.Writer, name string, size int64, modTime time.Time, r io.Reader) error {
+	hdr := &tar.Header{
+		Name:    name,
+		Mode:    0o644,
+		Size:    size,
+		ModTime: modTime,
+		Format:  tar.FormatPAX,
+	}
+	if err := tw.WriteHeader(hdr); err != nil {
+		return fmt.Errorf("failed to write %s: %w", name, err)
+	}
+	if _, err := io.Copy(tw, r); err != nil {
+		return fmt.Errorf("failed to write %s: %w", name, err)
+	}
+	return nil
+}
@@ -0,0 +1,220 @@
+// Package archive 提供仓库级快照归档：把一个仓库在数据库中的全部行
+// （files、symbols、edges、提交历史、可选的 AST、vectors 等）导出为一个带版本号的
+// 归档文件，再在另一个数据库里通过 COPY 批量导入，用于新 API 副本或测试
+// 环境的快速初始化，免去重新 parse / index / embedding。
+//
+// 与 internal/snapshot 不同：snapshot 是给离线查询 mmap 的只读索引，
+// archive 是数据库行的无损搬运格式。
+//
+// 文件布局（POSIX tar，不整体压缩）：
+//
+//	manifest.json       : Manifest（格式版本、schema 版本、各表的列、行数、sha256）
+//	<table>.jsonl.gz    : 按 Manifest.Tables 顺序排列，每行一个 JSON 数组，
+//	                      元素为该列的 PostgreSQL 文本表示或 null
+//
+// 表按外键依赖顺序排列，导入端按顺序 COPY 即可满足约束。sha256 针对 tar 中
+// 存储的（压缩后）字节计算，导入端边读边校验。
+package archive
+
+import (
+	"errors"
+	"fmt"
+	"time"
+)
+
+// FormatVersion 是当前归档格式版本；导入端拒绝不认识的版本。
+const FormatVersion uint32 = 1
+
+// manifestName 是 tar 中第一个条目的文件名。
+const manifestName = "manifest.json"
+
+var (
+	// ErrNotArchive 表示文件不是归档（缺少 manifest 或 manifest 不在首位）。
+	ErrNotArchive = errors.New("archive: missing manifest")
+	// ErrUnsupportedVersion 表示归档由不兼容的格式版本写出。
+	ErrUnsupportedVersion = errors.New("archive: unsupported format version")
+	// ErrSchemaTooNew 表示归档来自迁移版本更高的数据库，需要先升级目标库。
+	ErrSchemaTooNew = errors.New("archive: archive schema is newer than the target database")
+	// ErrCorrupt 表示条目缺失、乱序或行数与 manifest 不一致。
+	ErrCorrupt = errors.New("archive: corrupt archive")
+	// ErrChecksumMismatch 表示条目内容的 sha256 与 manifest 不一致。
+	ErrChecksumMismatch = errors.New("archive: checksum mismatch")
+	// ErrRepositoryExists 表示目标库已有同 ID 或同名仓库且未指定替换。
+	ErrRepositoryExists = errors.New("archive: repository already exists")
+)
+
+// Manifest 描述一个归档。
+type Manifest struct {
+	FormatVersion uint32    `json:"format_version"`
+	CreatedAt     time.Time `json:"created_at"`
+	// SchemaVersion 是导出端数据库的 goose 迁移版本。
+	SchemaVersion int64          `json:"schema_version"`
+	RepoID        string         `json:"repo_id"`
+	RepoName      string         `json:"repo_name"`
+	CommitHash    string         `json:"commit_hash,omitempty"`
+	Tables        []TableSummary `json:"tables"`
+}
+
+// TableSummary 描述归档中的一张表。
+type TableSummary struct {
+	Name    string   `json:"name"`
+	File    string   `json:"file"`
+	Columns []string `json:"columns"`
+	Rows    int64    `json:"rows"`
+	Bytes   int64    `json:"bytes"`
+	SHA256  string   `json:"sha256"`
+}
+
+// validate 检查 manifest 本身的一致性。
+func (m *Manifest) validate() error {
+	if m.FormatVersion != FormatVersion {
+		return fmt.Errorf("%w: %d (supported: %d)", ErrUnsupportedVersion, m.FormatVersion, FormatVersion)
+	}
+	if m.RepoID == "" || len(m.Tables) == 0 || m.Tables[0].Name != "repositories" {
+		return fmt.Errorf("%w: manifest has no repository", ErrCorrupt)
+	}
+	// 表名与列名会进入 COPY 语句，只接受已知的表和列
+	known := make(map[string]map[string]bool, len(tableSpecs))
+	for _, spec := range tableSpecs {
+		known[spec.name] = make(map[string]bool, len(spec.columns))
+		for _, col := range spec.columns {
+			known[spec.name][col] = true
+		}
+	}
+	seen := make(map[string]bool, len(m.Tables))
+	for _, t := range m.Tables {
+		columns, ok := known[t.Name]
+		if !ok || seen[t.Name] {
+			return fmt.Errorf("%w: unexpected table %q", ErrCorrupt, t.Name)
+		}
+		if len(t.Columns) == 0 || t.File != tableFileName(t.Name) {
+			return fmt.Errorf("%w: bad entry for table %q", ErrCorrupt, t.Name)
+		}
+		for _, col := range t.Columns {
+			if !columns[col] {
+				return fmt.Errorf("%w: unexpected column %s.%s", ErrCorrupt, t.Name, col)
+			}
+		}
+		seen[t.Name] = true
+	}
+	return nil
+}
+
+func tableFileName(table string) string {
+	return table + ".jsonl.gz"
+}
+
+// tableSpec 定义一张表的导出方式。列统一以 ::text 导出，导入时由 COPY 的
+// 文本格式解析回原类型，因此 uuid、jsonb、timestamp、vector 等无需逐类型处理。
+// 生成列（content_tsv、name_tsv）不导出，由目标库重新计算。
+type tableSpec struct {
+	name    string
+	columns []string
+	// from 是 FROM 及之后的子句，$1 为 repo_id；列以别名 t 引用。
+	from string
+	// optional 的表只在 ExportOptions 要求时导出。
+	optional bool
+	// selects 覆盖个别列的导出表达式（默认 t.<col>）。
+	selects map[string]string
+}
+
+// repoSymbols / repoFiles 是仓库范围的子查询。
+const (
+	repoFiles   = `SELECT file_id FROM files WHERE repo_id = $1`
+	repoSymbols = `SELECT s.symbol_id FROM symbols s JOIN files f ON f.file_id = s.file_id WHERE f.repo_id = $1`
+)
+
+// tableSpecs 按外键依赖顺序排列，导出与导入都按此顺序进行。
+var tableSpecs = []tableSpec{
+	{
+		name:    "repositories",
+		columns: []string{"repo_id", "name", "url", "branch", "commit_hash", "metadata", "index_generation", "created_at", "updated_at"},
+		from:    `FROM repositories t WHERE t.repo_id = $1`,
+	},
+	{
+		name:    "commits",
+		columns: []string{"repo_id", "seq", "commit_hash", "parent_hash", "author", "email", "message", "committed_at", "indexed_at", "created_at"},
+		from:    `FROM commits t WHERE t.repo_id = $1 ORDER BY t.seq`,
+	},
+	{
+		name: "symbol_history",
+		columns: []string{"repo_id", "symbol_key", "symbol_id", "file_path", "name", "kind", "signature",
+			"start_line", "end_line", "valid_from", "valid_to"},
+		from: `FROM symbol_history t WHERE t.repo_id = $1 ORDER BY t.symbol_key, t.valid_from`,
+	},
+	{
+		name: "edge_history",
+		columns: []string{"repo_id", "source_key", "source_path", "target_key", "target_path", "target_module",
+			"target_name", "edge_type", "valid_from", "valid_to"},
+		from: `FROM edge_history t WHERE t.repo_id = $1
+			ORDER BY t.source_key, t.edge_type, t.target_key, t.target_module, t.target_name, t.valid_from`,
+	},
+	{
+		name:    "files",
+		columns: []string{"file_id", "repo_id", "path", "language", "size", "checksum", "created_at", "updated_at", "canonical_file_id", "api_only"},
+		from:    `FROM files t WHERE t.repo_id = $1 ORDER BY t.file_id`,
+	},
+	{
+		name: "symbols",
+		columns: []string{"symbol_id", "file_id", "name", "kind", "signature", "start_line", "end_line",
+			"start_byte", "end_byte", "docstring", "semantic_summary", "created_at"},
+		from: `FROM symbols t WHERE t.file_id IN (` + repoFiles + `) ORDER BY t.symbol_id`,
+	},
+	{
+		name:    "docstrings",
+		columns: []string{"doc_id", "symbol_id", "content", "created_at"},
+		from:    `FROM docstrings t WHERE t.symbol_id IN (` + repoSymbols + `) ORDER BY t.doc_id`,
+	},
+	{
+		name: "ast_nodes",
+		columns: []string{"node_id", "file_id", "type", "parent_id", "start_line", "end_line",
+			"start_byte", "end_byte", "text", "attributes", "created_at"},
+		from:     `FROM ast_nodes t WHERE t.file_id IN (` + repoFiles + `) ORDER BY t.node_id`,
+		optional: true,
+	},
+	{
+		name: "edges",
+		columns: []string{"edge_id", "source_id", "target_id", "edge_type", "source_file", "target_file",
+			"target_module", "target_name", "line_number", "created_at"},
+		from: `FROM edges t WHERE t.source_id IN (` + repoSymbols + `) ORDER BY t.edge_id`,
+		// 指向其他仓库的目标在导入端不存在，导出为未解析边；
+		// 外部模块以名字导出（module_id 只在本库有效），导入时重新 intern
+		selects: map[string]string{
+			"target_id":     `CASE WHEN t.target_id IN (` + repoSymbols + `) THEN t.target_id END`,
+			"target_module": `SELECT m.name FROM external_modules m WHERE m.module_id = t.target_module_id`,
+		},
+	},
+	{
+		name:    "vectors",
+		columns: []string{"vector_id", "entity_id", "entity_type", "embedding", "content", "model", "chunk_index", "created_at"},
+		from: `FROM vectors t WHERE (t.entity_type = 'symbol' AND t.entity_id IN (` + repoSymbols + `))
+			OR (t.entity_type = 'file' AND t.entity_id IN (` + repoFiles + `)) ORDER BY t.vector_id`,
+	},
+	{
+		name:    "coarse_vectors",
+		columns: []string{"vector_id", "entity_id", "level", "file_id", "embedding", "content_hash", "model", "chunk_index", "created_at"},
+		from:    `FROM coarse_vectors t WHERE t.file_id IN (` + repoFiles + `) ORDER BY t.vector_id`,
+	},
+	{
+		name:    "summaries",
+		columns: []string{"summary_id", "entity_id", "entity_type", "summary_type", "content", "created_at"},
+		from: `FROM summaries t WHERE (t.entity_type = 'symbol' AND t.entity_id IN (` + repoSymbols + `))
+			OR (t.entity_type = 'file' AND t.entity_id IN (` + repoFiles + `)) ORDER BY t.summary_id`,
+	},
+}
+
+// selectQuery 构造一张表的导出查询。
+func (s tableSpec) selectQuery() string {
+	query := "SELECT "
+	for i, col := range s.columns {
+		if i > 0 {
+			query += ", "
+		}
+		expr := "t." + col
+		if override, ok := s.selects[col]; ok {
+			expr = override
+		}
+		query += "(" + expr + ")::text"
+	}
+	return query + " " + s.from
+}
@@ -0,0 +1,303 @@
+package archive
+
+import (
+	"archive/tar"
+	"context"
+	"database/sql"
+	"encoding/json"
+	"fmt"
+	"io"
+	"os"
+	"strings"
+	"time"
+
+	"github.com/lib/pq"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+// ImportOptions 控制导入行为。
+type ImportOptions struct {
+	// Replace 在目标库已有同 ID 或同名仓库时先删除它；否则返回 ErrRepositoryExists。
+	Replace bool
+	// DeferIndexes 在目标表全部为空（新库初始化）时先删除二级索引，
+	// 全部行 COPY 完成后再逐个重建。目标表非空时忽略，避免长时间锁表。
+	DeferIndexes bool
+}
+
+// ImportResult 报告一次导入。
+type ImportResult struct {
+	Manifest *Manifest
+	// Replaced 表示替换了目标库中已有的仓库。
+	Replaced bool
+	// RebuiltIndexes 是延迟重建的索引数（0 表示未延迟）。
+	RebuiltIndexes int
+	Duration       time.Duration
+}
+
+// ImportFile 从归档文件导入。
+func ImportFile(ctx context.Context, db *models.DB, path string, opts ImportOptions) (*ImportResult, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return nil, fmt.Errorf("failed to open archive: %w", err)
+	}
+	defer f.Close()
+	return Import(ctx, db, f, opts)
+}
+
+// ReadManifest 读取归档的 manifest，不读取表数据。
+func ReadManifest(r io.Reader) (*Manifest, error) {
+	return readManifest(tar.NewReader(r))
+}
+
+func readManifest(tr *tar.Reader) (*Manifest, error) {
+	hdr, err := tr.Next()
+	if err != nil || hdr.Name != manifestName {
+		return nil, ErrNotArchive
+	}
+	var manifest Manifest
+	if err := json.NewDecoder(tr).Decode(&manifest); err != nil {
+		return nil, fmt.Errorf("%w: bad manifest: %v", ErrCorrupt, err)
+	}
+	if err := manifest.validate(); err != nil {
+		return nil, err
+	}
+	return &manifest, nil
+}
+
+// Import 在一个事务中把归档写入数据库：各表按 manifest 顺序用 COPY FROM STDIN
+// 批量写入，边读边校验 sha256 与行数，任何不一致都会回滚整个导入。
+// 提交后 ANALYZE 导入过的表，使规划器立即拿到新统计信息。
+func Import(ctx context.Context, db *models.DB, r io.Reader, opts ImportOptions) (*ImportResult, error) {
+	start := time.Now()
+	tr := tar.NewReader(r)
+	manifest, err := readManifest(tr)
+	if err != nil {
+		return nil, err
+	}
+
+	current, err := models.MigrationStatus(ctx, db.DB)
+	if err != nil {
+		return nil, err
+	}
+	if manifest.SchemaVersion > current {
+		return nil, fmt.Errorf("%w: archive %d, database %d", ErrSchemaTooNew, manifest.SchemaVersion, current)
+	}
+
+	tx, err := db.Bulk().BeginTx(ctx, nil)
+	if err != nil {
+		return nil, fmt.Errorf("failed to begin transaction: %w", err)
+	}
+	defer tx.Rollback()
+
+	// 与 DB.OptimizeForBulkInserts 相同的取舍，但只作用于本事务
+	for _, stmt := range []string{
+		"SET LOCAL work_mem = '256MB'",
+		"SET LOCAL maintenance_work_mem = '512MB'",
+		"SET LOCAL synchronous_commit = 'off'",
+	} {
+		if _, err := tx.ExecContext(ctx, stmt); err != nil {
+			return nil, fmt.Errorf("failed to configure import transaction: %w", err)
+		}
+	}
+
+	result := &ImportResult{Manifest: manifest}
+	previousGeneration, err := clearExisting(ctx, tx, manifest, opts.Replace)
+	if err != nil {
+		return nil, err
+	}
+	result.Replaced = previousGeneration >= 0
+
+	tables := make([]string, len(manifest.Tables))
+	for i, t := range manifest.Tables {
+		tables[i] = t.Name
+	}
+	var deferred []models.IndexDefinition
+	if opts.DeferIndexes {
+		empty, err := models.TablesEmpty(ctx, tx, tables)
+		if err != nil {
+			return nil, fmt.Errorf("failed to inspect target tables: %w", err)
+		}
+		if empty {
+			if deferred, err = models.DropSecondaryIndexes(ctx, tx, tables); err != nil {
+				return nil, err
+			}
+		}
+	}
+
+	for i := range manifest.Tables {
+		t := &manifest.Tables[i]
+		hdr, err := tr.Next()
+		if err != nil || hdr.Name != t.File {
+			return nil, fmt.Errorf("%w: expected entry %s", ErrCorrupt, t.File)
+		}
+		load := copyTable
+		if t.Name == "edges" && containsColumn(t.Columns, moduleColumn) {
+			load = copyEdges
+		}
+		if err := load(ctx, tx, tr, t); err != nil {
+			return nil, fmt.Errorf("failed to import %s: %w", t.Name, err)
+		}
+	}
+
+	if err := models.RecreateIndexes(ctx, tx, deferred); err != nil {
+		return nil, err
+	}
+	result.RebuiltIndexes = len(deferred)
+
+	// 导入即一次新的索引写入：generation 要比归档中和被替换仓库的都大。
+	// API 服务器在 DB_GENERATION_TTL 内重新读取该列，已发出的 ETag 随之失效
+	_, err = tx.ExecContext(ctx, `
+		UPDATE repositories
+		SET index_generation = GREATEST(index_generation, $2) + 1, updated_at = NOW()
+		WHERE repo_id = $1
+	`, manifest.RepoID, previousGeneration)
+	if err != nil {
+		return nil, fmt.Errorf("failed to bump index generation: %w", err)
+	}
+
+	if err := tx.Commit(); err != nil {
+		return nil, fmt.Errorf("failed to commit import: %w", err)
+	}
+
+	for _, table := range tables {
+		if _, err := db.Bulk().ExecContext(ctx, "ANALYZE "+pq.QuoteIdentifier(table)); err != nil {
+			return nil, fmt.Errorf("failed to analyze %s: %w", table, err)
+		}
+	}
+	result.Duration = time.Since(start)
+	return result, nil
+}
+
+// clearExisting 处理目标库中同 ID 或同名的仓库：replace 时删除并返回其
+// index_generation，否则返回 ErrRepositoryExists。没有冲突时返回 -1。
+func clearExisting(ctx context.Context, tx *sql.Tx, manifest *Manifest, replace bool) (int64, error) {
+	rows, err := tx.QueryContext(ctx,
+		`SELECT repo_id, index_generation FROM repositories WHERE repo_id = $1 OR name = $2`,
+		manifest.RepoID, manifest.RepoName)
+	if err != nil {
+		return 0, fmt.Errorf("failed to look up repository: %w", err)
+	}
+	var ids []string
+	previous := int64(-1)
+	for rows.Next() {
+		var id string
+		var gen int64
+		if err := rows.Scan(&id, &gen); err != nil {
+			rows.Close()
+			return 0, err
+		}
+		ids = append(ids, id)
+		if gen > previous {
+			previous = gen
+		}
+	}
+	rows.Close()
+	if err := rows.Err(); err != nil {
+		return 0, err
+	}
+	if len(ids) == 0 {
+		return -1, nil
+	}
+	if !replace {
+		return 0, fmt.Errorf("%w: %s (%s)", ErrRepositoryExists, manifest.RepoName, manifest.RepoID)
+	}
+
+	// vectors / summaries 没有外键，不会随仓库级联删除
+	for _, table := range []string{"vectors", "summaries"} {
+		query := fmt.Sprintf(`
+			DELETE FROM %s
+			WHERE (entity_type = 'symbol' AND entity_id IN (
+			           SELECT s.symbol_id FROM symbols s JOIN files f ON f.file_id = s.file_id WHERE f.repo_id = ANY($1)))
+			   OR (entity_type = 'file' AND entity_id IN (SELECT file_id FROM files WHERE repo_id = ANY($1)))
+		`, table)
+		if _, err := tx.ExecContext(ctx, query, pq.Array(ids)); err != nil {
+			return 0, fmt.Errorf("failed to delete existing %s: %w", table, err)
+		}
+	}
+	if _, err := tx.ExecContext(ctx, `DELETE FROM repositories WHERE repo_id = ANY($1)`, pq.Array(ids)); err != nil {
+		return 0, fmt.Errorf("failed to delete existing repository: %w", err)
+	}
+	return previous, nil
+}
+
+// copyTable 把一个表条目 COPY 进数据库。
+func copyTable(ctx context.Context, tx *sql.Tx, r io.Reader, t *TableSummary) error {
+	stmt, err := tx.PrepareContext(ctx, pq.CopyIn(t.Name, t.Columns...))
+	if err != nil {
+		return err
+	}
+	defer stmt.Close()
+
+	err = readTable(r, t, func(values []interface{}) error {
+		_, err := stmt.ExecContext(ctx, values...)
+		return err
+	})
+	if err != nil {
+		return err
+	}
+	// 无参数的 Exec 结束 COPY；约束错误在这里返回
+	if _, err := stmt.ExecContext(ctx); err != nil {
+		return fmt.Errorf("copy failed: %w", err)
+	}
+	return nil
+}
+
+// moduleColumn 是归档中 edges 的外部模块名列；库内存的是 external_modules 的键
+const moduleColumn = "target_module"
+
+// copyEdges 先把边 COPY 进临时表，再把模块名 intern 进 external_modules、
+// 换成 target_module_id 写入 edges。COPY 进行中不能在同一连接上执行其他语句，
+// 因此不能逐行 intern。
+func copyEdges(ctx context.Context, tx *sql.Tx, r io.Reader, t *TableSummary) error {
+	for _, stmt := range []string{
+		`CREATE TEMP TABLE edges_import (LIKE edges) ON COMMIT DROP`,
+		`ALTER TABLE edges_import ADD COLUMN target_module TEXT`,
+	} {
+		if _, err := tx.ExecContext(ctx, stmt); err != nil {
+			return fmt.Errorf("failed to create staging table: %w", err)
+		}
+	}
+	staged := *t
+	staged.Name = "edges_import"
+	if err := copyTable(ctx, tx, r, &staged); err != nil {
+		return err
+	}
+
+	if _, err := tx.ExecContext(ctx, `
+		INSERT INTO external_modules (name)
+		SELECT DISTINCT target_module FROM edges_import WHERE target_module IS NOT NULL
+		ORDER BY target_module
+		ON CONFLICT (name) DO NOTHING
+	`); err != nil {
+		return fmt.Errorf("failed to intern external modules: %w", err)
+	}
+
+	columns := make([]string, len(t.Columns))
+	exprs := make([]string, len(t.Columns))
+	for i, col := range t.Columns {
+		columns[i] = pq.QuoteIdentifier(col)
+		exprs[i] = "i." + pq.QuoteIdentifier(col)
+		if col == moduleColumn {
+			columns[i] = "target_module_id"
+			exprs[i] = "m.module_id"
+		}
+	}
+	query := fmt.Sprintf(`
+		INSERT INTO edges (%s)
+		SELECT %s FROM edges_import i
+		LEFT JOIN external_modules m ON m.name = i.target_module
+	`, strings.Join(columns, ", "), strings.Join(exprs, ", "))
+	if _, err := tx.ExecContext(ctx, query); err != nil {
+		return fmt.Errorf("failed to insert edges: %w", err)
+	}
+	return nil
+}
+
+func containsColumn(columns []string, name string) bool {
+	for _, col := range columns {
+		if col == name {
+			return true
+		}
+	}
+	return false
+}
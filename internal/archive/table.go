@@ -0,0 +1,143 @@
+package archive
+
+import (
+	"compress/gzip"
+	"crypto/sha256"
+	"database/sql"
+	"encoding/hex"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"hash"
+	"io"
+)
+
+// rowScanner 是 *sql.Rows 中导出用到的部分，便于测试替换。
+type rowScanner interface {
+	Next() bool
+	Scan(dest ...interface{}) error
+	Err() error
+}
+
+// digestWriter 在写入的同时计算 sha256 与字节数。
+type digestWriter struct {
+	w io.Writer
+	h hash.Hash
+	n int64
+}
+
+func newDigestWriter(w io.Writer) *digestWriter {
+	return &digestWriter{w: w, h: sha256.New()}
+}
+
+func (d *digestWriter) Write(p []byte) (int, error) {
+	n, err := d.w.Write(p)
+	d.h.Write(p[:n])
+	d.n += int64(n)
+	return n, err
+}
+
+func (d *digestWriter) sum() string {
+	return hex.EncodeToString(d.h.Sum(nil))
+}
+
+// writeTable 把 rows 的每一行（columns 列文本值）编码为一行 JSON 数组，
+// gzip 压缩后写入 w，返回行数。
+func writeTable(w io.Writer, rows rowScanner, columns int) (int64, error) {
+	gz := gzip.NewWriter(w)
+	enc := json.NewEncoder(gz)
+	enc.SetEscapeHTML(false)
+
+	values := make([]sql.NullString, columns)
+	dest := make([]interface{}, columns)
+	for i := range values {
+		dest[i] = &values[i]
+	}
+	row := make([]*string, columns)
+
+	var n int64
+	for rows.Next() {
+		if err := rows.Scan(dest...); err != nil {
+			return n, err
+		}
+		for i := range values {
+			row[i] = nil
+			if values[i].Valid {
+				row[i] = &values[i].String
+			}
+		}
+		if err := enc.Encode(row); err != nil {
+			return n, err
+		}
+		n++
+	}
+	if err := rows.Err(); err != nil {
+		return n, err
+	}
+	return n, gz.Close()
+}
+
+// readTable 解码 writeTable 写出的条目，对每一行调用 fn（nil 表示 NULL），
+// 读完后校验行数、字节数与 sha256。fn 返回的错误原样返回。
+func readTable(r io.Reader, t *TableSummary, fn func(values []interface{}) error) error {
+	h := sha256.New()
+	counted := &countingReader{r: io.TeeReader(r, h)}
+
+	gz, err := gzip.NewReader(counted)
+	if err != nil {
+		return fmt.Errorf("%w: %s: %v", ErrCorrupt, t.File, err)
+	}
+	dec := json.NewDecoder(gz)
+
+	values := make([]interface{}, len(t.Columns))
+	var rows int64
+	for {
+		var row []*string
+		if err := dec.Decode(&row); err != nil {
+			if errors.Is(err, io.EOF) {
+				break
+			}
+			return fmt.Errorf("%w: %s row %d: %v", ErrCorrupt, t.File, rows+1, err)
+		}
+		if len(row) != len(t.Columns) {
+			return fmt.Errorf("%w: %s row %d has %d columns, want %d", ErrCorrupt, t.File, rows+1, len(row), len(t.Columns))
+		}
+		for i, v := range row {
+			if v == nil {
+				values[i] = nil
+			} else {
+				values[i] = *v
+			}
+		}
+		if err := fn(values); err != nil {
+			return err
+		}
+		rows++
+	}
+	if err := gz.Close(); err != nil {
+		return fmt.Errorf("%w: %s: %v", ErrCorrupt, t.File, err)
+	}
+	// gzip 尾部之后若还有字节也要计入校验
+	if _, err := io.Copy(io.Discard, counted); err != nil {
+		return err
+	}
+
+	if sum := hex.EncodeToString(h.Sum(nil)); sum != t.SHA256 || counted.n != t.Bytes {
+		return fmt.Errorf("%w: %s", ErrChecksumMismatch, t.File)
+	}
+	if rows != t.Rows {
+		return fmt.Errorf("%w: %s has %d rows, manifest says %d", ErrCorrupt, t.File, rows, t.Rows)
+	}
+	return nil
+}
+
+type countingReader struct {
+	r io.Reader
+	n int64
+}
+
+func (c *countingReader) Read(p []byte) (int, error) {
+	n, err := c.r.Read(p)
+	c.n += int64(n)
+	return n, err
+}
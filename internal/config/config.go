@@ -28,6 +28,35 @@ type DatabaseConfig struct {
 	MaxIdleConns    int
 	ConnMaxLifetime time.Duration
 	ConnMaxIdleTime time.Duration
+
+	// Bulk-write pool (indexing). 0 means indexing shares the interactive pool.
+	BulkMaxOpenConns int
+	BulkMaxIdleConns int
+
+	// Adaptive pool sizing
+	PoolAutoTune      bool
+	PoolTuneInterval  time.Duration
+	PoolMaxTotalConns int           // Upper bound across both pools (0 = MaxOpenConns + BulkMaxOpenConns)
+	PoolLatencyTarget time.Duration // Probe latency above which the controller backs off
+
+	// Statement instrumentation
+	QueryStats         bool          // Per-statement latency histograms
+	SlowQueryThreshold time.Duration // Log statements slower than this with their parameters (0 = off)
+	ExplainSampleRate  float64       // Fraction of slow reads re-run under EXPLAIN (ANALYZE, BUFFERS)
+
+	// How long conditional GETs trust the cached repositories.index_generation
+	// before re-reading it (writes by other processes are seen within this TTL)
+	GenerationTTL time.Duration
+
+	// Build the half-precision HNSW index used by rescored vector searches
+	// (off: the rescore request parameter is ignored)
+	VectorRescore bool
+
+	// Background compaction of orphan rows and dangling edges (API server)
+	CompactionInterval      time.Duration // Time between runs (0 = off)
+	CompactionBatchSize     int           // Rows examined per statement
+	CompactionRowsPerSecond int           // I/O budget across all steps (0 = unlimited)
+	CompactionReindexBloat  float64       // Rebuild btree indexes bloated past this ratio (0 = never)
 }
 
 // APIConfig holds API server configuration
@@ -38,6 +67,37 @@ type APIConfig struct {
 	AuthTokens  []string
 	CORSOrigins []string
 	Timeout     time.Duration
+	// Upper bound on post-start warm-up (generation load, index prewarm);
+	// 0 skips warm-up
+	WarmupTimeout time.Duration
+
+	// Diagnostics listener (pprof + flight recorder). Empty address disables it.
+	DiagnosticsAddr  string
+	DiagnosticsToken string
+	// Flight recorder: dump the trace ring buffer when a request exceeds
+	// TraceSlowThreshold (0 disables the recorder)
+	TraceSlowThreshold time.Duration
+	TraceWindow        time.Duration
+	TraceDir           string
+
+	// Per-client request quotas (token bucket; QuotaRate 0 disables the
+	// global bucket). QuotaRoutes is "METHOD /path=rate:burst[:cost],...",
+	// QuotaWeights is "token=weight,..." for the fair queue.
+	QuotaRate    float64
+	QuotaBurst   int
+	QuotaRoutes  string
+	QuotaWeights string
+	// Weighted fair queuing once MaxInFlight requests are running (0 = off)
+	MaxInFlight  int
+	QueueSize    int
+	QueueTimeout time.Duration
+}
+
+// RouteQuota is one parsed entry of APIConfig.QuotaRoutes
+type RouteQuota struct {
+	Rate  float64
+	Burst int
+	Cost  float64
 }
 
 // IndexerConfig holds indexer configuration
@@ -48,6 +108,12 @@ type IndexerConfig struct {
 	Incremental     bool
 	UseTransactions bool
 	EmbeddingModel  string
+	// BulkMaintenanceMemMB 是批量加载后重建推迟索引的 maintenance_work_mem 总预算，
+	// 由 BulkBuildParallelism 个并行重建会话均分（0 表示使用默认值）
+	BulkMaintenanceMemMB int
+	BulkBuildParallelism int
+	// WriteParallelism 是大仓库事务写入时并发写暂存表的文件分组数（1 表示单事务）
+	WriteParallelism int
 }
 
 // EmbedderConfig holds embedder configuration
@@ -63,8 +129,13 @@ type EmbedderConfig struct {
 	BaseRetryDelay       time.Duration
 	MaxRetryDelay        time.Duration
 	Timeout              time.Duration
+	// Granularity 选择切分策略：symbol（默认）、block 或 multi（文件/块/符号多粒度）
+	Granularity string
 }
 
+// coarseDimensions 与 models.CoarseDimensions（coarse_vectors.embedding 的维度）一致
+const coarseDimensions = 256
+
 // ToIndexerConfig converts config.EmbedderConfig to indexer.EmbedderConfig
 // This is a helper to avoid import cycles and provide a clean conversion
 func (e *EmbedderConfig) ToIndexerEmbedderConfig() map[string]interface{} {
@@ -80,6 +151,7 @@ func (e *EmbedderConfig) ToIndexerEmbedderConfig() map[string]interface{} {
 		"BaseRetryDelay":       e.BaseRetryDelay,
 		"MaxRetryDelay":        e.MaxRetryDelay,
 		"Timeout":              e.Timeout,
+		"Granularity":          e.Granularity,
 	}
 }
 
@@ -113,6 +185,27 @@ func loadDatabaseConfig() DatabaseConfig {
 		MaxIdleConns:    getEnvInt("DB_MAX_IDLE_CONNS", 5),
 		ConnMaxLifetime: getEnvDuration("DB_CONN_MAX_LIFETIME", 5*time.Minute),
 		ConnMaxIdleTime: getEnvDuration("DB_CONN_MAX_IDLE_TIME", 5*time.Minute),
+
+		BulkMaxOpenConns: getEnvInt("DB_BULK_MAX_OPEN_CONNS", 0),
+		BulkMaxIdleConns: getEnvInt("DB_BULK_MAX_IDLE_CONNS", 2),
+
+		PoolAutoTune:      getEnvBool("DB_POOL_AUTOTUNE", false),
+		PoolTuneInterval:  getEnvDuration("DB_POOL_TUNE_INTERVAL", 10*time.Second),
+		PoolMaxTotalConns: getEnvInt("DB_POOL_MAX_TOTAL_CONNS", 0),
+		PoolLatencyTarget: getEnvDuration("DB_POOL_LATENCY_TARGET", 50*time.Millisecond),
+
+		QueryStats:         getEnvBool("DB_QUERY_STATS", true),
+		SlowQueryThreshold: getEnvDuration("DB_SLOW_QUERY_THRESHOLD", 200*time.Millisecond),
+		ExplainSampleRate:  getEnvFloat("DB_EXPLAIN_SAMPLE_RATE", 0),
+
+		GenerationTTL: getEnvDuration("DB_GENERATION_TTL", time.Second),
+
+		VectorRescore: getEnvBool("DB_VECTOR_RESCORE", false),
+
+		CompactionInterval:      getEnvDuration("DB_COMPACTION_INTERVAL", 0),
+		CompactionBatchSize:     getEnvInt("DB_COMPACTION_BATCH_SIZE", 1000),
+		CompactionRowsPerSecond: getEnvInt("DB_COMPACTION_ROWS_PER_SECOND", 5000),
+		CompactionReindexBloat:  getEnvFloat("DB_COMPACTION_REINDEX_BLOAT", 2.0),
 	}
 }
 
@@ -125,18 +218,38 @@ func loadAPIConfig() APIConfig {
 		AuthTokens:  getEnvStringSlice("AUTH_TOKENS", []string{}),
 		CORSOrigins: getEnvStringSlice("CORS_ORIGINS", []string{"*"}),
 		Timeout:     getEnvDuration("API_TIMEOUT", 30*time.Second),
+
+		WarmupTimeout: getEnvDuration("API_WARMUP_TIMEOUT", 30*time.Second),
+
+		DiagnosticsAddr:  getEnv("API_DIAG_ADDR", ""),
+		DiagnosticsToken: getEnv("API_DIAG_TOKEN", ""),
+
+		TraceSlowThreshold: getEnvDuration("API_TRACE_SLOW_THRESHOLD", 0),
+		TraceWindow:        getEnvDuration("API_TRACE_WINDOW", 10*time.Second),
+		TraceDir:           getEnv("API_TRACE_DIR", ""),
+
+		QuotaRate:    getEnvFloat("API_QUOTA_RATE", 0),
+		QuotaBurst:   getEnvInt("API_QUOTA_BURST", 20),
+		QuotaRoutes:  getEnv("API_QUOTA_ROUTES", ""),
+		QuotaWeights: getEnv("API_QUOTA_WEIGHTS", ""),
+		MaxInFlight:  getEnvInt("API_MAX_IN_FLIGHT", 0),
+		QueueSize:    getEnvInt("API_QUEUE_SIZE", 100),
+		QueueTimeout: getEnvDuration("API_QUEUE_TIMEOUT", 5*time.Second),
 	}
 }
 
 // loadIndexerConfig loads indexer configuration from environment
 func loadIndexerConfig() IndexerConfig {
 	return IndexerConfig{
-		BatchSize:       getEnvInt("INDEXER_BATCH_SIZE", 100),
-		WorkerCount:     getEnvInt("INDEXER_WORKER_COUNT", 4),
-		SkipVectors:     getEnvBool("INDEXER_SKIP_VECTORS", false),
-		Incremental:     getEnvBool("INDEXER_INCREMENTAL", false),
-		UseTransactions: getEnvBool("INDEXER_USE_TRANSACTIONS", true),
-		EmbeddingModel:  getEnv("INDEXER_EMBEDDING_MODEL", ""),
+		BatchSize:            getEnvInt("INDEXER_BATCH_SIZE", 100),
+		WorkerCount:          getEnvInt("INDEXER_WORKER_COUNT", 4),
+		SkipVectors:          getEnvBool("INDEXER_SKIP_VECTORS", false),
+		Incremental:          getEnvBool("INDEXER_INCREMENTAL", false),
+		UseTransactions:      getEnvBool("INDEXER_USE_TRANSACTIONS", true),
+		EmbeddingModel:       getEnv("INDEXER_EMBEDDING_MODEL", ""),
+		BulkMaintenanceMemMB: getEnvInt("INDEXER_BULK_MAINTENANCE_MEM_MB", 1024),
+		BulkBuildParallelism: getEnvInt("INDEXER_BULK_BUILD_PARALLELISM", 2),
+		WriteParallelism:     getEnvInt("INDEXER_WRITE_PARALLELISM", 4),
 	}
 }
 
@@ -154,6 +267,7 @@ func loadEmbedderConfig() EmbedderConfig {
 		BaseRetryDelay:       getEnvDuration("EMBEDDING_BASE_RETRY_DELAY", 100*time.Millisecond),
 		MaxRetryDelay:        getEnvDuration("EMBEDDING_MAX_RETRY_DELAY", 5*time.Second),
 		Timeout:              getEnvDuration("EMBEDDING_TIMEOUT", 30*time.Second),
+		Granularity:          getEnv("EMBEDDING_GRANULARITY", "symbol"),
 	}
 }
 
@@ -181,6 +295,46 @@ func (c *Config) Validate() error {
 	if c.Database.MaxIdleConns > c.Database.MaxOpenConns {
 		return fmt.Errorf("database max idle connections cannot exceed max open connections")
 	}
+	if c.Database.BulkMaxOpenConns < 0 {
+		return fmt.Errorf("database bulk max open connections cannot be negative")
+	}
+	if c.Database.BulkMaxOpenConns > 0 && c.Database.BulkMaxIdleConns > c.Database.BulkMaxOpenConns {
+		return fmt.Errorf("database bulk max idle connections cannot exceed bulk max open connections")
+	}
+	if c.Database.PoolAutoTune {
+		if c.Database.PoolTuneInterval <= 0 {
+			return fmt.Errorf("database pool tune interval must be positive")
+		}
+		if c.Database.PoolMaxTotalConns < 0 {
+			return fmt.Errorf("database pool max total connections cannot be negative")
+		}
+		if c.Database.PoolMaxTotalConns > 0 && c.Database.PoolMaxTotalConns < c.Database.MaxOpenConns+c.Database.BulkMaxOpenConns {
+			return fmt.Errorf("database pool max total connections cannot be below the configured pool sizes")
+		}
+	}
+	if c.Database.SlowQueryThreshold < 0 {
+		return fmt.Errorf("database slow query threshold cannot be negative")
+	}
+	if c.Database.ExplainSampleRate < 0 || c.Database.ExplainSampleRate > 1 {
+		return fmt.Errorf("database explain sample rate must be between 0 and 1")
+	}
+	if c.Database.GenerationTTL < 0 {
+		return fmt.Errorf("database generation TTL cannot be negative")
+	}
+	if c.Database.CompactionInterval < 0 {
+		return fmt.Errorf("database compaction interval cannot be negative")
+	}
+	if c.Database.CompactionInterval > 0 {
+		if c.Database.CompactionBatchSize <= 0 {
+			return fmt.Errorf("database compaction batch size must be positive")
+		}
+		if c.Database.CompactionRowsPerSecond < 0 {
+			return fmt.Errorf("database compaction rows per second cannot be negative")
+		}
+		if c.Database.CompactionReindexBloat != 0 && c.Database.CompactionReindexBloat < 1 {
+			return fmt.Errorf("database compaction reindex bloat ratio must be 0 or at least 1")
+		}
+	}
 
 	// Validate API config
 	if c.API.Port <= 0 || c.API.Port > 65535 {
@@ -189,6 +343,36 @@ func (c *Config) Validate() error {
 	if c.API.EnableAuth && len(c.API.AuthTokens) == 0 {
 		return fmt.Errorf("authentication is enabled but no auth tokens are configured")
 	}
+	if c.API.WarmupTimeout < 0 {
+		return fmt.Errorf("API warm-up timeout cannot be negative")
+	}
+	if c.API.DiagnosticsAddr != "" && c.API.DiagnosticsToken == "" {
+		return fmt.Errorf("diagnostics listener is enabled but no diagnostics token is configured")
+	}
+	if c.API.TraceSlowThreshold < 0 {
+		return fmt.Errorf("trace slow threshold cannot be negative")
+	}
+	if c.API.TraceSlowThreshold > 0 && c.API.TraceWindow <= 0 {
+		return fmt.Errorf("trace window must be positive when the flight recorder is enabled")
+	}
+	if c.API.QuotaRate < 0 {
+		return fmt.Errorf("API quota rate cannot be negative")
+	}
+	if c.API.QuotaRate > 0 && c.API.QuotaBurst < 1 {
+		return fmt.Errorf("API quota burst must be at least 1")
+	}
+	if _, err := c.API.RouteQuotas(); err != nil {
+		return err
+	}
+	if _, err := c.API.TokenWeights(); err != nil {
+		return err
+	}
+	if c.API.MaxInFlight < 0 {
+		return fmt.Errorf("API max in-flight requests cannot be negative")
+	}
+	if c.API.MaxInFlight > 0 && (c.API.QueueSize < 1 || c.API.QueueTimeout <= 0) {
+		return fmt.Errorf("API queue size and timeout must be positive when fair queuing is enabled")
+	}
 
 	// Validate indexer config
 	if c.Indexer.BatchSize < 1 {
@@ -197,6 +381,12 @@ func (c *Config) Validate() error {
 	if c.Indexer.WorkerCount < 1 {
 		return fmt.Errorf("indexer worker count must be at least 1")
 	}
+	if c.Indexer.BulkMaintenanceMemMB < 0 || c.Indexer.BulkBuildParallelism < 0 {
+		return fmt.Errorf("indexer bulk maintenance memory and build parallelism cannot be negative")
+	}
+	if c.Indexer.WriteParallelism < 0 {
+		return fmt.Errorf("indexer write parallelism cannot be negative")
+	}
 
 	// Validate embedder config
 	if !c.Indexer.SkipVectors {
@@ -221,6 +411,15 @@ func (c *Config) Validate() error {
 		if c.Embedder.MaxRetries < 0 {
 			return fmt.Errorf("embedder max retries cannot be negative")
 		}
+		switch c.Embedder.Granularity {
+		case "", "symbol", "block":
+		case "multi":
+			if c.Embedder.Dimensions < coarseDimensions {
+				return fmt.Errorf("multi-granularity embedding needs at least %d dimensions", coarseDimensions)
+			}
+		default:
+			return fmt.Errorf("embedder granularity must be 'symbol', 'block' or 'multi'")
+		}
 	}
 
 	return nil
@@ -237,6 +436,63 @@ func (c *APIConfig) Address() string {
 	return fmt.Sprintf("%s:%d", c.Host, c.Port)
 }
 
+// QuotasEnabled reports whether any quota or fair queuing is configured
+func (c *APIConfig) QuotasEnabled() bool {
+	return c.QuotaRate > 0 || c.QuotaRoutes != "" || c.MaxInFlight > 0
+}
+
+// RouteQuotas parses QuotaRoutes, e.g.
+// "POST /api/v1/search=2:5:4,POST /api/v1/qa=0.5:2:8"
+func (c *APIConfig) RouteQuotas() (map[string]RouteQuota, error) {
+	routes := make(map[string]RouteQuota)
+	for _, entry := range strings.Split(c.QuotaRoutes, ",") {
+		entry = strings.TrimSpace(entry)
+		if entry == "" {
+			continue
+		}
+		route, spec, ok := strings.Cut(entry, "=")
+		method, path, _ := strings.Cut(strings.Join(strings.Fields(route), " "), " ")
+		fields := strings.Split(spec, ":")
+		if !ok || method == "" || !strings.HasPrefix(path, "/") || len(fields) < 2 || len(fields) > 3 {
+			return nil, fmt.Errorf("invalid API quota route %q (expected METHOD /path=rate:burst[:cost])", entry)
+		}
+		var rq RouteQuota
+		var err error
+		if rq.Rate, err = strconv.ParseFloat(fields[0], 64); err != nil || rq.Rate < 0 {
+			return nil, fmt.Errorf("invalid rate in API quota route %q", entry)
+		}
+		if rq.Burst, err = strconv.Atoi(fields[1]); err != nil || rq.Burst < 0 {
+			return nil, fmt.Errorf("invalid burst in API quota route %q", entry)
+		}
+		if len(fields) == 3 {
+			if rq.Cost, err = strconv.ParseFloat(fields[2], 64); err != nil || rq.Cost <= 0 {
+				return nil, fmt.Errorf("invalid cost in API quota route %q", entry)
+			}
+		}
+		routes[strings.ToUpper(method)+" "+path] = rq
+	}
+	return routes, nil
+}
+
+// TokenWeights parses QuotaWeights ("token=weight,...")
+func (c *APIConfig) TokenWeights() (map[string]float64, error) {
+	weights := make(map[string]float64)
+	for _, entry := range strings.Split(c.QuotaWeights, ",") {
+		entry = strings.TrimSpace(entry)
+		if entry == "" {
+			continue
+		}
+		token, value, ok := strings.Cut(entry, "=")
+		weight, err := strconv.ParseFloat(value, 64)
+		if !ok || token == "" || err != nil || weight <= 0 {
+			// 不回显 token 本身
+			return nil, fmt.Errorf("invalid API quota weight entry (expected token=weight with weight > 0)")
+		}
+		weights[token] = weight
+	}
+	return weights, nil
+}
+
 // Helper functions for environment variable parsing
 
 func getEnv(key, defaultValue string) string {
@@ -283,6 +539,18 @@ func getEnvDuration(key string, defaultValue time.Duration) time.Duration {
 	return duration
 }
 
+func getEnvFloat(key string, defaultValue float64) float64 {
+	value := os.Getenv(key)
+	if value == "" {
+		return defaultValue
+	}
+	floatValue, err := strconv.ParseFloat(value, 64)
+	if err != nil {
+		return defaultValue
+	}
+	return floatValue
+}
+
 func getEnvStringSlice(key string, defaultValue []string) []string {
 	value := os.Getenv(key)
 	if value == "" {
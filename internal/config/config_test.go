@@ -38,6 +38,12 @@ func TestLoadConfig(t *testing.T) {
 		if config.API.EnableAuth {
 			t.Error("expected API auth to be disabled by default")
 		}
+		if config.Database.CompactionInterval != 0 {
+			t.Errorf("expected compaction to be disabled by default, got %v", config.Database.CompactionInterval)
+		}
+		if config.API.QuotasEnabled() {
+			t.Error("expected API quotas to be disabled by default")
+		}
 
 		// Check indexer defaults
 		if config.Indexer.BatchSize != 100 {
@@ -46,6 +52,12 @@ func TestLoadConfig(t *testing.T) {
 		if config.Indexer.WorkerCount != 4 {
 			t.Errorf("expected indexer worker count 4, got %d", config.Indexer.WorkerCount)
 		}
+		if config.Indexer.BulkMaintenanceMemMB != 1024 || config.Indexer.BulkBuildParallelism != 2 {
+			t.Errorf("expected bulk build 1024MB x 2, got %dMB x %d", config.Indexer.BulkMaintenanceMemMB, config.Indexer.BulkBuildParallelism)
+		}
+		if config.Indexer.WriteParallelism != 4 {
+			t.Errorf("expected indexer write parallelism 4, got %d", config.Indexer.WriteParallelism)
+		}
 
 		// Check embedder defaults
 		if config.Embedder.Backend != "openai" {
@@ -54,6 +66,9 @@ func TestLoadConfig(t *testing.T) {
 		if config.Embedder.Dimensions != 768 {
 			t.Errorf("expected embedder dimensions 768, got %d", config.Embedder.Dimensions)
 		}
+		if config.Embedder.Granularity != "symbol" {
+			t.Errorf("expected embedder granularity 'symbol', got '%s'", config.Embedder.Granularity)
+		}
 	})
 
 	// Test with custom environment variables
@@ -160,6 +175,110 @@ func TestDatabaseConfigValidation(t *testing.T) {
 			},
 			wantErr: true,
 		},
+		{
+			name: "valid_bulk_pool_with_autotune",
+			config: DatabaseConfig{
+				Host:              "localhost",
+				Port:              5432,
+				User:              "user",
+				Database:          "db",
+				MaxOpenConns:      10,
+				MaxIdleConns:      5,
+				BulkMaxOpenConns:  4,
+				BulkMaxIdleConns:  2,
+				PoolAutoTune:      true,
+				PoolTuneInterval:  10 * time.Second,
+				PoolMaxTotalConns: 20,
+			},
+			wantErr: false,
+		},
+		{
+			name: "explain_sample_rate_out_of_range",
+			config: DatabaseConfig{
+				Host:              "localhost",
+				Port:              5432,
+				User:              "user",
+				Database:          "db",
+				MaxOpenConns:      10,
+				MaxIdleConns:      5,
+				ExplainSampleRate: 1.5,
+			},
+			wantErr: true,
+		},
+		{
+			name: "compaction_enabled",
+			config: DatabaseConfig{
+				Host:                    "localhost",
+				Port:                    5432,
+				User:                    "user",
+				Database:                "db",
+				MaxOpenConns:            10,
+				MaxIdleConns:            5,
+				CompactionInterval:      time.Hour,
+				CompactionBatchSize:     1000,
+				CompactionRowsPerSecond: 5000,
+				CompactionReindexBloat:  2.0,
+			},
+			wantErr: false,
+		},
+		{
+			name: "compaction_zero_batch_size",
+			config: DatabaseConfig{
+				Host:               "localhost",
+				Port:               5432,
+				User:               "user",
+				Database:           "db",
+				MaxOpenConns:       10,
+				MaxIdleConns:       5,
+				CompactionInterval: time.Hour,
+			},
+			wantErr: true,
+		},
+		{
+			name: "compaction_reindex_bloat_below_one",
+			config: DatabaseConfig{
+				Host:                   "localhost",
+				Port:                   5432,
+				User:                   "user",
+				Database:               "db",
+				MaxOpenConns:           10,
+				MaxIdleConns:           5,
+				CompactionInterval:     time.Hour,
+				CompactionBatchSize:    1000,
+				CompactionReindexBloat: 0.5,
+			},
+			wantErr: true,
+		},
+		{
+			name: "bulk_idle_exceeds_max",
+			config: DatabaseConfig{
+				Host:             "localhost",
+				Port:             5432,
+				User:             "user",
+				Database:         "db",
+				MaxOpenConns:     10,
+				MaxIdleConns:     5,
+				BulkMaxOpenConns: 2,
+				BulkMaxIdleConns: 4,
+			},
+			wantErr: true,
+		},
+		{
+			name: "total_cap_below_pool_sizes",
+			config: DatabaseConfig{
+				Host:              "localhost",
+				Port:              5432,
+				User:              "user",
+				Database:          "db",
+				MaxOpenConns:      10,
+				MaxIdleConns:      5,
+				BulkMaxOpenConns:  4,
+				PoolAutoTune:      true,
+				PoolTuneInterval:  10 * time.Second,
+				PoolMaxTotalConns: 12,
+			},
+			wantErr: true,
+		},
 	}
 
 	for _, tt := range tests {
@@ -230,6 +349,88 @@ func TestAPIConfigValidation(t *testing.T) {
 			},
 			wantErr: true,
 		},
+		{
+			name: "valid_diagnostics",
+			config: APIConfig{
+				Port:               8080,
+				DiagnosticsAddr:    "127.0.0.1:6060",
+				DiagnosticsToken:   "diag-token",
+				TraceSlowThreshold: 500 * time.Millisecond,
+				TraceWindow:        10 * time.Second,
+			},
+			wantErr: false,
+		},
+		{
+			name: "diagnostics_without_token",
+			config: APIConfig{
+				Port:            8080,
+				DiagnosticsAddr: "127.0.0.1:6060",
+			},
+			wantErr: true,
+		},
+		{
+			name: "flight_recorder_without_window",
+			config: APIConfig{
+				Port:               8080,
+				TraceSlowThreshold: time.Second,
+			},
+			wantErr: true,
+		},
+		{
+			name: "valid_quotas",
+			config: APIConfig{
+				Port:         8080,
+				QuotaRate:    5,
+				QuotaBurst:   10,
+				QuotaRoutes:  "POST /api/v1/search=1:5:4, post /api/v1/qa=0.5:2",
+				QuotaWeights: "human-token=4",
+				MaxInFlight:  32,
+				QueueSize:    100,
+				QueueTimeout: 5 * time.Second,
+			},
+			wantErr: false,
+		},
+		{
+			name: "quota_without_burst",
+			config: APIConfig{
+				Port:      8080,
+				QuotaRate: 5,
+			},
+			wantErr: true,
+		},
+		{
+			name: "malformed_quota_route",
+			config: APIConfig{
+				Port:        8080,
+				QuotaRoutes: "/api/v1/search=1",
+			},
+			wantErr: true,
+		},
+		{
+			name: "zero_quota_weight",
+			config: APIConfig{
+				Port:         8080,
+				QuotaWeights: "bot=0",
+			},
+			wantErr: true,
+		},
+		{
+			name: "negative_warmup_timeout",
+			config: APIConfig{
+				Port:          8080,
+				WarmupTimeout: -time.Second,
+			},
+			wantErr: true,
+		},
+		{
+			name: "fair_queue_without_timeout",
+			config: APIConfig{
+				Port:        8080,
+				MaxInFlight: 32,
+				QueueSize:   100,
+			},
+			wantErr: true,
+		},
 	}
 
 	for _, tt := range tests {
@@ -265,6 +466,25 @@ func TestAPIConfigValidation(t *testing.T) {
 	}
 }
 
+func TestRouteQuotas(t *testing.T) {
+	c := &APIConfig{QuotaRoutes: "POST  /api/v1/search=1:5:4, get /api/v1/symbols/:id/callers=10:20"}
+	routes, err := c.RouteQuotas()
+	if err != nil {
+		t.Fatalf("RouteQuotas() error = %v", err)
+	}
+	if got := routes["POST /api/v1/search"]; got != (RouteQuota{Rate: 1, Burst: 5, Cost: 4}) {
+		t.Errorf("search quota = %+v", got)
+	}
+	if got := routes["GET /api/v1/symbols/:id/callers"]; got != (RouteQuota{Rate: 10, Burst: 20}) {
+		t.Errorf("callers quota = %+v", got)
+	}
+
+	weights, err := (&APIConfig{QuotaWeights: "a=2, b=0.5"}).TokenWeights()
+	if err != nil || weights["a"] != 2 || weights["b"] != 0.5 {
+		t.Errorf("TokenWeights() = %v, %v", weights, err)
+	}
+}
+
 func TestIndexerConfigValidation(t *testing.T) {
 	tests := []struct {
 		name    string
@@ -295,6 +515,24 @@ func TestIndexerConfigValidation(t *testing.T) {
 			},
 			wantErr: true,
 		},
+		{
+			name: "invalid_bulk_parallelism",
+			config: IndexerConfig{
+				BatchSize:            100,
+				WorkerCount:          4,
+				BulkBuildParallelism: -1,
+			},
+			wantErr: true,
+		},
+		{
+			name: "invalid_write_parallelism",
+			config: IndexerConfig{
+				BatchSize:        100,
+				WorkerCount:      4,
+				WriteParallelism: -1,
+			},
+			wantErr: true,
+		},
 	}
 
 	for _, tt := range tests {
@@ -383,6 +621,48 @@ func TestEmbedderConfigValidation(t *testing.T) {
 			skipVectors: false,
 			wantErr:     true,
 		},
+		{
+			name: "multi_granularity",
+			config: EmbedderConfig{
+				Backend:              "openai",
+				APIEndpoint:          "http://localhost:1234",
+				Model:                "test-model",
+				Dimensions:           1024,
+				BatchSize:            50,
+				MaxRequestsPerSecond: 10,
+				Granularity:          "multi",
+			},
+			skipVectors: false,
+			wantErr:     false,
+		},
+		{
+			name: "multi_granularity_too_few_dimensions",
+			config: EmbedderConfig{
+				Backend:              "openai",
+				APIEndpoint:          "http://localhost:1234",
+				Model:                "test-model",
+				Dimensions:           128,
+				BatchSize:            50,
+				MaxRequestsPerSecond: 10,
+				Granularity:          "multi",
+			},
+			skipVectors: false,
+			wantErr:     true,
+		},
+		{
+			name: "invalid_granularity",
+			config: EmbedderConfig{
+				Backend:              "openai",
+				APIEndpoint:          "http://localhost:1234",
+				Model:                "test-model",
+				Dimensions:           768,
+				BatchSize:            50,
+				MaxRequestsPerSecond: 10,
+				Granularity:          "line",
+			},
+			skipVectors: false,
+			wantErr:     true,
+		},
 	}
 
 	for _, tt := range tests {
@@ -507,6 +787,18 @@ func TestGetEnvHelpers(t *testing.T) {
 		}
 	})
 
+	t.Run("getEnvFloat", func(t *testing.T) {
+		clearEnv()
+		os.Setenv("TEST_FLOAT", "0.25")
+		if got := getEnvFloat("TEST_FLOAT", 0); got != 0.25 {
+			t.Errorf("getEnvFloat() = %v, want 0.25", got)
+		}
+		os.Setenv("TEST_FLOAT", "invalid")
+		if got := getEnvFloat("TEST_FLOAT", 0.5); got != 0.5 {
+			t.Errorf("getEnvFloat() with invalid value = %v, want 0.5", got)
+		}
+	})
+
 	t.Run("getEnvStringSlice", func(t *testing.T) {
 		clearEnv()
 		os.Setenv("TEST_SLICE", "a,b,c")
@@ -553,13 +845,22 @@ func clearEnv() {
 	testVars := []string{
 		"DB_HOST", "DB_PORT", "DB_USER", "DB_PASSWORD", "DB_NAME", "DB_SSLMODE",
 		"DB_MAX_OPEN_CONNS", "DB_MAX_IDLE_CONNS", "DB_CONN_MAX_LIFETIME", "DB_CONN_MAX_IDLE_TIME",
+		"DB_BULK_MAX_OPEN_CONNS", "DB_BULK_MAX_IDLE_CONNS", "DB_POOL_AUTOTUNE", "DB_POOL_TUNE_INTERVAL",
+		"DB_POOL_MAX_TOTAL_CONNS", "DB_POOL_LATENCY_TARGET",
+		"DB_QUERY_STATS", "DB_SLOW_QUERY_THRESHOLD", "DB_EXPLAIN_SAMPLE_RATE",
+		"DB_COMPACTION_INTERVAL", "DB_COMPACTION_BATCH_SIZE", "DB_COMPACTION_ROWS_PER_SECOND", "DB_COMPACTION_REINDEX_BLOAT",
 		"API_HOST", "API_PORT", "ENABLE_AUTH", "AUTH_TOKENS", "CORS_ORIGINS", "API_TIMEOUT",
+		"API_DIAG_ADDR", "API_DIAG_TOKEN", "API_TRACE_SLOW_THRESHOLD", "API_TRACE_WINDOW", "API_TRACE_DIR",
+		"API_QUOTA_RATE", "API_QUOTA_BURST", "API_QUOTA_ROUTES", "API_QUOTA_WEIGHTS",
+		"API_MAX_IN_FLIGHT", "API_QUEUE_SIZE", "API_QUEUE_TIMEOUT",
 		"INDEXER_BATCH_SIZE", "INDEXER_WORKER_COUNT", "INDEXER_SKIP_VECTORS",
 		"INDEXER_INCREMENTAL", "INDEXER_USE_TRANSACTIONS", "INDEXER_EMBEDDING_MODEL",
+		"INDEXER_BULK_MAINTENANCE_MEM_MB", "INDEXER_BULK_BUILD_PARALLELISM", "INDEXER_WRITE_PARALLELISM",
 		"EMBEDDING_BACKEND", "EMBEDDING_API_ENDPOINT", "EMBEDDING_API_KEY", "EMBEDDING_MODEL",
 		"EMBEDDING_DIMENSIONS", "EMBEDDING_BATCH_SIZE", "EMBEDDING_MAX_REQUESTS_PER_SECOND",
 		"EMBEDDING_MAX_RETRIES", "EMBEDDING_BASE_RETRY_DELAY", "EMBEDDING_MAX_RETRY_DELAY", "EMBEDDING_TIMEOUT",
-		"TEST_STRING", "TEST_INT", "TEST_BOOL", "TEST_DURATION", "TEST_SLICE",
+		"EMBEDDING_GRANULARITY",
+		"TEST_STRING", "TEST_INT", "TEST_BOOL", "TEST_DURATION", "TEST_FLOAT", "TEST_SLICE",
 	}
 	for _, v := range testVars {
 		os.Unsetenv(v)
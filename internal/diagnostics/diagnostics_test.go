@@ -0,0 +1,164 @@
+package diagnostics
+
+import (
+	"io"
+	"net/http"
+	"net/http/httptest"
+	"os"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+)
+
+// fakeBuffer 替代 runtime/trace.FlightRecorder，记录写出次数
+type fakeBuffer struct {
+	mu     sync.Mutex
+	writes int
+	block  chan struct{}
+}
+
+func (f *fakeBuffer) Start() error { return nil }
+func (f *fakeBuffer) Stop()        {}
+func (f *fakeBuffer) WriteTo(w io.Writer) (int64, error) {
+	if f.block != nil {
+		<-f.block
+	}
+	f.mu.Lock()
+	f.writes++
+	f.mu.Unlock()
+	n, err := w.Write([]byte("trace"))
+	return int64(n), err
+}
+
+func newTestRecorder(t *testing.T, buf *fakeBuffer) *FlightRecorder {
+	t.Helper()
+	cfg := DefaultFlightRecorderConfig()
+	cfg.Dir = t.TempDir()
+	cfg.SlowThreshold = 100 * time.Millisecond
+	cfg.MaxDumps = 2
+	fr := newFlightRecorder(cfg, buf, nil)
+	if err := fr.Start(); err != nil {
+		t.Fatalf("Start failed: %v", err)
+	}
+	return fr
+}
+
+// waitIdle 等待异步 dump 完成
+func waitIdle(t *testing.T, fr *FlightRecorder) {
+	t.Helper()
+	deadline := time.Now().Add(2 * time.Second)
+	for fr.dumping.Load() {
+		if time.Now().After(deadline) {
+			t.Fatal("dump did not finish")
+		}
+		time.Sleep(time.Millisecond)
+	}
+}
+
+func TestFlightRecorder_DumpsOnSlowRequest(t *testing.T) {
+	buf := &fakeBuffer{}
+	fr := newTestRecorder(t, buf)
+
+	fr.Observe("GET /fast", 10*time.Millisecond)
+	fr.Observe("GET /api/v1/symbols/:id/callers", 300*time.Millisecond)
+	waitIdle(t, fr)
+
+	dumps := fr.Dumps()
+	if len(dumps) != 1 {
+		t.Fatalf("Expected 1 dump, got %d", len(dumps))
+	}
+	if !strings.Contains(dumps[0].Path, "slow_request_GET__api_v1_symbols__id_callers") {
+		t.Errorf("Unexpected dump path %s", dumps[0].Path)
+	}
+	data, err := os.ReadFile(dumps[0].Path)
+	if err != nil || string(data) != "trace" {
+		t.Errorf("Unexpected dump content %q (err=%v)", data, err)
+	}
+
+	// Cooldown suppresses an immediate second dump
+	fr.Observe("GET /slow", time.Second)
+	waitIdle(t, fr)
+	if len(fr.Dumps()) != 1 {
+		t.Errorf("Expected cooldown to suppress dump, got %d dumps", len(fr.Dumps()))
+	}
+}
+
+func TestFlightRecorder_PrunesOldDumps(t *testing.T) {
+	fr := newTestRecorder(t, &fakeBuffer{})
+	fr.cfg.Cooldown = 0
+
+	var paths []string
+	for i := 0; i < 3; i++ {
+		d, err := fr.dump("slow", time.Second, time.Now().Add(time.Duration(i)*time.Millisecond))
+		if err != nil {
+			t.Fatalf("dump failed: %v", err)
+		}
+		paths = append(paths, d.Path)
+	}
+
+	dumps := fr.Dumps()
+	if len(dumps) != 2 || dumps[0].Path != paths[2] {
+		t.Errorf("Expected the 2 newest dumps, got %+v", dumps)
+	}
+	if _, err := os.Stat(paths[0]); !os.IsNotExist(err) {
+		t.Errorf("Expected oldest dump file to be removed, stat err=%v", err)
+	}
+}
+
+func TestFlightRecorder_SingleDumpInFlight(t *testing.T) {
+	buf := &fakeBuffer{block: make(chan struct{})}
+	fr := newTestRecorder(t, buf)
+	fr.cfg.Cooldown = 0
+
+	fr.Observe("GET /a", time.Second)
+	fr.Observe("GET /b", time.Second)
+	if _, err := fr.WriteTo(io.Discard); err == nil {
+		t.Error("Expected on-demand snapshot to fail while a dump is in progress")
+	}
+	close(buf.block)
+	waitIdle(t, fr)
+
+	if buf.writes != 1 {
+		t.Errorf("Expected exactly 1 write, got %d", buf.writes)
+	}
+}
+
+func TestHandler_RequiresToken(t *testing.T) {
+	h := NewHandler("secret", newTestRecorder(t, &fakeBuffer{}))
+
+	tests := []struct {
+		name   string
+		path   string
+		auth   string
+		status int
+	}{
+		{"missing_token", "/debug/pprof/", "", http.StatusUnauthorized},
+		{"wrong_token", "/debug/pprof/", "Bearer nope", http.StatusUnauthorized},
+		{"pprof_index", "/debug/pprof/", "Bearer secret", http.StatusOK},
+		{"flight_trace", "/debug/flight/trace", "Bearer secret", http.StatusOK},
+		{"flight_dumps", "/debug/flight/dumps", "Bearer secret", http.StatusOK},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			req := httptest.NewRequest("GET", tt.path, nil)
+			if tt.auth != "" {
+				req.Header.Set("Authorization", tt.auth)
+			}
+			w := httptest.NewRecorder()
+			h.ServeHTTP(w, req)
+			if w.Code != tt.status {
+				t.Errorf("Expected status %d, got %d", tt.status, w.Code)
+			}
+		})
+	}
+
+	// An empty configured token never authenticates
+	req := httptest.NewRequest("GET", "/debug/pprof/", nil)
+	req.Header.Set("Authorization", "Bearer ")
+	w := httptest.NewRecorder()
+	NewHandler("", nil).ServeHTTP(w, req)
+	if w.Code != http.StatusUnauthorized {
+		t.Errorf("Expected status %d with empty token, got %d", http.StatusUnauthorized, w.Code)
+	}
+}
@@ -0,0 +1,223 @@
+// Package diagnostics provides the opt-in runtime diagnostics of the API server:
+// pprof endpoints and an execution-trace flight recorder that is dumped to disk
+// when a request exceeds a latency threshold.
+package diagnostics
+
+import (
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"runtime/trace"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/yourtionguo/CodeAtlas/internal/utils"
+)
+
+// FlightRecorderConfig configures the execution-trace flight recorder
+type FlightRecorderConfig struct {
+	// Window is how much recent trace history the ring buffer keeps
+	Window time.Duration
+	// MaxBytes caps the ring buffer size (0 = runtime default)
+	MaxBytes uint64
+	// SlowThreshold is the request latency that triggers a dump
+	SlowThreshold time.Duration
+	// Cooldown is the minimum interval between automatic dumps, so a latency
+	// storm produces one trace instead of hundreds
+	Cooldown time.Duration
+	// Dir is where dumps are written
+	Dir string
+	// MaxDumps is how many dump files are kept; older ones are removed
+	MaxDumps int
+}
+
+// DefaultFlightRecorderConfig returns the default flight recorder configuration
+func DefaultFlightRecorderConfig() FlightRecorderConfig {
+	return FlightRecorderConfig{
+		Window:        10 * time.Second,
+		MaxBytes:      16 << 20,
+		SlowThreshold: time.Second,
+		Cooldown:      time.Minute,
+		Dir:           filepath.Join(os.TempDir(), "codeatlas-traces"),
+		MaxDumps:      10,
+	}
+}
+
+// Dump describes one trace written by the flight recorder
+type Dump struct {
+	Path      string        `json:"path"`
+	Reason    string        `json:"reason"`
+	Latency   time.Duration `json:"latency"`
+	Bytes     int64         `json:"bytes"`
+	CreatedAt time.Time     `json:"created_at"`
+}
+
+// traceBuffer is the subset of runtime/trace.FlightRecorder used here; tests
+// substitute a fake so trigger logic can be exercised without tracing.
+type traceBuffer interface {
+	Start() error
+	Stop()
+	WriteTo(w io.Writer) (int64, error)
+}
+
+// FlightRecorder keeps a rolling execution trace of the last Window and writes
+// it to disk when Observe sees a request slower than SlowThreshold. Tracing is
+// continuous but low overhead; only dumping costs I/O, and at most one dump
+// runs at a time.
+type FlightRecorder struct {
+	cfg    FlightRecorderConfig
+	buf    traceBuffer
+	logger *utils.Logger
+
+	dumping  atomic.Bool
+	lastDump atomic.Int64 // unix nanos of the last automatic dump
+
+	mu    sync.Mutex
+	dumps []Dump
+}
+
+// NewFlightRecorder creates a flight recorder; call Start to begin tracing
+func NewFlightRecorder(cfg FlightRecorderConfig, logger *utils.Logger) *FlightRecorder {
+	buf := trace.NewFlightRecorder(trace.FlightRecorderConfig{
+		MinAge:   cfg.Window,
+		MaxBytes: cfg.MaxBytes,
+	})
+	return newFlightRecorder(cfg, buf, logger)
+}
+
+func newFlightRecorder(cfg FlightRecorderConfig, buf traceBuffer, logger *utils.Logger) *FlightRecorder {
+	if logger == nil {
+		logger = utils.NewSilentLogger()
+	}
+	return &FlightRecorder{cfg: cfg, buf: buf, logger: logger}
+}
+
+// Start begins continuous tracing into the ring buffer
+func (fr *FlightRecorder) Start() error {
+	if err := os.MkdirAll(fr.cfg.Dir, 0o755); err != nil {
+		return fmt.Errorf("failed to create trace directory: %w", err)
+	}
+	if err := fr.buf.Start(); err != nil {
+		return fmt.Errorf("failed to start flight recorder: %w", err)
+	}
+	return nil
+}
+
+// Stop ends tracing. Safe to call on a nil recorder.
+func (fr *FlightRecorder) Stop() {
+	if fr == nil {
+		return
+	}
+	fr.buf.Stop()
+}
+
+// Observe reports a finished request. Requests slower than SlowThreshold
+// trigger an asynchronous dump unless one is in progress or the cooldown has
+// not elapsed. Observe never blocks the request path.
+func (fr *FlightRecorder) Observe(route string, latency time.Duration) {
+	if fr == nil || fr.cfg.SlowThreshold <= 0 || latency < fr.cfg.SlowThreshold {
+		return
+	}
+	now := time.Now()
+	last := fr.lastDump.Load()
+	if last != 0 && now.Sub(time.Unix(0, last)) < fr.cfg.Cooldown {
+		return
+	}
+	if !fr.dumping.CompareAndSwap(false, true) {
+		return
+	}
+	fr.lastDump.Store(now.UnixNano())
+
+	go func() {
+		defer fr.dumping.Store(false)
+		reason := "slow request " + route
+		dump, err := fr.dump(reason, latency, now)
+		if err != nil {
+			fr.logger.WarnWithFields("Failed to dump flight recorder trace",
+				utils.Field{Key: "route", Value: route},
+				utils.Field{Key: "error", Value: err.Error()},
+			)
+			return
+		}
+		fr.logger.WarnWithFields("Slow request, flight recorder trace saved",
+			utils.Field{Key: "route", Value: route},
+			utils.Field{Key: "latency", Value: latency},
+			utils.Field{Key: "path", Value: dump.Path},
+		)
+	}()
+}
+
+// WriteTo writes the current ring buffer contents to w (on-demand snapshot)
+func (fr *FlightRecorder) WriteTo(w io.Writer) (int64, error) {
+	if !fr.dumping.CompareAndSwap(false, true) {
+		return 0, fmt.Errorf("a trace dump is already in progress")
+	}
+	defer fr.dumping.Store(false)
+	return fr.buf.WriteTo(w)
+}
+
+// Dumps returns the traces written so far, newest first
+func (fr *FlightRecorder) Dumps() []Dump {
+	fr.mu.Lock()
+	defer fr.mu.Unlock()
+	out := make([]Dump, len(fr.dumps))
+	for i, d := range fr.dumps {
+		out[len(fr.dumps)-1-i] = d
+	}
+	return out
+}
+
+// dump writes the ring buffer to a new file and prunes old dumps
+func (fr *FlightRecorder) dump(reason string, latency time.Duration, at time.Time) (Dump, error) {
+	name := fmt.Sprintf("trace-%s-%s.out", at.UTC().Format("20060102T150405.000Z"), sanitizeRoute(reason))
+	path := filepath.Join(fr.cfg.Dir, name)
+	f, err := os.Create(path)
+	if err != nil {
+		return Dump{}, err
+	}
+	n, err := fr.buf.WriteTo(f)
+	if closeErr := f.Close(); err == nil {
+		err = closeErr
+	}
+	if err != nil {
+		os.Remove(path)
+		return Dump{}, err
+	}
+
+	d := Dump{Path: path, Reason: reason, Latency: latency, Bytes: n, CreatedAt: at}
+	fr.mu.Lock()
+	fr.dumps = append(fr.dumps, d)
+	var expired []Dump
+	if fr.cfg.MaxDumps > 0 && len(fr.dumps) > fr.cfg.MaxDumps {
+		expired = append(expired, fr.dumps[:len(fr.dumps)-fr.cfg.MaxDumps]...)
+		fr.dumps = append([]Dump(nil), fr.dumps[len(fr.dumps)-fr.cfg.MaxDumps:]...)
+	}
+	fr.mu.Unlock()
+
+	for _, old := range expired {
+		os.Remove(old.Path)
+	}
+	return d, nil
+}
+
+// sanitizeRoute turns "slow request GET /api/v1/symbols/:id/callers" into a
+// file-name-safe fragment
+func sanitizeRoute(s string) string {
+	var b strings.Builder
+	for _, r := range s {
+		switch {
+		case r >= 'a' && r <= 'z', r >= 'A' && r <= 'Z', r >= '0' && r <= '9':
+			b.WriteRune(r)
+		default:
+			b.WriteByte('_')
+		}
+	}
+	out := strings.Trim(b.String(), "_")
+	if len(out) > 64 {
+		out = out[:64]
+	}
+	return out
+}
@@ -0,0 +1,87 @@
+package diagnostics
+
+import (
+	"context"
+	"crypto/subtle"
+	"encoding/json"
+	"net/http"
+	"net/http/pprof"
+	"strings"
+	"time"
+)
+
+// NewHandler returns the diagnostics HTTP handler. Every endpoint requires
+// "Authorization: Bearer <token>"; an empty token rejects all requests.
+//
+//	/debug/pprof/...         standard pprof profiles (cpu, heap, goroutine, ...)
+//	/debug/flight/trace      current flight recorder window as a runtime trace
+//	/debug/flight/dumps      traces saved after slow requests (JSON)
+//
+// recorder may be nil, in which case the flight endpoints return 404.
+func NewHandler(token string, recorder *FlightRecorder) http.Handler {
+	mux := http.NewServeMux()
+	mux.HandleFunc("/debug/pprof/", pprof.Index)
+	mux.HandleFunc("/debug/pprof/cmdline", pprof.Cmdline)
+	mux.HandleFunc("/debug/pprof/profile", pprof.Profile)
+	mux.HandleFunc("/debug/pprof/symbol", pprof.Symbol)
+	mux.HandleFunc("/debug/pprof/trace", pprof.Trace)
+
+	mux.HandleFunc("/debug/flight/trace", func(w http.ResponseWriter, r *http.Request) {
+		if recorder == nil {
+			http.Error(w, "flight recorder not enabled", http.StatusNotFound)
+			return
+		}
+		w.Header().Set("Content-Type", "application/octet-stream")
+		w.Header().Set("Content-Disposition", `attachment; filename="flight.trace"`)
+		if _, err := recorder.WriteTo(w); err != nil {
+			http.Error(w, err.Error(), http.StatusConflict)
+		}
+	})
+	mux.HandleFunc("/debug/flight/dumps", func(w http.ResponseWriter, r *http.Request) {
+		if recorder == nil {
+			http.Error(w, "flight recorder not enabled", http.StatusNotFound)
+			return
+		}
+		w.Header().Set("Content-Type", "application/json")
+		json.NewEncoder(w).Encode(map[string]interface{}{"dumps": recorder.Dumps()})
+	})
+
+	return requireToken(token, mux)
+}
+
+// requireToken wraps h with constant-time bearer token authentication
+func requireToken(token string, h http.Handler) http.Handler {
+	return http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		got := strings.TrimPrefix(r.Header.Get("Authorization"), "Bearer ")
+		if token == "" || subtle.ConstantTimeCompare([]byte(got), []byte(token)) != 1 {
+			http.Error(w, "unauthorized", http.StatusUnauthorized)
+			return
+		}
+		h.ServeHTTP(w, r)
+	})
+}
+
+// Server is the diagnostics listener, separate from the public API port so it
+// can be bound to localhost or an internal interface only
+type Server struct {
+	srv *http.Server
+}
+
+// NewServer creates a diagnostics server listening on addr
+func NewServer(addr, token string, recorder *FlightRecorder) *Server {
+	return &Server{srv: &http.Server{
+		Addr:              addr,
+		Handler:           NewHandler(token, recorder),
+		ReadHeaderTimeout: 10 * time.Second,
+	}}
+}
+
+// ListenAndServe starts serving; it returns http.ErrServerClosed after Shutdown
+func (s *Server) ListenAndServe() error {
+	return s.srv.ListenAndServe()
+}
+
+// Shutdown gracefully stops the listener
+func (s *Server) Shutdown(ctx context.Context) error {
+	return s.srv.Shutdown(ctx)
+}
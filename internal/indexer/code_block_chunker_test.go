@@ -1,10 +1,12 @@
 package indexer
 
 import (
+	"fmt"
 	"strings"
 	"testing"
 
 	"github.com/yourtionguo/CodeAtlas/internal/schema"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
 )
 
 func mkSymbol(id, fileID, name string, kind schema.SymbolKind, startLine, endLine int, signature string) schema.Symbol {
@@ -113,3 +115,89 @@ func TestSymbolChunker_Baseline(t *testing.T) {
 		t.Fatalf("SymbolChunker should produce 1 input per symbol, got %d", len(got))
 	}
 }
+
+// TestMultiGranularityChunker_EmitsAllLevels 验证一次遍历产出符号、块、文件三级 chunk。
+func TestMultiGranularityChunker_EmitsAllLevels(t *testing.T) {
+	symbols := []schema.Symbol{
+		mkSymbol("s3", "f1", "far", schema.SymbolFunction, 100, 110, "func far()"),
+		mkSymbol("s1", "f1", "a", schema.SymbolFunction, 10, 15, "func a()"),
+		mkSymbol("s2", "f1", "b", schema.SymbolFunction, 18, 25, "func b()"),
+		mkSymbol("s4", "f2", "c", schema.SymbolClass, 1, 5, "class C"),
+	}
+	got := NewMultiGranularityChunker(30).Chunk(symbols)
+
+	var symbolIDs []string
+	blocks := map[string][]EmbeddingInput{}
+	files := map[string]EmbeddingInput{}
+	for _, in := range got {
+		switch in.Level {
+		case "":
+			symbolIDs = append(symbolIDs, in.EntityID)
+		case models.CoarseLevelBlock:
+			blocks[in.FileID] = append(blocks[in.FileID], in)
+		case models.CoarseLevelFile:
+			files[in.FileID] = in
+		}
+	}
+
+	if strings.Join(symbolIDs, ",") != "s1,s2,s3,s4" {
+		t.Errorf("every symbol should keep its own chunk in line order, got %v", symbolIDs)
+	}
+	if len(blocks["f1"]) != 2 || len(blocks["f2"]) != 1 {
+		t.Fatalf("expected 2 blocks in f1 and 1 in f2, got %d and %d", len(blocks["f1"]), len(blocks["f2"]))
+	}
+	for i, b := range blocks["f1"] {
+		if b.ChunkIndex != i {
+			t.Errorf("block %d has chunk index %d", i, b.ChunkIndex)
+		}
+	}
+	if !strings.Contains(blocks["f1"][0].Content, "func a()") || !strings.Contains(blocks["f1"][0].Content, "func b()") {
+		t.Errorf("first block should merge a and b, got %q", blocks["f1"][0].Content)
+	}
+	if f := files["f1"]; f.EntityID != "f1" || f.Content != "func a()\nfunc b()\nfunc far()" {
+		t.Errorf("unexpected file-level chunk %+v", f)
+	}
+	// 单符号块与符号本身内容相同，交给 Embedder 去重
+	if blocks["f2"][0].Content != buildSymbolContent(symbols[3]) {
+		t.Errorf("single-symbol block should equal the symbol content")
+	}
+}
+
+// TestMultiGranularityChunker_CapsFileContent 验证文件级内容不超过上限。
+func TestMultiGranularityChunker_CapsFileContent(t *testing.T) {
+	var symbols []schema.Symbol
+	for i := 0; i < 100; i++ {
+		symbols = append(symbols, mkSymbol(fmt.Sprintf("s%d", i), "f1", "fn", schema.SymbolFunction, i*10, i*10+5, "func someLongFunctionName()"))
+	}
+	c := NewMultiGranularityChunker(30)
+	c.MaxFileContent = 200
+	for _, in := range c.Chunk(symbols) {
+		if in.Level == models.CoarseLevelFile && (len(in.Content) > 200 || in.Content == "") {
+			t.Errorf("file-level content length %d exceeds cap", len(in.Content))
+		}
+	}
+}
+
+// TestDedupeInputs 验证相同内容只保留一份并记录所有引用。
+func TestDedupeInputs(t *testing.T) {
+	inputs := []EmbeddingInput{
+		{EntityID: "s1", Content: "func a()"},
+		{EntityID: "s2", Content: "func b()"},
+		{EntityID: "s1", Content: "func a()", Level: models.CoarseLevelBlock, FileID: "f1"},
+	}
+	contents, hashes, refs := dedupeInputs(inputs)
+	if len(contents) != 2 || len(hashes) != 2 {
+		t.Fatalf("expected 2 unique contents, got %d", len(contents))
+	}
+	if len(refs[0]) != 2 || refs[0][0] != 0 || refs[0][1] != 2 {
+		t.Errorf("first content should be referenced by inputs 0 and 2, got %v", refs[0])
+	}
+	if hashes[0] == hashes[1] || len(hashes[0]) != 64 {
+		t.Errorf("unexpected hashes %v", hashes)
+	}
+
+	fileIDs, counts := blockCounts(append(inputs, EmbeddingInput{EntityID: "f2", Level: models.CoarseLevelFile, FileID: "f2"}))
+	if strings.Join(fileIDs, ",") != "f1,f2" || counts[0] != 1 || counts[1] != 0 {
+		t.Errorf("blockCounts = %v %v", fileIDs, counts)
+	}
+}
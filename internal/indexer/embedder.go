@@ -3,6 +3,8 @@ package indexer
 import (
 	"bytes"
 	"context"
+	"crypto/sha256"
+	"encoding/hex"
 	"encoding/json"
 	"fmt"
 	"io"
@@ -33,17 +35,23 @@ type Embedder interface {
 // EmbeddingInput 是单个待嵌入单元，由 Chunker 产出。
 // 一个 symbol 可被切分为多个 chunk（多粒度 embedding），每个 chunk
 // 携带归属的 entity_id（默认为 symbol_id）与 chunk_index。
+//
+// Level 为空表示符号级向量（写入 vectors）；models.CoarseLevelFile /
+// models.CoarseLevelBlock 表示粗粒度向量（降维后写入 coarse_vectors），
+// 此时 FileID 必填、ChunkIndex 为块在文件内的序号。
 type EmbeddingInput struct {
 	EntityID   string
 	Content    string
 	ChunkIndex int
+	Level      string
+	FileID     string
 }
 
 // Chunker 把符号切分为待嵌入的文本单元。
 //
-// 当前唯一实现 SymbolChunker 维持原有"逐 symbol 单向量"行为；
-// 下一站检索质量优化可新增 MultiGranularityChunker（按文件/按代码块），
-// 通过 SetChunker 注入，无需改动 EmbedSymbols 主流程。
+// 实现：SymbolChunker（默认，逐 symbol 单向量）、CodeBlockChunker（按代码块）、
+// MultiGranularityChunker（文件/块/符号三级，一次遍历产出），
+// 由 EmbedderConfig.Granularity 选择或通过 SetChunker 注入。
 type Chunker interface {
 	// Chunk 将符号转换为待嵌入输入列表。
 	// 返回空 content 的项应被跳过（与原 buildSymbolContent 行为一致）。
@@ -106,44 +114,57 @@ func (c CodeBlockChunker) Chunk(symbols []schema.Symbol) []EmbeddingInput {
 		return nil
 	}
 
-	// 1. 按 file_id 分组
-	files := make(map[string][]schema.Symbol)
-	for _, s := range symbols {
-		files[s.FileID] = append(files[s.FileID], s)
+	outputs := make([]EmbeddingInput, 0, len(symbols))
+	for _, syms := range groupSymbolsByFile(symbols) {
+		for _, block := range splitBlocks(syms, c.GapThreshold) {
+			outputs = append(outputs, c.blockToInput(block))
+		}
 	}
+	return outputs
+}
 
-	outputs := make([]EmbeddingInput, 0, len(symbols))
-	// 2. 每个文件内排序 + 分块
-	for fileID, syms := range files {
-		sort.Slice(syms, func(i, j int) bool {
+// groupSymbolsByFile 按 file_id 分组（组按首次出现的顺序），组内按 start_line 排序。
+func groupSymbolsByFile(symbols []schema.Symbol) [][]schema.Symbol {
+	index := make(map[string]int)
+	var groups [][]schema.Symbol
+	for _, s := range symbols {
+		i, ok := index[s.FileID]
+		if !ok {
+			i = len(groups)
+			index[s.FileID] = i
+			groups = append(groups, nil)
+		}
+		groups[i] = append(groups[i], s)
+	}
+	for _, syms := range groups {
+		sort.SliceStable(syms, func(i, j int) bool {
 			return syms[i].Span.StartLine < syms[j].Span.StartLine
 		})
+	}
+	return groups
+}
 
-		var currentBlock []schema.Symbol
-		var lastEndLine int
-		flush := func() {
-			if len(currentBlock) == 0 {
-				return
-			}
-			outputs = append(outputs, c.blockToInput(currentBlock))
-			currentBlock = nil
+// splitBlocks 把同一文件内已排序的符号切分为代码块：相邻符号 start_line 与上一个
+// 符号 end_line 的差 ≤ gap 则合并，否则开新块。无内容的符号被跳过。
+func splitBlocks(syms []schema.Symbol, gap int) [][]schema.Symbol {
+	var blocks [][]schema.Symbol
+	var current []schema.Symbol
+	var lastEndLine int
+	for _, s := range syms {
+		if buildSymbolContent(s) == "" {
+			continue // 跳过无内容符号
 		}
-
-		for _, s := range syms {
-			content := buildSymbolContent(s)
-			if content == "" {
-				continue // 跳过无内容符号
-			}
-			if len(currentBlock) > 0 && s.Span.StartLine-lastEndLine > c.GapThreshold {
-				flush() // 间距超阈值，开新块
-			}
-			currentBlock = append(currentBlock, s)
-			lastEndLine = s.Span.EndLine
+		if len(current) > 0 && s.Span.StartLine-lastEndLine > gap {
+			blocks = append(blocks, current) // 间距超阈值，开新块
+			current = nil
 		}
-		flush()
-		_ = fileID // fileID 用于分组，块内通过 entity symbol 关联
+		current = append(current, s)
+		lastEndLine = s.Span.EndLine
 	}
-	return outputs
+	if len(current) > 0 {
+		blocks = append(blocks, current)
+	}
+	return blocks
 }
 
 // blockToInput 把一个符号块转为单条 EmbeddingInput。
@@ -167,6 +188,91 @@ func (c CodeBlockChunker) blockToInput(block []schema.Symbol) EmbeddingInput {
 	}
 }
 
+// defaultMaxFileContent 是文件级 chunk 内容的默认上限（字节），
+// 防止大文件的签名列表超出嵌入模型的输入长度。
+const defaultMaxFileContent = 8000
+
+// MultiGranularityChunker 在一次遍历中同时产出文件级、代码块级与符号级 chunk。
+//
+// 动机：SymbolChunker 召回精确但缺上下文，CodeBlockChunker 有上下文但块内次要
+// 符号不可召回；以前要两者兼得只能索引两遍、每个区域存两份 vector(1024)。
+// 本实现按文件分组排序一次，符号级 chunk 照常写入 vectors；块级与文件级 chunk
+// 标记 Level，由 Embedder 降维后写入 coarse_vectors，仅用于检索时粗筛候选文件。
+//
+// 块级内容与 CodeBlockChunker 一致，entity_id 为块的主要符号、ChunkIndex 为块序号；
+// 文件级内容为文件内全部符号签名（无签名时取名称）逐行拼接，entity_id 为 file_id。
+// 内容相同的 chunk（如单符号块与该符号本身）由 Embedder 按内容哈希只嵌入一次。
+type MultiGranularityChunker struct {
+	// GapThreshold 同 CodeBlockChunker.GapThreshold。默认 30。
+	GapThreshold int
+	// MaxFileContent 是文件级内容上限（字节）。默认 8000。
+	MaxFileContent int
+}
+
+// NewMultiGranularityChunker 创建多粒度 chunker。
+func NewMultiGranularityChunker(gapThreshold int) *MultiGranularityChunker {
+	if gapThreshold <= 0 {
+		gapThreshold = 30
+	}
+	return &MultiGranularityChunker{GapThreshold: gapThreshold, MaxFileContent: defaultMaxFileContent}
+}
+
+// Chunk 实现 Chunker 接口。
+func (c MultiGranularityChunker) Chunk(symbols []schema.Symbol) []EmbeddingInput {
+	if len(symbols) == 0 {
+		return nil
+	}
+	maxFileContent := c.MaxFileContent
+	if maxFileContent <= 0 {
+		maxFileContent = defaultMaxFileContent
+	}
+	blockChunker := CodeBlockChunker{GapThreshold: c.GapThreshold}
+
+	outputs := make([]EmbeddingInput, 0, len(symbols)+len(symbols)/2)
+	for _, syms := range groupSymbolsByFile(symbols) {
+		fileID := syms[0].FileID
+		var outline strings.Builder
+		for _, s := range syms {
+			content := buildSymbolContent(s)
+			if content == "" {
+				continue
+			}
+			outputs = append(outputs, EmbeddingInput{EntityID: s.SymbolID, Content: content})
+
+			line := s.Signature
+			if line == "" {
+				line = s.Name
+			}
+			if outline.Len()+len(line)+1 <= maxFileContent {
+				if outline.Len() > 0 {
+					outline.WriteByte('\n')
+				}
+				outline.WriteString(line)
+			}
+		}
+		if fileID == "" {
+			continue // 粗粒度向量按文件归属，缺少 file_id 时只保留符号级
+		}
+
+		for i, block := range splitBlocks(syms, c.GapThreshold) {
+			in := blockChunker.blockToInput(block)
+			in.Level = models.CoarseLevelBlock
+			in.FileID = fileID
+			in.ChunkIndex = i
+			outputs = append(outputs, in)
+		}
+		if outline.Len() > 0 {
+			outputs = append(outputs, EmbeddingInput{
+				EntityID: fileID,
+				Content:  outline.String(),
+				Level:    models.CoarseLevelFile,
+				FileID:   fileID,
+			})
+		}
+	}
+	return outputs
+}
+
 // symbolRank 返回符号作为块代表的优先级（越小越优先）。
 func symbolRank(kind schema.SymbolKind) int {
 	switch kind {
@@ -229,6 +335,31 @@ type EmbedderConfig struct {
 
 	// HTTP client timeout
 	Timeout time.Duration `json:"timeout"`
+
+	// Granularity selects the chunker: "symbol" (default), "block" or "multi"
+	// (file + block + symbol levels, see MultiGranularityChunker). "multi"
+	// needs Dimensions >= models.CoarseDimensions.
+	Granularity string `json:"granularity,omitempty"`
+}
+
+// Embedding granularities accepted by EmbedderConfig.Granularity
+const (
+	GranularitySymbol = "symbol"
+	GranularityBlock  = "block"
+	GranularityMulti  = "multi"
+)
+
+// newChunker returns the chunker for a granularity (unknown values fall back
+// to SymbolChunker)
+func newChunker(granularity string) Chunker {
+	switch granularity {
+	case GranularityBlock:
+		return NewCodeBlockChunker(0)
+	case GranularityMulti:
+		return NewMultiGranularityChunker(0)
+	default:
+		return SymbolChunker{}
+	}
 }
 
 // DefaultEmbedderConfig returns default configuration
@@ -273,11 +404,11 @@ func NewOpenAIEmbedder(config *EmbedderConfig, vectorRepo *models.VectorReposito
 		},
 		vectorRepo:  vectorRepo,
 		rateLimiter: newRateLimiter(config.MaxRequestsPerSecond),
-		chunker:     SymbolChunker{},
+		chunker:     newChunker(config.Granularity),
 	}
 }
 
-// SetChunker 替换符号切分策略，仅供检索质量优化时注入多粒度实现。
+// SetChunker 替换符号切分策略（覆盖 Granularity 的选择）。
 // 传入 nil 等价于恢复默认 SymbolChunker。
 func (e *OpenAIEmbedder) SetChunker(c Chunker) {
 	if c == nil {
@@ -289,9 +420,26 @@ func (e *OpenAIEmbedder) SetChunker(c Chunker) {
 
 // EmbedResult contains the results of an embedding operation
 type EmbedResult struct {
-	VectorsCreated int           `json:"vectors_created"`
-	Duration       time.Duration `json:"duration"`
-	Errors         []EmbedError  `json:"errors,omitempty"`
+	VectorsCreated int `json:"vectors_created"`
+	// CoarseVectorsCreated counts file/block-level rows (multi granularity)
+	CoarseVectorsCreated int `json:"coarse_vectors_created,omitempty"`
+	// EmbeddingsReused counts inputs served by an identical content embedded
+	// earlier in the same call
+	EmbeddingsReused int           `json:"embeddings_reused,omitempty"`
+	Duration         time.Duration `json:"duration"`
+	Errors           []EmbedError  `json:"errors,omitempty"`
+}
+
+// addError records a failed embedding in errs, or appends it to the result
+// when the caller does not aggregate errors (errs == nil)
+func (r *EmbedResult) addError(errs *ErrorAggregator, embedErr EmbedError) {
+	if errs == nil {
+		r.Errors = append(r.Errors, embedErr)
+		return
+	}
+	errs.Record("embedding", ErrorTypeEmbedding, "", true, func() *IndexerError {
+		return NewEmbeddingError(embedErr.Message, embedErr.EntityID, "", nil, true)
+	})
 }
 
 // EmbedError represents an error that occurred during embedding
@@ -391,16 +539,19 @@ func (e *OpenAIEmbedder) EmbedSymbols(ctx context.Context, symbols []schema.Symb
 		return result, nil
 	}
 
-	// 通过 Chunker 把符号切分为待嵌入单元。
-	// 默认 SymbolChunker 维持原"逐 symbol 单向量"行为；
-	// 下一站可通过 SetChunker 注入多粒度实现。
+	// 通过 Chunker 把符号切分为待嵌入单元（单粒度或多粒度）。
 	inputs := e.chunker.Chunk(symbols)
 	if len(inputs) == 0 {
 		return result, nil
 	}
 
+	// 按内容哈希去重：多粒度下单符号块与符号本身、重复的签名等内容相同，
+	// 只嵌入一次，向量分发给所有引用它的 input。
+	contents, hashes, refs := dedupeInputs(inputs)
+	result.EmbeddingsReused = len(inputs) - len(contents)
+
 	// Process in batches
-	for i := 0; i < len(inputs); i += e.config.BatchSize {
+	for i := 0; i < len(contents); i += e.config.BatchSize {
 		// 顶部检查 ctx：长批次链下，BatchEmbed/BatchCreate 内部虽检查 ctx，
 		// 但顶部显式检查可让取消/超时在一个 batch 边界即响应，无需等下游。
 		if err := ctx.Err(); err != nil {
@@ -411,68 +562,114 @@ func (e *OpenAIEmbedder) EmbedSymbols(ctx context.Context, symbols []schema.Symb
 			break
 		}
 		end := i + e.config.BatchSize
-		if end > len(inputs) {
-			end = len(inputs)
-		}
-
-		batch := inputs[i:end]
-		batchContents := make([]string, len(batch))
-		for k, in := range batch {
-			batchContents[k] = in.Content
+		if end > len(contents) {
+			end = len(contents)
 		}
 
 		// Generate embeddings for batch
-		embeddings, err := e.BatchEmbed(ctx, batchContents)
+		embeddings, err := e.BatchEmbed(ctx, contents[i:end])
 		if err != nil {
 			// Log error but continue with other batches
-			for _, in := range batch {
-				result.Errors = append(result.Errors, EmbedError{
-					EntityID: in.EntityID,
-					Message:  fmt.Sprintf("failed to generate embedding: %v", err),
-				})
+			for _, r := range refs[i:end] {
+				for _, k := range r {
+					result.Errors = append(result.Errors, EmbedError{
+						EntityID: inputs[k].EntityID,
+						Message:  fmt.Sprintf("failed to generate embedding: %v", err),
+					})
+				}
 			}
 			continue
 		}
 
 		// 收集维度校验通过的向量，稍后批量写入（替代原先逐条 Create 的 N 次 INSERT）
 		vectorsToStore := make([]*models.Vector, 0, len(embeddings))
+		var coarseToStore []*models.CoarseVector
 		for j, embedding := range embeddings {
 			if len(embedding) != e.config.Dimensions {
-				result.Errors = append(result.Errors, EmbedError{
-					EntityID: batch[j].EntityID,
-					Message:  fmt.Sprintf("invalid embedding dimensions: expected %d, got %d", e.config.Dimensions, len(embedding)),
-				})
+				for _, k := range refs[i+j] {
+					result.Errors = append(result.Errors, EmbedError{
+						EntityID: inputs[k].EntityID,
+						Message:  fmt.Sprintf("invalid embedding dimensions: expected %d, got %d", e.config.Dimensions, len(embedding)),
+					})
+				}
 				continue
 			}
-			vectorsToStore = append(vectorsToStore, &models.Vector{
-				VectorID:   uuid.New().String(),
-				EntityID:   batch[j].EntityID,
-				EntityType: "symbol",
-				Embedding:  embedding,
-				Content:    batch[j].Content,
-				Model:      e.config.Model,
-				ChunkIndex: batch[j].ChunkIndex,
-			})
+			var reduced []float32
+			for _, k := range refs[i+j] {
+				in := inputs[k]
+				if in.Level == "" {
+					vectorsToStore = append(vectorsToStore, &models.Vector{
+						VectorID:   uuid.New().String(),
+						EntityID:   in.EntityID,
+						EntityType: "symbol",
+						Embedding:  embedding,
+						Content:    in.Content,
+						Model:      e.config.Model,
+						ChunkIndex: in.ChunkIndex,
+					})
+					continue
+				}
+				if reduced == nil {
+					reduced = models.ReduceEmbedding(embedding, models.CoarseDimensions)
+				}
+				if reduced == nil {
+					result.Errors = append(result.Errors, EmbedError{
+						EntityID: in.EntityID,
+						Message:  fmt.Sprintf("embedding has %d dimensions, coarse vectors need at least %d", len(embedding), models.CoarseDimensions),
+					})
+					continue
+				}
+				coarseToStore = append(coarseToStore, &models.CoarseVector{
+					VectorID:    uuid.New().String(),
+					EntityID:    in.EntityID,
+					Level:       in.Level,
+					FileID:      in.FileID,
+					Embedding:   reduced,
+					ContentHash: hashes[i+j],
+					Model:       e.config.Model,
+					ChunkIndex:  in.ChunkIndex,
+				})
+			}
 		}
 
-		if len(vectorsToStore) == 0 {
-			continue
+		if len(vectorsToStore) > 0 {
+			// 批量写入；失败时降级为逐条写入以定位具体出错条目
+			if err := e.vectorRepo.BatchCreate(ctx, vectorsToStore); err != nil {
+				for _, v := range vectorsToStore {
+					if err := e.vectorRepo.Create(ctx, v); err != nil {
+						result.Errors = append(result.Errors, EmbedError{
+							EntityID: v.EntityID,
+							Message:  fmt.Sprintf("failed to store embedding: %v", err),
+						})
+					} else {
+						result.VectorsCreated++
+					}
+				}
+			} else {
+				result.VectorsCreated += len(vectorsToStore)
+			}
 		}
 
-		// 批量写入；失败时降级为逐条写入以定位具体出错条目
-		if err := e.vectorRepo.BatchCreate(ctx, vectorsToStore); err != nil {
-			for _, v := range vectorsToStore {
-				if err := e.vectorRepo.Create(ctx, v); err != nil {
+		if len(coarseToStore) > 0 {
+			if err := e.vectorRepo.BatchCreateCoarse(ctx, coarseToStore); err != nil {
+				for _, v := range coarseToStore {
 					result.Errors = append(result.Errors, EmbedError{
 						EntityID: v.EntityID,
-						Message:  fmt.Sprintf("failed to store embedding: %v", err),
+						Message:  fmt.Sprintf("failed to store coarse embedding: %v", err),
 					})
-				} else {
-					result.VectorsCreated++
 				}
+			} else {
+				result.CoarseVectorsCreated += len(coarseToStore)
 			}
-		} else {
-			result.VectorsCreated += len(vectorsToStore)
+		}
+	}
+
+	// 文件的块数变少时，清理旧版本多出来的块级向量
+	if fileIDs, counts := blockCounts(inputs); len(fileIDs) > 0 && ctx.Err() == nil {
+		if err := e.vectorRepo.TrimCoarseBlocks(ctx, fileIDs, counts); err != nil {
+			result.Errors = append(result.Errors, EmbedError{
+				Message: fmt.Sprintf("failed to trim stale block embeddings: %v", err),
+			})
 		}
 	}
 
@@ -480,6 +677,49 @@ func (e *OpenAIEmbedder) EmbedSymbols(ctx context.Context, symbols []schema.Symb
 	return result, nil
 }
 
+// dedupeInputs 按内容 sha256 去重，返回唯一内容、其哈希，以及每个唯一内容
+// 对应的 input 下标（保持首次出现的顺序）。
+func dedupeInputs(inputs []EmbeddingInput) (contents, hashes []string, refs [][]int) {
+	index := make(map[string]int, len(inputs))
+	for k, in := range inputs {
+		sum := sha256.Sum256([]byte(in.Content))
+		hash := hex.EncodeToString(sum[:])
+		i, ok := index[hash]
+		if !ok {
+			i = len(contents)
+			index[hash] = i
+			contents = append(contents, in.Content)
+			hashes = append(hashes, hash)
+			refs = append(refs, nil)
+		}
+		refs[i] = append(refs[i], k)
+	}
+	return contents, hashes, refs
+}
+
+// blockCounts 统计每个文件的块级 input 数（按文件首次出现的顺序）。
+func blockCounts(inputs []EmbeddingInput) ([]string, []int) {
+	index := make(map[string]int)
+	var fileIDs []string
+	var counts []int
+	for _, in := range inputs {
+		if in.Level != models.CoarseLevelBlock && in.Level != models.CoarseLevelFile {
+			continue
+		}
+		i, ok := index[in.FileID]
+		if !ok {
+			i = len(fileIDs)
+			index[in.FileID] = i
+			fileIDs = append(fileIDs, in.FileID)
+			counts = append(counts, 0)
+		}
+		if in.Level == models.CoarseLevelBlock {
+			counts[i]++
+		}
+	}
+	return fileIDs, counts
+}
+
 // callEmbeddingAPI makes the actual API call to generate embeddings
 func (e *OpenAIEmbedder) callEmbeddingAPI(ctx context.Context, texts []string) ([][]float32, error) {
 	// Prepare request body
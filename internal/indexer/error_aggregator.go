@@ -0,0 +1,282 @@
+package indexer
+
+import (
+	"context"
+	"errors"
+	"sort"
+	"sync"
+	"sync/atomic"
+
+	"github.com/lib/pq"
+)
+
+// ErrErrorBudgetExceeded is returned when a run records more errors than its
+// configured budget and stops early
+var ErrErrorBudgetExceeded = errors.New("error budget exceeded")
+
+const (
+	// DefaultErrorExemplars is how many full errors each bucket retains
+	DefaultErrorExemplars = 5
+
+	// maxErrorBuckets bounds the number of distinct (stage, type, code)
+	// buckets; errors beyond it are counted in a single overflow bucket
+	maxErrorBuckets = 256
+
+	counterShards = 16
+)
+
+// ErrorKey identifies an aggregation bucket. Code is the PostgreSQL SQLSTATE
+// of the cause when there is one, the context error for timeouts, or the
+// violated rule (ValidationErrorType) for validation errors.
+type ErrorKey struct {
+	Stage string           `json:"stage"`
+	Type  IndexerErrorType `json:"type"`
+	Code  string           `json:"code,omitempty"`
+}
+
+// ErrorBucket is the structured summary of one bucket
+type ErrorBucket struct {
+	ErrorKey
+	Count        int64           `json:"count"`
+	NonRetryable int64           `json:"non_retryable"`
+	Exemplars    []*IndexerError `json:"exemplars"`
+}
+
+// errorBucket counts one key and keeps its first exemplars. Slots are claimed
+// with an atomic counter, so concurrent writers never block each other.
+type errorBucket struct {
+	key          ErrorKey
+	shard        int
+	count        atomic.Int64
+	nonRetryable atomic.Int64
+	claimed      atomic.Int64
+	exemplars    []atomic.Pointer[IndexerError]
+}
+
+// shardedCounter spreads increments over cache-line padded slots; each bucket
+// writes to its own slot, so hot buckets do not contend on one cache line
+type shardedCounter struct {
+	slots [counterShards]struct {
+		n atomic.Int64
+		_ [56]byte
+	}
+}
+
+func (c *shardedCounter) add(shard int, n int64) {
+	c.slots[shard%counterShards].n.Add(n)
+}
+
+func (c *shardedCounter) sum() int64 {
+	var total int64
+	for i := range c.slots {
+		total += c.slots[i].n.Load()
+	}
+	return total
+}
+
+// ErrorAggregator counts errors by (stage, type, code) in constant memory.
+// Unlike ErrorCollector it does not retain every error: each bucket keeps its
+// first N exemplars and a count, and callers can defer building an error
+// until the aggregator knows it will be kept (see Record). Safe for
+// concurrent use without locks on the recording path.
+type ErrorAggregator struct {
+	exemplars int
+	budget    int64
+
+	buckets     sync.Map // ErrorKey → *errorBucket
+	bucketCount atomic.Int64
+	overflow    *errorBucket
+
+	total        shardedCounter
+	nonRetryable shardedCounter
+
+	exceeded   atomic.Bool
+	onExceeded func()
+}
+
+// NewErrorAggregator creates an aggregator keeping exemplars errors per
+// bucket (DefaultErrorExemplars when <= 0). budget > 0 marks the run as over
+// budget once more than budget errors are recorded; 0 means unlimited.
+func NewErrorAggregator(exemplars, budget int) *ErrorAggregator {
+	if exemplars <= 0 {
+		exemplars = DefaultErrorExemplars
+	}
+	a := &ErrorAggregator{exemplars: exemplars, budget: int64(budget)}
+	a.overflow = a.newBucket(ErrorKey{Stage: "other", Type: "unknown"}, 0)
+	return a
+}
+
+// OnExceeded registers fn to run once, from the Add that exceeds the budget
+// (e.g. to cancel the run's context). Must be called before recording.
+func (a *ErrorAggregator) OnExceeded(fn func()) {
+	a.onExceeded = fn
+}
+
+func (a *ErrorAggregator) newBucket(key ErrorKey, shard int) *errorBucket {
+	return &errorBucket{key: key, shard: shard, exemplars: make([]atomic.Pointer[IndexerError], a.exemplars)}
+}
+
+func (a *ErrorAggregator) bucket(key ErrorKey) *errorBucket {
+	if b, ok := a.buckets.Load(key); ok {
+		return b.(*errorBucket)
+	}
+	n := a.bucketCount.Add(1)
+	if n > maxErrorBuckets {
+		a.bucketCount.Add(-1)
+		return a.overflow
+	}
+	b, loaded := a.buckets.LoadOrStore(key, a.newBucket(key, int(n)))
+	if loaded {
+		a.bucketCount.Add(-1)
+	}
+	return b.(*errorBucket)
+}
+
+// Record counts one error and reports whether it was kept as an exemplar.
+// build is only called when a slot is free, so the hot path of a failing run
+// allocates nothing once the bucket's exemplars are full.
+func (a *ErrorAggregator) Record(stage string, typ IndexerErrorType, code string, retryable bool, build func() *IndexerError) bool {
+	b := a.bucket(ErrorKey{Stage: stage, Type: typ, Code: code})
+	b.count.Add(1)
+	a.total.add(b.shard, 1)
+	if !retryable {
+		b.nonRetryable.Add(1)
+		a.nonRetryable.add(b.shard, 1)
+	}
+
+	kept := false
+	if slot := b.claimed.Add(1) - 1; slot < int64(len(b.exemplars)) {
+		b.exemplars[slot].Store(build())
+		kept = true
+	}
+
+	if a.budget > 0 && !a.exceeded.Load() && a.total.sum() > a.budget {
+		if a.exceeded.CompareAndSwap(false, true) && a.onExceeded != nil {
+			a.onExceeded()
+		}
+	}
+	return kept
+}
+
+// Add records an already constructed error under stage. Errors that are not
+// *IndexerError are counted as type "unknown" and non-retryable.
+func (a *ErrorAggregator) Add(stage string, err error) bool {
+	if err == nil {
+		return false
+	}
+	var indexerErr *IndexerError
+	if !errors.As(err, &indexerErr) {
+		indexerErr = &IndexerError{Type: "unknown", Message: err.Error(), Cause: err}
+	}
+	return a.Record(stage, indexerErr.Type, errorCode(indexerErr.Cause), indexerErr.Retryable, func() *IndexerError {
+		return indexerErr
+	})
+}
+
+// Count returns the number of recorded errors
+func (a *ErrorAggregator) Count() int {
+	return int(a.total.sum())
+}
+
+// HasErrors returns true if any error was recorded
+func (a *ErrorAggregator) HasErrors() bool {
+	return a.Count() > 0
+}
+
+// NonRetryableCount returns the number of non-retryable errors
+func (a *ErrorAggregator) NonRetryableCount() int {
+	return int(a.nonRetryable.sum())
+}
+
+// Exceeded reports whether the error budget has been exceeded. A nil
+// aggregator never is.
+func (a *ErrorAggregator) Exceeded() bool {
+	return a != nil && a.exceeded.Load()
+}
+
+// StageCount returns the number of errors recorded under stage
+func (a *ErrorAggregator) StageCount(stage string) int {
+	total := 0
+	for _, b := range a.Buckets() {
+		if b.Stage == stage {
+			total += int(b.Count)
+		}
+	}
+	return total
+}
+
+// Buckets returns every non-empty bucket, largest first
+func (a *ErrorAggregator) Buckets() []ErrorBucket {
+	var out []ErrorBucket
+	collect := func(b *errorBucket) {
+		count := b.count.Load()
+		if count == 0 {
+			return
+		}
+		bucket := ErrorBucket{ErrorKey: b.key, Count: count, NonRetryable: b.nonRetryable.Load()}
+		for i := range b.exemplars {
+			// 槽位已被占用但尚未写入时为 nil，跳过
+			if e := b.exemplars[i].Load(); e != nil {
+				bucket.Exemplars = append(bucket.Exemplars, e)
+			}
+		}
+		out = append(out, bucket)
+	}
+	a.buckets.Range(func(_, v interface{}) bool {
+		collect(v.(*errorBucket))
+		return true
+	})
+	collect(a.overflow)
+
+	sort.Slice(out, func(i, j int) bool {
+		if out[i].Count != out[j].Count {
+			return out[i].Count > out[j].Count
+		}
+		if out[i].Stage != out[j].Stage {
+			return out[i].Stage < out[j].Stage
+		}
+		if out[i].Type != out[j].Type {
+			return out[i].Type < out[j].Type
+		}
+		return out[i].Code < out[j].Code
+	})
+	return out
+}
+
+// Exemplars returns the retained errors of all buckets, at most
+// exemplars × buckets regardless of how many errors were recorded
+func (a *ErrorAggregator) Exemplars() []*IndexerError {
+	var out []*IndexerError
+	for _, b := range a.Buckets() {
+		out = append(out, b.Exemplars...)
+	}
+	return out
+}
+
+// Summary returns error counts by type, the shape ErrorCollector.Summary has
+func (a *ErrorAggregator) Summary() map[string]int {
+	summary := make(map[string]int)
+	for _, b := range a.Buckets() {
+		summary[string(b.Type)] += int(b.Count)
+	}
+	return summary
+}
+
+// errorCode derives the bucket code of a cause: the SQLSTATE of PostgreSQL
+// errors, or the context error for cancellations and timeouts
+func errorCode(err error) string {
+	if err == nil {
+		return ""
+	}
+	var pqErr *pq.Error
+	if errors.As(err, &pqErr) {
+		return string(pqErr.Code)
+	}
+	switch {
+	case errors.Is(err, context.DeadlineExceeded):
+		return "deadline_exceeded"
+	case errors.Is(err, context.Canceled):
+		return "canceled"
+	}
+	return ""
+}
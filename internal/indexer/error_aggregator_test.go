@@ -0,0 +1,104 @@
+package indexer
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"sync"
+	"sync/atomic"
+	"testing"
+
+	"github.com/lib/pq"
+	"github.com/stretchr/testify/assert"
+)
+
+func TestErrorAggregator_BucketsAndExemplars(t *testing.T) {
+	agg := NewErrorAggregator(3, 0)
+
+	var built atomic.Int64
+	for i := 0; i < 1000; i++ {
+		agg.Record("write", ErrorTypeDatabase, "symbol", false, func() *IndexerError {
+			built.Add(1)
+			return NewDatabaseError("insert failed", fmt.Sprintf("sym-%d", i), "", nil, false)
+		})
+	}
+	agg.Add("embedding", NewEmbeddingError("rate limited", "sym-1", "", nil, true))
+
+	assert.Equal(t, 1001, agg.Count())
+	assert.Equal(t, 1000, agg.NonRetryableCount())
+	assert.Equal(t, int64(3), built.Load(), "errors beyond the exemplar slots must not be built")
+
+	buckets := agg.Buckets()
+	assert.Len(t, buckets, 2)
+	assert.Equal(t, ErrorKey{Stage: "write", Type: ErrorTypeDatabase, Code: "symbol"}, buckets[0].ErrorKey)
+	assert.Equal(t, int64(1000), buckets[0].Count)
+	assert.Len(t, buckets[0].Exemplars, 3)
+	assert.Equal(t, "sym-0", buckets[0].Exemplars[0].EntityID)
+
+	assert.Len(t, agg.Exemplars(), 4)
+	assert.Equal(t, map[string]int{"database": 1000, "embedding": 1}, agg.Summary())
+}
+
+func TestErrorAggregator_Concurrent(t *testing.T) {
+	agg := NewErrorAggregator(2, 0)
+
+	var wg sync.WaitGroup
+	for w := 0; w < 8; w++ {
+		wg.Add(1)
+		go func(w int) {
+			defer wg.Done()
+			for i := 0; i < 1000; i++ {
+				agg.Add(fmt.Sprintf("stage-%d", w%4), NewTimeoutError("slow", "", "", context.DeadlineExceeded))
+			}
+		}(w)
+	}
+	wg.Wait()
+
+	assert.Equal(t, 8000, agg.Count())
+	buckets := agg.Buckets()
+	assert.Len(t, buckets, 4)
+	for _, b := range buckets {
+		assert.Equal(t, int64(2000), b.Count)
+		assert.Equal(t, "deadline_exceeded", b.Code)
+		assert.Len(t, b.Exemplars, 2)
+	}
+}
+
+func TestErrorAggregator_Budget(t *testing.T) {
+	agg := NewErrorAggregator(1, 5)
+	var fired atomic.Int64
+	agg.OnExceeded(func() { fired.Add(1) })
+
+	for i := 0; i < 5; i++ {
+		agg.Add("write", errors.New("boom"))
+	}
+	assert.False(t, agg.Exceeded(), "reaching the budget is allowed")
+
+	for i := 0; i < 10; i++ {
+		agg.Add("write", errors.New("boom"))
+	}
+	assert.True(t, agg.Exceeded())
+	assert.Equal(t, int64(1), fired.Load(), "OnExceeded runs once")
+}
+
+func TestErrorAggregator_OverflowBucket(t *testing.T) {
+	agg := NewErrorAggregator(1, 0)
+	for i := 0; i < maxErrorBuckets+10; i++ {
+		agg.Record(fmt.Sprintf("stage-%d", i), ErrorTypeValidation, "", false, func() *IndexerError {
+			return NewValidationError("bad", "", "", nil)
+		})
+	}
+
+	buckets := agg.Buckets()
+	assert.Len(t, buckets, maxErrorBuckets+1)
+	assert.Equal(t, "other", buckets[0].Stage, "overflow bucket collects the rest")
+	assert.Equal(t, int64(10), buckets[0].Count)
+	assert.Equal(t, maxErrorBuckets+10, agg.Count())
+}
+
+func TestErrorCode(t *testing.T) {
+	assert.Equal(t, "", errorCode(nil))
+	assert.Equal(t, "23505", errorCode(fmt.Errorf("insert: %w", &pq.Error{Code: "23505"})))
+	assert.Equal(t, "canceled", errorCode(context.Canceled))
+	assert.Equal(t, "", errorCode(errors.New("other")))
+}
@@ -0,0 +1,153 @@
+package indexer
+
+import (
+	"context"
+	"fmt"
+	"sort"
+
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+// recordHistory 把本次索引相对上一提交的差异写入提交级历史（IndexerConfig.History）。
+//
+// 差异范围（scope）是本次写入的文件、上一提交之后被删除的文件（历史中仍有效
+// 但不在输入中），以及输入中尚未进入历史的文件；范围外的历史行原样保留，
+// 所以增量索引只付出变更文件的代价。
+func (idx *Indexer) recordHistory(ctx context.Context, input *schema.ParseOutput, changed []schema.File) (*models.HistoryDiff, error) {
+	tx, err := idx.db.BeginTx(ctx, nil)
+	if err != nil {
+		return nil, fmt.Errorf("failed to begin history transaction: %w", err)
+	}
+	defer tx.Rollback()
+
+	history := models.NewHistoryRepository(idx.db)
+	seq, err := history.BeginCommit(ctx, tx, idx.config.RepoID, idx.config.CommitHash)
+	if err != nil {
+		return nil, err
+	}
+	open, err := history.OpenPaths(ctx, tx, idx.config.RepoID)
+	if err != nil {
+		return nil, err
+	}
+
+	scope := historyScope(input.Files, changed, open)
+	symbols, edges := buildHistory(input.Files, input.Relationships, scope)
+	paths := make([]string, 0, len(scope))
+	for p := range scope {
+		paths = append(paths, p)
+	}
+	sort.Strings(paths)
+
+	diff, err := history.ApplyDiff(ctx, tx, idx.config.RepoID, seq, paths, symbols, edges)
+	if err != nil {
+		return nil, err
+	}
+	if err := tx.Commit(); err != nil {
+		return nil, fmt.Errorf("failed to commit history: %w", err)
+	}
+	return diff, nil
+}
+
+// historyScope 计算需要对比的文件路径集合。
+func historyScope(all, changed []schema.File, open []string) map[string]bool {
+	present := make(map[string]bool, len(all))
+	for _, f := range all {
+		present[f.Path] = true
+	}
+	recorded := make(map[string]bool, len(open))
+	scope := make(map[string]bool, len(changed))
+	for _, p := range open {
+		recorded[p] = true
+		if !present[p] {
+			scope[p] = true // 已删除
+		}
+	}
+	for _, f := range changed {
+		scope[f.Path] = true
+	}
+	for _, f := range all {
+		if !recorded[f.Path] {
+			scope[f.Path] = true // 首次进入历史（包括开启历史模式后的第一次索引）
+		}
+	}
+	return scope
+}
+
+// buildHistory 把解析结果转换为 scope 内文件的历史符号和边。
+// 所有文件的符号键都会计算，以便解析指向 scope 外符号的边。
+func buildHistory(files []schema.File, edges []schema.DependencyEdge, scope map[string]bool) ([]models.HistorySymbol, []models.HistoryEdge) {
+	type located struct {
+		key  string
+		path string
+	}
+	byID := make(map[string]located)
+	var symbols []models.HistorySymbol
+
+	for _, f := range files {
+		order := make([]int, len(f.Symbols))
+		for i := range order {
+			order[i] = i
+		}
+		sort.SliceStable(order, func(a, b int) bool {
+			sa, sb := f.Symbols[order[a]].Span, f.Symbols[order[b]].Span
+			if sa.StartByte != sb.StartByte {
+				return sa.StartByte < sb.StartByte
+			}
+			return sa.StartLine < sb.StartLine
+		})
+
+		seen := make(map[string]int, len(f.Symbols))
+		for _, i := range order {
+			s := f.Symbols[i]
+			name := string(s.Kind) + ":" + s.Name
+			key := models.HistorySymbolKey(f.Path, string(s.Kind), s.Name, seen[name])
+			seen[name]++
+			byID[s.SymbolID] = located{key: key, path: f.Path}
+
+			if scope[f.Path] {
+				symbols = append(symbols, models.HistorySymbol{
+					Key:       key,
+					SymbolID:  s.SymbolID,
+					FilePath:  f.Path,
+					Name:      s.Name,
+					Kind:      string(s.Kind),
+					Signature: s.Signature,
+					StartLine: s.Span.StartLine,
+					EndLine:   s.Span.EndLine,
+				})
+			}
+		}
+	}
+
+	var result []models.HistoryEdge
+	seen := make(map[models.HistoryEdge]bool, len(edges))
+	for _, e := range edges {
+		source, ok := byID[e.SourceID]
+		if !ok {
+			continue // 源符号不在本仓库输入中（如外部占位符号）
+		}
+		he := models.HistoryEdge{
+			SourceKey:    source.key,
+			SourcePath:   source.path,
+			TargetPath:   e.TargetFile,
+			TargetModule: e.TargetModule,
+			TargetName:   e.TargetName,
+			EdgeType:     string(e.EdgeType),
+		}
+		if target, ok := byID[e.TargetID]; ok && e.TargetID != "" {
+			he.TargetKey = target.key
+			he.TargetPath = target.path
+		}
+		if !scope[he.SourcePath] && !scope[he.TargetPath] {
+			continue
+		}
+		// 同一调用点出现多次时只记一条
+		if seen[he] {
+			continue
+		}
+		seen[he] = true
+		result = append(result, he)
+	}
+	return symbols, result
+}
@@ -0,0 +1,98 @@
+package indexer
+
+import (
+	"reflect"
+	"sort"
+	"testing"
+
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+func historyTestFiles() []schema.File {
+	return []schema.File{
+		{
+			FileID: "f1", Path: "a.go",
+			Symbols: []schema.Symbol{
+				// 同名同种类的两个符号按出现位置编号，与切片顺序无关
+				{SymbolID: "s2", Name: "init", Kind: schema.SymbolFunction, Span: schema.Span{StartLine: 9, StartByte: 90}},
+				{SymbolID: "s1", Name: "init", Kind: schema.SymbolFunction, Span: schema.Span{StartLine: 1, StartByte: 10}},
+				{SymbolID: "s3", Name: "run", Kind: schema.SymbolFunction, Signature: "func run()", Span: schema.Span{StartLine: 20, StartByte: 200}},
+			},
+		},
+		{
+			FileID: "f2", Path: "b.go",
+			Symbols: []schema.Symbol{
+				{SymbolID: "s4", Name: "helper", Kind: schema.SymbolFunction, Span: schema.Span{StartLine: 3, StartByte: 30}},
+			},
+		},
+	}
+}
+
+func TestBuildHistoryKeys(t *testing.T) {
+	files := historyTestFiles()
+	symbols, _ := buildHistory(files, nil, map[string]bool{"a.go": true})
+
+	got := make(map[string]string)
+	for _, s := range symbols {
+		got[s.SymbolID] = s.Key
+	}
+	want := map[string]string{
+		"s1": "a.go#function:init",
+		"s2": "a.go#function:init@1",
+		"s3": "a.go#function:run",
+	}
+	if !reflect.DeepEqual(got, want) {
+		t.Errorf("keys = %v, want %v", got, want)
+	}
+}
+
+func TestBuildHistoryEdgesScope(t *testing.T) {
+	files := historyTestFiles()
+	edges := []schema.DependencyEdge{
+		{SourceID: "s3", TargetID: "s4", EdgeType: schema.EdgeCall, TargetName: "helper"},
+		{SourceID: "s3", TargetID: "s4", EdgeType: schema.EdgeCall, TargetName: "helper"}, // 同一调用点重复
+		{SourceID: "s4", EdgeType: schema.EdgeImport, TargetModule: "fmt"},
+		{SourceID: "external", TargetID: "s3", EdgeType: schema.EdgeCall},
+	}
+
+	// 只有 b.go 变更：a.go -> b.go 的调用仍在范围内（目标端变更）
+	_, got := buildHistory(files, edges, map[string]bool{"b.go": true})
+	want := []models.HistoryEdge{
+		{SourceKey: "a.go#function:run", SourcePath: "a.go", TargetKey: "b.go#function:helper",
+			TargetPath: "b.go", TargetName: "helper", EdgeType: "call"},
+		{SourceKey: "b.go#function:helper", SourcePath: "b.go", TargetModule: "fmt", EdgeType: "import"},
+	}
+	if !reflect.DeepEqual(got, want) {
+		t.Errorf("edges = %+v, want %+v", got, want)
+	}
+
+	// 两端都不在范围内的边不写入
+	if _, got := buildHistory(files, edges, map[string]bool{"c.go": true}); len(got) != 0 {
+		t.Errorf("expected no edges outside scope, got %+v", got)
+	}
+}
+
+func TestHistoryScope(t *testing.T) {
+	all := historyTestFiles()
+	changed := all[:1]
+	open := []string{"a.go", "deleted.go"}
+
+	scope := historyScope(all, changed, open)
+	var got []string
+	for p := range scope {
+		got = append(got, p)
+	}
+	sort.Strings(got)
+	// a.go 变更，deleted.go 已删除，b.go 尚未进入历史
+	want := []string{"a.go", "b.go", "deleted.go"}
+	if !reflect.DeepEqual(got, want) {
+		t.Errorf("scope = %v, want %v", got, want)
+	}
+
+	// b.go 已有历史且未变更时不在范围内
+	scope = historyScope(all, changed, []string{"a.go", "b.go"})
+	if scope["b.go"] {
+		t.Error("unchanged recorded file should not be in scope")
+	}
+}
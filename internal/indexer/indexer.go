@@ -17,10 +17,13 @@ import (
 //
 // Indexer 自身实现该接口（方法已存在）；测试可注入 fakeExecutor
 // 来记录各阶段调用次数而无需真实数据库。
+//
+// errs 非空时，各阶段在错误发生处直接记入聚合器（结果中不再携带错误列表），
+// 超出预算后写入循环立即停止；为 nil 时错误照旧通过结果返回。
 type pipelineExecutor interface {
 	writeRepository(ctx context.Context) error
-	writeData(ctx context.Context, files []schema.File, edges []schema.DependencyEdge) (*WriteResult, error)
-	generateEmbeddings(ctx context.Context, files []schema.File) *EmbedResult
+	writeData(ctx context.Context, files []schema.File, edges []schema.DependencyEdge, errs *ErrorAggregator) (*WriteResult, error)
+	generateEmbeddings(ctx context.Context, files []schema.File, errs *ErrorAggregator) *EmbedResult
 }
 
 // Indexer orchestrates the indexing pipeline
@@ -65,6 +68,9 @@ type IndexerConfig struct {
 	RepoURL  string `json:"repo_url,omitempty"`
 	Branch   string `json:"branch,omitempty"`
 
+	// CommitHash 是本次索引对应的提交，写入 repositories.commit_hash
+	CommitHash string `json:"commit_hash,omitempty"`
+
 	// Processing options
 	BatchSize       int  `json:"batch_size"`
 	WorkerCount     int  `json:"worker_count"`
@@ -72,6 +78,25 @@ type IndexerConfig struct {
 	Incremental     bool `json:"incremental"`
 	UseTransactions bool `json:"use_transactions"`
 
+	// WriteParallelism > 1 让事务写入按文件分组，由多个连接并发写入暂存表，
+	// 再在一个事务内发布（见 models.StagedWrite）；文件数少于
+	// 2 × minFilesPerWriteGroup 时仍走单事务
+	WriteParallelism int `json:"write_parallelism,omitempty"`
+
+	// History 开启提交级增量历史：写入数据后把相对上一提交的符号/边差异
+	// 记录到 symbol_history / edge_history，需要 CommitHash
+	History bool `json:"history,omitempty"`
+
+	// BulkLoad 非空时，写入前先删除空表上的二级索引，写完后按该配置并行重建
+	// （见 models.BeginBulkLoad）；表非空（增量索引、已有其他仓库）时不生效
+	BulkLoad *models.BulkLoadConfig `json:"bulk_load,omitempty"`
+
+	// ErrorBudget > 0 让错误数超过该值时提前结束本次索引（跳过历史、关联与
+	// 向量阶段）；0 表示不限制。ErrorExemplars 是每个 (stage, type, code)
+	// 分桶保留的完整错误数，<= 0 时为 DefaultErrorExemplars
+	ErrorBudget    int `json:"error_budget,omitempty"`
+	ErrorExemplars int `json:"error_exemplars,omitempty"`
+
 	// Embedding options
 	EmbeddingModel string `json:"embedding_model,omitempty"`
 }
@@ -230,27 +255,29 @@ func (idx *Indexer) Index(ctx context.Context, input *schema.ParseOutput) (*Inde
 		LogField{Key: "relationships_count", Value: len(input.Relationships)},
 	)
 
-	// Collect errors throughout the process
-	errorCollector := NewErrorCollector()
+	// Aggregate errors throughout the process: counts per (stage, type, code)
+	// plus a few exemplars each, so a run with millions of failing rows stays
+	// in constant memory
+	errs := NewErrorAggregator(idx.config.ErrorExemplars, idx.config.ErrorBudget)
+
+	// 超出预算时取消仍在进行的阶段（写入、embedding 请求）；
+	// generation 自增与索引重建不受影响
+	parentCtx := ctx
+	ctx, cancelRun := context.WithCancelCause(ctx)
+	defer cancelRun(nil)
+	errs.OnExceeded(func() { cancelRun(ErrErrorBudgetExceeded) })
 
 	// Step 1: Validate input
 	idx.logger.Debug("validating input")
-	validationResult := idx.validator.Validate(input)
+	validationResult := idx.validator.ValidateWith(input, errs)
 	if validationResult.HasErrors() {
 		idx.logger.ErrorWithFields("validation failed", nil,
 			LogField{Key: "error_count", Value: validationResult.ErrorCount()},
 			LogField{Key: "repo_id", Value: idx.config.RepoID},
 		)
-		for _, valErr := range validationResult.Errors {
-			errorCollector.Add(NewValidationError(
-				valErr.Message,
-				valErr.EntityID,
-				valErr.FilePath,
-				nil,
-			))
-		}
 		result.Status = "failed"
-		result.Errors = convertErrors(errorCollector.Errors())
+		result.Errors = errs.Exemplars()
+		result.Summary["error_buckets"] = errs.Buckets()
 		result.Duration = time.Since(startTime)
 		return result, fmt.Errorf("validation failed with %d errors", validationResult.ErrorCount())
 	}
@@ -264,7 +291,7 @@ func (idx *Indexer) Index(ctx context.Context, input *schema.ParseOutput) (*Inde
 		idx.logger.ErrorWithFields("failed to write repository metadata", err,
 			LogField{Key: "repo_id", Value: idx.config.RepoID},
 		)
-		errorCollector.Add(NewDatabaseError(
+		errs.Add("repository", NewDatabaseError(
 			"failed to write repository metadata",
 			idx.config.RepoID,
 			"",
@@ -272,7 +299,7 @@ func (idx *Indexer) Index(ctx context.Context, input *schema.ParseOutput) (*Inde
 			true,
 		))
 		result.Status = "failed"
-		result.Errors = convertErrors(errorCollector.Errors())
+		result.Errors = errs.Exemplars()
 		result.Duration = time.Since(startTime)
 		return result, err
 	}
@@ -299,24 +326,45 @@ func (idx *Indexer) Index(ctx context.Context, input *schema.ParseOutput) (*Inde
 		)
 	}
 
+	// Step 3.5: Defer secondary indexes of empty tables (optional)
+	var bulk *models.BulkLoad
+	if idx.config.BulkLoad != nil && idx.db != nil {
+		b, err := models.BeginBulkLoad(ctx, idx.db, *idx.config.BulkLoad)
+		if err != nil {
+			idx.logger.WarnWithFields("failed to defer indexes, loading with indexes in place", LogField{Key: "error", Value: err})
+			// Non-fatal, continue
+		} else if deferred := b.Deferred(); len(deferred) > 0 {
+			bulk = b
+			result.Summary["deferred_indexes"] = len(deferred)
+			idx.logger.InfoWithFields("secondary indexes deferred for bulk load",
+				LogField{Key: "indexes", Value: len(deferred)},
+			)
+		}
+	}
+	// 中途返回或 panic 时也要重建；请求被取消后重建仍需完成，故不继承取消
+	defer idx.finishBulkLoad(context.WithoutCancel(ctx), bulk, nil)
+
 	// Step 4: Write data to database
 	idx.logger.InfoWithFields("writing data to database",
 		LogField{Key: "files_to_process", Value: len(filesToProcess)},
 		LogField{Key: "relationships", Value: len(input.Relationships)},
 	)
-	writeResult, err := idx.executor.writeData(ctx, filesToProcess, input.Relationships)
+	writeResult, err := idx.executor.writeData(ctx, filesToProcess, input.Relationships, errs)
 	writeDataFailed := err != nil
 	if writeDataFailed {
 		idx.logger.ErrorWithFields("failed to write data", err,
 			LogField{Key: "repo_id", Value: idx.config.RepoID},
 		)
-		errorCollector.Add(NewDatabaseError(
-			"failed to write data",
-			"",
-			"",
-			err,
-			true,
-		))
+		// 因预算中止时错误已在发生处记录，不再额外计一次
+		if !errs.Exceeded() {
+			errs.Add("write", NewDatabaseError(
+				"failed to write data",
+				"",
+				"",
+				err,
+				true,
+			))
+		}
 		// writeData 失败时返回的部分填充计数（如子步骤中途 return）不可靠，
 		// 不上报，避免 result.FilesProcessed 等虚高。
 		writeResult = &WriteResult{}
@@ -331,30 +379,68 @@ func (idx *Indexer) Index(ctx context.Context, input *schema.ParseOutput) (*Inde
 		LogField{Key: "symbols_created", Value: writeResult.SymbolsCreated},
 		LogField{Key: "nodes_created", Value: writeResult.NodesCreated},
 		LogField{Key: "edges_created", Value: writeResult.EdgesCreated},
-		LogField{Key: "write_errors", Value: len(writeResult.Errors)},
+		LogField{Key: "write_errors", Value: errs.StageCount("write")},
 	)
 
-	// Collect write errors
+	// Collect write errors the executor returned instead of recording them;
+	// only exemplars are logged
 	for _, writeErr := range writeResult.Errors {
-		idx.logger.WarnWithFields("write error occurred",
-			LogField{Key: "entity_type", Value: writeErr.EntityType},
-			LogField{Key: "entity_id", Value: writeErr.EntityID},
-			LogField{Key: "message", Value: writeErr.Message},
-			LogField{Key: "retryable", Value: writeErr.Retryable},
+		if errs.Record("write", ErrorTypeDatabase, writeErr.Code, writeErr.Retryable, func() *IndexerError {
+			return NewDatabaseError(writeErr.EntityType+": "+writeErr.Message, writeErr.EntityID, "", nil, writeErr.Retryable)
+		}) {
+			idx.logger.WarnWithFields("write error occurred",
+				LogField{Key: "entity_type", Value: writeErr.EntityType},
+				LogField{Key: "entity_id", Value: writeErr.EntityID},
+				LogField{Key: "message", Value: writeErr.Message},
+				LogField{Key: "retryable", Value: writeErr.Retryable},
+			)
+		}
+	}
+
+	// 图表索引先重建：历史记录与头文件关联都要按这些表查询
+	idx.finishBulkLoad(context.WithoutCancel(ctx), bulk, errs, "symbols", "ast_nodes", "edges")
+
+	// 错误数超出预算：不再做后续增强步骤，直接收尾
+	overBudget := errs.Exceeded()
+	if overBudget {
+		idx.logger.WarnWithFields("error budget exceeded, stopping early",
+			LogField{Key: "budget", Value: idx.config.ErrorBudget},
+			LogField{Key: "total_errors", Value: errs.Count()},
 		)
-		errorCollector.Add(NewDatabaseError(
-			writeErr.Message,
-			writeErr.EntityID,
-			"",
-			nil,
-			writeErr.Retryable,
-		))
+	}
+
+	// Step 4.2: Record commit-level history (optional)
+	// writeData 失败时当前表状态不完整，不能作为该提交的历史
+	if idx.config.History && idx.config.CommitHash != "" && !writeDataFailed && !overBudget && idx.db != nil {
+		diff, err := idx.recordHistory(ctx, input, filesToProcess)
+		if err != nil {
+			idx.logger.WarnWithFields("failed to record commit history",
+				LogField{Key: "commit", Value: idx.config.CommitHash},
+				LogField{Key: "error", Value: err},
+			)
+			errs.Add("history", NewDatabaseError(
+				"failed to record commit history",
+				idx.config.CommitHash,
+				"",
+				err,
+				false,
+			))
+		} else {
+			result.Summary["history"] = diff
+			idx.logger.InfoWithFields("commit history recorded",
+				LogField{Key: "commit", Value: idx.config.CommitHash},
+				LogField{Key: "symbols_opened", Value: diff.SymbolsOpened},
+				LogField{Key: "symbols_closed", Value: diff.SymbolsClosed},
+				LogField{Key: "edges_opened", Value: diff.EdgesOpened},
+				LogField{Key: "edges_closed", Value: diff.EdgesClosed},
+			)
+		}
 	}
 
 	// Step 4.5: Associate header and implementation files (for C/C++/Objective-C)
 	idx.logger.Info("associating header and implementation files")
 	var assocResult *AssociationResult
-	if idx.db == nil {
+	if idx.db == nil || overBudget {
 		// 测试环境（db 未注入，走 fake executor）下跳过；
 		// 该步骤为非致命的增强关联，真实路径中会执行。
 		assocResult = &AssociationResult{}
@@ -385,51 +471,68 @@ func (idx *Indexer) Index(ctx context.Context, input *schema.ParseOutput) (*Inde
 	}
 
 	// Step 5: Generate embeddings (async, optional)
-	if idx.embedder != nil && !idx.config.SkipVectors {
+	if idx.embedder != nil && !idx.config.SkipVectors && !overBudget {
 		idx.logger.Info("generating vector embeddings")
-		embedResult := idx.executor.generateEmbeddings(ctx, filesToProcess)
+		embedResult := idx.executor.generateEmbeddings(ctx, filesToProcess, errs)
 		result.VectorsCreated = embedResult.VectorsCreated
 
+		if embedResult.CoarseVectorsCreated > 0 {
+			result.Summary["coarse_vectors_created"] = embedResult.CoarseVectorsCreated
+		}
+
 		idx.logger.InfoWithFields("vector embeddings generated",
 			LogField{Key: "vectors_created", Value: embedResult.VectorsCreated},
-			LogField{Key: "embedding_errors", Value: len(embedResult.Errors)},
+			LogField{Key: "coarse_vectors_created", Value: embedResult.CoarseVectorsCreated},
+			LogField{Key: "embeddings_reused", Value: embedResult.EmbeddingsReused},
+			LogField{Key: "embedding_errors", Value: errs.StageCount("embedding")},
 		)
 
-		// Collect embedding errors (non-fatal)
+		// Collect embedding errors the executor returned (non-fatal); only
+		// exemplars are logged
 		for _, embedErr := range embedResult.Errors {
-			idx.logger.WarnWithFields("embedding error occurred",
-				LogField{Key: "entity_id", Value: embedErr.EntityID},
-				LogField{Key: "message", Value: embedErr.Message},
-			)
-			errorCollector.Add(NewEmbeddingError(
-				embedErr.Message,
-				embedErr.EntityID,
-				"",
-				nil,
-				true,
-			))
+			if errs.Record("embedding", ErrorTypeEmbedding, "", true, func() *IndexerError {
+				return NewEmbeddingError(embedErr.Message, embedErr.EntityID, "", nil, true)
+			}) {
+				idx.logger.WarnWithFields("embedding error occurred",
+					LogField{Key: "entity_id", Value: embedErr.EntityID},
+					LogField{Key: "message", Value: embedErr.Message},
+				)
+			}
 		}
 	}
 
+	// 其余（向量表）索引在 generation 自增前重建完，保证缓存失效后的查询走索引
+	idx.finishBulkLoad(context.WithoutCancel(ctx), bulk, errs)
+
+	// Step 6: Bump index generation so cached API responses are revalidated.
+	// 即使 writeData 失败或超出预算也要自增：部分数据可能已落库。
+	if gen, ok := idx.bumpIndexGeneration(parentCtx); ok {
+		result.Summary["index_generation"] = gen
+	}
+
 	// Finalize result
 	result.Duration = time.Since(startTime)
-	result.Errors = convertErrors(errorCollector.Errors())
+	result.Errors = errs.Exemplars()
 
-	// Determine final status
-	if errorCollector.HasErrors() {
-		nonRetryable := errorCollector.FilterNonRetryable()
-		if len(nonRetryable) > 0 {
+	// Determine final status; embedding errors may have exhausted the budget
+	overBudget = errs.Exceeded()
+	if overBudget {
+		result.Status = "failed"
+		result.Summary["error_budget_exceeded"] = true
+	} else if errs.HasErrors() {
+		nonRetryable := errs.NonRetryableCount()
+		if nonRetryable > 0 {
 			result.Status = "partial_success"
 			idx.logger.WarnWithFields("indexing completed with errors",
 				LogField{Key: "status", Value: result.Status},
-				LogField{Key: "total_errors", Value: errorCollector.Count()},
-				LogField{Key: "non_retryable_errors", Value: len(nonRetryable)},
+				LogField{Key: "total_errors", Value: errs.Count()},
+				LogField{Key: "non_retryable_errors", Value: nonRetryable},
 			)
 		} else {
 			result.Status = "success_with_warnings"
 			idx.logger.InfoWithFields("indexing completed with warnings",
 				LogField{Key: "status", Value: result.Status},
-				LogField{Key: "total_warnings", Value: errorCollector.Count()},
+				LogField{Key: "total_warnings", Value: errs.Count()},
 			)
 		}
 	} else {
@@ -440,8 +543,9 @@ func (idx *Indexer) Index(ctx context.Context, input *schema.ParseOutput) (*Inde
 	}
 
 	// Add summary statistics
-	result.Summary["total_errors"] = errorCollector.Count()
-	result.Summary["error_types"] = errorCollector.Summary()
+	result.Summary["total_errors"] = errs.Count()
+	result.Summary["error_types"] = errs.Summary()
+	result.Summary["error_buckets"] = errs.Buckets()
 	result.Summary["validation_errors"] = validationResult.ErrorCount()
 
 	idx.logger.InfoWithFields("indexing operation completed",
@@ -452,9 +556,12 @@ func (idx *Indexer) Index(ctx context.Context, input *schema.ParseOutput) (*Inde
 		LogField{Key: "symbols_created", Value: result.SymbolsCreated},
 		LogField{Key: "edges_created", Value: result.EdgesCreated},
 		LogField{Key: "vectors_created", Value: result.VectorsCreated},
-		LogField{Key: "total_errors", Value: errorCollector.Count()},
+		LogField{Key: "total_errors", Value: errs.Count()},
 	)
 
+	if overBudget {
+		return result, fmt.Errorf("%w: %d errors (budget %d)", ErrErrorBudgetExceeded, errs.Count(), idx.config.ErrorBudget)
+	}
 	return result, nil
 }
 
@@ -542,7 +649,7 @@ func (idx *Indexer) IndexWithProgress(ctx context.Context, input *schema.ParseOu
 		}
 	}
 
-	writeResult, err := idx.executor.writeData(ctx, filesToProcess, input.Relationships)
+	writeResult, err := idx.executor.writeData(ctx, filesToProcess, input.Relationships, nil)
 	if err != nil {
 		// 与 Index 的契约一致：返回带 Status 的失败结果而非 nil。
 		// writeData 失败时 writeResult 的部分计数不可靠，不上报。
@@ -569,7 +676,7 @@ func (idx *Indexer) IndexWithProgress(ctx context.Context, input *schema.ParseOu
 			}
 		}
 
-		embedResult := idx.executor.generateEmbeddings(ctx, filesToProcess)
+		embedResult := idx.executor.generateEmbeddings(ctx, filesToProcess, nil)
 		vectorsCreated = embedResult.VectorsCreated
 
 		if progressChan != nil {
@@ -581,6 +688,8 @@ func (idx *Indexer) IndexWithProgress(ctx context.Context, input *schema.ParseOu
 		}
 	}
 
+	gen, bumped := idx.bumpIndexGeneration(ctx)
+
 	// Complete
 	if progressChan != nil {
 		progressChan <- IndexProgress{
@@ -606,10 +715,59 @@ func (idx *Indexer) IndexWithProgress(ctx context.Context, input *schema.ParseOu
 		Duration:       time.Since(startTime),
 		Summary:        make(map[string]interface{}),
 	}
+	if bumped {
+		result.Summary["index_generation"] = gen
+	}
 
 	return result, nil
 }
 
+// bumpIndexGeneration atomically increments the repository's index generation.
+// Failure is non-fatal; the in-memory entry is dropped instead so that no stale
+// validator can still match and conditional GETs for the repository fall back
+// to full responses.
+func (idx *Indexer) bumpIndexGeneration(ctx context.Context) (int64, bool) {
+	if idx.db == nil {
+		// 测试环境（db 未注入，走 fake executor）下跳过
+		return 0, false
+	}
+	gen, err := models.NewRepositoryRepository(idx.db).BumpIndexGeneration(ctx, idx.config.RepoID)
+	if err != nil {
+		idx.logger.WarnWithFields("failed to bump index generation",
+			LogField{Key: "repo_id", Value: idx.config.RepoID},
+			LogField{Key: "error", Value: err},
+		)
+		idx.db.Generations().Invalidate(idx.config.RepoID)
+		return 0, false
+	}
+	return gen.Value, true
+}
+
+// finishBulkLoad rebuilds the indexes bulk deferred on tables (all remaining
+// when none is given). A failed rebuild is non-retryable for this run but not
+// lost: the index stays journaled and is restored at the next API start or
+// bulk load. errs may be nil.
+func (idx *Indexer) finishBulkLoad(ctx context.Context, bulk *models.BulkLoad, errs *ErrorAggregator, tables ...string) {
+	if bulk == nil {
+		return
+	}
+	if err := bulk.Finish(ctx, tables...); err != nil {
+		idx.logger.WarnWithFields("failed to rebuild deferred indexes",
+			LogField{Key: "tables", Value: tables},
+			LogField{Key: "error", Value: err},
+		)
+		if errs != nil {
+			errs.Add("bulk_load", NewDatabaseError(
+				"failed to rebuild deferred indexes",
+				idx.config.RepoID,
+				"",
+				err,
+				false,
+			))
+		}
+	}
+}
+
 // writeRepository writes repository metadata
 func (idx *Indexer) writeRepository(ctx context.Context) error {
 	// Generate repo ID if not provided
@@ -618,10 +776,11 @@ func (idx *Indexer) writeRepository(ctx context.Context) error {
 	}
 
 	repo := &models.Repository{
-		RepoID: idx.config.RepoID,
-		Name:   idx.config.RepoName,
-		URL:    idx.config.RepoURL,
-		Branch: idx.config.Branch,
+		RepoID:     idx.config.RepoID,
+		Name:       idx.config.RepoName,
+		URL:        idx.config.RepoURL,
+		Branch:     idx.config.Branch,
+		CommitHash: idx.config.CommitHash,
 	}
 
 	return idx.writer.WriteRepository(ctx, repo)
@@ -641,8 +800,15 @@ func (idx *Indexer) filterChangedFiles(ctx context.Context, files []schema.File)
 			continue
 		}
 
-		// Check if checksum changed
-		if existingFile.Checksum != file.Checksum {
+		// Check if checksum changed, or the file became / stopped being a
+		// copy of another path or an API-surface file (its AST nodes and
+		// vectors follow the role)
+		existingCanonical := ""
+		if existingFile.CanonicalFileID != nil {
+			existingCanonical = *existingFile.CanonicalFileID
+		}
+		if existingFile.Checksum != file.Checksum || existingCanonical != file.CanonicalFileID ||
+			existingFile.APIOnly != file.APIOnly {
 			changedFiles = append(changedFiles, file)
 		}
 	}
@@ -650,11 +816,16 @@ func (idx *Indexer) filterChangedFiles(ctx context.Context, files []schema.File)
 	return changedFiles
 }
 
-// writeData writes files, symbols, nodes, and edges to database with streaming and optimization
-func (idx *Indexer) writeData(ctx context.Context, files []schema.File, edges []schema.DependencyEdge) (*WriteResult, error) {
+// writeData writes files, symbols, nodes, and edges to database with streaming
+// and optimization. Failed batches are recorded in errs when it is set.
+func (idx *Indexer) writeData(ctx context.Context, files []schema.File, edges []schema.DependencyEdge, errs *ErrorAggregator) (*WriteResult, error) {
 	result := &WriteResult{}
+	writer := idx.writer.withErrors(errs)
 
 	if idx.config.UseTransactions {
+		if groups := idx.writeGroupCount(len(files)); groups > 1 {
+			return idx.writeDataStaged(ctx, files, edges, groups)
+		}
 		return idx.writeDataWithTransaction(ctx, files, edges)
 	}
 
@@ -669,7 +840,7 @@ func (idx *Indexer) writeData(ctx context.Context, files []schema.File, edges []
 	}()
 
 	// Write files with streaming
-	filesResult, err := idx.writer.WriteFiles(ctx, idx.config.RepoID, files)
+	filesResult, err := writer.WriteFiles(ctx, idx.config.RepoID, files)
 	if err != nil {
 		return result, err
 	}
@@ -686,7 +857,7 @@ func (idx *Indexer) writeData(ctx context.Context, files []schema.File, edges []
 
 	// Write symbols with adaptive batch sizing
 	batchSize := idx.batchOptimizer.GetBatchSize()
-	symbolsResult, err := idx.writeSymbolsOptimized(ctx, allSymbols, batchSize)
+	symbolsResult, err := idx.writeSymbolsOptimized(ctx, allSymbols, batchSize, errs)
 	if err != nil {
 		return result, err
 	}
@@ -702,7 +873,7 @@ func (idx *Indexer) writeData(ctx context.Context, files []schema.File, edges []
 	result.Errors = append(result.Errors, nodesResult.Errors...)
 
 	// Write edges
-	edgesResult, err := idx.writer.WriteEdges(ctx, edges)
+	edgesResult, err := writer.WriteEdges(ctx, edges)
 	if err != nil {
 		return result, err
 	}
@@ -730,6 +901,14 @@ func (idx *Indexer) writeData(ctx context.Context, files []schema.File, edges []
 func (idx *Indexer) writeDataWithTransaction(ctx context.Context, files []schema.File, edges []schema.DependencyEdge) (*WriteResult, error) {
 	result := &WriteResult{}
 
+	// 外部模块是所有仓库共享的表，在写事务开始前单独 intern
+	edgeRepo := models.NewEdgeRepository(idx.db)
+	modelEdges := toModelEdges(edges)
+	modules, err := edgeRepo.InternModules(ctx, modelEdges)
+	if err != nil {
+		return result, err
+	}
+
 	// Begin transaction
 	tx, err := idx.writer.BeginTx(ctx)
 	if err != nil {
@@ -743,19 +922,7 @@ func (idx *Indexer) writeDataWithTransaction(ctx context.Context, files []schema
 
 	// Convert and write files
 	fileRepo := models.NewFileRepository(idx.db)
-	modelFiles := make([]*models.File, 0, len(files))
-	for _, file := range files {
-		modelFile := &models.File{
-			FileID:   file.FileID,
-			RepoID:   idx.config.RepoID,
-			Path:     file.Path,
-			Language: file.Language,
-			Size:     file.Size,
-			Checksum: file.Checksum,
-		}
-		modelFiles = append(modelFiles, modelFile)
-	}
-	
+	modelFiles := toModelFiles(idx.config.RepoID, files)
 	if len(modelFiles) > 0 {
 		err = fileRepo.BatchCreateTx(ctx, tx, modelFiles)
 		if err != nil {
@@ -764,34 +931,9 @@ func (idx *Indexer) writeDataWithTransaction(ctx context.Context, files []schema
 		result.FilesProcessed = len(modelFiles)
 	}
 
-	// Collect all symbols and nodes
-	var allSymbols []schema.Symbol
-	var allNodes []schema.ASTNode
-	for _, file := range files {
-		allSymbols = append(allSymbols, file.Symbols...)
-		allNodes = append(allNodes, file.Nodes...)
-	}
-
 	// Convert and write symbols
 	symbolRepo := models.NewSymbolRepository(idx.db)
-	modelSymbols := make([]*models.Symbol, 0, len(allSymbols))
-	for _, symbol := range allSymbols {
-		modelSymbol := &models.Symbol{
-			SymbolID:        symbol.SymbolID,
-			FileID:          symbol.FileID,
-			Name:            symbol.Name,
-			Kind:            string(symbol.Kind),
-			Signature:       symbol.Signature,
-			StartLine:       symbol.Span.StartLine,
-			EndLine:         symbol.Span.EndLine,
-			StartByte:       symbol.Span.StartByte,
-			EndByte:         symbol.Span.EndByte,
-			Docstring:       symbol.Docstring,
-			SemanticSummary: symbol.SemanticSummary,
-		}
-		modelSymbols = append(modelSymbols, modelSymbol)
-	}
-	
+	modelSymbols := toModelSymbols(files)
 	if len(modelSymbols) > 0 {
 		err = symbolRepo.BatchCreateTx(ctx, tx, modelSymbols)
 		if err != nil {
@@ -802,28 +944,7 @@ func (idx *Indexer) writeDataWithTransaction(ctx context.Context, files []schema
 
 	// Convert and write AST nodes
 	astNodeRepo := models.NewASTNodeRepository(idx.db)
-	modelNodes := make([]*models.ASTNode, 0, len(allNodes))
-	for _, node := range allNodes {
-		var parentID *string
-		if node.ParentID != "" {
-			parentID = &node.ParentID
-		}
-
-		modelNode := &models.ASTNode{
-			NodeID:     node.NodeID,
-			FileID:     node.FileID,
-			Type:       node.Type,
-			ParentID:   parentID,
-			StartLine:  node.Span.StartLine,
-			EndLine:    node.Span.EndLine,
-			StartByte:  node.Span.StartByte,
-			EndByte:    node.Span.EndByte,
-			Text:       node.Text,
-			Attributes: node.Attributes,
-		}
-		modelNodes = append(modelNodes, modelNode)
-	}
-	
+	modelNodes := toModelNodes(files)
 	if len(modelNodes) > 0 {
 		err = astNodeRepo.BatchCreateTx(ctx, tx, modelNodes)
 		if err != nil {
@@ -832,39 +953,9 @@ func (idx *Indexer) writeDataWithTransaction(ctx context.Context, files []schema
 		result.NodesCreated = len(modelNodes)
 	}
 
-	// Convert and write edges
-	edgeRepo := models.NewEdgeRepository(idx.db)
-	modelEdges := make([]*models.Edge, 0, len(edges))
-	for _, edge := range edges {
-		var targetID *string
-		if edge.TargetID != "" {
-			targetID = &edge.TargetID
-		}
-
-		var targetFile *string
-		if edge.TargetFile != "" {
-			targetFile = &edge.TargetFile
-		}
-
-		var targetModule *string
-		if edge.TargetModule != "" {
-			targetModule = &edge.TargetModule
-		}
-
-		modelEdge := &models.Edge{
-			EdgeID:       edge.EdgeID,
-			SourceID:     edge.SourceID,
-			TargetID:     targetID,
-			EdgeType:     string(edge.EdgeType),
-			SourceFile:   edge.SourceFile,
-			TargetFile:   targetFile,
-			TargetModule: targetModule,
-		}
-		modelEdges = append(modelEdges, modelEdge)
-	}
-	
+	// Write edges
 	if len(modelEdges) > 0 {
-		err = edgeRepo.BatchCreateTx(ctx, tx, modelEdges)
+		err = edgeRepo.BatchCreateTx(ctx, tx, modelEdges, modules)
 		if err != nil {
 			return result, fmt.Errorf("failed to write edges: %w", err)
 		}
@@ -879,13 +970,18 @@ func (idx *Indexer) writeDataWithTransaction(ctx context.Context, files []schema
 	return result, nil
 }
 
-// generateEmbeddings generates vector embeddings for symbols
-func (idx *Indexer) generateEmbeddings(ctx context.Context, files []schema.File) *EmbedResult {
+// generateEmbeddings generates vector embeddings for symbols. Failures are
+// recorded in errs when it is set.
+func (idx *Indexer) generateEmbeddings(ctx context.Context, files []schema.File, errs *ErrorAggregator) *EmbedResult {
 	result := &EmbedResult{}
 
-	// Collect all symbols
+	// Collect all symbols; copies of another path's content share its vectors
+	// and API-surface files get none
 	var allSymbols []schema.Symbol
 	for _, file := range files {
+		if file.CanonicalFileID != "" || file.APIOnly {
+			continue
+		}
 		allSymbols = append(allSymbols, file.Symbols...)
 	}
 
@@ -895,25 +991,29 @@ func (idx *Indexer) generateEmbeddings(ctx context.Context, files []schema.File)
 
 	// Process symbols in parallel batches
 	if idx.config.WorkerCount > 1 {
-		return idx.generateEmbeddingsParallel(ctx, allSymbols)
+		return idx.generateEmbeddingsParallel(ctx, allSymbols, errs)
 	}
 
 	// Sequential processing
 	embedResult, err := idx.embedder.EmbedSymbols(ctx, allSymbols)
 	if err != nil {
-		result.Errors = append(result.Errors, EmbedError{
+		result.addError(errs, EmbedError{
 			Message: err.Error(),
 		})
 	} else {
 		result.VectorsCreated = embedResult.VectorsCreated
-		result.Errors = append(result.Errors, embedResult.Errors...)
+		result.CoarseVectorsCreated = embedResult.CoarseVectorsCreated
+		result.EmbeddingsReused = embedResult.EmbeddingsReused
+		for _, embedErr := range embedResult.Errors {
+			result.addError(errs, embedErr)
+		}
 	}
 
 	return result
 }
 
 // generateEmbeddingsParallel generates embeddings using parallel workers
-func (idx *Indexer) generateEmbeddingsParallel(ctx context.Context, symbols []schema.Symbol) *EmbedResult {
+func (idx *Indexer) generateEmbeddingsParallel(ctx context.Context, symbols []schema.Symbol, errs *ErrorAggregator) *EmbedResult {
 	result := &EmbedResult{}
 	var mu sync.Mutex
 	var wg sync.WaitGroup
@@ -922,15 +1022,16 @@ func (idx *Indexer) generateEmbeddingsParallel(ctx context.Context, symbols []sc
 	batchSize := (len(symbols) + idx.config.WorkerCount - 1) / idx.config.WorkerCount
 
 	// Process in parallel
-	for i := 0; i < idx.config.WorkerCount; i++ {
-		start := i * batchSize
-		if start >= len(symbols) {
-			break
-		}
+	for start := 0; start < len(symbols); {
 		end := start + batchSize
 		if end > len(symbols) {
 			end = len(symbols)
 		}
+		// 不把一个文件的符号拆给两个 worker：多粒度 embedding 的块级/文件级
+		// chunk 需要看到文件的全部符号
+		for end < len(symbols) && symbols[end].FileID != "" && symbols[end].FileID == symbols[end-1].FileID {
+			end++
+		}
 
 		wg.Add(1)
 		go func(batch []schema.Symbol) {
@@ -942,14 +1043,19 @@ func (idx *Indexer) generateEmbeddingsParallel(ctx context.Context, symbols []sc
 			defer mu.Unlock()
 
 			if err != nil {
-				result.Errors = append(result.Errors, EmbedError{
+				result.addError(errs, EmbedError{
 					Message: err.Error(),
 				})
 			} else {
 				result.VectorsCreated += embedResult.VectorsCreated
-				result.Errors = append(result.Errors, embedResult.Errors...)
+				result.CoarseVectorsCreated += embedResult.CoarseVectorsCreated
+				result.EmbeddingsReused += embedResult.EmbeddingsReused
+				for _, embedErr := range embedResult.Errors {
+					result.addError(errs, embedErr)
+				}
 			}
 		}(symbols[start:end])
+		start = end
 	}
 
 	wg.Wait()
@@ -966,25 +1072,9 @@ type IndexProgress struct {
 	Error          bool    `json:"error,omitempty"`
 }
 
-// convertErrors converts internal errors to IndexerError format
-func convertErrors(errors []error) []*IndexerError {
-	var result []*IndexerError
-	for _, err := range errors {
-		if indexerErr, ok := err.(*IndexerError); ok {
-			result = append(result, indexerErr)
-		} else {
-			result = append(result, &IndexerError{
-				Type:      "unknown",
-				Message:   err.Error(),
-				Retryable: false,
-			})
-		}
-	}
-	return result
-}
-
-// writeSymbolsOptimized writes symbols with adaptive batch sizing
-func (idx *Indexer) writeSymbolsOptimized(ctx context.Context, symbols []schema.Symbol, batchSize int) (*WriteResult, error) {
+// writeSymbolsOptimized writes symbols with adaptive batch sizing. Failed
+// batches are recorded in errs when it is set.
+func (idx *Indexer) writeSymbolsOptimized(ctx context.Context, symbols []schema.Symbol, batchSize int, errs *ErrorAggregator) (*WriteResult, error) {
 	result := &WriteResult{}
 
 	if len(symbols) == 0 {
@@ -1018,6 +1108,9 @@ func (idx *Indexer) writeSymbolsOptimized(ctx context.Context, symbols []schema.
 		if err := ctx.Err(); err != nil {
 			return result, fmt.Errorf("write symbols cancelled before batch %d: %w", i/batchSize, err)
 		}
+		if errs.Exceeded() {
+			return result, ErrErrorBudgetExceeded
+		}
 		end := i + batchSize
 		if end > len(modelSymbols) {
 			end = len(modelSymbols)
@@ -1033,11 +1126,12 @@ func (idx *Indexer) writeSymbolsOptimized(ctx context.Context, symbols []schema.
 		idx.batchOptimizer.RecordLatency(latency)
 
 		if err != nil {
-			result.Errors = append(result.Errors, WriteError{
+			result.addError(errs, WriteError{
 				EntityType: "symbols_batch",
 				EntityID:   fmt.Sprintf("batch_%d", i/batchSize),
 				Message:    err.Error(),
 				Retryable:  false,
+				Code:       errorCode(err),
 			})
 		} else {
 			result.SymbolsCreated += len(batch)
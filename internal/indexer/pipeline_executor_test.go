@@ -2,6 +2,7 @@ package indexer
 
 import (
 	"context"
+	"errors"
 	"fmt"
 	"sync"
 	"testing"
@@ -24,6 +25,9 @@ type fakeExecutor struct {
 	writeDataResult *WriteResult
 	writeDataErr    error
 	embedResult     *EmbedResult
+
+	// writeDataHook 模拟在发生处记录错误的写入阶段，返回值作为 writeData 的错误
+	writeDataHook func(ctx context.Context, errs *ErrorAggregator) error
 }
 
 func (f *fakeExecutor) writeRepository(ctx context.Context) error {
@@ -33,17 +37,20 @@ func (f *fakeExecutor) writeRepository(ctx context.Context) error {
 	return f.writeRepoErr
 }
 
-func (f *fakeExecutor) writeData(ctx context.Context, files []schema.File, edges []schema.DependencyEdge) (*WriteResult, error) {
+func (f *fakeExecutor) writeData(ctx context.Context, files []schema.File, edges []schema.DependencyEdge, errs *ErrorAggregator) (*WriteResult, error) {
 	f.mu.Lock()
 	defer f.mu.Unlock()
 	f.writeDataCalls++
+	if f.writeDataHook != nil {
+		return &WriteResult{}, f.writeDataHook(ctx, errs)
+	}
 	if f.writeDataResult == nil {
 		return &WriteResult{}, f.writeDataErr
 	}
 	return f.writeDataResult, f.writeDataErr
 }
 
-func (f *fakeExecutor) generateEmbeddings(ctx context.Context, files []schema.File) *EmbedResult {
+func (f *fakeExecutor) generateEmbeddings(ctx context.Context, files []schema.File, errs *ErrorAggregator) *EmbedResult {
 	f.mu.Lock()
 	defer f.mu.Unlock()
 	f.generateEmbeddingsCalls++
@@ -223,3 +230,90 @@ func TestIndex_WriteDataFailureDoesNotReportPartialCounts(t *testing.T) {
 	}
 }
 
+
+// TestIndex_StopsWhenErrorBudgetExceeded 验证错误数超出预算时提前结束，
+// 且结果只携带每个分桶的少量样例而非全部错误。
+func TestIndex_StopsWhenErrorBudgetExceeded(t *testing.T) {
+	idx, fake := newIndexerWithFake(t)
+	idx.config.ErrorBudget = 10
+	idx.config.ErrorExemplars = 2
+
+	writeResult := &WriteResult{}
+	for i := 0; i < 100; i++ {
+		writeResult.Errors = append(writeResult.Errors, WriteError{
+			EntityType: "symbol",
+			EntityID:   fmt.Sprintf("sym-%d", i),
+			Message:    "insert failed",
+		})
+	}
+	fake.writeDataResult = writeResult
+
+	input := &schema.ParseOutput{
+		Metadata: schema.ParseMetadata{Version: "test-1.0"},
+		Files: []schema.File{
+			{FileID: uuid.New().String(), Path: "main.go", Checksum: "abc123", Language: "go"},
+		},
+	}
+
+	result, err := idx.Index(context.Background(), input)
+	if !errors.Is(err, ErrErrorBudgetExceeded) {
+		t.Fatalf("expected ErrErrorBudgetExceeded, got %v", err)
+	}
+	if result.Status != "failed" {
+		t.Errorf("expected status failed, got %s", result.Status)
+	}
+	if result.Summary["total_errors"] != 100 {
+		t.Errorf("expected all 100 errors counted, got %v", result.Summary["total_errors"])
+	}
+	if len(result.Errors) != 2 {
+		t.Errorf("expected 2 exemplars, got %d", len(result.Errors))
+	}
+}
+
+// TestIndex_ErrorBudgetCancelsRun 验证错误在发生处记入聚合器：超出预算时
+// 写入阶段的 ctx 立即被取消，而不是等阶段返回后才检查。
+func TestIndex_ErrorBudgetCancelsRun(t *testing.T) {
+	idx, fake := newIndexerWithFake(t)
+	idx.config.ErrorBudget = 3
+
+	recorded := 0
+	fake.writeDataHook = func(ctx context.Context, errs *ErrorAggregator) error {
+		for i := 0; i < 100 && ctx.Err() == nil; i++ {
+			var result WriteResult
+			result.addError(errs, WriteError{
+				EntityType: "symbols_batch",
+				EntityID:   fmt.Sprintf("batch_%d", i),
+				Message:    "duplicate key",
+				Code:       "23505",
+			})
+			recorded++
+		}
+		if !errors.Is(context.Cause(ctx), ErrErrorBudgetExceeded) {
+			t.Errorf("expected the write context to be cancelled by the budget, got %v", context.Cause(ctx))
+		}
+		return ctx.Err()
+	}
+
+	input := &schema.ParseOutput{
+		Metadata: schema.ParseMetadata{Version: "test-1.0"},
+		Files: []schema.File{
+			{FileID: uuid.New().String(), Path: "main.go", Checksum: "abc123", Language: "go"},
+		},
+	}
+
+	result, err := idx.Index(context.Background(), input)
+	if !errors.Is(err, ErrErrorBudgetExceeded) {
+		t.Fatalf("expected ErrErrorBudgetExceeded, got %v", err)
+	}
+	if recorded != 4 {
+		t.Errorf("expected writing to stop right after the budget was exceeded, recorded %d", recorded)
+	}
+	// 中止本身不再计为一次写入失败
+	if result.Summary["total_errors"] != 4 {
+		t.Errorf("expected 4 errors, got %v", result.Summary["total_errors"])
+	}
+	buckets := result.Summary["error_buckets"].([]ErrorBucket)
+	if len(buckets) != 1 || buckets[0].Code != "23505" {
+		t.Errorf("expected one bucket keyed by SQLSTATE, got %+v", buckets)
+	}
+}
@@ -0,0 +1,242 @@
+package indexer
+
+import (
+	"context"
+	"fmt"
+	"sort"
+	"sync"
+
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+// minFilesPerWriteGroup keeps small repositories on the single-transaction
+// path, where creating staging tables would cost more than it saves
+const minFilesPerWriteGroup = 50
+
+// writeGroupCount returns how many concurrent file groups a write of n files
+// uses; <= 1 means a single transaction
+func (idx *Indexer) writeGroupCount(n int) int {
+	groups := idx.config.WriteParallelism
+	if limit := n / minFilesPerWriteGroup; groups > limit {
+		groups = limit
+	}
+	return groups
+}
+
+// partitionFiles splits files into groups of roughly equal row counts
+// (symbols + nodes), assigning the heaviest files first. Deterministic for a
+// given input.
+func partitionFiles(files []schema.File, groups int) [][]schema.File {
+	if groups < 1 {
+		groups = 1
+	}
+	order := make([]int, len(files))
+	for i := range order {
+		order[i] = i
+	}
+	weight := func(f *schema.File) int {
+		return 1 + len(f.Symbols) + len(f.Nodes)
+	}
+	sort.SliceStable(order, func(a, b int) bool {
+		return weight(&files[order[a]]) > weight(&files[order[b]])
+	})
+
+	out := make([][]schema.File, groups)
+	load := make([]int, groups)
+	for _, i := range order {
+		lightest := 0
+		for g := 1; g < groups; g++ {
+			if load[g] < load[lightest] {
+				lightest = g
+			}
+		}
+		out[lightest] = append(out[lightest], files[i])
+		load[lightest] += weight(&files[i])
+	}
+	return out
+}
+
+// partitionEdges assigns each edge to the group holding its source file;
+// edges whose source file is not part of this write go to the first group
+func partitionEdges(groups [][]schema.File, edges []schema.DependencyEdge) [][]schema.DependencyEdge {
+	groupOf := make(map[string]int)
+	for g, files := range groups {
+		for _, file := range files {
+			groupOf[file.Path] = g
+		}
+	}
+	out := make([][]schema.DependencyEdge, len(groups))
+	for _, edge := range edges {
+		g := groupOf[edge.SourceFile]
+		out[g] = append(out[g], edge)
+	}
+	return out
+}
+
+// writeDataStaged writes files and edges partitioned into groups, each loaded
+// into staging tables by its own transaction on its own connection, then
+// publishes them in one transaction. Readers see either the previous
+// repository state or the complete new one, as with
+// writeDataWithTransaction, but the load uses several backends and the live
+// tables are only locked for the final server-side copy.
+func (idx *Indexer) writeDataStaged(ctx context.Context, files []schema.File, edges []schema.DependencyEdge, groups int) (*WriteResult, error) {
+	result := &WriteResult{}
+
+	staged, err := models.BeginStagedWrite(ctx, idx.db)
+	if err != nil {
+		return result, err
+	}
+	// 发布或失败后都要删除暂存表；取消的请求也要清理
+	defer staged.Discard(context.WithoutCancel(ctx))
+
+	fileGroups := partitionFiles(files, groups)
+	edgeGroups := partitionEdges(fileGroups, edges)
+
+	var (
+		wg       sync.WaitGroup
+		mu       sync.Mutex
+		firstErr error
+	)
+	groupCtx, cancel := context.WithCancel(ctx)
+	defer cancel()
+	for g := range fileGroups {
+		group := models.StagedGroup{
+			Files:   toModelFiles(idx.config.RepoID, fileGroups[g]),
+			Symbols: toModelSymbols(fileGroups[g]),
+			Nodes:   toModelNodes(fileGroups[g]),
+			Edges:   toModelEdges(edgeGroups[g]),
+		}
+		result.FilesProcessed += len(group.Files)
+		result.SymbolsCreated += len(group.Symbols)
+		result.NodesCreated += len(group.Nodes)
+		result.EdgesCreated += len(group.Edges)
+
+		wg.Add(1)
+		go func(g int) {
+			defer wg.Done()
+			if err := staged.WriteGroup(groupCtx, group); err != nil {
+				mu.Lock()
+				if firstErr == nil {
+					firstErr = fmt.Errorf("failed to write file group %d: %w", g, err)
+					// 一组失败则整体不发布，其余组无需继续
+					cancel()
+				}
+				mu.Unlock()
+			}
+		}(g)
+	}
+	wg.Wait()
+	if firstErr != nil {
+		return result, firstErr
+	}
+
+	if err := staged.Publish(ctx); err != nil {
+		return result, err
+	}
+
+	idx.logger.InfoWithFields("staged write published",
+		LogField{Key: "groups", Value: len(fileGroups)},
+		LogField{Key: "files", Value: result.FilesProcessed},
+		LogField{Key: "symbols", Value: result.SymbolsCreated},
+		LogField{Key: "nodes", Value: result.NodesCreated},
+		LogField{Key: "edges", Value: result.EdgesCreated},
+	)
+	return result, nil
+}
+
+// toModelFiles converts parsed files to file rows of repoID
+func toModelFiles(repoID string, files []schema.File) []*models.File {
+	modelFiles := make([]*models.File, 0, len(files))
+	for _, file := range files {
+		modelFile := &models.File{
+			FileID:   file.FileID,
+			RepoID:   repoID,
+			Path:     file.Path,
+			Language: file.Language,
+			Size:     file.Size,
+			Checksum: file.Checksum,
+			APIOnly:  file.APIOnly,
+		}
+		if file.CanonicalFileID != "" {
+			canonical := file.CanonicalFileID
+			modelFile.CanonicalFileID = &canonical
+		}
+		modelFiles = append(modelFiles, modelFile)
+	}
+	return modelFiles
+}
+
+// toModelSymbols converts the symbols of files to symbol rows
+func toModelSymbols(files []schema.File) []*models.Symbol {
+	var modelSymbols []*models.Symbol
+	for _, file := range files {
+		for _, symbol := range file.Symbols {
+			modelSymbols = append(modelSymbols, &models.Symbol{
+				SymbolID:        symbol.SymbolID,
+				FileID:          symbol.FileID,
+				Name:            symbol.Name,
+				Kind:            string(symbol.Kind),
+				Signature:       symbol.Signature,
+				StartLine:       symbol.Span.StartLine,
+				EndLine:         symbol.Span.EndLine,
+				StartByte:       symbol.Span.StartByte,
+				EndByte:         symbol.Span.EndByte,
+				Docstring:       symbol.Docstring,
+				SemanticSummary: symbol.SemanticSummary,
+			})
+		}
+	}
+	return modelSymbols
+}
+
+// toModelNodes converts the AST nodes of files to node rows
+func toModelNodes(files []schema.File) []*models.ASTNode {
+	var modelNodes []*models.ASTNode
+	for _, file := range files {
+		for _, node := range file.Nodes {
+			var parentID *string
+			if node.ParentID != "" {
+				parentID = &node.ParentID
+			}
+			modelNodes = append(modelNodes, &models.ASTNode{
+				NodeID:     node.NodeID,
+				FileID:     node.FileID,
+				Type:       node.Type,
+				ParentID:   parentID,
+				StartLine:  node.Span.StartLine,
+				EndLine:    node.Span.EndLine,
+				StartByte:  node.Span.StartByte,
+				EndByte:    node.Span.EndByte,
+				Text:       node.Text,
+				Attributes: node.Attributes,
+			})
+		}
+	}
+	return modelNodes
+}
+
+// toModelEdges converts dependency edges to edge rows; empty optional fields
+// become NULL
+func toModelEdges(edges []schema.DependencyEdge) []*models.Edge {
+	optional := func(s string) *string {
+		if s == "" {
+			return nil
+		}
+		return &s
+	}
+	modelEdges := make([]*models.Edge, 0, len(edges))
+	for _, edge := range edges {
+		modelEdges = append(modelEdges, &models.Edge{
+			EdgeID:       edge.EdgeID,
+			SourceID:     edge.SourceID,
+			TargetID:     optional(edge.TargetID),
+			EdgeType:     string(edge.EdgeType),
+			SourceFile:   edge.SourceFile,
+			TargetFile:   optional(edge.TargetFile),
+			TargetModule: optional(edge.TargetModule),
+			TargetName:   optional(edge.TargetName),
+		})
+	}
+	return modelEdges
+}
@@ -0,0 +1,109 @@
+package indexer
+
+import (
+	"fmt"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+)
+
+func TestPartitionFiles_BalancesRowCounts(t *testing.T) {
+	var files []schema.File
+	for i := 0; i < 40; i++ {
+		file := schema.File{FileID: fmt.Sprintf("f%d", i), Path: fmt.Sprintf("src/f%d.go", i)}
+		// 少数大文件加大量小文件
+		n := 2
+		if i%10 == 0 {
+			n = 200
+		}
+		file.Symbols = make([]schema.Symbol, n)
+		files = append(files, file)
+	}
+
+	groups := partitionFiles(files, 4)
+	assert.Len(t, groups, 4)
+
+	seen := make(map[string]bool)
+	minLoad, maxLoad := -1, 0
+	for _, group := range groups {
+		load := 0
+		for _, file := range group {
+			assert.False(t, seen[file.FileID], "file %s assigned twice", file.FileID)
+			seen[file.FileID] = true
+			load += 1 + len(file.Symbols)
+		}
+		if minLoad < 0 || load < minLoad {
+			minLoad = load
+		}
+		if load > maxLoad {
+			maxLoad = load
+		}
+	}
+	assert.Len(t, seen, len(files))
+	assert.LessOrEqual(t, maxLoad-minLoad, 201, "groups should differ by at most one large file")
+
+	assert.Equal(t, groups, partitionFiles(files, 4), "partitioning must be deterministic")
+}
+
+func TestPartitionEdges_FollowSourceFile(t *testing.T) {
+	groups := [][]schema.File{
+		{{Path: "a.go"}},
+		{{Path: "b.go"}, {Path: "c.go"}},
+	}
+	edges := []schema.DependencyEdge{
+		{EdgeID: "1", SourceFile: "c.go"},
+		{EdgeID: "2", SourceFile: "a.go"},
+		{EdgeID: "3", SourceFile: "elsewhere.go"},
+	}
+
+	out := partitionEdges(groups, edges)
+	assert.Len(t, out, 2)
+	assert.Equal(t, []schema.DependencyEdge{edges[1], edges[2]}, out[0])
+	assert.Equal(t, []schema.DependencyEdge{edges[0]}, out[1])
+}
+
+func TestWriteGroupCount(t *testing.T) {
+	idx := &Indexer{config: &IndexerConfig{WriteParallelism: 4}}
+	assert.Equal(t, 1, idx.writeGroupCount(99), "small writes stay in one transaction")
+	assert.Equal(t, 2, idx.writeGroupCount(100))
+	assert.Equal(t, 4, idx.writeGroupCount(10000))
+
+	idx.config.WriteParallelism = 0
+	assert.Equal(t, 0, idx.writeGroupCount(10000))
+}
+
+func TestToModelEdges_EmptyFieldsAreNull(t *testing.T) {
+	edges := toModelEdges([]schema.DependencyEdge{
+		{EdgeID: "e1", SourceID: "s1", EdgeType: schema.EdgeImport, SourceFile: "a.go", TargetModule: "fmt"},
+	})
+	assert.Len(t, edges, 1)
+	assert.Nil(t, edges[0].TargetID)
+	assert.Nil(t, edges[0].TargetFile)
+	assert.Nil(t, edges[0].TargetName)
+	if assert.NotNil(t, edges[0].TargetModule) {
+		assert.Equal(t, "fmt", *edges[0].TargetModule)
+	}
+}
+
+func TestToModelFiles_CanonicalFileID(t *testing.T) {
+	files := toModelFiles("repo", []schema.File{
+		{FileID: "f1", Path: "android/x/util.h"},
+		{FileID: "f2", Path: "ios/x/util.h", CanonicalFileID: "f1"},
+	})
+	assert.Len(t, files, 2)
+	assert.Nil(t, files[0].CanonicalFileID)
+	if assert.NotNil(t, files[1].CanonicalFileID) {
+		assert.Equal(t, "f1", *files[1].CanonicalFileID)
+	}
+}
+
+func TestToModelFiles_APIOnly(t *testing.T) {
+	files := toModelFiles("repo", []schema.File{
+		{FileID: "f1", Path: "src/main.cc"},
+		{FileID: "f2", Path: "third_party/x/util.h", APIOnly: true},
+	})
+	assert.Len(t, files, 2)
+	assert.False(t, files[0].APIOnly)
+	assert.True(t, files[1].APIOnly)
+}
@@ -61,22 +61,33 @@ func (e *ValidationError) Error() string {
 type ValidationResult struct {
 	Valid  bool               `json:"valid"`
 	Errors []*ValidationError `json:"errors,omitempty"`
+
+	// errs receives errors instead of Errors (see ValidateWith)
+	errs    *ErrorAggregator
+	counted int
 }
 
 // AddError adds a validation error to the result
 func (r *ValidationResult) AddError(err *ValidationError) {
 	r.Valid = false
-	r.Errors = append(r.Errors, err)
+	if r.errs == nil {
+		r.Errors = append(r.Errors, err)
+		return
+	}
+	r.counted++
+	r.errs.Record("validation", ErrorTypeValidation, string(err.Type), false, func() *IndexerError {
+		return NewValidationError(err.Message, err.EntityID, err.FilePath, nil)
+	})
 }
 
 // HasErrors returns true if there are validation errors
 func (r *ValidationResult) HasErrors() bool {
-	return len(r.Errors) > 0
+	return r.ErrorCount() > 0
 }
 
 // ErrorCount returns the number of validation errors
 func (r *ValidationResult) ErrorCount() int {
-	return len(r.Errors)
+	return len(r.Errors) + r.counted
 }
 
 // Validator interface for validating parsed output
@@ -84,6 +95,10 @@ type Validator interface {
 	// Validate checks the parsed output against schema constraints
 	Validate(output *schema.ParseOutput) *ValidationResult
 
+	// ValidateWith is Validate recording each error in errs as it is found
+	// instead of collecting them in the result (errs may be nil)
+	ValidateWith(output *schema.ParseOutput, errs *ErrorAggregator) *ValidationResult
+
 	// ValidateFile validates a single file entity
 	ValidateFile(file *schema.File) *ValidationResult
 
@@ -118,7 +133,14 @@ func NewSchemaValidator() *SchemaValidator {
 
 // Validate validates the entire ParseOutput structure
 func (v *SchemaValidator) Validate(output *schema.ParseOutput) *ValidationResult {
-	result := &ValidationResult{Valid: true}
+	return v.ValidateWith(output, nil)
+}
+
+// ValidateWith validates the entire ParseOutput structure. With errs set the
+// result only counts errors, so a broken input of millions of entities is
+// reported through errs' bounded buckets.
+func (v *SchemaValidator) ValidateWith(output *schema.ParseOutput, errs *ErrorAggregator) *ValidationResult {
+	result := &ValidationResult{Valid: true, errs: errs}
 
 	if output == nil {
 		result.AddError(&ValidationError{
@@ -139,19 +161,15 @@ func (v *SchemaValidator) Validate(output *schema.ParseOutput) *ValidationResult
 
 	// Validate files and collect IDs
 	for _, file := range output.Files {
-		fileResult := v.ValidateFile(&file)
-		result.Errors = append(result.Errors, fileResult.Errors...)
-		if fileResult.HasErrors() {
-			result.Valid = false
+		for _, err := range v.ValidateFile(&file).Errors {
+			result.AddError(err)
 		}
 	}
 
 	// Validate relationships and check referential integrity
 	for _, edge := range output.Relationships {
-		edgeResult := v.ValidateEdge(&edge)
-		result.Errors = append(result.Errors, edgeResult.Errors...)
-		if edgeResult.HasErrors() {
-			result.Valid = false
+		for _, err := range v.ValidateEdge(&edge).Errors {
+			result.AddError(err)
 		}
 	}
 
@@ -23,6 +23,9 @@ type Writer struct {
 	baseRetryDelay time.Duration
 	maxRetryDelay  time.Duration
 	batchSize      int
+
+	// errs receives failed batches instead of WriteResult.Errors (see withErrors)
+	errs *ErrorAggregator
 }
 
 // WriterConfig contains configuration options for the Writer
@@ -79,6 +82,27 @@ type WriteError struct {
 	EntityID   string `json:"entity_id"`
 	Message    string `json:"message"`
 	Retryable  bool   `json:"retryable"`
+	Code       string `json:"code,omitempty"` // SQLSTATE of the cause, see errorCode
+}
+
+// addError records a failed write in errs, or appends it to the result when
+// the caller does not aggregate errors (errs == nil)
+func (r *WriteResult) addError(errs *ErrorAggregator, writeErr WriteError) {
+	if errs == nil {
+		r.Errors = append(r.Errors, writeErr)
+		return
+	}
+	errs.Record("write", ErrorTypeDatabase, writeErr.Code, writeErr.Retryable, func() *IndexerError {
+		return NewDatabaseError(writeErr.EntityType+": "+writeErr.Message, writeErr.EntityID, "", nil, writeErr.Retryable)
+	})
+}
+
+// withErrors returns a copy of w that records failed batches in errs as they
+// happen and stops with ErrErrorBudgetExceeded once errs is over budget
+func (w *Writer) withErrors(errs *ErrorAggregator) *Writer {
+	c := *w
+	c.errs = errs
+	return &c
 }
 
 // WriteRepository creates or updates a repository record
@@ -98,21 +122,13 @@ func (w *Writer) WriteFiles(ctx context.Context, repoID string, files []schema.F
 	}
 
 	// Convert schema files to model files
-	modelFiles := make([]*models.File, 0, len(files))
-	for _, file := range files {
-		modelFile := &models.File{
-			FileID:   file.FileID,
-			RepoID:   repoID,
-			Path:     file.Path,
-			Language: file.Language,
-			Size:     file.Size,
-			Checksum: file.Checksum,
-		}
-		modelFiles = append(modelFiles, modelFile)
-	}
+	modelFiles := toModelFiles(repoID, files)
 
 	// Process files in batches
 	for i := 0; i < len(modelFiles); i += w.batchSize {
+		if w.errs.Exceeded() {
+			return result, ErrErrorBudgetExceeded
+		}
 		end := i + w.batchSize
 		if end > len(modelFiles) {
 			end = len(modelFiles)
@@ -124,11 +140,12 @@ func (w *Writer) WriteFiles(ctx context.Context, repoID string, files []schema.F
 		})
 
 		if err != nil {
-			result.Errors = append(result.Errors, WriteError{
+			result.addError(w.errs, WriteError{
 				EntityType: "files_batch",
 				EntityID:   fmt.Sprintf("batch_%d", i/w.batchSize),
 				Message:    err.Error(),
 				Retryable:  w.isRetryableError(err),
+				Code:       errorCode(err),
 			})
 		} else {
 			result.FilesProcessed += len(batch)
@@ -169,6 +186,9 @@ func (w *Writer) WriteSymbols(ctx context.Context, symbols []schema.Symbol) (*Wr
 
 	// Process symbols in batches
 	for i := 0; i < len(modelSymbols); i += w.batchSize {
+		if w.errs.Exceeded() {
+			return result, ErrErrorBudgetExceeded
+		}
 		end := i + w.batchSize
 		if end > len(modelSymbols) {
 			end = len(modelSymbols)
@@ -180,11 +200,12 @@ func (w *Writer) WriteSymbols(ctx context.Context, symbols []schema.Symbol) (*Wr
 		})
 
 		if err != nil {
-			result.Errors = append(result.Errors, WriteError{
+			result.addError(w.errs, WriteError{
 				EntityType: "symbols_batch",
 				EntityID:   fmt.Sprintf("batch_%d", i/w.batchSize),
 				Message:    err.Error(),
 				Retryable:  w.isRetryableError(err),
+				Code:       errorCode(err),
 			})
 		} else {
 			result.SymbolsCreated += len(batch)
@@ -233,6 +254,9 @@ func (w *Writer) WriteASTNodes(ctx context.Context, nodes []schema.ASTNode) (*Wr
 
 	// Process nodes in batches
 	for i := 0; i < len(sortedNodes); i += w.batchSize {
+		if w.errs.Exceeded() {
+			return result, ErrErrorBudgetExceeded
+		}
 		end := i + w.batchSize
 		if end > len(sortedNodes) {
 			end = len(sortedNodes)
@@ -244,11 +268,12 @@ func (w *Writer) WriteASTNodes(ctx context.Context, nodes []schema.ASTNode) (*Wr
 		})
 
 		if err != nil {
-			result.Errors = append(result.Errors, WriteError{
+			result.addError(w.errs, WriteError{
 				EntityType: "ast_nodes_batch",
 				EntityID:   fmt.Sprintf("batch_%d", i/w.batchSize),
 				Message:    err.Error(),
 				Retryable:  w.isRetryableError(err),
+				Code:       errorCode(err),
 			})
 		} else {
 			result.NodesCreated += len(batch)
@@ -286,6 +311,11 @@ func (w *Writer) WriteEdges(ctx context.Context, edges []schema.DependencyEdge)
 			targetModule = &edge.TargetModule
 		}
 
+		var targetName *string
+		if edge.TargetName != "" {
+			targetName = &edge.TargetName
+		}
+
 		modelEdge := &models.Edge{
 			EdgeID:       edge.EdgeID,
 			SourceID:     edge.SourceID,
@@ -294,12 +324,16 @@ func (w *Writer) WriteEdges(ctx context.Context, edges []schema.DependencyEdge)
 			SourceFile:   edge.SourceFile,
 			TargetFile:   targetFile,
 			TargetModule: targetModule,
+			TargetName:   targetName,
 		}
 		modelEdges = append(modelEdges, modelEdge)
 	}
 
 	// Process edges in batches
 	for i := 0; i < len(modelEdges); i += w.batchSize {
+		if w.errs.Exceeded() {
+			return result, ErrErrorBudgetExceeded
+		}
 		end := i + w.batchSize
 		if end > len(modelEdges) {
 			end = len(modelEdges)
@@ -312,11 +346,12 @@ func (w *Writer) WriteEdges(ctx context.Context, edges []schema.DependencyEdge)
 		})
 
 		if err != nil {
-			result.Errors = append(result.Errors, WriteError{
+			result.addError(w.errs, WriteError{
 				EntityType: "edges_batch",
 				EntityID:   fmt.Sprintf("batch_%d", i/w.batchSize),
 				Message:    err.Error(),
 				Retryable:  w.isRetryableError(err),
+				Code:       errorCode(err),
 			})
 		} else {
 			result.EdgesCreated += len(batch)
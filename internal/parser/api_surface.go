@@ -0,0 +1,71 @@
+package parser
+
+// APISurfaceFilter selects the files indexed for their API surface only:
+// third-party and vendored code whose declarations are needed to resolve our
+// own calls into it, but whose bodies, call edges, AST and embeddings are not.
+// Patterns use the same gitignore syntax as IgnoreFilter, so a later
+// "!third_party/ours/" takes part of an auto-detected layout back into full
+// indexing.
+type APISurfaceFilter struct {
+	rules *IgnoreFilter
+}
+
+// defaultAPISurfacePatterns returns the vendor layouts detected automatically.
+// They match at any depth, so only names that always mean third-party code
+// are listed: generic ones such as external/, extern/ or deps/ often hold
+// first-party code and must be opted in, preferably anchored ("/external/").
+// vendor/ and node_modules/ are ignored by default and only match when ignore
+// rules are disabled or negated.
+func defaultAPISurfacePatterns() []string {
+	return []string{
+		"third_party/",
+		"third-party/",
+		"thirdparty/",
+		"3rdparty/",
+		"Pods/",
+		"Carthage/",
+		"bower_components/",
+		"vendor/",
+		"node_modules/",
+	}
+}
+
+// NewAPISurfaceFilter creates an APISurfaceFilter from the default vendor
+// layouts (when autoDetect is set) followed by custom patterns
+func NewAPISurfaceFilter(patterns []string, autoDetect bool) *APISurfaceFilter {
+	rules := &IgnoreFilter{rules: make([]IgnoreRule, 0)}
+	if autoDetect {
+		for _, pattern := range defaultAPISurfacePatterns() {
+			rules.addPattern(pattern)
+		}
+	}
+	for _, pattern := range patterns {
+		rules.addPattern(pattern)
+	}
+	return &APISurfaceFilter{rules: rules}
+}
+
+// Matches reports whether a file (relative path) belongs to the API-surface tier
+func (f *APISurfaceFilter) Matches(path string) bool {
+	if f == nil || len(f.rules.rules) == 0 {
+		return false
+	}
+	return f.rules.ShouldIgnore(path, false)
+}
+
+// reduceToAPISurface strips a parsed file of everything but its declarations:
+// call edges are dropped (the parsers already skip their call pass where it
+// extracts nothing else) and the Tree-sitter tree is released so no AST nodes
+// are mapped. Imports and inheritance are kept for edge resolution.
+func reduceToAPISurface(parsed *ParsedFile) {
+	parsed.APIOnly = true
+	parsed.RootNode = nil
+	parsed.flat = nil
+	deps := parsed.Dependencies[:0]
+	for _, dep := range parsed.Dependencies {
+		if dep.Type != "call" {
+			deps = append(deps, dep)
+		}
+	}
+	parsed.Dependencies = deps
+}
@@ -0,0 +1,106 @@
+package parser
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+func TestAPISurfaceFilter_Matches(t *testing.T) {
+	filter := NewAPISurfaceFilter([]string{"libs/", "/external/", "!external/keep/"}, true)
+
+	tests := []struct {
+		path string
+		want bool
+	}{
+		{"third_party/zlib/zlib.h", true},
+		{"src/third_party/x/util.c", true},
+		{"ios/Pods/AFNetworking/AFURLSessionManager.m", true},
+		{"libs/json/json.hpp", true},
+		{"external/boost/asio.hpp", true},
+		{"external/keep/ours.cc", false},
+		{"src/external/ours.cc", false}, // 锚定到仓库根目录
+		{"src/main.cc", false},
+		{"src/deps.go", false},
+	}
+	for _, tt := range tests {
+		if got := filter.Matches(tt.path); got != tt.want {
+			t.Errorf("Matches(%q) = %v, want %v", tt.path, got, tt.want)
+		}
+	}
+
+	// 含义不明确的目录名默认按第一方代码完整解析
+	defaults := NewAPISurfaceFilter(nil, true)
+	for _, path := range []string{"external/boost/asio.hpp", "src/extern/api.h", "deps/lib.go"} {
+		if defaults.Matches(path) {
+			t.Errorf("%s should not be API-surface-only by default", path)
+		}
+	}
+
+	if NewAPISurfaceFilter(nil, false).Matches("third_party/zlib/zlib.h") {
+		t.Error("Vendor layouts should not match with auto-detection disabled")
+	}
+	var none *APISurfaceFilter
+	if none.Matches("third_party/zlib/zlib.h") {
+		t.Error("A nil filter should match nothing")
+	}
+}
+
+func TestFileScanner_MarksAPISurface(t *testing.T) {
+	tempDir := t.TempDir()
+	for _, rel := range []string{"src/main.c", "third_party/x/util.c", "third_party/y/util.c"} {
+		path := filepath.Join(tempDir, rel)
+		if err := os.MkdirAll(filepath.Dir(path), 0755); err != nil {
+			t.Fatal(err)
+		}
+		if err := os.WriteFile(path, []byte("int f(void);\n"), 0644); err != nil {
+			t.Fatal(err)
+		}
+	}
+
+	scanner := NewFileScanner(tempDir, nil)
+	scanner.SetAPISurfaceFilter(NewAPISurfaceFilter(nil, true))
+	files, err := scanner.Scan()
+	if err != nil {
+		t.Fatalf("Scan failed: %v", err)
+	}
+	if len(files) != 3 {
+		t.Fatalf("Expected 3 files, got %d", len(files))
+	}
+	for _, f := range files {
+		want := filepath.Dir(f.Path) != "src"
+		if f.APIOnly != want {
+			t.Errorf("%s: APIOnly = %v, want %v", f.Path, f.APIOnly, want)
+		}
+	}
+
+	// 同内容的第一方文件与第三方文件解析方式不同，不能合并
+	unique, copies := GroupByContent(files)
+	if len(unique) != 2 || len(copies[filepath.Join("third_party", "x", "util.c")]) != 1 {
+		t.Errorf("Expected tiers to be grouped separately: unique=%d copies=%v", len(unique), copies)
+	}
+}
+
+func TestReduceToAPISurface(t *testing.T) {
+	parsed := &ParsedFile{
+		Path: "third_party/x/Base.java",
+		Dependencies: []ParsedDependency{
+			{Type: "import", Target: "java.util.List"},
+			{Type: "call", Source: "Base.run", Target: "helper"},
+			{Type: "extends", Source: "Base", Target: "Object"},
+		},
+	}
+	reduceToAPISurface(parsed)
+
+	if !parsed.APIOnly {
+		t.Error("Expected file to be marked APIOnly")
+	}
+	if len(parsed.Dependencies) != 2 {
+		t.Fatalf("Expected import and extends to be kept, got %+v", parsed.Dependencies)
+	}
+	for _, dep := range parsed.Dependencies {
+		if dep.Type == "call" {
+			t.Errorf("Call edge kept: %+v", dep)
+		}
+	}
+}
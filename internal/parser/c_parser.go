@@ -49,6 +49,7 @@ func (p *CParser) Parse(file ScannedFile) (*ParsedFile, error) {
 			File:    file.Path,
 			Message: fmt.Sprintf("failed to parse C file: %v", parseErr),
 			Type:    "parse",
+			Err:     parseErr,
 		}
 	}
 
@@ -95,8 +96,9 @@ func (p *CParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		// Non-fatal, continue
 	}
 
-	// Extract call relationships (only for implementation files)
-	if !isHeader {
+	// Extract call relationships (only for implementation files outside the
+	// API-surface tier)
+	if !isHeader && !file.APIOnly {
 		if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
 			// Non-fatal, continue
 		}
@@ -144,11 +146,12 @@ func (p *CParser) extractSignature(node *sitter.Node, content []byte) string {
 
 // findContainingFunction finds the name of the function containing a node
 func (p *CParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a function definition
-		if current.Type() == "function_definition" {
+		if tree.Type(current) == "function_definition" {
 			// Find the matching symbol in our parsed symbols
 			for _, symbol := range parsedFile.Symbols {
 				if symbol.Node == current {
@@ -156,7 +159,7 @@ func (p *CParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedFi
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
@@ -0,0 +1,120 @@
+package parser
+
+import (
+	"sort"
+
+	sitter "github.com/smacker/go-tree-sitter"
+)
+
+// commentIndex lists the comment nodes of one file in source order.
+//
+// Doc comment extractors attach the run of comments directly preceding a
+// symbol among its siblings. Scanning a parent's children for every symbol
+// through cgo is quadratic in the size of heavily documented files, so the
+// comments are collected once from the flattened tree and each lookup is a
+// binary search followed by a walk over that comment run only.
+type commentIndex struct {
+	tree     *FlatTree
+	comments []int // flat indices of comment nodes; pre-order is source order
+}
+
+// docComment is a comment attached to a symbol
+type docComment struct {
+	Kind string
+	Text string
+}
+
+// newCommentIndex collects the nodes of the given comment kinds. Returns nil
+// for a nil tree; lookups on a nil index fall back to walking siblings.
+func newCommentIndex(tree *FlatTree, kinds ...string) *commentIndex {
+	if tree == nil {
+		return nil
+	}
+
+	idx := &commentIndex{tree: tree}
+	for i := 0; i < tree.Len(); i++ {
+		if isCommentKind(tree.Kind(i), kinds) {
+			idx.comments = append(idx.comments, i)
+		}
+	}
+	return idx
+}
+
+// precedingComments returns the comments of the given kinds that directly
+// precede node among its parent's children, in source order. The run stops at
+// the first sibling that is not such a comment.
+func (c *commentIndex) precedingComments(node *sitter.Node, content []byte, kinds ...string) []docComment {
+	if node == nil {
+		return nil
+	}
+
+	i := -1
+	if c != nil {
+		i = c.tree.Lookup(node)
+	}
+	if i < 0 {
+		return precedingSiblingComments(node, content, kinds)
+	}
+
+	parent := c.tree.ParentIndex(i)
+	if parent < 0 {
+		return nil
+	}
+
+	// Comments are leaves, so the previous sibling is a comment exactly when
+	// it is the nearest comment before node in pre-order
+	var run []docComment
+	want := c.tree.ChildIndex(i) - 1
+	for k := sort.SearchInts(c.comments, i) - 1; k >= 0 && want >= 0; k-- {
+		j := c.comments[k]
+		if c.tree.ParentIndex(j) != parent || c.tree.ChildIndex(j) != want {
+			break
+		}
+		run = append(run, docComment{Kind: c.tree.Kind(j), Text: c.tree.Content(j, content)})
+		want--
+	}
+
+	// Collected nearest first
+	for l, r := 0, len(run)-1; l < r; l, r = l+1, r-1 {
+		run[l], run[r] = run[r], run[l]
+	}
+	return run
+}
+
+// precedingSiblingComments is precedingComments through the node accessors,
+// for nodes outside an indexed tree
+func precedingSiblingComments(node *sitter.Node, content []byte, kinds []string) []docComment {
+	parent := node.Parent()
+	if parent == nil {
+		return nil
+	}
+
+	// Find the index of the current node
+	nodeIndex := -1
+	for i := 0; i < int(parent.ChildCount()); i++ {
+		if parent.Child(i) == node {
+			nodeIndex = i
+			break
+		}
+	}
+
+	var run []docComment
+	for i := nodeIndex - 1; i >= 0; i-- {
+		sibling := parent.Child(i)
+		kind := sibling.Type()
+		if !isCommentKind(kind, kinds) {
+			break
+		}
+		run = append([]docComment{{Kind: kind, Text: sibling.Content(content)}}, run...)
+	}
+	return run
+}
+
+func isCommentKind(kind string, kinds []string) bool {
+	for _, k := range kinds {
+		if kind == k {
+			return true
+		}
+	}
+	return false
+}
@@ -0,0 +1,71 @@
+package parser
+
+import (
+	"reflect"
+	"testing"
+)
+
+const commentIndexSource = `package main
+
+// Greeter says hello
+// to someone.
+type Greeter struct {
+	// name of the greeted
+	name string
+}
+
+/* block comment */
+var x = 1
+
+// Greet prints a greeting
+func (g *Greeter) Greet() {
+	// inside the body
+	println(g.name)
+}
+`
+
+// TestCommentIndex_MatchesSiblingWalk 对每个节点比较索引查找与逐个兄弟节点回溯的结果
+func TestCommentIndex_MatchesSiblingWalk(t *testing.T) {
+	tsParser, err := NewTreeSitterParser()
+	if err != nil {
+		t.Fatalf("Failed to create parser: %v", err)
+	}
+	content := []byte(commentIndexSource)
+	root, err := tsParser.Parse(content, "go")
+	if err != nil {
+		t.Fatalf("Parse failed: %v", err)
+	}
+
+	tree := FlattenTree(root)
+	index := newCommentIndex(tree, "comment")
+	if len(index.comments) != 6 {
+		t.Fatalf("Expected 6 comments, got %d", len(index.comments))
+	}
+
+	attached := 0
+	for i := 0; i < tree.Len(); i++ {
+		node := tree.Node(i)
+		got := index.precedingComments(node, content, "comment")
+		want := precedingSiblingComments(node, content, []string{"comment"})
+		if !reflect.DeepEqual(got, want) {
+			t.Errorf("Node %d (%s): got %+v, want %+v", i, tree.Kind(i), got, want)
+		}
+		if len(got) > 0 && tree.Kind(i) != "comment" {
+			attached++
+		}
+	}
+	if attached == 0 {
+		t.Error("Expected some nodes to have preceding comments")
+	}
+
+	// nil 索引退回兄弟节点回溯
+	var none *commentIndex
+	for i := 0; i < tree.Len(); i++ {
+		if tree.Kind(i) == "type_declaration" {
+			comments := none.precedingComments(tree.Node(i), content, "comment")
+			if len(comments) != 2 || comments[0].Text != "// Greeter says hello" {
+				t.Errorf("Expected the two Greeter comments in source order, got %+v", comments)
+			}
+		}
+	}
+}
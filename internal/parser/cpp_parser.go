@@ -49,6 +49,7 @@ func (p *CppParser) Parse(file ScannedFile) (*ParsedFile, error) {
 			File:    file.Path,
 			Message: fmt.Sprintf("failed to parse C++ file: %v", parseErr),
 			Type:    "parse",
+			Err:     parseErr,
 		}
 	}
 
@@ -98,8 +99,9 @@ func (p *CppParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		// Non-fatal, continue
 	}
 
-	// Extract call relationships (only for implementation files)
-	if !isHeader {
+	// Extract call relationships (only for implementation files outside the
+	// API-surface tier)
+	if !isHeader && !file.APIOnly {
 		if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
 			// Non-fatal, continue
 		}
@@ -152,11 +154,12 @@ func (p *CppParser) extractSignature(node *sitter.Node, content []byte) string {
 
 // findContainingFunction finds the name of the function containing a node
 func (p *CppParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a function definition
-		if current.Type() == "function_definition" {
+		if tree.Type(current) == "function_definition" {
 			// Find the matching symbol in our parsed symbols
 			for _, symbol := range parsedFile.Symbols {
 				if symbol.Node == current {
@@ -164,7 +167,7 @@ func (p *CppParser) findContainingFunction(node *sitter.Node, parsedFile *Parsed
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
@@ -1069,7 +1072,8 @@ func (p *CppParser) extractTemplateTypeName(templateNode *sitter.Node, content [
 
 // findContainingSymbol finds the name of the symbol containing a node
 func (p *CppParser) findContainingSymbol(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a function definition or class
@@ -1078,7 +1082,7 @@ func (p *CppParser) findContainingSymbol(node *sitter.Node, parsedFile *ParsedFi
 				return symbol.Name
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
@@ -1501,11 +1505,12 @@ func (p *CppParser) extractVirtualMethodOverrides(rootNode *sitter.Node, parsedF
 
 // findContainingClass finds the name of the class containing a node
 func (p *CppParser) findContainingClass(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a class or struct
-		if current.Type() == "class_specifier" || current.Type() == "struct_specifier" {
+		if tree.Type(current) == "class_specifier" || tree.Type(current) == "struct_specifier" {
 			// Find the matching symbol in our parsed symbols
 			for _, symbol := range parsedFile.Symbols {
 				if symbol.Node == current {
@@ -1513,7 +1518,7 @@ func (p *CppParser) findContainingClass(node *sitter.Node, parsedFile *ParsedFil
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
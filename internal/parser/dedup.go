@@ -0,0 +1,72 @@
+package parser
+
+import (
+	"crypto/sha256"
+	"encoding/hex"
+	"io"
+	"os"
+)
+
+// GroupByContent splits scanned files into one canonical file per distinct
+// (language, content) and the copies of it found at other paths, so vendored
+// or per-platform duplicates are parsed once. Canonical files are returned in
+// scan order, each being the first path of its content; copies maps a
+// canonical path to its copies, also in scan order. Files of the API-surface
+// tier are only grouped with each other, since they are parsed differently.
+//
+// Only files sharing a size with another file of the same language are hashed,
+// so a tree without duplicates costs no extra reads. Files that cannot be read
+// are kept as canonical and fail later in the parser as before.
+func GroupByContent(files []ScannedFile) ([]ScannedFile, map[string][]ScannedFile) {
+	type sizeKey struct {
+		language string
+		size     int64
+	}
+	sameSize := make(map[sizeKey]int, len(files))
+	for _, f := range files {
+		sameSize[sizeKey{f.Language, f.Size}]++
+	}
+
+	type contentKey struct {
+		language string
+		checksum string
+		apiOnly  bool
+	}
+	canonicalOf := make(map[contentKey]string)
+	unique := make([]ScannedFile, 0, len(files))
+	copies := make(map[string][]ScannedFile)
+	for _, f := range files {
+		if sameSize[sizeKey{f.Language, f.Size}] < 2 {
+			unique = append(unique, f)
+			continue
+		}
+		checksum, err := fileChecksum(f.AbsPath)
+		if err != nil {
+			unique = append(unique, f)
+			continue
+		}
+		key := contentKey{f.Language, checksum, f.APIOnly}
+		if canonical, ok := canonicalOf[key]; ok {
+			copies[canonical] = append(copies[canonical], f)
+			continue
+		}
+		canonicalOf[key] = f.Path
+		unique = append(unique, f)
+	}
+	return unique, copies
+}
+
+// fileChecksum returns the hex SHA-256 of a file's content
+func fileChecksum(path string) (string, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return "", err
+	}
+	defer f.Close()
+
+	h := sha256.New()
+	if _, err := io.Copy(h, f); err != nil {
+		return "", err
+	}
+	return hex.EncodeToString(h.Sum(nil)), nil
+}
@@ -0,0 +1,68 @@
+package parser
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+func TestGroupByContent(t *testing.T) {
+	tempDir := t.TempDir()
+	write := func(rel, content string) {
+		path := filepath.Join(tempDir, rel)
+		if err := os.MkdirAll(filepath.Dir(path), 0755); err != nil {
+			t.Fatal(err)
+		}
+		if err := os.WriteFile(path, []byte(content), 0644); err != nil {
+			t.Fatal(err)
+		}
+	}
+	write("third_party/x/util.h", "int add(int a, int b);\n")
+	write("android/x/util.h", "int add(int a, int b);\n")
+	write("ios/x/util.h", "int add(int a, int b);\n")
+	write("src/other.h", "int sub(int a, int b);\n") // 同大小不同内容
+	write("src/main.c", "int main(void) { return 0; }\n")
+
+	filter, err := NewIgnoreFilter(nil, nil)
+	if err != nil {
+		t.Fatalf("Failed to create ignore filter: %v", err)
+	}
+	files, err := NewFileScanner(tempDir, filter).Scan()
+	if err != nil {
+		t.Fatalf("Scan failed: %v", err)
+	}
+
+	unique, copies := GroupByContent(files)
+	if len(unique) != 3 {
+		t.Fatalf("Expected 3 unique files, got %d: %+v", len(unique), unique)
+	}
+	// WalkDir 按字典序：android/x/util.h 最先出现，成为规范路径
+	got := copies[filepath.Join("android", "x", "util.h")]
+	if len(got) != 2 {
+		t.Fatalf("Expected 2 copies of android/x/util.h, got %+v", copies)
+	}
+	if got[0].Path != filepath.Join("ios", "x", "util.h") || got[1].Path != filepath.Join("third_party", "x", "util.h") {
+		t.Errorf("Copies not in scan order: %s, %s", got[0].Path, got[1].Path)
+	}
+	if len(copies) != 1 {
+		t.Errorf("Expected copies for one canonical file only, got %d", len(copies))
+	}
+}
+
+func TestGroupByContent_LanguageSeparates(t *testing.T) {
+	tempDir := t.TempDir()
+	for _, name := range []string{"a.js", "a.ts"} {
+		if err := os.WriteFile(filepath.Join(tempDir, name), []byte("export const x = 1;\n"), 0644); err != nil {
+			t.Fatal(err)
+		}
+	}
+	files := []ScannedFile{
+		{Path: "a.js", AbsPath: filepath.Join(tempDir, "a.js"), Language: "JavaScript", Size: 20},
+		{Path: "a.ts", AbsPath: filepath.Join(tempDir, "a.ts"), Language: "TypeScript", Size: 20},
+	}
+
+	unique, copies := GroupByContent(files)
+	if len(unique) != 2 || len(copies) != 0 {
+		t.Errorf("Files of different languages must not be grouped: unique=%d copies=%d", len(unique), len(copies))
+	}
+}
@@ -0,0 +1,172 @@
+package parser
+
+import (
+	sitter "github.com/smacker/go-tree-sitter"
+)
+
+// FlatTree is a parsed tree copied into Go-side arrays in one pre-order walk.
+//
+// Every accessor of sitter.Node is a cgo call, and ts_node_parent even
+// descends from the root again, so the extractors' parent climbs and the AST
+// node mapping spend much of their time crossing into C. FlatTree reads each
+// node once through a TreeCursor (kind, byte range, points, named flag) and
+// answers parent, child and kind lookups from slices afterwards. Node types
+// are interned by grammar symbol, so each distinct type is converted to a Go
+// string only once per file.
+//
+// Indices are pre-order: a node's parent always has a smaller index, and the
+// subtree of node i is the contiguous range i..End(i)-1.
+type FlatTree struct {
+	kinds      []string // interned node types, indexed by kind
+	kind       []uint16
+	named      []bool
+	startByte  []uint32
+	endByte    []uint32
+	startPoint []sitter.Point
+	endPoint   []sitter.Point
+	parent     []int32
+	childIndex []uint32
+	subtreeEnd []int32
+	nodes      []*sitter.Node
+	index      map[*sitter.Node]int32
+}
+
+// FlattenTree copies the tree under root into a FlatTree. Returns nil for a
+// nil root.
+func FlattenTree(root *sitter.Node) *FlatTree {
+	if root == nil {
+		return nil
+	}
+
+	t := &FlatTree{index: make(map[*sitter.Node]int32)}
+	kindOf := make(map[sitter.Symbol]uint16)
+	add := func(node *sitter.Node, parent int32, childIndex uint32) int32 {
+		i := int32(len(t.nodes))
+		symbol := node.Symbol()
+		k, ok := kindOf[symbol]
+		if !ok {
+			k = uint16(len(t.kinds))
+			kindOf[symbol] = k
+			t.kinds = append(t.kinds, node.Type())
+		}
+		t.kind = append(t.kind, k)
+		t.named = append(t.named, node.IsNamed())
+		t.startByte = append(t.startByte, node.StartByte())
+		t.endByte = append(t.endByte, node.EndByte())
+		t.startPoint = append(t.startPoint, node.StartPoint())
+		t.endPoint = append(t.endPoint, node.EndPoint())
+		t.parent = append(t.parent, parent)
+		t.childIndex = append(t.childIndex, childIndex)
+		t.subtreeEnd = append(t.subtreeEnd, i+1)
+		t.nodes = append(t.nodes, node)
+		t.index[node] = i
+		return i
+	}
+
+	cursor := sitter.NewTreeCursor(root)
+	defer cursor.Close()
+
+	// open 是游标当前位置的祖先链，seen 是各祖先已访问的子节点数
+	var open []int32
+	var seen []uint32
+	current := add(root, -1, 0)
+	for {
+		if cursor.GoToFirstChild() {
+			open = append(open, current)
+			seen = append(seen, 1)
+			current = add(cursor.CurrentNode(), current, 0)
+			continue
+		}
+		// 叶子：前进到下一个兄弟，沿途关闭已遍历完的祖先
+		for {
+			if len(open) == 0 {
+				return t
+			}
+			top := len(open) - 1
+			if cursor.GoToNextSibling() {
+				current = add(cursor.CurrentNode(), open[top], seen[top])
+				seen[top]++
+				break
+			}
+			cursor.GoToParent()
+			t.subtreeEnd[open[top]] = int32(len(t.nodes))
+			open, seen = open[:top], seen[:top]
+		}
+	}
+}
+
+// Len returns the number of nodes
+func (t *FlatTree) Len() int {
+	if t == nil {
+		return 0
+	}
+	return len(t.nodes)
+}
+
+// Lookup returns the index of node, or -1 if node is not part of the tree
+func (t *FlatTree) Lookup(node *sitter.Node) int {
+	if t == nil || node == nil {
+		return -1
+	}
+	if i, ok := t.index[node]; ok {
+		return int(i)
+	}
+	return -1
+}
+
+// Node returns the Tree-sitter node at index i
+func (t *FlatTree) Node(i int) *sitter.Node { return t.nodes[i] }
+
+// Kind returns the node type at index i
+func (t *FlatTree) Kind(i int) string { return t.kinds[t.kind[i]] }
+
+// IsNamed reports whether the node at index i is named
+func (t *FlatTree) IsNamed(i int) bool { return t.named[i] }
+
+// StartByte returns the start byte of the node at index i
+func (t *FlatTree) StartByte(i int) uint32 { return t.startByte[i] }
+
+// EndByte returns the end byte of the node at index i
+func (t *FlatTree) EndByte(i int) uint32 { return t.endByte[i] }
+
+// StartPoint returns the start position of the node at index i
+func (t *FlatTree) StartPoint(i int) sitter.Point { return t.startPoint[i] }
+
+// EndPoint returns the end position of the node at index i
+func (t *FlatTree) EndPoint(i int) sitter.Point { return t.endPoint[i] }
+
+// ParentIndex returns the index of the parent of node i, -1 for the root
+func (t *FlatTree) ParentIndex(i int) int { return int(t.parent[i]) }
+
+// ChildIndex returns the position of node i among its parent's children
+func (t *FlatTree) ChildIndex(i int) int { return int(t.childIndex[i]) }
+
+// End returns the index just past the subtree of node i
+func (t *FlatTree) End(i int) int { return int(t.subtreeEnd[i]) }
+
+// Content returns the source text of the node at index i
+func (t *FlatTree) Content(i int, content []byte) string {
+	return string(content[t.startByte[i]:t.endByte[i]])
+}
+
+// Parent returns the parent of node. Nodes outside the tree (or a nil tree)
+// fall back to the cgo accessor, so callers need no separate path.
+func (t *FlatTree) Parent(node *sitter.Node) *sitter.Node {
+	i := t.Lookup(node)
+	if i < 0 {
+		return node.Parent()
+	}
+	if p := t.parent[i]; p >= 0 {
+		return t.nodes[p]
+	}
+	return nil
+}
+
+// Type returns the type of node, with the same fallback as Parent
+func (t *FlatTree) Type(node *sitter.Node) string {
+	i := t.Lookup(node)
+	if i < 0 {
+		return node.Type()
+	}
+	return t.Kind(i)
+}
@@ -0,0 +1,136 @@
+package parser
+
+import (
+	"testing"
+
+	sitter "github.com/smacker/go-tree-sitter"
+)
+
+const flatTreeSource = `package main
+
+import "fmt"
+
+type Greeter struct{ name string }
+
+func (g *Greeter) Greet() {
+	fmt.Println("hello", g.name)
+}
+
+func main() {
+	g := &Greeter{name: "x"}
+	g.Greet()
+}
+`
+
+// TestFlattenTree_MatchesNodeAccessors 逐节点对照 FlatTree 与 cgo 访问器的结果
+func TestFlattenTree_MatchesNodeAccessors(t *testing.T) {
+	tsParser, err := NewTreeSitterParser()
+	if err != nil {
+		t.Fatalf("Failed to create parser: %v", err)
+	}
+	content := []byte(flatTreeSource)
+	root, err := tsParser.Parse(content, "go")
+	if err != nil {
+		t.Fatalf("Parse failed: %v", err)
+	}
+
+	tree := FlattenTree(root)
+
+	// 递归遍历得到的前序序列应与扁平数组一一对应
+	var walk func(node *sitter.Node, parent int, childIndex int)
+	next := 0
+	walk = func(node *sitter.Node, parent int, childIndex int) {
+		i := next
+		next++
+		if i >= tree.Len() {
+			t.Fatalf("FlatTree has %d nodes, walk reached more", tree.Len())
+		}
+		if tree.Node(i) != node {
+			t.Fatalf("Node %d: expected %s, got %s", i, node.Type(), tree.Kind(i))
+		}
+		if tree.Lookup(node) != i {
+			t.Errorf("Node %d: Lookup returned %d", i, tree.Lookup(node))
+		}
+		if tree.Kind(i) != node.Type() || tree.IsNamed(i) != node.IsNamed() {
+			t.Errorf("Node %d: kind %s/%v, want %s/%v", i, tree.Kind(i), tree.IsNamed(i), node.Type(), node.IsNamed())
+		}
+		if tree.StartByte(i) != node.StartByte() || tree.EndByte(i) != node.EndByte() ||
+			tree.StartPoint(i) != node.StartPoint() || tree.EndPoint(i) != node.EndPoint() {
+			t.Errorf("Node %d (%s): range differs", i, node.Type())
+		}
+		if tree.ParentIndex(i) != parent || tree.ChildIndex(i) != childIndex {
+			t.Errorf("Node %d (%s): parent/child index %d/%d, want %d/%d",
+				i, node.Type(), tree.ParentIndex(i), tree.ChildIndex(i), parent, childIndex)
+		}
+		if tree.Content(i, content) != node.Content(content) {
+			t.Errorf("Node %d: content differs", i)
+		}
+		for k := 0; k < int(node.ChildCount()); k++ {
+			walk(node.Child(k), i, k)
+		}
+		if tree.End(i) != next {
+			t.Errorf("Node %d (%s): subtree ends at %d, want %d", i, node.Type(), tree.End(i), next)
+		}
+	}
+	walk(root, -1, 0)
+
+	if next != tree.Len() {
+		t.Errorf("Walk visited %d nodes, FlatTree has %d", next, tree.Len())
+	}
+	if tree.Parent(root) != nil {
+		t.Error("Root should have no parent")
+	}
+}
+
+func TestFlatTree_ParentMatchesCgo(t *testing.T) {
+	tsParser, err := NewTreeSitterParser()
+	if err != nil {
+		t.Fatalf("Failed to create parser: %v", err)
+	}
+	root, err := tsParser.Parse([]byte(flatTreeSource), "go")
+	if err != nil {
+		t.Fatalf("Parse failed: %v", err)
+	}
+
+	tree := FlattenTree(root)
+	for i := 1; i < tree.Len(); i++ {
+		node := tree.Node(i)
+		if got, want := tree.Parent(node), node.Parent(); got != want {
+			t.Errorf("Node %d (%s): Parent differs from cgo accessor", i, tree.Kind(i))
+		}
+		if tree.Type(node) != node.Type() {
+			t.Errorf("Node %d: Type differs from cgo accessor", i)
+		}
+	}
+
+	// 不在树中的节点（或 nil 树）退回 cgo 访问器
+	var none *FlatTree
+	child := tree.Node(1)
+	if none.Parent(child) != child.Parent() || none.Type(child) != child.Type() {
+		t.Error("A nil FlatTree should fall back to the node accessors")
+	}
+}
+
+func BenchmarkFindContainingFunction(b *testing.B) {
+	tsParser, err := NewTreeSitterParser()
+	if err != nil {
+		b.Fatalf("Failed to create parser: %v", err)
+	}
+	content := []byte(flatTreeSource)
+	for _, mode := range []string{"cgo", "flat"} {
+		b.Run(mode, func(b *testing.B) {
+			for i := 0; i < b.N; i++ {
+				root, _ := tsParser.Parse(content, "go")
+				parsedFile := &ParsedFile{Path: "main.go", Content: content, RootNode: root}
+				goParser := NewGoParser(tsParser)
+				_ = goParser.extractFunctions(root, parsedFile, content)
+				_ = goParser.extractMethods(root, parsedFile, content)
+				if mode == "cgo" {
+					// 空树：每次查找都退回 cgo 访问器
+					parsedFile.flat = &FlatTree{}
+				}
+				_ = goParser.extractCallRelationships(root, parsedFile, content)
+			}
+		})
+	}
+}
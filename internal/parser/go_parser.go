@@ -16,6 +16,7 @@ type DetailedParseError struct {
 	Column  int
 	Message string
 	Type    string // filesystem, parse, mapping
+	Err     error  // underlying error, if any (e.g. *BrokenTreeError)
 }
 
 func (e *DetailedParseError) Error() string {
@@ -25,6 +26,10 @@ func (e *DetailedParseError) Error() string {
 	return fmt.Sprintf("%s: %s", e.File, e.Message)
 }
 
+func (e *DetailedParseError) Unwrap() error {
+	return e.Err
+}
+
 // ParsedFile represents the internal representation of a parsed file
 type ParsedFile struct {
 	Path         string
@@ -34,6 +39,20 @@ type ParsedFile struct {
 	RootNode     *sitter.Node
 	Symbols      []ParsedSymbol
 	Dependencies []ParsedDependency
+	// APIOnly marks a file of the API-surface tier (see APISurfaceFilter):
+	// declarations only, no call edges and no tree
+	APIOnly bool
+
+	flat *FlatTree
+}
+
+// Flat returns RootNode flattened into Go-side arrays, built on first use and
+// shared by the extractors and the AST node mapping (nil without a tree)
+func (f *ParsedFile) Flat() *FlatTree {
+	if f.flat == nil && f.RootNode != nil {
+		f.flat = FlattenTree(f.RootNode)
+	}
+	return f.flat
 }
 
 // ParsedSymbol represents a code symbol (function, class, etc.)
@@ -67,6 +86,7 @@ type ParsedDependency struct {
 // GoParser parses Go source code using Tree-sitter
 type GoParser struct {
 	tsParser *TreeSitterParser
+	comments *commentIndex // comments of the file being parsed
 }
 
 // NewGoParser creates a new Go parser
@@ -107,6 +127,10 @@ func (p *GoParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		}
 	}
 
+	// Index comments once for docstring lookups
+	p.comments = newCommentIndex(parsedFile.Flat(), "comment")
+	defer func() { p.comments = nil }()
+
 	// Extract package declaration
 	if err := p.extractPackage(rootNode, parsedFile); err != nil {
 		// Non-fatal, continue
@@ -142,9 +166,11 @@ func (p *GoParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		// Non-fatal, continue
 	}
 
-	// Extract call relationships
-	if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
-		// Non-fatal, continue
+	// Extract call relationships (not for API-surface files)
+	if !file.APIOnly {
+		if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
+			// Non-fatal, continue
+		}
 	}
 
 	// Return parse error if there was one, but with partial results
@@ -661,43 +687,12 @@ func (p *GoParser) extractInterfaceMethods(interfaceBody *sitter.Node, content [
 
 // extractDocstring extracts the comment/docstring before a node
 func (p *GoParser) extractDocstring(node *sitter.Node, content []byte) string {
-	if node == nil {
-		return ""
-	}
-
-	// Look for comment nodes before this node
-	parent := node.Parent()
-	if parent == nil {
-		return ""
-	}
-
 	var comments []string
-
-	// Find the index of the current node
-	nodeIndex := -1
-	for i := 0; i < int(parent.ChildCount()); i++ {
-		if parent.Child(i) == node {
-			nodeIndex = i
-			break
-		}
-	}
-
-	if nodeIndex <= 0 {
-		return ""
-	}
-
-	// Look backwards for comments
-	for i := nodeIndex - 1; i >= 0; i-- {
-		sibling := parent.Child(i)
-		if sibling.Type() == "comment" {
-			commentText := sibling.Content(content)
-			// Remove comment markers
-			commentText = strings.TrimPrefix(commentText, "//")
-			commentText = strings.TrimSpace(commentText)
-			comments = append([]string{commentText}, comments...)
-		} else if sibling.Type() != "comment" {
-			break
-		}
+	for _, comment := range p.comments.precedingComments(node, content, "comment") {
+		// Remove comment markers
+		commentText := strings.TrimPrefix(comment.Text, "//")
+		commentText = strings.TrimSpace(commentText)
+		comments = append(comments, commentText)
 	}
 
 	return strings.Join(comments, "\n")
@@ -736,11 +731,12 @@ func (p *GoParser) extractCallRelationships(rootNode *sitter.Node, parsedFile *P
 
 // findContainingFunction finds the name of the function/method containing a node
 func (p *GoParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a function or method declaration
-		if current.Type() == "function_declaration" || current.Type() == "method_declaration" {
+		if tree.Type(current) == "function_declaration" || tree.Type(current) == "method_declaration" {
 			// Find the matching symbol in our parsed symbols
 			for _, symbol := range parsedFile.Symbols {
 				if symbol.Node == current {
@@ -748,7 +744,7 @@ func (p *GoParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedF
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
@@ -172,11 +172,16 @@ func (f *IgnoreFilter) matchesPattern(path, pattern string, isDir bool) bool {
 		return f.matchDoubleStarPattern(path, pattern)
 	}
 
-	// Handle absolute patterns (starting with /)
+	// Handle absolute patterns (starting with /): the path itself or one of
+	// its parent directories must match from the root
 	if strings.HasPrefix(pattern, "/") {
 		pattern = strings.TrimPrefix(pattern, "/")
-		matched, _ := filepath.Match(pattern, path)
-		return matched
+		for p := path; p != "." && p != "/"; p = filepath.Dir(p) {
+			if matched, _ := filepath.Match(pattern, p); matched {
+				return true
+			}
+		}
+		return false
 	}
 
 	// Try matching against the full path
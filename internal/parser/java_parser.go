@@ -10,8 +10,12 @@ import (
 // JavaParser parses Java source code using Tree-sitter
 type JavaParser struct {
 	tsParser *TreeSitterParser
+	comments *commentIndex // comments of the file being parsed
 }
 
+// javaCommentKinds are the node types a Javadoc run is collected from
+var javaCommentKinds = []string{"block_comment", "line_comment"}
+
 // NewJavaParser creates a new Java parser
 func NewJavaParser(tsParser *TreeSitterParser) *JavaParser {
 	return &JavaParser{
@@ -53,6 +57,10 @@ func (p *JavaParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		}
 	}
 
+	// Index comments once for docstring lookups
+	p.comments = newCommentIndex(parsedFile.Flat(), javaCommentKinds...)
+	defer func() { p.comments = nil }()
+
 	// Extract package declaration
 	if err := p.extractPackage(rootNode, parsedFile, content); err != nil {
 		// Non-fatal, continue
@@ -127,11 +135,12 @@ func (p *JavaParser) extractSignature(node *sitter.Node, content []byte) string
 
 // findContainingFunction finds the name of the function/method containing a node
 func (p *JavaParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a method declaration
-		if current.Type() == "method_declaration" || current.Type() == "constructor_declaration" {
+		if tree.Type(current) == "method_declaration" || tree.Type(current) == "constructor_declaration" {
 			// Find the matching symbol in our parsed symbols
 			for _, symbol := range parsedFile.Symbols {
 				if symbol.Node == current {
@@ -151,7 +160,7 @@ func (p *JavaParser) findContainingFunction(node *sitter.Node, parsedFile *Parse
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
@@ -1023,37 +1032,10 @@ func (p *JavaParser) findAnnotationTarget(node *sitter.Node, content []byte) str
 
 // extractJavadoc extracts Javadoc comments
 func (p *JavaParser) extractJavadoc(node *sitter.Node, content []byte) string {
-	if node == nil {
-		return ""
-	}
-
-	// Look for comment nodes before this node
-	parent := node.Parent()
-	if parent == nil {
-		return ""
-	}
-
 	var comments []string
-
-	// Find the index of the current node
-	nodeIndex := -1
-	for i := 0; i < int(parent.ChildCount()); i++ {
-		if parent.Child(i) == node {
-			nodeIndex = i
-			break
-		}
-	}
-
-	if nodeIndex <= 0 {
-		return ""
-	}
-
-	// Look backwards for comments
-	for i := nodeIndex - 1; i >= 0; i-- {
-		sibling := parent.Child(i)
-		if sibling.Type() == "block_comment" {
-			commentText := sibling.Content(content)
-
+	for _, comment := range p.comments.precedingComments(node, content, javaCommentKinds...) {
+		commentText := comment.Text
+		if comment.Kind == "block_comment" {
 			// Handle Javadoc comments (/** ... */)
 			if strings.HasPrefix(commentText, "/**") {
 				commentText = strings.TrimPrefix(commentText, "/**")
@@ -1073,17 +1055,13 @@ func (p *JavaParser) extractJavadoc(node *sitter.Node, content []byte) string {
 				}
 				commentText = strings.Join(cleanLines, "\n")
 			}
-
-			comments = append([]string{commentText}, comments...)
-		} else if sibling.Type() == "line_comment" {
-			commentText := sibling.Content(content)
+		} else {
 			// Handle single-line comments
 			commentText = strings.TrimPrefix(commentText, "//")
 			commentText = strings.TrimSpace(commentText)
-			comments = append([]string{commentText}, comments...)
-		} else if sibling.Type() != "block_comment" && sibling.Type() != "line_comment" {
-			break
 		}
+
+		comments = append(comments, commentText)
 	}
 
 	return strings.Join(comments, "\n")
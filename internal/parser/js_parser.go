@@ -10,6 +10,7 @@ import (
 // JSParser parses JavaScript/TypeScript source code using Tree-sitter
 type JSParser struct {
 	tsParser *TreeSitterParser
+	comments *commentIndex // comments of the file being parsed
 }
 
 // NewJSParser creates a new JavaScript/TypeScript parser
@@ -53,6 +54,10 @@ func (p *JSParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		}
 	}
 
+	// Index comments once for docstring lookups
+	p.comments = newCommentIndex(parsedFile.Flat(), "comment")
+	defer func() { p.comments = nil }()
+
 	// Create a module symbol for the file (similar to Go's package symbol)
 	// Extract file name without extension
 	fileName := file.Path
@@ -101,9 +106,11 @@ func (p *JSParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		// Non-fatal, continue
 	}
 
-	// Extract call relationships
-	if err := p.extractCallRelationships(rootNode, parsedFile, content, language); err != nil {
-		// Non-fatal, continue
+	// Extract call relationships (not for API-surface files)
+	if !file.APIOnly {
+		if err := p.extractCallRelationships(rootNode, parsedFile, content, language); err != nil {
+			// Non-fatal, continue
+		}
 	}
 
 	// Return parse error if there was one, but with partial results
@@ -688,65 +695,35 @@ func (p *JSParser) extractTypeAnnotations(node *sitter.Node, signature string, c
 
 // extractJSDoc extracts JSDoc comments before a node
 func (p *JSParser) extractJSDoc(node *sitter.Node, content []byte) string {
-	if node == nil {
-		return ""
-	}
-
-	// Look for comment nodes before this node
-	parent := node.Parent()
-	if parent == nil {
-		return ""
-	}
-
 	var comments []string
-
-	// Find the index of the current node
-	nodeIndex := -1
-	for i := 0; i < int(parent.ChildCount()); i++ {
-		if parent.Child(i) == node {
-			nodeIndex = i
-			break
-		}
-	}
-
-	if nodeIndex <= 0 {
-		return ""
-	}
-
-	// Look backwards for comments
-	for i := nodeIndex - 1; i >= 0; i-- {
-		sibling := parent.Child(i)
-		if sibling.Type() == "comment" {
-			commentText := sibling.Content(content)
-
-			// Handle JSDoc comments (/** ... */)
-			if strings.HasPrefix(commentText, "/**") {
-				commentText = strings.TrimPrefix(commentText, "/**")
-				commentText = strings.TrimSuffix(commentText, "*/")
-				commentText = strings.TrimSpace(commentText)
-
-				// Clean up JSDoc formatting
-				lines := strings.Split(commentText, "\n")
-				var cleanLines []string
-				for _, line := range lines {
-					line = strings.TrimSpace(line)
-					line = strings.TrimPrefix(line, "*")
-					line = strings.TrimSpace(line)
-					if line != "" {
-						cleanLines = append(cleanLines, line)
-					}
+	for _, comment := range p.comments.precedingComments(node, content, "comment") {
+		commentText := comment.Text
+
+		// Handle JSDoc comments (/** ... */)
+		if strings.HasPrefix(commentText, "/**") {
+			commentText = strings.TrimPrefix(commentText, "/**")
+			commentText = strings.TrimSuffix(commentText, "*/")
+			commentText = strings.TrimSpace(commentText)
+
+			// Clean up JSDoc formatting
+			lines := strings.Split(commentText, "\n")
+			var cleanLines []string
+			for _, line := range lines {
+				line = strings.TrimSpace(line)
+				line = strings.TrimPrefix(line, "*")
+				line = strings.TrimSpace(line)
+				if line != "" {
+					cleanLines = append(cleanLines, line)
 				}
-				commentText = strings.Join(cleanLines, "\n")
-			} else {
-				// Handle single-line comments
-				commentText = strings.TrimPrefix(commentText, "//")
-				commentText = strings.TrimSpace(commentText)
 			}
-
-			comments = append([]string{commentText}, comments...)
-		} else if sibling.Type() != "comment" {
-			break
+			commentText = strings.Join(cleanLines, "\n")
+		} else {
+			// Handle single-line comments
+			commentText = strings.TrimPrefix(commentText, "//")
+			commentText = strings.TrimSpace(commentText)
 		}
+
+		comments = append(comments, commentText)
 	}
 
 	return strings.Join(comments, "\n")
@@ -816,11 +793,12 @@ func (p *JSParser) extractCallRelationships(rootNode *sitter.Node, parsedFile *P
 
 // findContainingFunction finds the name of the function/method containing a node
 func (p *JSParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a function, arrow function, or method
-		nodeType := current.Type()
+		nodeType := tree.Type(current)
 		if nodeType == "function_declaration" ||
 			nodeType == "function_expression" ||
 			nodeType == "arrow_function" ||
@@ -838,7 +816,7 @@ func (p *JSParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedF
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
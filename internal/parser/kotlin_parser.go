@@ -1,8 +1,10 @@
 package parser
 
 import (
+	"bytes"
 	"fmt"
 	"strings"
+	"unicode"
 
 	sitter "github.com/smacker/go-tree-sitter"
 )
@@ -138,11 +140,12 @@ func (p *KotlinParser) extractSignature(node *sitter.Node, content []byte) strin
 
 // findContainingFunction finds the name of the function/method containing a node
 func (p *KotlinParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a function declaration
-		if current.Type() == "function_declaration" {
+		if tree.Type(current) == "function_declaration" {
 			// Find the matching symbol in our parsed symbols
 			for _, symbol := range parsedFile.Symbols {
 				if symbol.Node == current {
@@ -156,7 +159,7 @@ func (p *KotlinParser) findContainingFunction(node *sitter.Node, parsedFile *Par
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
@@ -691,7 +694,7 @@ func (p *KotlinParser) extractFunctions(rootNode *sitter.Node, parsedFile *Parse
 
 		if funcNode != nil && funcName != "" {
 			// Skip if this is a method (inside a class)
-			if p.isInsideClass(funcNode) {
+			if p.isInsideClass(funcNode, parsedFile) {
 				continue
 			}
 
@@ -798,13 +801,14 @@ func (p *KotlinParser) isSuspendFunction(funcNode *sitter.Node, content []byte)
 }
 
 // isInsideClass checks if a node is inside a class definition
-func (p *KotlinParser) isInsideClass(node *sitter.Node) bool {
-	current := node.Parent()
+func (p *KotlinParser) isInsideClass(node *sitter.Node, parsedFile *ParsedFile) bool {
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 	for current != nil {
-		if current.Type() == "class_declaration" || current.Type() == "object_declaration" {
+		if tree.Type(current) == "class_declaration" || tree.Type(current) == "object_declaration" {
 			return true
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 	return false
 }
@@ -967,7 +971,7 @@ func (p *KotlinParser) extractProperties(rootNode *sitter.Node, parsedFile *Pars
 
 		if propNode != nil && propName != "" {
 			// Skip if this is inside a class
-			if p.isInsideClass(propNode) {
+			if p.isInsideClass(propNode, parsedFile) {
 				continue
 			}
 
@@ -1056,30 +1060,24 @@ func (p *KotlinParser) extractKDoc(node *sitter.Node, content []byte) string {
 	}
 
 	// Search backwards in the source for KDoc comments
-	// Look for /** ... */ pattern before the node
-	beforeNode := string(content[:startByte])
-	
-	// Find the last occurrence of */ before the node
-	lastCommentEnd := strings.LastIndex(beforeNode, "*/")
-	if lastCommentEnd == -1 {
+	// Look for /** ... */ pattern before the node. Only whitespace may
+	// separate the comment from the node, so the search starts from the last
+	// non-space byte instead of copying everything before the node.
+	beforeNode := bytes.TrimRightFunc(content[:startByte], unicode.IsSpace)
+	if !bytes.HasSuffix(beforeNode, []byte("*/")) {
+		// There's code between the last comment and the node, not a doc comment
 		return ""
 	}
-	
+	lastCommentEnd := len(beforeNode) - 2
+
 	// Find the corresponding /** before it
-	commentStart := strings.LastIndex(beforeNode[:lastCommentEnd], "/**")
+	commentStart := bytes.LastIndex(beforeNode[:lastCommentEnd], []byte("/**"))
 	if commentStart == -1 {
 		return ""
 	}
-	
-	// Check if there's any non-whitespace between the comment and the node
-	betweenCommentAndNode := beforeNode[lastCommentEnd+2:]
-	if strings.TrimSpace(betweenCommentAndNode) != "" {
-		// There's code between the comment and the node, not a doc comment
-		return ""
-	}
-	
+
 	// Extract and clean the comment
-	commentText := beforeNode[commentStart : lastCommentEnd+2]
+	commentText := string(beforeNode[commentStart : lastCommentEnd+2])
 	commentText = strings.TrimPrefix(commentText, "/**")
 	commentText = strings.TrimSuffix(commentText, "*/")
 	commentText = strings.TrimSpace(commentText)
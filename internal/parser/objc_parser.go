@@ -11,6 +11,7 @@ import (
 // ObjCParser parses Objective-C source code using Tree-sitter
 type ObjCParser struct {
 	tsParser *TreeSitterParser
+	comments *commentIndex // comments of the file being parsed
 }
 
 // NewObjCParser creates a new Objective-C parser
@@ -48,9 +49,14 @@ func (p *ObjCParser) Parse(file ScannedFile) (*ParsedFile, error) {
 			File:    file.Path,
 			Message: fmt.Sprintf("failed to parse Objective-C file: %v", parseErr),
 			Type:    "parse",
+			Err:     parseErr,
 		}
 	}
 
+	// Index comments once for docstring lookups
+	p.comments = newCommentIndex(parsedFile.Flat(), "comment")
+	defer func() { p.comments = nil }()
+
 	// Determine if this is a header or implementation file
 	isHeader := strings.HasSuffix(file.Path, ".h")
 
@@ -81,9 +87,11 @@ func (p *ObjCParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		// Non-fatal, continue
 	}
 
-	// Extract call relationships (message sends)
-	if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
-		// Non-fatal, continue
+	// Extract call relationships (message sends, not for API-surface files)
+	if !file.APIOnly {
+		if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
+			// Non-fatal, continue
+		}
 	}
 
 	// Return parse error if there was one, but with partial results
@@ -125,11 +133,12 @@ func (p *ObjCParser) extractSignature(node *sitter.Node, content []byte) string
 
 // findContainingMethod finds the name of the method containing a node
 func (p *ObjCParser) findContainingMethod(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a method declaration or definition
-		if current.Type() == "method_declaration" || current.Type() == "method_definition" {
+		if tree.Type(current) == "method_declaration" || tree.Type(current) == "method_definition" {
 			// Find the matching symbol in our parsed symbols
 			for _, symbol := range parsedFile.Symbols {
 				if symbol.Node == current {
@@ -143,7 +152,7 @@ func (p *ObjCParser) findContainingMethod(node *sitter.Node, parsedFile *ParsedF
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
@@ -844,68 +853,38 @@ func (p *ObjCParser) extractCallRelationships(rootNode *sitter.Node, parsedFile
 
 // extractHeaderDoc extracts header documentation comments
 func (p *ObjCParser) extractHeaderDoc(node *sitter.Node, content []byte) string {
-	if node == nil {
-		return ""
-	}
-
-	// Look for comment nodes before this node
-	parent := node.Parent()
-	if parent == nil {
-		return ""
-	}
-
 	var comments []string
-
-	// Find the index of the current node
-	nodeIndex := -1
-	for i := 0; i < int(parent.ChildCount()); i++ {
-		if parent.Child(i) == node {
-			nodeIndex = i
-			break
-		}
-	}
-
-	if nodeIndex <= 0 {
-		return ""
-	}
-
-	// Look backwards for comments
-	for i := nodeIndex - 1; i >= 0; i-- {
-		sibling := parent.Child(i)
-		if sibling.Type() == "comment" {
-			commentText := sibling.Content(content)
-
-			// Handle documentation comments (/** ... */ or ///)
-			if strings.HasPrefix(commentText, "/**") {
-				commentText = strings.TrimPrefix(commentText, "/**")
-				commentText = strings.TrimSuffix(commentText, "*/")
-				commentText = strings.TrimSpace(commentText)
-
-				// Clean up documentation formatting
-				lines := strings.Split(commentText, "\n")
-				var cleanLines []string
-				for _, line := range lines {
-					line = strings.TrimSpace(line)
-					line = strings.TrimPrefix(line, "*")
-					line = strings.TrimSpace(line)
-					if line != "" {
-						cleanLines = append(cleanLines, line)
-					}
+	for _, comment := range p.comments.precedingComments(node, content, "comment") {
+		commentText := comment.Text
+
+		// Handle documentation comments (/** ... */ or ///)
+		if strings.HasPrefix(commentText, "/**") {
+			commentText = strings.TrimPrefix(commentText, "/**")
+			commentText = strings.TrimSuffix(commentText, "*/")
+			commentText = strings.TrimSpace(commentText)
+
+			// Clean up documentation formatting
+			lines := strings.Split(commentText, "\n")
+			var cleanLines []string
+			for _, line := range lines {
+				line = strings.TrimSpace(line)
+				line = strings.TrimPrefix(line, "*")
+				line = strings.TrimSpace(line)
+				if line != "" {
+					cleanLines = append(cleanLines, line)
 				}
-				commentText = strings.Join(cleanLines, "\n")
-			} else if strings.HasPrefix(commentText, "///") {
-				commentText = strings.TrimPrefix(commentText, "///")
-				commentText = strings.TrimSpace(commentText)
-			} else {
-				// Handle single-line comments
-				commentText = strings.TrimPrefix(commentText, "//")
-				commentText = strings.TrimSpace(commentText)
 			}
-
-			comments = append([]string{commentText}, comments...)
-		} else if sibling.Type() != "comment" {
-			break
+			commentText = strings.Join(cleanLines, "\n")
+		} else if strings.HasPrefix(commentText, "///") {
+			commentText = strings.TrimPrefix(commentText, "///")
+			commentText = strings.TrimSpace(commentText)
+		} else {
+			// Handle single-line comments
+			commentText = strings.TrimPrefix(commentText, "//")
+			commentText = strings.TrimSpace(commentText)
 		}
+
+		comments = append(comments, commentText)
 	}
 
 	return strings.Join(comments, "\n")
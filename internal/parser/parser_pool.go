@@ -1,6 +1,7 @@
 package parser
 
 import (
+	"errors"
 	"fmt"
 	"runtime"
 	"sync"
@@ -12,6 +13,9 @@ type ParserPool struct {
 	tsParser *TreeSitterParser
 	verbose  bool
 	logger   ProgressLogger
+
+	// maxErrorRatio is DefaultMaxErrorRatio; tests lower it to force rejection
+	maxErrorRatio float64
 }
 
 // ProgressLogger defines the interface for progress tracking
@@ -46,9 +50,10 @@ func NewParserPool(workers int, tsParser *TreeSitterParser) *ParserPool {
 	}
 
 	return &ParserPool{
-		workers:  workers,
-		tsParser: tsParser,
-		verbose:  false,
+		workers:       workers,
+		tsParser:      tsParser,
+		verbose:       false,
+		maxErrorRatio: DefaultMaxErrorRatio,
 	}
 }
 
@@ -186,34 +191,65 @@ func (p *ParserPool) worker(id int, jobs <-chan ParseJob, results chan<- ParseRe
 	cParser := NewCParser(workerTSParser)
 	cppParser := NewCppParser(workerTSParser)
 
-	for job := range jobs {
-		file := job.File
+	workerTSParser.SetMaxErrorRatio(p.maxErrorRatio)
 
+	parse := func(file ScannedFile) (*ParsedFile, error) {
 		// Select the appropriate parser based on language
-		var parsedFile *ParsedFile
-		var parseErr error
-
 		switch file.Language {
 		case "Go":
-			parsedFile, parseErr = goParser.Parse(file)
+			return goParser.Parse(file)
 		case "JavaScript", "TypeScript":
-			parsedFile, parseErr = jsParser.Parse(file)
+			return jsParser.Parse(file)
 		case "Python":
-			parsedFile, parseErr = pyParser.Parse(file)
+			return pyParser.Parse(file)
 		case "Kotlin":
-			parsedFile, parseErr = kotlinParser.Parse(file)
+			return kotlinParser.Parse(file)
 		case "Java":
-			parsedFile, parseErr = javaParser.Parse(file)
+			return javaParser.Parse(file)
 		case "Swift":
-			parsedFile, parseErr = swiftParser.Parse(file)
+			return swiftParser.Parse(file)
 		case "Objective-C":
-			parsedFile, parseErr = objcParser.Parse(file)
+			return objcParser.Parse(file)
 		case "C":
-			parsedFile, parseErr = cParser.Parse(file)
+			return cParser.Parse(file)
 		case "C++":
-			parsedFile, parseErr = cppParser.Parse(file)
+			return cppParser.Parse(file)
 		default:
-			parseErr = fmt.Errorf("unsupported language: %s", file.Language)
+			return nil, fmt.Errorf("unsupported language: %s", file.Language)
+		}
+	}
+
+	for job := range jobs {
+		file := job.File
+		parsedFile, parseErr := parse(file)
+
+		// A C-family tree rejected as broken gets one attempt per alternate
+		// grammar; other failures (unreadable file, parser error) are reported
+		// as they are
+		var broken *BrokenTreeError
+		if parsedFile != nil && parsedFile.RootNode == nil && errors.As(parseErr, &broken) {
+			for _, language := range alternateLanguages[file.Language] {
+				retry := file
+				retry.Language = language
+				retried, retryErr := parse(retry)
+				if retried == nil || retried.RootNode == nil {
+					continue
+				}
+				message := fmt.Sprintf("reparsed as %s after: %v", language, parseErr)
+				if detailed, ok := parseErr.(*DetailedParseError); ok {
+					message = fmt.Sprintf("reparsed as %s after: %s", language, detailed.Message)
+				}
+				if retryErr != nil {
+					message += fmt.Sprintf(" (%v)", retryErr)
+				}
+				parsedFile = retried
+				parseErr = &DetailedParseError{File: file.Path, Message: message, Type: "parse"}
+				break
+			}
+		}
+
+		if file.APIOnly && parsedFile != nil {
+			reduceToAPISurface(parsedFile)
 		}
 
 		// Send result
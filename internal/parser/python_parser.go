@@ -70,9 +70,11 @@ func (p *PythonParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		// Non-fatal, continue
 	}
 
-	// Extract call relationships
-	if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
-		// Non-fatal, continue
+	// Extract call relationships (not for API-surface files)
+	if !file.APIOnly {
+		if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
+			// Non-fatal, continue
+		}
 	}
 
 	// Return parse error if there was one, but with partial results
@@ -237,7 +239,7 @@ func (p *PythonParser) extractFunctions(rootNode *sitter.Node, parsedFile *Parse
 
 		if funcNode != nil && funcName != "" {
 			// Skip if this is a method (inside a class)
-			if p.isInsideClass(funcNode) {
+			if p.isInsideClass(funcNode, parsedFile) {
 				continue
 			}
 
@@ -296,7 +298,7 @@ func (p *PythonParser) extractClasses(rootNode *sitter.Node, parsedFile *ParsedF
 
 		if classNode != nil && className != "" {
 			// Skip nested classes
-			if p.isInsideClass(classNode) {
+			if p.isInsideClass(classNode, parsedFile) {
 				continue
 			}
 
@@ -599,13 +601,14 @@ func (p *PythonParser) isAsyncFunction(funcNode *sitter.Node) bool {
 }
 
 // isInsideClass checks if a node is inside a class definition
-func (p *PythonParser) isInsideClass(node *sitter.Node) bool {
-	current := node.Parent()
+func (p *PythonParser) isInsideClass(node *sitter.Node, parsedFile *ParsedFile) bool {
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 	for current != nil {
-		if current.Type() == "class_definition" {
+		if tree.Type(current) == "class_definition" {
 			return true
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 	return false
 }
@@ -653,11 +656,12 @@ func (p *PythonParser) extractCallRelationships(rootNode *sitter.Node, parsedFil
 
 // findContainingFunction finds the name of the function/method containing a node
 func (p *PythonParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a function definition
-		if current.Type() == "function_definition" {
+		if tree.Type(current) == "function_definition" {
 			// Find the matching symbol in our parsed symbols
 			for _, symbol := range parsedFile.Symbols {
 				if symbol.Node == current {
@@ -671,7 +675,7 @@ func (p *PythonParser) findContainingFunction(node *sitter.Node, parsedFile *Par
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
@@ -22,14 +22,16 @@ type ScannedFile struct {
 	AbsPath  string // Absolute path
 	Language string // Detected language
 	Size     int64  // File size in bytes
+	APIOnly  bool   // Index declarations only (see APISurfaceFilter)
 }
 
 // FileScanner scans directories for source files with ignore filter support
 type FileScanner struct {
-	rootPath  string
-	filter    *IgnoreFilter
-	maxSize   int64    // Maximum file size in bytes (0 = no limit)
-	languages []string // Language filter (empty = all languages)
+	rootPath   string
+	filter     *IgnoreFilter
+	apiSurface *APISurfaceFilter // Files indexed for their declarations only (nil = none)
+	maxSize    int64             // Maximum file size in bytes (0 = no limit)
+	languages  []string          // Language filter (empty = all languages)
 }
 
 // NewFileScanner creates a new FileScanner
@@ -51,6 +53,11 @@ func (s *FileScanner) SetLanguageFilter(languages []string) {
 	s.languages = languages
 }
 
+// SetAPISurfaceFilter sets the filter selecting API-surface-only files
+func (s *FileScanner) SetAPISurfaceFilter(filter *APISurfaceFilter) {
+	s.apiSurface = filter
+}
+
 // Scan walks the directory tree and returns all matching files
 func (s *FileScanner) Scan() ([]ScannedFile, error) {
 	var files []ScannedFile
@@ -137,6 +144,7 @@ func (s *FileScanner) Scan() ([]ScannedFile, error) {
 			AbsPath:  absPath,
 			Language: language,
 			Size:     info.Size(),
+			APIOnly:  s.apiSurface.Matches(relPath),
 		}
 
 		files = append(files, scannedFile)
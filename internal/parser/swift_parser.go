@@ -10,8 +10,12 @@ import (
 // SwiftParser parses Swift source code using Tree-sitter
 type SwiftParser struct {
 	tsParser *TreeSitterParser
+	comments *commentIndex // comments of the file being parsed
 }
 
+// swiftCommentKinds are the node types a doc comment run is collected from
+var swiftCommentKinds = []string{"comment", "multiline_comment"}
+
 // NewSwiftParser creates a new Swift parser
 func NewSwiftParser(tsParser *TreeSitterParser) *SwiftParser {
 	return &SwiftParser{
@@ -50,6 +54,10 @@ func (p *SwiftParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		}
 	}
 
+	// Index comments once for docstring lookups
+	p.comments = newCommentIndex(parsedFile.Flat(), swiftCommentKinds...)
+	defer func() { p.comments = nil }()
+
 	// Extract imports
 	if err := p.extractImports(rootNode, parsedFile, content); err != nil {
 		// Non-fatal, continue
@@ -90,9 +98,11 @@ func (p *SwiftParser) Parse(file ScannedFile) (*ParsedFile, error) {
 		// Non-fatal, continue
 	}
 
-	// Extract call relationships
-	if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
-		// Non-fatal, continue
+	// Extract call relationships (not for API-surface files)
+	if !file.APIOnly {
+		if err := p.extractCallRelationships(rootNode, parsedFile, content); err != nil {
+			// Non-fatal, continue
+		}
 	}
 
 	// Return parse error if there was one, but with partial results
@@ -134,11 +144,12 @@ func (p *SwiftParser) extractSignature(node *sitter.Node, content []byte) string
 
 // findContainingFunction finds the name of the function/method containing a node
 func (p *SwiftParser) findContainingFunction(node *sitter.Node, parsedFile *ParsedFile) string {
-	current := node.Parent()
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 
 	for current != nil {
 		// Check if this is a function declaration
-		if current.Type() == "function_declaration" {
+		if tree.Type(current) == "function_declaration" {
 			// Find the matching symbol in our parsed symbols
 			for _, symbol := range parsedFile.Symbols {
 				if symbol.Node == current {
@@ -152,24 +163,25 @@ func (p *SwiftParser) findContainingFunction(node *sitter.Node, parsedFile *Pars
 				}
 			}
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 
 	return ""
 }
 
 // isInsideType checks if a node is inside a class, struct, enum, or protocol definition
-func (p *SwiftParser) isInsideType(node *sitter.Node) bool {
-	current := node.Parent()
+func (p *SwiftParser) isInsideType(node *sitter.Node, parsedFile *ParsedFile) bool {
+	tree := parsedFile.Flat()
+	current := tree.Parent(node)
 	for current != nil {
-		nodeType := current.Type()
+		nodeType := tree.Type(current)
 		if nodeType == "class_declaration" || 
 		   nodeType == "struct_declaration" || 
 		   nodeType == "enum_declaration" || 
 		   nodeType == "protocol_declaration" {
 			return true
 		}
-		current = current.Parent()
+		current = tree.Parent(current)
 	}
 	return false
 }
@@ -641,7 +653,7 @@ func (p *SwiftParser) extractFunctions(rootNode *sitter.Node, parsedFile *Parsed
 
 		if funcNode != nil && funcName != "" {
 			// Skip if this is a method (inside a type)
-			if p.isInsideType(funcNode) {
+			if p.isInsideType(funcNode, parsedFile) {
 				continue
 			}
 
@@ -693,7 +705,7 @@ func (p *SwiftParser) extractProperties(rootNode *sitter.Node, parsedFile *Parse
 
 		if propNode != nil && propName != "" {
 			// Skip if this is inside a type
-			if p.isInsideType(propNode) {
+			if p.isInsideType(propNode, parsedFile) {
 				continue
 			}
 
@@ -1151,68 +1163,38 @@ func (p *SwiftParser) hasPropertyObservers(propNode *sitter.Node, content []byte
 
 // extractSwiftDoc extracts Swift documentation comments
 func (p *SwiftParser) extractSwiftDoc(node *sitter.Node, content []byte) string {
-	if node == nil {
-		return ""
-	}
-
-	// Look for comment nodes before this node
-	parent := node.Parent()
-	if parent == nil {
-		return ""
-	}
-
 	var comments []string
-
-	// Find the index of the current node
-	nodeIndex := -1
-	for i := 0; i < int(parent.ChildCount()); i++ {
-		if parent.Child(i) == node {
-			nodeIndex = i
-			break
-		}
-	}
-
-	if nodeIndex <= 0 {
-		return ""
-	}
-
-	// Look backwards for comments
-	for i := nodeIndex - 1; i >= 0; i-- {
-		sibling := parent.Child(i)
-		if sibling.Type() == "comment" || sibling.Type() == "multiline_comment" {
-			commentText := sibling.Content(content)
-
-			// Handle Swift documentation comments (/// or /** ... */)
-			if strings.HasPrefix(commentText, "///") {
-				commentText = strings.TrimPrefix(commentText, "///")
-				commentText = strings.TrimSpace(commentText)
-			} else if strings.HasPrefix(commentText, "/**") {
-				commentText = strings.TrimPrefix(commentText, "/**")
-				commentText = strings.TrimSuffix(commentText, "*/")
-				commentText = strings.TrimSpace(commentText)
-
-				// Clean up documentation formatting
-				lines := strings.Split(commentText, "\n")
-				var cleanLines []string
-				for _, line := range lines {
-					line = strings.TrimSpace(line)
-					line = strings.TrimPrefix(line, "*")
-					line = strings.TrimSpace(line)
-					if line != "" {
-						cleanLines = append(cleanLines, line)
-					}
+	for _, comment := range p.comments.precedingComments(node, content, swiftCommentKinds...) {
+		commentText := comment.Text
+
+		// Handle Swift documentation comments (/// or /** ... */)
+		if strings.HasPrefix(commentText, "///") {
+			commentText = strings.TrimPrefix(commentText, "///")
+			commentText = strings.TrimSpace(commentText)
+		} else if strings.HasPrefix(commentText, "/**") {
+			commentText = strings.TrimPrefix(commentText, "/**")
+			commentText = strings.TrimSuffix(commentText, "*/")
+			commentText = strings.TrimSpace(commentText)
+
+			// Clean up documentation formatting
+			lines := strings.Split(commentText, "\n")
+			var cleanLines []string
+			for _, line := range lines {
+				line = strings.TrimSpace(line)
+				line = strings.TrimPrefix(line, "*")
+				line = strings.TrimSpace(line)
+				if line != "" {
+					cleanLines = append(cleanLines, line)
 				}
-				commentText = strings.Join(cleanLines, "\n")
-			} else {
-				// Handle single-line comments
-				commentText = strings.TrimPrefix(commentText, "//")
-				commentText = strings.TrimSpace(commentText)
 			}
-
-			comments = append([]string{commentText}, comments...)
-		} else if sibling.Type() != "comment" && sibling.Type() != "multiline_comment" {
-			break
+			commentText = strings.Join(cleanLines, "\n")
+		} else {
+			// Handle single-line comments
+			commentText = strings.TrimPrefix(commentText, "//")
+			commentText = strings.TrimSpace(commentText)
 		}
+
+		comments = append(comments, commentText)
 	}
 
 	return strings.Join(comments, "\n")
@@ -0,0 +1,75 @@
+package parser
+
+import (
+	"fmt"
+
+	sitter "github.com/smacker/go-tree-sitter"
+)
+
+// DefaultMaxErrorRatio is the share of a file inside ERROR nodes above which
+// its tree is rejected: a mislabeled header, a templated .in file or macro
+// soup yields an AST that is mostly error recovery, and the extractors only
+// turn it into garbage symbols for ResolveEdges to chase.
+const DefaultMaxErrorRatio = 0.5
+
+// minJudgedSize is the smallest file whose error ratio is acted on. A single
+// ERROR node dominates the ratio of a short snippet, and short files cost
+// nothing to extract anyway.
+const minJudgedSize = 1024
+
+// SyntaxErrorStats summarizes the error recovery in a parse tree
+type SyntaxErrorStats struct {
+	ErrorNodes   int
+	MissingNodes int
+	ErrorBytes   int     // bytes covered by ERROR nodes
+	ErrorRatio   float64 // ErrorBytes / file size
+}
+
+// BrokenTreeError is returned by TreeSitterParser.Parse instead of a tree when
+// the tree is mostly syntax errors
+type BrokenTreeError struct {
+	Language string
+	Stats    SyntaxErrorStats
+}
+
+func (e *BrokenTreeError) Error() string {
+	return fmt.Sprintf("syntax errors cover %.0f%% of the file as %s (%d ERROR, %d MISSING nodes)",
+		e.Stats.ErrorRatio*100, e.Language, e.Stats.ErrorNodes, e.Stats.MissingNodes)
+}
+
+// measureSyntaxErrors counts the ERROR and MISSING nodes under root. Only
+// subtrees flagged by HasError are visited and ERROR nodes are not descended
+// into, so the cost is bounded by the damaged part of the tree.
+func measureSyntaxErrors(root *sitter.Node, size int) SyntaxErrorStats {
+	var stats SyntaxErrorStats
+	stack := []*sitter.Node{root}
+	for len(stack) > 0 {
+		node := stack[len(stack)-1]
+		stack = stack[:len(stack)-1]
+
+		switch {
+		case node.IsMissing():
+			stats.MissingNodes++
+		case node.Type() == "ERROR":
+			stats.ErrorNodes++
+			stats.ErrorBytes += int(node.EndByte() - node.StartByte())
+		case node.HasError():
+			for i := int(node.ChildCount()) - 1; i >= 0; i-- {
+				stack = append(stack, node.Child(i))
+			}
+		}
+	}
+	if size > 0 {
+		stats.ErrorRatio = float64(stats.ErrorBytes) / float64(size)
+	}
+	return stats
+}
+
+// alternateLanguages lists the grammars a rejected C-family file is retried
+// with, in order. Header extensions are shared, so a .h detected as one of
+// them is often written in another.
+var alternateLanguages = map[string][]string{
+	"C":           {"C++", "Objective-C"},
+	"C++":         {"Objective-C"},
+	"Objective-C": {"C++"},
+}
@@ -0,0 +1,102 @@
+package parser
+
+import (
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+)
+
+func TestParse_RejectsBrokenTree(t *testing.T) {
+	tsParser, err := NewTreeSitterParser()
+	require.NoError(t, err)
+
+	// 生成的宏堆：几乎整个文件都是错误恢复
+	content := []byte(strings.Repeat("@@ ))) ((( ;;; ## }} {{ ::\n", 64))
+	node, err := tsParser.Parse(content, "go")
+	assert.Nil(t, node, "A tree that is mostly ERROR nodes should be rejected")
+	var broken *BrokenTreeError
+	if assert.True(t, errors.As(err, &broken), "Expected BrokenTreeError, got %v", err) {
+		assert.Equal(t, "go", broken.Language)
+		assert.Greater(t, broken.Stats.ErrorRatio, DefaultMaxErrorRatio)
+		assert.Greater(t, broken.Stats.ErrorNodes, 0)
+	}
+
+	// 关闭检查后照常返回带错误的树
+	tsParser.SetMaxErrorRatio(0)
+	node, err = tsParser.Parse(content, "go")
+	assert.NotNil(t, node)
+	if assert.Error(t, err) {
+		assert.Contains(t, err.Error(), "parse tree contains errors")
+	}
+}
+
+func TestParse_SmallBrokenFileKept(t *testing.T) {
+	tsParser, err := NewTreeSitterParser()
+	require.NoError(t, err)
+
+	// 短文件不做判断，保留部分解析结果
+	node, err := tsParser.Parse([]byte("package main\n\nfunc broken( {\n\treturn\n}"), "go")
+	assert.NotNil(t, node)
+	assert.Error(t, err)
+}
+
+func TestMeasureSyntaxErrors_CleanTree(t *testing.T) {
+	tsParser, err := NewTreeSitterParser()
+	require.NoError(t, err)
+
+	content := []byte("package main\n\nfunc main() {}\n")
+	node, err := tsParser.Parse(content, "go")
+	require.NoError(t, err)
+
+	assert.Equal(t, SyntaxErrorStats{}, measureSyntaxErrors(node, len(content)))
+}
+
+func TestParserPool_RetriesAlternateGrammar(t *testing.T) {
+	// 扩展名为 .h、被识别为 C 的 C++ 头文件
+	var b strings.Builder
+	b.WriteString("namespace geometry {\n\n")
+	for i := 0; i < 12; i++ {
+		fmt.Fprintf(&b, "template <typename T>\nclass Shape%d {\npublic:\n    T area() const { return width_ * height_; }\nprivate:\n    T width_;\n    T height_;\n};\n\n", i)
+	}
+	b.WriteString("} // namespace geometry\n")
+
+	tmpDir := t.TempDir()
+	path := filepath.Join(tmpDir, "shapes.h")
+	require.NoError(t, os.WriteFile(path, []byte(b.String()), 0644))
+
+	pool := NewParserPool(1, nil)
+	// 任何错误恢复都拒绝，确保 C 语法的树一定被拒
+	pool.maxErrorRatio = 0.001
+	files, errs := pool.Process([]ScannedFile{{Path: "shapes.h", AbsPath: path, Language: "C"}})
+
+	require.Len(t, files, 1)
+	assert.Equal(t, "cpp", files[0].Language, "Expected the C++ grammar to be used")
+	assert.NotNil(t, files[0].RootNode)
+	assert.NotEmpty(t, files[0].Symbols)
+	if assert.Len(t, errs, 1) {
+		assert.Contains(t, errs[0].Error(), "reparsed as C++")
+	}
+}
+
+func TestCParser_KeepsBrokenTreeError(t *testing.T) {
+	tsParser, err := NewTreeSitterParser()
+	require.NoError(t, err)
+	tsParser.SetMaxErrorRatio(0.001)
+
+	tmpDir := t.TempDir()
+	path := filepath.Join(tmpDir, "macros.h")
+	require.NoError(t, os.WriteFile(path, []byte(strings.Repeat("@@ ))) ((( ;;; ## }} {{ ::\n", 64)), 0644))
+
+	// 只有被判定为损坏的树才换语法重试，因此拒绝原因必须能从错误链中取出
+	parsed, err := NewCParser(tsParser).Parse(ScannedFile{Path: "macros.h", AbsPath: path, Language: "C"})
+	require.NotNil(t, parsed)
+	assert.Nil(t, parsed.RootNode)
+	var broken *BrokenTreeError
+	assert.True(t, errors.As(err, &broken), "Expected BrokenTreeError in the chain, got %v", err)
+}
@@ -46,11 +46,14 @@ type TreeSitterParser struct {
 	objcLang   *sitter.Language
 	cLang      *sitter.Language
 	cppLang    *sitter.Language
+
+	// maxErrorRatio rejects trees that are mostly ERROR nodes (0 disables)
+	maxErrorRatio float64
 }
 
 // NewTreeSitterParser initializes Tree-sitter parsers for all supported languages
 func NewTreeSitterParser() (*TreeSitterParser, error) {
-	tsp := &TreeSitterParser{}
+	tsp := &TreeSitterParser{maxErrorRatio: DefaultMaxErrorRatio}
 
 	// Initialize Go parser
 	tsp.goLang = golang.GetLanguage()
@@ -159,12 +162,25 @@ func (p *TreeSitterParser) Parse(content []byte, language string) (*sitter.Node,
 	// We return the node even if it has errors (partial results)
 	// but indicate the error in the return value
 	if rootNode.HasError() {
+		// A tree that is mostly error recovery is not worth extracting from
+		if p.maxErrorRatio > 0 && len(content) >= minJudgedSize {
+			stats := measureSyntaxErrors(rootNode, len(content))
+			if stats.ErrorRatio > p.maxErrorRatio {
+				return nil, &BrokenTreeError{Language: language, Stats: stats}
+			}
+		}
 		return rootNode, fmt.Errorf("parse tree contains errors")
 	}
 
 	return rootNode, nil
 }
 
+// SetMaxErrorRatio sets the share of a file inside ERROR nodes above which
+// Parse returns a BrokenTreeError instead of the tree (0 disables the check)
+func (p *TreeSitterParser) SetMaxErrorRatio(ratio float64) {
+	p.maxErrorRatio = ratio
+}
+
 // Query executes a Tree-sitter query on the given node and returns matches
 func (p *TreeSitterParser) Query(node *sitter.Node, queryString string, language string) ([]*sitter.QueryMatch, error) {
 	if node == nil {
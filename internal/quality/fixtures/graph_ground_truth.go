@@ -7,7 +7,7 @@
 // 匹配按 (SourceID, EdgeType, TargetID) 三元组进行 symbol_id 精确匹配，由
 // ResolveTruthIDs 在索引 fixture 后从 DB 回填 SourceID/TargetID（解决 C++ 重载同名问题）。
 // SourceName/TargetName 仅保留用于调试日志与符号查找；target 悬空时 TargetID 为空，
-// TargetName 回退到 edges.target_module（对 import 边即模块名）。
+// TargetName 回退到外部模块名（external_modules.name，对 import 边即模块名）。
 //
 // 跨文件符号消解（已修复）：
 //
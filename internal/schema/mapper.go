@@ -40,6 +40,24 @@ type pendingDependency struct {
 	SourceFilePath string
 }
 
+// PreparedFile is a parsed file without its Tree-sitter tree: AST nodes are
+// already mapped and symbols carry no node pointers, so it can be serialized
+// between processes (see PrepareFile / CollectPrepared)
+type PreparedFile struct {
+	FileID       string                    `json:"file_id"`
+	Path         string                    `json:"path"`
+	Language     string                    `json:"language"`
+	Size         int64                     `json:"size"`
+	Checksum     string                    `json:"checksum"`
+	Nodes        []ASTNode                 `json:"nodes"`
+	Symbols      []parser.ParsedSymbol     `json:"symbols"`
+	Dependencies []parser.ParsedDependency `json:"dependencies"`
+	// CanonicalFileID is set on copies made by PrepareCopy
+	CanonicalFileID string `json:"canonical_file_id,omitempty"`
+	// APIOnly is set on files of the API-surface tier (no nodes, no call edges)
+	APIOnly bool `json:"api_only,omitempty"`
+}
+
 // NewSchemaMapper creates a new schema mapper
 func NewSchemaMapper() *SchemaMapper {
 	return &SchemaMapper{
@@ -59,17 +77,79 @@ func (m *SchemaMapper) SetWarnLog(fn func(format string, args ...interface{})) {
 // import relations, pending deps (including imports), external symbols,
 // and AST nodes — but does NOT resolve edges.
 func (m *SchemaMapper) CollectSymbols(parsed *parser.ParsedFile) (*File, error) {
+	return m.CollectPrepared(m.PrepareFile(parsed))
+}
+
+// PrepareFile reduces a parsed file to plain data: the checksum and file ID are
+// computed and the Tree-sitter tree is mapped to AST nodes, after which the tree
+// is no longer referenced. It does not touch mapper state, so a parse shard can
+// run it in another process and hand the result to CollectPrepared.
+func (m *SchemaMapper) PrepareFile(parsed *parser.ParsedFile) *PreparedFile {
 	checksum := utils.SHA256Checksum(parsed.Content)
-	fileID := utils.GenerateDeterministicUUID(fmt.Sprintf("file:%s:%s", parsed.Path, checksum))
+	fileID := fileIDFor(parsed.Path, checksum)
+
+	prepared := &PreparedFile{
+		FileID:       fileID,
+		Path:         parsed.Path,
+		Language:     parsed.Language,
+		Size:         int64(len(parsed.Content)),
+		Checksum:     checksum,
+		Nodes:        []ASTNode{},
+		Symbols:      detachSymbols(parsed.Symbols),
+		Dependencies: parsed.Dependencies,
+		APIOnly:      parsed.APIOnly,
+	}
+
+	// 映射 AST 节点（保持现有逻辑）
+	if parsed.RootNode != nil {
+		prepared.Nodes = m.mapFlatNodes(parsed.Flat(), fileID, "", 0, parsed.Content)
+	}
+
+	return prepared
+}
+
+// PrepareCopy returns the prepared file of another path with the same content
+// as canonical, without parsing it again: it gets its own file ID (and so its
+// own symbol IDs when collected) but shares the symbols and dependencies of
+// canonical, and carries no AST nodes since those are stored once for the
+// canonical file.
+func (m *SchemaMapper) PrepareCopy(canonical *PreparedFile, path string) *PreparedFile {
+	return &PreparedFile{
+		FileID:          fileIDFor(path, canonical.Checksum),
+		Path:            path,
+		Language:        canonical.Language,
+		Size:            canonical.Size,
+		Checksum:        canonical.Checksum,
+		Nodes:           []ASTNode{},
+		Symbols:         canonical.Symbols,
+		Dependencies:    canonical.Dependencies,
+		CanonicalFileID: canonical.FileID,
+		APIOnly:         canonical.APIOnly,
+	}
+}
+
+// fileIDFor derives the deterministic file ID of a path with given content
+func fileIDFor(path, checksum string) string {
+	return utils.GenerateDeterministicUUID(fmt.Sprintf("file:%s:%s", path, checksum))
+}
+
+// CollectPrepared is CollectSymbols for a file already reduced by PrepareFile.
+// Collecting the same prepared files in the same order yields the same
+// candidate set, and therefore the same edges, as collecting the parsed files.
+func (m *SchemaMapper) CollectPrepared(prepared *PreparedFile) (*File, error) {
+	fileID := prepared.FileID
 
 	file := &File{
 		FileID:   fileID,
-		Path:     parsed.Path,
-		Language: parsed.Language,
-		Size:     int64(len(parsed.Content)),
-		Checksum: checksum,
-		Nodes:    []ASTNode{},
+		Path:     prepared.Path,
+		Language: prepared.Language,
+		Size:     prepared.Size,
+		Checksum: prepared.Checksum,
+		Nodes:    prepared.Nodes,
 		Symbols:  []Symbol{},
+
+		CanonicalFileID: prepared.CanonicalFileID,
+		APIOnly:         prepared.APIOnly,
 	}
 
 	// 收集符号到候选集（累积，不覆盖）。
@@ -78,13 +158,13 @@ func (m *SchemaMapper) CollectSymbols(parsed *parser.ParsedFile) (*File, error)
 	// seenIDs 按文件内 symbol_id 去重——部分解析器（如 C++）会把同一方法既作为
 	// 顶层 function 又作为类的 Children(method) 输出，span 一致导致确定性 ID 撞车；
 	// 首次出现的（顶层那条）保留，Children 里的重复条目跳过。
-	seenIDs := make(map[string]bool, len(parsed.Symbols))
-	for _, parsedSymbol := range parsed.Symbols {
-		m.collectSymbolRecursive(parsedSymbol, fileID, parsed.Path, file, seenIDs)
+	seenIDs := make(map[string]bool, len(prepared.Symbols))
+	for _, parsedSymbol := range prepared.Symbols {
+		m.collectSymbolRecursive(parsedSymbol, fileID, prepared.Path, file, seenIDs)
 	}
 
 	// 收集外部模块符号（保持现有逻辑）
-	externalModules := m.collectExternalModules(parsed.Dependencies)
+	externalModules := m.collectExternalModules(prepared.Dependencies)
 	for moduleName := range externalModules {
 		externalSymbol := m.createExternalSymbol(moduleName)
 		m.externalSymbols[moduleName] = &externalSymbol
@@ -92,23 +172,32 @@ func (m *SchemaMapper) CollectSymbols(parsed *parser.ParsedFile) (*File, error)
 	}
 
 	// 收集 import 关系
-	m.collectFileImports(parsed.Dependencies, fileID)
+	m.collectFileImports(prepared.Dependencies, fileID)
 
 	// 收集所有 dep 到 pendingDeps（含 import，第二遍统一解析）
-	for _, dep := range parsed.Dependencies {
+	for _, dep := range prepared.Dependencies {
 		m.pendingDeps = append(m.pendingDeps, pendingDependency{
-			Dep: dep, SourceFileID: fileID, SourceFilePath: parsed.Path,
+			Dep: dep, SourceFileID: fileID, SourceFilePath: prepared.Path,
 		})
 	}
 
-	// 映射 AST 节点（保持现有逻辑）
-	if parsed.RootNode != nil {
-		file.Nodes = m.mapASTNodes(parsed.RootNode, fileID, "", parsed.Content)
-	}
-
 	return file, nil
 }
 
+// detachSymbols copies symbols without their Tree-sitter nodes
+func detachSymbols(symbols []parser.ParsedSymbol) []parser.ParsedSymbol {
+	if symbols == nil {
+		return nil
+	}
+	out := make([]parser.ParsedSymbol, len(symbols))
+	for i, sym := range symbols {
+		sym.Node = nil
+		sym.Children = detachSymbols(sym.Children)
+		out[i] = sym
+	}
+	return out
+}
+
 // collectSymbolRecursive 递归收集符号到候选集和 file.Symbols。
 // 方法/构造器/字段等 Children 符号也作为独立符号加入，使跨文件方法调用边可消解。
 // seenIDs 记录文件内已收录的 symbol_id，跳过重复条目（部分解析器会把同一符号既放
@@ -209,6 +298,7 @@ func (m *SchemaMapper) resolveEdge(pd pendingDependency) *DependencyEdge {
 		EdgeType:   edgeType,
 		SourceFile: pd.SourceFilePath,
 		TargetFile: targetFile,
+		TargetName: dep.Target,
 	}
 }
 
@@ -405,53 +495,63 @@ func (m *SchemaMapper) mapSymbolKind(kind string) SymbolKind {
 	}
 }
 
-// mapASTNodes recursively transforms Tree-sitter nodes into schema.ASTNode
-func (m *SchemaMapper) mapASTNodes(node *sitter.Node, fileID string, parentID string, content []byte) []ASTNode {
+// mapASTNodes transforms the Tree-sitter tree under node into schema.ASTNode,
+// in pre-order
+func (m *SchemaMapper) mapASTNodes(node *sitter.Node, fileID string, parentID string, index int, content []byte) []ASTNode {
 	if node == nil {
 		return nil
 	}
+	return m.mapFlatNodes(parser.FlattenTree(node), fileID, parentID, index, content)
+}
 
-	var nodes []ASTNode
-
-	// Create node for current Tree-sitter node
-	nodeID := utils.GenerateUUID()
-
-	span := Span{
-		StartLine: int(node.StartPoint().Row) + 1,
-		EndLine:   int(node.EndPoint().Row) + 1,
-		StartByte: int(node.StartByte()),
-		EndByte:   int(node.EndByte()),
+// mapFlatNodes is mapASTNodes over a flattened tree: the tree is read from
+// Go-side arrays (see parser.FlatTree) instead of one cgo call per accessor
+// and child
+func (m *SchemaMapper) mapFlatNodes(tree *parser.FlatTree, fileID string, parentID string, index int, content []byte) []ASTNode {
+	if tree.Len() == 0 {
+		return nil
 	}
 
-	// Extract text for small nodes (< 100 bytes)
-	text := ""
-	nodeSize := int(node.EndByte() - node.StartByte())
-	if nodeSize < 100 {
-		text = node.Content(content)
-	}
+	nodes := make([]ASTNode, tree.Len())
+	for i := range nodes {
+		// ID 由 (文件, 父节点, 子序号) 确定：同一内容重复解析得到同一棵 ID 树，
+		// 分片解析与单进程解析的输出逐字节一致
+		nodeParentID, nodeIndex := parentID, index
+		if p := tree.ParentIndex(i); p >= 0 {
+			nodeParentID, nodeIndex = nodes[p].NodeID, tree.ChildIndex(i)
+		}
+		nodeID := utils.GenerateDeterministicUUID(fmt.Sprintf("node:%s:%s:%d", fileID, nodeParentID, nodeIndex))
+
+		startByte, endByte := tree.StartByte(i), tree.EndByte(i)
+		span := Span{
+			StartLine: int(tree.StartPoint(i).Row) + 1,
+			EndLine:   int(tree.EndPoint(i).Row) + 1,
+			StartByte: int(startByte),
+			EndByte:   int(endByte),
+		}
 
-	astNode := ASTNode{
-		NodeID:     nodeID,
-		FileID:     fileID,
-		Type:       node.Type(),
-		Span:       span,
-		ParentID:   parentID,
-		Text:       text,
-		Attributes: make(map[string]string),
-	}
+		// Extract text for small nodes (< 100 bytes)
+		text := ""
+		if endByte-startByte < 100 {
+			text = tree.Content(i, content)
+		}
 
-	// Add node type as attribute
-	if node.IsNamed() {
-		astNode.Attributes["named"] = "true"
-	}
+		astNode := ASTNode{
+			NodeID:     nodeID,
+			FileID:     fileID,
+			Type:       tree.Kind(i),
+			Span:       span,
+			ParentID:   nodeParentID,
+			Text:       text,
+			Attributes: make(map[string]string),
+		}
 
-	nodes = append(nodes, astNode)
+		// Add node type as attribute
+		if tree.IsNamed(i) {
+			astNode.Attributes["named"] = "true"
+		}
 
-	// Recursively process children
-	for i := 0; i < int(node.ChildCount()); i++ {
-		child := node.Child(i)
-		childNodes := m.mapASTNodes(child, fileID, nodeID, content)
-		nodes = append(nodes, childNodes...)
+		nodes[i] = astNode
 	}
 
 	return nodes
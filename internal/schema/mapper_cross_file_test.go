@@ -1,6 +1,7 @@
 package schema
 
 import (
+	"encoding/json"
 	"testing"
 
 	"github.com/stretchr/testify/assert"
@@ -237,3 +238,126 @@ func TestResolveEdges_MapEdgeType_ImplementsDeclaration(t *testing.T) {
 	assert.Equal(t, fileAOut.Symbols[1].SymbolID, edge.TargetID, "TargetID 应为 decl")
 	assert.NotEmpty(t, edge.TargetID, "target_id 不应为空")
 }
+
+// TestCollectPrepared_MatchesCollectSymbols 验证经 PrepareFile → JSON → CollectPrepared
+// （分片解析的跨进程路径）得到的文件与边，与直接 CollectSymbols 完全一致。
+func TestCollectPrepared_MatchesCollectSymbols(t *testing.T) {
+	files := []*parser.ParsedFile{
+		makeParsedFile("a.kt", "kotlin",
+			[]parser.ParsedSymbol{
+				{Name: "Service", Kind: "class", Span: spanOf(1, 0), Children: []parser.ParsedSymbol{
+					{Name: "run", Kind: "method", Span: spanOf(2, 10)},
+				}},
+			},
+			[]parser.ParsedDependency{
+				{Type: "import", Source: "a.kt", Target: "okhttp3", TargetModule: "okhttp3", IsExternal: true},
+				{Type: "call", Source: "run", Target: "helper"},
+			},
+		),
+		makeParsedFile("b.kt", "kotlin",
+			[]parser.ParsedSymbol{
+				{Name: "helper", Kind: "function", Span: spanOf(1, 0)},
+			},
+			[]parser.ParsedDependency{
+				{Type: "call", Source: "helper", Target: "run"},
+			},
+		),
+	}
+
+	direct := NewSchemaMapper()
+	var directFiles []*File
+	for _, f := range files {
+		out, err := direct.CollectSymbols(f)
+		require.NoError(t, err)
+		directFiles = append(directFiles, out)
+	}
+	directEdges, err := direct.ResolveEdges()
+	require.NoError(t, err)
+
+	viaShard := NewSchemaMapper()
+	var shardFiles []*File
+	for _, f := range files {
+		data, err := json.Marshal(viaShard.PrepareFile(f))
+		require.NoError(t, err)
+		var prepared PreparedFile
+		require.NoError(t, json.Unmarshal(data, &prepared))
+
+		out, err := viaShard.CollectPrepared(&prepared)
+		require.NoError(t, err)
+		shardFiles = append(shardFiles, out)
+	}
+	shardEdges, err := viaShard.ResolveEdges()
+	require.NoError(t, err)
+
+	assert.Equal(t, directFiles, shardFiles)
+	assert.Equal(t, directEdges, shardEdges)
+	assert.Len(t, shardFiles[0].Symbols, 2, "Children 应随 PreparedFile 一起传递")
+}
+
+// TestPrepareCopy 验证内容相同的副本不重新解析：拥有自己的 file_id/symbol_id 与路径，
+// 共享规范文件的符号，不带 AST 节点，并记录规范文件 ID。
+func TestPrepareCopy(t *testing.T) {
+	canonicalFile := makeParsedFile("third_party/x/util.kt", "kotlin",
+		[]parser.ParsedSymbol{
+			{Name: "helper", Kind: "function", Span: spanOf(1, 0)},
+		},
+		[]parser.ParsedDependency{
+			{Type: "call", Source: "helper", Target: "run"},
+		},
+	)
+
+	mapper := NewSchemaMapper()
+	canonical := mapper.PrepareFile(canonicalFile)
+	copied := mapper.PrepareCopy(canonical, "android/x/util.kt")
+
+	canonicalOut, err := mapper.CollectPrepared(canonical)
+	require.NoError(t, err)
+	copyOut, err := mapper.CollectPrepared(copied)
+	require.NoError(t, err)
+
+	assert.Equal(t, "android/x/util.kt", copyOut.Path)
+	assert.Equal(t, canonical.Checksum, copyOut.Checksum)
+	assert.NotEqual(t, canonicalOut.FileID, copyOut.FileID)
+	assert.Equal(t, canonicalOut.FileID, copyOut.CanonicalFileID)
+	assert.Empty(t, canonicalOut.CanonicalFileID)
+	assert.Empty(t, copyOut.Nodes)
+	require.Len(t, copyOut.Symbols, 1)
+	assert.Equal(t, "helper", copyOut.Symbols[0].Name)
+	assert.NotEqual(t, canonicalOut.Symbols[0].SymbolID, copyOut.Symbols[0].SymbolID)
+}
+
+// TestResolveEdges_APISurfaceTarget 验证 API 表面层文件（无调用边、无 AST）的符号
+// 仍作为候选，第一方代码对它的调用可以消解。
+func TestResolveEdges_APISurfaceTarget(t *testing.T) {
+	mapper := NewSchemaMapper()
+
+	caller := makeParsedFile("src/main.go", "go",
+		[]parser.ParsedSymbol{
+			{Name: "main", Kind: "function", Span: spanOf(1, 0)},
+		},
+		[]parser.ParsedDependency{
+			{Type: "call", Source: "main", Target: "Compress"},
+		},
+	)
+	vendored := makeParsedFile("third_party/zlib/zlib.go", "go",
+		[]parser.ParsedSymbol{
+			{Name: "Compress", Kind: "function", Span: spanOf(1, 0)},
+		},
+		nil,
+	)
+	vendored.APIOnly = true
+
+	_, err := mapper.CollectSymbols(caller)
+	require.NoError(t, err)
+	vendoredOut, err := mapper.CollectSymbols(vendored)
+	require.NoError(t, err)
+	assert.True(t, vendoredOut.APIOnly)
+	assert.Empty(t, vendoredOut.Nodes)
+
+	edges, err := mapper.ResolveEdges()
+	require.NoError(t, err)
+
+	callEdge, ok := findEdge(edges, EdgeCall)
+	require.True(t, ok, "应存在 call 边")
+	assert.Equal(t, vendoredOut.Symbols[0].SymbolID, callEdge.TargetID, "TargetID 应消解到 API 表面层的符号")
+}
@@ -330,7 +330,7 @@ func main() {
 	mapper := NewSchemaMapper()
 	fileID := "test-file-id"
 
-	nodes := mapper.mapASTNodes(rootNode, fileID, "", content)
+	nodes := mapper.mapASTNodes(rootNode, fileID, "", 0, content)
 
 	if len(nodes) == 0 {
 		t.Fatal("Expected AST nodes, got none")
@@ -372,6 +372,41 @@ func main() {
 	}
 }
 
+func TestMapASTNodesDeterministicIDs(t *testing.T) {
+	tsParser := sitter.NewParser()
+	tsParser.SetLanguage(golang.GetLanguage())
+
+	content := []byte("package main\n\nfunc a() {}\n\nfunc b() { a() }\n")
+	tree := tsParser.Parse(nil, content)
+	if tree == nil {
+		t.Fatal("Failed to parse: tree is nil")
+	}
+	defer tree.Close()
+
+	mapper := NewSchemaMapper()
+	first := mapper.mapASTNodes(tree.RootNode(), "test-file", "", 0, content)
+	second := mapper.mapASTNodes(tree.RootNode(), "test-file", "", 0, content)
+
+	if len(first) != len(second) {
+		t.Fatalf("Expected %d nodes on second run, got %d", len(first), len(second))
+	}
+	seen := make(map[string]bool, len(first))
+	for i := range first {
+		if first[i].NodeID != second[i].NodeID {
+			t.Errorf("Node %d: ID changed between runs (%s vs %s)", i, first[i].NodeID, second[i].NodeID)
+		}
+		if seen[first[i].NodeID] {
+			t.Errorf("Duplicate node ID %s", first[i].NodeID)
+		}
+		seen[first[i].NodeID] = true
+	}
+
+	other := mapper.mapASTNodes(tree.RootNode(), "other-file", "", 0, content)
+	if other[0].NodeID == first[0].NodeID {
+		t.Error("Node IDs should differ between files")
+	}
+}
+
 func TestMapASTNodesWithSmallText(t *testing.T) {
 	tsParser := sitter.NewParser()
 	lang := golang.GetLanguage()
@@ -395,7 +430,7 @@ func TestMapASTNodesWithSmallText(t *testing.T) {
 	}
 	mapper := NewSchemaMapper()
 
-	nodes := mapper.mapASTNodes(rootNode, "test-file", "", content)
+	nodes := mapper.mapASTNodes(rootNode, "test-file", "", 0, content)
 
 	// Find a small node with text
 	foundSmallNode := false
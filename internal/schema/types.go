@@ -48,6 +48,13 @@ type File struct {
 	Checksum string    `json:"checksum"`
 	Nodes    []ASTNode `json:"nodes"`
 	Symbols  []Symbol  `json:"symbols"`
+	// CanonicalFileID 非空表示本文件与另一路径内容相同（如 vendored 副本）：
+	// 只解析一次，副本保留自己的路径与符号，不带 AST 节点，也不单独生成向量，
+	// AST 与向量以规范文件为准。
+	CanonicalFileID string `json:"canonical_file_id,omitempty"`
+	// APIOnly 表示本文件属于 API 表面层（第三方 / vendored 代码）：只提取声明，
+	// 不含调用边与 AST 节点，也不生成向量；其符号仍参与 ResolveEdges 候选查找。
+	APIOnly bool `json:"api_only,omitempty"`
 }
 
 // Symbol represents a high-level code entity
@@ -109,6 +116,7 @@ type DependencyEdge struct {
 	SourceFile   string   `json:"source_file"`
 	TargetFile   string   `json:"target_file,omitempty"`
 	TargetModule string   `json:"target_module,omitempty"`
+	TargetName   string   `json:"target_name,omitempty"` // Bare target name, kept so the edge can be re-resolved later
 }
 
 // EdgeType represents the type of relationship between symbols
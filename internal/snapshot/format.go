@@ -0,0 +1,90 @@
+// Package snapshot 提供离线快照：把一次解析结果写成单个自描述的二进制文件，
+// CLI 在没有 PostgreSQL / API server 的环境（笔记本、隔离 CI）里也能直接
+// mmap 打开并回答 impact/search/ask 查询。
+//
+// 文件布局（小端序，每个 section 8 字节对齐）：
+//
+//	header   : magic(8) | version(u32) | sectionCount(u32)
+//	directory: sectionCount × { id(u32) | reserved(u32) | offset(u64) | length(u64) }
+//	sections : strings | symbols | calls_out | calls_in | keywords | vectors | meta
+//
+// 所有表都是列式的定长 u32 数组，字符串统一进字符串表、以下标引用；
+// 调用图以 CSR（offsets + targets）双向存储。读取端只在访问时按需解码，
+// 常驻内存由 page cache 承担而非 Go 堆。
+package snapshot
+
+import "errors"
+
+// Magic 是快照文件头的魔数。
+const Magic = "CATLSNAP"
+
+// FormatVersion 是当前快照格式版本；读取端拒绝不认识的版本。
+const FormatVersion uint32 = 1
+
+// section 标识。新增 section 只能追加，不能改已有编号。
+const (
+	sectionStrings  uint32 = 1
+	sectionSymbols  uint32 = 2
+	sectionCallsOut uint32 = 3
+	sectionCallsIn  uint32 = 4
+	sectionKeywords uint32 = 5
+	sectionVectors  uint32 = 6
+	sectionMeta     uint32 = 7
+)
+
+const (
+	headerSize   = 16
+	dirEntrySize = 24
+)
+
+// symbols section 的列顺序（每列 count 个 u32）。
+const (
+	colID = iota
+	colName
+	colKind
+	colSignature
+	colDocstring
+	colFilePath
+	colLanguage
+	colStartLine
+	colEndLine
+	symbolColumns
+)
+
+var (
+	// ErrBadMagic 表示文件不是快照（或已损坏）。
+	ErrBadMagic = errors.New("snapshot: bad magic")
+	// ErrUnsupportedVersion 表示快照由更新/更旧的不兼容版本写出。
+	ErrUnsupportedVersion = errors.New("snapshot: unsupported format version")
+	// ErrCorrupt 表示 section 越界或结构不一致。
+	ErrCorrupt = errors.New("snapshot: corrupt file")
+	// ErrSymbolNotFound 表示快照里没有该 symbol_id。
+	ErrSymbolNotFound = errors.New("snapshot: symbol not found")
+)
+
+// Meta 是快照的描述信息（meta section 以 JSON 存储）。
+type Meta struct {
+	FormatVersion uint32 `json:"format_version"`
+	RepoID        string `json:"repo_id,omitempty"`
+	RepoName      string `json:"repo_name,omitempty"`
+	CommitHash    string `json:"commit_hash,omitempty"`
+	CreatedAt     string `json:"created_at"`
+	SymbolCount   int    `json:"symbol_count"`
+	CallEdgeCount int    `json:"call_edge_count"`
+	TermCount     int    `json:"term_count"`
+	VectorCount   int    `json:"vector_count"`
+	VectorDim     int    `json:"vector_dim,omitempty"`
+}
+
+// Symbol 是从快照解码出的符号视图。
+type Symbol struct {
+	SymbolID  string
+	Name      string
+	Kind      string
+	Signature string
+	Docstring string
+	FilePath  string
+	Language  string
+	StartLine int
+	EndLine   int
+}
@@ -0,0 +1,18 @@
+//go:build !unix
+
+package snapshot
+
+import (
+	"fmt"
+	"io"
+	"os"
+)
+
+// mapFile 在不支持 mmap 的平台上退化为整文件读入内存。
+func mapFile(f *os.File, size int) ([]byte, func() error, error) {
+	data := make([]byte, size)
+	if _, err := io.ReadFull(f, data); err != nil {
+		return nil, nil, fmt.Errorf("failed to read snapshot: %w", err)
+	}
+	return data, func() error { return nil }, nil
+}
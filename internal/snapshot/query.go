@@ -0,0 +1,249 @@
+package snapshot
+
+import (
+	"container/heap"
+	"math"
+	"sort"
+	"strings"
+
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+// Reachable 是多跳可达查询的单条结果，语义与 models.ReachableSymbol 一致。
+type Reachable struct {
+	Symbol
+	// Depth 是相对起始符号的最短跳数（直接相邻为 1）。
+	Depth int
+}
+
+// Transitive 沿 call 边做 BFS，返回从 symbolID 出发可达的符号。
+//
+// direction 为 "callers" 时沿反向边（谁调用了它），否则沿正向边（它调用了谁）。
+// 深度默认/上限与 API 侧保持一致（models.DefaultTransitiveDepth / MaxTransitiveDepth）。
+// 结果按 depth、name 排序，起始符号自身不在结果中。
+func (s *Snapshot) Transitive(symbolID, direction string, maxDepth int) ([]Reachable, int, error) {
+	if maxDepth <= 0 {
+		maxDepth = models.DefaultTransitiveDepth
+	}
+	if maxDepth > models.MaxTransitiveDepth {
+		maxDepth = models.MaxTransitiveDepth
+	}
+
+	start, ok := s.Lookup(symbolID)
+	if !ok {
+		return nil, maxDepth, ErrSymbolNotFound
+	}
+
+	graph := s.callsOut
+	if direction == "callers" {
+		graph = s.callsIn
+	}
+
+	depthOf := map[int]int{start: 0}
+	frontier := []int{start}
+	var order []int
+	for depth := 1; depth <= maxDepth && len(frontier) > 0; depth++ {
+		var next []int
+		for _, node := range frontier {
+			row := graph.row(node)
+			for j := 0; j < len(row)/4; j++ {
+				n := int(u32(row, j))
+				if _, seen := depthOf[n]; seen {
+					continue
+				}
+				depthOf[n] = depth
+				order = append(order, n)
+				next = append(next, n)
+			}
+		}
+		frontier = next
+	}
+
+	results := make([]Reachable, 0, len(order))
+	for _, idx := range order {
+		results = append(results, Reachable{Symbol: s.Symbol(idx), Depth: depthOf[idx]})
+	}
+	sort.SliceStable(results, func(i, j int) bool {
+		if results[i].Depth != results[j].Depth {
+			return results[i].Depth < results[j].Depth
+		}
+		return results[i].Name < results[j].Name
+	})
+	return results, maxDepth, nil
+}
+
+// Neighbors 返回 1 跳 callers 或 callees（最多 limit 个，limit<=0 不限）。
+func (s *Snapshot) Neighbors(idx int, direction string, limit int) []Symbol {
+	graph := s.callsOut
+	if direction == "callers" {
+		graph = s.callsIn
+	}
+	row := graph.row(idx)
+	n := len(row) / 4
+	if limit > 0 && n > limit {
+		n = limit
+	}
+	out := make([]Symbol, 0, n)
+	for j := 0; j < n; j++ {
+		out = append(out, s.Symbol(int(u32(row, j))))
+	}
+	return out
+}
+
+// Filters 是检索过滤条件。快照只含单个仓库，因此没有 repo 过滤。
+type Filters struct {
+	Language string
+	Kind     []string
+	Limit    int
+}
+
+func (f Filters) match(s *Snapshot, idx int) bool {
+	if f.Language != "" && !strings.EqualFold(s.str(s.col(colLanguage, idx)), f.Language) {
+		return false
+	}
+	if len(f.Kind) > 0 {
+		kind := s.str(s.col(colKind, idx))
+		for _, k := range f.Kind {
+			if k == kind {
+				return true
+			}
+		}
+		return false
+	}
+	return true
+}
+
+func (f Filters) limit() int {
+	if f.Limit <= 0 {
+		return 10
+	}
+	return f.Limit
+}
+
+// Hit 是检索命中，Score 归一化到 [0,1]。
+type Hit struct {
+	Symbol
+	Index int
+	Score float64
+}
+
+// KeywordSearch 在倒排索引上做词项匹配打分。
+//
+// 每个查询词命中符号名记 1 分、命中签名/文档记 0.5 分，总分除以查询词数归一化；
+// 查询整体与符号名完全相同（忽略大小写）时直接记满分。
+func (s *Snapshot) KeywordSearch(query string, f Filters) []Hit {
+	terms := tokenize(query)
+	if len(terms) == 0 {
+		return nil
+	}
+	// 完整小写形式只参与精确名匹配，不计入分母
+	whole := strings.ToLower(strings.TrimSpace(query))
+
+	scores := make(map[int]float64)
+	queryTerms := 0
+	for _, t := range terms {
+		if t == whole && len(terms) > 1 {
+			continue
+		}
+		queryTerms++
+		ti, ok := s.findTerm(t)
+		if !ok {
+			continue
+		}
+		row := s.postings.row(ti)
+		for j := 0; j < len(row)/4; j++ {
+			v := u32(row, j)
+			idx := int(v &^ nameTermFlag)
+			if v&nameTermFlag != 0 {
+				scores[idx] += 1
+			} else {
+				scores[idx] += 0.5
+			}
+		}
+	}
+	if queryTerms == 0 {
+		queryTerms = 1
+	}
+
+	h := &hitHeap{}
+	limit := f.limit()
+	for idx, score := range scores {
+		if !f.match(s, idx) {
+			continue
+		}
+		score /= float64(queryTerms)
+		if strings.EqualFold(s.str(s.col(colName, idx)), whole) {
+			score = 1
+		}
+		h.offer(Hit{Index: idx, Score: math.Min(score, 1)}, limit)
+	}
+	return s.finish(h)
+}
+
+// VectorSearch 在归一化向量上做暴力点积（flat index），返回 Top-K。
+// embedding 维度与快照不一致时返回 nil。
+func (s *Snapshot) VectorSearch(embedding []float32, f Filters) []Hit {
+	if !s.HasVectors() || len(embedding) != s.vecDim {
+		return nil
+	}
+	query := normalize(embedding)
+
+	h := &hitHeap{}
+	limit := f.limit()
+	for i := 0; i < s.vecCount; i++ {
+		idx := int(u32(s.vecSyms, i))
+		if !f.match(s, idx) {
+			continue
+		}
+		row := s.vecData[4*i*s.vecDim : 4*(i+1)*s.vecDim]
+		var dot float64
+		for j, q := range query {
+			dot += float64(q) * float64(math.Float32frombits(u32(row, j)))
+		}
+		h.offer(Hit{Index: idx, Score: dot}, limit)
+	}
+	return s.finish(h)
+}
+
+// finish 把堆里的 Top-K 按分数降序展开并解码符号。
+func (s *Snapshot) finish(h *hitHeap) []Hit {
+	hits := make([]Hit, h.Len())
+	for i := len(hits) - 1; i >= 0; i-- {
+		hits[i] = heap.Pop(h).(Hit)
+	}
+	for i := range hits {
+		hits[i].Symbol = s.Symbol(hits[i].Index)
+	}
+	return hits
+}
+
+// hitHeap 是按 Score 的小顶堆，维持 Top-K。分数相同时按下标稳定排序。
+type hitHeap []Hit
+
+func (h hitHeap) Len() int { return len(h) }
+func (h hitHeap) Less(i, j int) bool {
+	if h[i].Score != h[j].Score {
+		return h[i].Score < h[j].Score
+	}
+	return h[i].Index > h[j].Index
+}
+func (h hitHeap) Swap(i, j int)       { h[i], h[j] = h[j], h[i] }
+func (h *hitHeap) Push(x interface{}) { *h = append(*h, x.(Hit)) }
+func (h *hitHeap) Pop() interface{} {
+	old := *h
+	x := old[len(old)-1]
+	*h = old[:len(old)-1]
+	return x
+}
+
+func (h *hitHeap) offer(hit Hit, limit int) {
+	if h.Len() < limit {
+		heap.Push(h, hit)
+		return
+	}
+	top := (*h)[0]
+	if hit.Score > top.Score || (hit.Score == top.Score && hit.Index < top.Index) {
+		(*h)[0] = hit
+		heap.Fix(h, 0)
+	}
+}
@@ -0,0 +1,313 @@
+package snapshot
+
+import (
+	"encoding/binary"
+	"encoding/json"
+	"fmt"
+	"os"
+	"sort"
+)
+
+// Snapshot 是一个已打开（mmap）的快照。所有访问器都直接在映射内存上解码，
+// 不把整张表物化到 Go 堆；并发只读安全。
+type Snapshot struct {
+	data    []byte
+	release func() error
+	meta    Meta
+
+	strCount   int
+	strOffsets []byte
+	strBlob    []byte
+
+	symCount int
+	symCols  []byte
+
+	callsOut csr
+	callsIn  csr
+
+	termCount int
+	termIDs   []byte
+	postings  csr
+
+	vecDim   int
+	vecCount int
+	vecSyms  []byte
+	vecData  []byte
+}
+
+// csr 是映射内存上的压缩邻接表视图。
+type csr struct {
+	rows    int
+	offsets []byte
+	values  []byte
+}
+
+func (c csr) row(i int) []byte {
+	start := u32(c.offsets, i)
+	end := u32(c.offsets, i+1)
+	return c.values[4*start : 4*end]
+}
+
+// Open 打开并校验快照文件。调用方用完需 Close。
+func Open(path string) (*Snapshot, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return nil, fmt.Errorf("failed to open snapshot: %w", err)
+	}
+	defer f.Close()
+
+	info, err := f.Stat()
+	if err != nil {
+		return nil, fmt.Errorf("failed to stat snapshot: %w", err)
+	}
+	data, release, err := mapFile(f, int(info.Size()))
+	if err != nil {
+		return nil, err
+	}
+
+	s, err := parse(data)
+	if err != nil {
+		release()
+		return nil, err
+	}
+	s.release = release
+	return s, nil
+}
+
+// Close 解除映射。Close 之后不得再访问 Snapshot。
+func (s *Snapshot) Close() error {
+	if s.release == nil {
+		return nil
+	}
+	err := s.release()
+	s.release = nil
+	s.data = nil
+	return err
+}
+
+// parse 校验文件头和目录，建立各 section 的切片视图（不拷贝）。
+// 所有偏移和下标在这里检查一遍（单遍线性扫描），之后的访问器不再做边界检查，
+// 因此任何能打开的文件都不会在查询时越界。
+func parse(data []byte) (*Snapshot, error) {
+	if len(data) < headerSize || string(data[:8]) != Magic {
+		return nil, ErrBadMagic
+	}
+	if v := binary.LittleEndian.Uint32(data[8:]); v != FormatVersion {
+		return nil, fmt.Errorf("%w: %d", ErrUnsupportedVersion, v)
+	}
+	count := int(binary.LittleEndian.Uint32(data[12:]))
+	if headerSize+count*dirEntrySize > len(data) {
+		return nil, ErrCorrupt
+	}
+
+	sections := make(map[uint32][]byte, count)
+	for i := 0; i < count; i++ {
+		entry := data[headerSize+i*dirEntrySize:]
+		id := binary.LittleEndian.Uint32(entry[0:])
+		off := binary.LittleEndian.Uint64(entry[8:])
+		length := binary.LittleEndian.Uint64(entry[16:])
+		if off > uint64(len(data)) || length > uint64(len(data))-off {
+			return nil, ErrCorrupt
+		}
+		sections[id] = data[off : off+length]
+	}
+
+	s := &Snapshot{data: data}
+	if err := json.Unmarshal(sections[sectionMeta], &s.meta); err != nil {
+		return nil, fmt.Errorf("%w: invalid meta: %v", ErrCorrupt, err)
+	}
+
+	// strings: count | offsets[count+1] | blob
+	strs := sections[sectionStrings]
+	if len(strs) < 4 {
+		return nil, ErrCorrupt
+	}
+	s.strCount = int(u32(strs, 0))
+	if len(strs) < 4+4*(s.strCount+1) {
+		return nil, ErrCorrupt
+	}
+	s.strOffsets = strs[4 : 4+4*(s.strCount+1)]
+	s.strBlob = strs[4+4*(s.strCount+1):]
+	if !validOffsets(s.strOffsets, s.strCount, len(s.strBlob)) {
+		return nil, ErrCorrupt
+	}
+
+	// symbols: count | columns
+	syms := sections[sectionSymbols]
+	if len(syms) < 4 {
+		return nil, ErrCorrupt
+	}
+	s.symCount = int(u32(syms, 0))
+	if len(syms) < 4+4*s.symCount*symbolColumns {
+		return nil, ErrCorrupt
+	}
+	s.symCols = syms[4:]
+
+	var err error
+	if s.callsOut, err = parseCSR(sections[sectionCallsOut], s.symCount, 0); err != nil {
+		return nil, err
+	}
+	if s.callsIn, err = parseCSR(sections[sectionCallsIn], s.symCount, 0); err != nil {
+		return nil, err
+	}
+	if s.callsOut.rows != s.symCount || s.callsIn.rows != s.symCount {
+		return nil, ErrCorrupt
+	}
+
+	// keywords: termCount | termIDs | CSR
+	kw := sections[sectionKeywords]
+	if len(kw) < 4 {
+		return nil, ErrCorrupt
+	}
+	s.termCount = int(u32(kw, 0))
+	if len(kw) < 4+4*s.termCount {
+		return nil, ErrCorrupt
+	}
+	s.termIDs = kw[4 : 4+4*s.termCount]
+	if !validIndexes(s.termIDs, s.strCount, 0) {
+		return nil, ErrCorrupt
+	}
+	if s.postings, err = parseCSR(kw[4+4*s.termCount:], s.symCount, nameTermFlag); err != nil {
+		return nil, err
+	}
+	if s.postings.rows != s.termCount {
+		return nil, ErrCorrupt
+	}
+
+	// vectors: dim | count | symIdx[count] | data[count*dim]
+	vec := sections[sectionVectors]
+	if len(vec) < 8 {
+		return nil, ErrCorrupt
+	}
+	s.vecDim = int(u32(vec, 0))
+	s.vecCount = int(u32(vec, 1))
+	if len(vec) < 8+4*s.vecCount+4*s.vecCount*s.vecDim {
+		return nil, ErrCorrupt
+	}
+	s.vecSyms = vec[8 : 8+4*s.vecCount]
+	s.vecData = vec[8+4*s.vecCount:]
+	if !validIndexes(s.vecSyms, s.symCount, 0) {
+		return nil, ErrCorrupt
+	}
+
+	return s, nil
+}
+
+// parseCSR 建立 CSR 视图，并校验偏移与值：值（去掉 flags 位后）必须小于 limit。
+func parseCSR(buf []byte, limit int, flags uint32) (csr, error) {
+	if len(buf) < 4 {
+		return csr{}, ErrCorrupt
+	}
+	rows := int(u32(buf, 0))
+	if len(buf) < 4+4*(rows+1) {
+		return csr{}, ErrCorrupt
+	}
+	c := csr{
+		rows:    rows,
+		offsets: buf[4 : 4+4*(rows+1)],
+		values:  buf[4+4*(rows+1):],
+	}
+	if !validOffsets(c.offsets, rows, len(c.values)/4) {
+		return csr{}, ErrCorrupt
+	}
+	if !validIndexes(c.values[:4*u32(c.offsets, rows)], limit, flags) {
+		return csr{}, ErrCorrupt
+	}
+	return c, nil
+}
+
+// validOffsets 检查 n+1 个偏移单调不减且不超过 limit。
+func validOffsets(offsets []byte, n, limit int) bool {
+	prev := uint32(0)
+	for i := 0; i <= n; i++ {
+		off := u32(offsets, i)
+		if off < prev {
+			return false
+		}
+		prev = off
+	}
+	return int(prev) <= limit
+}
+
+// validIndexes 检查 buf 中每个 u32（去掉 flags 位后）都小于 limit。
+func validIndexes(buf []byte, limit int, flags uint32) bool {
+	for i := 0; i < len(buf)/4; i++ {
+		if int(u32(buf, i)&^flags) >= limit {
+			return false
+		}
+	}
+	return true
+}
+
+// Meta 返回快照描述信息。
+func (s *Snapshot) Meta() Meta {
+	return s.meta
+}
+
+// SymbolCount 返回符号总数。
+func (s *Snapshot) SymbolCount() int {
+	return s.symCount
+}
+
+// HasVectors 报告快照是否带向量索引。
+func (s *Snapshot) HasVectors() bool {
+	return s.vecCount > 0 && s.vecDim > 0
+}
+
+// Symbol 解码第 i 个符号。
+func (s *Snapshot) Symbol(i int) Symbol {
+	return Symbol{
+		SymbolID:  s.str(s.col(colID, i)),
+		Name:      s.str(s.col(colName, i)),
+		Kind:      s.str(s.col(colKind, i)),
+		Signature: s.str(s.col(colSignature, i)),
+		Docstring: s.str(s.col(colDocstring, i)),
+		FilePath:  s.str(s.col(colFilePath, i)),
+		Language:  s.str(s.col(colLanguage, i)),
+		StartLine: int(s.col(colStartLine, i)),
+		EndLine:   int(s.col(colEndLine, i)),
+	}
+}
+
+// Lookup 按 symbol_id 二分查找符号下标（符号按 symbol_id 排序写入）。
+func (s *Snapshot) Lookup(symbolID string) (int, bool) {
+	i := sort.Search(s.symCount, func(i int) bool {
+		return string(s.strBytes(s.col(colID, i))) >= symbolID
+	})
+	if i < s.symCount && string(s.strBytes(s.col(colID, i))) == symbolID {
+		return i, true
+	}
+	return 0, false
+}
+
+// col 读取 symbols 表第 c 列第 row 行的原始 u32。
+func (s *Snapshot) col(c, row int) uint32 {
+	return u32(s.symCols, c*s.symCount+row)
+}
+
+func (s *Snapshot) strBytes(idx uint32) []byte {
+	if int(idx) >= s.strCount {
+		return nil
+	}
+	return s.strBlob[u32(s.strOffsets, int(idx)):u32(s.strOffsets, int(idx)+1)]
+}
+
+func (s *Snapshot) str(idx uint32) string {
+	return string(s.strBytes(idx))
+}
+
+// findTerm 在有序词表上二分查找，返回词项下标。
+func (s *Snapshot) findTerm(term string) (int, bool) {
+	i := sort.Search(s.termCount, func(i int) bool {
+		return string(s.strBytes(u32(s.termIDs, i))) >= term
+	})
+	if i < s.termCount && string(s.strBytes(u32(s.termIDs, i))) == term {
+		return i, true
+	}
+	return 0, false
+}
+
+// u32 读取 buf 中第 i 个小端 u32。
+func u32(buf []byte, i int) uint32 {
+	return binary.LittleEndian.Uint32(buf[4*i:])
+}
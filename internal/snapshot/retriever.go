@@ -0,0 +1,140 @@
+package snapshot
+
+import (
+	"context"
+	"sort"
+
+	"github.com/yourtionguo/CodeAtlas/internal/indexer"
+	"github.com/yourtionguo/CodeAtlas/internal/retrieval"
+)
+
+// 编译期断言：快照检索器可直接替换 HybridRetriever 供 qa.Service 使用。
+var _ retrieval.Retriever = (*Retriever)(nil)
+
+// Retriever 在快照上实现 retrieval.Retriever：检索 + 1 跳图谱扩展。
+//
+// embedder 可为 nil；快照不含向量或 embedder 为 nil 时，vector/hybrid 模式
+// 自动退化为 keyword，保证离线环境下始终可用。
+type Retriever struct {
+	snap     *Snapshot
+	embedder indexer.Embedder
+	config   retrieval.HybridRetrieverConfig
+}
+
+// NewRetriever 构造快照检索器。
+func NewRetriever(snap *Snapshot, embedder indexer.Embedder) *Retriever {
+	return &Retriever{
+		snap:     snap,
+		embedder: embedder,
+		config:   retrieval.DefaultHybridRetrieverConfig(),
+	}
+}
+
+// Query 实现 retrieval.Retriever。
+func (r *Retriever) Query(ctx context.Context, req retrieval.RetrievalRequest) ([]retrieval.ContextBlock, error) {
+	mode := req.Mode
+	if mode == "" {
+		mode = "hybrid"
+	}
+	if !r.snap.HasVectors() || r.embedder == nil {
+		mode = "keyword"
+	}
+	limit := req.Limit
+	if limit <= 0 {
+		limit = r.config.DefaultLimit
+	}
+	filters := Filters{Language: req.Language, Kind: req.Kind, Limit: limit}
+
+	var hits []Hit
+	switch mode {
+	case "keyword":
+		hits = r.snap.KeywordSearch(req.Query, filters)
+	default:
+		emb, err := r.embedder.GenerateEmbedding(ctx, req.Query)
+		if err != nil {
+			return nil, err
+		}
+		if mode == "vector" {
+			hits = r.snap.VectorSearch(emb, filters)
+		} else {
+			hits = r.fuse(req.Query, emb, filters)
+		}
+	}
+
+	blocks := make([]retrieval.ContextBlock, 0, len(hits))
+	for _, h := range hits {
+		block := retrieval.ContextBlock{
+			Symbol:     toContextSymbol(h.Symbol),
+			Similarity: h.Score,
+			MatchMode:  mode,
+		}
+		if req.ExpandHops > 0 {
+			if req.ExpandCallers {
+				block.Callers = toContextSymbols(r.snap.Neighbors(h.Index, "callers", r.config.NeighborLimit))
+			}
+			if req.ExpandCallees {
+				block.Callees = toContextSymbols(r.snap.Neighbors(h.Index, "callees", r.config.NeighborLimit))
+			}
+		}
+		blocks = append(blocks, block)
+	}
+	return blocks, nil
+}
+
+// fuse 按 HybridRetrieverConfig 的权重线性融合向量与关键词得分。
+func (r *Retriever) fuse(query string, emb []float32, f Filters) []Hit {
+	// 两路各多召回一些，融合后再截断
+	wide := f
+	wide.Limit = f.limit() * 2
+
+	merged := make(map[int]*Hit)
+	for _, h := range r.snap.VectorSearch(emb, wide) {
+		h := h
+		h.Score *= r.config.WeightVector
+		merged[h.Index] = &h
+	}
+	for _, h := range r.snap.KeywordSearch(query, wide) {
+		if m, ok := merged[h.Index]; ok {
+			m.Score += h.Score * r.config.WeightKeyword
+			continue
+		}
+		h := h
+		h.Score *= r.config.WeightKeyword
+		merged[h.Index] = &h
+	}
+
+	hits := make([]Hit, 0, len(merged))
+	for _, h := range merged {
+		hits = append(hits, *h)
+	}
+	sort.Slice(hits, func(i, j int) bool {
+		if hits[i].Score != hits[j].Score {
+			return hits[i].Score > hits[j].Score
+		}
+		return hits[i].Index < hits[j].Index
+	})
+	if len(hits) > f.limit() {
+		hits = hits[:f.limit()]
+	}
+	return hits
+}
+
+func toContextSymbol(s Symbol) retrieval.ContextSymbol {
+	return retrieval.ContextSymbol{
+		SymbolID:  s.SymbolID,
+		Name:      s.Name,
+		Kind:      s.Kind,
+		Signature: s.Signature,
+		FilePath:  s.FilePath,
+		Language:  s.Language,
+		Docstring: s.Docstring,
+	}
+}
+
+func toContextSymbols(ss []Symbol) []retrieval.ContextSymbol {
+	out := make([]retrieval.ContextSymbol, 0, len(ss))
+	for _, s := range ss {
+		out = append(out, toContextSymbol(s))
+	}
+	return out
+}
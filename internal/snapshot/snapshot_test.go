@@ -0,0 +1,346 @@
+package snapshot
+
+import (
+	"bytes"
+	"context"
+	"encoding/binary"
+	"errors"
+	"os"
+	"path/filepath"
+	"reflect"
+	"testing"
+
+	"github.com/yourtionguo/CodeAtlas/internal/retrieval"
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+)
+
+// testOutput 构造一个小型调用图：main → handleRequest → parseBody → readAll，
+// handleRequest → writeResponse；另有一个外部未解析调用（不进图）。
+func testOutput() *schema.ParseOutput {
+	sym := func(id, name, doc string) schema.Symbol {
+		return schema.Symbol{
+			SymbolID:  id,
+			FileID:    "f1",
+			Name:      name,
+			Kind:      schema.SymbolFunction,
+			Signature: "func " + name + "()",
+			Docstring: doc,
+			Span:      schema.Span{StartLine: 1, EndLine: 3},
+		}
+	}
+	call := func(src, dst string) schema.DependencyEdge {
+		return schema.DependencyEdge{EdgeID: src + "->" + dst, SourceID: src, TargetID: dst, EdgeType: schema.EdgeCall, SourceFile: "server.go"}
+	}
+	return &schema.ParseOutput{
+		Files: []schema.File{{
+			FileID:   "f1",
+			Path:     "server.go",
+			Language: "go",
+			Symbols: []schema.Symbol{
+				sym("s-main", "main", "program entry point"),
+				sym("s-handle", "handleRequest", "handles an incoming HTTP request"),
+				sym("s-parse", "parseBody", "parses the JSON request body"),
+				sym("s-read", "readAll", ""),
+				sym("s-write", "writeResponse", "writes the HTTP response"),
+			},
+		}},
+		Relationships: []schema.DependencyEdge{
+			call("s-main", "s-handle"),
+			call("s-handle", "s-parse"),
+			call("s-handle", "s-write"),
+			call("s-parse", "s-read"),
+			call("s-parse", "s-read"), // 重复边
+			{EdgeID: "ext", SourceID: "s-read", EdgeType: schema.EdgeCall, SourceFile: "server.go"},
+			{EdgeID: "imp", SourceID: "s-main", TargetModule: "net/http", EdgeType: schema.EdgeImport},
+		},
+	}
+}
+
+func writeTestSnapshot(t *testing.T, opts WriteOptions) *Snapshot {
+	t.Helper()
+	path := filepath.Join(t.TempDir(), "repo.snap")
+	if err := WriteFile(path, testOutput(), opts); err != nil {
+		t.Fatalf("WriteFile failed: %v", err)
+	}
+	snap, err := Open(path)
+	if err != nil {
+		t.Fatalf("Open failed: %v", err)
+	}
+	t.Cleanup(func() { snap.Close() })
+	return snap
+}
+
+func TestSnapshot_RoundTrip(t *testing.T) {
+	snap := writeTestSnapshot(t, WriteOptions{RepoName: "demo"})
+
+	meta := snap.Meta()
+	if meta.RepoName != "demo" || meta.SymbolCount != 5 || meta.CallEdgeCount != 4 {
+		t.Errorf("unexpected meta: %+v", meta)
+	}
+	if snap.HasVectors() {
+		t.Error("expected no vectors")
+	}
+
+	idx, ok := snap.Lookup("s-parse")
+	if !ok {
+		t.Fatal("Lookup(s-parse) not found")
+	}
+	got := snap.Symbol(idx)
+	want := Symbol{
+		SymbolID: "s-parse", Name: "parseBody", Kind: "function",
+		Signature: "func parseBody()", Docstring: "parses the JSON request body",
+		FilePath: "server.go", Language: "go", StartLine: 1, EndLine: 3,
+	}
+	if got != want {
+		t.Errorf("Symbol = %+v, want %+v", got, want)
+	}
+
+	if _, ok := snap.Lookup("missing"); ok {
+		t.Error("Lookup(missing) should fail")
+	}
+}
+
+func TestSnapshot_Transitive(t *testing.T) {
+	snap := writeTestSnapshot(t, WriteOptions{})
+
+	callees, depth, err := snap.Transitive("s-main", "callees", 0)
+	if err != nil {
+		t.Fatalf("Transitive failed: %v", err)
+	}
+	if depth != 5 {
+		t.Errorf("default depth = %d, want 5", depth)
+	}
+	var got []string
+	for _, r := range callees {
+		got = append(got, r.Name+":"+string(rune('0'+r.Depth)))
+	}
+	want := []string{"handleRequest:1", "parseBody:2", "writeResponse:2", "readAll:3"}
+	if !reflect.DeepEqual(got, want) {
+		t.Errorf("callees = %v, want %v", got, want)
+	}
+
+	limited, _, _ := snap.Transitive("s-main", "callees", 1)
+	if len(limited) != 1 {
+		t.Errorf("depth=1 returned %d symbols, want 1", len(limited))
+	}
+
+	callers, _, _ := snap.Transitive("s-read", "callers", 0)
+	got = got[:0]
+	for _, r := range callers {
+		got = append(got, r.Name)
+	}
+	if !reflect.DeepEqual(got, []string{"parseBody", "handleRequest", "main"}) {
+		t.Errorf("callers = %v", got)
+	}
+
+	if _, _, err := snap.Transitive("missing", "callees", 0); !errors.Is(err, ErrSymbolNotFound) {
+		t.Errorf("expected ErrSymbolNotFound, got %v", err)
+	}
+}
+
+func TestSnapshot_KeywordSearch(t *testing.T) {
+	snap := writeTestSnapshot(t, WriteOptions{})
+
+	hits := snap.KeywordSearch("parse body", Filters{Limit: 3})
+	if len(hits) == 0 || hits[0].Name != "parseBody" {
+		t.Fatalf("expected parseBody first, got %+v", hits)
+	}
+	if hits[0].Score != 1 {
+		t.Errorf("full name-term match should score 1, got %f", hits[0].Score)
+	}
+
+	// 名字精确匹配
+	hits = snap.KeywordSearch("handleRequest", Filters{})
+	if len(hits) == 0 || hits[0].Name != "handleRequest" {
+		t.Errorf("expected handleRequest first, got %+v", hits)
+	}
+
+	// 文档命中 + 过滤
+	hits = snap.KeywordSearch("http", Filters{Kind: []string{"class"}})
+	if len(hits) != 0 {
+		t.Errorf("kind filter should exclude all, got %d", len(hits))
+	}
+	hits = snap.KeywordSearch("http", Filters{Language: "go"})
+	if len(hits) != 2 {
+		t.Errorf("expected 2 docstring hits for http, got %d", len(hits))
+	}
+}
+
+func TestSnapshot_VectorSearch(t *testing.T) {
+	vectors := map[string][]float32{
+		"s-handle": {1, 0, 0},
+		"s-parse":  {0, 2, 0},
+		"s-write":  {0.9, 0.1, 0},
+		"s-read":   {1, 1}, // 维度不一致，跳过
+	}
+	snap := writeTestSnapshot(t, WriteOptions{Vectors: vectors})
+	if !snap.HasVectors() || snap.Meta().VectorCount != 3 {
+		t.Fatalf("unexpected vector meta: %+v", snap.Meta())
+	}
+
+	hits := snap.VectorSearch([]float32{2, 0, 0}, Filters{Limit: 2})
+	if len(hits) != 2 || hits[0].Name != "handleRequest" || hits[1].Name != "writeResponse" {
+		t.Fatalf("unexpected hits: %+v", hits)
+	}
+	if hits[0].Score < 0.999 {
+		t.Errorf("identical direction should score ~1, got %f", hits[0].Score)
+	}
+	if snap.VectorSearch([]float32{1, 0}, Filters{}) != nil {
+		t.Error("dimension mismatch should return nil")
+	}
+}
+
+func TestRetriever_KeywordFallback(t *testing.T) {
+	snap := writeTestSnapshot(t, WriteOptions{})
+	r := NewRetriever(snap, nil)
+
+	blocks, err := r.Query(context.Background(), retrieval.RetrievalRequest{
+		Query:         "parse body",
+		Mode:          "hybrid",
+		Limit:         1,
+		ExpandHops:    1,
+		ExpandCallers: true,
+		ExpandCallees: true,
+	})
+	if err != nil {
+		t.Fatalf("Query failed: %v", err)
+	}
+	if len(blocks) != 1 {
+		t.Fatalf("expected 1 block, got %d", len(blocks))
+	}
+	b := blocks[0]
+	if b.Symbol.Name != "parseBody" || b.MatchMode != "keyword" {
+		t.Errorf("unexpected block: %+v", b)
+	}
+	if len(b.Callers) != 1 || b.Callers[0].Name != "handleRequest" {
+		t.Errorf("callers = %+v", b.Callers)
+	}
+	if len(b.Callees) != 1 || b.Callees[0].Name != "readAll" {
+		t.Errorf("callees = %+v", b.Callees)
+	}
+}
+
+func TestOpen_RejectsInvalidFiles(t *testing.T) {
+	dir := t.TempDir()
+
+	bad := filepath.Join(dir, "bad.snap")
+	if err := os.WriteFile(bad, []byte("not a snapshot"), 0644); err != nil {
+		t.Fatal(err)
+	}
+	if _, err := Open(bad); !errors.Is(err, ErrBadMagic) {
+		t.Errorf("expected ErrBadMagic, got %v", err)
+	}
+
+	var buf bytes.Buffer
+	if err := Encode(&buf, testOutput(), WriteOptions{}); err != nil {
+		t.Fatal(err)
+	}
+	truncated := filepath.Join(dir, "truncated.snap")
+	if err := os.WriteFile(truncated, buf.Bytes()[:buf.Len()/2], 0644); err != nil {
+		t.Fatal(err)
+	}
+	if _, err := Open(truncated); !errors.Is(err, ErrCorrupt) {
+		t.Errorf("expected ErrCorrupt, got %v", err)
+	}
+}
+
+// sectionStart 返回 section 在文件中的字节偏移
+func sectionStart(t *testing.T, data []byte, id uint32) int {
+	t.Helper()
+	count := int(binary.LittleEndian.Uint32(data[12:]))
+	for i := 0; i < count; i++ {
+		entry := data[headerSize+i*dirEntrySize:]
+		if binary.LittleEndian.Uint32(entry) == id {
+			return int(binary.LittleEndian.Uint64(entry[8:]))
+		}
+	}
+	t.Fatalf("section %d not found", id)
+	return 0
+}
+
+// TestParse_RejectsGarbledSections 构造能通过长度检查、但内部偏移或下标损坏的文件：
+// 这些文件必须在打开时被拒绝，而不是在之后的查询中越界。
+func TestParse_RejectsGarbledSections(t *testing.T) {
+	var buf bytes.Buffer
+	opts := WriteOptions{Vectors: map[string][]float32{"s-handle": {1, 0, 0}, "s-parse": {0, 1, 0}}}
+	if err := Encode(&buf, testOutput(), opts); err != nil {
+		t.Fatal(err)
+	}
+	clean := buf.Bytes()
+	if _, err := parse(clean); err != nil {
+		t.Fatalf("clean snapshot rejected: %v", err)
+	}
+	const symCount = 5
+
+	put := func(data []byte, off int, v uint32) { binary.LittleEndian.PutUint32(data[off:], v) }
+	tests := []struct {
+		name   string
+		garble func(data []byte)
+	}{
+		{"string_offsets_decrease", func(data []byte) {
+			// strings: count | offsets[count+1] | blob；offsets[1] 指到末尾，offsets[2] 随之倒退
+			strs := sectionStart(t, data, sectionStrings)
+			count := int(binary.LittleEndian.Uint32(data[strs:]))
+			put(data, strs+4+4, binary.LittleEndian.Uint32(data[strs+4+4*count:]))
+		}},
+		{"string_section_truncated", func(data []byte) {
+			// 目录里的长度截掉字符串表末尾，最后一个偏移越出 blob
+			for i := 0; i < int(binary.LittleEndian.Uint32(data[12:])); i++ {
+				entry := headerSize + i*dirEntrySize
+				if binary.LittleEndian.Uint32(data[entry:]) == sectionStrings {
+					length := binary.LittleEndian.Uint64(data[entry+16:])
+					binary.LittleEndian.PutUint64(data[entry+16:], length-8)
+				}
+			}
+		}},
+		{"call_offsets_decrease", func(data []byte) {
+			// calls_out: rows | offsets[rows+1] | values；s-main 有一条出边
+			calls := sectionStart(t, data, sectionCallsOut)
+			put(data, calls+4+4, 1000)
+		}},
+		{"call_target_out_of_range", func(data []byte) {
+			calls := sectionStart(t, data, sectionCallsOut)
+			put(data, calls+4+4*(symCount+1), symCount)
+		}},
+		{"posting_out_of_range", func(data []byte) {
+			// keywords: termCount | termIDs | rows | offsets | values
+			kw := sectionStart(t, data, sectionKeywords)
+			terms := int(binary.LittleEndian.Uint32(data[kw:]))
+			put(data, kw+4+4*terms+4+4*(terms+1), nameTermFlag|symCount)
+		}},
+		{"term_id_out_of_range", func(data []byte) {
+			kw := sectionStart(t, data, sectionKeywords)
+			put(data, kw+4, 1<<30)
+		}},
+		{"vector_symbol_out_of_range", func(data []byte) {
+			// vectors: dim | count | symIdx[count] | data
+			vec := sectionStart(t, data, sectionVectors)
+			put(data, vec+8, symCount)
+		}},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			data := append([]byte(nil), clean...)
+			tt.garble(data)
+			if _, err := parse(data); !errors.Is(err, ErrCorrupt) {
+				t.Errorf("expected ErrCorrupt, got %v", err)
+			}
+		})
+	}
+}
+
+func TestTokenize(t *testing.T) {
+	tests := []struct {
+		in   string
+		want []string
+	}{
+		{"parseHTTPRequest", []string{"parsehttprequest", "parse", "http", "request"}},
+		{"read_all_v2", []string{"read_all_v2", "read", "all", "v2"}},
+		{"a b", nil},
+	}
+	for _, tt := range tests {
+		if got := tokenize(tt.in); !reflect.DeepEqual(got, tt.want) {
+			t.Errorf("tokenize(%q) = %v, want %v", tt.in, got, tt.want)
+		}
+	}
+}
@@ -0,0 +1,65 @@
+package snapshot
+
+import (
+	"strings"
+	"unicode"
+)
+
+// minTermLen 是进入倒排索引的最短词长，过滤 "a"/"i" 这类噪声。
+const minTermLen = 2
+
+// tokenize 把标识符或自然语言切成小写词项。
+//
+// 标识符按 camelCase / snake_case / 非字母数字边界拆分（数字跟随前一段，如 v2、utf8），并保留完整的小写形式，
+// 例如 "parseHTTPRequest" → ["parsehttprequest", "parse", "http", "request"]。
+// 结果已去重，顺序稳定（按首次出现）。
+func tokenize(text string) []string {
+	var terms []string
+	seen := make(map[string]bool)
+	add := func(t string) {
+		t = strings.ToLower(t)
+		if len(t) < minTermLen || seen[t] {
+			return
+		}
+		seen[t] = true
+		terms = append(terms, t)
+	}
+
+	words := strings.FieldsFunc(text, func(r rune) bool {
+		return !unicode.IsLetter(r) && !unicode.IsDigit(r) && r != '_'
+	})
+	for _, word := range words {
+		add(strings.Trim(word, "_"))
+		for _, part := range strings.Split(word, "_") {
+			for _, sub := range splitCamel(part) {
+				add(sub)
+			}
+		}
+	}
+	return terms
+}
+
+// splitCamel 按大小写边界拆分：fooBar → foo,Bar；HTTPServer → HTTP,Server。
+func splitCamel(s string) []string {
+	runes := []rune(s)
+	if len(runes) == 0 {
+		return nil
+	}
+	var parts []string
+	start := 0
+	for i := 1; i < len(runes); i++ {
+		prev, cur := runes[i-1], runes[i]
+		boundary := false
+		switch {
+		case unicode.IsLower(prev) && unicode.IsUpper(cur):
+			boundary = true
+		case unicode.IsUpper(prev) && unicode.IsUpper(cur) && i+1 < len(runes) && unicode.IsLower(runes[i+1]):
+			boundary = true
+		}
+		if boundary {
+			parts = append(parts, string(runes[start:i]))
+			start = i
+		}
+	}
+	return append(parts, string(runes[start:]))
+}
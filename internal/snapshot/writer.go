@@ -0,0 +1,427 @@
+package snapshot
+
+import (
+	"bufio"
+	"encoding/binary"
+	"encoding/json"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"path/filepath"
+	"sort"
+	"time"
+
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+)
+
+// nameTermFlag 标记 postings 里"命中符号名"的条目（最高位），
+// 其余条目来自签名/文档。检索时名字命中的权重更高。
+const nameTermFlag uint32 = 1 << 31
+
+// WriteOptions 控制快照内容。
+type WriteOptions struct {
+	RepoID     string
+	RepoName   string
+	CommitHash string
+	// Vectors 是 symbol_id → embedding；为空则快照不含向量索引，
+	// search/ask 退化为关键词检索。维度不一致的条目会被跳过。
+	Vectors map[string][]float32
+}
+
+// WriteFile 把解析结果写成快照文件。先写临时文件再 rename，
+// 保证读者不会看到写了一半的快照。
+func WriteFile(path string, output *schema.ParseOutput, opts WriteOptions) error {
+	dir := filepath.Dir(path)
+	tmp, err := os.CreateTemp(dir, ".snapshot-*")
+	if err != nil {
+		return fmt.Errorf("failed to create temp file: %w", err)
+	}
+	tmpPath := tmp.Name()
+	defer os.Remove(tmpPath)
+
+	bw := bufio.NewWriterSize(tmp, 1<<20)
+	if err := Encode(bw, output, opts); err != nil {
+		tmp.Close()
+		return err
+	}
+	if err := bw.Flush(); err != nil {
+		tmp.Close()
+		return fmt.Errorf("failed to flush snapshot: %w", err)
+	}
+	if err := tmp.Sync(); err != nil {
+		tmp.Close()
+		return fmt.Errorf("failed to sync snapshot: %w", err)
+	}
+	if err := tmp.Close(); err != nil {
+		return fmt.Errorf("failed to close snapshot: %w", err)
+	}
+	if err := os.Rename(tmpPath, path); err != nil {
+		return fmt.Errorf("failed to move snapshot into place: %w", err)
+	}
+	return nil
+}
+
+// Encode 把解析结果编码为快照格式写入 w。
+func Encode(w io.Writer, output *schema.ParseOutput, opts WriteOptions) error {
+	if output == nil {
+		return fmt.Errorf("parse output is nil")
+	}
+	b := newBuilder()
+	b.addSymbols(output)
+	b.addCallEdges(output.Relationships)
+	b.addKeywords()
+	b.addVectors(opts.Vectors)
+
+	meta := Meta{
+		FormatVersion: FormatVersion,
+		RepoID:        opts.RepoID,
+		RepoName:      opts.RepoName,
+		CommitHash:    opts.CommitHash,
+		CreatedAt:     time.Now().UTC().Format(time.RFC3339),
+		SymbolCount:   len(b.symbols),
+		CallEdgeCount: b.callEdgeCount,
+		TermCount:     len(b.terms),
+		VectorCount:   len(b.vectorSyms),
+		VectorDim:     b.vectorDim,
+	}
+	metaJSON, err := json.Marshal(meta)
+	if err != nil {
+		return fmt.Errorf("failed to marshal snapshot meta: %w", err)
+	}
+
+	sections := []struct {
+		id   uint32
+		data []byte
+	}{
+		{sectionStrings, b.encodeStrings()},
+		{sectionSymbols, b.encodeSymbols()},
+		{sectionCallsOut, encodeCSR(b.callsOut)},
+		{sectionCallsIn, encodeCSR(b.callsIn)},
+		{sectionKeywords, b.encodeKeywords()},
+		{sectionVectors, b.encodeVectors()},
+		{sectionMeta, metaJSON},
+	}
+
+	header := make([]byte, headerSize+dirEntrySize*len(sections))
+	copy(header, Magic)
+	binary.LittleEndian.PutUint32(header[8:], FormatVersion)
+	binary.LittleEndian.PutUint32(header[12:], uint32(len(sections)))
+
+	offset := align8(uint64(len(header)))
+	for i, s := range sections {
+		entry := header[headerSize+i*dirEntrySize:]
+		binary.LittleEndian.PutUint32(entry[0:], s.id)
+		binary.LittleEndian.PutUint64(entry[8:], offset)
+		binary.LittleEndian.PutUint64(entry[16:], uint64(len(s.data)))
+		offset = align8(offset + uint64(len(s.data)))
+	}
+
+	written := uint64(0)
+	write := func(p []byte) error {
+		n, err := w.Write(p)
+		written += uint64(n)
+		return err
+	}
+	pad := func() error {
+		if rem := align8(written) - written; rem > 0 {
+			return write(make([]byte, rem))
+		}
+		return nil
+	}
+
+	if err := write(header); err != nil {
+		return fmt.Errorf("failed to write snapshot header: %w", err)
+	}
+	for _, s := range sections {
+		if err := pad(); err != nil {
+			return fmt.Errorf("failed to write snapshot: %w", err)
+		}
+		if err := write(s.data); err != nil {
+			return fmt.Errorf("failed to write snapshot section %d: %w", s.id, err)
+		}
+	}
+	return pad()
+}
+
+// builder 在内存里攒齐各张表，然后一次性编码。
+type builder struct {
+	strIndex map[string]uint32
+	strs     []string
+
+	symbols  []schema.Symbol
+	paths    []string
+	langs    []string
+	symIndex map[string]uint32
+
+	callsOut      [][]uint32
+	callsIn       [][]uint32
+	callEdgeCount int
+
+	terms    []string
+	postings [][]uint32
+
+	vectorDim  int
+	vectorSyms []uint32
+	vectorData [][]float32
+}
+
+func newBuilder() *builder {
+	b := &builder{
+		strIndex: make(map[string]uint32),
+		symIndex: make(map[string]uint32),
+	}
+	b.intern("") // 下标 0 恒为空串
+	return b
+}
+
+func (b *builder) intern(s string) uint32 {
+	if idx, ok := b.strIndex[s]; ok {
+		return idx
+	}
+	idx := uint32(len(b.strs))
+	b.strIndex[s] = idx
+	b.strs = append(b.strs, s)
+	return idx
+}
+
+// addSymbols 收集所有符号并按 symbol_id 排序，使读取端可二分查找。
+func (b *builder) addSymbols(output *schema.ParseOutput) {
+	type row struct {
+		sym  schema.Symbol
+		path string
+		lang string
+	}
+	var rows []row
+	seen := make(map[string]bool)
+	for _, file := range output.Files {
+		for _, sym := range file.Symbols {
+			if sym.SymbolID == "" || seen[sym.SymbolID] {
+				continue
+			}
+			seen[sym.SymbolID] = true
+			rows = append(rows, row{sym: sym, path: file.Path, lang: file.Language})
+		}
+	}
+	sort.Slice(rows, func(i, j int) bool { return rows[i].sym.SymbolID < rows[j].sym.SymbolID })
+
+	b.symbols = make([]schema.Symbol, len(rows))
+	b.paths = make([]string, len(rows))
+	b.langs = make([]string, len(rows))
+	for i, r := range rows {
+		b.symbols[i] = r.sym
+		b.paths[i] = r.path
+		b.langs[i] = r.lang
+		b.symIndex[r.sym.SymbolID] = uint32(i)
+		for _, s := range []string{r.sym.SymbolID, r.sym.Name, string(r.sym.Kind), r.sym.Signature, r.sym.Docstring, r.path, r.lang} {
+			b.intern(s)
+		}
+	}
+}
+
+// addCallEdges 只保留两端都在快照内的 call 边，与 transitiveQuery 的语义一致。
+func (b *builder) addCallEdges(edges []schema.DependencyEdge) {
+	n := len(b.symbols)
+	b.callsOut = make([][]uint32, n)
+	b.callsIn = make([][]uint32, n)
+	seen := make(map[[2]uint32]bool)
+	for _, e := range edges {
+		if e.EdgeType != schema.EdgeCall || e.TargetID == "" {
+			continue
+		}
+		src, ok1 := b.symIndex[e.SourceID]
+		dst, ok2 := b.symIndex[e.TargetID]
+		if !ok1 || !ok2 {
+			continue
+		}
+		key := [2]uint32{src, dst}
+		if seen[key] {
+			continue
+		}
+		seen[key] = true
+		b.callsOut[src] = append(b.callsOut[src], dst)
+		b.callsIn[dst] = append(b.callsIn[dst], src)
+		b.callEdgeCount++
+	}
+	for i := range b.callsOut {
+		sortUint32(b.callsOut[i])
+		sortUint32(b.callsIn[i])
+	}
+}
+
+// addKeywords 基于符号名、签名、文档构建倒排索引。
+func (b *builder) addKeywords() {
+	index := make(map[string]map[uint32]uint32)
+	for i, sym := range b.symbols {
+		idx := uint32(i)
+		for _, t := range tokenize(sym.Name) {
+			if index[t] == nil {
+				index[t] = make(map[uint32]uint32)
+			}
+			index[t][idx] = idx | nameTermFlag
+		}
+		for _, t := range tokenize(sym.Signature + " " + sym.Docstring) {
+			if index[t] == nil {
+				index[t] = make(map[uint32]uint32)
+			}
+			if _, ok := index[t][idx]; !ok {
+				index[t][idx] = idx
+			}
+		}
+	}
+
+	b.terms = make([]string, 0, len(index))
+	for t := range index {
+		b.terms = append(b.terms, t)
+	}
+	sort.Strings(b.terms)
+	b.postings = make([][]uint32, len(b.terms))
+	for i, t := range b.terms {
+		list := make([]uint32, 0, len(index[t]))
+		for _, v := range index[t] {
+			list = append(list, v)
+		}
+		sort.Slice(list, func(x, y int) bool { return list[x]&^nameTermFlag < list[y]&^nameTermFlag })
+		b.postings[i] = list
+		b.intern(t)
+	}
+}
+
+// addVectors 归一化后存储，读取端的余弦相似度即点积。
+func (b *builder) addVectors(vectors map[string][]float32) {
+	if len(vectors) == 0 {
+		return
+	}
+	for i, sym := range b.symbols {
+		vec, ok := vectors[sym.SymbolID]
+		if !ok || len(vec) == 0 {
+			continue
+		}
+		if b.vectorDim == 0 {
+			b.vectorDim = len(vec)
+		}
+		if len(vec) != b.vectorDim {
+			continue
+		}
+		b.vectorSyms = append(b.vectorSyms, uint32(i))
+		b.vectorData = append(b.vectorData, normalize(vec))
+	}
+}
+
+func (b *builder) encodeStrings() []byte {
+	total := 0
+	for _, s := range b.strs {
+		total += len(s)
+	}
+	buf := make([]byte, 4+4*(len(b.strs)+1)+total)
+	binary.LittleEndian.PutUint32(buf, uint32(len(b.strs)))
+	offsets := buf[4:]
+	blob := buf[4+4*(len(b.strs)+1):]
+	pos := 0
+	for i, s := range b.strs {
+		binary.LittleEndian.PutUint32(offsets[4*i:], uint32(pos))
+		copy(blob[pos:], s)
+		pos += len(s)
+	}
+	binary.LittleEndian.PutUint32(offsets[4*len(b.strs):], uint32(pos))
+	return buf
+}
+
+func (b *builder) encodeSymbols() []byte {
+	n := len(b.symbols)
+	buf := make([]byte, 4+4*n*symbolColumns)
+	binary.LittleEndian.PutUint32(buf, uint32(n))
+	put := func(col, row int, v uint32) {
+		binary.LittleEndian.PutUint32(buf[4+4*(col*n+row):], v)
+	}
+	for i, sym := range b.symbols {
+		put(colID, i, b.strIndex[sym.SymbolID])
+		put(colName, i, b.strIndex[sym.Name])
+		put(colKind, i, b.strIndex[string(sym.Kind)])
+		put(colSignature, i, b.strIndex[sym.Signature])
+		put(colDocstring, i, b.strIndex[sym.Docstring])
+		put(colFilePath, i, b.strIndex[b.paths[i]])
+		put(colLanguage, i, b.strIndex[b.langs[i]])
+		put(colStartLine, i, uint32(sym.Span.StartLine))
+		put(colEndLine, i, uint32(sym.Span.EndLine))
+	}
+	return buf
+}
+
+func (b *builder) encodeKeywords() []byte {
+	termIDs := make([]uint32, len(b.terms))
+	for i, t := range b.terms {
+		termIDs[i] = b.strIndex[t]
+	}
+	buf := encodeCSR(b.postings)
+	// 布局：termCount | termStringIDs[termCount] | CSR(offsets, postings)
+	out := make([]byte, 4+4*len(termIDs), 4+4*len(termIDs)+len(buf))
+	binary.LittleEndian.PutUint32(out, uint32(len(termIDs)))
+	for i, id := range termIDs {
+		binary.LittleEndian.PutUint32(out[4+4*i:], id)
+	}
+	return append(out, buf...)
+}
+
+func (b *builder) encodeVectors() []byte {
+	n := len(b.vectorSyms)
+	buf := make([]byte, 8+4*n+4*n*b.vectorDim)
+	binary.LittleEndian.PutUint32(buf, uint32(b.vectorDim))
+	binary.LittleEndian.PutUint32(buf[4:], uint32(n))
+	for i, idx := range b.vectorSyms {
+		binary.LittleEndian.PutUint32(buf[8+4*i:], idx)
+	}
+	data := buf[8+4*n:]
+	for i, vec := range b.vectorData {
+		for j, f := range vec {
+			binary.LittleEndian.PutUint32(data[4*(i*b.vectorDim+j):], math.Float32bits(f))
+		}
+	}
+	return buf
+}
+
+// encodeCSR 把邻接表编码为 rows | offsets[rows+1] | values。
+func encodeCSR(lists [][]uint32) []byte {
+	total := 0
+	for _, l := range lists {
+		total += len(l)
+	}
+	buf := make([]byte, 4+4*(len(lists)+1)+4*total)
+	binary.LittleEndian.PutUint32(buf, uint32(len(lists)))
+	offsets := buf[4:]
+	values := buf[4+4*(len(lists)+1):]
+	pos := 0
+	for i, l := range lists {
+		binary.LittleEndian.PutUint32(offsets[4*i:], uint32(pos))
+		for _, v := range l {
+			binary.LittleEndian.PutUint32(values[4*pos:], v)
+			pos++
+		}
+	}
+	binary.LittleEndian.PutUint32(offsets[4*len(lists):], uint32(pos))
+	return buf
+}
+
+func normalize(vec []float32) []float32 {
+	var sum float64
+	for _, f := range vec {
+		sum += float64(f) * float64(f)
+	}
+	out := make([]float32, len(vec))
+	if sum == 0 {
+		return out
+	}
+	inv := 1 / math.Sqrt(sum)
+	for i, f := range vec {
+		out[i] = float32(float64(f) * inv)
+	}
+	return out
+}
+
+func sortUint32(s []uint32) {
+	sort.Slice(s, func(i, j int) bool { return s[i] < s[j] })
+}
+
+func align8(n uint64) uint64 {
+	return (n + 7) &^ 7
+}
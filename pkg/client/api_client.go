@@ -87,6 +87,12 @@ type IndexOptions struct {
 	BatchSize      int    `json:"batch_size"`
 	WorkerCount    int    `json:"worker_count"`
 	EmbeddingModel string `json:"embedding_model,omitempty"`
+	// History records this index as a version of CommitHash in the commit-level history
+	History bool `json:"history,omitempty"`
+	// BulkLoad defers secondary indexes of empty tables until the load is done
+	BulkLoad bool `json:"bulk_load,omitempty"`
+	// ErrorBudget stops the run early once more errors than this are recorded (0 = unlimited)
+	ErrorBudget int `json:"error_budget,omitempty"`
 }
 
 // IndexResponse represents the response for POST /api/v1/index
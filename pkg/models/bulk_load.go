@@ -0,0 +1,414 @@
+package models
+
+import (
+	"context"
+	"database/sql"
+	"errors"
+	"fmt"
+	"sort"
+	"strings"
+	"sync"
+
+	"github.com/lib/pq"
+)
+
+// bulkLoadLockKey is held by a bulk load for its whole duration. Restoring
+// deferred indexes takes it as well, so the indexes of a live load are never
+// rebuilt behind its back, while those of a crashed load (whose session and
+// lock died with it) are.
+const bulkLoadLockKey int64 = 0x42756c6b4c6f6164 // "BulkLoad"
+
+// ErrBulkLoadPoolTooSmall is returned when the bulk load lock would have to
+// take the only connection of the pool that the load itself writes through
+var ErrBulkLoadPoolTooSmall = errors.New("bulk load needs a pool of at least 2 connections")
+
+// minRebuildWorkMemMB is the floor of the per-session maintenance_work_mem
+const minRebuildWorkMemMB = 64
+
+// BulkLoadTables are the tables whose secondary indexes a bulk load defers by
+// default: the ones written row by row by the indexer and the embedder
+var BulkLoadTables = []string{"symbols", "ast_nodes", "edges", "vectors", "coarse_vectors"}
+
+// BulkLoadConfig configures deferred index builds
+type BulkLoadConfig struct {
+	// Tables whose secondary indexes are deferred while they are empty
+	Tables []string
+	// Parallelism is the number of indexes rebuilt at once, each on its own
+	// session
+	Parallelism int
+	// MaintenanceWorkMemMB is the maintenance_work_mem budget shared by the
+	// rebuild sessions. HNSW builds are much faster when the graph fits in it.
+	MaintenanceWorkMemMB int
+	// ParallelWorkers sets max_parallel_maintenance_workers for each rebuild
+	// (0 keeps the server setting)
+	ParallelWorkers int
+}
+
+// DefaultBulkLoadConfig returns the default bulk load configuration
+func DefaultBulkLoadConfig() BulkLoadConfig {
+	return BulkLoadConfig{
+		Tables:               BulkLoadTables,
+		Parallelism:          2,
+		MaintenanceWorkMemMB: 1024,
+		ParallelWorkers:      2,
+	}
+}
+
+func (c BulkLoadConfig) withDefaults() BulkLoadConfig {
+	if len(c.Tables) == 0 {
+		c.Tables = BulkLoadTables
+	}
+	if c.Parallelism < 1 {
+		c.Parallelism = 1
+	}
+	return c
+}
+
+// workMemPerSession splits the maintenance memory budget across the sessions
+// that rebuild indexes concurrently
+func (c BulkLoadConfig) workMemPerSession(sessions int) int {
+	if sessions < 1 {
+		sessions = 1
+	}
+	mem := c.MaintenanceWorkMemMB / sessions
+	if mem < minRebuildWorkMemMB {
+		mem = minRebuildWorkMemMB
+	}
+	return mem
+}
+
+// BulkLoad is a load into empty tables with their secondary indexes dropped.
+// Each dropped index is journaled in deferred_indexes in the transaction that
+// drops it, and removed from the journal in the transaction that recreates
+// it, so an index is never lost: if the process dies mid-load,
+// RestoreDeferredIndexes (run at API startup) or the next BeginBulkLoad
+// rebuilds it.
+type BulkLoad struct {
+	db     *DB
+	config BulkLoadConfig
+	conn   *sql.Conn // pinned session holding bulkLoadLockKey (see lockSession)
+
+	mu      sync.Mutex
+	pending []IndexDefinition
+}
+
+// BeginBulkLoad drops the secondary indexes of the configured tables that are
+// currently empty. Indexes left in the journal by an earlier crashed load are
+// adopted and rebuilt together with the new ones. It returns nil when nothing
+// is deferred: no table is empty, or another bulk load holds the lock.
+func BeginBulkLoad(ctx context.Context, db *DB, config BulkLoadConfig) (*BulkLoad, error) {
+	config = config.withDefaults()
+	conn, err := lockSession(ctx, db)
+	if err != nil {
+		return nil, err
+	}
+	var locked bool
+	if err := conn.QueryRowContext(ctx, "SELECT pg_try_advisory_lock($1)", bulkLoadLockKey).Scan(&locked); err != nil {
+		conn.Close()
+		return nil, fmt.Errorf("failed to take bulk load lock: %w", err)
+	}
+	if !locked {
+		conn.Close()
+		return nil, nil
+	}
+	b := &BulkLoad{db: db, config: config, conn: conn}
+
+	if b.pending, err = loadDeferredIndexes(ctx, conn); err != nil {
+		b.release()
+		return nil, err
+	}
+	deferred, err := b.deferEmptyTables(ctx)
+	if err != nil {
+		b.release()
+		return nil, err
+	}
+	b.pending = append(b.pending, deferred...)
+
+	if len(b.pending) == 0 {
+		b.release()
+		return nil, nil
+	}
+	if dbLogger != nil {
+		dbLogger.Infof("Bulk load: %d secondary indexes deferred", len(b.pending))
+	}
+	return b, nil
+}
+
+// deferEmptyTables drops and journals the secondary indexes of empty tables in
+// one transaction
+func (b *BulkLoad) deferEmptyTables(ctx context.Context) ([]IndexDefinition, error) {
+	tx, err := b.conn.BeginTx(ctx, nil)
+	if err != nil {
+		return nil, err
+	}
+	defer tx.Rollback()
+
+	var empty []string
+	for _, table := range b.config.Tables {
+		ok, err := TablesEmpty(ctx, tx, []string{table})
+		if err != nil {
+			return nil, fmt.Errorf("failed to check table %s: %w", table, err)
+		}
+		if ok {
+			empty = append(empty, table)
+		}
+	}
+	if len(empty) == 0 {
+		return nil, nil
+	}
+
+	defs, err := DropSecondaryIndexes(ctx, tx, empty)
+	if err != nil {
+		return nil, err
+	}
+	if len(defs) > 0 {
+		names := make([]string, len(defs))
+		tables := make([]string, len(defs))
+		definitions := make([]string, len(defs))
+		for i, def := range defs {
+			names[i], tables[i], definitions[i] = def.Name, def.Table, def.Definition
+		}
+		if _, err := tx.ExecContext(ctx, `
+			INSERT INTO deferred_indexes (index_name, table_name, definition)
+			SELECT * FROM unnest($1::text[], $2::text[], $3::text[])
+			ON CONFLICT (index_name) DO NOTHING
+		`, pq.Array(names), pq.Array(tables), pq.Array(definitions)); err != nil {
+			return nil, fmt.Errorf("failed to journal deferred indexes: %w", err)
+		}
+	}
+	if err := tx.Commit(); err != nil {
+		return nil, err
+	}
+	return defs, nil
+}
+
+// Deferred returns the indexes still waiting to be rebuilt
+func (b *BulkLoad) Deferred() []IndexDefinition {
+	if b == nil {
+		return nil
+	}
+	b.mu.Lock()
+	defer b.mu.Unlock()
+	return append([]IndexDefinition(nil), b.pending...)
+}
+
+// Finish rebuilds the deferred indexes of tables (all of them when none is
+// given), so that later stages can query those tables with their indexes
+// while other tables are still loading. Once nothing is pending the lock is
+// released. Indexes that fail to rebuild stay in the journal for
+// RestoreDeferredIndexes. Safe to call on a nil BulkLoad and more than once.
+func (b *BulkLoad) Finish(ctx context.Context, tables ...string) error {
+	if b == nil {
+		return nil
+	}
+	b.mu.Lock()
+	var defs, rest []IndexDefinition
+	for _, def := range b.pending {
+		if len(tables) == 0 || containsString(tables, def.Table) {
+			defs = append(defs, def)
+		} else {
+			rest = append(rest, def)
+		}
+	}
+	b.pending = rest
+	done := len(rest) == 0
+	b.mu.Unlock()
+
+	err := rebuildIndexes(ctx, b.db, defs, b.config)
+	if done {
+		b.release()
+	}
+	return err
+}
+
+// release drops the bulk load lock and returns the pinned session
+func (b *BulkLoad) release() {
+	if b.conn == nil {
+		return
+	}
+	b.conn.ExecContext(context.Background(), "SELECT pg_advisory_unlock($1)", bulkLoadLockKey)
+	b.conn.Close()
+	b.conn = nil
+}
+
+// RestoreDeferredIndexes rebuilds the indexes journaled by a bulk load that
+// did not finish (the process crashed or the rebuild failed). Indexes of a
+// bulk load that is still running are left alone. Returns the number of
+// indexes rebuilt.
+func RestoreDeferredIndexes(ctx context.Context, db *DB, config BulkLoadConfig) (int, error) {
+	config = config.withDefaults()
+	conn, err := lockSession(ctx, db)
+	if err != nil {
+		return 0, err
+	}
+	defer conn.Close()
+	var locked bool
+	if err := conn.QueryRowContext(ctx, "SELECT pg_try_advisory_lock($1)", bulkLoadLockKey).Scan(&locked); err != nil {
+		return 0, fmt.Errorf("failed to take bulk load lock: %w", err)
+	}
+	if !locked {
+		return 0, nil
+	}
+	defer conn.ExecContext(context.Background(), "SELECT pg_advisory_unlock($1)", bulkLoadLockKey)
+
+	defs, err := loadDeferredIndexes(ctx, conn)
+	if err != nil || len(defs) == 0 {
+		return 0, err
+	}
+	if dbLogger != nil {
+		dbLogger.Warnf("Restoring %d indexes deferred by an unfinished bulk load", len(defs))
+	}
+	if err := rebuildIndexes(ctx, db, defs, config); err != nil {
+		return 0, err
+	}
+	return len(defs), nil
+}
+
+// lockSession pins the session that holds bulkLoadLockKey for the whole load
+// or rebuild. Writes and rebuilds run on db's pool meanwhile, so the session
+// comes from the other pool when there is one (see DB.lockPool); a single pool
+// limited to one connection would wait on itself forever and is refused.
+func lockSession(ctx context.Context, db *DB) (*sql.Conn, error) {
+	pool := db.lockPool()
+	if max := pool.Stats().MaxOpenConnections; pool == db.DB && max > 0 && max < 2 {
+		return nil, fmt.Errorf("%w (DB_MAX_OPEN_CONNS / DB_BULK_MAX_OPEN_CONNS is %d)", ErrBulkLoadPoolTooSmall, max)
+	}
+	conn, err := pool.Conn(ctx)
+	if err != nil {
+		return nil, fmt.Errorf("failed to acquire connection: %w", err)
+	}
+	return conn, nil
+}
+
+// loadDeferredIndexes reads the deferred index journal
+func loadDeferredIndexes(ctx context.Context, conn *sql.Conn) ([]IndexDefinition, error) {
+	rows, err := conn.QueryContext(ctx, `SELECT table_name, index_name, definition FROM deferred_indexes ORDER BY table_name, index_name`)
+	if err != nil {
+		return nil, fmt.Errorf("failed to read deferred indexes: %w", err)
+	}
+	defer rows.Close()
+	var defs []IndexDefinition
+	for rows.Next() {
+		var def IndexDefinition
+		if err := rows.Scan(&def.Table, &def.Name, &def.Definition); err != nil {
+			return nil, err
+		}
+		defs = append(defs, def)
+	}
+	return defs, rows.Err()
+}
+
+// rebuildIndexes recreates defs on up to config.Parallelism sessions at once.
+// HNSW indexes, the slowest to build, start first. The first error is
+// returned after all workers stop.
+func rebuildIndexes(ctx context.Context, db *DB, defs []IndexDefinition, config BulkLoadConfig) error {
+	if len(defs) == 0 {
+		return nil
+	}
+	defs = append([]IndexDefinition(nil), defs...)
+	sort.SliceStable(defs, func(i, j int) bool {
+		return isHNSW(defs[i]) && !isHNSW(defs[j])
+	})
+
+	workers := config.Parallelism
+	if workers < 1 {
+		workers = 1
+	}
+	if workers > len(defs) {
+		workers = len(defs)
+	}
+	workMem := config.workMemPerSession(workers)
+
+	jobs := make(chan IndexDefinition)
+	var (
+		wg       sync.WaitGroup
+		mu       sync.Mutex
+		firstErr error
+	)
+	fail := func(err error) {
+		mu.Lock()
+		if firstErr == nil {
+			firstErr = err
+		}
+		mu.Unlock()
+	}
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			conn, err := db.DB.Conn(ctx)
+			if err != nil {
+				fail(fmt.Errorf("failed to acquire connection: %w", err))
+				for range jobs {
+				}
+				return
+			}
+			defer conn.Close()
+			for def := range jobs {
+				if err := rebuildIndex(ctx, conn, def, workMem, config.ParallelWorkers); err != nil {
+					fail(err)
+				}
+			}
+		}()
+	}
+	for _, def := range defs {
+		jobs <- def
+	}
+	close(jobs)
+	wg.Wait()
+
+	if firstErr == nil && dbLogger != nil {
+		dbLogger.Infof("Rebuilt %d deferred indexes (%d sessions, maintenance_work_mem %dMB each)", len(defs), workers, workMem)
+	}
+	return firstErr
+}
+
+// rebuildIndex recreates one index and clears its journal row in the same
+// transaction. SET LOCAL scopes the memory settings to this build.
+func rebuildIndex(ctx context.Context, conn *sql.Conn, def IndexDefinition, workMemMB, parallelWorkers int) error {
+	tx, err := conn.BeginTx(ctx, nil)
+	if err != nil {
+		return err
+	}
+	defer tx.Rollback()
+
+	if _, err := tx.ExecContext(ctx, fmt.Sprintf("SET LOCAL maintenance_work_mem = '%dMB'", workMemMB)); err != nil {
+		return fmt.Errorf("failed to set maintenance_work_mem: %w", err)
+	}
+	if parallelWorkers > 0 {
+		if _, err := tx.ExecContext(ctx, fmt.Sprintf("SET LOCAL max_parallel_maintenance_workers = %d", parallelWorkers)); err != nil {
+			return fmt.Errorf("failed to set max_parallel_maintenance_workers: %w", err)
+		}
+	}
+	if _, err := tx.ExecContext(ctx, ifNotExists(def.Definition)); err != nil {
+		return fmt.Errorf("failed to recreate index %s: %w", def.Name, err)
+	}
+	if _, err := tx.ExecContext(ctx, "DELETE FROM deferred_indexes WHERE index_name = $1", def.Name); err != nil {
+		return fmt.Errorf("failed to clear deferred index %s: %w", def.Name, err)
+	}
+	return tx.Commit()
+}
+
+// ifNotExists makes a pg_get_indexdef definition idempotent, for indexes that
+// were rebuilt before their journal row could be removed
+func ifNotExists(definition string) string {
+	for _, prefix := range []string{"CREATE UNIQUE INDEX ", "CREATE INDEX "} {
+		if strings.HasPrefix(definition, prefix) && !strings.HasPrefix(definition, prefix+"IF NOT EXISTS ") {
+			return prefix + "IF NOT EXISTS " + definition[len(prefix):]
+		}
+	}
+	return definition
+}
+
+func isHNSW(def IndexDefinition) bool {
+	return strings.Contains(def.Definition, "USING hnsw")
+}
+
+func containsString(list []string, s string) bool {
+	for _, v := range list {
+		if v == s {
+			return true
+		}
+	}
+	return false
+}
@@ -0,0 +1,110 @@
+package models
+
+import (
+	"context"
+	"database/sql"
+	"errors"
+	"testing"
+	"time"
+)
+
+func TestIfNotExists(t *testing.T) {
+	tests := []struct {
+		in, want string
+	}{
+		{
+			"CREATE INDEX idx_edges_source ON public.edges USING btree (source_id)",
+			"CREATE INDEX IF NOT EXISTS idx_edges_source ON public.edges USING btree (source_id)",
+		},
+		{
+			"CREATE UNIQUE INDEX idx_u ON public.symbols USING btree (file_id, name)",
+			"CREATE UNIQUE INDEX IF NOT EXISTS idx_u ON public.symbols USING btree (file_id, name)",
+		},
+		{
+			"CREATE INDEX IF NOT EXISTS idx_x ON public.vectors USING hnsw (embedding vector_cosine_ops)",
+			"CREATE INDEX IF NOT EXISTS idx_x ON public.vectors USING hnsw (embedding vector_cosine_ops)",
+		},
+	}
+	for _, tt := range tests {
+		if got := ifNotExists(tt.in); got != tt.want {
+			t.Errorf("ifNotExists(%q) = %q, want %q", tt.in, got, tt.want)
+		}
+	}
+}
+
+func TestBulkLoadConfig_WorkMemPerSession(t *testing.T) {
+	config := BulkLoadConfig{MaintenanceWorkMemMB: 1024}
+	if got := config.workMemPerSession(4); got != 256 {
+		t.Errorf("expected budget split to 256MB, got %d", got)
+	}
+	// 预算过小时不低于下限
+	if got := config.workMemPerSession(64); got != minRebuildWorkMemMB {
+		t.Errorf("expected floor %d, got %d", minRebuildWorkMemMB, got)
+	}
+
+	defaults := BulkLoadConfig{}.withDefaults()
+	if defaults.Parallelism != 1 || len(defaults.Tables) != len(BulkLoadTables) {
+		t.Errorf("unexpected defaults %+v", defaults)
+	}
+}
+
+func TestBulkLoad_NilIsNoop(t *testing.T) {
+	var b *BulkLoad
+	if err := b.Finish(context.Background()); err != nil {
+		t.Errorf("Finish on nil bulk load: %v", err)
+	}
+	if b.Deferred() != nil {
+		t.Error("nil bulk load should have nothing deferred")
+	}
+}
+
+// openUnreachable returns a pool that never connects successfully: the tests
+// below must decide without touching the database
+func openUnreachable(t *testing.T, maxOpen int) *sql.DB {
+	t.Helper()
+	pool, err := sql.Open("postgres", "host=127.0.0.1 port=1 connect_timeout=1 sslmode=disable")
+	if err != nil {
+		t.Fatal(err)
+	}
+	pool.SetMaxOpenConns(maxOpen)
+	t.Cleanup(func() { pool.Close() })
+	return pool
+}
+
+func TestBeginBulkLoad_RefusesOneConnectionPool(t *testing.T) {
+	// 锁会话占住唯一的连接后，写入的 BeginTx 会永远等待
+	db := &DB{DB: openUnreachable(t, 1)}
+	ctx, cancel := context.WithTimeout(context.Background(), 5*time.Second)
+	defer cancel()
+
+	if _, err := BeginBulkLoad(ctx, db, DefaultBulkLoadConfig()); !errors.Is(err, ErrBulkLoadPoolTooSmall) {
+		t.Errorf("BeginBulkLoad: expected ErrBulkLoadPoolTooSmall, got %v", err)
+	}
+	if _, err := RestoreDeferredIndexes(ctx, db, DefaultBulkLoadConfig()); !errors.Is(err, ErrBulkLoadPoolTooSmall) {
+		t.Errorf("RestoreDeferredIndexes: expected ErrBulkLoadPoolTooSmall, got %v", err)
+	}
+}
+
+func TestLockPool_UsesTheOtherPool(t *testing.T) {
+	interactive := openUnreachable(t, 4)
+	bulk := openUnreachable(t, 1)
+	db := &DB{DB: interactive, bulk: &DB{DB: bulk, interactive: interactive}}
+
+	// 一个连接的 bulk 池照常可用：锁会话来自交互池
+	if db.Bulk().lockPool() != interactive {
+		t.Error("Expected the bulk pool to take its lock session from the interactive pool")
+	}
+	if db.lockPool() != bulk {
+		t.Error("Expected the interactive pool to take its lock session from the bulk pool")
+	}
+	ctx, cancel := context.WithTimeout(context.Background(), 5*time.Second)
+	defer cancel()
+	if _, err := BeginBulkLoad(ctx, db.Bulk(), DefaultBulkLoadConfig()); errors.Is(err, ErrBulkLoadPoolTooSmall) {
+		t.Error("A one-connection bulk pool should be usable when the lock comes from the other pool")
+	}
+
+	single := &DB{DB: openUnreachable(t, 0)}
+	if single.lockPool() != single.DB {
+		t.Error("Expected a single pool to lock on itself")
+	}
+}
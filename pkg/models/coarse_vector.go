@@ -0,0 +1,231 @@
+package models
+
+import (
+	"context"
+	"fmt"
+	"math"
+	"strings"
+	"time"
+
+	"github.com/lib/pq"
+)
+
+// CoarseDimensions is the dimension of coarse_vectors.embedding (halfvec(256))
+const CoarseDimensions = 256
+
+// Levels of coarse vectors
+const (
+	CoarseLevelFile  = "file"
+	CoarseLevelBlock = "block"
+)
+
+// coarseOverfetch is how many coarse rows are read per requested file: a file
+// has one file-level row and usually several block rows, so reading exactly
+// CoarseFiles rows would yield fewer distinct files
+const coarseOverfetch = 4
+
+// CoarseVector is a file- or block-level embedding used to pick candidate
+// files before the symbol-level search. It holds a reduced embedding (see
+// ReduceEmbedding) and only the hash of the embedded content.
+type CoarseVector struct {
+	VectorID    string    `json:"vector_id" db:"vector_id"`
+	EntityID    string    `json:"entity_id" db:"entity_id"`
+	Level       string    `json:"level" db:"level"`
+	FileID      string    `json:"file_id" db:"file_id"`
+	Embedding   []float32 `json:"embedding" db:"embedding"`
+	ContentHash string    `json:"content_hash" db:"content_hash"`
+	Model       string    `json:"model" db:"model"`
+	ChunkIndex  int       `json:"chunk_index" db:"chunk_index"`
+	CreatedAt   time.Time `json:"created_at" db:"created_at"`
+}
+
+// ReduceEmbedding keeps the first dims components of embedding and
+// re-normalises them to unit length. Matryoshka-trained models (the default
+// qwen3 embedding model among them) put the coarse meaning in the leading
+// components, so the prefix is a usable lower-resolution embedding; for cosine
+// distance only the direction matters. Returns nil when embedding is shorter
+// than dims.
+func ReduceEmbedding(embedding []float32, dims int) []float32 {
+	if dims <= 0 || len(embedding) < dims {
+		return nil
+	}
+	reduced := make([]float32, dims)
+	copy(reduced, embedding[:dims])
+
+	var norm float64
+	for _, v := range reduced {
+		norm += float64(v) * float64(v)
+	}
+	if norm == 0 {
+		return reduced
+	}
+	scale := float32(1 / math.Sqrt(norm))
+	for i := range reduced {
+		reduced[i] *= scale
+	}
+	return reduced
+}
+
+// BatchCreateCoarse upserts coarse vectors with a single multi-row INSERT.
+// Rows are keyed by (file_id, level, chunk_index), so re-indexing a file
+// overwrites its previous coarse vectors in place.
+func (r *VectorRepository) BatchCreateCoarse(ctx context.Context, vectors []*CoarseVector) error {
+	if len(vectors) == 0 {
+		return nil
+	}
+
+	const columns = 8
+	var sb strings.Builder
+	sb.WriteString(`INSERT INTO coarse_vectors (vector_id, entity_id, level, file_id, embedding, content_hash, model, chunk_index, created_at) VALUES `)
+	args := make([]interface{}, 0, len(vectors)*columns+1)
+	now := time.Now()
+	args = append(args, now)
+	for i, v := range vectors {
+		if len(v.Embedding) != CoarseDimensions {
+			return fmt.Errorf("coarse vector %s has %d dimensions, expected %d", v.VectorID, len(v.Embedding), CoarseDimensions)
+		}
+		v.CreatedAt = now
+		if i > 0 {
+			sb.WriteString(", ")
+		}
+		base := len(args)
+		fmt.Fprintf(&sb, "($%d, $%d, $%d, $%d, $%d::halfvec, $%d, $%d, $%d, $1)",
+			base+1, base+2, base+3, base+4, base+5, base+6, base+7, base+8)
+		args = append(args, v.VectorID, v.EntityID, v.Level, v.FileID,
+			formatVectorForPgvector(v.Embedding), v.ContentHash, v.Model, v.ChunkIndex)
+	}
+	sb.WriteString(`
+		ON CONFLICT (file_id, level, chunk_index)
+		DO UPDATE SET
+			entity_id = EXCLUDED.entity_id,
+			embedding = EXCLUDED.embedding,
+			content_hash = EXCLUDED.content_hash,
+			model = EXCLUDED.model,
+			created_at = EXCLUDED.created_at`)
+
+	if _, err := r.db.ExecContext(ctx, sb.String(), args...); err != nil {
+		return fmt.Errorf("failed to insert coarse vectors: %w", err)
+	}
+	return nil
+}
+
+// TrimCoarseBlocks deletes block-level rows beyond the current block count of
+// each file, left over from a previous version of the file that had more
+// blocks. fileIDs and blockCounts are parallel slices.
+func (r *VectorRepository) TrimCoarseBlocks(ctx context.Context, fileIDs []string, blockCounts []int) error {
+	if len(fileIDs) == 0 {
+		return nil
+	}
+	counts := make([]int64, len(blockCounts))
+	for i, n := range blockCounts {
+		counts[i] = int64(n)
+	}
+	query := `
+		DELETE FROM coarse_vectors c
+		USING unnest($1::uuid[], $2::int[]) AS k(file_id, blocks)
+		WHERE c.file_id = k.file_id AND c.level = 'block' AND c.chunk_index >= k.blocks
+	`
+	_, err := r.db.ExecContext(ctx, query, pq.Array(fileIDs), pq.Array(counts))
+	return err
+}
+
+// coarseCandidateFiles returns up to filters.CoarseFiles file IDs whose file-
+// or block-level vectors are closest to queryEmbedding, best first. The repo,
+// language and model filters apply; kind does not, since coarse rows span
+// several symbols.
+func (r *VectorRepository) coarseCandidateFiles(ctx context.Context, queryEmbedding []float32, filters VectorSearchFilters) ([]string, error) {
+	reduced := ReduceEmbedding(queryEmbedding, CoarseDimensions)
+	if reduced == nil {
+		return nil, fmt.Errorf("query embedding has %d dimensions, coarse search needs at least %d", len(queryEmbedding), CoarseDimensions)
+	}
+
+	args := []interface{}{formatVectorForPgvector(reduced)}
+	addArg := func(v interface{}) string {
+		args = append(args, v)
+		return fmt.Sprintf("$%d", len(args))
+	}
+
+	query := "SELECT c.file_id FROM coarse_vectors c"
+	if filters.Language != "" || len(filters.RepoIDs) > 0 {
+		query += " JOIN files f ON f.file_id = c.file_id"
+	}
+	query += " WHERE 1=1"
+	if filters.Model != "" {
+		query += " AND c.model = " + addArg(filters.Model)
+	}
+	if filters.Language != "" {
+		query += " AND f.language = " + addArg(filters.Language)
+	}
+	if len(filters.RepoIDs) > 0 {
+		query += " AND f.repo_id = ANY(" + addArg(pq.Array(filters.RepoIDs)) + ")"
+	}
+	query += " ORDER BY c.embedding <=> $1::halfvec LIMIT " + addArg(filters.CoarseFiles*coarseOverfetch)
+
+	rows, err := r.db.QueryContext(ctx, query, args...)
+	if err != nil {
+		return nil, err
+	}
+	defer rows.Close()
+
+	seen := make(map[string]bool)
+	var fileIDs []string
+	for rows.Next() {
+		var fileID string
+		if err := rows.Scan(&fileID); err != nil {
+			return nil, err
+		}
+		if seen[fileID] || len(fileIDs) >= filters.CoarseFiles {
+			continue
+		}
+		seen[fileID] = true
+		fileIDs = append(fileIDs, fileID)
+	}
+	return fileIDs, rows.Err()
+}
+
+// coarseCoversScope reports whether every file in the search scope that has
+// symbol vectors also has coarse vectors. A scope is only partly covered when
+// some of its repositories (or files) were indexed without multi-granularity
+// embedding; restricting the symbol search to coarse candidates would then
+// silently drop those files. The repo, language and model filters apply as in
+// coarseCandidateFiles.
+func (r *VectorRepository) coarseCoversScope(ctx context.Context, filters VectorSearchFilters) (bool, error) {
+	var args []interface{}
+	addArg := func(v interface{}) string {
+		args = append(args, v)
+		return fmt.Sprintf("$%d", len(args))
+	}
+
+	// 范围内有符号向量、却没有粗粒度向量的文件
+	coarseModel, symbolModel := "", ""
+	if filters.Model != "" {
+		p := addArg(filters.Model)
+		coarseModel = " AND c.model = " + p
+		symbolModel = " AND v.model = " + p
+	}
+	where := "1=1"
+	if filters.Language != "" {
+		where += " AND f.language = " + addArg(filters.Language)
+	}
+	if len(filters.RepoIDs) > 0 {
+		where += " AND f.repo_id = ANY(" + addArg(pq.Array(filters.RepoIDs)) + ")"
+	}
+	query := `
+		SELECT NOT EXISTS (
+			SELECT 1 FROM files f
+			WHERE ` + where + `
+			  AND NOT EXISTS (SELECT 1 FROM coarse_vectors c WHERE c.file_id = f.file_id` + coarseModel + `)
+			  AND EXISTS (
+				SELECT 1 FROM symbols s
+				JOIN vectors v ON v.entity_id = s.symbol_id AND v.entity_type = 'symbol'
+				WHERE s.file_id = f.file_id` + symbolModel + `
+			  )
+		)
+	`
+
+	var covered bool
+	if err := r.db.QueryRowContext(ctx, query, args...).Scan(&covered); err != nil {
+		return false, err
+	}
+	return covered, nil
+}
@@ -0,0 +1,121 @@
+package models
+
+import (
+	"context"
+	"math"
+	"testing"
+
+	"github.com/google/uuid"
+)
+
+func TestReduceEmbedding(t *testing.T) {
+	reduced := ReduceEmbedding([]float32{3, 4, 100, -7}, 2)
+	if len(reduced) != 2 {
+		t.Fatalf("expected 2 dimensions, got %d", len(reduced))
+	}
+	// 前缀 (3,4) 归一化为 (0.6,0.8)
+	if math.Abs(float64(reduced[0])-0.6) > 1e-6 || math.Abs(float64(reduced[1])-0.8) > 1e-6 {
+		t.Errorf("unexpected reduced embedding %v", reduced)
+	}
+
+	if got := ReduceEmbedding([]float32{1, 2}, 4); got != nil {
+		t.Errorf("embedding shorter than dims should yield nil, got %v", got)
+	}
+	if got := ReduceEmbedding([]float32{0, 0, 1}, 2); len(got) != 2 || got[0] != 0 || got[1] != 0 {
+		t.Errorf("zero prefix should stay zero, got %v", got)
+	}
+
+	input := []float32{1, 1, 1}
+	ReduceEmbedding(input, 2)
+	if input[0] != 1 {
+		t.Error("ReduceEmbedding must not modify its input")
+	}
+}
+
+func TestSimilaritySearch_CoarseFallsBackOnPartialCoverage(t *testing.T) {
+	if testing.Short() {
+		t.Skip("Skipping integration test in short mode")
+	}
+	dim := getVectorDimension()
+	if dim < CoarseDimensions {
+		t.Skipf("coarse search needs at least %d dimensions, have %d", CoarseDimensions, dim)
+	}
+
+	testDB := SetupTestDB(t)
+	defer testDB.TeardownTestDB(t)
+	ctx := context.Background()
+
+	repoID := uuid.New().String()
+	if err := NewRepositoryRepository(testDB.DB).Create(ctx, &Repository{
+		RepoID: repoID, Name: "test-repo-coarse-" + repoID[:8], URL: "https://github.com/test/repo", Branch: "main",
+	}); err != nil {
+		t.Fatalf("Failed to create repository: %v", err)
+	}
+
+	embedding := make([]float32, dim)
+	for i := range embedding {
+		embedding[i] = float32(i%7+1) / 10
+	}
+	vectorRepo := NewVectorRepository(testDB.DB)
+
+	// covered.go 有粗粒度向量，plain.go 没有（如按 symbol 模式索引）
+	symbolIDs := make(map[string]string)
+	fileIDs := make(map[string]string)
+	for _, path := range []string{"covered.go", "plain.go"} {
+		file := &File{FileID: uuid.New().String(), RepoID: repoID, Path: path, Language: "go", Size: 64, Checksum: path}
+		if err := NewFileRepository(testDB.DB).Create(ctx, file); err != nil {
+			t.Fatalf("Failed to create file: %v", err)
+		}
+		symbol := &Symbol{SymbolID: uuid.New().String(), FileID: file.FileID, Name: "F", Kind: "function", StartLine: 1, EndLine: 2, EndByte: 10}
+		if err := NewSymbolRepository(testDB.DB).Create(ctx, symbol); err != nil {
+			t.Fatalf("Failed to create symbol: %v", err)
+		}
+		if err := vectorRepo.Create(ctx, &Vector{
+			VectorID: uuid.New().String(), EntityID: symbol.SymbolID, EntityType: "symbol",
+			Embedding: embedding, Content: path, Model: "test-model",
+		}); err != nil {
+			t.Fatalf("Failed to create vector: %v", err)
+		}
+		fileIDs[path] = file.FileID
+		symbolIDs[path] = symbol.SymbolID
+	}
+	coarse := func(path string) {
+		t.Helper()
+		if err := vectorRepo.BatchCreateCoarse(ctx, []*CoarseVector{{
+			VectorID: uuid.New().String(), EntityID: fileIDs[path], Level: CoarseLevelFile, FileID: fileIDs[path],
+			Embedding: ReduceEmbedding(embedding, CoarseDimensions), ContentHash: path, Model: "test-model",
+		}}); err != nil {
+			t.Fatalf("Failed to create coarse vector: %v", err)
+		}
+	}
+	search := func() (map[string]bool, *SearchPlan) {
+		t.Helper()
+		results, plan, err := vectorRepo.SimilaritySearchWithPlan(ctx, embedding, VectorSearchFilters{
+			EntityType: "symbol", RepoIDs: []string{repoID}, Limit: 10, CoarseFiles: 1,
+		})
+		if err != nil {
+			t.Fatalf("Search failed: %v", err)
+		}
+		found := make(map[string]bool)
+		for _, r := range results {
+			found[r.EntityID] = true
+		}
+		return found, plan
+	}
+
+	coarse("covered.go")
+	found, plan := search()
+	if !found[symbolIDs["covered.go"]] || !found[symbolIDs["plain.go"]] {
+		t.Errorf("partly covered scope should search every file, got %v", found)
+	}
+	if plan.Exact {
+		t.Error("partly covered scope should run the unrestricted index search")
+	}
+
+	// 全部覆盖后按粗筛候选收窄（CoarseFiles=1 只保留一个文件）
+	coarse("plain.go")
+	found, plan = search()
+	if len(found) != 1 || !plan.Exact {
+		t.Errorf("fully covered scope should rank only the coarse candidate, got %v (exact=%v)", found, plan.Exact)
+	}
+}
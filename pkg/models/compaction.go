@@ -0,0 +1,548 @@
+package models
+
+import (
+	"context"
+	"database/sql"
+	"errors"
+	"fmt"
+	"math"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/lib/pq"
+)
+
+// ErrCompactionRunning is returned by Run when a compaction is already in progress
+var ErrCompactionRunning = errors.New("compaction already running")
+
+// compactionLockKey is the advisory lock that keeps API replicas from
+// compacting the same database concurrently
+const compactionLockKey int64 = 0x436f6d70616374 // "Compact"
+
+// zeroUUID starts the keyset cursors
+const zeroUUID = "00000000-0000-0000-0000-000000000000"
+
+// CompactionConfig configures the background compaction job
+type CompactionConfig struct {
+	// Interval is the time between runs started by Start
+	Interval time.Duration
+	// BatchSize is the number of rows examined per statement
+	BatchSize int
+	// RowsPerSecond is the I/O budget: rows examined per second across all
+	// steps; the job sleeps between batches to stay under it (0 = unlimited)
+	RowsPerSecond int
+	// ReindexBloatRatio rebuilds btree indexes whose size exceeds this multiple
+	// of their estimated compact size (0 disables reindexing)
+	ReindexBloatRatio float64
+	// MinReindexBytes skips indexes smaller than this
+	MinReindexBytes int64
+	// ReindexTables lists the tables whose indexes are checked for bloat
+	ReindexTables []string
+}
+
+// DefaultCompactionConfig returns the default compaction configuration
+func DefaultCompactionConfig() CompactionConfig {
+	return CompactionConfig{
+		Interval:          time.Hour,
+		BatchSize:         1000,
+		RowsPerSecond:     5000,
+		ReindexBloatRatio: 2.0,
+		MinReindexBytes:   64 << 20,
+		ReindexTables:     []string{"edges", "symbols", "ast_nodes", "vectors", "summaries"},
+	}
+}
+
+// CompactionStats reports what one compaction run did
+type CompactionStats struct {
+	StartedAt       time.Time     `json:"started_at"`
+	Duration        time.Duration `json:"duration"`
+	Skipped         bool          `json:"skipped"` // another instance holds the compaction lock
+	RowsExamined    int64         `json:"rows_examined"`
+	OrphanVectors   int64         `json:"orphan_vectors"`
+	OrphanSummaries int64         `json:"orphan_summaries"`
+	EdgesResolved   int64         `json:"edges_resolved"` // dangling edges pointed at the re-indexed symbol
+	EdgesDemoted    int64         `json:"edges_demoted"`  // no unique target left; stale target_file cleared
+	ReposChanged    int           `json:"repos_changed"`  // repositories whose index generation was bumped
+	Reindexed       []string      `json:"reindexed"`
+}
+
+// Compactor removes the leftovers of incremental re-indexing in bounded,
+// set-based batches:
+//
+//   - vectors and summaries whose symbol or file no longer exists
+//     (they have no foreign key, so deletes do not cascade to them)
+//   - edges whose target symbol was deleted (ON DELETE SET NULL left
+//     target_id empty but target_file set): re-resolved by target name within
+//     the source repository, or demoted to unresolved when no unique target
+//     remains
+//   - btree indexes bloated by the delete/re-insert churn: rebuilt with
+//     REINDEX CONCURRENTLY
+//
+// Every statement touches at most BatchSize rows and runs in its own short
+// transaction on the bulk pool, paced by the RowsPerSecond budget.
+type Compactor struct {
+	db     *DB
+	cfg    CompactionConfig
+	budget *ioBudget
+
+	running atomic.Bool
+
+	stop     chan struct{}
+	done     chan struct{}
+	stopOnce sync.Once
+
+	mu   sync.Mutex
+	last *CompactionStats
+}
+
+// NewCompactor creates a compactor; call Start for periodic runs or Run for one
+func NewCompactor(db *DB, cfg CompactionConfig) *Compactor {
+	if cfg.BatchSize <= 0 {
+		cfg.BatchSize = DefaultCompactionConfig().BatchSize
+	}
+	return &Compactor{
+		db:     db,
+		cfg:    cfg,
+		budget: newIOBudget(cfg.RowsPerSecond),
+		stop:   make(chan struct{}),
+		done:   make(chan struct{}),
+	}
+}
+
+// Start runs compaction every Interval in the background until Stop is called.
+// A non-positive Interval leaves the job idle.
+func (c *Compactor) Start() {
+	if c.cfg.Interval <= 0 {
+		close(c.done)
+		return
+	}
+	ctx, cancel := context.WithCancel(context.Background())
+	go func() {
+		<-c.stop
+		cancel()
+	}()
+	go func() {
+		defer close(c.done)
+		ticker := time.NewTicker(c.cfg.Interval)
+		defer ticker.Stop()
+		for {
+			select {
+			case <-c.stop:
+				return
+			case <-ticker.C:
+				stats, err := c.Run(ctx)
+				if dbLogger == nil {
+					continue
+				}
+				if err != nil {
+					if ctx.Err() == nil {
+						dbLogger.Warnf("Compaction failed: %v", err)
+					}
+					continue
+				}
+				if !stats.Skipped {
+					dbLogger.Infof("Compaction finished in %s: %d orphan vectors, %d orphan summaries, %d edges re-resolved, %d edges demoted (%d repositories), %d indexes rebuilt",
+						stats.Duration, stats.OrphanVectors, stats.OrphanSummaries, stats.EdgesResolved, stats.EdgesDemoted, stats.ReposChanged, len(stats.Reindexed))
+				}
+			}
+		}
+	}()
+}
+
+// Stop cancels a run in progress and waits for the loop to exit
+func (c *Compactor) Stop() {
+	c.stopOnce.Do(func() {
+		close(c.stop)
+		<-c.done
+	})
+}
+
+// LastRun returns the stats of the last completed run, or nil
+func (c *Compactor) LastRun() *CompactionStats {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	return c.last
+}
+
+// Run performs one compaction pass. It returns ErrCompactionRunning if a pass
+// is already in progress in this process, and Skipped stats if another
+// process holds the compaction lock.
+func (c *Compactor) Run(ctx context.Context) (*CompactionStats, error) {
+	if !c.running.CompareAndSwap(false, true) {
+		return nil, ErrCompactionRunning
+	}
+	defer c.running.Store(false)
+
+	stats := &CompactionStats{StartedAt: time.Now(), Reindexed: []string{}}
+
+	// 会话级 advisory lock 绑定在这条连接上，其余语句走连接池
+	conn, err := c.db.DB.Conn(ctx)
+	if err != nil {
+		return nil, fmt.Errorf("failed to acquire connection: %w", err)
+	}
+	defer conn.Close()
+	var locked bool
+	if err := conn.QueryRowContext(ctx, "SELECT pg_try_advisory_lock($1)", compactionLockKey).Scan(&locked); err != nil {
+		return nil, fmt.Errorf("failed to take compaction lock: %w", err)
+	}
+	if !locked {
+		stats.Skipped = true
+		return stats, nil
+	}
+	defer conn.ExecContext(context.Background(), "SELECT pg_advisory_unlock($1)", compactionLockKey)
+
+	c.budget.reset()
+	db := c.db.Bulk()
+
+	if stats.OrphanVectors, err = c.sweepOrphans(ctx, db, "vectors", "vector_id", stats); err != nil {
+		return nil, fmt.Errorf("failed to remove orphan vectors: %w", err)
+	}
+	if stats.OrphanSummaries, err = c.sweepOrphans(ctx, db, "summaries", "summary_id", stats); err != nil {
+		return nil, fmt.Errorf("failed to remove orphan summaries: %w", err)
+	}
+	// 边被改写的仓库推进代数，缓存的调用方/被调方/依赖响应随之失效；
+	// 中途失败时已提交的批次同样需要推进
+	changed := make(map[string]bool)
+	err = c.resolveDanglingEdges(ctx, db, stats, changed)
+	c.bumpGenerations(db, changed, stats)
+	if err != nil {
+		return nil, fmt.Errorf("failed to re-resolve dangling edges: %w", err)
+	}
+	if c.cfg.ReindexBloatRatio > 0 {
+		if err := c.reindexBloated(ctx, db, stats); err != nil {
+			return nil, fmt.Errorf("failed to reindex bloated indexes: %w", err)
+		}
+	}
+
+	stats.Duration = time.Since(stats.StartedAt)
+	c.mu.Lock()
+	c.last = stats
+	c.mu.Unlock()
+	return stats, nil
+}
+
+// bumpGenerations advances the persisted index generation of every changed
+// repository. It runs even when the run was cancelled, since the committed
+// batches already changed what cached responses describe.
+func (c *Compactor) bumpGenerations(db *DB, changed map[string]bool, stats *CompactionStats) {
+	repos := NewRepositoryRepository(db)
+	for repoID := range changed {
+		ctx, cancel := context.WithTimeout(context.Background(), 5*time.Second)
+		_, err := repos.BumpIndexGeneration(ctx, repoID)
+		cancel()
+		if err != nil {
+			db.Generations().Invalidate(repoID)
+			if dbLogger != nil {
+				dbLogger.Warnf("Compaction: failed to bump index generation of %s: %v", repoID, err)
+			}
+			continue
+		}
+		stats.ReposChanged++
+	}
+}
+
+// sweepOrphans walks table in primary-key pages and deletes the rows of each
+// page whose entity (symbol or file) no longer exists. Rows of other entity
+// types are left alone.
+func (c *Compactor) sweepOrphans(ctx context.Context, db *DB, table, idColumn string, stats *CompactionStats) (int64, error) {
+	query := fmt.Sprintf(`
+		WITH page AS (
+			SELECT %[2]s AS id, entity_id, entity_type FROM %[1]s
+			WHERE %[2]s > $1
+			ORDER BY %[2]s
+			LIMIT $2
+		),
+		deleted AS (
+			DELETE FROM %[1]s t USING page p
+			WHERE t.%[2]s = p.id
+			  AND ((p.entity_type = 'symbol' AND NOT EXISTS (SELECT 1 FROM symbols s WHERE s.symbol_id = p.entity_id))
+			    OR (p.entity_type = 'file' AND NOT EXISTS (SELECT 1 FROM files f WHERE f.file_id = p.entity_id)))
+			RETURNING 1
+		)
+		SELECT (SELECT id FROM page ORDER BY id DESC LIMIT 1),
+		       (SELECT COUNT(*) FROM page),
+		       (SELECT COUNT(*) FROM deleted)
+	`, table, idColumn)
+
+	var removed int64
+	cursor := zeroUUID
+	for {
+		var last sql.NullString
+		var examined, deleted int64
+		if err := db.QueryRowContext(ctx, query, cursor, c.cfg.BatchSize).Scan(&last, &examined, &deleted); err != nil {
+			return removed, err
+		}
+		removed += deleted
+		stats.RowsExamined += examined
+		if !last.Valid || examined < int64(c.cfg.BatchSize) {
+			return removed, nil
+		}
+		cursor = last.String
+		if err := c.budget.spend(ctx, examined); err != nil {
+			return removed, err
+		}
+	}
+}
+
+// resolveDanglingEdgesQuery points each edge of the batch at the symbol named
+// target_name in the source's repository: the unique one in the old target
+// file if there is one, otherwise the unique one in the repository.
+const resolveDanglingEdgesQuery = `
+	WITH batch AS (
+		SELECT e.edge_id, e.target_name, e.target_file, sf.repo_id
+		FROM edges e
+		JOIN symbols ss ON ss.symbol_id = e.source_id
+		JOIN files sf ON sf.file_id = ss.file_id
+		WHERE e.edge_id = ANY($1::uuid[]) AND e.target_id IS NULL AND e.target_name IS NOT NULL
+	),
+	candidates AS (
+		SELECT b.edge_id, b.repo_id, s.symbol_id, f.path,
+		       f.path = b.target_file AS same_file,
+		       COUNT(*) OVER w AS in_repo,
+		       SUM(CASE WHEN f.path = b.target_file THEN 1 ELSE 0 END) OVER w AS in_file
+		FROM batch b
+		JOIN files f ON f.repo_id = b.repo_id
+		JOIN symbols s ON s.file_id = f.file_id AND s.name = b.target_name
+		WINDOW w AS (PARTITION BY b.edge_id)
+	)
+	UPDATE edges e
+	SET target_id = c.symbol_id, target_file = c.path
+	FROM candidates c
+	WHERE e.edge_id = c.edge_id
+	  AND ((c.in_file = 1 AND c.same_file) OR (c.in_file = 0 AND c.in_repo = 1))
+	RETURNING c.repo_id
+`
+
+// resolveDanglingEdges re-resolves edges whose target was deleted. Edges that
+// cannot be resolved unambiguously have their stale target_file cleared, which
+// makes them ordinary unresolved edges and drops them from the scan. The
+// repositories of all updated edges are added to changed.
+func (c *Compactor) resolveDanglingEdges(ctx context.Context, db *DB, stats *CompactionStats, changed map[string]bool) error {
+	const pageQuery = `
+		SELECT edge_id FROM edges
+		WHERE target_id IS NULL AND target_file IS NOT NULL AND edge_id > $1
+		ORDER BY edge_id
+		LIMIT $2
+	`
+	const demoteQuery = `
+		UPDATE edges e SET target_file = NULL
+		FROM symbols ss
+		JOIN files sf ON sf.file_id = ss.file_id
+		WHERE e.edge_id = ANY($1::uuid[]) AND e.target_id IS NULL AND e.target_file IS NOT NULL
+		  AND ss.symbol_id = e.source_id
+		RETURNING sf.repo_id
+	`
+
+	cursor := zeroUUID
+	for {
+		ids, err := c.edgePage(ctx, db, pageQuery, cursor)
+		if err != nil {
+			return err
+		}
+		if len(ids) == 0 {
+			return nil
+		}
+		stats.RowsExamined += int64(len(ids))
+
+		n, err := updatedRepos(ctx, db, resolveDanglingEdgesQuery, ids, changed)
+		if err != nil {
+			return err
+		}
+		stats.EdgesResolved += n
+
+		n, err = updatedRepos(ctx, db, demoteQuery, ids, changed)
+		if err != nil {
+			return err
+		}
+		stats.EdgesDemoted += n
+
+		if len(ids) < c.cfg.BatchSize {
+			return nil
+		}
+		cursor = ids[len(ids)-1]
+		if err := c.budget.spend(ctx, int64(len(ids))); err != nil {
+			return err
+		}
+	}
+}
+
+// updatedRepos runs an edge UPDATE that returns the source repository of each
+// updated row, adds them to changed and returns the number of rows
+func updatedRepos(ctx context.Context, db *DB, query string, ids []string, changed map[string]bool) (int64, error) {
+	rows, err := db.QueryContext(ctx, query, pq.Array(ids))
+	if err != nil {
+		return 0, err
+	}
+	defer rows.Close()
+	var n int64
+	for rows.Next() {
+		var repoID string
+		if err := rows.Scan(&repoID); err != nil {
+			return n, err
+		}
+		changed[repoID] = true
+		n++
+	}
+	return n, rows.Err()
+}
+
+func (c *Compactor) edgePage(ctx context.Context, db *DB, query, cursor string) ([]string, error) {
+	rows, err := db.QueryContext(ctx, query, cursor, c.cfg.BatchSize)
+	if err != nil {
+		return nil, err
+	}
+	defer rows.Close()
+	var ids []string
+	for rows.Next() {
+		var id string
+		if err := rows.Scan(&id); err != nil {
+			return nil, err
+		}
+		ids = append(ids, id)
+	}
+	return ids, rows.Err()
+}
+
+// indexSizeQuery lists the valid btree indexes of the given tables with the
+// inputs of the bloat estimate: on-disk size, tuple count and key width
+const indexSizeQuery = `
+	SELECT ic.relname,
+	       pg_relation_size(ic.oid),
+	       GREATEST(ic.reltuples, 0)::bigint,
+	       COALESCE((
+	           SELECT SUM(st.avg_width) FROM pg_attribute a
+	           JOIN pg_stats st ON st.schemaname = n.nspname AND st.tablename = tc.relname AND st.attname = a.attname
+	           WHERE a.attrelid = tc.oid AND a.attnum = ANY(i.indkey)
+	       ), 0)::bigint
+	FROM pg_index i
+	JOIN pg_class ic ON ic.oid = i.indexrelid
+	JOIN pg_class tc ON tc.oid = i.indrelid
+	JOIN pg_namespace n ON n.oid = tc.relnamespace
+	JOIN pg_am am ON am.oid = ic.relam
+	WHERE n.nspname = current_schema()
+	  AND tc.relname = ANY($1)
+	  AND am.amname = 'btree'
+	  AND i.indisvalid
+	ORDER BY ic.relname
+`
+
+// reindexBloated rebuilds the btree indexes whose estimated bloat exceeds the
+// configured ratio. REINDEX CONCURRENTLY does not block reads or writes.
+func (c *Compactor) reindexBloated(ctx context.Context, db *DB, stats *CompactionStats) error {
+	type candidate struct {
+		name              string
+		size, tuples, key int64
+	}
+	rows, err := db.QueryContext(ctx, indexSizeQuery, pq.Array(c.cfg.ReindexTables))
+	if err != nil {
+		return err
+	}
+	var candidates []candidate
+	for rows.Next() {
+		var ic candidate
+		if err := rows.Scan(&ic.name, &ic.size, &ic.tuples, &ic.key); err != nil {
+			rows.Close()
+			return err
+		}
+		candidates = append(candidates, ic)
+	}
+	rows.Close()
+	if err := rows.Err(); err != nil {
+		return err
+	}
+
+	for _, ic := range candidates {
+		if ic.size < c.cfg.MinReindexBytes {
+			continue
+		}
+		ratio := estimateIndexBloat(ic.size, ic.tuples, ic.key)
+		if ratio < c.cfg.ReindexBloatRatio {
+			continue
+		}
+		if _, err := db.ExecContext(ctx, "REINDEX INDEX CONCURRENTLY "+pq.QuoteIdentifier(ic.name)); err != nil {
+			return fmt.Errorf("%s: %w", ic.name, err)
+		}
+		stats.Reindexed = append(stats.Reindexed, ic.name)
+		if dbLogger != nil {
+			dbLogger.Debugf("Rebuilt index %s (%d bytes, estimated bloat %.1fx)", ic.name, ic.size, ratio)
+		}
+		if err := c.budget.spend(ctx, ic.tuples); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// btree page geometry used by the bloat estimate
+const (
+	btreePageSize       = 8192
+	btreePageOverhead   = 24 + 16 // page header + btree special space
+	btreeTupleOverhead  = 8 + 4   // IndexTupleData + line pointer
+	btreeLeafFillFactor = 0.9
+)
+
+// estimateIndexBloat returns the ratio of an index's size to the size of a
+// freshly built btree over the same tuples (leaf pages at the default fill
+// factor plus the metapage and roughly one internal page per leaf page's worth
+// of downlinks). It returns 0 when there is nothing to estimate from, such as
+// an empty or never-analyzed table.
+func estimateIndexBloat(sizeBytes, tuples, keyWidth int64) float64 {
+	if sizeBytes <= 0 || tuples <= 0 || keyWidth <= 0 {
+		return 0
+	}
+	tupleBytes := btreeTupleOverhead + (keyWidth+7)/8*8
+	usable := float64(btreePageSize-btreePageOverhead) * btreeLeafFillFactor
+	perPage := int64(usable) / tupleBytes
+	if perPage < 1 {
+		perPage = 1
+	}
+	leafPages := int64(math.Ceil(float64(tuples) / float64(perPage)))
+	internalPages := int64(math.Ceil(float64(leafPages) / float64(perPage)))
+	expected := (leafPages + internalPages + 1) * btreePageSize
+	return float64(sizeBytes) / float64(expected)
+}
+
+// ioBudget paces work to a rows-per-second rate measured from the start of
+// the run, so short bursts are allowed but the average stays under budget
+type ioBudget struct {
+	rate  int
+	start time.Time
+	rows  int64
+	now   func() time.Time
+	sleep func(ctx context.Context, d time.Duration) error
+}
+
+func newIOBudget(rowsPerSecond int) *ioBudget {
+	return &ioBudget{rate: rowsPerSecond, now: time.Now, sleep: sleepContext}
+}
+
+func (b *ioBudget) reset() {
+	b.start = b.now()
+	b.rows = 0
+}
+
+// spend records rows of work and sleeps until the running average is back
+// under the rate
+func (b *ioBudget) spend(ctx context.Context, rows int64) error {
+	if b.rate <= 0 {
+		return ctx.Err()
+	}
+	b.rows += rows
+	due := b.start.Add(time.Duration(float64(b.rows) / float64(b.rate) * float64(time.Second)))
+	if wait := due.Sub(b.now()); wait > 0 {
+		return b.sleep(ctx, wait)
+	}
+	return ctx.Err()
+}
+
+func sleepContext(ctx context.Context, d time.Duration) error {
+	t := time.NewTimer(d)
+	defer t.Stop()
+	select {
+	case <-ctx.Done():
+		return ctx.Err()
+	case <-t.C:
+		return nil
+	}
+}
@@ -0,0 +1,88 @@
+package models
+
+import (
+	"context"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+)
+
+func TestEstimateIndexBloat(t *testing.T) {
+	// 16 字节键（uuid）：每页 (8192-40)*0.9/28 = 262 个元组
+	const tuples = 262 * 1000
+	compact := int64(1000+4+1) * btreePageSize
+
+	assert.InDelta(t, 1.0, estimateIndexBloat(compact, tuples, 16), 0.01)
+	assert.InDelta(t, 3.0, estimateIndexBloat(3*compact, tuples, 16), 0.01)
+
+	// 无统计信息或空表不做估计
+	assert.Zero(t, estimateIndexBloat(compact, 0, 16))
+	assert.Zero(t, estimateIndexBloat(compact, tuples, 0))
+	assert.Zero(t, estimateIndexBloat(0, tuples, 16))
+}
+
+func TestIOBudgetPacesToRate(t *testing.T) {
+	now := time.Unix(0, 0)
+	var slept []time.Duration
+	b := newIOBudget(1000)
+	b.now = func() time.Time { return now }
+	b.sleep = func(ctx context.Context, d time.Duration) error {
+		slept = append(slept, d)
+		now = now.Add(d)
+		return nil
+	}
+	b.reset()
+
+	ctx := context.Background()
+	require.NoError(t, b.spend(ctx, 500))
+	assert.Equal(t, []time.Duration{500 * time.Millisecond}, slept)
+
+	// 批次本身耗时超过配额时不再等待
+	now = now.Add(2 * time.Second)
+	require.NoError(t, b.spend(ctx, 1000))
+	assert.Len(t, slept, 1)
+
+	// 累计 3000 行应在第 3 秒完成，当前在第 2.5 秒
+	require.NoError(t, b.spend(ctx, 1500))
+	assert.Equal(t, []time.Duration{500 * time.Millisecond, 500 * time.Millisecond}, slept)
+}
+
+func TestIOBudgetUnlimited(t *testing.T) {
+	b := newIOBudget(0)
+	b.sleep = func(ctx context.Context, d time.Duration) error {
+		t.Fatal("unlimited budget should never sleep")
+		return nil
+	}
+	b.reset()
+	assert.NoError(t, b.spend(context.Background(), 1<<20))
+
+	ctx, cancel := context.WithCancel(context.Background())
+	cancel()
+	assert.ErrorIs(t, b.spend(ctx, 1), context.Canceled)
+}
+
+func TestIOBudgetHonoursCancellation(t *testing.T) {
+	b := newIOBudget(1)
+	b.reset()
+	ctx, cancel := context.WithCancel(context.Background())
+	cancel()
+	assert.ErrorIs(t, b.spend(ctx, 3600), context.Canceled)
+}
+
+func TestCompactorRejectsConcurrentRun(t *testing.T) {
+	c := NewCompactor(&DB{}, DefaultCompactionConfig())
+	c.running.Store(true)
+	_, err := c.Run(context.Background())
+	assert.ErrorIs(t, err, ErrCompactionRunning)
+}
+
+func TestCompactorStartStopWithoutInterval(t *testing.T) {
+	cfg := DefaultCompactionConfig()
+	cfg.Interval = 0
+	c := NewCompactor(&DB{}, cfg)
+	c.Start()
+	c.Stop()
+	assert.Nil(t, c.LastRun())
+}
@@ -31,8 +31,19 @@ func SetDBLogger(logger *utils.Logger) {
 }
 
 // DB represents the database connection
+//
+// The embedded *sql.DB is the interactive pool used by API reads. When a bulk
+// pool is configured (DatabaseConfig.BulkMaxOpenConns > 0), long indexing
+// transactions run on a separate pool obtained via Bulk(), so they cannot
+// exhaust the connections that search and graph queries need.
 type DB struct {
 	*sql.DB
+
+	bulk        *DB
+	interactive *sql.DB // set on the bulk pool: the pool it was split from
+	controller  *PoolController
+	generations *IndexGenerations
+	stats       *QueryStats
 }
 
 // NewDB creates a new database connection using default configuration
@@ -46,6 +57,61 @@ func NewDB() (*DB, error) {
 
 // NewDBWithConfig creates a new database connection with provided configuration
 func NewDBWithConfig(cfg *config.DatabaseConfig) (*DB, error) {
+	db, err := openPool(cfg, cfg.MaxOpenConns, cfg.MaxIdleConns)
+	if err != nil {
+		return nil, err
+	}
+
+	if dbLogger != nil {
+		dbLogger.Debugf("Successfully connected to database at %s:%d (pool: %d max, %d idle, lifetime: %s)",
+			cfg.Host, cfg.Port, cfg.MaxOpenConns, cfg.MaxIdleConns, cfg.ConnMaxLifetime)
+
+		// Log connection pool statistics
+		stats := db.Stats()
+		dbLogger.Debugf("Initial connection pool stats - Open: %d, InUse: %d, Idle: %d",
+			stats.OpenConnections, stats.InUse, stats.Idle)
+	}
+
+	result := &DB{DB: db, generations: NewIndexGenerations()}
+	// 条件 GET 的验证器以持久化的 index_generation 为准，其他进程的写入在一个 TTL 内可见
+	result.generations.SetLoader(NewRepositoryRepository(result).ListIndexGenerations, cfg.GenerationTTL)
+	if cfg.QueryStats {
+		statsCfg := DefaultQueryStatsConfig()
+		statsCfg.SlowThreshold = cfg.SlowQueryThreshold
+		statsCfg.ExplainSampleRate = cfg.ExplainSampleRate
+		result.stats = NewQueryStats(statsCfg)
+	}
+
+	// Separate pool for bulk-write work (indexing)
+	var bulkLane *poolLane
+	if cfg.BulkMaxOpenConns > 0 {
+		bulk, err := openPool(cfg, cfg.BulkMaxOpenConns, cfg.BulkMaxIdleConns)
+		if err != nil {
+			db.Close()
+			return nil, fmt.Errorf("failed to open bulk pool: %w", err)
+		}
+		result.bulk = &DB{DB: bulk, interactive: db, generations: result.generations, stats: result.stats}
+		bulkLane = &poolLane{name: PoolLaneBulk, db: bulk, base: cfg.BulkMaxOpenConns, maxIdle: cfg.BulkMaxIdleConns}
+		if dbLogger != nil {
+			dbLogger.Debugf("Bulk connection pool enabled (pool: %d max, %d idle)", cfg.BulkMaxOpenConns, cfg.BulkMaxIdleConns)
+		}
+	}
+
+	if cfg.PoolAutoTune {
+		controllerCfg := DefaultPoolControllerConfig()
+		controllerCfg.Interval = cfg.PoolTuneInterval
+		controllerCfg.LatencyTarget = cfg.PoolLatencyTarget
+		controllerCfg.MaxTotalConns = cfg.PoolMaxTotalConns
+		interactiveLane := &poolLane{name: PoolLaneInteractive, db: db, base: cfg.MaxOpenConns, maxIdle: cfg.MaxIdleConns}
+		result.controller = newPoolController(controllerCfg, interactiveLane, bulkLane)
+		result.controller.Start()
+	}
+
+	return result, nil
+}
+
+// openPool opens and pings one connection pool with the given size limits
+func openPool(cfg *config.DatabaseConfig, maxOpen, maxIdle int) (*sql.DB, error) {
 	// Create connection string
 	connStr := cfg.ConnectionString()
 
@@ -56,27 +122,86 @@ func NewDBWithConfig(cfg *config.DatabaseConfig) (*DB, error) {
 	}
 
 	// Configure connection pool with optimized settings
-	db.SetMaxOpenConns(cfg.MaxOpenConns)
-	db.SetMaxIdleConns(cfg.MaxIdleConns)
+	db.SetMaxOpenConns(maxOpen)
+	db.SetMaxIdleConns(maxIdle)
 	db.SetConnMaxLifetime(cfg.ConnMaxLifetime)
 	db.SetConnMaxIdleTime(cfg.ConnMaxIdleTime)
 
 	// Test the connection
 	if err := db.Ping(); err != nil {
+		db.Close()
 		return nil, fmt.Errorf("failed to ping database: %w", err)
 	}
+	return db, nil
+}
 
-	if dbLogger != nil {
-		dbLogger.Debugf("Successfully connected to database at %s:%d (pool: %d max, %d idle, lifetime: %s)",
-			cfg.Host, cfg.Port, cfg.MaxOpenConns, cfg.MaxIdleConns, cfg.ConnMaxLifetime)
-		
-		// Log connection pool statistics
-		stats := db.Stats()
-		dbLogger.Debugf("Initial connection pool stats - Open: %d, InUse: %d, Idle: %d",
-			stats.OpenConnections, stats.InUse, stats.Idle)
+// Bulk returns the connection pool reserved for bulk-write work such as
+// indexing transactions. Without a configured bulk pool it returns db itself.
+func (db *DB) Bulk() *DB {
+	if db == nil || db.bulk == nil {
+		return db
+	}
+	return db.bulk
+}
+
+// lockPool returns the pool to pin a session from when holding a session-level
+// lock while other work runs on db: the other pool of a pair, so the lock
+// never takes a connection the work under it needs
+func (db *DB) lockPool() *sql.DB {
+	switch {
+	case db.bulk != nil:
+		return db.bulk.DB
+	case db.interactive != nil:
+		return db.interactive
+	}
+	return db.DB
+}
+
+// Generations returns the index generation cache shared by all pools, or nil
+// when the DB was not created through NewDBWithConfig
+func (db *DB) Generations() *IndexGenerations {
+	if db == nil {
+		return nil
 	}
-	
-	return &DB{db}, nil
+	return db.generations
+}
+
+// PoolController returns the adaptive pool controller, or nil when auto-tuning is disabled
+func (db *DB) PoolController() *PoolController {
+	return db.controller
+}
+
+// PoolStatus returns the current pool limits and stats for inspection. When the
+// controller is enabled it also includes its recent decisions.
+func (db *DB) PoolStatus() PoolStatus {
+	if db.controller != nil {
+		return db.controller.Status()
+	}
+	status := PoolStatus{Decisions: []PoolDecision{}}
+	if db.DB == nil {
+		return status
+	}
+	limit := db.Stats().MaxOpenConnections
+	status.Lanes = append(status.Lanes, laneStatus(PoolLaneInteractive, db.DB, limit, limit, limit))
+	if db.bulk != nil && db.bulk.DB != nil {
+		limit := db.bulk.Stats().MaxOpenConnections
+		status.Lanes = append(status.Lanes, laneStatus(PoolLaneBulk, db.bulk.DB, limit, limit, limit))
+	}
+	return status
+}
+
+// Close stops the pool controller and closes all connection pools
+func (db *DB) Close() error {
+	if db.controller != nil {
+		db.controller.Stop()
+	}
+	if db.bulk != nil {
+		db.bulk.Close()
+	}
+	if db.DB == nil {
+		return nil
+	}
+	return db.DB.Close()
 }
 
 // getEnv retrieves environment variable or returns default value
@@ -121,6 +246,11 @@ func (db *DB) LogPoolStats() {
 	if dbLogger == nil {
 		return
 	}
+	if db.bulk != nil {
+		bulkStats := db.bulk.Stats()
+		dbLogger.Debugf("Bulk connection pool stats - Open: %d, InUse: %d, Idle: %d, WaitCount: %d, WaitDuration: %s",
+			bulkStats.OpenConnections, bulkStats.InUse, bulkStats.Idle, bulkStats.WaitCount, bulkStats.WaitDuration)
+	}
 	stats := db.Stats()
 	dbLogger.Debugf("Connection pool stats - Open: %d, InUse: %d, Idle: %d, WaitCount: %d, WaitDuration: %s, MaxIdleClosed: %d, MaxLifetimeClosed: %d",
 		stats.OpenConnections,
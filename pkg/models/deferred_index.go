@@ -0,0 +1,94 @@
+package models
+
+import (
+	"context"
+	"database/sql"
+	"fmt"
+
+	"github.com/lib/pq"
+)
+
+// IndexDefinition is a secondary index dropped for a bulk load, with the DDL
+// that recreates it
+type IndexDefinition struct {
+	Table      string
+	Name       string
+	Definition string
+}
+
+// secondaryIndexesQuery lists the indexes of the given tables that do not back
+// a constraint (primary keys and unique constraints stay, since foreign keys
+// and ON CONFLICT depend on them)
+const secondaryIndexesQuery = `
+	SELECT tc.relname, ic.relname, pg_get_indexdef(i.indexrelid)
+	FROM pg_index i
+	JOIN pg_class ic ON ic.oid = i.indexrelid
+	JOIN pg_class tc ON tc.oid = i.indrelid
+	JOIN pg_namespace n ON n.oid = tc.relnamespace
+	WHERE n.nspname = current_schema()
+	  AND tc.relname = ANY($1)
+	  AND NOT EXISTS (SELECT 1 FROM pg_constraint c WHERE c.conrelid = tc.oid AND c.conindid = i.indexrelid)
+	ORDER BY tc.relname, ic.relname
+`
+
+// DropSecondaryIndexes drops the secondary indexes of tables inside tx and
+// returns their definitions for RecreateIndexes. Loading rows into a table
+// without indexes and building each index once afterwards is much cheaper
+// than maintaining every index (HNSW above all) row by row.
+//
+// DROP INDEX takes an ACCESS EXCLUSIVE lock on the table until tx ends, so
+// this is meant for loads into empty tables, such as seeding a new database.
+func DropSecondaryIndexes(ctx context.Context, tx *sql.Tx, tables []string) ([]IndexDefinition, error) {
+	rows, err := tx.QueryContext(ctx, secondaryIndexesQuery, pq.Array(tables))
+	if err != nil {
+		return nil, fmt.Errorf("failed to list indexes: %w", err)
+	}
+	var defs []IndexDefinition
+	for rows.Next() {
+		var def IndexDefinition
+		if err := rows.Scan(&def.Table, &def.Name, &def.Definition); err != nil {
+			rows.Close()
+			return nil, err
+		}
+		defs = append(defs, def)
+	}
+	rows.Close()
+	if err := rows.Err(); err != nil {
+		return nil, err
+	}
+
+	for _, def := range defs {
+		if _, err := tx.ExecContext(ctx, "DROP INDEX "+pq.QuoteIdentifier(def.Name)); err != nil {
+			return nil, fmt.Errorf("failed to drop index %s: %w", def.Name, err)
+		}
+	}
+	if dbLogger != nil && len(defs) > 0 {
+		dbLogger.Debugf("Dropped %d secondary indexes for bulk load", len(defs))
+	}
+	return defs, nil
+}
+
+// RecreateIndexes rebuilds indexes dropped by DropSecondaryIndexes
+func RecreateIndexes(ctx context.Context, tx *sql.Tx, defs []IndexDefinition) error {
+	for _, def := range defs {
+		if _, err := tx.ExecContext(ctx, def.Definition); err != nil {
+			return fmt.Errorf("failed to recreate index %s: %w", def.Name, err)
+		}
+	}
+	return nil
+}
+
+// TablesEmpty reports whether none of tables has any row
+func TablesEmpty(ctx context.Context, tx *sql.Tx, tables []string) (bool, error) {
+	for _, table := range tables {
+		var exists bool
+		query := "SELECT EXISTS (SELECT 1 FROM " + pq.QuoteIdentifier(table) + ")"
+		if err := tx.QueryRowContext(ctx, query).Scan(&exists); err != nil {
+			return false, err
+		}
+		if exists {
+			return false, nil
+		}
+	}
+	return true, nil
+}
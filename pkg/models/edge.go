@@ -17,10 +17,14 @@ type Edge struct {
 	EdgeType     string    `json:"edge_type" db:"edge_type"`
 	SourceFile   string    `json:"source_file" db:"source_file"`
 	TargetFile   *string   `json:"target_file" db:"target_file"`
-	TargetModule *string   `json:"target_module" db:"target_module"`
+	TargetModule *string   `json:"target_module" db:"target_module"`       // Stored interned in external_modules
+	TargetName   *string   `json:"target_name,omitempty" db:"target_name"` // Bare target name, written for Compactor re-resolution only
 	CreatedAt    time.Time `json:"created_at" db:"created_at"`
 }
 
+// edgesWithModule joins each edge with its interned target module (m.name)
+const edgesWithModule = `edges LEFT JOIN external_modules m ON m.module_id = edges.target_module_id`
+
 // EdgeRepository handles CRUD operations for edges
 type EdgeRepository struct {
 	db *DB
@@ -33,23 +37,27 @@ func NewEdgeRepository(db *DB) *EdgeRepository {
 
 // Create inserts a new edge record
 func (r *EdgeRepository) Create(ctx context.Context, edge *Edge) error {
+	modules, err := InternExternalModules(ctx, r.db, edgeModuleNames([]*Edge{edge}))
+	if err != nil {
+		return err
+	}
 	query := `
-		INSERT INTO edges (edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at)
-		VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
+		INSERT INTO edges (edge_id, source_id, target_id, edge_type, source_file, target_file, target_module_id, target_name, created_at)
+		VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9)
 	`
 	edge.CreatedAt = time.Now()
 
-	_, err := r.db.ExecContext(ctx, query,
+	_, err = r.db.ExecContext(ctx, query,
 		edge.EdgeID, edge.SourceID, edge.TargetID, edge.EdgeType,
-		edge.SourceFile, edge.TargetFile, edge.TargetModule, edge.CreatedAt)
+		edge.SourceFile, edge.TargetFile, moduleID(modules, edge.TargetModule), edge.TargetName, edge.CreatedAt)
 	return err
 }
 
 // GetByID retrieves an edge by its ID
 func (r *EdgeRepository) GetByID(ctx context.Context, edgeID string) (*Edge, error) {
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges WHERE edge_id = $1
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + ` WHERE edge_id = $1
 	`
 	var edge Edge
 	err := r.db.QueryRowContext(ctx, query, edgeID).Scan(
@@ -67,8 +75,8 @@ func (r *EdgeRepository) GetByID(ctx context.Context, edgeID string) (*Edge, err
 // GetBySourceID retrieves all edges originating from a source symbol
 func (r *EdgeRepository) GetBySourceID(ctx context.Context, sourceID string) ([]*Edge, error) {
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges WHERE source_id = $1 ORDER BY edge_type, created_at
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + ` WHERE source_id = $1 ORDER BY edge_type, created_at
 	`
 	rows, err := r.db.QueryContext(ctx, query, sourceID)
 	if err != nil {
@@ -93,8 +101,8 @@ func (r *EdgeRepository) GetBySourceID(ctx context.Context, sourceID string) ([]
 // GetByTargetID retrieves all edges pointing to a target symbol
 func (r *EdgeRepository) GetByTargetID(ctx context.Context, targetID string) ([]*Edge, error) {
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges WHERE target_id = $1 ORDER BY edge_type, created_at
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + ` WHERE target_id = $1 ORDER BY edge_type, created_at
 	`
 	rows, err := r.db.QueryContext(ctx, query, targetID)
 	if err != nil {
@@ -119,8 +127,8 @@ func (r *EdgeRepository) GetByTargetID(ctx context.Context, targetID string) ([]
 // GetByType retrieves edges filtered by type
 func (r *EdgeRepository) GetByType(ctx context.Context, edgeType string) ([]*Edge, error) {
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges WHERE edge_type = $1 ORDER BY created_at
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + ` WHERE edge_type = $1 ORDER BY created_at
 	`
 	rows, err := r.db.QueryContext(ctx, query, edgeType)
 	if err != nil {
@@ -145,8 +153,8 @@ func (r *EdgeRepository) GetByType(ctx context.Context, edgeType string) ([]*Edg
 // GetBySourceAndType retrieves edges by source ID and type
 func (r *EdgeRepository) GetBySourceAndType(ctx context.Context, sourceID, edgeType string) ([]*Edge, error) {
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges WHERE source_id = $1 AND edge_type = $2 ORDER BY created_at
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + ` WHERE source_id = $1 AND edge_type = $2 ORDER BY created_at
 	`
 	rows, err := r.db.QueryContext(ctx, query, sourceID, edgeType)
 	if err != nil {
@@ -171,8 +179,8 @@ func (r *EdgeRepository) GetBySourceAndType(ctx context.Context, sourceID, edgeT
 // GetByTargetAndType retrieves edges by target ID and type
 func (r *EdgeRepository) GetByTargetAndType(ctx context.Context, targetID, edgeType string) ([]*Edge, error) {
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges WHERE target_id = $1 AND edge_type = $2 ORDER BY created_at
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + ` WHERE target_id = $1 AND edge_type = $2 ORDER BY created_at
 	`
 	rows, err := r.db.QueryContext(ctx, query, targetID, edgeType)
 	if err != nil {
@@ -196,14 +204,18 @@ func (r *EdgeRepository) GetByTargetAndType(ctx context.Context, targetID, edgeT
 
 // Update updates an existing edge record
 func (r *EdgeRepository) Update(ctx context.Context, edge *Edge) error {
+	modules, err := InternExternalModules(ctx, r.db, edgeModuleNames([]*Edge{edge}))
+	if err != nil {
+		return err
+	}
 	query := `
 		UPDATE edges 
-		SET target_id = $3, edge_type = $4, source_file = $5, target_file = $6, target_module = $7
+		SET target_id = $3, edge_type = $4, source_file = $5, target_file = $6, target_module_id = $7
 		WHERE edge_id = $1 AND source_id = $2
 	`
 	result, err := r.db.ExecContext(ctx, query,
 		edge.EdgeID, edge.SourceID, edge.TargetID, edge.EdgeType,
-		edge.SourceFile, edge.TargetFile, edge.TargetModule)
+		edge.SourceFile, edge.TargetFile, moduleID(modules, edge.TargetModule))
 	if err != nil {
 		return err
 	}
@@ -242,16 +254,22 @@ func (r *EdgeRepository) BatchCreate(ctx context.Context, edges []*Edge) error {
 		return nil
 	}
 
+	modules, err := InternExternalModules(ctx, r.db, edgeModuleNames(edges))
+	if err != nil {
+		return err
+	}
+
 	query := `
-		INSERT INTO edges (edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at)
-		VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
+		INSERT INTO edges (edge_id, source_id, target_id, edge_type, source_file, target_file, target_module_id, target_name, created_at)
+		VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9)
 		ON CONFLICT (edge_id)
 		DO UPDATE SET
 			target_id = EXCLUDED.target_id,
 			edge_type = EXCLUDED.edge_type,
 			source_file = EXCLUDED.source_file,
 			target_file = EXCLUDED.target_file,
-			target_module = EXCLUDED.target_module
+			target_module_id = EXCLUDED.target_module_id,
+			target_name = EXCLUDED.target_name
 	`
 
 	stmt, err := r.db.PrepareContext(ctx, query)
@@ -266,7 +284,7 @@ func (r *EdgeRepository) BatchCreate(ctx context.Context, edges []*Edge) error {
 
 		_, err := stmt.ExecContext(ctx,
 			edge.EdgeID, edge.SourceID, edge.TargetID, edge.EdgeType,
-			edge.SourceFile, edge.TargetFile, edge.TargetModule, edge.CreatedAt)
+			edge.SourceFile, edge.TargetFile, moduleID(modules, edge.TargetModule), edge.TargetName, edge.CreatedAt)
 		if err != nil {
 			return fmt.Errorf("failed to insert edge %s: %w", edge.EdgeID, err)
 		}
@@ -275,22 +293,31 @@ func (r *EdgeRepository) BatchCreate(ctx context.Context, edges []*Edge) error {
 	return nil
 }
 
-// BatchCreateTx inserts multiple edges within a transaction
-func (r *EdgeRepository) BatchCreateTx(ctx context.Context, tx *sql.Tx, edges []*Edge) error {
+// InternModules interns the target modules of edges (see
+// InternExternalModules). Call it before opening the transaction passed to
+// BatchCreateTx.
+func (r *EdgeRepository) InternModules(ctx context.Context, edges []*Edge) (map[string]int64, error) {
+	return InternExternalModules(ctx, r.db, edgeModuleNames(edges))
+}
+
+// BatchCreateTx inserts multiple edges within a transaction. modules maps
+// target module names to the ids returned by InternModules.
+func (r *EdgeRepository) BatchCreateTx(ctx context.Context, tx *sql.Tx, edges []*Edge, modules map[string]int64) error {
 	if len(edges) == 0 {
 		return nil
 	}
 
 	query := `
-		INSERT INTO edges (edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at)
-		VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
+		INSERT INTO edges (edge_id, source_id, target_id, edge_type, source_file, target_file, target_module_id, target_name, created_at)
+		VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9)
 		ON CONFLICT (edge_id) 
 		DO UPDATE SET 
 			target_id = EXCLUDED.target_id,
 			edge_type = EXCLUDED.edge_type,
 			source_file = EXCLUDED.source_file,
 			target_file = EXCLUDED.target_file,
-			target_module = EXCLUDED.target_module
+			target_module_id = EXCLUDED.target_module_id,
+			target_name = EXCLUDED.target_name
 	`
 
 	stmt, err := tx.PrepareContext(ctx, query)
@@ -304,7 +331,7 @@ func (r *EdgeRepository) BatchCreateTx(ctx context.Context, tx *sql.Tx, edges []
 		edge.CreatedAt = now
 		_, err := stmt.ExecContext(ctx,
 			edge.EdgeID, edge.SourceID, edge.TargetID, edge.EdgeType,
-			edge.SourceFile, edge.TargetFile, edge.TargetModule, edge.CreatedAt)
+			edge.SourceFile, edge.TargetFile, moduleID(modules, edge.TargetModule), edge.TargetName, edge.CreatedAt)
 		if err != nil {
 			return fmt.Errorf("failed to insert edge %s: %w", edge.EdgeID, err)
 		}
@@ -330,8 +357,8 @@ func (r *EdgeRepository) DeleteByTargetID(ctx context.Context, targetID string)
 // GetCallRelationships retrieves call relationships (caller -> callee)
 func (r *EdgeRepository) GetCallRelationships(ctx context.Context, symbolID string) ([]*Edge, error) {
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges 
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + `
 		WHERE (source_id = $1 OR target_id = $1) AND edge_type = 'call'
 		ORDER BY created_at
 	`
@@ -358,8 +385,8 @@ func (r *EdgeRepository) GetCallRelationships(ctx context.Context, symbolID stri
 // GetImportRelationships retrieves import relationships
 func (r *EdgeRepository) GetImportRelationships(ctx context.Context, symbolID string) ([]*Edge, error) {
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges 
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + `
 		WHERE (source_id = $1 OR target_id = $1) AND edge_type = 'import'
 		ORDER BY created_at
 	`
@@ -386,8 +413,8 @@ func (r *EdgeRepository) GetImportRelationships(ctx context.Context, symbolID st
 // GetInheritanceRelationships retrieves inheritance relationships (extends/implements)
 func (r *EdgeRepository) GetInheritanceRelationships(ctx context.Context, symbolID string) ([]*Edge, error) {
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges 
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + `
 		WHERE (source_id = $1 OR target_id = $1) AND edge_type IN ('extends', 'implements')
 		ORDER BY edge_type, created_at
 	`
@@ -418,8 +445,8 @@ func (r *EdgeRepository) GetEdgesByTypes(ctx context.Context, edgeTypes []string
 	}
 
 	query := `
-		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at
-		FROM edges WHERE edge_type = ANY($1) ORDER BY edge_type, created_at
+		SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at
+		FROM ` + edgesWithModule + ` WHERE edge_type = ANY($1) ORDER BY edge_type, created_at
 	`
 	rows, err := r.db.QueryContext(ctx, query, pq.Array(edgeTypes))
 	if err != nil {
@@ -514,14 +541,53 @@ const edgeDetailsColumns = `
 		e.edge_id, e.edge_type,
 		s.symbol_id, s.name, s.kind, s.signature,
 		f.path,
-		e.source_file, e.target_file, e.target_module
+		e.source_file, e.target_file, m.name
 	FROM edges e
 	JOIN symbols s ON s.symbol_id = %s
 	LEFT JOIN files f ON s.file_id = f.file_id
+	LEFT JOIN external_modules m ON m.module_id = e.target_module_id
 	WHERE %s
 	ORDER BY s.name
 `
 
+// edgeDetailsPage 与 edgeDetailsColumns 相同，但按 (s.name, e.edge_id) 做 keyset 分页：
+// $2/$3 是上一页最后一行的 name/edge_id（首页为空串与 zeroUUID），$4 是页大小。
+// 翻页代价与页码无关，结果集再大也只读一页。
+const edgeDetailsPage = `
+	SELECT
+		e.edge_id, e.edge_type,
+		s.symbol_id, s.name, s.kind, s.signature,
+		f.path,
+		e.source_file, e.target_file, m.name
+	FROM edges e
+	JOIN symbols s ON s.symbol_id = %s
+	LEFT JOIN files f ON s.file_id = f.file_id
+	LEFT JOIN external_modules m ON m.module_id = e.target_module_id
+	WHERE %s AND (s.name, e.edge_id) > ($2, $3::uuid)
+	ORDER BY s.name, e.edge_id
+	LIMIT $4
+`
+
+// GetCallersPage 返回调用给定符号的符号中排在 (afterName, afterEdgeID) 之后的至多 limit 个。
+// afterEdgeID 为空时从头开始。
+func (r *EdgeRepository) GetCallersPage(ctx context.Context, targetSymbolID, afterName, afterEdgeID string, limit int) ([]*EdgeWithDetails, error) {
+	query := fmt.Sprintf(edgeDetailsPage, "e.source_id", "e.target_id = $1 AND e.edge_type = 'call'")
+	return r.queryEdgesWithDetails(ctx, query, targetSymbolID, afterName, pageCursor(afterEdgeID), limit)
+}
+
+// GetCalleesPage 是 GetCalleesWithDetails 的分页版本，参数同 GetCallersPage。
+func (r *EdgeRepository) GetCalleesPage(ctx context.Context, sourceSymbolID, afterName, afterEdgeID string, limit int) ([]*EdgeWithDetails, error) {
+	query := fmt.Sprintf(edgeDetailsPage, "e.target_id", "e.source_id = $1 AND e.edge_type = 'call'")
+	return r.queryEdgesWithDetails(ctx, query, sourceSymbolID, afterName, pageCursor(afterEdgeID), limit)
+}
+
+func pageCursor(edgeID string) string {
+	if edgeID == "" {
+		return zeroUUID
+	}
+	return edgeID
+}
+
 // GetCallersWithDetails 返回调用给定符号的所有符号（含详情），一次 JOIN 消除 N+1。
 // caller 是边的 source，给定符号是 target。
 func (r *EdgeRepository) GetCallersWithDetails(ctx context.Context, targetSymbolID string) ([]*EdgeWithDetails, error) {
@@ -544,10 +610,11 @@ func (r *EdgeRepository) GetDependenciesWithDetails(ctx context.Context, sourceS
 		e.edge_id, e.edge_type,
 		s.symbol_id, s.name, s.kind, s.signature,
 		f.path,
-		e.source_file, e.target_file, e.target_module
+		e.source_file, e.target_file, m.name
 	FROM edges e
 	JOIN symbols s ON s.symbol_id = e.target_id
 	LEFT JOIN files f ON s.file_id = f.file_id
+	LEFT JOIN external_modules m ON m.module_id = e.target_module_id
 	WHERE e.source_id = $1
 	  AND e.edge_type IN ('import', 'extends', 'implements', 'reference')
 	  AND e.target_id IS NOT NULL
@@ -564,20 +631,41 @@ func (r *EdgeRepository) GetExternalDependencies(ctx context.Context, sourceSymb
 		e.edge_id, e.edge_type,
 		'' AS symbol_id, '' AS name, '' AS kind, '' AS signature,
 		'' AS path,
-		e.source_file, e.target_file, e.target_module
+		e.source_file, e.target_file, m.name
 	FROM edges e
+	JOIN external_modules m ON m.module_id = e.target_module_id
 	WHERE e.source_id = $1
 	  AND e.edge_type IN ('import', 'extends', 'implements', 'reference')
 	  AND e.target_id IS NULL
-	  AND e.target_module IS NOT NULL
-	ORDER BY e.edge_type, e.target_module
+	ORDER BY e.edge_type, m.name
 	`
 	return r.queryEdgesWithDetails(ctx, query, sourceSymbolID)
 }
 
+// GetModuleDependents 返回导入外部模块 module 的符号（"谁在用 libcurl"）。prefix 为 true
+// 时匹配以 module 开头的所有模块（如 "curl/" 匹配 curl/curl.h、curl/easy.h）；repoID
+// 非空时只查该仓库。先按 external_modules.name 取键，再走 idx_edges_target_module。
+func (r *EdgeRepository) GetModuleDependents(ctx context.Context, module string, prefix bool, repoID string) ([]*EdgeWithDetails, error) {
+	query := `
+	SELECT
+		e.edge_id, e.edge_type,
+		s.symbol_id, s.name, s.kind, s.signature,
+		f.path,
+		e.source_file, e.target_file, m.name
+	FROM external_modules m
+	JOIN edges e ON e.target_module_id = m.module_id
+	JOIN symbols s ON s.symbol_id = e.source_id
+	JOIN files f ON s.file_id = f.file_id
+	WHERE (m.name = $1 OR ($2 AND starts_with(m.name, $1)))
+	  AND ($3 = '' OR f.repo_id::text = $3)
+	ORDER BY m.name, f.path, s.name
+	`
+	return r.queryEdgesWithDetails(ctx, query, module, prefix, repoID)
+}
+
 // queryEdgesWithDetails 执行 JOIN 查询并扫描为 EdgeWithDetails 切片。
-func (r *EdgeRepository) queryEdgesWithDetails(ctx context.Context, query, arg string) ([]*EdgeWithDetails, error) {
-	rows, err := r.db.QueryContext(ctx, query, arg)
+func (r *EdgeRepository) queryEdgesWithDetails(ctx context.Context, query string, args ...interface{}) ([]*EdgeWithDetails, error) {
+	rows, err := r.db.QueryContext(ctx, query, args...)
 	if err != nil {
 		return nil, err
 	}
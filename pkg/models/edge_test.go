@@ -633,3 +633,99 @@ func TestEdgeRepository_Count(t *testing.T) {
 		t.Errorf("Expected non-negative count, got %d", initialCount)
 	}
 }
+
+func TestEdgeRepository_ExternalModules(t *testing.T) {
+	if testing.Short() {
+		t.Skip("Skipping integration test in short mode")
+	}
+
+	testDB := SetupTestDB(t)
+	defer testDB.TeardownTestDB(t)
+
+	ctx := context.Background()
+	repoRepo := NewRepositoryRepository(testDB.DB)
+	fileRepo := NewFileRepository(testDB.DB)
+	symbolRepo := NewSymbolRepository(testDB.DB)
+	edgeRepo := NewEdgeRepository(testDB.DB)
+
+	repo := &Repository{
+		RepoID: uuid.New().String(),
+		Name:   "test-repo-modules",
+		URL:    "https://github.com/test/modules",
+		Branch: "main",
+	}
+	if err := repoRepo.Create(ctx, repo); err != nil {
+		t.Fatalf("Failed to create repository: %v", err)
+	}
+	defer repoRepo.Delete(ctx, repo.RepoID)
+
+	file := &File{
+		FileID:   uuid.New().String(),
+		RepoID:   repo.RepoID,
+		Path:     "src/http.c",
+		Language: "c",
+		Size:     512,
+		Checksum: "mod123",
+	}
+	if err := fileRepo.Create(ctx, file); err != nil {
+		t.Fatalf("Failed to create file: %v", err)
+	}
+
+	var edges []*Edge
+	for i, name := range []string{"fetch_url", "post_form"} {
+		symbol := &Symbol{
+			SymbolID:  uuid.New().String(),
+			FileID:    file.FileID,
+			Name:      name,
+			Kind:      "function",
+			StartLine: 10 * (i + 1),
+			EndLine:   10*(i+1) + 5,
+		}
+		if err := symbolRepo.Create(ctx, symbol); err != nil {
+			t.Fatalf("Failed to create symbol: %v", err)
+		}
+		module := "curl/curl.h"
+		edges = append(edges, &Edge{
+			EdgeID:       uuid.New().String(),
+			SourceID:     symbol.SymbolID,
+			EdgeType:     "import",
+			SourceFile:   file.Path,
+			TargetModule: &module,
+		})
+	}
+	if err := edgeRepo.BatchCreate(ctx, edges); err != nil {
+		t.Fatalf("Failed to create edges: %v", err)
+	}
+
+	// 同名模块只存一份
+	var modules int
+	if err := testDB.DB.QueryRowContext(ctx, `SELECT COUNT(*) FROM external_modules WHERE name = 'curl/curl.h'`).Scan(&modules); err != nil {
+		t.Fatalf("Failed to count modules: %v", err)
+	}
+	if modules != 1 {
+		t.Errorf("Expected 1 interned module, got %d", modules)
+	}
+
+	retrieved, err := edgeRepo.GetByID(ctx, edges[0].EdgeID)
+	if err != nil || retrieved == nil {
+		t.Fatalf("Failed to retrieve edge: %v", err)
+	}
+	if retrieved.TargetModule == nil || *retrieved.TargetModule != "curl/curl.h" {
+		t.Errorf("Expected target module curl/curl.h, got %v", retrieved.TargetModule)
+	}
+
+	dependents, err := edgeRepo.GetModuleDependents(ctx, "curl/", true, repo.RepoID)
+	if err != nil {
+		t.Fatalf("Failed to query module dependents: %v", err)
+	}
+	if len(dependents) != 2 {
+		t.Errorf("Expected 2 dependents, got %d", len(dependents))
+	}
+	exact, err := edgeRepo.GetModuleDependents(ctx, "curl/", false, repo.RepoID)
+	if err != nil {
+		t.Fatalf("Failed to query module dependents: %v", err)
+	}
+	if len(exact) != 0 {
+		t.Errorf("Exact match should not match a prefix, got %d", len(exact))
+	}
+}
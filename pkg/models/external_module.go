@@ -0,0 +1,75 @@
+package models
+
+import (
+	"context"
+	"fmt"
+
+	"github.com/lib/pq"
+)
+
+// InternExternalModules returns the module_id of each name, adding the names
+// not seen before to external_modules. The table is shared by all
+// repositories, so a module imported everywhere is stored once.
+//
+// Writers call it on db before opening their write transaction. Each statement
+// then commits on its own, so the unique-index entry of a new name is held only
+// for the insert instead of until a long indexing transaction commits, and the
+// names are inserted in sorted order: concurrent indexing runs never wait on
+// each other's modules in a cycle. The insert and the lookup are separate
+// statements: under READ COMMITTED the lookup sees names that a concurrent
+// transaction committed while the insert skipped them as conflicts.
+func InternExternalModules(ctx context.Context, db *DB, names []string) (map[string]int64, error) {
+	ids := make(map[string]int64, len(names))
+	if len(names) == 0 {
+		return ids, nil
+	}
+
+	if _, err := db.ExecContext(ctx, `
+		INSERT INTO external_modules (name)
+		SELECT DISTINCT unnest($1::text[]) AS name ORDER BY name
+		ON CONFLICT (name) DO NOTHING
+	`, pq.Array(names)); err != nil {
+		return nil, fmt.Errorf("failed to intern external modules: %w", err)
+	}
+
+	rows, err := db.QueryContext(ctx, `SELECT module_id, name FROM external_modules WHERE name = ANY($1)`, pq.Array(names))
+	if err != nil {
+		return nil, fmt.Errorf("failed to look up external modules: %w", err)
+	}
+	defer rows.Close()
+	for rows.Next() {
+		var id int64
+		var name string
+		if err := rows.Scan(&id, &name); err != nil {
+			return nil, err
+		}
+		ids[name] = id
+	}
+	return ids, rows.Err()
+}
+
+// edgeModuleNames returns the distinct target modules of edges
+func edgeModuleNames(edges []*Edge) []string {
+	seen := make(map[string]bool)
+	var names []string
+	for _, edge := range edges {
+		if edge.TargetModule == nil || *edge.TargetModule == "" || seen[*edge.TargetModule] {
+			continue
+		}
+		seen[*edge.TargetModule] = true
+		names = append(names, *edge.TargetModule)
+	}
+	return names
+}
+
+// moduleID returns the interned key of an edge's target module, or nil (SQL
+// NULL) when the edge has none
+func moduleID(ids map[string]int64, module *string) interface{} {
+	if module == nil || *module == "" {
+		return nil
+	}
+	if id, ok := ids[*module]; ok {
+		return id
+	}
+	return nil
+}
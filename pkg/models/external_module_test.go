@@ -0,0 +1,29 @@
+package models
+
+import "testing"
+
+func TestEdgeModuleNames(t *testing.T) {
+	curl, java, empty := "curl/curl.h", "java.util.List", ""
+	edges := []*Edge{
+		{TargetModule: &curl},
+		{TargetModule: &java},
+		{TargetModule: &curl},
+		{TargetModule: &empty},
+		{},
+	}
+	names := edgeModuleNames(edges)
+	if len(names) != 2 || names[0] != curl || names[1] != java {
+		t.Errorf("expected distinct non-empty modules, got %v", names)
+	}
+
+	ids := map[string]int64{curl: 7}
+	if got := moduleID(ids, &curl); got != int64(7) {
+		t.Errorf("expected module id 7, got %v", got)
+	}
+	if got := moduleID(ids, &java); got != nil {
+		t.Errorf("unknown module should be NULL, got %v", got)
+	}
+	if got := moduleID(ids, nil); got != nil {
+		t.Errorf("edge without module should be NULL, got %v", got)
+	}
+}
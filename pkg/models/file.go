@@ -19,6 +19,10 @@ type File struct {
 	Checksum  string    `json:"checksum" db:"checksum"`
 	CreatedAt time.Time `json:"created_at" db:"created_at"`
 	UpdatedAt time.Time `json:"updated_at" db:"updated_at"`
+	// CanonicalFileID 指向内容相同、持有 AST 节点与向量的规范文件（本文件为副本时）
+	CanonicalFileID *string `json:"canonical_file_id,omitempty" db:"canonical_file_id"`
+	// APIOnly 表示只索引了声明的第三方 / vendored 文件（无调用边、AST 节点与向量）
+	APIOnly bool `json:"api_only,omitempty" db:"api_only"`
 }
 
 // FileRepository handles CRUD operations for files
@@ -34,8 +38,8 @@ func NewFileRepository(db *DB) *FileRepository {
 // Create inserts a new file record
 func (r *FileRepository) Create(ctx context.Context, file *File) error {
 	query := `
-		INSERT INTO files (file_id, repo_id, path, language, size, checksum, created_at, updated_at)
-		VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
+		INSERT INTO files (file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only)
+		VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10)
 	`
 	now := time.Now()
 	file.CreatedAt = now
@@ -43,20 +47,20 @@ func (r *FileRepository) Create(ctx context.Context, file *File) error {
 
 	_, err := r.db.ExecContext(ctx, query,
 		file.FileID, file.RepoID, file.Path, file.Language,
-		file.Size, file.Checksum, file.CreatedAt, file.UpdatedAt)
+		file.Size, file.Checksum, file.CreatedAt, file.UpdatedAt, file.CanonicalFileID, file.APIOnly)
 	return err
 }
 
 // GetByID retrieves a file by its ID
 func (r *FileRepository) GetByID(ctx context.Context, fileID string) (*File, error) {
 	query := `
-		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at
+		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only
 		FROM files WHERE file_id = $1
 	`
 	var file File
 	err := r.db.QueryRowContext(ctx, query, fileID).Scan(
 		&file.FileID, &file.RepoID, &file.Path, &file.Language,
-		&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt)
+		&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt, &file.CanonicalFileID, &file.APIOnly)
 	if err != nil {
 		if err == sql.ErrNoRows {
 			return nil, nil
@@ -69,13 +73,13 @@ func (r *FileRepository) GetByID(ctx context.Context, fileID string) (*File, err
 // GetByPath retrieves a file by repository ID and path
 func (r *FileRepository) GetByPath(ctx context.Context, repoID, path string) (*File, error) {
 	query := `
-		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at
+		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only
 		FROM files WHERE repo_id = $1 AND path = $2
 	`
 	var file File
 	err := r.db.QueryRowContext(ctx, query, repoID, path).Scan(
 		&file.FileID, &file.RepoID, &file.Path, &file.Language,
-		&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt)
+		&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt, &file.CanonicalFileID, &file.APIOnly)
 	if err != nil {
 		if err == sql.ErrNoRows {
 			return nil, nil
@@ -88,7 +92,7 @@ func (r *FileRepository) GetByPath(ctx context.Context, repoID, path string) (*F
 // GetByRepoID retrieves all files for a repository
 func (r *FileRepository) GetByRepoID(ctx context.Context, repoID string) ([]*File, error) {
 	query := `
-		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at
+		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only
 		FROM files WHERE repo_id = $1 ORDER BY path
 	`
 	rows, err := r.db.QueryContext(ctx, query, repoID)
@@ -102,7 +106,7 @@ func (r *FileRepository) GetByRepoID(ctx context.Context, repoID string) ([]*Fil
 		var file File
 		err := rows.Scan(
 			&file.FileID, &file.RepoID, &file.Path, &file.Language,
-			&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt)
+			&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt, &file.CanonicalFileID, &file.APIOnly)
 		if err != nil {
 			return nil, err
 		}
@@ -161,15 +165,19 @@ func (r *FileRepository) BatchCreate(ctx context.Context, files []*File) error {
 	}
 
 	query := `
-		INSERT INTO files (file_id, repo_id, path, language, size, checksum, created_at, updated_at)
-		VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
+		INSERT INTO files (file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only)
+		VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10)
 		ON CONFLICT (repo_id, path) 
 		DO UPDATE SET 
 			language = EXCLUDED.language,
 			size = EXCLUDED.size,
 			checksum = EXCLUDED.checksum,
-			updated_at = EXCLUDED.updated_at
+			updated_at = EXCLUDED.updated_at,
+			canonical_file_id = EXCLUDED.canonical_file_id,
+			api_only = EXCLUDED.api_only
 		WHERE files.checksum != EXCLUDED.checksum
+			OR files.canonical_file_id IS DISTINCT FROM EXCLUDED.canonical_file_id
+			OR files.api_only != EXCLUDED.api_only
 	`
 
 	stmt, err := r.db.PrepareContext(ctx, query)
@@ -184,7 +192,7 @@ func (r *FileRepository) BatchCreate(ctx context.Context, files []*File) error {
 		file.UpdatedAt = now
 		_, err := stmt.ExecContext(ctx,
 			file.FileID, file.RepoID, file.Path, file.Language,
-			file.Size, file.Checksum, file.CreatedAt, file.UpdatedAt)
+			file.Size, file.Checksum, file.CreatedAt, file.UpdatedAt, file.CanonicalFileID, file.APIOnly)
 		if err != nil {
 			return fmt.Errorf("failed to insert file %s: %w", file.Path, err)
 		}
@@ -200,15 +208,19 @@ func (r *FileRepository) BatchCreateTx(ctx context.Context, tx *sql.Tx, files []
 	}
 
 	query := `
-		INSERT INTO files (file_id, repo_id, path, language, size, checksum, created_at, updated_at)
-		VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
+		INSERT INTO files (file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only)
+		VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10)
 		ON CONFLICT (repo_id, path) 
 		DO UPDATE SET 
 			language = EXCLUDED.language,
 			size = EXCLUDED.size,
 			checksum = EXCLUDED.checksum,
-			updated_at = EXCLUDED.updated_at
+			updated_at = EXCLUDED.updated_at,
+			canonical_file_id = EXCLUDED.canonical_file_id,
+			api_only = EXCLUDED.api_only
 		WHERE files.checksum != EXCLUDED.checksum
+			OR files.canonical_file_id IS DISTINCT FROM EXCLUDED.canonical_file_id
+			OR files.api_only != EXCLUDED.api_only
 	`
 
 	stmt, err := tx.PrepareContext(ctx, query)
@@ -223,7 +235,7 @@ func (r *FileRepository) BatchCreateTx(ctx context.Context, tx *sql.Tx, files []
 		file.UpdatedAt = now
 		_, err := stmt.ExecContext(ctx,
 			file.FileID, file.RepoID, file.Path, file.Language,
-			file.Size, file.Checksum, file.CreatedAt, file.UpdatedAt)
+			file.Size, file.Checksum, file.CreatedAt, file.UpdatedAt, file.CanonicalFileID, file.APIOnly)
 		if err != nil {
 			return fmt.Errorf("failed to insert file %s: %w", file.Path, err)
 		}
@@ -247,7 +259,7 @@ func (r *FileRepository) GetChangedFiles(ctx context.Context, repoID string, fil
 	}
 
 	query := `
-		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at
+		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only
 		FROM files 
 		WHERE repo_id = $1 
 		AND path = ANY($2) 
@@ -266,7 +278,7 @@ func (r *FileRepository) GetChangedFiles(ctx context.Context, repoID string, fil
 		var file File
 		err := rows.Scan(
 			&file.FileID, &file.RepoID, &file.Path, &file.Language,
-			&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt)
+			&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt, &file.CanonicalFileID, &file.APIOnly)
 		if err != nil {
 			return nil, err
 		}
@@ -278,7 +290,7 @@ func (r *FileRepository) GetChangedFiles(ctx context.Context, repoID string, fil
 // GetFilesByLanguage retrieves files filtered by language
 func (r *FileRepository) GetFilesByLanguage(ctx context.Context, repoID, language string) ([]*File, error) {
 	query := `
-		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at
+		SELECT file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only
 		FROM files 
 		WHERE repo_id = $1 AND language = $2 
 		ORDER BY path
@@ -294,7 +306,7 @@ func (r *FileRepository) GetFilesByLanguage(ctx context.Context, repoID, languag
 		var file File
 		err := rows.Scan(
 			&file.FileID, &file.RepoID, &file.Path, &file.Language,
-			&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt)
+			&file.Size, &file.Checksum, &file.CreatedAt, &file.UpdatedAt, &file.CanonicalFileID, &file.APIOnly)
 		if err != nil {
 			return nil, err
 		}
@@ -168,17 +168,18 @@ type ExtractedEdge struct {
 // 对应 name，用于 symbol_id 精确匹配解决 C++ 重载同名问题）。
 //
 // target_id 取解析后的目标符号 ID；若未解析到（悬空），COALESCE 回空串。
-// target_name 取解析后的目标符号名；悬空时回退到 target_module
-// （对 import 边而言 target_module 是有意义的标识，如 "java.util.ArrayList"），
+// target_name 取解析后的目标符号名；悬空时回退到外部模块名（external_modules.name，
+// 对 import 边而言是有意义的标识，如 "java.util.ArrayList"），
 // 仅供调试日志——匹配只用 symbol_id 三元组。
 func ListExtractedEdges(ctx context.Context, r *EdgeRepository, repoID string) ([]ExtractedEdge, error) {
 	query := `
 		SELECT e.source_id, s_source.name, e.edge_type,
-		       COALESCE(e.target_id::text, ''), COALESCE(s_target.name, COALESCE(e.target_module, ''))
+		       COALESCE(e.target_id::text, ''), COALESCE(s_target.name, COALESCE(m.name, ''))
 		FROM edges e
 		JOIN symbols s_source ON e.source_id = s_source.symbol_id
 		JOIN files f ON s_source.file_id = f.file_id
 		LEFT JOIN symbols s_target ON e.target_id = s_target.symbol_id
+		LEFT JOIN external_modules m ON m.module_id = e.target_module_id
 		WHERE f.repo_id = $1
 	`
 	rows, err := r.db.QueryContext(ctx, query, repoID)
@@ -0,0 +1,451 @@
+package models
+
+import (
+	"context"
+	"database/sql"
+	"errors"
+	"fmt"
+	"strconv"
+	"strings"
+	"time"
+
+	"github.com/lib/pq"
+)
+
+// 提交级增量历史（symbol_history / edge_history，见迁移 20260101000008）。
+//
+// 每个已索引提交在仓库内有一个线性序号 seq；历史行带 [valid_from, valid_to)
+// 区间，valid_to 为 NULL 表示在最新提交中仍然有效。写入时只对比变更文件，
+// 关闭消失的行、插入新出现的行，未变化的行保持原样，因此存储随变更量增长。
+// 任意提交的状态是 valid_from <= seq AND (valid_to IS NULL OR valid_to > seq)。
+
+var (
+	// ErrCommitNotFound 表示仓库中没有匹配的已索引提交。
+	ErrCommitNotFound = errors.New("commit not found")
+	// ErrAmbiguousCommit 表示提交前缀匹配到多个提交。
+	ErrAmbiguousCommit = errors.New("ambiguous commit prefix")
+	// ErrCommitOutOfOrder 表示要写入历史的提交早于已索引的提交。
+	// 历史只能按提交顺序追加；重新索引最新提交是允许的。
+	ErrCommitOutOfOrder = errors.New("commit is older than the latest indexed commit")
+)
+
+// minCommitPrefix 是按前缀解析提交时要求的最短长度。
+const minCommitPrefix = 4
+
+// Commit 是 commits 表中的一个提交。
+type Commit struct {
+	RepoID      string     `json:"repo_id"`
+	Seq         int        `json:"seq"`
+	Hash        string     `json:"hash"`
+	ParentHash  string     `json:"parent_hash,omitempty"`
+	Author      string     `json:"author,omitempty"`
+	Email       string     `json:"email,omitempty"`
+	Message     string     `json:"message,omitempty"`
+	CommittedAt *time.Time `json:"committed_at,omitempty"`
+	IndexedAt   *time.Time `json:"indexed_at,omitempty"`
+	CreatedAt   time.Time  `json:"created_at"`
+}
+
+// HistorySymbol 是一个提交中的符号版本。
+type HistorySymbol struct {
+	Key       string
+	SymbolID  string
+	FilePath  string
+	Name      string
+	Kind      string
+	Signature string
+	StartLine int
+	EndLine   int
+}
+
+// HistoryEdge 是一个提交中的边。目标未解析时 TargetKey 为空。
+type HistoryEdge struct {
+	SourceKey    string
+	SourcePath   string
+	TargetKey    string
+	TargetPath   string
+	TargetModule string
+	TargetName   string
+	EdgeType     string
+}
+
+// HistoryDiff 统计一次 ApplyDiff 写入的变化量。
+type HistoryDiff struct {
+	SymbolsOpened int64 `json:"symbols_opened"`
+	SymbolsClosed int64 `json:"symbols_closed"`
+	EdgesOpened   int64 `json:"edges_opened"`
+	EdgesClosed   int64 `json:"edges_closed"`
+}
+
+// HistorySymbolKey 构造跨提交稳定的符号键：文件路径 + 种类 + 名称，
+// ordinal 区分同一文件中同种类同名的符号（按出现顺序，从 0 开始）。
+// symbol_id 由文件 checksum 派生，文件内容一变就全部改变，不能作为历史键。
+func HistorySymbolKey(path, kind, name string, ordinal int) string {
+	key := path + "#" + kind + ":" + name
+	if ordinal > 0 {
+		key += "@" + strconv.Itoa(ordinal)
+	}
+	return key
+}
+
+// HistoryRepository 读写提交级历史
+type HistoryRepository struct {
+	db *DB
+}
+
+// NewHistoryRepository creates a new history repository
+func NewHistoryRepository(db *DB) *HistoryRepository {
+	return &HistoryRepository{db: db}
+}
+
+// RegisterCommit 登记提交元数据（POST /commits）。提交已存在时只补全
+// 为空的元数据字段，不改变其 seq。
+func (r *HistoryRepository) RegisterCommit(ctx context.Context, commit *Commit) error {
+	tx, err := r.db.BeginTx(ctx, nil)
+	if err != nil {
+		return fmt.Errorf("failed to begin transaction: %w", err)
+	}
+	defer tx.Rollback()
+
+	if err := r.upsertCommit(ctx, tx, commit); err != nil {
+		return err
+	}
+	return tx.Commit()
+}
+
+// BeginCommit 在 tx 中为即将写入历史的提交分配（或复用）seq。
+// 提交早于已索引的最新提交时返回 ErrCommitOutOfOrder。
+func (r *HistoryRepository) BeginCommit(ctx context.Context, tx *sql.Tx, repoID, hash string) (int, error) {
+	commit := &Commit{RepoID: repoID, Hash: hash}
+	if err := r.upsertCommit(ctx, tx, commit); err != nil {
+		return 0, err
+	}
+
+	var later bool
+	err := tx.QueryRowContext(ctx, `
+		SELECT EXISTS(SELECT 1 FROM commits WHERE repo_id = $1 AND seq > $2 AND indexed_at IS NOT NULL)
+	`, repoID, commit.Seq).Scan(&later)
+	if err != nil {
+		return 0, fmt.Errorf("failed to check commit order: %w", err)
+	}
+	if later {
+		return 0, fmt.Errorf("%w: %s", ErrCommitOutOfOrder, hash)
+	}
+	return commit.Seq, nil
+}
+
+// upsertCommit 插入或补全提交（哈希统一小写），并回填 commit.Seq / CreatedAt。
+// 先锁住仓库行，串行化同一仓库的 seq 分配。
+func (r *HistoryRepository) upsertCommit(ctx context.Context, tx *sql.Tx, commit *Commit) error {
+	commit.Hash = strings.ToLower(strings.TrimSpace(commit.Hash))
+	commit.ParentHash = strings.ToLower(strings.TrimSpace(commit.ParentHash))
+
+	var locked string
+	err := tx.QueryRowContext(ctx,
+		`SELECT repo_id FROM repositories WHERE repo_id = $1 FOR UPDATE`, commit.RepoID).Scan(&locked)
+	if err == sql.ErrNoRows {
+		return fmt.Errorf("repository not found: %s", commit.RepoID)
+	}
+	if err != nil {
+		return fmt.Errorf("failed to lock repository: %w", err)
+	}
+
+	err = tx.QueryRowContext(ctx, `
+		INSERT INTO commits (repo_id, seq, commit_hash, parent_hash, author, email, message, committed_at)
+		SELECT $1, COALESCE(MAX(seq), 0) + 1, $2, NULLIF($3, ''), NULLIF($4, ''), NULLIF($5, ''), NULLIF($6, ''), $7
+		FROM commits WHERE repo_id = $1
+		ON CONFLICT (repo_id, commit_hash) DO UPDATE SET
+			parent_hash = COALESCE(commits.parent_hash, EXCLUDED.parent_hash),
+			author = COALESCE(commits.author, EXCLUDED.author),
+			email = COALESCE(commits.email, EXCLUDED.email),
+			message = COALESCE(commits.message, EXCLUDED.message),
+			committed_at = COALESCE(commits.committed_at, EXCLUDED.committed_at)
+		RETURNING seq, created_at
+	`, commit.RepoID, commit.Hash, commit.ParentHash, commit.Author, commit.Email, commit.Message, commit.CommittedAt,
+	).Scan(&commit.Seq, &commit.CreatedAt)
+	if err != nil {
+		return fmt.Errorf("failed to register commit: %w", err)
+	}
+	return nil
+}
+
+// OpenPaths 返回最新提交中仍有有效历史行的文件路径，用于识别已删除的文件。
+func (r *HistoryRepository) OpenPaths(ctx context.Context, tx *sql.Tx, repoID string) ([]string, error) {
+	rows, err := tx.QueryContext(ctx, `
+		SELECT file_path FROM symbol_history WHERE repo_id = $1 AND valid_to IS NULL
+		UNION
+		SELECT source_path FROM edge_history WHERE repo_id = $1 AND valid_to IS NULL
+	`, repoID)
+	if err != nil {
+		return nil, fmt.Errorf("failed to list open paths: %w", err)
+	}
+	defer rows.Close()
+
+	var paths []string
+	for rows.Next() {
+		var p string
+		if err := rows.Scan(&p); err != nil {
+			return nil, err
+		}
+		paths = append(paths, p)
+	}
+	return paths, rows.Err()
+}
+
+// symbolDiffQuery 在一条语句里完成符号差异：scope 内消失（或签名改变）的
+// 有效行被关闭；本提交此前写入的这类行直接删除（重新索引同一提交）；
+// 新出现的行以 valid_from = seq 插入。各 CTE 看到同一快照，互不干扰。
+const symbolDiffQuery = `
+	WITH incoming AS (
+		SELECT * FROM unnest($4::text[], $5::uuid[], $6::text[], $7::text[], $8::text[], $9::text[], $10::int[], $11::int[])
+			AS n(symbol_key, symbol_id, file_path, name, kind, signature, start_line, end_line)
+	),
+	stale AS (
+		SELECT h.ctid, h.valid_from FROM symbol_history h
+		WHERE h.repo_id = $1 AND h.valid_to IS NULL AND h.file_path = ANY($3)
+		  AND NOT EXISTS (
+			SELECT 1 FROM incoming n WHERE n.symbol_key = h.symbol_key AND n.signature = h.signature)
+	),
+	closed AS (
+		UPDATE symbol_history h SET valid_to = $2
+		FROM stale WHERE h.ctid = stale.ctid AND stale.valid_from < $2
+		RETURNING 1
+	),
+	dropped AS (
+		DELETE FROM symbol_history h
+		USING stale WHERE h.ctid = stale.ctid AND stale.valid_from >= $2
+		RETURNING 1
+	),
+	opened AS (
+		INSERT INTO symbol_history (repo_id, symbol_key, symbol_id, file_path, name, kind, signature,
+			start_line, end_line, valid_from)
+		SELECT $1, n.symbol_key, n.symbol_id, n.file_path, n.name, n.kind, n.signature,
+			n.start_line, n.end_line, $2
+		FROM incoming n
+		WHERE NOT EXISTS (
+			SELECT 1 FROM symbol_history h
+			WHERE h.repo_id = $1 AND h.symbol_key = n.symbol_key AND h.signature = n.signature
+			  AND h.valid_to IS NULL)
+		RETURNING 1
+	)
+	SELECT (SELECT COUNT(*) FROM opened), (SELECT COUNT(*) FROM closed) + (SELECT COUNT(*) FROM dropped)
+`
+
+// edgeDiffQuery 与 symbolDiffQuery 相同，scope 按边任一端所在文件判断。
+const edgeDiffQuery = `
+	WITH incoming AS (
+		SELECT * FROM unnest($4::text[], $5::text[], $6::text[], $7::text[], $8::text[], $9::text[], $10::text[])
+			AS n(source_key, source_path, target_key, target_path, target_module, target_name, edge_type)
+	),
+	stale AS (
+		SELECT h.ctid, h.valid_from FROM edge_history h
+		WHERE h.repo_id = $1 AND h.valid_to IS NULL
+		  AND (h.source_path = ANY($3) OR h.target_path = ANY($3))
+		  AND NOT EXISTS (
+			SELECT 1 FROM incoming n
+			WHERE n.source_key = h.source_key AND n.edge_type = h.edge_type AND n.target_key = h.target_key
+			  AND n.target_module = h.target_module AND n.target_name = h.target_name)
+	),
+	closed AS (
+		UPDATE edge_history h SET valid_to = $2
+		FROM stale WHERE h.ctid = stale.ctid AND stale.valid_from < $2
+		RETURNING 1
+	),
+	dropped AS (
+		DELETE FROM edge_history h
+		USING stale WHERE h.ctid = stale.ctid AND stale.valid_from >= $2
+		RETURNING 1
+	),
+	opened AS (
+		INSERT INTO edge_history (repo_id, source_key, source_path, target_key, target_path,
+			target_module, target_name, edge_type, valid_from)
+		SELECT $1, n.source_key, n.source_path, n.target_key, n.target_path,
+			n.target_module, n.target_name, n.edge_type, $2
+		FROM incoming n
+		WHERE NOT EXISTS (
+			SELECT 1 FROM edge_history h
+			WHERE h.repo_id = $1 AND h.source_key = n.source_key AND h.edge_type = n.edge_type
+			  AND h.target_key = n.target_key AND h.target_module = n.target_module
+			  AND h.target_name = n.target_name AND h.valid_to IS NULL)
+		RETURNING 1
+	)
+	SELECT (SELECT COUNT(*) FROM opened), (SELECT COUNT(*) FROM closed) + (SELECT COUNT(*) FROM dropped)
+`
+
+// ApplyDiff 把提交 seq 中 scope 文件的符号与边写入历史，并标记提交已索引。
+// symbols 与 edges 必须是 scope 内文件在该提交中的完整状态（边只要求任一端在
+// scope 内）；scope 外的历史行不受影响。
+func (r *HistoryRepository) ApplyDiff(ctx context.Context, tx *sql.Tx, repoID string, seq int, scope []string,
+	symbols []HistorySymbol, edges []HistoryEdge) (*HistoryDiff, error) {
+	diff := &HistoryDiff{}
+
+	if len(scope) > 0 {
+		n := len(symbols)
+		keys, ids, paths, names := make([]string, n), make([]string, n), make([]string, n), make([]string, n)
+		kinds, sigs := make([]string, n), make([]string, n)
+		starts, ends := make([]int64, n), make([]int64, n)
+		for i, s := range symbols {
+			keys[i], ids[i], paths[i], names[i] = s.Key, s.SymbolID, s.FilePath, s.Name
+			kinds[i], sigs[i] = s.Kind, s.Signature
+			starts[i], ends[i] = int64(s.StartLine), int64(s.EndLine)
+		}
+		err := tx.QueryRowContext(ctx, symbolDiffQuery, repoID, seq, pq.Array(scope),
+			pq.Array(keys), pq.Array(ids), pq.Array(paths), pq.Array(names),
+			pq.Array(kinds), pq.Array(sigs), pq.Array(starts), pq.Array(ends),
+		).Scan(&diff.SymbolsOpened, &diff.SymbolsClosed)
+		if err != nil {
+			return nil, fmt.Errorf("failed to write symbol history: %w", err)
+		}
+
+		m := len(edges)
+		srcKeys, srcPaths, tgtKeys, tgtPaths := make([]string, m), make([]string, m), make([]string, m), make([]string, m)
+		modules, tgtNames, types := make([]string, m), make([]string, m), make([]string, m)
+		for i, e := range edges {
+			srcKeys[i], srcPaths[i], tgtKeys[i], tgtPaths[i] = e.SourceKey, e.SourcePath, e.TargetKey, e.TargetPath
+			modules[i], tgtNames[i], types[i] = e.TargetModule, e.TargetName, e.EdgeType
+		}
+		err = tx.QueryRowContext(ctx, edgeDiffQuery, repoID, seq, pq.Array(scope),
+			pq.Array(srcKeys), pq.Array(srcPaths), pq.Array(tgtKeys), pq.Array(tgtPaths),
+			pq.Array(modules), pq.Array(tgtNames), pq.Array(types),
+		).Scan(&diff.EdgesOpened, &diff.EdgesClosed)
+		if err != nil {
+			return nil, fmt.Errorf("failed to write edge history: %w", err)
+		}
+	}
+
+	_, err := tx.ExecContext(ctx,
+		`UPDATE commits SET indexed_at = NOW() WHERE repo_id = $1 AND seq = $2`, repoID, seq)
+	if err != nil {
+		return nil, fmt.Errorf("failed to mark commit indexed: %w", err)
+	}
+	return diff, nil
+}
+
+// ResolveCommit 按完整哈希或唯一前缀（至少 4 个字符）解析仓库中已索引的提交。
+func (r *HistoryRepository) ResolveCommit(ctx context.Context, repoID, ref string) (*Commit, error) {
+	ref = strings.ToLower(strings.TrimSpace(ref))
+	if len(ref) < minCommitPrefix {
+		return nil, fmt.Errorf("%w: %q", ErrCommitNotFound, ref)
+	}
+
+	rows, err := r.db.QueryContext(ctx, `
+		SELECT repo_id, seq, commit_hash, COALESCE(parent_hash, ''), COALESCE(author, ''),
+		       COALESCE(email, ''), COALESCE(message, ''), committed_at, indexed_at, created_at
+		FROM commits
+		WHERE repo_id = $1 AND indexed_at IS NOT NULL
+		  AND (commit_hash = $2 OR commit_hash LIKE $3)
+		ORDER BY (commit_hash = $2) DESC, seq
+		LIMIT 2
+	`, repoID, ref, escapeLike(ref)+"%")
+	if err != nil {
+		return nil, fmt.Errorf("failed to resolve commit: %w", err)
+	}
+	defer rows.Close()
+
+	var found []*Commit
+	for rows.Next() {
+		var c Commit
+		if err := rows.Scan(&c.RepoID, &c.Seq, &c.Hash, &c.ParentHash, &c.Author,
+			&c.Email, &c.Message, &c.CommittedAt, &c.IndexedAt, &c.CreatedAt); err != nil {
+			return nil, err
+		}
+		found = append(found, &c)
+	}
+	if err := rows.Err(); err != nil {
+		return nil, err
+	}
+
+	switch {
+	case len(found) == 0:
+		return nil, fmt.Errorf("%w: %s", ErrCommitNotFound, ref)
+	case found[0].Hash == ref || len(found) == 1:
+		return found[0], nil
+	default:
+		return nil, fmt.Errorf("%w: %s", ErrAmbiguousCommit, ref)
+	}
+}
+
+// escapeLike 转义 LIKE 模式中的通配符。
+func escapeLike(s string) string {
+	return strings.NewReplacer(`\`, `\\`, `%`, `\%`, `_`, `\_`).Replace(s)
+}
+
+// SymbolKey 把 symbol_id 映射为所属仓库和历史键。优先按当前 symbols 表计算
+// （与写入时相同的同名序号规则），符号已不存在时回退到历史中记录的 ID。
+// 找不到时返回空串。
+func (r *HistoryRepository) SymbolKey(ctx context.Context, symbolID string) (repoID, key string, err error) {
+	var path, kind, name string
+	var ordinal int
+	err = r.db.QueryRowContext(ctx, `
+		SELECT f.repo_id, f.path, s.kind, s.name,
+		       (SELECT COUNT(*) FROM symbols o
+		        WHERE o.file_id = s.file_id AND o.kind = s.kind AND o.name = s.name
+		          AND (o.start_byte, o.start_line) < (s.start_byte, s.start_line))
+		FROM symbols s JOIN files f ON f.file_id = s.file_id
+		WHERE s.symbol_id = $1
+	`, symbolID).Scan(&repoID, &path, &kind, &name, &ordinal)
+	if err == nil {
+		return repoID, HistorySymbolKey(path, kind, name, ordinal), nil
+	}
+	if err != sql.ErrNoRows {
+		return "", "", err
+	}
+
+	err = r.db.QueryRowContext(ctx, `
+		SELECT repo_id, symbol_key FROM symbol_history
+		WHERE symbol_id = $1 ORDER BY valid_from DESC LIMIT 1
+	`, symbolID).Scan(&repoID, &key)
+	if err == sql.ErrNoRows {
+		return "", "", nil
+	}
+	return repoID, key, err
+}
+
+// historyEdgesAt 查询某提交时刻与给定符号相连的调用边，另一端符号取该时刻的版本。
+// keyColumn 是给定符号所在的一端，otherColumn 是要返回详情的一端。
+const historyEdgesAt = `
+	SELECT e.edge_type, s.symbol_id, s.name, s.kind, s.signature, s.file_path,
+	       e.source_path, e.target_path, e.target_module
+	FROM edge_history e
+	JOIN symbol_history s ON s.repo_id = e.repo_id AND s.symbol_key = e.%s
+	     AND s.valid_from <= $3 AND (s.valid_to IS NULL OR s.valid_to > $3)
+	WHERE e.repo_id = $1 AND e.%s = $2 AND e.edge_type = 'call'
+	  AND e.valid_from <= $3 AND (e.valid_to IS NULL OR e.valid_to > $3)
+	ORDER BY s.name
+`
+
+// CallersAt 返回提交 seq 时调用 key 符号的符号
+func (r *HistoryRepository) CallersAt(ctx context.Context, repoID, key string, seq int) ([]*EdgeWithDetails, error) {
+	return r.edgesAt(ctx, fmt.Sprintf(historyEdgesAt, "source_key", "target_key"), repoID, key, seq)
+}
+
+// CalleesAt 返回提交 seq 时 key 符号调用的符号
+func (r *HistoryRepository) CalleesAt(ctx context.Context, repoID, key string, seq int) ([]*EdgeWithDetails, error) {
+	return r.edgesAt(ctx, fmt.Sprintf(historyEdgesAt, "target_key", "source_key"), repoID, key, seq)
+}
+
+func (r *HistoryRepository) edgesAt(ctx context.Context, query, repoID, key string, seq int) ([]*EdgeWithDetails, error) {
+	rows, err := r.db.QueryContext(ctx, query, repoID, key, seq)
+	if err != nil {
+		return nil, err
+	}
+	defer rows.Close()
+
+	var results []*EdgeWithDetails
+	for rows.Next() {
+		var d EdgeWithDetails
+		var targetPath, targetModule string
+		if err := rows.Scan(&d.EdgeType, &d.SymbolID, &d.Name, &d.Kind, &d.Signature, &d.FilePath,
+			&d.SourceFile, &targetPath, &targetModule); err != nil {
+			return nil, err
+		}
+		if targetPath != "" {
+			d.TargetFile = &targetPath
+		}
+		if targetModule != "" {
+			d.TargetModule = &targetModule
+		}
+		results = append(results, &d)
+	}
+	return results, rows.Err()
+}
@@ -0,0 +1,251 @@
+package models
+
+import (
+	"context"
+	"hash/fnv"
+	"sort"
+	"strconv"
+	"sync"
+	"time"
+)
+
+// IndexGeneration identifies one version of indexed data. Value increases
+// monotonically; ModifiedAt is when that version was written.
+type IndexGeneration struct {
+	Value      int64     `json:"value"`
+	ModifiedAt time.Time `json:"modified_at"`
+}
+
+// GenerationLoader reads the persisted generation of every repository
+type GenerationLoader func(ctx context.Context) (map[string]IndexGeneration, error)
+
+// IndexGenerations caches repositories.index_generation to answer conditional
+// GETs without querying the database on every request.
+//
+// The persisted column is the source of truth: it is bumped by every writer
+// (indexer, archive import, compaction), in whichever process they run. With a
+// loader configured the table is reloaded once its snapshot is older than the
+// TTL, so changes made by other API replicas or the CLI are picked up within
+// one TTL. Observe only speeds up changes made by this process. When a reload
+// fails no validator is issued until one succeeds: serving full responses is
+// always safe, serving 304 from an old snapshot is not.
+//
+// The global validator covers endpoints addressed by file or symbol ID, which
+// cannot be mapped to a repository without a query. It is a fingerprint of all
+// repositories' generations, so every replica derives the same value.
+type IndexGenerations struct {
+	mu         sync.RWMutex
+	repos      map[string]IndexGeneration
+	suppressed map[string]int64 // repositories invalidated at or below this generation
+	tag        string           // fingerprint of repos and suppressed
+	modified   time.Time        // latest change covered by tag
+	stale      bool             // last reload failed
+
+	loadMu   sync.Mutex
+	load     GenerationLoader
+	ttl      time.Duration
+	loadedAt time.Time
+}
+
+// NewIndexGenerations creates an empty generation table. Without a loader (see
+// SetLoader) it only knows what is passed to Observe.
+func NewIndexGenerations() *IndexGenerations {
+	g := &IndexGenerations{
+		repos:      make(map[string]IndexGeneration),
+		suppressed: make(map[string]int64),
+	}
+	g.retagLocked(time.Now())
+	return g
+}
+
+// SetLoader makes the table reload from the database whenever its snapshot is
+// older than ttl (0 reloads on every read)
+func (g *IndexGenerations) SetLoader(load GenerationLoader, ttl time.Duration) {
+	if g == nil {
+		return
+	}
+	g.loadMu.Lock()
+	defer g.loadMu.Unlock()
+	g.load = load
+	g.ttl = ttl
+	g.loadedAt = time.Time{}
+}
+
+// Reload reads the persisted generations now, regardless of the TTL
+func (g *IndexGenerations) Reload(ctx context.Context) error {
+	if g == nil {
+		return nil
+	}
+	g.loadMu.Lock()
+	defer g.loadMu.Unlock()
+	return g.reloadLocked(ctx)
+}
+
+// refresh reloads the snapshot once it is older than the TTL
+func (g *IndexGenerations) refresh(ctx context.Context) {
+	g.loadMu.Lock()
+	defer g.loadMu.Unlock()
+	if g.load == nil || (!g.loadedAt.IsZero() && time.Since(g.loadedAt) < g.ttl) {
+		return
+	}
+	g.reloadLocked(ctx)
+}
+
+func (g *IndexGenerations) reloadLocked(ctx context.Context) error {
+	if g.load == nil {
+		return nil
+	}
+	started := time.Now()
+	loaded, err := g.load(ctx)
+
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	g.loadedAt = started
+	if err != nil {
+		// 失败后按 TTL 重试（请求被取消则下一个请求立即重试），期间不签发验证器
+		g.stale = true
+		if ctx.Err() != nil {
+			g.loadedAt = time.Time{}
+		}
+		return err
+	}
+	g.stale = false
+
+	for repoID, gen := range loaded {
+		// 查询开始后本进程 Observe 到的更新代数不能被旧快照覆盖；
+		// 仓库删除后重建时代数从 0 开始，但修改时间更新，以快照为准
+		if cur, ok := g.repos[repoID]; ok && cur.Value > gen.Value && cur.ModifiedAt.After(gen.ModifiedAt) {
+			loaded[repoID] = cur
+		}
+		if limit, ok := g.suppressed[repoID]; ok {
+			if gen.Value <= limit {
+				delete(loaded, repoID)
+			} else {
+				delete(g.suppressed, repoID)
+			}
+		}
+	}
+	g.repos = loaded
+	g.retagLocked(started)
+	return nil
+}
+
+// Observe records a generation this process has just persisted. Stale values
+// (not newer than what is already known) are ignored so that out-of-order
+// updates cannot move a repository backwards.
+func (g *IndexGenerations) Observe(repoID string, gen IndexGeneration) {
+	if g == nil {
+		return
+	}
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	if cur, ok := g.repos[repoID]; ok && cur.Value >= gen.Value {
+		return
+	}
+	g.repos[repoID] = gen
+	if limit, ok := g.suppressed[repoID]; ok && gen.Value > limit {
+		delete(g.suppressed, repoID)
+	}
+	g.retagLocked(gen.ModifiedAt)
+}
+
+// Invalidate distrusts a repository's current generation, e.g. after its data
+// changed but the persisted generation could not be bumped. The repository has
+// no validator until a newer generation is persisted, so no stale 304 can be
+// served by this process.
+func (g *IndexGenerations) Invalidate(repoID string) {
+	if g == nil {
+		return
+	}
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	limit := g.repos[repoID].Value
+	if cur, ok := g.suppressed[repoID]; !ok || cur < limit {
+		g.suppressed[repoID] = limit
+	}
+	delete(g.repos, repoID)
+	g.retagLocked(time.Now())
+}
+
+// Expire makes the next read reload from the database, for writes that change
+// the repositories table without bumping a generation (e.g. creating a
+// repository through the API)
+func (g *IndexGenerations) Expire() {
+	if g == nil {
+		return
+	}
+	g.loadMu.Lock()
+	defer g.loadMu.Unlock()
+	g.loadedAt = time.Time{}
+}
+
+// retagLocked recomputes the global fingerprint. at is when the change became
+// known; it advances the global modification time when no repository's own
+// timestamp does (e.g. after a deletion).
+func (g *IndexGenerations) retagLocked(at time.Time) {
+	ids := make([]string, 0, len(g.repos)+len(g.suppressed))
+	for id := range g.repos {
+		ids = append(ids, id)
+	}
+	for id := range g.suppressed {
+		ids = append(ids, "!"+id)
+	}
+	sort.Strings(ids)
+
+	h := fnv.New64a()
+	var latest time.Time
+	for _, id := range ids {
+		h.Write([]byte(id))
+		if id[0] == '!' {
+			h.Write([]byte(strconv.FormatInt(g.suppressed[id[1:]], 10)))
+			continue
+		}
+		gen := g.repos[id]
+		h.Write([]byte(strconv.FormatInt(gen.Value, 10) + "-" + strconv.FormatInt(gen.ModifiedAt.UnixNano(), 36) + ";"))
+		if gen.ModifiedAt.After(latest) {
+			latest = gen.ModifiedAt
+		}
+	}
+
+	tag := strconv.FormatUint(h.Sum64(), 36)
+	if tag == g.tag {
+		return
+	}
+	g.tag = tag
+	if !latest.After(g.modified) {
+		latest = at
+	}
+	if latest.After(g.modified) {
+		g.modified = latest
+	}
+}
+
+// Repo returns the known generation of a repository
+func (g *IndexGenerations) Repo(ctx context.Context, repoID string) (IndexGeneration, bool) {
+	if g == nil {
+		return IndexGeneration{}, false
+	}
+	g.refresh(ctx)
+	g.mu.RLock()
+	defer g.mu.RUnlock()
+	if g.stale {
+		return IndexGeneration{}, false
+	}
+	gen, ok := g.repos[repoID]
+	return gen, ok
+}
+
+// Global returns the validator covering all repositories: a fingerprint of
+// their generations and the latest change it reflects
+func (g *IndexGenerations) Global(ctx context.Context) (tag string, modified time.Time, ok bool) {
+	if g == nil {
+		return "", time.Time{}, false
+	}
+	g.refresh(ctx)
+	g.mu.RLock()
+	defer g.mu.RUnlock()
+	if g.stale {
+		return "", time.Time{}, false
+	}
+	return g.tag, g.modified, true
+}
@@ -0,0 +1,153 @@
+package models
+
+import (
+	"context"
+	"errors"
+	"testing"
+	"time"
+)
+
+func TestIndexGenerations_ObserveIsMonotonic(t *testing.T) {
+	ctx := context.Background()
+	g := NewIndexGenerations()
+	t0 := time.Now()
+
+	g.Observe("r1", IndexGeneration{Value: 2, ModifiedAt: t0})
+	tag, _, _ := g.Global(ctx)
+	g.Observe("r1", IndexGeneration{Value: 1, ModifiedAt: t0.Add(time.Second)})
+
+	gen, ok := g.Repo(ctx, "r1")
+	if !ok || gen.Value != 2 {
+		t.Errorf("Expected generation 2, got %+v (ok=%v)", gen, ok)
+	}
+	if after, _, _ := g.Global(ctx); after != tag {
+		t.Error("Expected stale observation not to change the global validator")
+	}
+}
+
+// fakeLoader 模拟 repositories 表，rows 可在测试中修改
+type fakeLoader struct {
+	rows  map[string]IndexGeneration
+	err   error
+	calls int
+}
+
+func (f *fakeLoader) load(ctx context.Context) (map[string]IndexGeneration, error) {
+	f.calls++
+	if f.err != nil {
+		return nil, f.err
+	}
+	out := make(map[string]IndexGeneration, len(f.rows))
+	for k, v := range f.rows {
+		out[k] = v
+	}
+	return out, nil
+}
+
+func TestIndexGenerations_ReloadsPersistedGenerations(t *testing.T) {
+	ctx := context.Background()
+	t0 := time.Date(2026, 1, 2, 3, 4, 5, 0, time.UTC)
+	db := &fakeLoader{rows: map[string]IndexGeneration{"r1": {Value: 1, ModifiedAt: t0}}}
+
+	g := NewIndexGenerations()
+	g.SetLoader(db.load, time.Hour)
+	if gen, ok := g.Repo(ctx, "r1"); !ok || gen.Value != 1 {
+		t.Fatalf("Expected generation loaded from the database, got %+v (ok=%v)", gen, ok)
+	}
+	before, _, _ := g.Global(ctx)
+
+	// 另一个进程（CLI 索引、导入、压缩）写入了新代数：TTL 内不重读
+	db.rows["r1"] = IndexGeneration{Value: 2, ModifiedAt: t0.Add(time.Minute)}
+	if gen, _ := g.Repo(ctx, "r1"); gen.Value != 1 || db.calls != 1 {
+		t.Errorf("Expected cached generation within the TTL, got %+v after %d loads", gen, db.calls)
+	}
+	g.Expire()
+	if gen, _ := g.Repo(ctx, "r1"); gen.Value != 2 {
+		t.Errorf("Expected generation 2 after reload, got %+v", gen)
+	}
+	after, _, _ := g.Global(ctx)
+	if after == before {
+		t.Error("Expected the global validator to change with a persisted generation")
+	}
+
+	// 同一份数据在任何副本上得到相同的全局验证器
+	replica := NewIndexGenerations()
+	replica.SetLoader(db.load, time.Hour)
+	if tag, _, _ := replica.Global(ctx); tag != after {
+		t.Errorf("Expected replicas to agree on the global validator: %s vs %s", tag, after)
+	}
+
+	// 删除仓库同样改变全局验证器
+	delete(db.rows, "r1")
+	g.Expire()
+	if _, ok := g.Repo(ctx, "r1"); ok {
+		t.Error("Expected deleted repository to be unknown")
+	}
+	if tag, _, _ := g.Global(ctx); tag == after {
+		t.Error("Expected the global validator to change after a deletion")
+	}
+}
+
+func TestIndexGenerations_NoValidatorsWhileReloadFails(t *testing.T) {
+	ctx := context.Background()
+	db := &fakeLoader{rows: map[string]IndexGeneration{"r1": {Value: 1, ModifiedAt: time.Now()}}}
+	g := NewIndexGenerations()
+	g.SetLoader(db.load, 0)
+	if _, ok := g.Repo(ctx, "r1"); !ok {
+		t.Fatal("Expected repository to be known")
+	}
+
+	db.err = errors.New("connection refused")
+	if _, ok := g.Repo(ctx, "r1"); ok {
+		t.Error("Expected no repository validator while the database cannot be read")
+	}
+	if _, _, ok := g.Global(ctx); ok {
+		t.Error("Expected no global validator while the database cannot be read")
+	}
+
+	db.err = nil
+	if _, ok := g.Repo(ctx, "r1"); !ok {
+		t.Error("Expected validators to return after a successful reload")
+	}
+}
+
+func TestIndexGenerations_InvalidateUntilNewerGeneration(t *testing.T) {
+	ctx := context.Background()
+	t0 := time.Now()
+	db := &fakeLoader{rows: map[string]IndexGeneration{"r1": {Value: 1, ModifiedAt: t0}}}
+	g := NewIndexGenerations()
+	g.SetLoader(db.load, 0)
+	g.Repo(ctx, "r1")
+	before, _, _ := g.Global(ctx)
+
+	g.Invalidate("r1")
+	if _, ok := g.Repo(ctx, "r1"); ok {
+		t.Error("Expected invalidated repository to stay unknown while the persisted generation is unchanged")
+	}
+	if tag, _, _ := g.Global(ctx); tag == before {
+		t.Error("Expected invalidation to change the global validator")
+	}
+
+	db.rows["r1"] = IndexGeneration{Value: 2, ModifiedAt: t0.Add(time.Second)}
+	if gen, ok := g.Repo(ctx, "r1"); !ok || gen.Value != 2 {
+		t.Errorf("Expected generation 2 once persisted, got %+v (ok=%v)", gen, ok)
+	}
+}
+
+func TestIndexGenerations_NilSafe(t *testing.T) {
+	ctx := context.Background()
+	var g *IndexGenerations
+	g.Observe("r1", IndexGeneration{Value: 1})
+	g.Expire()
+	g.Invalidate("r1")
+	if _, ok := g.Repo(ctx, "r1"); ok {
+		t.Error("Expected nil table to know no repositories")
+	}
+	if _, _, ok := g.Global(ctx); ok {
+		t.Error("Expected nil table to have no global validator")
+	}
+	var db *DB
+	if db.Generations() != nil {
+		t.Error("Expected nil DB to have no generation table")
+	}
+}
@@ -5,6 +5,10 @@ import (
 	"database/sql"
 	"embed"
 	"fmt"
+	"io/fs"
+	"strconv"
+	"strings"
+	"sync"
 
 	"github.com/pressly/goose/v3"
 )
@@ -57,3 +61,29 @@ func MigrationStatus(ctx context.Context, db *sql.DB) (current int64, pending er
 	}
 	return v, nil
 }
+
+var (
+	latestVersionOnce sync.Once
+	latestVersion     int64
+)
+
+// LatestMigrationVersion 返回嵌入二进制的最新迁移版本号（文件名前缀），
+// 数据库的 goose 版本等于它即说明 schema 已是本二进制期望的状态。
+func LatestMigrationVersion() int64 {
+	latestVersionOnce.Do(func() {
+		entries, err := fs.ReadDir(migrationsFS, migrationsDir)
+		if err != nil {
+			return
+		}
+		for _, entry := range entries {
+			prefix, _, ok := strings.Cut(entry.Name(), "_")
+			if !ok {
+				continue
+			}
+			if v, err := strconv.ParseInt(prefix, 10, 64); err == nil && v > latestVersion {
+				latestVersion = v
+			}
+		}
+	})
+	return latestVersion
+}
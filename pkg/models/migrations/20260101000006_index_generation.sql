@@ -0,0 +1,13 @@
+-- 仓库索引代数：每次 Indexer.Index 完成写入后原子自增
+--
+-- API 以该值派生 ETag / Last-Modified，客户端带 If-None-Match 轮询时，
+-- 代数未变即直接返回 304，无需查询数据库。
+
+-- +goose Up
+
+ALTER TABLE repositories ADD COLUMN IF NOT EXISTS index_generation BIGINT NOT NULL DEFAULT 0;
+
+
+-- +goose Down
+
+ALTER TABLE repositories DROP COLUMN IF EXISTS index_generation;
@@ -0,0 +1,20 @@
+-- 边的目标符号名
+--
+-- 增量索引重建文件时先删除旧符号，指向它们的边经 ON DELETE SET NULL 变为悬空边，
+-- 原来的目标信息随之丢失。记录目标裸名后，后台压缩任务（pkg/models/compaction.go）
+-- 可以把这些边重新消解到重建后的新符号 ID。
+
+-- +goose Up
+
+ALTER TABLE edges ADD COLUMN IF NOT EXISTS target_name TEXT;
+
+-- 曾经消解成功（target_file 非空）但目标已被删除的边；压缩任务按 edge_id 游标分页扫描。
+-- 处理后要么重新得到 target_id，要么清空 target_file，都会离开该部分索引。
+CREATE INDEX IF NOT EXISTS idx_edges_dangling ON edges(edge_id)
+WHERE target_id IS NULL AND target_file IS NOT NULL;
+
+
+-- +goose Down
+
+DROP INDEX IF EXISTS idx_edges_dangling;
+ALTER TABLE edges DROP COLUMN IF EXISTS target_name;
@@ -0,0 +1,76 @@
+-- 提交级增量历史
+--
+-- symbols / edges 只保存最新一次索引的状态。开启历史模式后，每次索引额外把
+-- 与上一提交相比变化的符号和边写入 *_history 表，每行带 [valid_from, valid_to)
+-- 提交区间（commits.seq），未变化的行不重复写入。存储量随变更量增长，
+-- 而不是随历史长度增长；任意提交的调用图可以用一次区间过滤查询还原。
+--
+-- 符号在历史中以稳定的 symbol_key（路径 + 种类 + 名称 + 同名序号）标识：
+-- symbol_id 由文件 checksum 派生，文件任何改动都会改变它，无法跨提交对齐。
+
+-- +goose Up
+
+-- 已登记的提交。seq 在仓库内单调递增，是历史区间使用的线性版本号。
+-- indexed_at 为空表示只登记了元数据（POST /commits），尚未写入历史。
+CREATE TABLE IF NOT EXISTS commits (
+    repo_id UUID NOT NULL REFERENCES repositories(repo_id) ON DELETE CASCADE,
+    seq INT NOT NULL,
+    commit_hash VARCHAR(64) NOT NULL,
+    parent_hash VARCHAR(64),
+    author TEXT,
+    email TEXT,
+    message TEXT,
+    committed_at TIMESTAMP,
+    indexed_at TIMESTAMP,
+    created_at TIMESTAMP DEFAULT NOW(),
+    PRIMARY KEY (repo_id, seq),
+    UNIQUE (repo_id, commit_hash)
+);
+
+-- 符号版本：valid_to 为空表示在最新提交中仍然存在
+CREATE TABLE IF NOT EXISTS symbol_history (
+    repo_id UUID NOT NULL REFERENCES repositories(repo_id) ON DELETE CASCADE,
+    symbol_key TEXT NOT NULL,
+    symbol_id UUID NOT NULL,
+    file_path TEXT NOT NULL,
+    name VARCHAR(255) NOT NULL,
+    kind VARCHAR(50) NOT NULL,
+    signature TEXT NOT NULL DEFAULT '',
+    start_line INT NOT NULL,
+    end_line INT NOT NULL,
+    valid_from INT NOT NULL,
+    valid_to INT
+);
+
+-- 按键做时间点查询
+CREATE INDEX IF NOT EXISTS idx_symbol_history_key ON symbol_history(repo_id, symbol_key, valid_from);
+-- 写入差异时只扫描变更文件中仍然有效的行
+CREATE INDEX IF NOT EXISTS idx_symbol_history_open ON symbol_history(repo_id, file_path) WHERE valid_to IS NULL;
+-- 由旧 symbol_id 反查 symbol_key（符号已被删除或改过 ID 时）
+CREATE INDEX IF NOT EXISTS idx_symbol_history_symbol_id ON symbol_history(symbol_id);
+
+-- 边版本。可选的目标字段以空串代替 NULL，便于整行比较。
+CREATE TABLE IF NOT EXISTS edge_history (
+    repo_id UUID NOT NULL REFERENCES repositories(repo_id) ON DELETE CASCADE,
+    source_key TEXT NOT NULL,
+    source_path TEXT NOT NULL,
+    target_key TEXT NOT NULL DEFAULT '',
+    target_path TEXT NOT NULL DEFAULT '',
+    target_module TEXT NOT NULL DEFAULT '',
+    target_name TEXT NOT NULL DEFAULT '',
+    edge_type VARCHAR(50) NOT NULL,
+    valid_from INT NOT NULL,
+    valid_to INT
+);
+
+CREATE INDEX IF NOT EXISTS idx_edge_history_source ON edge_history(repo_id, source_key, edge_type, valid_from);
+CREATE INDEX IF NOT EXISTS idx_edge_history_target ON edge_history(repo_id, target_key, edge_type, valid_from);
+CREATE INDEX IF NOT EXISTS idx_edge_history_open_source ON edge_history(repo_id, source_path) WHERE valid_to IS NULL;
+CREATE INDEX IF NOT EXISTS idx_edge_history_open_target ON edge_history(repo_id, target_path) WHERE valid_to IS NULL;
+
+
+-- +goose Down
+
+DROP TABLE IF EXISTS edge_history;
+DROP TABLE IF EXISTS symbol_history;
+DROP TABLE IF EXISTS commits;
@@ -0,0 +1,34 @@
+-- 多粒度 embedding 的粗粒度层
+--
+-- 多粒度模式下一次索引同时产出符号级、代码块级与文件级向量。符号级仍写入
+-- vectors（vector(1024)）；块级与文件级只用于粗筛候选文件，截断为前 256 维
+-- （Matryoshka 前缀）并以 halfvec 存储，每行约为 vectors 的 1/8。
+-- 检索先在此表中找出最相近的文件，再只在这些文件的符号中精排。
+-- halfvec 需要 pgvector 0.7+。
+--
+-- file_id 外键级联删除：文件被删除时粗粒度向量随之清理，不产生孤儿行。
+-- 只存 content_hash 不存原文：块/文件内容由符号内容拼接而成，原文已在 vectors 中。
+
+-- +goose Up
+
+CREATE TABLE IF NOT EXISTS coarse_vectors (
+    vector_id UUID PRIMARY KEY DEFAULT gen_random_uuid(),
+    entity_id UUID NOT NULL,
+    level VARCHAR(16) NOT NULL CHECK (level IN ('file', 'block')),
+    file_id UUID NOT NULL REFERENCES files(file_id) ON DELETE CASCADE,
+    embedding halfvec(256) NOT NULL,
+    content_hash VARCHAR(64) NOT NULL,
+    model VARCHAR(100) NOT NULL,
+    chunk_index INT NOT NULL DEFAULT 0,
+    created_at TIMESTAMP DEFAULT NOW(),
+    CONSTRAINT unique_coarse_chunk UNIQUE (file_id, level, chunk_index)
+);
+
+CREATE INDEX IF NOT EXISTS idx_coarse_vectors_embedding_hnsw
+ON coarse_vectors USING hnsw (embedding halfvec_cosine_ops)
+WITH (m = 16, ef_construction = 64);
+
+
+-- +goose Down
+
+DROP TABLE IF EXISTS coarse_vectors;
@@ -0,0 +1,21 @@
+-- 批量加载时被推迟的二级索引
+--
+-- 首次索引大仓库时，先删除空表上的二级索引（vectors 的 HNSW、edges 的六个索引等），
+-- 写完数据后再一次性并行重建，比逐行维护索引快数倍。删除索引与写入本表在同一事务中
+-- 提交，因此任何时刻被删除的索引都记录在这里：加载过程中进程崩溃时，API 启动或下一次
+-- 批量加载会按 definition 重建这些索引（见 pkg/models/bulk_load.go）。
+-- 每个索引重建成功后在同一事务中删除对应行。
+
+-- +goose Up
+
+CREATE TABLE IF NOT EXISTS deferred_indexes (
+    index_name TEXT PRIMARY KEY,
+    table_name TEXT NOT NULL,
+    definition TEXT NOT NULL,
+    deferred_at TIMESTAMP NOT NULL DEFAULT NOW()
+);
+
+
+-- +goose Down
+
+DROP TABLE IF EXISTS deferred_indexes;
@@ -0,0 +1,93 @@
+-- 外部模块去重表
+--
+-- 未解析的 import 边（std::vector、java.util.List、curl/curl.h 等外部依赖）原先在
+-- edges.target_module 中逐行存模块名，同一个名字在所有仓库里重复数百万次。现在
+-- 模块名只在 external_modules 中存一份（跨仓库去重），edges 以 INTEGER 键引用。
+-- "谁在用 libcurl" 这类查询先按 name 唯一索引取键，再走 idx_edges_target_module。
+--
+-- 模块行被所有仓库共享，删除仓库时不级联删除；行数与不同模块名的数量成正比，
+-- 只增不删，避免清理与并发索引之间的竞争。
+
+-- +goose Up
+
+CREATE TABLE IF NOT EXISTS external_modules (
+    module_id SERIAL PRIMARY KEY,
+    name TEXT NOT NULL UNIQUE
+);
+
+ALTER TABLE edges ADD COLUMN IF NOT EXISTS target_module_id INTEGER REFERENCES external_modules(module_id);
+
+INSERT INTO external_modules (name)
+SELECT DISTINCT target_module FROM edges WHERE target_module IS NOT NULL
+ON CONFLICT (name) DO NOTHING;
+
+UPDATE edges e SET target_module_id = m.module_id
+FROM external_modules m
+WHERE m.name = e.target_module;
+
+DROP VIEW IF EXISTS edges_with_symbols;
+DROP INDEX IF EXISTS idx_edges_external;
+ALTER TABLE edges DROP COLUMN IF EXISTS target_module;
+
+-- 无 target 的外部引用边
+CREATE INDEX IF NOT EXISTS idx_edges_external ON edges(source_id, target_module_id, edge_type)
+WHERE target_id IS NULL AND target_module_id IS NOT NULL;
+-- 按外部模块反查使用方
+CREATE INDEX IF NOT EXISTS idx_edges_target_module ON edges(target_module_id, edge_type)
+WHERE target_module_id IS NOT NULL;
+
+CREATE OR REPLACE VIEW edges_with_symbols AS
+SELECT
+    e.edge_id,
+    e.edge_type,
+    e.source_file,
+    e.target_file,
+    m.name as target_module,
+    e.line_number,
+    s1.symbol_id as source_symbol_id,
+    s1.name as source_name,
+    s1.kind as source_kind,
+    s2.symbol_id as target_symbol_id,
+    s2.name as target_name,
+    s2.kind as target_kind
+FROM edges e
+JOIN symbols s1 ON e.source_id = s1.symbol_id
+LEFT JOIN symbols s2 ON e.target_id = s2.symbol_id
+LEFT JOIN external_modules m ON e.target_module_id = m.module_id;
+
+
+-- +goose Down
+
+DROP VIEW IF EXISTS edges_with_symbols;
+DROP INDEX IF EXISTS idx_edges_target_module;
+DROP INDEX IF EXISTS idx_edges_external;
+
+ALTER TABLE edges ADD COLUMN IF NOT EXISTS target_module TEXT;
+
+UPDATE edges e SET target_module = m.name
+FROM external_modules m
+WHERE m.module_id = e.target_module_id;
+
+ALTER TABLE edges DROP COLUMN IF EXISTS target_module_id;
+DROP TABLE IF EXISTS external_modules;
+
+CREATE INDEX IF NOT EXISTS idx_edges_external ON edges(source_id, target_module, edge_type)
+WHERE target_id IS NULL AND target_module IS NOT NULL;
+
+CREATE OR REPLACE VIEW edges_with_symbols AS
+SELECT
+    e.edge_id,
+    e.edge_type,
+    e.source_file,
+    e.target_file,
+    e.target_module,
+    e.line_number,
+    s1.symbol_id as source_symbol_id,
+    s1.name as source_name,
+    s1.kind as source_kind,
+    s2.symbol_id as target_symbol_id,
+    s2.name as target_name,
+    s2.kind as target_kind
+FROM edges e
+JOIN symbols s1 ON e.source_id = s1.symbol_id
+LEFT JOIN symbols s2 ON e.target_id = s2.symbol_id;
@@ -0,0 +1,22 @@
+-- 内容相同文件的规范文件
+--
+-- 单体仓库常把同一份头文件/源文件 vendored 到多个路径（third_party/x、各平台副本）。
+-- 解析端按内容分组，每份内容只解析一次；副本仍各有 files 行与 symbols 行（路径、
+-- 符号查找与调用图按路径成立），但不再写 AST 节点与向量，canonical_file_id 指向
+-- 持有这些数据的规范文件。表体积与 embedding 次数因此随不同内容数而非路径数增长。
+--
+-- 不加外键：同一批写入中规范文件与副本的插入顺序不保证，规范文件被删除后副本在下一次
+-- 索引时按新的分组重写（增量索引比较 canonical_file_id，见 filterChangedFiles）。
+
+-- +goose Up
+
+ALTER TABLE files ADD COLUMN IF NOT EXISTS canonical_file_id UUID;
+
+CREATE INDEX IF NOT EXISTS idx_files_canonical ON files(canonical_file_id)
+WHERE canonical_file_id IS NOT NULL;
+
+
+-- +goose Down
+
+DROP INDEX IF EXISTS idx_files_canonical;
+ALTER TABLE files DROP COLUMN IF EXISTS canonical_file_id;
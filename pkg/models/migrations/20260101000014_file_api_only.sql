@@ -0,0 +1,14 @@
+-- API 表面层文件
+--
+-- third_party/、Pods/、external/ 等第三方 / vendored 目录下的文件只提取声明：
+-- 符号照常写入并参与跨文件调用边的候选查找，但不提取调用边、不写 AST 节点、不生成向量。
+-- api_only 记录文件当时所在的层，增量索引据此发现层的变化（配置调整后需整文件重写）。
+
+-- +goose Up
+
+ALTER TABLE files ADD COLUMN IF NOT EXISTS api_only BOOLEAN NOT NULL DEFAULT false;
+
+
+-- +goose Down
+
+ALTER TABLE files DROP COLUMN IF EXISTS api_only;
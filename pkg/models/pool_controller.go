@@ -0,0 +1,418 @@
+package models
+
+import (
+	"context"
+	"database/sql"
+	"sync"
+	"time"
+)
+
+// Pool lane names
+const (
+	PoolLaneInteractive = "interactive"
+	PoolLaneBulk        = "bulk"
+)
+
+// Pool controller actions
+const (
+	PoolActionGrow   = "grow"
+	PoolActionShrink = "shrink"
+)
+
+// PoolControllerConfig configures the adaptive pool controller
+type PoolControllerConfig struct {
+	Interval      time.Duration // Sampling interval
+	LatencyTarget time.Duration // Probe latency above which the controller backs off
+	WaitThreshold time.Duration // Average acquire wait that triggers growth
+	MaxTotalConns int           // Upper bound across all lanes
+	MinConns      int           // Per-lane floor
+	IdleTicks     int           // Consecutive idle samples before shrinking back toward the base size
+	HistorySize   int           // Number of decisions kept for inspection
+}
+
+// DefaultPoolControllerConfig returns the default controller configuration
+func DefaultPoolControllerConfig() PoolControllerConfig {
+	return PoolControllerConfig{
+		Interval:      10 * time.Second,
+		LatencyTarget: 50 * time.Millisecond,
+		WaitThreshold: 5 * time.Millisecond,
+		MinConns:      2,
+		IdleTicks:     3,
+		HistorySize:   64,
+	}
+}
+
+// PoolDecision records one limit change made by the controller
+type PoolDecision struct {
+	Time      time.Time     `json:"time"`
+	Lane      string        `json:"lane"`
+	Action    string        `json:"action"`
+	OldLimit  int           `json:"old_limit"`
+	NewLimit  int           `json:"new_limit"`
+	Reason    string        `json:"reason"`
+	WaitCount int64         `json:"wait_count"` // Waits observed during the sample window
+	AvgWait   time.Duration `json:"avg_wait"`
+	Latency   time.Duration `json:"latency"`
+	InUse     int           `json:"in_use"`
+}
+
+// PoolLaneStatus is the current state of one pool lane
+type PoolLaneStatus struct {
+	Lane         string        `json:"lane"`
+	Limit        int           `json:"limit"`
+	BaseLimit    int           `json:"base_limit"`
+	MaxLimit     int           `json:"max_limit"`
+	Open         int           `json:"open"`
+	InUse        int           `json:"in_use"`
+	Idle         int           `json:"idle"`
+	WaitCount    int64         `json:"wait_count"`
+	WaitDuration time.Duration `json:"wait_duration"`
+}
+
+// PoolStatus is the exported view of the connection pools and controller decisions
+type PoolStatus struct {
+	AutoTune  bool             `json:"auto_tune"`
+	Latency   time.Duration    `json:"latency"`
+	Lanes     []PoolLaneStatus `json:"lanes"`
+	Decisions []PoolDecision   `json:"decisions"`
+}
+
+// poolLane tracks one *sql.DB governed by the controller
+type poolLane struct {
+	name      string
+	db        *sql.DB
+	maxIdle   int
+	base      int
+	limit     int
+	idleTicks int
+
+	lastWaitCount    int64
+	lastWaitDuration time.Duration
+}
+
+// PoolController adjusts per-lane MaxOpenConns from observed pool waits and
+// database latency.
+//
+// 策略（AIMD 风格）：
+//   - 数据库延迟超过目标：先按 1/4 收缩 bulk 通道，bulk 已到下限时再收缩 interactive，
+//     避免在 Postgres 已经过载时继续加连接
+//   - 某通道平均等待超过阈值：按 1/4 扩容（至少 1），受总连接数上限约束；
+//     interactive 没有余量时从 bulk 借
+//   - 连续若干个采样窗口空闲（无等待且使用率不足一半）：逐步回落到初始大小
+type PoolController struct {
+	mu      sync.Mutex
+	cfg     PoolControllerConfig
+	lanes   []*poolLane
+	latency time.Duration
+	history []PoolDecision
+	probe   func(ctx context.Context) (time.Duration, error)
+
+	stopOnce sync.Once
+	stop     chan struct{}
+	done     chan struct{}
+}
+
+// newPoolController creates a controller over the given lanes. interactive must be
+// non-nil; bulk may be nil when indexing shares the interactive pool.
+func newPoolController(cfg PoolControllerConfig, interactive, bulk *poolLane) *PoolController {
+	defaults := DefaultPoolControllerConfig()
+	if cfg.Interval <= 0 {
+		cfg.Interval = defaults.Interval
+	}
+	if cfg.LatencyTarget <= 0 {
+		cfg.LatencyTarget = defaults.LatencyTarget
+	}
+	if cfg.WaitThreshold <= 0 {
+		cfg.WaitThreshold = defaults.WaitThreshold
+	}
+	if cfg.MinConns <= 0 {
+		cfg.MinConns = defaults.MinConns
+	}
+	if cfg.IdleTicks <= 0 {
+		cfg.IdleTicks = defaults.IdleTicks
+	}
+	if cfg.HistorySize <= 0 {
+		cfg.HistorySize = defaults.HistorySize
+	}
+
+	lanes := []*poolLane{interactive}
+	if bulk != nil {
+		lanes = append(lanes, bulk)
+	}
+	total := 0
+	for _, l := range lanes {
+		l.limit = l.base
+		total += l.base
+	}
+	if cfg.MaxTotalConns < total {
+		cfg.MaxTotalConns = total
+	}
+
+	c := &PoolController{
+		cfg:   cfg,
+		lanes: lanes,
+		stop:  make(chan struct{}),
+		done:  make(chan struct{}),
+	}
+	c.probe = func(ctx context.Context) (time.Duration, error) {
+		start := time.Now()
+		var one int
+		err := interactive.db.QueryRowContext(ctx, "SELECT 1").Scan(&one)
+		return time.Since(start), err
+	}
+	return c
+}
+
+// Start runs the sampling loop in the background until Stop is called
+func (c *PoolController) Start() {
+	go func() {
+		defer close(c.done)
+		ticker := time.NewTicker(c.cfg.Interval)
+		defer ticker.Stop()
+		for {
+			select {
+			case <-c.stop:
+				return
+			case <-ticker.C:
+				c.sample()
+			}
+		}
+	}()
+}
+
+// Stop terminates the sampling loop and waits for it to exit
+func (c *PoolController) Stop() {
+	c.stopOnce.Do(func() {
+		close(c.stop)
+		<-c.done
+	})
+}
+
+// ObserveLatency feeds an externally measured query latency into the controller's
+// moving average (in addition to the controller's own probe)
+func (c *PoolController) ObserveLatency(d time.Duration) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.observeLatencyLocked(d)
+}
+
+func (c *PoolController) observeLatencyLocked(d time.Duration) {
+	if c.latency == 0 {
+		c.latency = d
+		return
+	}
+	// EWMA, alpha = 0.3
+	c.latency = time.Duration(0.7*float64(c.latency) + 0.3*float64(d))
+}
+
+// sample probes latency, reads pool stats and applies one control step
+func (c *PoolController) sample() {
+	ctx, cancel := context.WithTimeout(context.Background(), c.cfg.Interval)
+	d, err := c.probe(ctx)
+	cancel()
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if err == nil {
+		c.observeLatencyLocked(d)
+	} else if dbLogger != nil {
+		dbLogger.Warnf("Pool controller latency probe failed: %v", err)
+	}
+
+	stats := make([]sql.DBStats, len(c.lanes))
+	for i, l := range c.lanes {
+		stats[i] = l.db.Stats()
+	}
+	for _, decision := range c.step(time.Now(), stats) {
+		c.apply(decision)
+	}
+}
+
+// step computes limit changes for one sample window. It mutates lane limits and
+// counters but does not touch the underlying *sql.DB, which keeps it testable.
+func (c *PoolController) step(now time.Time, stats []sql.DBStats) []PoolDecision {
+	type window struct {
+		waits   int64
+		avgWait time.Duration
+		inUse   int
+	}
+	windows := make([]window, len(c.lanes))
+	for i, l := range c.lanes {
+		st := stats[i]
+		w := window{waits: st.WaitCount - l.lastWaitCount, inUse: st.InUse}
+		if w.waits > 0 {
+			w.avgWait = (st.WaitDuration - l.lastWaitDuration) / time.Duration(w.waits)
+		}
+		l.lastWaitCount = st.WaitCount
+		l.lastWaitDuration = st.WaitDuration
+		windows[i] = w
+	}
+
+	var decisions []PoolDecision
+	change := func(i, newLimit int, action, reason string) {
+		l := c.lanes[i]
+		if newLimit == l.limit {
+			return
+		}
+		decisions = append(decisions, PoolDecision{
+			Time:      now,
+			Lane:      l.name,
+			Action:    action,
+			OldLimit:  l.limit,
+			NewLimit:  newLimit,
+			Reason:    reason,
+			WaitCount: windows[i].waits,
+			AvgWait:   windows[i].avgWait,
+			Latency:   c.latency,
+			InUse:     windows[i].inUse,
+		})
+		l.limit = newLimit
+	}
+
+	// 1. 数据库过载：收缩，bulk 优先
+	if c.latency > c.cfg.LatencyTarget {
+		reason := "db latency " + c.latency.String() + " above target " + c.cfg.LatencyTarget.String()
+		for i := len(c.lanes) - 1; i >= 0; i-- {
+			l := c.lanes[i]
+			if l.limit > c.cfg.MinConns {
+				change(i, maxInt(c.cfg.MinConns, l.limit-maxInt(1, l.limit/4)), PoolActionShrink, reason)
+				break
+			}
+		}
+		for _, l := range c.lanes {
+			l.idleTicks = 0
+		}
+		return decisions
+	}
+
+	// 2. 等待过长：扩容
+	grew := false
+	for i, l := range c.lanes {
+		w := windows[i]
+		if w.waits == 0 || w.avgWait < c.cfg.WaitThreshold {
+			continue
+		}
+		l.idleTicks = 0
+		reason := "avg acquire wait " + w.avgWait.String() + " over " + c.cfg.WaitThreshold.String()
+		want := maxInt(1, l.limit/4)
+		grant := minInt(want, c.cfg.MaxTotalConns-c.totalLimit())
+		// interactive 没有余量时从 bulk 借，保证搜索不被长事务饿死
+		if grant < want && l.name == PoolLaneInteractive {
+			for j, other := range c.lanes {
+				if other.name != PoolLaneBulk || other.limit <= c.cfg.MinConns {
+					continue
+				}
+				borrow := minInt(want-grant, other.limit-c.cfg.MinConns)
+				change(j, other.limit-borrow, PoolActionShrink, "lend to interactive lane")
+				grant += borrow
+			}
+		}
+		if grant > 0 {
+			change(i, l.limit+grant, PoolActionGrow, reason)
+			grew = true
+		}
+	}
+	if grew {
+		return decisions
+	}
+
+	// 3. 持续空闲：回落到初始大小
+	for i, l := range c.lanes {
+		w := windows[i]
+		if w.waits > 0 || l.limit <= l.base || w.inUse > l.limit/2 {
+			l.idleTicks = 0
+			continue
+		}
+		l.idleTicks++
+		if l.idleTicks >= c.cfg.IdleTicks {
+			l.idleTicks = 0
+			change(i, l.limit-1, PoolActionShrink, "idle, returning toward base size")
+		}
+	}
+
+	// 4. 被收缩/借走的通道在有余量时补回初始大小
+	for i, l := range c.lanes {
+		if l.limit >= l.base {
+			continue
+		}
+		if room := c.cfg.MaxTotalConns - c.totalLimit(); room > 0 {
+			change(i, l.limit+minInt(room, l.base-l.limit), PoolActionGrow, "restore toward base size")
+		}
+	}
+	return decisions
+}
+
+// apply pushes a decision to the underlying pool and records it
+func (c *PoolController) apply(d PoolDecision) {
+	for _, l := range c.lanes {
+		if l.name != d.Lane {
+			continue
+		}
+		l.db.SetMaxOpenConns(d.NewLimit)
+		l.db.SetMaxIdleConns(minInt(l.maxIdle, d.NewLimit))
+	}
+	c.record(d)
+	if dbLogger != nil {
+		dbLogger.Infof("Pool controller: %s lane %s %d -> %d (%s)", d.Lane, d.Action, d.OldLimit, d.NewLimit, d.Reason)
+	}
+}
+
+func (c *PoolController) record(d PoolDecision) {
+	c.history = append(c.history, d)
+	if over := len(c.history) - c.cfg.HistorySize; over > 0 {
+		c.history = append(c.history[:0], c.history[over:]...)
+	}
+}
+
+func (c *PoolController) totalLimit() int {
+	total := 0
+	for _, l := range c.lanes {
+		total += l.limit
+	}
+	return total
+}
+
+// Status returns the current lane limits, pool stats and recent decisions
+func (c *PoolController) Status() PoolStatus {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	status := PoolStatus{
+		AutoTune:  true,
+		Latency:   c.latency,
+		Decisions: append([]PoolDecision(nil), c.history...),
+	}
+	for _, l := range c.lanes {
+		status.Lanes = append(status.Lanes, laneStatus(l.name, l.db, l.limit, l.base, c.cfg.MaxTotalConns))
+	}
+	return status
+}
+
+func laneStatus(name string, db *sql.DB, limit, base, max int) PoolLaneStatus {
+	st := db.Stats()
+	return PoolLaneStatus{
+		Lane:         name,
+		Limit:        limit,
+		BaseLimit:    base,
+		MaxLimit:     max,
+		Open:         st.OpenConnections,
+		InUse:        st.InUse,
+		Idle:         st.Idle,
+		WaitCount:    st.WaitCount,
+		WaitDuration: st.WaitDuration,
+	}
+}
+
+func minInt(a, b int) int {
+	if a < b {
+		return a
+	}
+	return b
+}
+
+func maxInt(a, b int) int {
+	if a > b {
+		return a
+	}
+	return b
+}
@@ -0,0 +1,134 @@
+package models
+
+import (
+	"database/sql"
+	"testing"
+	"time"
+)
+
+// Unit tests for the pool controller decision logic (no database required)
+
+func newTestPoolController(interactiveBase, bulkBase, maxTotal int) *PoolController {
+	cfg := DefaultPoolControllerConfig()
+	cfg.MaxTotalConns = maxTotal
+	interactive := &poolLane{name: PoolLaneInteractive, base: interactiveBase, maxIdle: 5}
+	var bulk *poolLane
+	if bulkBase > 0 {
+		bulk = &poolLane{name: PoolLaneBulk, base: bulkBase, maxIdle: 2}
+	}
+	return newPoolController(cfg, interactive, bulk)
+}
+
+func TestPoolController_GrowsOnWaits(t *testing.T) {
+	c := newTestPoolController(8, 4, 20)
+
+	decisions := c.step(time.Now(), []sql.DBStats{
+		{WaitCount: 10, WaitDuration: 200 * time.Millisecond, InUse: 8},
+		{},
+	})
+
+	if len(decisions) != 1 {
+		t.Fatalf("Expected 1 decision, got %d: %+v", len(decisions), decisions)
+	}
+	d := decisions[0]
+	if d.Lane != PoolLaneInteractive || d.Action != PoolActionGrow || d.OldLimit != 8 || d.NewLimit != 10 {
+		t.Errorf("Unexpected decision: %+v", d)
+	}
+	if d.AvgWait != 20*time.Millisecond || d.WaitCount != 10 {
+		t.Errorf("Expected window stats (10 waits, 20ms avg), got %d / %s", d.WaitCount, d.AvgWait)
+	}
+
+	// Counters are deltas: the same cumulative stats mean no new waits
+	decisions = c.step(time.Now(), []sql.DBStats{
+		{WaitCount: 10, WaitDuration: 200 * time.Millisecond, InUse: 8},
+		{},
+	})
+	for _, d := range decisions {
+		if d.Action == PoolActionGrow && d.Lane == PoolLaneInteractive {
+			t.Errorf("Did not expect growth without new waits: %+v", d)
+		}
+	}
+}
+
+func TestPoolController_BorrowsFromBulkAtCap(t *testing.T) {
+	c := newTestPoolController(8, 4, 12)
+
+	decisions := c.step(time.Now(), []sql.DBStats{
+		{WaitCount: 5, WaitDuration: 100 * time.Millisecond, InUse: 8},
+		{InUse: 4},
+	})
+
+	if len(decisions) != 2 {
+		t.Fatalf("Expected 2 decisions, got %d: %+v", len(decisions), decisions)
+	}
+	if decisions[0].Lane != PoolLaneBulk || decisions[0].NewLimit != 2 {
+		t.Errorf("Expected bulk lane to lend down to 2, got %+v", decisions[0])
+	}
+	if decisions[1].Lane != PoolLaneInteractive || decisions[1].NewLimit != 10 {
+		t.Errorf("Expected interactive lane to grow to 10, got %+v", decisions[1])
+	}
+	if c.totalLimit() > 12 {
+		t.Errorf("Total limit %d exceeds cap 12", c.totalLimit())
+	}
+}
+
+func TestPoolController_ShrinksBulkFirstOnLatency(t *testing.T) {
+	c := newTestPoolController(8, 8, 16)
+	c.ObserveLatency(200 * time.Millisecond)
+
+	decisions := c.step(time.Now(), []sql.DBStats{
+		{WaitCount: 5, WaitDuration: time.Second},
+		{},
+	})
+
+	if len(decisions) != 1 {
+		t.Fatalf("Expected 1 decision, got %d: %+v", len(decisions), decisions)
+	}
+	if decisions[0].Lane != PoolLaneBulk || decisions[0].Action != PoolActionShrink || decisions[0].NewLimit != 6 {
+		t.Errorf("Expected bulk lane to shrink to 6, got %+v", decisions[0])
+	}
+}
+
+func TestPoolController_ReturnsToBaseWhenIdle(t *testing.T) {
+	c := newTestPoolController(4, 0, 10)
+	c.step(time.Now(), []sql.DBStats{{WaitCount: 4, WaitDuration: 100 * time.Millisecond, InUse: 4}})
+	if c.lanes[0].limit != 5 {
+		t.Fatalf("Expected limit 5 after growth, got %d", c.lanes[0].limit)
+	}
+
+	idle := []sql.DBStats{{WaitCount: 4, WaitDuration: 100 * time.Millisecond, InUse: 0}}
+	for i := 0; i < c.cfg.IdleTicks-1; i++ {
+		if d := c.step(time.Now(), idle); len(d) != 0 {
+			t.Fatalf("Did not expect a decision before %d idle ticks: %+v", c.cfg.IdleTicks, d)
+		}
+	}
+	decisions := c.step(time.Now(), idle)
+	if len(decisions) != 1 || decisions[0].NewLimit != 4 {
+		t.Fatalf("Expected shrink back to base 4, got %+v", decisions)
+	}
+	if d := c.step(time.Now(), idle); len(d) != 0 {
+		t.Errorf("Did not expect shrinking below base: %+v", d)
+	}
+}
+
+func TestPoolController_HistoryIsBounded(t *testing.T) {
+	c := newTestPoolController(4, 0, 10)
+	c.cfg.HistorySize = 3
+	for i := 0; i < 5; i++ {
+		c.record(PoolDecision{OldLimit: i, NewLimit: i + 1})
+	}
+	if len(c.history) != 3 || c.history[0].OldLimit != 2 {
+		t.Errorf("Expected the last 3 decisions, got %+v", c.history)
+	}
+}
+
+func TestDB_BulkFallsBackToSelf(t *testing.T) {
+	db := &DB{}
+	if db.Bulk() != db {
+		t.Error("Expected Bulk() to return the shared pool when no bulk pool is configured")
+	}
+	var nilDB *DB
+	if nilDB.Bulk() != nil {
+		t.Error("Expected Bulk() on nil DB to return nil")
+	}
+}
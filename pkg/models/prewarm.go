@@ -0,0 +1,58 @@
+package models
+
+import (
+	"context"
+	"database/sql"
+	"fmt"
+)
+
+// DefaultPrewarmRelations are the relations read by almost every request:
+// symbol name lookups (exact and trigram), call edges in both directions and
+// the vector indexes searched by /search and /qa
+var DefaultPrewarmRelations = []string{
+	"idx_symbols_name",
+	"idx_symbols_name_trgm",
+	"idx_edges_source_type",
+	"idx_edges_target_type",
+	"idx_vectors_embedding_hnsw",
+	"idx_vectors_embedding_halfvec_hnsw",
+	"idx_coarse_vectors_embedding_hnsw",
+}
+
+// PrewarmRelations loads the given tables or indexes into shared buffers with
+// pg_prewarm, so the first queries after a restart do not pay for cold reads.
+// It returns the number of relations warmed.
+//
+// pg_prewarm is an optional contrib extension and creating it needs
+// privileges the API user may lack, so when it is not installed this is a
+// no-op. Relations that do not exist (e.g. coarse vectors never enabled) are
+// skipped.
+func PrewarmRelations(ctx context.Context, db *DB, relations []string) (int, error) {
+	var installed bool
+	if err := db.QueryRowContext(ctx, `SELECT EXISTS(SELECT 1 FROM pg_extension WHERE extname = 'pg_prewarm')`).Scan(&installed); err != nil {
+		return 0, fmt.Errorf("failed to check pg_prewarm: %w", err)
+	}
+	if !installed {
+		if dbLogger != nil {
+			dbLogger.Debug("pg_prewarm not installed, skipping relation prewarm")
+		}
+		return 0, nil
+	}
+
+	warmed := 0
+	for _, rel := range relations {
+		var blocks int64
+		err := db.QueryRowContext(ctx, `SELECT pg_prewarm(c.oid) FROM pg_class c WHERE c.oid = to_regclass($1)`, rel).Scan(&blocks)
+		if err != nil {
+			if err == sql.ErrNoRows {
+				continue
+			}
+			return warmed, fmt.Errorf("failed to prewarm %s: %w", rel, err)
+		}
+		if dbLogger != nil {
+			dbLogger.Debugf("Prewarmed %s (%d blocks)", rel, blocks)
+		}
+		warmed++
+	}
+	return warmed, nil
+}
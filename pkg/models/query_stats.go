@@ -0,0 +1,570 @@
+package models
+
+import (
+	"context"
+	"database/sql"
+	"fmt"
+	"hash/fnv"
+	"math/rand"
+	"sort"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+	"unicode"
+)
+
+// QueryStatsConfig configures per-statement instrumentation of DB
+type QueryStatsConfig struct {
+	// SlowThreshold is the latency above which a statement is logged with its
+	// parameters and kept in the slow-query log (0 disables slow-query capture)
+	SlowThreshold time.Duration
+	// ExplainSampleRate is the fraction of slow read-only statements that are
+	// re-run under EXPLAIN (ANALYZE, BUFFERS) to capture a plan (0 disables)
+	ExplainSampleRate float64
+	// ExplainTimeout bounds one EXPLAIN run
+	ExplainTimeout time.Duration
+	// MaxFingerprints caps the number of distinct statements tracked; further
+	// statements are folded into a single "other" entry
+	MaxFingerprints int
+	// SlowLogSize is how many slow executions are kept
+	SlowLogSize int
+}
+
+// DefaultQueryStatsConfig returns the default instrumentation configuration
+func DefaultQueryStatsConfig() QueryStatsConfig {
+	return QueryStatsConfig{
+		SlowThreshold:     200 * time.Millisecond,
+		ExplainSampleRate: 0,
+		ExplainTimeout:    30 * time.Second,
+		MaxFingerprints:   500,
+		SlowLogSize:       50,
+	}
+}
+
+// latencyBuckets are the upper bounds of the histogram buckets; the last
+// bucket is unbounded
+var latencyBuckets = []time.Duration{
+	time.Millisecond,
+	2500 * time.Microsecond,
+	5 * time.Millisecond,
+	10 * time.Millisecond,
+	25 * time.Millisecond,
+	50 * time.Millisecond,
+	100 * time.Millisecond,
+	250 * time.Millisecond,
+	500 * time.Millisecond,
+	time.Second,
+	2500 * time.Millisecond,
+	5 * time.Second,
+}
+
+// otherFingerprint collects statements beyond MaxFingerprints
+const otherFingerprint = "(other)"
+
+// maxParamLen truncates logged parameters; embeddings are serialized as long strings
+const maxParamLen = 64
+
+// QueryHistogram is the latency distribution of one statement fingerprint
+type QueryHistogram struct {
+	ID          string             `json:"id"`
+	Fingerprint string             `json:"fingerprint"`
+	Count       int64              `json:"count"`
+	Errors      int64              `json:"errors"`
+	Total       time.Duration      `json:"total"`
+	Max         time.Duration      `json:"max"`
+	P50         time.Duration      `json:"p50"`
+	P95         time.Duration      `json:"p95"`
+	P99         time.Duration      `json:"p99"`
+	Buckets     []QueryBucketCount `json:"buckets"`
+}
+
+// QueryBucketCount is one histogram bucket; Le is 0 for the unbounded bucket
+type QueryBucketCount struct {
+	Le    time.Duration `json:"le"`
+	Count int64         `json:"count"`
+}
+
+// SlowQuery is one captured slow execution
+type SlowQuery struct {
+	ID          string        `json:"id"`
+	Fingerprint string        `json:"fingerprint"`
+	Params      []string      `json:"params,omitempty"`
+	Duration    time.Duration `json:"duration"`
+	Error       string        `json:"error,omitempty"`
+	At          time.Time     `json:"at"`
+	Plan        string        `json:"plan,omitempty"`
+}
+
+// QueryStatsSnapshot is the admin view of the instrumentation state
+type QueryStatsSnapshot struct {
+	SlowThreshold     time.Duration    `json:"slow_threshold"`
+	ExplainSampleRate float64          `json:"explain_sample_rate"`
+	Statements        []QueryHistogram `json:"statements"`
+	SlowQueries       []SlowQuery      `json:"slow_queries"`
+}
+
+type queryEntry struct {
+	id          string
+	fingerprint string
+	count       int64
+	errors      int64
+	total       time.Duration
+	max         time.Duration
+	buckets     []int64
+}
+
+// QueryStats records per-fingerprint latency histograms and a bounded log of
+// slow executions. All methods are safe for concurrent use; Snapshot and Reset
+// also accept a nil recorder.
+type QueryStats struct {
+	cfg QueryStatsConfig
+
+	// fingerprints caches raw query text → fingerprint; statements are
+	// constant strings in practice, so normalization runs once per statement
+	fingerprints sync.Map
+	cached       atomic.Int64
+
+	mu       sync.Mutex
+	entries  map[string]*queryEntry
+	slow     []SlowQuery // ring buffer, slowNext is the next write position
+	slowNext int
+
+	explaining atomic.Bool
+}
+
+// NewQueryStats creates a query statistics recorder
+func NewQueryStats(cfg QueryStatsConfig) *QueryStats {
+	return &QueryStats{cfg: cfg, entries: make(map[string]*queryEntry)}
+}
+
+// Config returns the recorder configuration
+func (s *QueryStats) Config() QueryStatsConfig {
+	return s.cfg
+}
+
+// observe records one execution and returns whether it was slow
+func (s *QueryStats) observe(query string, args []interface{}, d time.Duration, err error) (SlowQuery, bool) {
+	fp := s.fingerprint(query)
+
+	s.mu.Lock()
+	e, ok := s.entries[fp]
+	if !ok {
+		if len(s.entries) >= s.cfg.MaxFingerprints && s.cfg.MaxFingerprints > 0 {
+			fp = otherFingerprint
+			e = s.entries[fp]
+		}
+		if e == nil {
+			e = &queryEntry{id: fingerprintID(fp), fingerprint: fp, buckets: make([]int64, len(latencyBuckets)+1)}
+			s.entries[fp] = e
+		}
+	}
+	e.count++
+	e.total += d
+	if d > e.max {
+		e.max = d
+	}
+	if err != nil {
+		e.errors++
+	}
+	e.buckets[bucketIndex(d)]++
+
+	slow := s.cfg.SlowThreshold > 0 && d >= s.cfg.SlowThreshold
+	var sq SlowQuery
+	if slow {
+		sq = SlowQuery{ID: e.id, Fingerprint: fp, Params: formatParams(args), Duration: d, At: time.Now()}
+		if err != nil {
+			sq.Error = err.Error()
+		}
+		s.appendSlowLocked(sq)
+	}
+	s.mu.Unlock()
+	return sq, slow
+}
+
+func (s *QueryStats) appendSlowLocked(sq SlowQuery) {
+	if s.cfg.SlowLogSize <= 0 {
+		return
+	}
+	if len(s.slow) < s.cfg.SlowLogSize {
+		s.slow = append(s.slow, sq)
+	} else {
+		s.slow[s.slowNext] = sq
+	}
+	s.slowNext = (s.slowNext + 1) % s.cfg.SlowLogSize
+}
+
+// attachPlan stores a captured plan on the matching slow-log entry
+func (s *QueryStats) attachPlan(sq SlowQuery, plan string) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	for i := range s.slow {
+		if s.slow[i].ID == sq.ID && s.slow[i].At.Equal(sq.At) {
+			s.slow[i].Plan = plan
+			return
+		}
+	}
+}
+
+// Snapshot returns histograms sorted by total time (most expensive first) and
+// the slow-query log, newest first
+func (s *QueryStats) Snapshot() QueryStatsSnapshot {
+	snap := QueryStatsSnapshot{Statements: []QueryHistogram{}, SlowQueries: []SlowQuery{}}
+	if s == nil {
+		return snap
+	}
+	snap.SlowThreshold = s.cfg.SlowThreshold
+	snap.ExplainSampleRate = s.cfg.ExplainSampleRate
+
+	s.mu.Lock()
+	for _, e := range s.entries {
+		snap.Statements = append(snap.Statements, e.histogram())
+	}
+	n := len(s.slow)
+	for i := 0; i < n; i++ {
+		// slowNext-1 is the newest entry
+		snap.SlowQueries = append(snap.SlowQueries, s.slow[(s.slowNext-1-i+2*n)%n])
+	}
+	s.mu.Unlock()
+
+	sort.Slice(snap.Statements, func(i, j int) bool {
+		if snap.Statements[i].Total != snap.Statements[j].Total {
+			return snap.Statements[i].Total > snap.Statements[j].Total
+		}
+		return snap.Statements[i].ID < snap.Statements[j].ID
+	})
+	return snap
+}
+
+// Reset clears all histograms and the slow-query log
+func (s *QueryStats) Reset() {
+	if s == nil {
+		return
+	}
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	s.entries = make(map[string]*queryEntry)
+	s.slow = nil
+	s.slowNext = 0
+}
+
+func (e *queryEntry) histogram() QueryHistogram {
+	h := QueryHistogram{
+		ID:          e.id,
+		Fingerprint: e.fingerprint,
+		Count:       e.count,
+		Errors:      e.errors,
+		Total:       e.total,
+		Max:         e.max,
+		Buckets:     make([]QueryBucketCount, len(e.buckets)),
+	}
+	for i, c := range e.buckets {
+		if i < len(latencyBuckets) {
+			h.Buckets[i].Le = latencyBuckets[i]
+		}
+		h.Buckets[i].Count = c
+	}
+	h.P50 = e.quantile(0.50)
+	h.P95 = e.quantile(0.95)
+	h.P99 = e.quantile(0.99)
+	return h
+}
+
+// quantile estimates a latency quantile as the upper bound of the bucket that
+// contains it; the unbounded bucket reports the observed max
+func (e *queryEntry) quantile(q float64) time.Duration {
+	if e.count == 0 {
+		return 0
+	}
+	rank := int64(q*float64(e.count) + 0.5)
+	if rank < 1 {
+		rank = 1
+	}
+	var seen int64
+	for i, c := range e.buckets {
+		seen += c
+		if seen >= rank {
+			if i < len(latencyBuckets) && latencyBuckets[i] < e.max {
+				return latencyBuckets[i]
+			}
+			return e.max
+		}
+	}
+	return e.max
+}
+
+func bucketIndex(d time.Duration) int {
+	for i, le := range latencyBuckets {
+		if d <= le {
+			return i
+		}
+	}
+	return len(latencyBuckets)
+}
+
+// fingerprint returns the normalized statement text, caching results for up
+// to MaxFingerprints distinct raw queries
+func (s *QueryStats) fingerprint(query string) string {
+	if fp, ok := s.fingerprints.Load(query); ok {
+		return fp.(string)
+	}
+	fp := Fingerprint(query)
+	if s.cfg.MaxFingerprints <= 0 || s.cached.Load() < int64(s.cfg.MaxFingerprints) {
+		if _, loaded := s.fingerprints.LoadOrStore(query, fp); !loaded {
+			s.cached.Add(1)
+		}
+	}
+	return fp
+}
+
+// Fingerprint normalizes a SQL statement so executions that differ only in
+// literals, whitespace or the length of placeholder lists share one key:
+// string and numeric literals become ?, runs of whitespace collapse to one
+// space, and lists of placeholders such as ($1, $2, $3) become (...).
+func Fingerprint(query string) string {
+	var b strings.Builder
+	b.Grow(len(query))
+	runes := []rune(query)
+	space := false
+	for i := 0; i < len(runes); i++ {
+		r := runes[i]
+		switch {
+		case unicode.IsSpace(r):
+			space = true
+			continue
+		case r == '-' && i+1 < len(runes) && runes[i+1] == '-':
+			// Line comment
+			for i < len(runes) && runes[i] != '\n' {
+				i++
+			}
+			space = true
+			continue
+		}
+		if space && b.Len() > 0 {
+			b.WriteByte(' ')
+		}
+		space = false
+
+		switch {
+		case r == '\'':
+			// String literal ('' escapes a quote)
+			for i++; i < len(runes); i++ {
+				if runes[i] == '\'' {
+					if i+1 < len(runes) && runes[i+1] == '\'' {
+						i++
+						continue
+					}
+					break
+				}
+			}
+			b.WriteByte('?')
+		case unicode.IsDigit(r) && !isIdentRune(prevRune(runes, i)):
+			for i+1 < len(runes) && (unicode.IsDigit(runes[i+1]) || runes[i+1] == '.') {
+				i++
+			}
+			b.WriteByte('?')
+		default:
+			b.WriteRune(r)
+		}
+	}
+	return collapsePlaceholderLists(b.String())
+}
+
+func prevRune(runes []rune, i int) rune {
+	if i == 0 {
+		return ' '
+	}
+	return runes[i-1]
+}
+
+func isIdentRune(r rune) bool {
+	return unicode.IsLetter(r) || unicode.IsDigit(r) || r == '_' || r == '$'
+}
+
+// collapsePlaceholderLists rewrites "(?, ?)" / "($1, $2, $3)" into "(...)"
+func collapsePlaceholderLists(s string) string {
+	var b strings.Builder
+	for {
+		open := strings.IndexByte(s, '(')
+		if open < 0 {
+			b.WriteString(s)
+			return b.String()
+		}
+		close := strings.IndexByte(s[open:], ')')
+		if close < 0 {
+			b.WriteString(s)
+			return b.String()
+		}
+		close += open
+		if isPlaceholderList(s[open+1 : close]) {
+			b.WriteString(s[:open])
+			b.WriteString("(...)")
+		} else {
+			b.WriteString(s[:open+1])
+			close = open
+		}
+		s = s[close+1:]
+	}
+}
+
+func isPlaceholderList(s string) bool {
+	items := strings.Split(s, ",")
+	if len(items) < 2 {
+		return false
+	}
+	for _, item := range items {
+		item = strings.TrimSpace(item)
+		if item == "?" {
+			continue
+		}
+		if len(item) < 2 || item[0] != '$' || strings.TrimLeft(item[1:], "0123456789") != "" {
+			return false
+		}
+	}
+	return true
+}
+
+func fingerprintID(fp string) string {
+	h := fnv.New64a()
+	h.Write([]byte(fp))
+	return fmt.Sprintf("%016x", h.Sum64())
+}
+
+// formatParams renders statement arguments for logging, truncating long values
+func formatParams(args []interface{}) []string {
+	if len(args) == 0 {
+		return nil
+	}
+	out := make([]string, len(args))
+	for i, a := range args {
+		var v string
+		switch t := a.(type) {
+		case nil:
+			v = "NULL"
+		case []byte:
+			v = fmt.Sprintf("<%d bytes>", len(t))
+		case string:
+			v = t
+		default:
+			v = fmt.Sprintf("%v", t)
+		}
+		if len(v) > maxParamLen {
+			v = fmt.Sprintf("%s...(%d chars)", v[:maxParamLen], len(v))
+		}
+		out[i] = v
+	}
+	return out
+}
+
+// isReadOnlyStatement reports whether EXPLAIN ANALYZE can safely re-run the
+// statement. The explain additionally runs in a read-only transaction that is
+// rolled back, so this check only avoids pointless failures.
+func isReadOnlyStatement(query string) bool {
+	q := strings.ToUpper(strings.TrimSpace(query))
+	if !strings.HasPrefix(q, "SELECT") && !strings.HasPrefix(q, "WITH") {
+		return false
+	}
+	for _, kw := range []string{"INSERT ", "UPDATE ", "DELETE ", "FOR UPDATE", "FOR SHARE"} {
+		if strings.Contains(q, kw) {
+			return false
+		}
+	}
+	return true
+}
+
+// QueryStats returns the statement statistics recorder, or nil when disabled
+func (db *DB) QueryStats() *QueryStats {
+	if db == nil {
+		return nil
+	}
+	return db.stats
+}
+
+// QueryContext executes a query with latency instrumentation.
+// Latency covers execution up to the first row; row iteration is excluded.
+func (db *DB) QueryContext(ctx context.Context, query string, args ...interface{}) (*sql.Rows, error) {
+	start := time.Now()
+	rows, err := db.DB.QueryContext(ctx, query, args...)
+	db.observe(query, args, time.Since(start), err)
+	return rows, err
+}
+
+// QueryRowContext executes a single-row query with latency instrumentation
+func (db *DB) QueryRowContext(ctx context.Context, query string, args ...interface{}) *sql.Row {
+	start := time.Now()
+	row := db.DB.QueryRowContext(ctx, query, args...)
+	db.observe(query, args, time.Since(start), row.Err())
+	return row
+}
+
+// ExecContext executes a statement with latency instrumentation
+func (db *DB) ExecContext(ctx context.Context, query string, args ...interface{}) (sql.Result, error) {
+	start := time.Now()
+	result, err := db.DB.ExecContext(ctx, query, args...)
+	db.observe(query, args, time.Since(start), err)
+	return result, err
+}
+
+func (db *DB) observe(query string, args []interface{}, d time.Duration, err error) {
+	if db.stats == nil {
+		return
+	}
+	sq, slow := db.stats.observe(query, args, d, err)
+	if !slow {
+		return
+	}
+	if dbLogger != nil {
+		dbLogger.Warnf("Slow query %s took %s: %s params=%v", sq.ID, d, sq.Fingerprint, sq.Params)
+	}
+	if db.stats.shouldExplain(query, err) {
+		go db.explain(sq, query, args)
+	}
+}
+
+// shouldExplain samples slow read-only statements, one EXPLAIN at a time
+func (s *QueryStats) shouldExplain(query string, err error) bool {
+	if err != nil || s.cfg.ExplainSampleRate <= 0 || !isReadOnlyStatement(query) {
+		return false
+	}
+	if s.cfg.ExplainSampleRate < 1 && rand.Float64() >= s.cfg.ExplainSampleRate {
+		return false
+	}
+	return s.explaining.CompareAndSwap(false, true)
+}
+
+// explain re-runs the statement under EXPLAIN (ANALYZE, BUFFERS) in a
+// read-only transaction that is always rolled back
+func (db *DB) explain(sq SlowQuery, query string, args []interface{}) {
+	defer db.stats.explaining.Store(false)
+
+	ctx, cancel := context.WithTimeout(context.Background(), db.stats.cfg.ExplainTimeout)
+	defer cancel()
+
+	tx, err := db.DB.BeginTx(ctx, &sql.TxOptions{ReadOnly: true})
+	if err != nil {
+		return
+	}
+	defer tx.Rollback()
+
+	rows, err := tx.QueryContext(ctx, "EXPLAIN (ANALYZE, BUFFERS) "+query, args...)
+	if err != nil {
+		if dbLogger != nil {
+			dbLogger.Debugf("EXPLAIN for slow query %s failed: %v", sq.ID, err)
+		}
+		return
+	}
+	defer rows.Close()
+
+	var lines []string
+	for rows.Next() {
+		var line string
+		if err := rows.Scan(&line); err != nil {
+			return
+		}
+		lines = append(lines, line)
+	}
+	if rows.Err() != nil {
+		return
+	}
+	db.stats.attachPlan(sq, strings.Join(lines, "\n"))
+}
@@ -0,0 +1,136 @@
+package models
+
+import (
+	"errors"
+	"strings"
+	"testing"
+	"time"
+)
+
+// Unit tests for statement instrumentation (no database required)
+
+func TestFingerprint(t *testing.T) {
+	tests := []struct {
+		in   string
+		want string
+	}{
+		{
+			"SELECT * FROM symbols\n\t\tWHERE name = 'foo''s' AND start_line > 42",
+			"SELECT * FROM symbols WHERE name = ? AND start_line > ?",
+		},
+		{
+			"SELECT s.symbol_id FROM symbols s WHERE s.file_id IN ($1, $2, $3) -- hot path\n LIMIT $4",
+			"SELECT s.symbol_id FROM symbols s WHERE s.file_id IN (...) LIMIT $4",
+		},
+		{
+			"INSERT INTO edges_v2 (a, b) VALUES ($1, $2)",
+			"INSERT INTO edges_v2 (a, b) VALUES (...)",
+		},
+		{
+			"SELECT COUNT(*) FROM files WHERE repo_id = $1",
+			"SELECT COUNT(*) FROM files WHERE repo_id = $1",
+		},
+	}
+	for _, tt := range tests {
+		if got := Fingerprint(tt.in); got != tt.want {
+			t.Errorf("Fingerprint(%q) = %q, want %q", tt.in, got, tt.want)
+		}
+	}
+}
+
+func TestQueryStats_Histogram(t *testing.T) {
+	s := NewQueryStats(DefaultQueryStatsConfig())
+	q := "SELECT * FROM symbols WHERE symbol_id = $1"
+	for i := 0; i < 98; i++ {
+		s.observe(q, nil, 3*time.Millisecond, nil)
+	}
+	s.observe(q, nil, 40*time.Millisecond, nil)
+	s.observe("  SELECT *   FROM symbols WHERE symbol_id = $1", nil, 2*time.Second, errors.New("timeout"))
+
+	snap := s.Snapshot()
+	if len(snap.Statements) != 1 {
+		t.Fatalf("Expected executions to share one fingerprint, got %d", len(snap.Statements))
+	}
+	h := snap.Statements[0]
+	if h.Count != 100 || h.Errors != 1 || h.Max != 2*time.Second {
+		t.Errorf("Unexpected histogram: count=%d errors=%d max=%s", h.Count, h.Errors, h.Max)
+	}
+	if h.P50 != 5*time.Millisecond || h.P99 != 50*time.Millisecond {
+		t.Errorf("Unexpected quantiles: p50=%s p99=%s", h.P50, h.P99)
+	}
+
+	if len(snap.SlowQueries) != 1 || snap.SlowQueries[0].Error != "timeout" {
+		t.Errorf("Expected one slow query with error, got %+v", snap.SlowQueries)
+	}
+}
+
+func TestQueryStats_SlowLogIsBoundedNewestFirst(t *testing.T) {
+	cfg := DefaultQueryStatsConfig()
+	cfg.SlowLogSize = 2
+	s := NewQueryStats(cfg)
+	for _, q := range []string{"SELECT 1", "SELECT a FROM t", "SELECT b FROM t"} {
+		s.observe(q, []interface{}{strings.Repeat("x", 100), []byte("abc"), nil, 7}, time.Second, nil)
+	}
+
+	slow := s.Snapshot().SlowQueries
+	if len(slow) != 2 || slow[0].Fingerprint != "SELECT b FROM t" || slow[1].Fingerprint != "SELECT a FROM t" {
+		t.Fatalf("Unexpected slow log: %+v", slow)
+	}
+	params := slow[0].Params
+	if len(params) != 4 || !strings.HasSuffix(params[0], "...(100 chars)") || params[1] != "<3 bytes>" || params[2] != "NULL" || params[3] != "7" {
+		t.Errorf("Unexpected params: %v", params)
+	}
+
+	s.Reset()
+	if snap := s.Snapshot(); len(snap.Statements) != 0 || len(snap.SlowQueries) != 0 {
+		t.Errorf("Expected empty stats after reset, got %+v", snap)
+	}
+}
+
+func TestQueryStats_FoldsExcessFingerprints(t *testing.T) {
+	cfg := DefaultQueryStatsConfig()
+	cfg.MaxFingerprints = 2
+	s := NewQueryStats(cfg)
+	for _, table := range []string{"a", "b", "c", "d"} {
+		s.observe("SELECT * FROM "+table, nil, time.Millisecond, nil)
+	}
+
+	snap := s.Snapshot()
+	if len(snap.Statements) != 3 {
+		t.Fatalf("Expected 2 statements plus the overflow entry, got %d", len(snap.Statements))
+	}
+	for _, h := range snap.Statements {
+		if h.Fingerprint == otherFingerprint && h.Count != 2 {
+			t.Errorf("Expected 2 folded executions, got %d", h.Count)
+		}
+	}
+}
+
+func TestQueryStats_ExplainSampling(t *testing.T) {
+	cfg := DefaultQueryStatsConfig()
+	cfg.ExplainSampleRate = 1
+	s := NewQueryStats(cfg)
+
+	if s.shouldExplain("UPDATE files SET size = $1", nil) {
+		t.Error("Did not expect EXPLAIN ANALYZE for a write statement")
+	}
+	if s.shouldExplain("SELECT 1", errors.New("failed")) {
+		t.Error("Did not expect EXPLAIN for a failed statement")
+	}
+	if !s.shouldExplain("WITH x AS (SELECT 1) SELECT * FROM x", nil) {
+		t.Error("Expected EXPLAIN for a sampled read")
+	}
+	if s.shouldExplain("SELECT 1", nil) {
+		t.Error("Expected only one EXPLAIN in flight")
+	}
+}
+
+func TestDB_QueryStatsDisabled(t *testing.T) {
+	db := &DB{}
+	if db.QueryStats() != nil {
+		t.Error("Expected no recorder when instrumentation is disabled")
+	}
+	if snap := db.QueryStats().Snapshot(); snap.Statements == nil || snap.SlowQueries == nil {
+		t.Error("Expected empty, non-nil snapshot slices from a nil recorder")
+	}
+}
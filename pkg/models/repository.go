@@ -251,3 +251,51 @@ func (r *RepositoryRepository) Count(ctx context.Context) (int64, error) {
 	err := r.db.QueryRowContext(ctx, query).Scan(&count)
 	return count, err
 }
+
+// BumpIndexGeneration atomically increments the repository's index generation
+// and records it in the in-memory generation table used for conditional GETs
+func (r *RepositoryRepository) BumpIndexGeneration(ctx context.Context, repoID string) (IndexGeneration, error) {
+	query := `
+		UPDATE repositories
+		SET index_generation = index_generation + 1, updated_at = NOW()
+		WHERE repo_id = $1
+		RETURNING index_generation, updated_at
+	`
+	var gen IndexGeneration
+	err := r.db.QueryRowContext(ctx, query, repoID).Scan(&gen.Value, &gen.ModifiedAt)
+	if err != nil {
+		if err == sql.ErrNoRows {
+			return gen, fmt.Errorf("repository not found: %s", repoID)
+		}
+		return gen, err
+	}
+	r.db.Generations().Observe(repoID, gen)
+	return gen, nil
+}
+
+// LoadIndexGenerations reloads the in-memory generation table from the
+// database, so that conditional GETs work right after a restart
+func (r *RepositoryRepository) LoadIndexGenerations(ctx context.Context) error {
+	return r.db.Generations().Reload(ctx)
+}
+
+// ListIndexGenerations reads the persisted generation of every repository
+func (r *RepositoryRepository) ListIndexGenerations(ctx context.Context) (map[string]IndexGeneration, error) {
+	query := `SELECT repo_id, index_generation, updated_at FROM repositories`
+	rows, err := r.db.QueryContext(ctx, query)
+	if err != nil {
+		return nil, err
+	}
+	defer rows.Close()
+
+	gens := make(map[string]IndexGeneration)
+	for rows.Next() {
+		var repoID string
+		var gen IndexGeneration
+		if err := rows.Scan(&repoID, &gen.Value, &gen.ModifiedAt); err != nil {
+			return nil, err
+		}
+		gens[repoID] = gen
+	}
+	return gens, rows.Err()
+}
@@ -22,6 +22,15 @@ func (sm *SchemaManager) InitializeSchema(ctx context.Context) error {
 		dbLogger.Debug("Initializing database schema...")
 	}
 
+	// 迁移版本已是最新时，扩展和核心表必然由迁移建好，跳过逐项检查：
+	// 大库上 information_schema 查询较慢，每次副本重启都要付一遍。
+	if version, ok := sm.appliedVersion(ctx); ok && version >= LatestMigrationVersion() {
+		if dbLogger != nil {
+			dbLogger.Debugf("Schema at migration version %d, skipping verification", version)
+		}
+		return nil
+	}
+
 	// Check and create extensions
 	if err := sm.ensureExtensions(ctx); err != nil {
 		return fmt.Errorf("failed to ensure extensions: %w", err)
@@ -47,6 +56,19 @@ func (sm *SchemaManager) InitializeSchema(ctx context.Context) error {
 	return nil
 }
 
+// appliedVersion 读取 goose_db_version 中最后一条记录的版本。表不存在、最后一步
+// 是回滚或查询失败时返回 false，调用方退回完整检查。只读查询，不会像
+// goose.GetDBVersion 那样在缺表时建表。
+func (sm *SchemaManager) appliedVersion(ctx context.Context) (int64, bool) {
+	var version int64
+	var applied bool
+	query := `SELECT version_id, is_applied FROM goose_db_version ORDER BY id DESC LIMIT 1`
+	if err := sm.db.QueryRowContext(ctx, query).Scan(&version, &applied); err != nil {
+		return 0, false
+	}
+	return version, applied && version > 0
+}
+
 // CreateSchema applies all pending database migrations via goose.
 // 迁移 SQL 的唯一真源为 pkg/models/migrations/*.sql，由 go:embed 嵌入二进制。
 // 历史实现在此内联了一份 DDL（与 docker/initdb、deployments/migrations 三套并行，
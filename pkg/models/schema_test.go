@@ -198,3 +198,10 @@ func TestWaitForDatabase(t *testing.T) {
 		t.Fatalf("Database ping failed: %v", err)
 	}
 }
+
+func TestLatestMigrationVersion(t *testing.T) {
+	// 嵌入的迁移至少包含 external_modules（20260101000011）
+	if v := LatestMigrationVersion(); v < 20260101000011 {
+		t.Errorf("LatestMigrationVersion() = %d, want >= 20260101000011", v)
+	}
+}
@@ -0,0 +1,375 @@
+package models
+
+import (
+	"context"
+	"crypto/rand"
+	"database/sql"
+	"encoding/hex"
+	"encoding/json"
+	"fmt"
+	"strconv"
+	"strings"
+	"time"
+
+	"github.com/lib/pq"
+)
+
+// stagedTablePrefix names the per-write staging tables:
+// staged_<unix seconds, hex>_<random>_<table>
+const stagedTablePrefix = "staged_"
+
+// staleStagedWriteAge is how old staging tables left by a crashed writer must
+// be before another write drops them
+const staleStagedWriteAge = 24 * time.Hour
+
+// stagedColumns are the columns a staged write copies, per live table. Edges
+// carry the module name; it is interned into external_modules before publish.
+var stagedColumns = map[string][]string{
+	"files":     {"file_id", "repo_id", "path", "language", "size", "checksum", "created_at", "updated_at", "canonical_file_id", "api_only"},
+	"symbols":   {"symbol_id", "file_id", "name", "kind", "signature", "start_line", "end_line", "start_byte", "end_byte", "docstring", "semantic_summary", "created_at"},
+	"ast_nodes": {"node_id", "file_id", "type", "parent_id", "start_line", "end_line", "start_byte", "end_byte", "text", "attributes", "created_at"},
+	"edges":     {"edge_id", "source_id", "target_id", "edge_type", "source_file", "target_file", "target_module", "target_name", "created_at"},
+}
+
+// stagedTables is the publish order (parents before children)
+var stagedTables = []string{"files", "symbols", "ast_nodes", "edges"}
+
+// StagedGroup is one partition of a staged write, loaded in its own transaction
+type StagedGroup struct {
+	Files   []*File
+	Symbols []*Symbol
+	Nodes   []*ASTNode
+	Edges   []*Edge
+}
+
+// StagedWrite writes a repository through private UNLOGGED staging tables:
+// WriteGroup may be called concurrently, each call COPYing one partition on
+// its own connection and transaction, and Publish moves everything into the
+// live tables in a single transaction of server-side INSERT ... SELECT.
+// Readers never see staging tables, so they observe either the previous state
+// or the complete new one, while the slow part of the load scales with the
+// number of connections and holds no locks on the live tables.
+type StagedWrite struct {
+	db     *DB
+	prefix string
+}
+
+// BeginStagedWrite creates the staging tables of a new write. Staging tables
+// left behind by writers that died more than staleStagedWriteAge ago are
+// dropped first.
+func BeginStagedWrite(ctx context.Context, db *DB) (*StagedWrite, error) {
+	if err := dropStaleStagedWrites(ctx, db, time.Now().Add(-staleStagedWriteAge)); err != nil && dbLogger != nil {
+		dbLogger.Warnf("Failed to drop stale staging tables: %v", err)
+	}
+
+	token := make([]byte, 4)
+	if _, err := rand.Read(token); err != nil {
+		return nil, fmt.Errorf("failed to generate staging token: %w", err)
+	}
+	s := &StagedWrite{
+		db:     db,
+		prefix: fmt.Sprintf("%s%x_%s_", stagedTablePrefix, time.Now().Unix(), hex.EncodeToString(token)),
+	}
+
+	for _, table := range stagedTables {
+		staged := pq.QuoteIdentifier(s.table(table))
+		// stage_seq 记录写入顺序：同一键出现多次时发布最后写入的那一行
+		stmts := []string{
+			fmt.Sprintf("CREATE UNLOGGED TABLE %s (LIKE %s INCLUDING DEFAULTS)", staged, table),
+			fmt.Sprintf("ALTER TABLE %s ADD COLUMN stage_seq BIGSERIAL", staged),
+		}
+		if table == "edges" {
+			stmts = append(stmts, fmt.Sprintf("ALTER TABLE %s ADD COLUMN target_module TEXT", staged))
+		}
+		for _, stmt := range stmts {
+			if _, err := db.ExecContext(ctx, stmt); err != nil {
+				s.Discard(context.WithoutCancel(ctx))
+				return nil, fmt.Errorf("failed to create staging table for %s: %w", table, err)
+			}
+		}
+	}
+	return s, nil
+}
+
+func (s *StagedWrite) table(name string) string {
+	return s.prefix + name
+}
+
+// WriteGroup COPYs one partition into the staging tables in its own
+// transaction. Safe to call concurrently.
+func (s *StagedWrite) WriteGroup(ctx context.Context, group StagedGroup) error {
+	tx, err := s.db.BeginTx(ctx, nil)
+	if err != nil {
+		return fmt.Errorf("failed to begin staging transaction: %w", err)
+	}
+	defer tx.Rollback()
+
+	now := time.Now()
+	err = s.copyRows(ctx, tx, "files", len(group.Files), func(i int) ([]interface{}, error) {
+		f := group.Files[i]
+		f.CreatedAt, f.UpdatedAt = now, now
+		return []interface{}{f.FileID, f.RepoID, f.Path, f.Language, f.Size, f.Checksum, f.CreatedAt, f.UpdatedAt, f.CanonicalFileID, f.APIOnly}, nil
+	})
+	if err != nil {
+		return err
+	}
+	err = s.copyRows(ctx, tx, "symbols", len(group.Symbols), func(i int) ([]interface{}, error) {
+		sym := group.Symbols[i]
+		sym.CreatedAt = now
+		return []interface{}{sym.SymbolID, sym.FileID, sym.Name, sym.Kind, sym.Signature,
+			sym.StartLine, sym.EndLine, sym.StartByte, sym.EndByte,
+			sym.Docstring, sym.SemanticSummary, sym.CreatedAt}, nil
+	})
+	if err != nil {
+		return err
+	}
+	err = s.copyRows(ctx, tx, "ast_nodes", len(group.Nodes), func(i int) ([]interface{}, error) {
+		node := group.Nodes[i]
+		node.CreatedAt = now
+		attributes := "{}"
+		if len(node.Attributes) > 0 {
+			data, err := json.Marshal(node.Attributes)
+			if err != nil {
+				return nil, fmt.Errorf("failed to marshal attributes for node %s: %w", node.NodeID, err)
+			}
+			// COPY 会把 []byte 编码为 bytea，jsonb 列需要文本
+			attributes = string(data)
+		}
+		return []interface{}{node.NodeID, node.FileID, node.Type, node.ParentID,
+			node.StartLine, node.EndLine, node.StartByte, node.EndByte,
+			node.Text, attributes, node.CreatedAt}, nil
+	})
+	if err != nil {
+		return err
+	}
+	err = s.copyRows(ctx, tx, "edges", len(group.Edges), func(i int) ([]interface{}, error) {
+		edge := group.Edges[i]
+		edge.CreatedAt = now
+		return []interface{}{edge.EdgeID, edge.SourceID, edge.TargetID, edge.EdgeType,
+			edge.SourceFile, edge.TargetFile, edge.TargetModule, edge.TargetName, edge.CreatedAt}, nil
+	})
+	if err != nil {
+		return err
+	}
+
+	if err := tx.Commit(); err != nil {
+		return fmt.Errorf("failed to commit staging transaction: %w", err)
+	}
+	return nil
+}
+
+// copyRows COPYs n rows produced by row into the staging table of table
+func (s *StagedWrite) copyRows(ctx context.Context, tx *sql.Tx, table string, n int, row func(i int) ([]interface{}, error)) error {
+	if n == 0 {
+		return nil
+	}
+	stmt, err := tx.PrepareContext(ctx, pq.CopyIn(s.table(table), stagedColumns[table]...))
+	if err != nil {
+		return fmt.Errorf("failed to start staging copy for %s: %w", table, err)
+	}
+	defer stmt.Close()
+
+	for i := 0; i < n; i++ {
+		values, err := row(i)
+		if err != nil {
+			return err
+		}
+		if _, err := stmt.ExecContext(ctx, values...); err != nil {
+			return fmt.Errorf("failed to stage %s: %w", table, err)
+		}
+	}
+	// 无参数的 Exec 结束 COPY；类型错误在这里返回
+	if _, err := stmt.ExecContext(ctx); err != nil {
+		return fmt.Errorf("failed to stage %s: %w", table, err)
+	}
+	return nil
+}
+
+// Publish moves the staged rows into the live tables in one transaction, with
+// the same conflict handling as the BatchCreateTx methods. It does not drop
+// the staging tables; call Discard afterwards.
+func (s *StagedWrite) Publish(ctx context.Context) error {
+	// 模块名在发布事务之外 intern，见 InternExternalModules
+	names, err := s.stagedModuleNames(ctx)
+	if err != nil {
+		return err
+	}
+	if _, err := InternExternalModules(ctx, s.db, names); err != nil {
+		return err
+	}
+
+	tx, err := s.db.BeginTx(ctx, nil)
+	if err != nil {
+		return fmt.Errorf("failed to begin publish transaction: %w", err)
+	}
+	defer tx.Rollback()
+
+	for _, table := range stagedTables {
+		for _, query := range s.publishQueries(table) {
+			if _, err := tx.ExecContext(ctx, query); err != nil {
+				return fmt.Errorf("failed to publish %s: %w", table, err)
+			}
+		}
+	}
+
+	if err := tx.Commit(); err != nil {
+		return fmt.Errorf("failed to commit publish transaction: %w", err)
+	}
+	return nil
+}
+
+// stagedModuleNames returns the distinct target modules of the staged edges
+func (s *StagedWrite) stagedModuleNames(ctx context.Context) ([]string, error) {
+	rows, err := s.db.QueryContext(ctx, fmt.Sprintf(`
+		SELECT DISTINCT target_module FROM %s WHERE target_module IS NOT NULL AND target_module != ''
+	`, pq.QuoteIdentifier(s.table("edges"))))
+	if err != nil {
+		return nil, fmt.Errorf("failed to read staged modules: %w", err)
+	}
+	defer rows.Close()
+
+	var names []string
+	for rows.Next() {
+		var name string
+		if err := rows.Scan(&name); err != nil {
+			return nil, err
+		}
+		names = append(names, name)
+	}
+	return names, rows.Err()
+}
+
+// publishQueries returns the statements that move table's staged rows into
+// the live table. DISTINCT ON keeps the last staged row of a key, as the
+// row-by-row upserts of BatchCreateTx would.
+func (s *StagedWrite) publishQueries(table string) []string {
+	staged := pq.QuoteIdentifier(s.table(table))
+	switch table {
+	case "files":
+		return []string{fmt.Sprintf(`
+			INSERT INTO files (file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only)
+			SELECT DISTINCT ON (repo_id, path) file_id, repo_id, path, language, size, checksum, created_at, updated_at, canonical_file_id, api_only
+			FROM %s ORDER BY repo_id, path, stage_seq DESC
+			ON CONFLICT (repo_id, path)
+			DO UPDATE SET
+				language = EXCLUDED.language,
+				size = EXCLUDED.size,
+				checksum = EXCLUDED.checksum,
+				updated_at = EXCLUDED.updated_at,
+				canonical_file_id = EXCLUDED.canonical_file_id,
+				api_only = EXCLUDED.api_only
+			WHERE files.checksum != EXCLUDED.checksum
+				OR files.canonical_file_id IS DISTINCT FROM EXCLUDED.canonical_file_id
+				OR files.api_only != EXCLUDED.api_only
+		`, staged)}
+	case "symbols":
+		return []string{fmt.Sprintf(`
+			INSERT INTO symbols (symbol_id, file_id, name, kind, signature, start_line, end_line,
+				start_byte, end_byte, docstring, semantic_summary, created_at)
+			SELECT DISTINCT ON (file_id, name, start_line, start_byte) symbol_id, file_id, name, kind, signature,
+				start_line, end_line, start_byte, end_byte, docstring, semantic_summary, created_at
+			FROM %s ORDER BY file_id, name, start_line, start_byte, stage_seq DESC
+			ON CONFLICT (file_id, name, start_line, start_byte)
+			DO UPDATE SET
+				symbol_id = EXCLUDED.symbol_id,
+				kind = EXCLUDED.kind,
+				signature = EXCLUDED.signature,
+				end_line = EXCLUDED.end_line,
+				end_byte = EXCLUDED.end_byte,
+				docstring = EXCLUDED.docstring,
+				semantic_summary = EXCLUDED.semantic_summary
+		`, staged)}
+	case "ast_nodes":
+		// 外键（含 parent_id 自引用）在语句结束时检查，父子节点顺序无关
+		return []string{fmt.Sprintf(`
+			INSERT INTO ast_nodes (node_id, file_id, type, parent_id, start_line, end_line,
+				start_byte, end_byte, text, attributes, created_at)
+			SELECT DISTINCT ON (node_id) node_id, file_id, type, parent_id, start_line, end_line,
+				start_byte, end_byte, text, attributes, created_at
+			FROM %s ORDER BY node_id, stage_seq DESC
+			ON CONFLICT (node_id)
+			DO UPDATE SET
+				type = EXCLUDED.type,
+				parent_id = EXCLUDED.parent_id,
+				start_line = EXCLUDED.start_line,
+				end_line = EXCLUDED.end_line,
+				start_byte = EXCLUDED.start_byte,
+				end_byte = EXCLUDED.end_byte,
+				text = EXCLUDED.text,
+				attributes = EXCLUDED.attributes
+		`, staged)}
+	case "edges":
+		return []string{
+			fmt.Sprintf(`
+				INSERT INTO edges (edge_id, source_id, target_id, edge_type, source_file, target_file,
+					target_module_id, target_name, created_at)
+				SELECT DISTINCT ON (i.edge_id) i.edge_id, i.source_id, i.target_id, i.edge_type, i.source_file,
+					i.target_file, m.module_id, i.target_name, i.created_at
+				FROM %s i
+				LEFT JOIN external_modules m ON m.name = i.target_module
+				ORDER BY i.edge_id, i.stage_seq DESC
+				ON CONFLICT (edge_id)
+				DO UPDATE SET
+					target_id = EXCLUDED.target_id,
+					edge_type = EXCLUDED.edge_type,
+					source_file = EXCLUDED.source_file,
+					target_file = EXCLUDED.target_file,
+					target_module_id = EXCLUDED.target_module_id,
+					target_name = EXCLUDED.target_name
+			`, staged),
+		}
+	}
+	return nil
+}
+
+// Discard drops the staging tables. Safe to call more than once.
+func (s *StagedWrite) Discard(ctx context.Context) {
+	names := make([]string, len(stagedTables))
+	for i, table := range stagedTables {
+		names[i] = pq.QuoteIdentifier(s.table(table))
+	}
+	if _, err := s.db.ExecContext(ctx, "DROP TABLE IF EXISTS "+strings.Join(names, ", ")); err != nil && dbLogger != nil {
+		dbLogger.Warnf("Failed to drop staging tables %s*: %v", s.prefix, err)
+	}
+}
+
+// dropStaleStagedWrites drops staging tables created before cutoff
+func dropStaleStagedWrites(ctx context.Context, db *DB, cutoff time.Time) error {
+	rows, err := db.QueryContext(ctx, `
+		SELECT tablename FROM pg_tables
+		WHERE schemaname = current_schema() AND tablename LIKE 'staged\_%'
+	`)
+	if err != nil {
+		return err
+	}
+	var stale []string
+	for rows.Next() {
+		var name string
+		if err := rows.Scan(&name); err != nil {
+			rows.Close()
+			return err
+		}
+		if created, ok := stagedTableCreated(name); ok && created.Before(cutoff) {
+			stale = append(stale, pq.QuoteIdentifier(name))
+		}
+	}
+	rows.Close()
+	if err := rows.Err(); err != nil || len(stale) == 0 {
+		return err
+	}
+	_, err = db.ExecContext(ctx, "DROP TABLE IF EXISTS "+strings.Join(stale, ", "))
+	return err
+}
+
+// stagedTableCreated parses the creation time encoded in a staging table name
+func stagedTableCreated(name string) (time.Time, bool) {
+	parts := strings.SplitN(strings.TrimPrefix(name, stagedTablePrefix), "_", 3)
+	if !strings.HasPrefix(name, stagedTablePrefix) || len(parts) != 3 {
+		return time.Time{}, false
+	}
+	unix, err := strconv.ParseInt(parts[0], 16, 64)
+	if err != nil {
+		return time.Time{}, false
+	}
+	return time.Unix(unix, 0), true
+}
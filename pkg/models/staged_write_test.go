@@ -0,0 +1,40 @@
+package models
+
+import (
+	"fmt"
+	"strings"
+	"testing"
+	"time"
+)
+
+func TestStagedTableCreated(t *testing.T) {
+	created := time.Unix(1767225600, 0)
+	s := &StagedWrite{prefix: fmt.Sprintf("staged_%x_0a1b2c3d_", created.Unix())}
+
+	got, ok := stagedTableCreated(s.table("ast_nodes"))
+	if !ok || !got.Equal(created) {
+		t.Errorf("expected creation time %v, got %v (ok=%v)", created, got, ok)
+	}
+	for _, name := range []string{"symbols", "staged_", "staged_zz_1_files", "stagedfiles"} {
+		if _, ok := stagedTableCreated(name); ok {
+			t.Errorf("%q should not parse as a staging table", name)
+		}
+	}
+}
+
+func TestStagedWrite_PublishQueries(t *testing.T) {
+	s := &StagedWrite{prefix: "staged_1_2_"}
+	for _, table := range stagedTables {
+		queries := s.publishQueries(table)
+		if len(queries) == 0 {
+			t.Fatalf("no publish query for %s", table)
+		}
+		last := queries[len(queries)-1]
+		if !strings.Contains(last, "INSERT INTO "+table) || !strings.Contains(last, `"staged_1_2_`+table+`"`) {
+			t.Errorf("%s publish query does not copy from its staging table:\n%s", table, last)
+		}
+		if !strings.Contains(last, "stage_seq DESC") {
+			t.Errorf("%s publish query should keep the last staged row of a key", table)
+		}
+	}
+}
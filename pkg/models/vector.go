@@ -7,6 +7,7 @@ import (
 	"sort"
 	"strconv"
 	"strings"
+	"sync"
 	"time"
 
 	"github.com/lib/pq"
@@ -26,12 +27,24 @@ type Vector struct {
 
 // VectorRepository handles CRUD operations for vectors
 type VectorRepository struct {
-	db *DB
+	db       *DB
+	fanOut   FanOutConfig
+	efSearch EfSearchPolicy
 }
 
 // NewVectorRepository creates a new vector repository
 func NewVectorRepository(db *DB) *VectorRepository {
-	return &VectorRepository{db: db}
+	return &VectorRepository{db: db, fanOut: DefaultFanOutConfig(), efSearch: DefaultEfSearchPolicy()}
+}
+
+// SetFanOutConfig replaces the multi-repository fan-out configuration
+func (r *VectorRepository) SetFanOutConfig(cfg FanOutConfig) {
+	r.fanOut = cfg
+}
+
+// SetEfSearchPolicy replaces the per-query hnsw.ef_search policy
+func (r *VectorRepository) SetEfSearchPolicy(policy EfSearchPolicy) {
+	r.efSearch = policy
 }
 
 // formatVectorForPgvector converts []float32 to pgvector format string [0.1,0.2,0.3]
@@ -371,10 +384,82 @@ func (r *VectorRepository) SimilaritySearch(ctx context.Context, queryEmbedding
 	return results, rows.Err()
 }
 
-// SimilaritySearchWithFilters performs vector similarity search with additional filters
+// SimilaritySearchWithFilters performs vector similarity search with additional filters.
+// Searches spanning at least FanOutConfig.MinRepos repositories run one query
+// per repository concurrently and merge the per-shard top-K (see fanOutSearch).
+//
+// With CoarseFiles set the search runs coarse-to-fine: the closest files are
+// picked from coarse_vectors first and only their symbols are ranked. When
+// any file in scope that has symbol vectors lacks coarse vectors (e.g. some of
+// the repositories were indexed without multi-granularity embedding) the full
+// symbol-level search runs instead, so those files are not dropped.
 func (r *VectorRepository) SimilaritySearchWithFilters(ctx context.Context, queryEmbedding []float32, filters VectorSearchFilters) ([]*VectorSearchResult, error) {
+	results, _, err := r.SimilaritySearchWithPlan(ctx, queryEmbedding, filters)
+	return results, err
+}
+
+// SimilaritySearchWithPlan is SimilaritySearchWithFilters that also reports
+// how the search ran: the hnsw.ef_search chosen for the requested limit,
+// filter selectivity and recall target, and whether it had to be widened
+func (r *VectorRepository) SimilaritySearchWithPlan(ctx context.Context, queryEmbedding []float32, filters VectorSearchFilters) ([]*VectorSearchResult, *SearchPlan, error) {
+	if filters.CoarseFiles > 0 {
+		covered, err := r.coarseCoversScope(ctx, filters)
+		if err != nil {
+			return nil, nil, fmt.Errorf("coarse search failed: %w", err)
+		}
+		var fileIDs []string
+		if covered {
+			fileIDs, err = r.coarseCandidateFiles(ctx, queryEmbedding, filters)
+			if err != nil {
+				return nil, nil, fmt.Errorf("coarse search failed: %w", err)
+			}
+		} else if dbLogger != nil {
+			dbLogger.Debugf("Coarse search skipped: some files in scope have no coarse vectors")
+		}
+		filters.CoarseFiles = 0
+		if len(fileIDs) > 0 {
+			filters.FileIDs = fileIDs
+		}
+	}
+	if r.fanOut.MinRepos > 0 && len(filters.RepoIDs) >= r.fanOut.MinRepos {
+		plan := newSearchPlan(filters)
+		var mu sync.Mutex
+		results, stats, err := fanOutSearch(ctx, filters, r.fanOut, func(ctx context.Context, f VectorSearchFilters) ([]*VectorSearchResult, error) {
+			results, shardPlan, err := r.similaritySearch(ctx, queryEmbedding, f)
+			mu.Lock()
+			plan.merge(shardPlan)
+			mu.Unlock()
+			return results, err
+		})
+		if err == nil && dbLogger != nil {
+			dbLogger.Debugf("Fan-out vector search: %d shards, %d queried, %d pruned, %d results",
+				stats.Shards, stats.Queried, stats.Pruned, len(results))
+		}
+		return results, plan, err
+	}
+	return r.similaritySearch(ctx, queryEmbedding, filters)
+}
+
+// similaritySearch runs one filtered similarity query.
+//
+// Index scans run in a read-only transaction with hnsw.ef_search set for the
+// query (SET LOCAL) from the limit, the estimated filter selectivity and the
+// recall target. When fewer than limit rows survive the filters the query is
+// retried with a wider ef_search (see EfSearchPolicy.widen).
+//
+// With filters.Rescore > 1 the index scan runs on the half-precision index
+// and over-fetches limit × Rescore candidates, which are then rescored
+// in-process by exact cosine similarity against their full-precision
+// embeddings (see rescoreCandidates).
+func (r *VectorRepository) similaritySearch(ctx context.Context, queryEmbedding []float32, filters VectorSearchFilters) ([]*VectorSearchResult, *SearchPlan, error) {
 	// 判断是否需要 JOIN symbols/files：任一符号/文件维度过滤非空，或显式请求详情。
-	needJoin := len(filters.Kind) > 0 || filters.Language != "" || len(filters.RepoIDs) > 0 || filters.WithDetails
+	needJoin := len(filters.Kind) > 0 || filters.Language != "" || len(filters.RepoIDs) > 0 || len(filters.FileIDs) > 0 || filters.WithDetails
+	// 两阶段检索：半精度索引过取候选，进程内按全精度向量精排
+	rescore := filters.Rescore > 1 && filters.Limit > 0 && len(filters.FileIDs) == 0
+	fetch := filters.Limit
+	if rescore {
+		fetch = filters.Limit * min(filters.Rescore, MaxRescoreFactor)
+	}
 
 	args := []interface{}{formatVectorForPgvector(queryEmbedding)}
 	argIndex := 2
@@ -386,6 +471,11 @@ func (r *VectorRepository) SimilaritySearchWithFilters(ctx context.Context, quer
 	}
 
 	// SELECT 子句：JOIN 时附带符号/文件详情，消除调用方 N+1 查询。
+	// 精排时相似度在进程内计算，SQL 只返回二进制格式的全精度向量。
+	similarityColumn := "1 - (v.embedding <=> $1::vector)"
+	if rescore {
+		similarityColumn = "0::float8"
+	}
 	selectClause := `
 		SELECT
 			v.vector_id,
@@ -394,7 +484,7 @@ func (r *VectorRepository) SimilaritySearchWithFilters(ctx context.Context, quer
 			v.content,
 			v.model,
 			v.chunk_index,
-			1 - (v.embedding <=> $1::vector) as similarity`
+			` + similarityColumn + ` as similarity`
 	if needJoin {
 		selectClause += `,
 			s.name,
@@ -405,6 +495,10 @@ func (r *VectorRepository) SimilaritySearchWithFilters(ctx context.Context, quer
 			f.language,
 			f.repo_id`
 	}
+	if rescore {
+		selectClause += `,
+			vector_send(v.embedding) as embedding`
+	}
 
 	// FROM + JOIN
 	fromClause := "\n\t\t\tFROM vectors v"
@@ -427,9 +521,6 @@ func (r *VectorRepository) SimilaritySearchWithFilters(ctx context.Context, quer
 	if filters.Model != "" {
 		whereClause += fmt.Sprintf(" AND v.model = %s", addArg(filters.Model))
 	}
-	if filters.MinSimilarity > 0 {
-		whereClause += fmt.Sprintf(" AND (1 - (v.embedding <=> $1::vector)) >= %s", addArg(filters.MinSimilarity))
-	}
 	// kind/language/repo 过滤（JOIN 列）。过滤时要求 JOIN 命中（非 NULL）。
 	if len(filters.Kind) > 0 {
 		whereClause += fmt.Sprintf(" AND s.kind = ANY(%s)", addArg(pq.Array(filters.Kind)))
@@ -440,43 +531,131 @@ func (r *VectorRepository) SimilaritySearchWithFilters(ctx context.Context, quer
 	if len(filters.RepoIDs) > 0 {
 		whereClause += fmt.Sprintf(" AND f.repo_id = ANY(%s)", addArg(pq.Array(filters.RepoIDs)))
 	}
+	if len(filters.FileIDs) > 0 {
+		whereClause += fmt.Sprintf(" AND s.file_id = ANY(%s)", addArg(pq.Array(filters.FileIDs)))
+	}
+	// 估算选择率只用上面的行过滤；$1 在估算语句中按 text 引用，不解析向量
+	filterClause := fromClause + whereClause + " AND $1::text IS NOT NULL"
+	filterArgs := args
+	if filters.MinSimilarity > 0 {
+		whereClause += fmt.Sprintf(" AND (1 - (v.embedding <=> $1::vector)) >= %s", addArg(filters.MinSimilarity))
+	}
 
 	// ORDER BY + LIMIT（过滤在 LIMIT 前应用，保证返回数满 limit）
 	orderBy := "\n\t\t\tORDER BY v.embedding <=> $1::vector"
+	if len(filters.FileIDs) > 0 {
+		// 候选文件已限定：按表达式排序绕开 HNSW，对候选符号精确计算距离，
+		// 避免索引扫描的 ef_search 窗口被候选集外的行占满而返回不足 limit。
+		orderBy = "\n\t\t\tORDER BY similarity DESC"
+	} else if rescore {
+		orderBy = approxOrderBy
+	}
 	limitClause := ""
 	if filters.Limit > 0 {
-		limitClause = fmt.Sprintf("\n\t\t\tLIMIT %s", addArg(filters.Limit))
+		limitClause = fmt.Sprintf("\n\t\t\tLIMIT %s", addArg(fetch))
 	}
 
 	query := selectClause + fromClause + whereClause + orderBy + limitClause
+	plan := newSearchPlan(filters)
+
+	// 不走 HNSW（候选文件精排或无 limit）时 ef_search 无意义
+	if len(filters.FileIDs) > 0 || filters.Limit <= 0 {
+		plan.Exact = true
+		plan.Attempts = 1
+		rows, err := r.db.QueryContext(ctx, query, args...)
+		if err != nil {
+			return nil, nil, err
+		}
+		results, _, err := scanSimilarityRows(rows, needJoin, false)
+		return results, plan, err
+	}
 
-	rows, err := r.db.QueryContext(ctx, query, args...)
+	if hasRowFilters(filters) {
+		rows, selectivity, err := estimateSelectivity(ctx, r.db, filterClause, filterArgs)
+		if err != nil {
+			// 估算失败不影响检索：按无过滤处理，不足时再放宽
+			if dbLogger != nil {
+				dbLogger.Debugf("Vector search selectivity estimate failed: %v", err)
+			}
+		} else {
+			plan.EstimatedRows, plan.Selectivity = rows, selectivity
+		}
+	}
+
+	tx, err := r.db.DB.BeginTx(ctx, &sql.TxOptions{ReadOnly: true})
 	if err != nil {
-		return nil, err
+		return nil, nil, err
+	}
+	defer tx.Rollback()
+
+	var results []*VectorSearchResult
+	var embeddings [][]byte
+	ef := r.efSearch.initial(fetch, plan.Selectivity, plan.Recall)
+	for {
+		if _, err := tx.ExecContext(ctx, fmt.Sprintf("SET LOCAL hnsw.ef_search = %d", ef)); err != nil {
+			return nil, nil, fmt.Errorf("failed to set ef_search: %w", err)
+		}
+		start := time.Now()
+		rows, err := tx.QueryContext(ctx, query, args...)
+		r.db.observe(query, args, time.Since(start), err)
+		if err != nil {
+			return nil, nil, err
+		}
+		results, embeddings, err = scanSimilarityRows(rows, needJoin, rescore)
+		if err != nil {
+			return nil, nil, err
+		}
+		plan.EfSearch = ef
+		plan.Attempts++
+
+		next, retry := r.efSearch.widen(ef, plan.Attempts, len(results), filters.Limit, plan.EstimatedRows)
+		if !retry {
+			break
+		}
+		ef = next
+	}
+	if rescore {
+		plan.Rescored = len(results)
+		results, err = rescoreCandidates(results, embeddings, queryEmbedding, filters.Limit)
+		if err != nil {
+			return nil, nil, err
+		}
 	}
+	return results, plan, nil
+}
+
+// scanSimilarityRows reads similarity query rows; details are scanned when
+// the query joined symbols/files, and the trailing binary embedding of each
+// row when withEmbedding is set
+func scanSimilarityRows(rows *sql.Rows, needJoin, withEmbedding bool) ([]*VectorSearchResult, [][]byte, error) {
 	defer rows.Close()
 
 	var results []*VectorSearchResult
+	var embeddings [][]byte
 	for rows.Next() {
 		var result VectorSearchResult
-		var err error
+		dest := []interface{}{
+			&result.VectorID, &result.EntityID, &result.EntityType,
+			&result.Content, &result.Model, &result.ChunkIndex, &result.Similarity,
+		}
 		if needJoin {
-			err = rows.Scan(
-				&result.VectorID, &result.EntityID, &result.EntityType,
-				&result.Content, &result.Model, &result.ChunkIndex, &result.Similarity,
+			dest = append(dest,
 				&result.Name, &result.Kind, &result.Signature, &result.Docstring,
 				&result.FilePath, &result.Language, &result.RepoID)
-		} else {
-			err = rows.Scan(
-				&result.VectorID, &result.EntityID, &result.EntityType,
-				&result.Content, &result.Model, &result.ChunkIndex, &result.Similarity)
 		}
-		if err != nil {
-			return nil, err
+		var embedding []byte
+		if withEmbedding {
+			dest = append(dest, &embedding)
+		}
+		if err := rows.Scan(dest...); err != nil {
+			return nil, nil, err
 		}
 		results = append(results, &result)
+		if withEmbedding {
+			embeddings = append(embeddings, embedding)
+		}
 	}
-	return results, rows.Err()
+	return results, embeddings, rows.Err()
 }
 
 // KeywordSearch 基于全文检索（content_tsv）的关键词召回。
@@ -592,6 +771,13 @@ type HybridSearchResult struct {
 //
 // 若 query 为空则只走向量召回；若 embedding 为空则只走关键词召回。
 func (r *VectorRepository) HybridSearch(ctx context.Context, query string, queryEmbedding []float32, filters VectorSearchFilters, weightVector, weightKeyword float64) ([]*HybridSearchResult, error) {
+	results, _, err := r.HybridSearchWithPlan(ctx, query, queryEmbedding, filters, weightVector, weightKeyword)
+	return results, err
+}
+
+// HybridSearchWithPlan 同 HybridSearch，并返回向量召回的执行计划
+// （未走向量召回时为 nil）。
+func (r *VectorRepository) HybridSearchWithPlan(ctx context.Context, query string, queryEmbedding []float32, filters VectorSearchFilters, weightVector, weightKeyword float64) ([]*HybridSearchResult, *SearchPlan, error) {
 	// 归一化权重
 	total := weightVector + weightKeyword
 	if total <= 0 {
@@ -610,13 +796,15 @@ func (r *VectorRepository) HybridSearch(ctx context.Context, query string, query
 	recallFilters.Limit = recallLimit
 
 	merge := make(map[string]*HybridSearchResult)
+	var plan *SearchPlan
 
 	// 向量召回
 	if len(queryEmbedding) > 0 {
-		vecResults, err := r.SimilaritySearchWithFilters(ctx, queryEmbedding, recallFilters)
+		vecResults, vecPlan, err := r.SimilaritySearchWithPlan(ctx, queryEmbedding, recallFilters)
 		if err != nil {
-			return nil, fmt.Errorf("vector recall failed: %w", err)
+			return nil, nil, fmt.Errorf("vector recall failed: %w", err)
 		}
+		plan = vecPlan
 		vecMax := 0.0
 		for _, v := range vecResults {
 			if v.Similarity > vecMax {
@@ -638,7 +826,7 @@ func (r *VectorRepository) HybridSearch(ctx context.Context, query string, query
 	if query != "" {
 		kwResults, err := r.KeywordSearch(ctx, query, recallFilters)
 		if err != nil {
-			return nil, fmt.Errorf("keyword recall failed: %w", err)
+			return nil, nil, fmt.Errorf("keyword recall failed: %w", err)
 		}
 		kwMax := 0.0
 		for _, k := range kwResults {
@@ -662,7 +850,7 @@ func (r *VectorRepository) HybridSearch(ctx context.Context, query string, query
 		}
 	}
 
-	return fuseHybridResults(merge, weightVector, weightKeyword, filters.Limit), nil
+	return fuseHybridResults(merge, weightVector, weightKeyword, filters.Limit), plan, nil
 }
 
 // fuseHybridResults 是 HybridSearch 的纯函数核心：对每路已归一化的分数
@@ -804,4 +992,17 @@ type VectorSearchFilters struct {
 	// 传入 kind/language/repo 任一即隐含 WithDetails=true。
 	// 显式设为 true 可在不过滤时也消除调用方的 N+1 查询。
 	WithDetails bool `json:"with_details,omitempty"`
+
+	// CoarseFiles > 0 开启粗到细检索：先在 coarse_vectors 中取最相近的
+	// CoarseFiles 个文件，再只在这些文件的符号中精排（仅向量召回生效）。
+	CoarseFiles int `json:"coarse_files,omitempty"`
+	// FileIDs 把符号级检索限定在这些文件内（粗筛结果，也可直接指定）。
+	FileIDs []string `json:"file_ids,omitempty"`
+
+	// Recall 是召回目标（fast/balanced/high，默认 balanced），
+	// 与 limit、过滤选择率一起决定 HNSW 的 ef_search。
+	Recall string `json:"recall,omitempty"`
+	// Rescore > 1 开启两阶段检索：在半精度索引上过取 limit × Rescore 个候选，
+	// 再按全精度向量精确重排（上限 MaxRescoreFactor）。FileIDs 非空时已是精确计算，不生效。
+	Rescore int `json:"rescore,omitempty"`
 }
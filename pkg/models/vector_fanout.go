@@ -0,0 +1,201 @@
+package models
+
+import (
+	"container/heap"
+	"context"
+	"sort"
+	"sync"
+	"time"
+)
+
+// maxCosineSimilarity is the upper bound of 1 - cosine distance
+const maxCosineSimilarity = 1.0
+
+// FanOutConfig controls per-repository fan-out of multi-repo vector search.
+//
+// With RepoIDs spanning several repositories, a single query filtered by
+// repo_id = ANY(...) is post-filtered after the HNSW scan: small repositories
+// lose their candidates to large ones and the result runs short. Fanning out
+// runs one top-K query per repository, each of which uses the index on a
+// narrow filter, and merges the per-shard results.
+type FanOutConfig struct {
+	// MinRepos is the number of repositories from which fan-out is used
+	// (0 disables fan-out)
+	MinRepos int
+	// Concurrency caps the shard queries in flight per search
+	Concurrency int
+	// ShardTimeout bounds each shard query (0 = only the request deadline)
+	ShardTimeout time.Duration
+}
+
+// DefaultFanOutConfig returns the default fan-out configuration
+func DefaultFanOutConfig() FanOutConfig {
+	return FanOutConfig{
+		MinRepos:    2,
+		Concurrency: 4,
+	}
+}
+
+// FanOutStats reports how a fan-out search was executed
+type FanOutStats struct {
+	Shards  int // shards in the request
+	Queried int // shards actually queried
+	Pruned  int // shards skipped because they could not beat the K-th score
+}
+
+// shardQuery runs one single-repository search
+type shardQuery func(ctx context.Context, filters VectorSearchFilters) ([]*VectorSearchResult, error)
+
+// fanOutSearch runs query once per repository in filters.RepoIDs with at most
+// cfg.Concurrency queries in flight and merges the results with a bounded
+// min-heap into the global top-K (K = filters.Limit; 0 keeps everything).
+//
+// Early termination: once K results are held, the K-th score is pushed down as
+// MinSimilarity to every shard launched afterwards, so those shards only return
+// rows that can still enter the top-K. When the K-th score reaches the
+// similarity ceiling no remaining shard can improve the result and they are
+// skipped.
+//
+// The first shard error or the request deadline cancels outstanding shard
+// queries and is returned; no partial result is reported as complete.
+func fanOutSearch(ctx context.Context, filters VectorSearchFilters, cfg FanOutConfig, query shardQuery) ([]*VectorSearchResult, FanOutStats, error) {
+	stats := FanOutStats{Shards: len(filters.RepoIDs)}
+	concurrency := cfg.Concurrency
+	if concurrency <= 0 {
+		concurrency = 1
+	}
+
+	ctx, cancel := context.WithCancel(ctx)
+	defer cancel()
+
+	top := &resultHeap{limit: filters.Limit}
+	var (
+		mu       sync.Mutex
+		firstErr error
+		wg       sync.WaitGroup
+	)
+	sem := make(chan struct{}, concurrency)
+	aborted := false
+
+	for _, repoID := range filters.RepoIDs {
+		// 等待并发名额，同时响应取消 / 截止时间
+		select {
+		case sem <- struct{}{}:
+		case <-ctx.Done():
+		}
+		if ctx.Err() != nil {
+			aborted = true
+			break
+		}
+
+		mu.Lock()
+		floor, full := top.floor()
+		mu.Unlock()
+		if full && floor >= maxCosineSimilarity {
+			<-sem
+			stats.Pruned++
+			continue
+		}
+
+		shard := filters
+		shard.RepoIDs = []string{repoID}
+		if full && floor > shard.MinSimilarity {
+			shard.MinSimilarity = floor
+		}
+		stats.Queried++
+
+		wg.Add(1)
+		go func(shard VectorSearchFilters) {
+			defer wg.Done()
+			defer func() { <-sem }()
+
+			shardCtx := ctx
+			if cfg.ShardTimeout > 0 {
+				var shardCancel context.CancelFunc
+				shardCtx, shardCancel = context.WithTimeout(ctx, cfg.ShardTimeout)
+				defer shardCancel()
+			}
+
+			results, err := query(shardCtx, shard)
+
+			mu.Lock()
+			defer mu.Unlock()
+			if err != nil {
+				if firstErr == nil {
+					firstErr = err
+					cancel()
+				}
+				return
+			}
+			for _, r := range results {
+				top.offer(r)
+			}
+		}(shard)
+	}
+	wg.Wait()
+
+	if firstErr != nil {
+		return nil, stats, firstErr
+	}
+	if aborted {
+		return nil, stats, ctx.Err()
+	}
+	return top.sorted(), stats, nil
+}
+
+// resultHeap is a min-heap on Similarity holding the best `limit` results
+type resultHeap struct {
+	items []*VectorSearchResult
+	limit int
+}
+
+func (h *resultHeap) Len() int { return len(h.items) }
+func (h *resultHeap) Less(i, j int) bool {
+	if h.items[i].Similarity != h.items[j].Similarity {
+		return h.items[i].Similarity < h.items[j].Similarity
+	}
+	// 同分时让 VectorID 较大的先出堆，保证结果与分片完成顺序无关
+	return h.items[i].VectorID > h.items[j].VectorID
+}
+func (h *resultHeap) Swap(i, j int)      { h.items[i], h.items[j] = h.items[j], h.items[i] }
+func (h *resultHeap) Push(x interface{}) { h.items = append(h.items, x.(*VectorSearchResult)) }
+func (h *resultHeap) Pop() interface{} {
+	old := h.items
+	n := len(old)
+	x := old[n-1]
+	h.items = old[:n-1]
+	return x
+}
+
+// offer adds r if it belongs in the current top-K
+func (h *resultHeap) offer(r *VectorSearchResult) {
+	if h.limit <= 0 || len(h.items) < h.limit {
+		heap.Push(h, r)
+		return
+	}
+	worst := h.items[0]
+	if r.Similarity > worst.Similarity || (r.Similarity == worst.Similarity && r.VectorID < worst.VectorID) {
+		h.items[0] = r
+		heap.Fix(h, 0)
+	}
+}
+
+// floor returns the K-th best score and whether K results are held
+func (h *resultHeap) floor() (float64, bool) {
+	if h.limit <= 0 || len(h.items) < h.limit {
+		return 0, false
+	}
+	return h.items[0].Similarity, true
+}
+
+// sorted returns the held results, best first
+func (h *resultHeap) sorted() []*VectorSearchResult {
+	out := append([]*VectorSearchResult(nil), h.items...)
+	sort.Slice(out, func(i, j int) bool {
+		if out[i].Similarity != out[j].Similarity {
+			return out[i].Similarity > out[j].Similarity
+		}
+		return out[i].VectorID < out[j].VectorID
+	})
+	return out
+}
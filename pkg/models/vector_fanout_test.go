@@ -0,0 +1,163 @@
+package models
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"sync"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+// Unit tests for multi-repository fan-out search (no database required)
+
+// fakeShards 按 repo 返回预置结果，并遵守下推的 MinSimilarity 与 Limit
+func fakeShards(data map[string][]float64) (shardQuery, *sync.Map) {
+	seen := &sync.Map{}
+	return func(ctx context.Context, f VectorSearchFilters) ([]*VectorSearchResult, error) {
+		repo := f.RepoIDs[0]
+		seen.Store(repo, f)
+		var out []*VectorSearchResult
+		for i, score := range data[repo] {
+			if score < f.MinSimilarity {
+				continue
+			}
+			out = append(out, &VectorSearchResult{VectorID: fmt.Sprintf("%s-%d", repo, i), RepoID: repo, Similarity: score})
+			if f.Limit > 0 && len(out) == f.Limit {
+				break
+			}
+		}
+		return out, nil
+	}, seen
+}
+
+func TestFanOutSearch_MergesTopK(t *testing.T) {
+	query, _ := fakeShards(map[string][]float64{
+		"big":   {0.95, 0.90, 0.85, 0.80},
+		"small": {0.92},
+		"other": {0.70, 0.60},
+	})
+	filters := VectorSearchFilters{RepoIDs: []string{"big", "small", "other"}, Limit: 3}
+
+	results, stats, err := fanOutSearch(context.Background(), filters, DefaultFanOutConfig(), query)
+	if err != nil {
+		t.Fatalf("fanOutSearch failed: %v", err)
+	}
+	want := []string{"big-0", "small-0", "big-1"}
+	if len(results) != len(want) {
+		t.Fatalf("Expected %d results, got %d", len(want), len(results))
+	}
+	for i, id := range want {
+		if results[i].VectorID != id {
+			t.Errorf("results[%d] = %s, want %s", i, results[i].VectorID, id)
+		}
+	}
+	if stats.Shards != 3 || stats.Queried != 3 {
+		t.Errorf("Unexpected stats: %+v", stats)
+	}
+}
+
+func TestFanOutSearch_PushesDownKthScore(t *testing.T) {
+	query, seen := fakeShards(map[string][]float64{
+		"a": {0.9, 0.8},
+		"b": {0.5},
+	})
+	cfg := DefaultFanOutConfig()
+	cfg.Concurrency = 1 // 串行，保证 a 完成后再发起 b
+	filters := VectorSearchFilters{RepoIDs: []string{"a", "b"}, Limit: 2}
+
+	results, _, err := fanOutSearch(context.Background(), filters, cfg, query)
+	if err != nil {
+		t.Fatalf("fanOutSearch failed: %v", err)
+	}
+	if len(results) != 2 || results[1].Similarity != 0.8 {
+		t.Errorf("Unexpected results: %+v", results)
+	}
+	f, _ := seen.Load("b")
+	if got := f.(VectorSearchFilters).MinSimilarity; got != 0.8 {
+		t.Errorf("Expected K-th score 0.8 pushed down to later shard, got %v", got)
+	}
+}
+
+func TestFanOutSearch_PrunesWhenNothingCanBeatFloor(t *testing.T) {
+	query, seen := fakeShards(map[string][]float64{
+		"exact": {1.0},
+		"rest":  {0.9},
+	})
+	cfg := DefaultFanOutConfig()
+	cfg.Concurrency = 1
+	filters := VectorSearchFilters{RepoIDs: []string{"exact", "rest"}, Limit: 1}
+
+	results, stats, err := fanOutSearch(context.Background(), filters, cfg, query)
+	if err != nil {
+		t.Fatalf("fanOutSearch failed: %v", err)
+	}
+	if len(results) != 1 || results[0].VectorID != "exact-0" {
+		t.Errorf("Unexpected results: %+v", results)
+	}
+	if stats.Pruned != 1 {
+		t.Errorf("Expected 1 pruned shard, got %+v", stats)
+	}
+	if _, ok := seen.Load("rest"); ok {
+		t.Error("Pruned shard should not be queried")
+	}
+}
+
+func TestFanOutSearch_LimitsConcurrency(t *testing.T) {
+	var inFlight, peak int32
+	query := func(ctx context.Context, f VectorSearchFilters) ([]*VectorSearchResult, error) {
+		n := atomic.AddInt32(&inFlight, 1)
+		for {
+			p := atomic.LoadInt32(&peak)
+			if n <= p || atomic.CompareAndSwapInt32(&peak, p, n) {
+				break
+			}
+		}
+		time.Sleep(5 * time.Millisecond)
+		atomic.AddInt32(&inFlight, -1)
+		return nil, nil
+	}
+	cfg := DefaultFanOutConfig()
+	cfg.Concurrency = 2
+	filters := VectorSearchFilters{RepoIDs: []string{"a", "b", "c", "d", "e", "f"}}
+
+	if _, _, err := fanOutSearch(context.Background(), filters, cfg, query); err != nil {
+		t.Fatalf("fanOutSearch failed: %v", err)
+	}
+	if peak > 2 {
+		t.Errorf("Expected at most 2 shard queries in flight, saw %d", peak)
+	}
+}
+
+func TestFanOutSearch_ErrorsAndDeadlines(t *testing.T) {
+	boom := errors.New("boom")
+	failing := func(ctx context.Context, f VectorSearchFilters) ([]*VectorSearchResult, error) {
+		if f.RepoIDs[0] == "bad" {
+			return nil, boom
+		}
+		<-ctx.Done()
+		return nil, ctx.Err()
+	}
+	filters := VectorSearchFilters{RepoIDs: []string{"slow", "bad"}, Limit: 5}
+	if _, _, err := fanOutSearch(context.Background(), filters, DefaultFanOutConfig(), failing); !errors.Is(err, boom) {
+		t.Errorf("Expected shard error to be returned, got %v", err)
+	}
+
+	blocking := func(ctx context.Context, f VectorSearchFilters) ([]*VectorSearchResult, error) {
+		<-ctx.Done()
+		return nil, ctx.Err()
+	}
+	ctx, cancel := context.WithTimeout(context.Background(), 20*time.Millisecond)
+	defer cancel()
+	cfg := DefaultFanOutConfig()
+	cfg.Concurrency = 1
+	filters = VectorSearchFilters{RepoIDs: []string{"a", "b", "c"}, Limit: 5}
+	start := time.Now()
+	if _, _, err := fanOutSearch(ctx, filters, cfg, blocking); !errors.Is(err, context.DeadlineExceeded) {
+		t.Errorf("Expected deadline error, got %v", err)
+	}
+	if time.Since(start) > time.Second {
+		t.Error("Deadline was not honoured")
+	}
+}
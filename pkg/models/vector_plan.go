@@ -0,0 +1,197 @@
+package models
+
+import (
+	"context"
+	"encoding/json"
+	"fmt"
+	"math"
+)
+
+// Recall targets of a vector search, trading latency for recall
+const (
+	RecallFast     = "fast"
+	RecallBalanced = "balanced"
+	RecallHigh     = "high"
+)
+
+// recallFactors is the HNSW candidate list size per requested result
+var recallFactors = map[string]float64{
+	RecallFast:     1,
+	RecallBalanced: 2,
+	RecallHigh:     4,
+}
+
+// minSelectivity bounds the ef_search boost of very selective filters; below
+// it the search is capped by EfSearchPolicy.Max anyway
+const minSelectivity = 0.001
+
+// EfSearchPolicy chooses hnsw.ef_search per query.
+//
+// HNSW returns at most ef_search candidates and pgvector applies WHERE filters
+// after the index scan, so a query keeping 5% of the rows needs roughly 20×
+// the candidates of an unfiltered one to fill K results, while a small-K
+// unfiltered query needs far fewer than the server default of 40.
+type EfSearchPolicy struct {
+	// Min is the ef_search of a balanced unfiltered query with a small K;
+	// fast queries use half of it, high-recall queries twice
+	Min int
+	// Max caps ef_search (pgvector accepts at most 1000)
+	Max int
+	// MaxAttempts bounds the queries run when too few results survive the
+	// filters; each retry multiplies ef_search by Growth
+	MaxAttempts int
+	Growth      int
+}
+
+// DefaultEfSearchPolicy returns the default ef_search policy
+func DefaultEfSearchPolicy() EfSearchPolicy {
+	return EfSearchPolicy{
+		Min:         40,
+		Max:         1000,
+		MaxAttempts: 3,
+		Growth:      4,
+	}
+}
+
+// SearchPlan reports how a similarity search was executed
+type SearchPlan struct {
+	// EfSearch is the hnsw.ef_search of the final attempt (0 when the index
+	// was not used)
+	EfSearch int `json:"ef_search,omitempty"`
+	// Attempts is the number of queries run, > 1 when ef_search was widened
+	Attempts int    `json:"attempts"`
+	Recall   string `json:"recall"`
+	// Selectivity is the planner's estimate of the fraction of vectors that
+	// pass the filters; EstimatedRows the matching row count (-1 if unknown)
+	Selectivity   float64 `json:"selectivity"`
+	EstimatedRows int64   `json:"estimated_rows"`
+	// Exact is set when candidates were ranked by exact distance instead of
+	// the HNSW index (candidate files given, or no limit)
+	Exact bool `json:"exact,omitempty"`
+	// Shards is the number of per-repository queries of a fan-out search
+	Shards int `json:"shards,omitempty"`
+	// Rescored is the number of candidates rescored by exact similarity
+	Rescored int `json:"rescored,omitempty"`
+}
+
+func newSearchPlan(filters VectorSearchFilters) *SearchPlan {
+	return &SearchPlan{Recall: recallTarget(filters.Recall), Selectivity: 1, EstimatedRows: -1}
+}
+
+// merge folds a shard's plan into a fan-out plan
+func (p *SearchPlan) merge(shard *SearchPlan) {
+	if shard == nil {
+		return
+	}
+	p.Shards++
+	p.Attempts += shard.Attempts
+	if shard.EfSearch > p.EfSearch {
+		p.EfSearch = shard.EfSearch
+	}
+	if p.Shards == 1 || shard.Selectivity < p.Selectivity {
+		p.Selectivity = shard.Selectivity
+	}
+	if shard.EstimatedRows >= 0 {
+		if p.EstimatedRows < 0 {
+			p.EstimatedRows = 0
+		}
+		p.EstimatedRows += shard.EstimatedRows
+	}
+	p.Exact = p.Exact || shard.Exact
+	p.Rescored += shard.Rescored
+}
+
+// recallTarget normalizes a requested recall target, defaulting to balanced
+func recallTarget(recall string) string {
+	if _, ok := recallFactors[recall]; ok {
+		return recall
+	}
+	return RecallBalanced
+}
+
+// initial returns the first ef_search for k results at the given filter
+// selectivity and recall target
+func (p EfSearchPolicy) initial(k int, selectivity float64, recall string) int {
+	factor := recallFactors[recallTarget(recall)]
+	if selectivity < minSelectivity {
+		selectivity = minSelectivity
+	}
+	if selectivity > 1 {
+		selectivity = 1
+	}
+	ef := math.Max(float64(k)*factor, float64(p.Min)*factor/2) / selectivity
+	return p.clamp(int(math.Ceil(ef)))
+}
+
+// widen returns the ef_search of the next attempt and whether one should run:
+// only when fewer than k results came back, ef_search can still grow, the
+// attempt budget is not spent and more rows are estimated to match than were
+// returned
+func (p EfSearchPolicy) widen(ef, attempts, got, k int, estimatedRows int64) (int, bool) {
+	if got >= k || ef >= p.Max || attempts >= p.MaxAttempts {
+		return ef, false
+	}
+	if estimatedRows >= 0 && int64(got) >= estimatedRows {
+		return ef, false
+	}
+	growth := p.Growth
+	if growth < 2 {
+		growth = 2
+	}
+	return p.clamp(ef * growth), true
+}
+
+func (p EfSearchPolicy) clamp(ef int) int {
+	if p.Max > 0 && ef > p.Max {
+		ef = p.Max
+	}
+	if ef < 1 {
+		ef = 1
+	}
+	return ef
+}
+
+// hasRowFilters reports whether filters narrow the vectors beyond the entity
+// type, i.e. whether estimating their selectivity is worth a round trip
+func hasRowFilters(filters VectorSearchFilters) bool {
+	return len(filters.Kind) > 0 || filters.Language != "" || len(filters.RepoIDs) > 0 || filters.Model != ""
+}
+
+// estimateSelectivity asks the planner how many vectors pass the filter
+// clause (a FROM ... WHERE fragment over vectors v) without running it, and
+// divides by the table's row estimate
+func estimateSelectivity(ctx context.Context, db *DB, filterClause string, args []interface{}) (int64, float64, error) {
+	var total float64
+	if err := db.QueryRowContext(ctx, `SELECT GREATEST(reltuples, 0) FROM pg_class WHERE oid = 'vectors'::regclass`).Scan(&total); err != nil {
+		return -1, 1, err
+	}
+	var raw []byte
+	if err := db.QueryRowContext(ctx, "EXPLAIN (FORMAT JSON) SELECT 1"+filterClause, args...).Scan(&raw); err != nil {
+		return -1, 1, err
+	}
+	rows, err := explainRows(raw)
+	if err != nil {
+		return -1, 1, err
+	}
+	if total <= 0 {
+		// 表从未 ANALYZE：只有匹配行数可用
+		return rows, 1, nil
+	}
+	return rows, math.Min(float64(rows)/total, 1), nil
+}
+
+// explainRows extracts the top-level row estimate of EXPLAIN (FORMAT JSON)
+func explainRows(raw []byte) (int64, error) {
+	var plans []struct {
+		Plan struct {
+			Rows float64 `json:"Plan Rows"`
+		} `json:"Plan"`
+	}
+	if err := json.Unmarshal(raw, &plans); err != nil {
+		return -1, fmt.Errorf("failed to parse plan: %w", err)
+	}
+	if len(plans) == 0 {
+		return -1, fmt.Errorf("empty plan")
+	}
+	return int64(plans[0].Plan.Rows), nil
+}
@@ -0,0 +1,85 @@
+package models
+
+import "testing"
+
+func TestEfSearchPolicy_Initial(t *testing.T) {
+	p := DefaultEfSearchPolicy()
+	tests := []struct {
+		name        string
+		k           int
+		selectivity float64
+		recall      string
+		want        int
+	}{
+		{"small k unfiltered", 10, 1, RecallBalanced, 40},
+		{"small k fast", 5, 1, RecallFast, 20},
+		{"large k", 100, 1, RecallBalanced, 200},
+		{"high recall", 10, 1, RecallHigh, 80},
+		{"unknown recall is balanced", 10, 1, "best", 40},
+		{"selective filter", 10, 0.05, RecallBalanced, 800},
+		{"capped", 50, 0.01, RecallHigh, 1000},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			if got := p.initial(tt.k, tt.selectivity, tt.recall); got != tt.want {
+				t.Errorf("initial(%d, %v, %q) = %d, want %d", tt.k, tt.selectivity, tt.recall, got, tt.want)
+			}
+		})
+	}
+}
+
+func TestEfSearchPolicy_Widen(t *testing.T) {
+	p := DefaultEfSearchPolicy()
+	tests := []struct {
+		name          string
+		ef, attempts  int
+		got, k        int
+		estimatedRows int64
+		want          int
+		retry         bool
+	}{
+		{"enough results", 40, 1, 10, 10, -1, 40, false},
+		{"too few results", 40, 1, 3, 10, -1, 160, true},
+		{"clamped to max", 400, 2, 3, 10, -1, 1000, true},
+		{"at max", 1000, 1, 3, 10, -1, 1000, false},
+		{"attempts spent", 160, 3, 3, 10, -1, 160, false},
+		{"all matching rows returned", 40, 1, 3, 10, 3, 40, false},
+		{"more rows match", 40, 1, 3, 10, 500, 160, true},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			got, retry := p.widen(tt.ef, tt.attempts, tt.got, tt.k, tt.estimatedRows)
+			if got != tt.want || retry != tt.retry {
+				t.Errorf("widen() = (%d, %v), want (%d, %v)", got, retry, tt.want, tt.retry)
+			}
+		})
+	}
+}
+
+func TestExplainRows(t *testing.T) {
+	raw := []byte(`[{"Plan": {"Node Type": "Hash Join", "Plan Rows": 1234, "Plans": [{"Plan Rows": 99999}]}}]`)
+	rows, err := explainRows(raw)
+	if err != nil || rows != 1234 {
+		t.Errorf("explainRows() = (%d, %v), want 1234", rows, err)
+	}
+	if _, err := explainRows([]byte(`[]`)); err == nil {
+		t.Error("expected error for empty plan")
+	}
+	if _, err := explainRows([]byte(`not json`)); err == nil {
+		t.Error("expected error for invalid plan")
+	}
+}
+
+func TestSearchPlan_Merge(t *testing.T) {
+	plan := newSearchPlan(VectorSearchFilters{Recall: RecallHigh})
+	plan.merge(&SearchPlan{EfSearch: 80, Attempts: 1, Selectivity: 0.5, EstimatedRows: 100})
+	plan.merge(&SearchPlan{EfSearch: 320, Attempts: 2, Selectivity: 0.2, EstimatedRows: -1})
+	plan.merge(nil)
+
+	if plan.Recall != RecallHigh || plan.Shards != 2 || plan.Attempts != 3 || plan.EfSearch != 320 {
+		t.Errorf("unexpected merged plan: %+v", plan)
+	}
+	if plan.Selectivity != 0.2 || plan.EstimatedRows != 100 {
+		t.Errorf("expected lowest selectivity and summed known rows, got %+v", plan)
+	}
+}
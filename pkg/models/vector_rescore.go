@@ -0,0 +1,207 @@
+package models
+
+import (
+	"context"
+	"database/sql"
+	"encoding/binary"
+	"fmt"
+	"math"
+	"sort"
+	"sync/atomic"
+	"time"
+)
+
+// VectorDimensions is the dimension of vectors.embedding (vector(1024)); the
+// half-precision index is built on embedding::halfvec(VectorDimensions)
+const VectorDimensions = 1024
+
+// MaxRescoreFactor caps the over-fetch of a rescored search
+const MaxRescoreFactor = 16
+
+// RescoreIndexName is the half-precision HNSW index scanned by the first
+// stage of a rescored search
+const RescoreIndexName = "idx_vectors_embedding_halfvec_hnsw"
+
+// rescoreIndexRetry is how long Ensure waits while the bulk load lock is held
+// by a bulk load or by another replica building the index
+const rescoreIndexRetry = 30 * time.Second
+
+// rescoreIndexDefinition builds RescoreIndexName; its expression must match
+// approxOrderBy for the planner to use it
+var rescoreIndexDefinition = fmt.Sprintf("CREATE INDEX CONCURRENTLY IF NOT EXISTS %s ON vectors USING hnsw ((embedding::halfvec(%d)) halfvec_cosine_ops) WITH (m = 16, ef_construction = 64)", RescoreIndexName, VectorDimensions)
+
+// approxOrderBy orders by half-precision distance, matching the expression of
+// idx_vectors_embedding_halfvec_hnsw
+var approxOrderBy = fmt.Sprintf("\n\t\t\tORDER BY v.embedding::halfvec(%d) <=> $1::halfvec(%d)", VectorDimensions, VectorDimensions)
+
+// decodeVector decodes a vector in pgvector's binary format (vector_send):
+// uint16 dimension, uint16 unused, then dimension big-endian float32
+func decodeVector(raw []byte) ([]float32, error) {
+	if len(raw) < 4 {
+		return nil, fmt.Errorf("vector too short: %d bytes", len(raw))
+	}
+	dim := int(binary.BigEndian.Uint16(raw[0:2]))
+	if len(raw) != 4+4*dim {
+		return nil, fmt.Errorf("vector of dimension %d has %d bytes", dim, len(raw))
+	}
+	vec := make([]float32, dim)
+	for i := range vec {
+		vec[i] = math.Float32frombits(binary.BigEndian.Uint32(raw[4+4*i:]))
+	}
+	return vec, nil
+}
+
+// cosineSimilarity returns 1 - cosine distance, the similarity reported by
+// pgvector queries; 0 when either vector is zero
+func cosineSimilarity(a, b []float32) float64 {
+	var dot, na, nb float64
+	for i := range a {
+		x, y := float64(a[i]), float64(b[i])
+		dot += x * y
+		na += x * x
+		nb += y * y
+	}
+	if na == 0 || nb == 0 {
+		return 0
+	}
+	return dot / (math.Sqrt(na) * math.Sqrt(nb))
+}
+
+// rescoreCandidates sets the exact cosine similarity of each candidate from
+// its full-precision embedding (embeddings[i] belongs to candidates[i]) and
+// returns the best limit of them
+func rescoreCandidates(candidates []*VectorSearchResult, embeddings [][]byte, query []float32, limit int) ([]*VectorSearchResult, error) {
+	for i, candidate := range candidates {
+		vec, err := decodeVector(embeddings[i])
+		if err != nil {
+			return nil, fmt.Errorf("failed to decode embedding of %s: %w", candidate.VectorID, err)
+		}
+		if len(vec) != len(query) {
+			return nil, fmt.Errorf("embedding of %s has dimension %d, query has %d", candidate.VectorID, len(vec), len(query))
+		}
+		candidate.Similarity = cosineSimilarity(query, vec)
+	}
+	// 稳定排序：相似度相同时保留近似阶段的顺序
+	sort.SliceStable(candidates, func(i, j int) bool {
+		return candidates[i].Similarity > candidates[j].Similarity
+	})
+	if limit > 0 && len(candidates) > limit {
+		candidates = candidates[:limit]
+	}
+	return candidates, nil
+}
+
+// RescoreIndex creates the half-precision index on demand and reports whether
+// rescored searches can use it. It owns the index: no migration creates it.
+//
+// The index is an HNSW graph on embedding::halfvec(VectorDimensions), about
+// half the size of idx_vectors_embedding_hnsw, so it caches better and is
+// faster to traverse; the error of the half-precision first stage is removed
+// by rescoring the candidates with their full-precision vectors. But a second
+// HNSW graph adds its maintenance to every vector write, so the index only
+// exists where rescoring is enabled (DB_VECTOR_RESCORE), and disabling it does
+// not drop an existing index. halfvec needs pgvector 0.7+.
+//
+// Until the index is valid, searches should ignore Rescore: the halfvec ORDER
+// BY would otherwise sort the whole table. A nil RescoreIndex is never ready.
+type RescoreIndex struct {
+	ready atomic.Bool
+}
+
+// Ready reports whether the index has been found valid or built
+func (r *RescoreIndex) Ready() bool {
+	return r != nil && r.ready.Load()
+}
+
+// Ensure makes sure the index exists and is valid, building it with CREATE
+// INDEX CONCURRENTLY so writes to vectors are not blocked. The build holds the
+// bulk load lock, so it never overlaps a bulk load (which rebuilds the indexes
+// of empty tables itself) or the same build on another replica; while the lock
+// is taken Ensure retries until ctx is done. An invalid index left by an
+// interrupted concurrent build is dropped and rebuilt. Returns whether this
+// call built the index.
+func (r *RescoreIndex) Ensure(ctx context.Context, db *DB, config BulkLoadConfig) (bool, error) {
+	for {
+		built, done, err := r.build(ctx, db, config.withDefaults())
+		if err != nil || done {
+			return built, err
+		}
+		if err := sleepContext(ctx, rescoreIndexRetry); err != nil {
+			return false, err
+		}
+	}
+}
+
+// build creates the index unless it is valid already. done is false when the
+// bulk load lock was held elsewhere.
+func (r *RescoreIndex) build(ctx context.Context, db *DB, config BulkLoadConfig) (built, done bool, err error) {
+	conn, err := db.DB.Conn(ctx)
+	if err != nil {
+		return false, false, fmt.Errorf("failed to acquire connection: %w", err)
+	}
+	defer conn.Close()
+
+	valid, exists, err := rescoreIndexState(ctx, conn)
+	if err != nil || valid {
+		r.ready.Store(valid)
+		return false, err == nil, err
+	}
+
+	var locked bool
+	if err := conn.QueryRowContext(ctx, "SELECT pg_try_advisory_lock($1)", bulkLoadLockKey).Scan(&locked); err != nil {
+		return false, false, fmt.Errorf("failed to take bulk load lock: %w", err)
+	}
+	if !locked {
+		return false, false, nil
+	}
+	defer conn.ExecContext(context.Background(), "SELECT pg_advisory_unlock($1)", bulkLoadLockKey)
+
+	// 拿到锁之前其他副本可能已建好
+	if valid, exists, err = rescoreIndexState(ctx, conn); err != nil || valid {
+		r.ready.Store(valid)
+		return false, err == nil, err
+	}
+	if exists {
+		if dbLogger != nil {
+			dbLogger.Warnf("Dropping invalid index %s left by an interrupted build", RescoreIndexName)
+		}
+		if _, err := conn.ExecContext(ctx, "DROP INDEX CONCURRENTLY IF EXISTS "+RescoreIndexName); err != nil {
+			return false, false, fmt.Errorf("failed to drop invalid index %s: %w", RescoreIndexName, err)
+		}
+	}
+
+	// CONCURRENTLY 不能在事务中执行，只能设置会话级参数，连接归还连接池前还原
+	workMem := config.workMemPerSession(1)
+	if _, err := conn.ExecContext(ctx, fmt.Sprintf("SET maintenance_work_mem = '%dMB'", workMem)); err != nil {
+		return false, false, fmt.Errorf("failed to set maintenance_work_mem: %w", err)
+	}
+	defer conn.ExecContext(context.Background(), "RESET maintenance_work_mem")
+	if config.ParallelWorkers > 0 {
+		if _, err := conn.ExecContext(ctx, fmt.Sprintf("SET max_parallel_maintenance_workers = %d", config.ParallelWorkers)); err != nil {
+			return false, false, fmt.Errorf("failed to set max_parallel_maintenance_workers: %w", err)
+		}
+		defer conn.ExecContext(context.Background(), "RESET max_parallel_maintenance_workers")
+	}
+
+	if dbLogger != nil {
+		dbLogger.Infof("Building %s concurrently (maintenance_work_mem %dMB)", RescoreIndexName, workMem)
+	}
+	if _, err := conn.ExecContext(ctx, rescoreIndexDefinition); err != nil {
+		return false, false, fmt.Errorf("failed to create index %s: %w", RescoreIndexName, err)
+	}
+	r.ready.Store(true)
+	return true, true, nil
+}
+
+// rescoreIndexState reports whether the index exists and whether it is valid
+// (an interrupted CREATE INDEX CONCURRENTLY leaves an invalid index behind)
+func rescoreIndexState(ctx context.Context, conn *sql.Conn) (valid, exists bool, err error) {
+	err = conn.QueryRowContext(ctx, `SELECT i.indisvalid FROM pg_index i WHERE i.indexrelid = to_regclass($1)`, RescoreIndexName).Scan(&valid)
+	if err == sql.ErrNoRows {
+		return false, false, nil
+	}
+	if err != nil {
+		return false, false, fmt.Errorf("failed to check index %s: %w", RescoreIndexName, err)
+	}
+	return valid, true, nil
+}
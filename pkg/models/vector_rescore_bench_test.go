@@ -0,0 +1,111 @@
+package models
+
+import (
+	"fmt"
+	"math/rand"
+	"sort"
+	"testing"
+)
+
+// BenchmarkRescore measures the in-process rescoring stage on a synthetic
+// clustered vector set and reports recall@10 against exact search. The
+// approximate stage is simulated by ranking on a 128-dimension prefix of the
+// embeddings, a deliberately lossy stand-in for a cheap index.
+func BenchmarkRescore(b *testing.B) {
+	const (
+		n       = 5000
+		dims    = VectorDimensions
+		queries = 20
+		k       = 10
+	)
+	rng := rand.New(rand.NewSource(1))
+
+	centroids := make([][]float32, 50)
+	for i := range centroids {
+		centroids[i] = randomVector(rng, dims, nil, 0)
+	}
+	ids := make([]string, n)
+	vectors := make([][]float32, n)
+	encoded := make([][]byte, n)
+	reduced := make([][]float32, n)
+	for i := range vectors {
+		ids[i] = fmt.Sprintf("v%d", i)
+		vectors[i] = randomVector(rng, dims, centroids[rng.Intn(len(centroids))], 0.6)
+		encoded[i] = encodeVector(vectors[i])
+		reduced[i] = ReduceEmbedding(vectors[i], 128)
+	}
+
+	type benchQuery struct {
+		embedding []float32
+		truth     map[string]bool
+		approx    []int
+	}
+	qs := make([]benchQuery, queries)
+	for q := range qs {
+		embedding := randomVector(rng, dims, vectors[rng.Intn(n)], 0.3)
+		exact := rankBy(n, func(i int) float64 { return cosineSimilarity(embedding, vectors[i]) })
+		reducedQuery := ReduceEmbedding(embedding, 128)
+		qs[q] = benchQuery{
+			embedding: embedding,
+			truth:     make(map[string]bool, k),
+			approx:    rankBy(n, func(i int) float64 { return cosineSimilarity(reducedQuery, reduced[i]) }),
+		}
+		for _, i := range exact[:k] {
+			qs[q].truth[ids[i]] = true
+		}
+	}
+
+	for _, factor := range []int{1, 2, 4, 8} {
+		b.Run(fmt.Sprintf("Overfetch_%d", factor), func(b *testing.B) {
+			hits := 0
+			b.ResetTimer()
+			for iter := 0; iter < b.N; iter++ {
+				hits = 0
+				for _, q := range qs {
+					fetched := q.approx[:k*factor]
+					candidates := make([]*VectorSearchResult, len(fetched))
+					embeddings := make([][]byte, len(fetched))
+					for c, i := range fetched {
+						candidates[c] = &VectorSearchResult{VectorID: ids[i]}
+						embeddings[c] = encoded[i]
+					}
+					results, err := rescoreCandidates(candidates, embeddings, q.embedding, k)
+					if err != nil {
+						b.Fatal(err)
+					}
+					for _, result := range results {
+						if q.truth[result.VectorID] {
+							hits++
+						}
+					}
+				}
+			}
+			b.ReportMetric(float64(hits)/float64(queries*k), "recall@10")
+		})
+	}
+}
+
+// randomVector returns a Gaussian vector, around center when given
+func randomVector(rng *rand.Rand, dims int, center []float32, noise float64) []float32 {
+	vec := make([]float32, dims)
+	for i := range vec {
+		if center == nil {
+			vec[i] = float32(rng.NormFloat64())
+		} else {
+			vec[i] = center[i] + float32(rng.NormFloat64()*noise)
+		}
+	}
+	return vec
+}
+
+// rankBy returns 0..n-1 ordered by descending score
+func rankBy(n int, score func(int) float64) []int {
+	scores := make([]float64, n)
+	order := make([]int, n)
+	for i := range order {
+		order[i] = i
+		scores[i] = score(i)
+	}
+	sort.Slice(order, func(a, b int) bool { return scores[order[a]] > scores[order[b]] })
+	return order
+}
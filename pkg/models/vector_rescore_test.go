@@ -0,0 +1,86 @@
+package models
+
+import (
+	"encoding/binary"
+	"fmt"
+	"math"
+	"strings"
+	"testing"
+)
+
+// encodeVector encodes vec in pgvector's binary format, as vector_send does
+func encodeVector(vec []float32) []byte {
+	raw := make([]byte, 4+4*len(vec))
+	binary.BigEndian.PutUint16(raw[0:2], uint16(len(vec)))
+	for i, v := range vec {
+		binary.BigEndian.PutUint32(raw[4+4*i:], math.Float32bits(v))
+	}
+	return raw
+}
+
+func TestDecodeVector(t *testing.T) {
+	want := []float32{0.5, -1.25, 3}
+	got, err := decodeVector(encodeVector(want))
+	if err != nil {
+		t.Fatalf("decodeVector failed: %v", err)
+	}
+	if len(got) != len(want) {
+		t.Fatalf("expected %d components, got %d", len(want), len(got))
+	}
+	for i := range want {
+		if got[i] != want[i] {
+			t.Errorf("component %d: expected %v, got %v", i, want[i], got[i])
+		}
+	}
+
+	if _, err := decodeVector([]byte{0, 1}); err == nil {
+		t.Error("expected error for truncated header")
+	}
+	if _, err := decodeVector(encodeVector(want)[:10]); err == nil {
+		t.Error("expected error for truncated components")
+	}
+}
+
+func TestRescoreCandidates(t *testing.T) {
+	query := []float32{1, 0}
+	candidates := []*VectorSearchResult{{VectorID: "far"}, {VectorID: "exact"}, {VectorID: "near"}}
+	embeddings := [][]byte{
+		encodeVector([]float32{0, 1}),
+		encodeVector([]float32{2, 0}),
+		encodeVector([]float32{1, 1}),
+	}
+
+	got, err := rescoreCandidates(candidates, embeddings, query, 2)
+	if err != nil {
+		t.Fatalf("rescoreCandidates failed: %v", err)
+	}
+	if len(got) != 2 || got[0].VectorID != "exact" || got[1].VectorID != "near" {
+		t.Fatalf("unexpected order: %+v", got)
+	}
+	if math.Abs(got[0].Similarity-1) > 1e-9 || math.Abs(got[1].Similarity-math.Sqrt2/2) > 1e-6 {
+		t.Errorf("unexpected similarities %v, %v", got[0].Similarity, got[1].Similarity)
+	}
+
+	if _, err := rescoreCandidates([]*VectorSearchResult{{VectorID: "short"}}, [][]byte{encodeVector([]float32{1})}, query, 1); err == nil {
+		t.Error("expected error for dimension mismatch")
+	}
+}
+
+func TestRescoreIndexDefinition_MatchesOrderBy(t *testing.T) {
+	// 索引表达式与检索 SQL 不一致时规划器不会走索引
+	expr := fmt.Sprintf("embedding::halfvec(%d)", VectorDimensions)
+	if !strings.Contains(approxOrderBy, "v."+expr) {
+		t.Fatalf("approxOrderBy does not order by %s: %q", expr, approxOrderBy)
+	}
+	if !strings.Contains(rescoreIndexDefinition, "(("+expr+") halfvec_cosine_ops)") {
+		t.Errorf("index definition does not index %s: %q", expr, rescoreIndexDefinition)
+	}
+	if !strings.HasPrefix(rescoreIndexDefinition, "CREATE INDEX CONCURRENTLY IF NOT EXISTS "+RescoreIndexName+" ") {
+		t.Errorf("index must be built concurrently: %q", rescoreIndexDefinition)
+	}
+
+	var none *RescoreIndex
+	if none.Ready() || (&RescoreIndex{}).Ready() {
+		t.Error("an index that was never ensured must not be ready")
+	}
+}
@@ -0,0 +1,167 @@
+package integration
+
+import (
+	"context"
+	"errors"
+	"path/filepath"
+	"testing"
+
+	"github.com/google/uuid"
+	"github.com/yourtionguo/CodeAtlas/internal/archive"
+	"github.com/yourtionguo/CodeAtlas/internal/indexer"
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+// TestArchiveExportImport indexes a small repository, exports it and imports
+// the archive into a second, empty database
+func TestArchiveExportImport(t *testing.T) {
+	if testing.Short() {
+		t.Skip("Skipping integration test in short mode")
+	}
+
+	source := SetupTestDB(t)
+	defer source.TeardownTestDB(t)
+	target := SetupTestDB(t)
+	defer target.TeardownTestDB(t)
+
+	ctx := context.Background()
+	repoID := uuid.New().String()
+	fileID := uuid.New().String()
+	mainID := uuid.New().String()
+	helperID := uuid.New().String()
+
+	parseOutput := &schema.ParseOutput{
+		Files: []schema.File{{
+			FileID:   fileID,
+			Path:     "main.go",
+			Language: "go",
+			Size:     120,
+			Checksum: "c0ffee",
+			Symbols: []schema.Symbol{
+				{SymbolID: mainID, FileID: fileID, Name: "main", Kind: schema.SymbolFunction,
+					Signature: "func main()", Span: schema.Span{StartLine: 3, EndLine: 5, StartByte: 20, EndByte: 60}},
+				{SymbolID: helperID, FileID: fileID, Name: "helper", Kind: schema.SymbolFunction,
+					Signature: "func helper() string", Docstring: "helper returns a greeting",
+					Span: schema.Span{StartLine: 7, EndLine: 9, StartByte: 62, EndByte: 110}},
+			},
+		}},
+		Relationships: []schema.DependencyEdge{
+			{EdgeID: uuid.New().String(), SourceID: mainID, TargetID: helperID, EdgeType: schema.EdgeCall,
+				SourceFile: "main.go", TargetFile: "main.go", TargetName: "helper"},
+			{EdgeID: uuid.New().String(), SourceID: mainID, EdgeType: schema.EdgeImport,
+				SourceFile: "main.go", TargetModule: "fmt"},
+		},
+		Metadata: schema.ParseMetadata{Version: "1.0.0", TotalFiles: 1, SuccessCount: 1},
+	}
+
+	idx := indexer.NewIndexer(source.DB, &indexer.IndexerConfig{
+		RepoID:          repoID,
+		RepoName:        "archive-repo",
+		CommitHash:      "a1b2c3d",
+		BatchSize:       100,
+		WorkerCount:     1,
+		UseTransactions: true,
+		SkipVectors:     true,
+		History:         true,
+	})
+	if _, err := idx.Index(ctx, parseOutput); err != nil {
+		t.Fatalf("Failed to index: %v", err)
+	}
+
+	path := filepath.Join(t.TempDir(), "repo.catlas")
+	manifest, err := archive.ExportFile(ctx, source.DB, repoID, path, archive.ExportOptions{})
+	if err != nil {
+		t.Fatalf("Export failed: %v", err)
+	}
+	if manifest.RepoName != "archive-repo" {
+		t.Errorf("Expected repo name archive-repo, got %s", manifest.RepoName)
+	}
+
+	indexesBefore := countIndexes(t, target.DB)
+	result, err := archive.ImportFile(ctx, target.DB, path, archive.ImportOptions{DeferIndexes: true})
+	if err != nil {
+		t.Fatalf("Import failed: %v", err)
+	}
+	if result.RebuiltIndexes == 0 {
+		t.Error("Expected secondary indexes to be deferred on an empty database")
+	}
+	if got := countIndexes(t, target.DB); got != indexesBefore {
+		t.Errorf("Expected %d indexes after import, got %d", indexesBefore, got)
+	}
+
+	for _, table := range archivedTables {
+		want := countRows(t, source.DB, table)
+		if got := countRows(t, target.DB, table); got != want {
+			t.Errorf("%s: expected %d rows, got %d", table, want, got)
+		}
+	}
+	if countRows(t, source.DB, "symbol_history") == 0 || countRows(t, source.DB, "edge_history") == 0 {
+		t.Fatal("Expected the source repository to have commit history")
+	}
+
+	edges, err := models.NewEdgeRepository(target.DB).GetBySourceID(ctx, mainID)
+	if err != nil {
+		t.Fatalf("Failed to get edges: %v", err)
+	}
+	resolved := 0
+	for _, e := range edges {
+		if e.TargetID != nil && *e.TargetID == helperID {
+			resolved++
+		}
+	}
+	if resolved != 1 {
+		t.Errorf("Expected the call edge to keep its target, got %d resolved edges", resolved)
+	}
+
+	// 第二次导入：默认拒绝，--replace 时替换且不延迟索引（表非空）
+	if _, err := archive.ImportFile(ctx, target.DB, path, archive.ImportOptions{DeferIndexes: true}); !errors.Is(err, archive.ErrRepositoryExists) {
+		t.Errorf("Expected ErrRepositoryExists, got %v", err)
+	}
+	result, err = archive.ImportFile(ctx, target.DB, path, archive.ImportOptions{Replace: true})
+	if err != nil {
+		t.Fatalf("Replace import failed: %v", err)
+	}
+	if !result.Replaced {
+		t.Error("Expected the existing repository to be replaced")
+	}
+	if got := countRows(t, target.DB, "symbols"); got != 2 {
+		t.Errorf("Expected 2 symbols after replace, got %d", got)
+	}
+
+	// 替换时删除仓库会级联删除提交历史，历史必须随归档重新导入
+	for _, table := range archivedTables {
+		want := countRows(t, source.DB, table)
+		if got := countRows(t, target.DB, table); got != want {
+			t.Errorf("%s after replace: expected %d rows, got %d", table, want, got)
+		}
+	}
+	commit, err := models.NewHistoryRepository(target.DB).ResolveCommit(ctx, repoID, "a1b2c3d")
+	if err != nil {
+		t.Fatalf("Failed to resolve the imported commit: %v", err)
+	}
+	if commit.Hash != "a1b2c3d" || commit.Seq != 1 {
+		t.Errorf("Expected commit a1b2c3d at seq 1, got %s at seq %d", commit.Hash, commit.Seq)
+	}
+}
+
+// archivedTables 是导入后行数应与源库一致的表
+var archivedTables = []string{"files", "symbols", "edges", "commits", "symbol_history", "edge_history"}
+
+func countRows(t *testing.T, db *models.DB, table string) int {
+	t.Helper()
+	var n int
+	if err := db.QueryRow("SELECT COUNT(*) FROM " + table).Scan(&n); err != nil {
+		t.Fatalf("Failed to count %s: %v", table, err)
+	}
+	return n
+}
+
+func countIndexes(t *testing.T, db *models.DB) int {
+	t.Helper()
+	var n int
+	if err := db.QueryRow("SELECT COUNT(*) FROM pg_indexes WHERE schemaname = current_schema()").Scan(&n); err != nil {
+		t.Fatalf("Failed to count indexes: %v", err)
+	}
+	return n
+}
@@ -89,7 +89,7 @@ func TestHeaderImplAssociation(t *testing.T) {
 	// Verify file-level implements_header edge (using virtual file symbols)
 	t.Run("VerifyFileLevelImplementsHeaderEdge", func(t *testing.T) {
 		// Query for implements_header edges（显式列名，避免 SELECT * 的列顺序/数量依赖）
-		query := `SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at FROM edges WHERE edge_type = 'implements_header'`
+		query := `SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at FROM edges LEFT JOIN external_modules m ON m.module_id = edges.target_module_id WHERE edge_type = 'implements_header'`
 		rows, err := testDB.DB.QueryContext(ctx, query)
 		if err != nil {
 			t.Fatalf("Failed to query edges: %v", err)
@@ -143,7 +143,7 @@ func TestHeaderImplAssociation(t *testing.T) {
 
 	t.Run("VerifyImplementsDeclarationEdge", func(t *testing.T) {
 		// Query for implements_declaration edges（显式列名）
-		query := `SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, target_module, created_at FROM edges WHERE edge_type = 'implements_declaration'`
+		query := `SELECT edge_id, source_id, target_id, edge_type, source_file, target_file, m.name, created_at FROM edges LEFT JOIN external_modules m ON m.module_id = edges.target_module_id WHERE edge_type = 'implements_declaration'`
 		rows, err := testDB.DB.QueryContext(ctx, query)
 		if err != nil {
 			t.Fatalf("Failed to query edges: %v", err)
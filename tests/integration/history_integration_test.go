@@ -0,0 +1,141 @@
+package integration
+
+import (
+	"context"
+	"errors"
+	"testing"
+
+	"github.com/google/uuid"
+	"github.com/yourtionguo/CodeAtlas/internal/indexer"
+	"github.com/yourtionguo/CodeAtlas/internal/schema"
+	"github.com/yourtionguo/CodeAtlas/pkg/models"
+)
+
+// historyFileIDs 固定两个文件的 ID：增量索引按 (repo_id, path) 更新文件行。
+var historyFileIDs = [2]string{uuid.New().String(), uuid.New().String()}
+
+// historyParseOutput 构造一个两文件仓库：main.go 中的 main 调用 util.go 的
+// helper；withCall 为 false 时 main.go 改为不再调用 helper。
+func historyParseOutput(withCall bool, helperID string) *schema.ParseOutput {
+	mainChecksum, mainSig := "main-v1", "func main()"
+	if !withCall {
+		mainChecksum, mainSig = "main-v2", "func main(args []string)"
+	}
+	mainFileID, utilFileID := historyFileIDs[0], historyFileIDs[1]
+	mainID := uuid.New().String()
+
+	output := &schema.ParseOutput{
+		Files: []schema.File{
+			{FileID: mainFileID, Path: "main.go", Language: "go", Size: 80, Checksum: mainChecksum,
+				Symbols: []schema.Symbol{{SymbolID: mainID, FileID: mainFileID, Name: "main",
+					Kind: schema.SymbolFunction, Signature: mainSig,
+					Span: schema.Span{StartLine: 3, EndLine: 5, StartByte: 20, EndByte: 60}}}},
+			{FileID: utilFileID, Path: "util.go", Language: "go", Size: 60, Checksum: "util-v1",
+				Symbols: []schema.Symbol{{SymbolID: helperID, FileID: utilFileID, Name: "helper",
+					Kind: schema.SymbolFunction, Signature: "func helper()",
+					Span: schema.Span{StartLine: 3, EndLine: 4, StartByte: 20, EndByte: 50}}}},
+		},
+		Metadata: schema.ParseMetadata{Version: "1.0.0", TotalFiles: 2, SuccessCount: 2},
+	}
+	if withCall {
+		output.Relationships = []schema.DependencyEdge{{EdgeID: uuid.New().String(), SourceID: mainID,
+			TargetID: helperID, EdgeType: schema.EdgeCall, SourceFile: "main.go", TargetFile: "util.go",
+			TargetName: "helper"}}
+	}
+	return output
+}
+
+// TestCommitHistory indexes two commits with history enabled and queries the
+// call graph as of each commit
+func TestCommitHistory(t *testing.T) {
+	if testing.Short() {
+		t.Skip("Skipping integration test in short mode")
+	}
+
+	tdb := SetupTestDB(t)
+	defer tdb.TeardownTestDB(t)
+
+	ctx := context.Background()
+	repoID := uuid.New().String()
+	index := func(commit string, output *schema.ParseOutput) *indexer.IndexResult {
+		t.Helper()
+		idx := indexer.NewIndexer(tdb.DB, &indexer.IndexerConfig{
+			RepoID:          repoID,
+			RepoName:        "history-repo",
+			CommitHash:      commit,
+			BatchSize:       100,
+			WorkerCount:     1,
+			Incremental:     true,
+			UseTransactions: true,
+			SkipVectors:     true,
+			History:         true,
+		})
+		result, err := idx.Index(ctx, output)
+		if err != nil {
+			t.Fatalf("Failed to index %s: %v", commit, err)
+		}
+		if result.Status != "success" {
+			t.Fatalf("Indexing %s finished with status %s: %+v", commit, result.Status, result.Errors)
+		}
+		return result
+	}
+
+	helperID := uuid.New().String()
+	v1 := historyParseOutput(true, helperID)
+	index("aaaa1111", v1)
+	result := index("bbbb2222", historyParseOutput(false, helperID))
+
+	// 第二个提交只改动了 main.go：util.go 的 helper 不应重新写入
+	diff, ok := result.Summary["history"].(*models.HistoryDiff)
+	if !ok {
+		t.Fatalf("Expected history diff in summary, got %v", result.Summary["history"])
+	}
+	if diff.SymbolsOpened != 1 || diff.SymbolsClosed != 1 || diff.EdgesClosed != 1 || diff.EdgesOpened != 0 {
+		t.Errorf("Unexpected diff: %+v", diff)
+	}
+	if got := countRows(t, tdb.DB, "symbol_history"); got != 3 {
+		t.Errorf("Expected 3 symbol versions, got %d", got)
+	}
+
+	history := models.NewHistoryRepository(tdb.DB)
+	gotRepo, key, err := history.SymbolKey(ctx, helperID)
+	if err != nil || gotRepo != repoID || key != "util.go#function:helper" {
+		t.Fatalf("SymbolKey = %s, %s, %v", gotRepo, key, err)
+	}
+
+	first, err := history.ResolveCommit(ctx, repoID, "aaaa")
+	if err != nil {
+		t.Fatalf("Failed to resolve commit prefix: %v", err)
+	}
+	second, err := history.ResolveCommit(ctx, repoID, "BBBB2222")
+	if err != nil {
+		t.Fatalf("Failed to resolve commit: %v", err)
+	}
+
+	callers, err := history.CallersAt(ctx, repoID, key, first.Seq)
+	if err != nil {
+		t.Fatalf("CallersAt failed: %v", err)
+	}
+	if len(callers) != 1 || callers[0].Name != "main" || callers[0].Signature != "func main()" {
+		t.Errorf("Expected main as caller at first commit, got %+v", callers)
+	}
+	if callers, err = history.CallersAt(ctx, repoID, key, second.Seq); err != nil || len(callers) != 0 {
+		t.Errorf("Expected no callers at second commit, got %+v (%v)", callers, err)
+	}
+
+	// 历史只能追加：重新索引旧提交被拒绝（非致命，记为错误）
+	idx := indexer.NewIndexer(tdb.DB, &indexer.IndexerConfig{
+		RepoID: repoID, RepoName: "history-repo", CommitHash: "aaaa1111",
+		BatchSize: 100, WorkerCount: 1, UseTransactions: true, SkipVectors: true, History: true,
+	})
+	result, err = idx.Index(ctx, v1)
+	if err != nil {
+		t.Fatalf("Failed to re-index: %v", err)
+	}
+	if result.Status != "partial_success" {
+		t.Errorf("Expected out-of-order history to be reported, got status %s", result.Status)
+	}
+	if _, err := history.ResolveCommit(ctx, repoID, "cccc"); !errors.Is(err, models.ErrCommitNotFound) {
+		t.Errorf("Expected ErrCommitNotFound, got %v", err)
+	}
+}
@@ -2,6 +2,7 @@ package integration
 
 import (
 	"context"
+	"fmt"
 	"testing"
 
 	"github.com/google/uuid"
@@ -147,6 +148,92 @@ func TestEndToEndIndexing(t *testing.T) {
 	})
 }
 
+// TestStagedParallelWrite indexes a repository large enough to be written as
+// concurrent file groups through staging tables
+func TestStagedParallelWrite(t *testing.T) {
+	if testing.Short() {
+		t.Skip("Skipping integration test in short mode")
+	}
+
+	testDB := SetupTestDB(t)
+	defer testDB.TeardownTestDB(t)
+
+	ctx := context.Background()
+
+	// 200 个文件，每个文件一个带子节点的函数并调用下一个文件的函数
+	parseOutput := &schema.ParseOutput{}
+	symbolIDs := make([]string, 200)
+	for i := range symbolIDs {
+		symbolIDs[i] = uuid.New().String()
+	}
+	for i := range symbolIDs {
+		fileID, rootID := uuid.New().String(), uuid.New().String()
+		path := fmt.Sprintf("pkg/f%03d.go", i)
+		parseOutput.Files = append(parseOutput.Files, schema.File{
+			FileID:   fileID,
+			Path:     path,
+			Language: "go",
+			Size:     100,
+			Checksum: fmt.Sprintf("sum%03d", i),
+			Symbols: []schema.Symbol{{
+				SymbolID: symbolIDs[i],
+				FileID:   fileID,
+				Name:     fmt.Sprintf("F%03d", i),
+				Kind:     schema.SymbolFunction,
+				Span:     schema.Span{StartLine: 1, EndLine: 3, StartByte: 0, EndByte: 40},
+			}},
+			Nodes: []schema.ASTNode{
+				{NodeID: rootID, FileID: fileID, Type: "source_file", Span: schema.Span{StartLine: 1, EndLine: 3, EndByte: 40}},
+				{NodeID: uuid.New().String(), FileID: fileID, Type: "function_declaration", ParentID: rootID,
+					Span: schema.Span{StartLine: 1, EndLine: 3, EndByte: 40}, Attributes: map[string]string{"name": "F"}},
+			},
+		})
+		parseOutput.Relationships = append(parseOutput.Relationships, schema.DependencyEdge{
+			EdgeID:     uuid.New().String(),
+			SourceID:   symbolIDs[i],
+			TargetID:   symbolIDs[(i+1)%len(symbolIDs)],
+			EdgeType:   schema.EdgeCall,
+			SourceFile: path,
+		})
+	}
+
+	config := &indexer.IndexerConfig{
+		RepoID:           uuid.New().String(),
+		RepoName:         "staged-repo",
+		BatchSize:        100,
+		WorkerCount:      2,
+		SkipVectors:      true,
+		UseTransactions:  true,
+		WriteParallelism: 4,
+	}
+	result, err := indexer.NewIndexer(testDB.DB, config).Index(ctx, parseOutput)
+	if err != nil {
+		t.Fatalf("Indexing failed: %v", err)
+	}
+	if result.FilesProcessed != 200 || result.SymbolsCreated != 200 || result.NodesCreated != 400 || result.EdgesCreated != 200 {
+		t.Errorf("unexpected counts: files=%d symbols=%d nodes=%d edges=%d",
+			result.FilesProcessed, result.SymbolsCreated, result.NodesCreated, result.EdgesCreated)
+	}
+
+	var edges, staging int
+	if err := testDB.QueryRowContext(ctx, `SELECT COUNT(*) FROM edges WHERE edge_type = 'call'`).Scan(&edges); err != nil {
+		t.Fatalf("Failed to count edges: %v", err)
+	}
+	if edges != 200 {
+		t.Errorf("expected 200 published call edges, got %d", edges)
+	}
+	if err := testDB.QueryRowContext(ctx, `SELECT COUNT(*) FROM pg_tables WHERE tablename LIKE 'staged\_%'`).Scan(&staging); err != nil {
+		t.Fatalf("Failed to list staging tables: %v", err)
+	}
+	if staging != 0 {
+		t.Errorf("expected staging tables to be dropped, found %d", staging)
+	}
+
+	if err := VerifyReferentialIntegrity(ctx, testDB.DB); err != nil {
+		t.Errorf("Referential integrity check failed: %v", err)
+	}
+}
+
 // TestIncrementalIndexing tests incremental indexing with file modifications
 func TestIncrementalIndexing(t *testing.T) {
 	if testing.Short() {
@@ -0,0 +1,61 @@
+// CodeAtlas REST API 客户端（接口说明见 docs/api.md）
+
+export const DEFAULT_PAGE_SIZE = 200;
+
+async function request(baseUrl, path, options = {}) {
+	const response = await fetch(`${baseUrl}/api/v1${path}`, options);
+	if (!response.ok) {
+		let message = response.statusText;
+		try {
+			const body = await response.json();
+			message = body.error || message;
+		} catch (_) {
+			// 非 JSON 错误体，保留 statusText
+		}
+		throw new Error(`API error: ${message}`);
+	}
+	return response.json();
+}
+
+/**
+ * 语义 / 关键词检索。结果按相关度排序，一次返回，不分页。
+ */
+export async function searchCode(baseUrl, query, { limit = 1000, mode } = {}) {
+	const body = await request(baseUrl, '/search', {
+		method: 'POST',
+		headers: { 'Content-Type': 'application/json' },
+		body: JSON.stringify({ query, limit, mode }),
+	});
+	return body.results || [];
+}
+
+async function fetchRelationshipPage(baseUrl, symbolId, relation, { cursor = '', limit = DEFAULT_PAGE_SIZE } = {}) {
+	const params = new URLSearchParams({ limit: String(limit) });
+	if (cursor) {
+		params.set('cursor', cursor);
+	}
+	const body = await request(baseUrl, `/symbols/${encodeURIComponent(symbolId)}/${relation}?${params}`);
+	return { items: body.symbols || [], nextCursor: body.next_cursor || '' };
+}
+
+/**
+ * 按游标分页获取直接调用方。返回 { items, nextCursor }，nextCursor 为空表示没有下一页。
+ */
+export function fetchCallers(baseUrl, symbolId, page) {
+	return fetchRelationshipPage(baseUrl, symbolId, 'callers', page);
+}
+
+/**
+ * 按游标分页获取直接被调用方，返回值同 fetchCallers。
+ */
+export function fetchCallees(baseUrl, symbolId, page) {
+	return fetchRelationshipPage(baseUrl, symbolId, 'callees', page);
+}
+
+/**
+ * 多跳调用关系。direction 为 'callers' 或 'callees'，depth 缺省时使用服务端默认值。
+ */
+export function fetchTransitive(baseUrl, symbolId, direction, depth) {
+	const query = depth ? `?depth=${depth}` : '';
+	return request(baseUrl, `/symbols/${encodeURIComponent(symbolId)}/transitive-${direction}${query}`);
+}
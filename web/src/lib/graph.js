@@ -0,0 +1,158 @@
+// 调用图渐进绘制。
+//
+// 多跳查询（transitive-callers / transitive-callees）在大仓库里一次能返回上万个
+// 符号，一次性画完会卡住主线程。这里分两步控制开销：
+//   1. 细节层级（LOD）截断：每一层（跳数）最多画 maxPerLevel 个节点，其余折叠成
+//      一个 "+N more" 节点；超过 maxDepth 的层整体折叠。绘制量因此有上限，与结果
+//      规模无关。
+//   2. 分帧绘制：按层由近及远排好绘制顺序，每帧在 budgetMs 时间预算内尽量多画，
+//      剩下的放到下一帧，近处的层先出现。
+
+export const DEFAULT_MAX_PER_LEVEL = 40;
+export const DEFAULT_MAX_DEPTH = 6;
+export const DEFAULT_FRAME_BUDGET_MS = 8;
+
+/**
+ * 按 depth 把多跳查询结果分层，并做 LOD 截断。
+ *
+ * @param {{name: string}} root 起始符号
+ * @param {Array<{symbol_id: string, name: string, depth: number}>} symbols
+ * @returns {Array<{depth: number, nodes: Array, hidden: number}>} 第 0 层为起始符号
+ */
+export function buildLevels(root, symbols, { maxPerLevel = DEFAULT_MAX_PER_LEVEL, maxDepth = DEFAULT_MAX_DEPTH } = {}) {
+	const levels = [{ depth: 0, nodes: [root], hidden: 0 }];
+	let collapsed = 0;
+
+	for (const sym of symbols) {
+		const depth = sym.depth > 0 ? sym.depth : 1;
+		if (depth > maxDepth) {
+			collapsed += 1;
+			continue;
+		}
+		while (levels.length <= depth) {
+			levels.push({ depth: levels.length, nodes: [], hidden: 0 });
+		}
+		const level = levels[depth];
+		if (level.nodes.length < maxPerLevel) {
+			level.nodes.push(sym);
+		} else {
+			level.hidden += 1;
+		}
+	}
+
+	if (collapsed > 0) {
+		levels.push({ depth: maxDepth + 1, nodes: [], hidden: collapsed });
+	}
+	return levels.filter((level) => level.nodes.length > 0 || level.hidden > 0);
+}
+
+/**
+ * 把分层结果排成从左到右的列，返回按绘制顺序排列的图元。
+ * 每层和上一层之间只画一条连线：多跳结果只带跳数，不带具体的父节点。
+ */
+export function layoutLevels(levels, { width, height, nodeHeight = 18, padding = 12 }) {
+	const items = [];
+	const columnWidth = levels.length > 1 ? (width - 2 * padding) / levels.length : width - 2 * padding;
+
+	levels.forEach((level, col) => {
+		const x = padding + col * columnWidth;
+		const slots = level.nodes.length + (level.hidden > 0 ? 1 : 0);
+		const step = Math.min(nodeHeight * 1.5, (height - 2 * padding) / Math.max(1, slots));
+		const top = (height - step * slots) / 2;
+
+		if (col > 0) {
+			items.push({
+				type: 'link',
+				x1: x - columnWidth * 0.15,
+				y1: height / 2,
+				x2: x,
+				y2: height / 2,
+			});
+		}
+		level.nodes.forEach((node, row) => {
+			items.push({
+				type: col === 0 ? 'root' : 'node',
+				x,
+				y: top + row * step,
+				width: columnWidth * 0.8,
+				height: Math.min(nodeHeight, step),
+				label: node.name,
+			});
+		});
+		if (level.hidden > 0) {
+			items.push({
+				type: 'more',
+				x,
+				y: top + level.nodes.length * step,
+				width: columnWidth * 0.8,
+				height: Math.min(nodeHeight, step),
+				label: `+${level.hidden} more`,
+			});
+		}
+	});
+	return items;
+}
+
+const COLORS = { root: '#ff3e00', node: '#4a6fa5', more: '#999', link: '#ccc' };
+
+function drawItem(ctx, item) {
+	if (item.type === 'link') {
+		ctx.strokeStyle = COLORS.link;
+		ctx.beginPath();
+		ctx.moveTo(item.x1, item.y1);
+		ctx.lineTo(item.x2, item.y2);
+		ctx.stroke();
+		return;
+	}
+	ctx.fillStyle = COLORS[item.type];
+	ctx.fillRect(item.x, item.y, item.width, item.height);
+	ctx.fillStyle = '#fff';
+	ctx.fillText(item.label, item.x + 4, item.y + item.height - 4, item.width - 8);
+}
+
+/**
+ * 分帧绘制图元：每帧在 budgetMs 内画尽量多的图元（至少一个），剩余的交给下一帧。
+ * schedule / cancel / now 可注入，便于在无浏览器环境下测试。
+ *
+ * @returns {() => void} 取消函数；重新绘制前应先取消上一次
+ */
+export function drawProgressive(ctx, items, {
+	budgetMs = DEFAULT_FRAME_BUDGET_MS,
+	now = () => performance.now(),
+	schedule = (fn) => requestAnimationFrame(fn),
+	cancel = (handle) => cancelAnimationFrame(handle),
+	onFrame = () => {},
+	onDone = () => {},
+} = {}) {
+	let next = 0;
+	let handle = null;
+
+	function frame() {
+		const deadline = now() + budgetMs;
+		const first = next;
+		do {
+			drawItem(ctx, items[next]);
+			next += 1;
+		} while (next < items.length && now() < deadline);
+
+		onFrame(next - first);
+		if (next < items.length) {
+			handle = schedule(frame);
+		} else {
+			handle = null;
+			onDone();
+		}
+	}
+
+	if (items.length > 0) {
+		handle = schedule(frame);
+	} else {
+		onDone();
+	}
+	return () => {
+		if (handle !== null) {
+			cancel(handle);
+			handle = null;
+		}
+	};
+}
@@ -0,0 +1,43 @@
+// 列表窗口化：只渲染视口内（加上下 overscan）的行，每帧的渲染量只和视口高度
+// 有关，与结果总数无关。行高固定，偏移量可以直接算出来，不需要测量 DOM。
+
+export const DEFAULT_OVERSCAN = 8;
+
+/**
+ * 计算当前滚动位置需要渲染的行区间 [start, end)。
+ *
+ * @param {object} opts
+ * @param {number} opts.scrollTop      视口滚动偏移（px）
+ * @param {number} opts.viewportHeight 视口高度（px）
+ * @param {number} opts.rowHeight      固定行高（px）
+ * @param {number} opts.total          已加载的总行数
+ * @param {number} [opts.overscan]     视口上下各多渲染的行数，减少快速滚动时的白屏
+ * @returns {{start: number, end: number, offsetTop: number, totalHeight: number}}
+ */
+export function visibleRange({ scrollTop, viewportHeight, rowHeight, total, overscan = DEFAULT_OVERSCAN }) {
+	const totalHeight = total * rowHeight;
+	if (total <= 0 || rowHeight <= 0) {
+		return { start: 0, end: 0, offsetTop: 0, totalHeight: 0 };
+	}
+
+	const maxScroll = Math.max(0, totalHeight - viewportHeight);
+	const top = Math.min(Math.max(0, scrollTop), maxScroll);
+
+	const first = Math.floor(top / rowHeight);
+	const count = Math.ceil(viewportHeight / rowHeight) + 1;
+	const start = Math.max(0, first - overscan);
+	const end = Math.min(total, first + count + overscan);
+
+	return { start, end, offsetTop: start * rowHeight, totalHeight };
+}
+
+/**
+ * 渲染区间是否已接近已加载数据的末尾，用于滚动时触发下一页请求。
+ *
+ * @param {{end: number}} range visibleRange 的返回值
+ * @param {number} total 已加载的总行数
+ * @param {number} [threshold] 距末尾多少行内开始预取
+ */
+export function nearEnd(range, total, threshold = 50) {
+	return total - range.end <= threshold;
+}
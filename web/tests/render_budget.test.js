@@ -0,0 +1,147 @@
+// 无浏览器的渲染开销测试：结果集从 1k 增长到 100k 时，每帧渲染的行数和 DOM 节点数应保持不变。
+// 只断言窗口化真正保证的数量，不依赖计时（CI 机器上的耗时抖动会让计时断言不稳定）。
+import { test } from 'node:test';
+import assert from 'node:assert/strict';
+
+import { visibleRange } from '../src/lib/virtual.js';
+import { buildLevels, layoutLevels, drawProgressive } from '../src/lib/graph.js';
+
+const SIZES = [1_000, 10_000, 100_000];
+const ROW_HEIGHT = 32;
+const VIEWPORT = 480;
+const FRAMES = 2_000;
+
+function makeRows(n) {
+	return Array.from({ length: n }, (_, i) => ({
+		symbol_id: `sym-${i}`,
+		name: `handler_${i}`,
+		kind: 'function',
+		file_path: `src/pkg${i % 97}/file${i % 13}.c`,
+		depth: 1 + (i % 8),
+	}));
+}
+
+// 模拟一次滚动帧：计算窗口、切片、生成行 DOM 的等价字符串
+function renderFrame(rows, scrollTop) {
+	const range = visibleRange({ scrollTop, viewportHeight: VIEWPORT, rowHeight: ROW_HEIGHT, total: rows.length });
+	let html = '';
+	for (const row of rows.slice(range.start, range.end)) {
+		html += `<div class="row"><span>${row.kind}</span><b>${row.name}</b><i>${row.file_path}</i></div>`;
+	}
+	return { range, html };
+}
+
+// 从顶部滚到底部，返回单帧最多渲染的行数和 DOM 节点数
+function scrollThrough(rows) {
+	const maxScroll = rows.length * ROW_HEIGHT - VIEWPORT;
+	let maxRendered = 0;
+	let maxNodes = 0;
+	for (let f = 0; f < FRAMES; f++) {
+		const { range, html } = renderFrame(rows, (maxScroll * f) / (FRAMES - 1));
+		maxRendered = Math.max(maxRendered, range.end - range.start);
+		maxNodes = Math.max(maxNodes, (html.match(/<[a-z]/g) || []).length);
+	}
+	return { maxRendered, maxNodes };
+}
+
+test('visibleRange clamps to the loaded rows', () => {
+	assert.deepEqual(visibleRange({ scrollTop: 0, viewportHeight: VIEWPORT, rowHeight: ROW_HEIGHT, total: 0 }), {
+		start: 0,
+		end: 0,
+		offsetTop: 0,
+		totalHeight: 0,
+	});
+
+	const bottom = visibleRange({ scrollTop: 1e9, viewportHeight: VIEWPORT, rowHeight: ROW_HEIGHT, total: 100 });
+	assert.equal(bottom.end, 100);
+	assert.equal(bottom.offsetTop, bottom.start * ROW_HEIGHT);
+	assert.equal(bottom.totalHeight, 100 * ROW_HEIGHT);
+});
+
+test('rows rendered per frame do not depend on result size', () => {
+	const rendered = SIZES.map((n) => scrollThrough(makeRows(n)).maxRendered);
+	assert.ok(rendered.every((r) => r === rendered[0]), `rendered rows per frame: ${rendered}`);
+	assert.ok(rendered[0] <= Math.ceil(VIEWPORT / ROW_HEIGHT) + 1 + 2 * 8);
+});
+
+test('DOM nodes per frame do not depend on result size', () => {
+	const stats = SIZES.map((n) => scrollThrough(makeRows(n)));
+	const nodes = stats.map((s) => s.maxNodes);
+	assert.ok(nodes.every((c) => c === nodes[0]), `DOM nodes per frame: ${nodes}`);
+	// 每行一个容器加三个子元素
+	assert.equal(nodes[0], stats[0].maxRendered * 4);
+});
+
+test('call graph level-of-detail caps drawn items', () => {
+	const root = { name: 'main' };
+	const counts = SIZES.map((n) => {
+		const levels = buildLevels(root, makeRows(n), { maxPerLevel: 40, maxDepth: 6 });
+		return layoutLevels(levels, { width: 960, height: 480 }).length;
+	});
+	assert.ok(counts.every((c) => c === counts[0]), `drawn items: ${counts}`);
+
+	const levels = buildLevels(root, makeRows(1_000), { maxPerLevel: 40, maxDepth: 6 });
+	const hidden = levels.reduce((sum, level) => sum + level.hidden, 0);
+	const shown = levels.reduce((sum, level) => sum + level.nodes.length, 0);
+	assert.equal(shown + hidden, 1_001);
+	assert.equal(levels[levels.length - 1].depth, 7, 'levels beyond maxDepth collapse into one');
+});
+
+test('progressive drawing respects the frame budget', () => {
+	const levels = buildLevels({ name: 'main' }, makeRows(100_000), { maxPerLevel: 200, maxDepth: 8 });
+	const items = layoutLevels(levels, { width: 960, height: 480 });
+
+	// 假时钟：每画一个图元（fillRect / stroke）耗时 0.5ms；假调度：手动逐帧推进
+	let clock = 0;
+	const ctx = new Proxy({}, {
+		get: (_, method) => () => {
+			if (method === 'fillRect' || method === 'stroke') {
+				clock += 0.5;
+			}
+		},
+		set: () => true,
+	});
+	const queue = [];
+	const perFrame = [];
+	let done = false;
+
+	drawProgressive(ctx, items, {
+		budgetMs: 8,
+		now: () => clock,
+		schedule: (fn) => queue.push(fn),
+		cancel: () => {},
+		onFrame: (n) => perFrame.push(n),
+		onDone: () => {
+			done = true;
+		},
+	});
+	while (queue.length > 0) {
+		queue.shift()();
+	}
+
+	assert.ok(done);
+	assert.equal(perFrame.reduce((a, b) => a + b, 0), items.length);
+	assert.ok(perFrame.length > 1, 'drawing should span several frames');
+	assert.ok(Math.max(...perFrame) <= 8 / 0.5 + 1, `items per frame: ${Math.max(...perFrame)}`);
+});
+
+test('cancel stops progressive drawing', () => {
+	const items = layoutLevels(buildLevels({ name: 'main' }, makeRows(500)), { width: 960, height: 480 });
+	const ctx = new Proxy({}, { get: () => () => {}, set: () => true });
+	const queue = [];
+	let frames = 0;
+
+	const cancel = drawProgressive(ctx, items, {
+		budgetMs: 0,
+		now: () => 0,
+		schedule: (fn) => queue.push(fn),
+		cancel: () => queue.splice(0),
+		onFrame: () => {
+			frames += 1;
+		},
+	});
+	queue.shift()();
+	cancel();
+	assert.equal(queue.length, 0);
+	assert.equal(frames, 1);
+});